@@ -0,0 +1,70 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#ifndef BENCHMARK_FREEIMAGE_API_H
+#define BENCHMARK_FREEIMAGE_API_H
+
+// the benchmarks share the image generators of the test suite
+#include "TestSuite.h"
+
+#include <chrono>
+
+/**
+Milliseconds elapsed since a time point of the steady clock
+*/
+inline double
+elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// GIF benchmarks
+// ==========================================================
+
+void benchGIF(const char *lpszPathName);
+
+// PNG benchmarks
+// ==========================================================
+
+void benchPNGEncode();
+void benchPNGDecode();
+void benchAPNG(const char *lpszPathName);
+
+// Other benchmarks
+// ==========================================================
+
+void benchConvertLineSIMD();
+void benchConvertToType();
+void benchDrawBitmap();
+void benchPreMultiplyWithAlpha();
+void benchRescaleLinearLight();
+void benchBlur();
+void benchConvolve();
+void benchToneMapping();
+void benchPoissonSolver();
+void benchQuantize();
+void benchMapToPalette();
+void benchDepthDither();
+void benchRotate();
+void benchWarpAffine();
+void benchRemap();
+void benchImageStatistics();
+void benchAdjustCurves();
+void benchSplitMergeChannels();
+
+#endif // BENCHMARK_FREEIMAGE_API_H
@@ -0,0 +1,120 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+// Timings of the image processing and codec functions, on full HD or larger frames.
+// Run from the TestAPI directory, which holds the sample images.
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+	FreeImage error handler
+	@param fif Format / Plugin responsible for the error 
+	@param message Error message
+*/
+void FreeImageErrorHandler(FREE_IMAGE_FORMAT fif, const char *message) {
+	printf("\n*** "); 
+	if(fif != FIF_UNKNOWN) {
+		printf("%s Format\n", FreeImage_GetFormatFromFIF(fif));
+	}
+	printf("%s", message);
+	printf(" ***\n");
+}
+
+// ----------------------------------------------------------
+
+int main() {
+#if defined(FREEIMAGE_LIB) || !defined(WIN32)
+	FreeImage_Initialise();
+#endif
+
+	// initialize our own FreeImage error handler
+	FreeImage_SetOutputMessage(FreeImageErrorHandler);
+
+	// GIF LZW codec
+	benchGIF("sample.gif");
+
+#if FREEIMAGE_WITH_LIBPNG
+	// PNG encoder presets
+	benchPNGEncode();
+
+	// PNG full / streamed / downscaled decoding
+	benchPNGDecode();
+
+	// APNG reading / writing
+	benchAPNG("sample.gif");
+#endif
+
+	// line conversions at every SIMD level
+	benchConvertLineSIMD();
+
+	// display conversions of high dynamic range types
+	benchConvertToType();
+
+	// alpha blending
+	benchDrawBitmap();
+
+	// alpha premultiplication
+	benchPreMultiplyWithAlpha();
+
+	// thumbnails
+	benchRescaleLinearLight();
+
+	// Gaussian blur
+	benchBlur();
+
+	// convolution and morphology
+	benchConvolve();
+
+	// tone mapping operators
+	benchToneMapping();
+
+	// Poisson solvers
+	benchPoissonSolver();
+
+	// color quantization
+	benchQuantize();
+
+	// palette mapping and dithering
+	benchMapToPalette();
+
+	// bit depth reduction
+	benchDepthDither();
+
+	// rotations by multiples of 90 degrees
+	benchRotate();
+
+	// affine and perspective warps
+	benchWarpAffine();
+	benchRemap();
+
+	// image statistics and curves
+	benchImageStatistics();
+	benchAdjustCurves();
+
+	// channel split and merge
+	benchSplitMergeChannels();
+
+#if defined(FREEIMAGE_LIB) || !defined(WIN32)
+	FreeImage_DeInitialise();
+#endif
+
+	return 0;
+}
@@ -0,0 +1,37 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Speed of the Gaussian blur on a 1920x1080 frame, for a small and a large radius
+*/
+void benchBlur() {
+	UniqueBitmap frame(FreeImage_Allocate(1920, 1080, 24), &::FreeImage_Unload);
+	fillRandom(frame.get(), 2);
+	for (double sigma : { 2.0, 20.0 }) {
+		const auto start = std::chrono::steady_clock::now();
+		UniqueBitmap blurred(FreeImage_GaussianBlur(frame.get(), sigma), &::FreeImage_Unload);
+		const double ms = elapsedMs(start);
+		assert(blurred);
+		printf("1920x1080 24-bit Gaussian blur, sigma %.1f : %.3f ms\n", sigma, ms);
+	}
+}
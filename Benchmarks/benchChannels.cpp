@@ -0,0 +1,57 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Single pass split of a 4096x2730 32-bit image, against one pass per channel, then merge
+*/
+void benchSplitMergeChannels() {
+	const unsigned width = 4096, height = 2730;
+	UniqueBitmap src(FreeImage_Allocate(width, height, 32), &::FreeImage_Unload);
+	assert(src != nullptr);
+	fillRandom(src.get(), 17);
+
+	FIBITMAP *channels[4] = {};
+	auto start = std::chrono::steady_clock::now();
+	const FIBOOL bSuccess = FreeImage_SplitChannels(src.get(), channels);
+	const double split = elapsedMs(start);
+	assert(bSuccess);
+
+	const FREE_IMAGE_COLOR_CHANNEL colors[] = { FICC_RED, FICC_GREEN, FICC_BLUE, FICC_ALPHA };
+	start = std::chrono::steady_clock::now();
+	for (FREE_IMAGE_COLOR_CHANNEL color : colors) {
+		UniqueBitmap channel(FreeImage_GetChannel(src.get(), color), &::FreeImage_Unload);
+		assert(channel != nullptr);
+	}
+	const double separate = elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap merged(FreeImage_MergeChannels(channels, 4), &::FreeImage_Unload);
+	const double merge = elapsedMs(start);
+	assert(merged != nullptr);
+
+	printf("%ux%u 32-bit : split %.3f ms, one channel at a time %.3f ms, merge %.3f ms\n", width, height, split, separate, merge);
+
+	for (FIBITMAP *channel : channels) {
+		FreeImage_Unload(channel);
+	}
+}
@@ -0,0 +1,79 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include <vector>
+
+// ----------------------------------------------------------
+
+/**
+Auto-levels input of a 40 MB image : one statistics pass against min / max and a histogram of every channel
+*/
+void benchImageStatistics() {
+	const unsigned width = 4096, height = 3413;
+	UniqueBitmap bmp(FreeImage_Allocate(width, height, 24), &::FreeImage_Unload);
+	fillRandom(bmp.get(), 15);
+
+	std::vector<uint32_t> hist(3 * 256);
+	FISTATISTICS stats;
+	auto start = std::chrono::steady_clock::now();
+	FIBOOL bSuccess = FreeImage_GetStatistics(bmp.get(), &stats, 256, hist.data());
+	const double combined = elapsedMs(start);
+	assert(bSuccess);
+
+	FIRGB8 minVal, maxVal;
+	uint8_t histMin{}, histMax{};
+	start = std::chrono::steady_clock::now();
+	const FIBOOL bMinMax = FreeImage_FindMinMaxValue(bmp.get(), &minVal, &maxVal);
+	const FIBOOL bHistogram = FreeImage_MakeHistogram(bmp.get(), 256, &histMin, &histMax, hist.data(), 1, hist.data() + 256, 1, hist.data() + 512, 1);
+	const double separate = elapsedMs(start);
+	assert(bMinMax && bHistogram);
+
+	printf("%ux%u 24-bit : statistics and histograms %.3f ms, min / max and histograms %.3f ms\n", width, height, combined, separate);
+}
+
+/**
+Colour grading of a 16-bit master : one fused pass against one curve per channel
+*/
+void benchAdjustCurves() {
+	const unsigned width = 4096, height = 2730;
+	UniqueBitmap bmp(FreeImage_AllocateT(FIT_RGB16, width, height), &::FreeImage_Unload);
+	fillRandom(bmp.get(), 16);
+	UniqueBitmap copy(FreeImage_Clone(bmp.get()), &::FreeImage_Unload);
+
+	std::vector<uint16_t> luts[3];
+	for (unsigned c = 0; c < 3; c++) {
+		luts[c].resize(65536);
+		FreeImage_GetAdjustColorsLookupTable16(luts[c].data(), 5.0 * c, 10.0, 1.0 + 0.2 * c, FALSE);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	const FIBOOL bFused = FreeImage_AdjustChannelCurves(bmp.get(), luts[0].data(), luts[1].data(), luts[2].data());
+	const double fused = elapsedMs(start);
+	assert(bFused);
+
+	start = std::chrono::steady_clock::now();
+	const FIBOOL bRed = FreeImage_AdjustCurve16(copy.get(), luts[0].data(), FICC_RED);
+	const FIBOOL bGreen = FreeImage_AdjustCurve16(copy.get(), luts[1].data(), FICC_GREEN);
+	const FIBOOL bBlue = FreeImage_AdjustCurve16(copy.get(), luts[2].data(), FICC_BLUE);
+	const double separate = elapsedMs(start);
+	assert(bRed && bGreen && bBlue);
+
+	printf("%ux%u RGB16 : fused curves %.3f ms, one curve per channel %.3f ms\n", width, height, fused, separate);
+}
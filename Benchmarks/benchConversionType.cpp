@@ -0,0 +1,60 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Fill a single channel image with a diagonal ramp over [0, max_value]
+*/
+template <class T>
+static void
+fillRamp(FIBITMAP *dib, T max_value) {
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+	for (unsigned y = 0; y < height; y++) {
+		T *bits = reinterpret_cast<T*>(FreeImage_GetScanLine(dib, y));
+		for (unsigned x = 0; x < width; x++) {
+			bits[x] = (T)(max_value * (double)((x + y) % 1024) / 1023);
+		}
+	}
+}
+
+/**
+Speed of the display conversions (linear scaling to 8-bit) on 4096x4096 images
+*/
+void benchConvertToType() {
+	const unsigned width = 4096, height = 4096;
+	const FREE_IMAGE_TYPE types[] = { FIT_UINT16, FIT_FLOAT };
+	for (FREE_IMAGE_TYPE type : types) {
+		UniqueBitmap src(FreeImage_AllocateT(type, width, height), &::FreeImage_Unload);
+		assert(src != nullptr);
+		if (type == FIT_UINT16) {
+			fillRamp<uint16_t>(src.get(), 65535);
+		} else {
+			fillRamp<float>(src.get(), 1.0f);
+		}
+		const auto start = std::chrono::steady_clock::now();
+		UniqueBitmap dst(FreeImage_ConvertToType(src.get(), FIT_BITMAP, TRUE), &::FreeImage_Unload);
+		const double ms = elapsedMs(start);
+		assert(dst != nullptr);
+		printf("%ux%u type %d to 8-bit : %.3f ms\n", width, height, (int)type, ms);
+	}
+}
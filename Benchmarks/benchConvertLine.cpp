@@ -0,0 +1,83 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// ----------------------------------------------------------
+
+/**
+Speed of the line conversion kernels on a 1920x1080 frame, at every SIMD level supported by the CPU
+*/
+void benchConvertLineSIMD() {
+	const FREE_IMAGE_SIMD initial_level = FreeImage_GetSIMDLevel();
+
+	unsigned seed = 1234;
+	std::vector<FIRGBA8> palette(256);
+	for (auto& color : palette) {
+		const unsigned value = nextRandom(seed);
+		memcpy(&color, &value, sizeof(color));
+	}
+
+	using LineConverter = std::function<void(uint8_t *target, uint8_t *source, int width)>;
+	const std::pair<const char*, LineConverter> conversions[] = {
+		{ "24To32", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine24To32(t, s, w); } },
+		{ "32To24", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine32To24(t, s, w); } },
+		{ "24To8", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine24To8(t, s, w); } },
+		{ "32To8", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine32To8(t, s, w); } },
+		{ "16To24_555", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To24_555(t, s, w); } },
+		{ "16To24_565", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To24_565(t, s, w); } },
+		{ "16To32_555", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To32_555(t, s, w); } },
+		{ "16To32_565", [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To32_565(t, s, w); } },
+		{ "8To32", [&palette](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine8To32(t, s, w, palette.data()); } }
+	};
+
+	std::vector<FREE_IMAGE_SIMD> levels{ FISIMD_NONE };
+	for (FREE_IMAGE_SIMD level : { FISIMD_SSSE3, FISIMD_AVX2, FISIMD_NEON }) {
+		if (FreeImage_SetSIMDLevel(level)) {
+			levels.push_back(level);
+		}
+	}
+
+	const int width = 1920;
+	const int height = 1080;
+	std::vector<uint8_t> source((size_t)width * 4);
+	std::vector<uint8_t> target((size_t)width * 4);
+	for (auto& value : source) {
+		value = (uint8_t)nextRandom(seed);
+	}
+
+	for (const auto& conversion : conversions) {
+		printf("%-10s :", conversion.first);
+		for (FREE_IMAGE_SIMD level : levels) {
+			FreeImage_SetSIMDLevel(level);
+			const auto start = std::chrono::steady_clock::now();
+			for (int y = 0; y < height; y++) {
+				conversion.second(target.data(), source.data(), width);
+			}
+			printf(" level %d %.3f ms", (int)level, elapsedMs(start));
+		}
+		printf("\n");
+	}
+
+	FreeImage_SetSIMDLevel(initial_level);
+}
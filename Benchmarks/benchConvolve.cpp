@@ -0,0 +1,55 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include <cmath>
+#include <vector>
+
+// ----------------------------------------------------------
+
+/**
+Speed of a separable and a full convolution kernel, and of a large erosion, on a 1920x1080 frame
+*/
+void benchConvolve() {
+	UniqueBitmap frame(FreeImage_Allocate(1920, 1080, 24), &::FreeImage_Unload);
+	fillRandom(frame.get(), 4);
+
+	// a rank one kernel is applied as two passes
+	std::vector<double> gaussian(15 * 15);
+	for (int y = 0; y < 15; y++) {
+		for (int x = 0; x < 15; x++) {
+			gaussian[y * 15 + x] = std::exp(-((x - 7) * (x - 7) + (y - 7) * (y - 7)) / 18.0);
+		}
+	}
+	std::vector<double> laplacian(5 * 5, -1);
+	laplacian[12] = 24;
+	laplacian[0] = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap separable(FreeImage_Convolve(frame.get(), gaussian.data(), 15, 15), &::FreeImage_Unload);
+	const double separable_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap full(FreeImage_Convolve(frame.get(), laplacian.data(), 5, 5), &::FreeImage_Unload);
+	const double full_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap eroded(FreeImage_Erode(frame.get(), 31, 31), &::FreeImage_Unload);
+	const double erode_ms = elapsedMs(start);
+	assert(separable && full && eroded);
+	printf("1920x1080 24-bit : 15x15 separable convolution %.3f ms, 5x5 convolution %.3f ms, 31x31 erosion %.3f ms\n", separable_ms, full_ms, erode_ms);
+}
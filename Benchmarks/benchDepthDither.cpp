@@ -0,0 +1,48 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Speed of the RGB16 to 24-bit conversion for every depth dithering mode, on a 1920x1080 gradient
+*/
+void benchDepthDither() {
+	const unsigned width = 1920, height = 1080;
+	UniqueBitmap src(FreeImage_AllocateT(FIT_RGB16, width, height), &::FreeImage_Unload);
+	assert(src != nullptr);
+	for (unsigned y = 0; y < height; y++) {
+		FIRGB16 *pixel = (FIRGB16*)FreeImage_GetScanLine(src.get(), y);
+		for (unsigned x = 0; x < width; x++) {
+			pixel[x].red = (uint16_t)(65535 * x / width);
+			pixel[x].green = (uint16_t)(65535 * y / height);
+			pixel[x].blue = 32768;
+		}
+	}
+
+	double ms[3] = {};
+	for (FREE_IMAGE_DEPTH_DITHER dither : { FIDD_NONE, FIDD_ORDERED, FIDD_FLOYD_STEINBERG }) {
+		const auto start = std::chrono::steady_clock::now();
+		UniqueBitmap dst(FreeImage_ConvertToStandardTypeEx(src.get(), TRUE, dither), &::FreeImage_Unload);
+		ms[dither] = elapsedMs(start);
+		assert(dst != nullptr);
+	}
+	printf("1920x1080 RGB16 to 24-bit : rounding %.3f ms, ordered %.3f ms, Floyd-Steinberg %.3f ms\n", ms[0], ms[1], ms[2]);
+}
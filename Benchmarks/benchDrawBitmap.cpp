@@ -0,0 +1,40 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Speed of a 32-bit watermark drawn over a 1920x1080 frame, for a few blending operations
+*/
+void benchDrawBitmap() {
+	UniqueBitmap mark(FreeImage_Allocate(1920, 1080, 32), &::FreeImage_Unload);
+	UniqueBitmap frame(FreeImage_Allocate(1920, 1080, 24), &::FreeImage_Unload);
+	fillRandom(mark.get(), 6);
+	fillRandom(frame.get(), 7);
+	const FREE_IMAGE_ALPHA_OPERATION ops[] = { FIAO_SrcOver, FIAO_Multiply, FIAO_Overlay };
+	for (FREE_IMAGE_ALPHA_OPERATION op : ops) {
+		const auto start = std::chrono::steady_clock::now();
+		FIBOOL bSuccess = FreeImage_DrawBitmap(frame.get(), mark.get(), op, 0, 0);
+		const double ms = elapsedMs(start);
+		assert(bSuccess);
+		printf("1920x1080 32-bit over 24-bit, operation %d : %.3f ms\n", (int)op, ms);
+	}
+}
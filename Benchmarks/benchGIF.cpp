@@ -0,0 +1,116 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include "ReferenceLZW.h"
+
+// ----------------------------------------------------------
+
+/**
+Encode a frame to GIF in memory and decode it back.
+Returns the mean encode and decode times (in ms) through the output parameters.
+*/
+static void
+timeGIF(FIBITMAP *dib, int iterations, double *encode_ms, double *decode_ms, size_t *encoded_size) {
+	UniqueMemory hmem(nullptr, &::FreeImage_CloseMemory);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		hmem.reset(FreeImage_OpenMemory());
+		FIBOOL bSuccess = FreeImage_SaveToMemory(FIF_GIF, dib, hmem.get(), 0);
+		assert(bSuccess);
+	}
+	*encode_ms = elapsedMs(start) / iterations;
+	*encoded_size = (size_t)FreeImage_TellMemory(hmem.get());
+
+	UniqueBitmap loaded(nullptr, &::FreeImage_Unload);
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		FreeImage_SeekMemory(hmem.get(), 0, SEEK_SET);
+		loaded.reset(FreeImage_LoadFromMemory(FIF_GIF, hmem.get(), 0));
+		assert(loaded != nullptr);
+	}
+	*decode_ms = elapsedMs(start) / iterations;
+}
+
+/**
+Mean time (in ms) of the LZW encoding of a frame by the string table encoder the GIF writer used before
+*/
+static double
+timeReferenceLZW(FIBITMAP *dib, int iterations) {
+	size_t encoded_size = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		encoded_size += encodeReferenceLZW(dib, false).size();
+	}
+	const double ms = elapsedMs(start) / iterations;
+	assert(encoded_size > 0);
+	return ms;
+}
+
+// ----------------------------------------------------------
+
+void benchGIF(const char *lpszPathName) {
+	double encode_ms = 0, decode_ms = 0;
+	size_t encoded_size = 0;
+
+	// every page of a real world file
+	{
+		FIMULTIBITMAP *src = FreeImage_OpenMultiBitmap(FIF_GIF, lpszPathName, FALSE, TRUE, TRUE, 0);
+		assert(src != nullptr);
+		const int count = FreeImage_GetPageCount(src);
+		double total_encode = 0, total_decode = 0, total_reference = 0;
+		for (int page = 0; page < count; page++) {
+			FIBITMAP *dib = FreeImage_LockPage(src, page);
+			assert(dib != nullptr);
+			timeGIF(dib, 20, &encode_ms, &decode_ms, &encoded_size);
+			total_reference += timeReferenceLZW(dib, 20);
+			total_encode += encode_ms;
+			total_decode += decode_ms;
+			FreeImage_UnlockPage(src, dib, FALSE);
+		}
+		FreeImage_CloseMultiBitmap(src, 0);
+		printf("%s : %d pages, encode %.3f ms (old string table %.3f ms), decode %.3f ms\n", lpszPathName, count, total_encode, total_reference, total_decode);
+	}
+
+	// full HD animation frames, at every bit depth supported by the GIF writer
+	{
+		const unsigned width = 1920;
+		const unsigned height = 1080;
+		const int frames = 4;
+		for (unsigned bpp : { 8, 4, 1 }) {
+			double total_encode = 0, total_decode = 0, total_reference = 0;
+			size_t total_size = 0;
+			for (int frame = 0; frame < frames; frame++) {
+				UniqueBitmap dib(createAnimationFrame(width, height, frame), &::FreeImage_Unload);
+				if (bpp == 4) {
+					dib.reset(FreeImage_ConvertTo4Bits(dib.get()));
+				} else if (bpp == 1) {
+					dib.reset(FreeImage_Threshold(dib.get(), 128));
+				}
+				assert(dib != nullptr);
+				timeGIF(dib.get(), 2, &encode_ms, &decode_ms, &encoded_size);
+				total_reference += timeReferenceLZW(dib.get(), 2);
+				total_encode += encode_ms;
+				total_decode += decode_ms;
+				total_size += encoded_size;
+			}
+			printf("%ux%u, %u-bit, %d frames : %zu bytes, encode %.3f ms (old string table %.3f ms), decode %.3f ms\n", width, height, bpp, frames, total_size, total_encode, total_reference, total_decode);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include <cstring>
+#include <vector>
+
+// ----------------------------------------------------------
+
+/**
+Speed and size of the PNG encoder presets on a screenshot-like image
+*/
+void benchPNGEncode() {
+	const int presets[] = { 
+		PNG_DEFAULT, PNG_ENCODE_FAST, PNG_ENCODE_SMALL, 
+		PNG_ENCODE_PARALLEL, PNG_ENCODE_PARALLEL | PNG_ENCODE_FAST, PNG_ENCODE_PARALLEL | PNG_ENCODE_SMALL, 
+		PNG_ENCODE_PARALLEL | PNG_Z_BEST_COMPRESSION 
+	};
+
+	UniqueBitmap rgba(createScreenshot(1920, 1080), &::FreeImage_Unload);
+	UniqueBitmap rgb(FreeImage_ConvertTo24Bits(rgba.get()), &::FreeImage_Unload);
+	for (FIBITMAP *dib : { rgb.get(), rgba.get() }) {
+		for (int flags : presets) {
+			UniqueMemory hmem(FreeImage_OpenMemory(), &::FreeImage_CloseMemory);
+			auto start = std::chrono::steady_clock::now();
+			FIBOOL bSuccess = FreeImage_SaveToMemory(FIF_PNG, dib, hmem.get(), flags);
+			assert(bSuccess);
+			const double encode_ms = elapsedMs(start);
+			printf("1920x1080 %u-bit, flags 0x%04X : %u bytes, encode %.3f ms\n", FreeImage_GetBPP(dib), flags, (unsigned)FreeImage_TellMemory(hmem.get()), encode_ms);
+		}
+	}
+}
+
+
+/**
+Scanline consumer : copy the streamed rows into a single buffer
+*/
+static FIBOOL DLL_CALLCONV
+copyScanline(FIBITMAP *header, unsigned y, const uint8_t *bits, void *user_data) {
+	auto *buffer = static_cast<std::vector<uint8_t>*>(user_data);
+	const unsigned pitch = FreeImage_GetLine(header);
+	if (buffer->empty()) {
+		buffer->resize((size_t)pitch * FreeImage_GetHeight(header));
+	}
+	memcpy(buffer->data() + (size_t)y * pitch, bits, pitch);
+	return TRUE;
+}
+
+/**
+Speed of a full decode versus streaming and downscaling on load
+*/
+void benchPNGDecode() {
+	const char *lpszPathName = "bench.png";
+
+	UniqueBitmap large(createScreenshot(1920, 1080), &::FreeImage_Unload);
+	FIBOOL bSuccess = FreeImage_Save(FIF_PNG, large.get(), lpszPathName, 0);
+	assert(bSuccess);
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap full(FreeImage_Load(FIF_PNG, lpszPathName, 0), &::FreeImage_Unload);
+	const double load_ms = elapsedMs(start);
+	assert(full != nullptr);
+
+	std::vector<uint8_t> buffer;
+	start = std::chrono::steady_clock::now();
+	bSuccess = FreeImage_LoadScanlines(FIF_PNG, lpszPathName, copyScanline, &buffer, 0);
+	const double stream_ms = elapsedMs(start);
+	assert(bSuccess);
+
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap thumbnail(FreeImage_Load(FIF_PNG, lpszPathName, 256 << 16), &::FreeImage_Unload);
+	const double thumbnail_ms = elapsedMs(start);
+	assert(thumbnail != nullptr);
+
+	printf("1920x1080 32-bit : load %.3f ms, stream %.3f ms, thumbnail %ux%u %.3f ms\n", load_ms, stream_ms, FreeImage_GetWidth(thumbnail.get()), FreeImage_GetHeight(thumbnail.get()), thumbnail_ms);
+}
+
+/**
+Convert a GIF animation to APNG in memory, then decode every frame
+*/
+void benchAPNG(const char *lpszPathName) {
+	FIMULTIBITMAP *gif = FreeImage_OpenMultiBitmap(FIF_GIF, lpszPathName, FALSE, TRUE, TRUE, GIF_PLAYBACK);
+	assert(gif != nullptr);
+	const int count = FreeImage_GetPageCount(gif);
+
+	UniqueMemory hmem(FreeImage_OpenMemory(), &::FreeImage_CloseMemory);
+	auto start = std::chrono::steady_clock::now();
+	FIBOOL bSuccess = FreeImage_SaveMultiBitmapToMemory(FIF_PNG, gif, hmem.get(), 0);
+	assert(bSuccess);
+	const double encode_ms = elapsedMs(start);
+
+	FreeImage_SeekMemory(hmem.get(), 0, SEEK_SET);
+	FIMULTIBITMAP *apng = FreeImage_LoadMultiBitmapFromMemory(FIF_PNG, hmem.get(), 0);
+	assert(apng != nullptr);
+
+	start = std::chrono::steady_clock::now();
+	for (int page = 0; page < count; page++) {
+		FIBITMAP *dst = FreeImage_LockPage(apng, page);
+		assert(dst != nullptr);
+		FreeImage_UnlockPage(apng, dst, FALSE);
+	}
+	const double decode_ms = elapsedMs(start);
+
+	FreeImage_CloseMultiBitmap(apng, 0);
+	FreeImage_CloseMultiBitmap(gif, 0);
+
+	printf("%s -> APNG : %d frames, %u bytes, encode %.3f ms, decode %.3f ms\n", lpszPathName, count, (unsigned)FreeImage_TellMemory(hmem.get()), encode_ms, decode_ms);
+}
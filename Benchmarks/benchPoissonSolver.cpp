@@ -0,0 +1,89 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// ----------------------------------------------------------
+
+/**
+Value of a /proc/self/status field in MB, 0 when not available
+*/
+static double
+statusMB(const char *field) {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (line.compare(0, strlen(field), field) == 0) {
+			return std::atof(line.c_str() + strlen(field) + 1) / 1024;
+		}
+	}
+	return 0;
+}
+
+/**
+Run a solver, and print its runtime and peak memory (the peak is measured on Linux only)
+*/
+template <typename Solver_>
+static void
+timeSolver(const char *name, FIBITMAP *L, Solver_ solver) {
+	const double resident = statusMB("VmRSS:");
+	{
+		// reset the peak resident size
+		std::ofstream clear_refs("/proc/self/clear_refs");
+		clear_refs << "5";
+	}
+	const auto start = std::chrono::steady_clock::now();
+	UniqueBitmap U(solver(L), &::FreeImage_Unload);
+	const double elapsed = elapsedMs(start);
+	assert(U != nullptr);
+	const double peak = statusMB("VmHWM:");
+	if (peak > 0) {
+		printf("%ux%u %s : %.3f ms, peak memory %.1f MB\n", FreeImage_GetWidth(L), FreeImage_GetHeight(L), name, elapsed, peak - resident);
+	} else {
+		printf("%ux%u %s : %.3f ms\n", FreeImage_GetWidth(L), FreeImage_GetHeight(L), name, elapsed);
+	}
+}
+
+/**
+Runtime and peak memory of the DCT and multigrid Poisson solvers on a 1920x1080 domain
+*/
+void benchPoissonSolver() {
+	const unsigned width = 1920, height = 1080;
+
+	// Laplacian of a smooth separable function
+	UniqueBitmap L(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+	assert(L != nullptr);
+	for (unsigned y = 0; y < height; y++) {
+		float *bits = (float*)FreeImage_GetScanLine(L.get(), y);
+		const double v = (y + 0.5) / height;
+		for (unsigned x = 0; x < width; x++) {
+			const double u = (x + 0.5) / width;
+			bits[x] = (float)(-13e-6 * std::cos(3 * u) * std::cos(2 * v));
+		}
+	}
+
+	// the DCT solver runs first, as memory released by the first solver may be reused by the second one
+	timeSolver("DCT Poisson solver", L.get(), [](FIBITMAP *dib) { return FreeImage_DCTPoissonSolver(dib); });
+	timeSolver("multigrid Poisson solver", L.get(), [](FIBITMAP *dib) { return FreeImage_MultigridPoissonSolver(dib, 3); });
+}
@@ -0,0 +1,56 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Speed of the alpha premultiplication, its inverse and the background compositing on 1920x1080 frames
+*/
+void benchPreMultiplyWithAlpha() {
+	UniqueBitmap frame(FreeImage_Allocate(1920, 1080, 32), &::FreeImage_Unload);
+	UniqueBitmap frame16(FreeImage_AllocateT(FIT_RGBA16, 1920, 1080), &::FreeImage_Unload);
+	fillRandom(frame.get(), 8);
+	fillRandom(frame16.get(), 9);
+
+	auto start = std::chrono::steady_clock::now();
+	FIBOOL bSuccess = FreeImage_PreMultiplyWithAlpha(frame.get());
+	const double premultiply = elapsedMs(start);
+	assert(bSuccess);
+	start = std::chrono::steady_clock::now();
+	bSuccess = FreeImage_UnPreMultiplyWithAlpha(frame.get());
+	const double unpremultiply = elapsedMs(start);
+	assert(bSuccess);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap composite(FreeImage_Composite(frame.get()), &::FreeImage_Unload);
+	const double compose = elapsedMs(start);
+	assert(composite != nullptr);
+	printf("1920x1080 32-bit : premultiply %.3f ms, unpremultiply %.3f ms, composite %.3f ms\n", premultiply, unpremultiply, compose);
+
+	start = std::chrono::steady_clock::now();
+	bSuccess = FreeImage_PreMultiplyWithAlpha(frame16.get());
+	const double premultiply16 = elapsedMs(start);
+	assert(bSuccess);
+	start = std::chrono::steady_clock::now();
+	bSuccess = FreeImage_UnPreMultiplyWithAlpha(frame16.get());
+	const double unpremultiply16 = elapsedMs(start);
+	assert(bSuccess);
+	printf("1920x1080 RGBA16 : premultiply %.3f ms, unpremultiply %.3f ms\n", premultiply16, unpremultiply16);
+}
@@ -0,0 +1,60 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Speed of the Wu and NeuQuant color quantizers on a 1920x1080 screenshot-like image
+*/
+void benchQuantize() {
+	UniqueBitmap rgba(createScreenshot(1920, 1080), &::FreeImage_Unload);
+	UniqueBitmap src(FreeImage_ConvertTo24Bits(rgba.get()), &::FreeImage_Unload);
+	assert(src != nullptr);
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap wu(FreeImage_ColorQuantize(src.get(), FIQ_WUQUANT), &::FreeImage_Unload);
+	const double wu_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap nn(FreeImage_ColorQuantize(src.get(), FIQ_NNQUANT), &::FreeImage_Unload);
+	const double nn_ms = elapsedMs(start);
+	assert(wu != nullptr && nn != nullptr);
+	printf("1920x1080 24-bit to 8-bit : Wu %.3f ms, NeuQuant %.3f ms\n", wu_ms, nn_ms);
+}
+
+/**
+Speed of the palette mapping, without and with error diffusion, on a 1920x1080 screenshot-like image
+*/
+void benchMapToPalette() {
+	UniqueBitmap rgba(createScreenshot(1920, 1080), &::FreeImage_Unload);
+	UniqueBitmap src(FreeImage_ConvertTo24Bits(rgba.get()), &::FreeImage_Unload);
+	UniqueBitmap wu(FreeImage_ColorQuantize(src.get(), FIQ_WUQUANT), &::FreeImage_Unload);
+	assert(wu != nullptr);
+	const FIRGBA8 *palette = FreeImage_GetPalette(wu.get());
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap mapped(FreeImage_MapToPalette(src.get(), palette, 256), &::FreeImage_Unload);
+	const double map_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap dithered(FreeImage_MapToPalette(src.get(), palette, 256, FIDF_FLOYD_STEINBERG), &::FreeImage_Unload);
+	const double dither_ms = elapsedMs(start);
+	assert(mapped != nullptr && dithered != nullptr);
+	printf("1920x1080 24-bit to 256 colors : map %.3f ms, Floyd-Steinberg %.3f ms\n", map_ms, dither_ms);
+}
@@ -0,0 +1,39 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Speed of a 4000x3000 to 400x300 thumbnail, with and without linear light filtering
+*/
+void benchRescaleLinearLight() {
+	UniqueBitmap photo(FreeImage_Allocate(4000, 3000, 24), &::FreeImage_Unload);
+	fillRandom(photo.get(), 10);
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap direct(FreeImage_Rescale(photo.get(), 400, 300, FILTER_CATMULLROM), &::FreeImage_Unload);
+	const double direct_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap linear(FreeImage_RescaleRect(photo.get(), 400, 300, 0, 0, 4000, 3000, FILTER_CATMULLROM, FI_RESCALE_LINEAR_LIGHT), &::FreeImage_Unload);
+	const double linear_ms = elapsedMs(start);
+	assert(direct && linear);
+	printf("4000x3000 24-bit to 400x300 : %.3f ms, linear light %.3f ms\n", direct_ms, linear_ms);
+}
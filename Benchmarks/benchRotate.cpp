@@ -0,0 +1,40 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+
+// ----------------------------------------------------------
+
+/**
+Speed of the 90 degree rotation and of the transposition of 1920x1080 frames
+*/
+void benchRotate() {
+	for (unsigned bpp : { 24U, 32U }) {
+		UniqueBitmap src(FreeImage_Allocate(1920, 1080, bpp), &::FreeImage_Unload);
+		fillRandom(src.get(), bpp);
+		auto start = std::chrono::steady_clock::now();
+		UniqueBitmap rotated(FreeImage_Rotate(src.get(), 90), &::FreeImage_Unload);
+		const double rotate_ms = elapsedMs(start);
+		start = std::chrono::steady_clock::now();
+		UniqueBitmap transposed(FreeImage_Transpose(src.get()), &::FreeImage_Unload);
+		const double transpose_ms = elapsedMs(start);
+		assert(rotated != nullptr && transposed != nullptr);
+		printf("1920x1080 %u-bit : rotate 90 %.3f ms, transpose %.3f ms\n", bpp, rotate_ms, transpose_ms);
+	}
+}
@@ -0,0 +1,64 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include <cmath>
+
+// ----------------------------------------------------------
+
+/**
+RGBF frame spanning about 12 stops from left to right, with pseudo random colors
+*/
+static FIBITMAP*
+createHDRFrame(unsigned width, unsigned height) {
+	FIBITMAP *dib = FreeImage_AllocateT(FIT_RGBF, width, height);
+	assert(dib != nullptr);
+	unsigned seed = 7;
+	for (unsigned y = 0; y < height; y++) {
+		FIRGBF *pixel = (FIRGBF*)FreeImage_GetScanLine(dib, y);
+		for (unsigned x = 0; x < width; x++) {
+			const double level = std::exp(-4 + 8.0 * x / width);
+			pixel[x].red = (float)(level * (0.2 + nextRandom(seed) / 32767.0));
+			pixel[x].green = (float)(level * (0.2 + nextRandom(seed) / 32767.0));
+			pixel[x].blue = (float)(level * (0.2 + nextRandom(seed) / 32767.0));
+		}
+	}
+	return dib;
+}
+
+/**
+Speed of the Drago03 and Reinhard05 (global and local) operators on a 1920x1080 frame
+*/
+void benchToneMapping() {
+	UniqueBitmap frame(createHDRFrame(1920, 1080), &::FreeImage_Unload);
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap drago(FreeImage_TmoDrago03(frame.get(), 2.2, 0), &::FreeImage_Unload);
+	const double drago_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap global(FreeImage_TmoReinhard05(frame.get(), 0, 0), &::FreeImage_Unload);
+	const double global_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap local(FreeImage_TmoReinhard05Ex(frame.get(), 0, 0, 0.5, 0.5), &::FreeImage_Unload);
+	const double local_ms = elapsedMs(start);
+	assert(drago && global && local);
+
+	printf("1920x1080 RGBF Drago03 : %.3f ms\n", drago_ms);
+	printf("1920x1080 RGBF Reinhard05 : global %.3f ms, local %.3f ms\n", global_ms, local_ms);
+}
@@ -0,0 +1,89 @@
+// ==========================================================
+// FreeImage 3 Benchmark Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "BenchmarkSuite.h"
+#include <cmath>
+
+// ----------------------------------------------------------
+
+/**
+Speed of the deskew of a 1920x1080 page by 2 degrees, in 24-bit and 8-bit greyscale
+*/
+void benchWarpAffine() {
+	UniqueBitmap rgb(FreeImage_Allocate(1920, 1080, 24), &::FreeImage_Unload);
+	UniqueBitmap grey(FreeImage_Allocate(1920, 1080, 8), &::FreeImage_Unload);
+	fillRandom(rgb.get(), 12);
+	fillRandom(grey.get(), 13);
+	FIRGBA8 *palette = FreeImage_GetPalette(grey.get());
+	for (unsigned i = 0; i < 256; i++) {
+		palette[i].red = palette[i].green = palette[i].blue = (uint8_t)i;
+	}
+
+	// rotation about the center of the page
+	const double angle = 2 * 3.14159265358979 / 180;
+	const double matrix[6] = { cos(angle), sin(angle), -540 * sin(angle), -sin(angle), cos(angle), 960 * sin(angle) };
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap bilinear(FreeImage_WarpAffine(rgb.get(), matrix, 1920, 1080, FILTER_BILINEAR), &::FreeImage_Unload);
+	const double bilinear_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap bicubic(FreeImage_WarpAffine(rgb.get(), matrix, 1920, 1080, FILTER_CATMULLROM), &::FreeImage_Unload);
+	const double bicubic_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap grey_bilinear(FreeImage_WarpAffine(grey.get(), matrix, 1920, 1080, FILTER_BILINEAR), &::FreeImage_Unload);
+	const double grey_ms = elapsedMs(start);
+	assert(bilinear != nullptr && bicubic != nullptr && grey_bilinear != nullptr);
+	printf("1920x1080 deskew : 24-bit bilinear %.3f ms, 24-bit Catmull-Rom %.3f ms, 8-bit bilinear %.3f ms\n", bilinear_ms, bicubic_ms, grey_ms);
+}
+
+/**
+Speed of a radial lens undistortion of a 1920x1080 frame, with floating point and fixed point maps
+*/
+void benchRemap() {
+	const unsigned width = 1920, height = 1080;
+	UniqueBitmap src(FreeImage_Allocate(width, height, 24), &::FreeImage_Unload);
+	fillRandom(src.get(), 14);
+
+	UniqueBitmap map_x(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+	UniqueBitmap map_y(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+	const double cx = (width - 1) / 2.0, cy = (height - 1) / 2.0, k1 = -0.08;
+	for (unsigned y = 0; y < height; y++) {
+		float *mx = (float*)FreeImage_GetScanLine(map_x.get(), height - 1 - y);
+		float *my = (float*)FreeImage_GetScanLine(map_y.get(), height - 1 - y);
+		for (unsigned x = 0; x < width; x++) {
+			const double nx = (x - cx) / cx, ny = (y - cy) / cx;
+			const double r = 1 + k1 * (nx * nx + ny * ny);
+			mx[x] = (float)(cx + nx * r * cx);
+			my[x] = (float)(cy + ny * r * cx);
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	UniqueBitmap remapped(FreeImage_Remap(src.get(), map_x.get(), map_y.get()), &::FreeImage_Unload);
+	const double remap_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap fixed_x(FreeImage_ConvertRemapMap(map_x.get()), &::FreeImage_Unload);
+	UniqueBitmap fixed_y(FreeImage_ConvertRemapMap(map_y.get()), &::FreeImage_Unload);
+	const double convert_ms = elapsedMs(start);
+	start = std::chrono::steady_clock::now();
+	UniqueBitmap fixed(FreeImage_Remap(src.get(), fixed_x.get(), fixed_y.get()), &::FreeImage_Unload);
+	const double fixed_ms = elapsedMs(start);
+	assert(remapped != nullptr && fixed != nullptr);
+	printf("1920x1080 24-bit undistortion : float maps %.3f ms, fixed maps %.3f ms (conversion %.3f ms)\n", remap_ms, fixed_ms, convert_ms);
+}
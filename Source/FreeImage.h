@@ -370,6 +370,20 @@ FI_STRUCT (FIICCPROFILE) {
 	void   *data;	//! points to a block of contiguous memory containing the profile
 };
 
+// Image statistics ---------------------------------------------------------
+
+/** Per channel statistics of an image, see FreeImage_GetStatistics.
+Channels are red, green, blue and alpha for color images, the value for one channel images.
+*/
+FI_STRUCT (FISTATISTICS) {
+	uint32_t channels;	//! number of channels of the image
+	double min[4];		//! smallest value per channel
+	double max[4];		//! largest value per channel
+	double mean[4];		//! mean value per channel
+	double stddev[4];	//! standard deviation per channel
+	uint64_t count[4];	//! number of values per channel, NaN values are not counted
+};
+
 // Important enums ----------------------------------------------------------
 
 /**
@@ -479,6 +493,24 @@ FI_ENUM(FREE_IMAGE_DITHER) {
 	FID_BAYER16x16	= 6		//! Bayer ordered dispersed dot dithering (order 4 dithering matrix)
 };
 
+/** Color error diffusion algorithms.
+Constants used in FreeImage_MapToPalette.
+*/
+FI_ENUM(FREE_IMAGE_DIFFUSION) {
+	FIDF_NONE				= 0,	//! no dithering, nearest palette entry
+	FIDF_FLOYD_STEINBERG	= 1,	//! Floyd & Steinberg error diffusion, serpentine scan
+	FIDF_SIERRA_LITE		= 2		//! Sierra Lite (Sierra-2-4A) error diffusion, serpentine scan
+};
+
+/** Dithering of a bit depth reduction to 8-bit per channel.
+Constants used in FreeImage_ConvertToStandardTypeEx and FreeImage_ToneMappingEx.
+*/
+FI_ENUM(FREE_IMAGE_DEPTH_DITHER) {
+	FIDD_NONE				= 0,	//! rounding to the nearest value
+	FIDD_ORDERED			= 1,	//! ordered dithering (16x16 Bayer matrix)
+	FIDD_FLOYD_STEINBERG	= 2		//! Floyd & Steinberg error diffusion, serpentine scan
+};
+
 /** Lossless JPEG transformations
 Constants used in FreeImage_JPEGTransform
 */
@@ -493,6 +525,35 @@ FI_ENUM(FREE_IMAGE_JPEG_OPERATION) {
 	FIJPEG_OP_ROTATE_270	= 7		//! 270-degree clockwise (or 90 ccw)
 };
 
+/** Steps of a lossless JPEG transform pipeline.
+Constants used in FIJPEGSTEP
+*/
+FI_ENUM(FREE_IMAGE_JPEG_STEP) {
+	FIJPEG_STEP_TRANSFORM	= 0,	//! transformation given by the operation of the step
+	FIJPEG_STEP_CROP		= 1,	//! crop to the rectangle of the step
+	FIJPEG_STEP_GRAYSCALE	= 2,	//! drop the color components
+	FIJPEG_STEP_AUTO_ORIENT	= 3		//! transformation given by the Exif orientation of the source, reset to 1 in the output
+};
+
+/** Extra markers (Exif, ICC profile, comments, ...) copied by a lossless JPEG transform pipeline.
+Constants used in FreeImage_JPEGTransformPipeline
+*/
+FI_ENUM(FREE_IMAGE_JPEG_MARKERS) {
+	FIJPEG_MARKERS_ALL			= 0,	//! copy all the extra markers
+	FIJPEG_MARKERS_NONE			= 1,	//! copy no extra marker
+	FIJPEG_MARKERS_ORIENTATION	= 2		//! copy the ICC profile and an Exif marker reduced to the orientation
+};
+
+/** Step of a lossless JPEG transform pipeline, see FreeImage_JPEGTransformPipeline.
+The crop rectangle is given in the coordinates of the image transformed by the previous steps,
+with the conventions of FreeImage_JPEGCrop.
+*/
+FI_STRUCT (FIJPEGSTEP) {
+	FREE_IMAGE_JPEG_STEP type;				//! step type
+	FREE_IMAGE_JPEG_OPERATION operation;	//! transformation of a FIJPEG_STEP_TRANSFORM step
+	int left, top, right, bottom;			//! crop rectangle of a FIJPEG_STEP_CROP step
+};
+
 /** Tone mapping operators.
 Constants used in FreeImage_ToneMapping.
 */
@@ -516,6 +577,16 @@ FI_ENUM(FREE_IMAGE_FILTER) {
 	FILTER_LANCZOS3	  = 5	//! Lanczos3 filter
 };
 
+/** Border modes.
+Constants used in FreeImage_Convolve, for the pixels outside of the image.
+*/
+FI_ENUM(FREE_IMAGE_BORDER_MODE) {
+	FIBM_CLAMP	= 0,	//! Repeat the edge pixels (aaa|abcd|ddd)
+	FIBM_MIRROR	= 1,	//! Mirror the image at its edges, without repeating the edge pixels (dcb|abcd|cba)
+	FIBM_WRAP	= 2,	//! Repeat the image (bcd|abcd|abc)
+	FIBM_ZERO	= 3		//! Pixels outside of the image are zero (000|abcd|000)
+};
+
 /** Color channels.
 Constants used in color manipulation routines.
 */
@@ -532,6 +603,16 @@ FI_ENUM(FREE_IMAGE_COLOR_CHANNEL) {
 	FICC_PHASE	= 9		//! Complex images: use phase
 };
 
+/** SIMD instruction sets.
+Constants used in FreeImage_GetSIMDLevel / FreeImage_SetSIMDLevel.
+*/
+FI_ENUM(FREE_IMAGE_SIMD) {
+	FISIMD_NONE		= 0,	//! Use scalar code only
+	FISIMD_SSSE3	= 1,	//! Use x86 SSSE3 instructions
+	FISIMD_AVX2		= 2,	//! Use x86 AVX2 instructions (and SSSE3 where no AVX2 code exists)
+	FISIMD_NEON		= 3		//! Use ARM NEON instructions
+};
+
 // Metadata support ---------------------------------------------------------
 
 /**
@@ -647,6 +728,8 @@ typedef FIBOOL (DLL_CALLCONV *FI_SupportsExportBPPProc)(int bpp);
 typedef FIBOOL (DLL_CALLCONV *FI_SupportsExportTypeProc)(FREE_IMAGE_TYPE type);
 typedef FIBOOL (DLL_CALLCONV *FI_SupportsICCProfilesProc)(void);
 typedef FIBOOL (DLL_CALLCONV *FI_SupportsNoPixelsProc)(void);
+typedef FIBOOL (DLL_CALLCONV *FI_ScanlineProc)(FIBITMAP *dib, unsigned y, const uint8_t *bits, void *user_data);
+typedef FIBOOL (DLL_CALLCONV *FI_LoadScanlinesProc)(FreeImageIO *io, fi_handle handle, int flags, FI_ScanlineProc scanline_proc, void *user_data);
 
 FI_STRUCT (Plugin) {
 	FI_FormatProc format_proc FI_DEFAULT(NULL);
@@ -665,6 +748,9 @@ FI_STRUCT (Plugin) {
 	FI_SupportsExportTypeProc supports_export_type_proc FI_DEFAULT(NULL);
 	FI_SupportsICCProfilesProc supports_icc_profiles_proc FI_DEFAULT(NULL);
 	FI_SupportsNoPixelsProc supports_no_pixels_proc FI_DEFAULT(NULL);
+	FI_OpenProc open_persistent_proc FI_DEFAULT(NULL);
+	FI_CloseProc close_persistent_proc FI_DEFAULT(NULL);
+	FI_LoadScanlinesProc load_scanlines_proc FI_DEFAULT(NULL);
 };
 
 typedef void (DLL_CALLCONV *FI_InitProc)(Plugin *plugin, int format_id);
@@ -794,11 +880,16 @@ FI_STRUCT (FIDEPENDENCY) {
 #define PICT_DEFAULT        0
 #define PNG_DEFAULT         0
 #define PNG_IGNOREGAMMA		1		//! loading: avoid gamma correction
+#define PNG_LOAD_8BIT				0x0002	//! loading: scale 16-bit samples down to 8-bit and return a standard bitmap
+#define PNG_LOAD_RGBA				0x0004	//! loading: expand any color type to RGBA (FIT_BITMAP 32-bit or FIT_RGBA16)
 #define PNG_Z_BEST_SPEED			0x0001	//! save using ZLib level 1 compression flag (default value is 6)
 #define PNG_Z_DEFAULT_COMPRESSION	0x0006	//! save using ZLib level 6 compression flag (default recommended value)
 #define PNG_Z_BEST_COMPRESSION		0x0009	//! save using ZLib level 9 compression flag (default value is 6)
 #define PNG_Z_NO_COMPRESSION		0x0100	//! save without ZLib compression
 #define PNG_INTERLACED				0x0200	//! save using Adam7 interlacing (use | to combine with other save flags)
+#define PNG_ENCODE_FAST				0x0400	//! save using a single row filter and run-length ZLib compression (level 1 unless a PNG_Z_* level is set)
+#define PNG_ENCODE_SMALL			0x0800	//! save using the best filter for each row (ZLib level 9 unless a PNG_Z_* level is set)
+#define PNG_ENCODE_PARALLEL			0x1000	//! save using multi-threaded compression of row groups (use | to combine with other save flags)
 #define PNM_DEFAULT         0
 #define PNM_SAVE_RAW        0       //! if set the writer saves in RAW format (i.e. P4, P5 or P6)
 #define PNM_SAVE_ASCII      1       //! if set the writer saves in ASCII format (i.e. P1, P2 or P3)
@@ -834,6 +925,18 @@ FI_STRUCT (FIDEPENDENCY) {
 #define XPM_DEFAULT			0
 #define WEBP_DEFAULT		0		//! save with good quality (75:1)
 #define WEBP_LOSSLESS		0x100	//! save in lossless mode
+#define WEBP_MULTITHREAD	0x0200	//! save using multi-threaded encoding (use | to combine with other save flags)
+#define WEBP_ANIM_MINSIZE	0x0400	//! save a multipage bitmap as the smallest possible animation (slower)
+#define WEBP_ANIM_ALLKEYFRAMES	0x0800	//! save a multipage bitmap as an animation where every frame is a keyframe (faster random access)
+#define WEBP_METHOD_0		0x1000	//! save with encoding method 0 (fastest, biggest file)
+#define WEBP_METHOD_1		0x2000	//! save with encoding method 1
+#define WEBP_METHOD_2		0x3000	//! save with encoding method 2
+#define WEBP_METHOD_3		0x4000	//! save with encoding method 3
+#define WEBP_METHOD_4		0x5000	//! save with encoding method 4
+#define WEBP_METHOD_5		0x6000	//! save with encoding method 5
+#define WEBP_METHOD_6		0x7000	//! save with encoding method 6 (slowest, smallest file) - default value
+#define WEBP_PREMULTIPLIED	0x0100	//! loading: load the frames of an animation with premultiplied alpha
+#define WEBP_LOAD_NOTHREADS	0x0200	//! loading: decode on the calling thread only (default uses a worker thread)
 #define JXR_DEFAULT			0		//! save with quality 80 and no chroma subsampling (4:4:4)
 #define JXR_LOSSLESS		0x0064	//! save lossless
 #define JXR_PROGRESSIVE		0x2000	//! save as a progressive-JXR (use | to combine with other save flags)
@@ -853,6 +956,7 @@ FI_STRUCT (FIDEPENDENCY) {
 #define FI_RESCALE_DEFAULT			0x00    //! default options; none of the following other options apply
 #define FI_RESCALE_TRUE_COLOR		0x01	//! for non-transparent greyscale images, convert to 24-bit if src bitdepth <= 8 (default is a 8-bit greyscale image). 
 #define FI_RESCALE_OMIT_METADATA	0x02	//! do not copy metadata to the rescaled image
+#define FI_RESCALE_LINEAR_LIGHT		0x04	//! for 24-bit and 32-bit images, filter in linear light: sRGB values are decoded before filtering and encoded after (colors are weighted by alpha)
 
 // Color conversion parameters
 FI_ENUM(FREE_IMAGE_CVT_COLOR_PARAM) {
@@ -861,10 +965,33 @@ FI_ENUM(FREE_IMAGE_CVT_COLOR_PARAM) {
 };
 
 // Alpha blending operation type
+// Porter-Duff operators and blend modes follow the W3C Compositing and Blending specification
 FI_ENUM(FREE_IMAGE_ALPHA_OPERATION) {
-	FIAO_SrcAlpha		///< Use only src alpha, ignore dst alpha
+	FIAO_SrcAlpha	= 0,	///< Use only src alpha, ignore dst alpha
+	FIAO_Clear		= 1,	///< Porter-Duff clear : dst is cleared
+	FIAO_Src		= 2,	///< Porter-Duff src : src replaces dst
+	FIAO_Dst		= 3,	///< Porter-Duff dst : dst is left unchanged
+	FIAO_SrcOver	= 4,	///< Porter-Duff src-over : src is drawn over dst
+	FIAO_DstOver	= 5,	///< Porter-Duff dst-over : src is drawn behind dst
+	FIAO_SrcIn		= 6,	///< Porter-Duff src-in : src where dst is opaque
+	FIAO_DstIn		= 7,	///< Porter-Duff dst-in : dst where src is opaque
+	FIAO_SrcOut		= 8,	///< Porter-Duff src-out : src where dst is transparent
+	FIAO_DstOut		= 9,	///< Porter-Duff dst-out : dst where src is transparent
+	FIAO_SrcAtop	= 10,	///< Porter-Duff src-atop : src over dst, inside dst only
+	FIAO_DstAtop	= 11,	///< Porter-Duff dst-atop : dst over src, inside src only
+	FIAO_Xor		= 12,	///< Porter-Duff xor : src and dst where they do not overlap
+	FIAO_Multiply	= 13,	///< Multiply blend mode, composited with src-over
+	FIAO_Screen		= 14,	///< Screen blend mode, composited with src-over
+	FIAO_Overlay	= 15,	///< Overlay blend mode, composited with src-over
+	FIAO_Add		= 16	///< Porter-Duff plus : src and dst are added, alpha is clamped to 1
 };
 
+// DrawBitmap options ---------------------------------------------------------
+// Constants used in FreeImage_DrawBitmapEx and FreeImage_CompositeEx
+
+#define FI_ALPHA_STRAIGHT		0x00	//! color channels of src and dst are not multiplied by alpha (default)
+#define FI_ALPHA_PREMULTIPLIED	0x01	//! color channels of src and dst are premultiplied by alpha (see FreeImage_PreMultiplyWithAlpha)
+
 
 // Message struct ---------------------------------------------------------
 
@@ -966,6 +1093,8 @@ DLL_API FIBOOL DLL_CALLCONV FreeImage_HasPixels(FIBITMAP *dib);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Load(FREE_IMAGE_FORMAT fif, const char *filename, int flags FI_DEFAULT(0));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_LoadU(FREE_IMAGE_FORMAT fif, const wchar_t *filename, int flags FI_DEFAULT(0));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_LoadFromHandle(FREE_IMAGE_FORMAT fif, FreeImageIO *io, fi_handle handle, int flags FI_DEFAULT(0));
+DLL_API FIBOOL DLL_CALLCONV FreeImage_LoadScanlines(FREE_IMAGE_FORMAT fif, const char *filename, FI_ScanlineProc scanline_proc, void *user_data, int flags FI_DEFAULT(0));
+DLL_API FIBOOL DLL_CALLCONV FreeImage_LoadScanlinesFromHandle(FREE_IMAGE_FORMAT fif, FreeImageIO *io, fi_handle handle, FI_ScanlineProc scanline_proc, void *user_data, int flags FI_DEFAULT(0));
 DLL_API FIBOOL DLL_CALLCONV FreeImage_Save(FREE_IMAGE_FORMAT fif, FIBITMAP *dib, const char *filename, int flags FI_DEFAULT(0));
 DLL_API FIBOOL DLL_CALLCONV FreeImage_SaveU(FREE_IMAGE_FORMAT fif, FIBITMAP *dib, const wchar_t *filename, int flags FI_DEFAULT(0));
 DLL_API FIBOOL DLL_CALLCONV FreeImage_SaveToHandle(FREE_IMAGE_FORMAT fif, FIBITMAP *dib, FreeImageIO *io, fi_handle handle, int flags FI_DEFAULT(0));
@@ -1144,6 +1273,8 @@ DLL_API void DLL_CALLCONV FreeImage_DestroyICCProfile(FIBITMAP *dib);
 
 // Line conversion routines -------------------------------------------------
 
+DLL_API FREE_IMAGE_SIMD DLL_CALLCONV FreeImage_GetSIMDLevel(void);
+DLL_API FIBOOL DLL_CALLCONV FreeImage_SetSIMDLevel(FREE_IMAGE_SIMD level);
 DLL_API void DLL_CALLCONV FreeImage_ConvertLine1To4(uint8_t *target, uint8_t *source, int width_in_pixels);
 DLL_API void DLL_CALLCONV FreeImage_ConvertLine8To4(uint8_t *target, uint8_t *source, int width_in_pixels, FIRGBA8 *palette);
 DLL_API void DLL_CALLCONV FreeImage_ConvertLine16To4_555(uint8_t *target, uint8_t *source, int width_in_pixels);
@@ -1197,6 +1328,8 @@ DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertTo24Bits(FIBITMAP *dib);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertTo32Bits(FIBITMAP *dib);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ColorQuantize(FIBITMAP *dib, FREE_IMAGE_QUANTIZE quantize);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ColorQuantizeEx(FIBITMAP *dib, FREE_IMAGE_QUANTIZE quantize FI_DEFAULT(FIQ_WUQUANT), int PaletteSize FI_DEFAULT(256), int ReserveSize FI_DEFAULT(0), FIRGBA8 *ReservePalette FI_DEFAULT(NULL));
+DLL_API int DLL_CALLCONV FreeImage_ComputePalette(FIBITMAP **frames, int count, FREE_IMAGE_QUANTIZE quantize, int PaletteSize, FIRGBA8 *palette, int ReserveSize FI_DEFAULT(0), FIRGBA8 *ReservePalette FI_DEFAULT(NULL));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_MapToPalette(FIBITMAP *dib, const FIRGBA8 *palette, int PaletteSize, FREE_IMAGE_DIFFUSION diffusion FI_DEFAULT(FIDF_NONE));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Threshold(FIBITMAP *dib, uint8_t T);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Dither(FIBITMAP *dib, FREE_IMAGE_DITHER algorithm);
 
@@ -1218,13 +1351,29 @@ DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertToRGB16(FIBITMAP *dib);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertToRGBA16(FIBITMAP *dib);
 
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertToStandardType(FIBITMAP *src, FIBOOL scale_linear FI_DEFAULT(TRUE));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertToStandardTypeEx(FIBITMAP *src, FIBOOL scale_linear FI_DEFAULT(TRUE), FREE_IMAGE_DEPTH_DITHER dither FI_DEFAULT(FIDD_NONE));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertToType(FIBITMAP *src, FREE_IMAGE_TYPE dst_type, FIBOOL scale_linear FI_DEFAULT(TRUE));
 
+/**
+ * Converts an image to another type and bit depth, reusing its pixel buffer when the target pixels are not wider.
+ * dst_bpp is only used for FIT_BITMAP targets (4, 8, 16 (565), 24 or 32 bits), conversions are the ones
+ * of FreeImage_ConvertTo<N>Bits for FIT_BITMAP targets and of FreeImage_ConvertToType (with linear scaling) otherwise.
+ * Wider targets, targets with a different palette layout, wrapped user buffers (FreeImage_AllocateHeaderForBits)
+ * and views (FreeImage_CreateView) are converted into a new buffer : the memory of a wrapped buffer or of the
+ * bitmap of a view is left unchanged, and no longer used by the converted image.
+ * The handle stays valid and keeps its metadata, ICC profile and thumbnail.
+ * Returns TRUE if successful, FALSE otherwise. When the conversion does not exist, or the first band of rows
+ * cannot be converted, the image is unchanged. A memory failure on a later band of an in place conversion
+ * leaves the image in the target format with undefined pixel values.
+ */
+DLL_API FIBOOL DLL_CALLCONV FreeImage_ConvertInPlace(FIBITMAP *dib, FREE_IMAGE_TYPE dst_type, unsigned dst_bpp FI_DEFAULT(0));
+
 DLL_API FIBITMAP* DLL_CALLCONV FreeImage_ConvertToColor(FIBITMAP* dib, FREE_IMAGE_COLOR_TYPE dst_color, int64_t fisrt_param FI_DEFAULT(0), int64_t second_param FI_DEFAULT(0));
 
 // Tone mapping operators ---------------------------------------------------
 
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ToneMapping(FIBITMAP *dib, FREE_IMAGE_TMO tmo, double first_param FI_DEFAULT(0), double second_param FI_DEFAULT(0));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ToneMappingEx(FIBITMAP *dib, FREE_IMAGE_TMO tmo, double first_param FI_DEFAULT(0), double second_param FI_DEFAULT(0), FREE_IMAGE_DEPTH_DITHER dither FI_DEFAULT(FIDD_NONE));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_TmoDrago03(FIBITMAP *src, double gamma FI_DEFAULT(2.2), double exposure FI_DEFAULT(0));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_TmoReinhard05(FIBITMAP *src, double intensity FI_DEFAULT(0), double contrast FI_DEFAULT(0));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_TmoReinhard05Ex(FIBITMAP *src, double intensity FI_DEFAULT(0), double contrast FI_DEFAULT(0), double adaptation FI_DEFAULT(1), double color_correction FI_DEFAULT(0));
@@ -1309,6 +1458,11 @@ DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformFromHandle(FreeImageIO* src_i
 DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformCombined(const char *src_file, const char *dst_file, FREE_IMAGE_JPEG_OPERATION operation, int* left, int* top, int* right, int* bottom, FIBOOL perfect FI_DEFAULT(TRUE));
 DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformCombinedU(const wchar_t *src_file, const wchar_t *dst_file, FREE_IMAGE_JPEG_OPERATION operation, int* left, int* top, int* right, int* bottom, FIBOOL perfect FI_DEFAULT(TRUE));
 DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformCombinedFromMemory(FIMEMORY* src_stream, FIMEMORY* dst_stream, FREE_IMAGE_JPEG_OPERATION operation, int* left, int* top, int* right, int* bottom, FIBOOL perfect FI_DEFAULT(TRUE));
+DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformPipeline(const char *src_file, const char *dst_file, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers FI_DEFAULT(FIJPEG_MARKERS_ALL), FIBOOL perfect FI_DEFAULT(TRUE));
+DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformPipelineU(const wchar_t *src_file, const wchar_t *dst_file, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers FI_DEFAULT(FIJPEG_MARKERS_ALL), FIBOOL perfect FI_DEFAULT(TRUE));
+DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformPipelineFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO* dst_io, fi_handle dst_handle, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers FI_DEFAULT(FIJPEG_MARKERS_ALL), FIBOOL perfect FI_DEFAULT(TRUE));
+DLL_API FIBOOL DLL_CALLCONV FreeImage_JPEGTransformPipelineFromMemory(FIMEMORY* src_stream, FIMEMORY* dst_stream, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers FI_DEFAULT(FIJPEG_MARKERS_ALL), FIBOOL perfect FI_DEFAULT(TRUE));
+DLL_API unsigned DLL_CALLCONV FreeImage_JPEGTransformBatch(const char **src_files, const char **dst_files, unsigned file_count, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers FI_DEFAULT(FIJPEG_MARKERS_ALL), FIBOOL perfect FI_DEFAULT(TRUE), FIBOOL *results FI_DEFAULT(NULL));
 
 
 // --------------------------------------------------------------------------
@@ -1320,14 +1474,32 @@ DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Rotate(FIBITMAP *dib, double angle, con
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_RotateEx(FIBITMAP *dib, double angle, double x_shift, double y_shift, double x_origin, double y_origin, FIBOOL use_mask);
 DLL_API FIBOOL DLL_CALLCONV FreeImage_FlipHorizontal(FIBITMAP *dib);
 DLL_API FIBOOL DLL_CALLCONV FreeImage_FlipVertical(FIBITMAP *dib);
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Transpose(FIBITMAP *dib);
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Transverse(FIBITMAP *dib);
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_WarpAffine(FIBITMAP *dib, const double *matrix, int dst_width, int dst_height, FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_BILINEAR), FREE_IMAGE_BORDER_MODE border FI_DEFAULT(FIBM_ZERO), const void *bkcolor FI_DEFAULT(NULL));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_WarpPerspective(FIBITMAP *dib, const double *matrix, int dst_width, int dst_height, FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_BILINEAR), FREE_IMAGE_BORDER_MODE border FI_DEFAULT(FIBM_ZERO), const void *bkcolor FI_DEFAULT(NULL));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Remap(FIBITMAP *dib, FIBITMAP *map_x, FIBITMAP *map_y, FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_BILINEAR), FREE_IMAGE_BORDER_MODE border FI_DEFAULT(FIBM_ZERO), const void *bkcolor FI_DEFAULT(NULL));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_ConvertRemapMap(FIBITMAP *map);
 
 // upsampling / downsampling
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Rescale(FIBITMAP *dib, int dst_width, int dst_height, FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_CATMULLROM));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_MakeThumbnail(FIBITMAP *dib, int max_pixel_size, FIBOOL convert FI_DEFAULT(TRUE));
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_RescaleRect(FIBITMAP *dib, int dst_width, int dst_height, int left, int top, int right, int bottom, FREE_IMAGE_FILTER filter FI_DEFAULT(FILTER_CATMULLROM), unsigned flags FI_DEFAULT(0));
 
+// blur / sharpen filters
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_BoxBlur(FIBITMAP *dib, int radius);
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_GaussianBlur(FIBITMAP *dib, double sigma);
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_UnsharpMask(FIBITMAP *dib, double sigma, double amount, double threshold FI_DEFAULT(0));
+
+// convolution / morphology filters
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Convolve(FIBITMAP *dib, const double *kernel, int width, int height, FREE_IMAGE_BORDER_MODE border FI_DEFAULT(FIBM_CLAMP));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Erode(FIBITMAP *dib, int width, int height, const uint8_t *element FI_DEFAULT(NULL));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Dilate(FIBITMAP *dib, int width, int height, const uint8_t *element FI_DEFAULT(NULL));
+
 // color manipulation routines (point operations)
 DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustCurve(FIBITMAP *dib, uint8_t *LUT, FREE_IMAGE_COLOR_CHANNEL channel);
+DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustCurve16(FIBITMAP *dib, const uint16_t *LUT, FREE_IMAGE_COLOR_CHANNEL channel);
+DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustChannelCurves(FIBITMAP *dib, const void *red, const void *green, const void *blue, const void *alpha FI_DEFAULT(NULL));
 DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustGamma(FIBITMAP *dib, double gamma);
 DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustBrightness(FIBITMAP *dib, double percentage);
 DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustContrast(FIBITMAP *dib, double percentage);
@@ -1342,7 +1514,14 @@ DLL_API FIBOOL DLL_CALLCONV FreeImage_Invert(FIBITMAP *dib);
 DLL_API FIBOOL DLL_CALLCONV FreeImage_MakeHistogram(FIBITMAP* dib, uint32_t binsNumber, void* minVal, void* maxVal, uint32_t* histR, uint32_t strideR FI_DEFAULT(1u),
 	uint32_t* histG FI_DEFAULT(NULL), uint32_t strideG  FI_DEFAULT(1u), uint32_t* histB FI_DEFAULT(NULL), uint32_t strideB  FI_DEFAULT(1u), uint32_t* histL FI_DEFAULT(NULL), uint32_t strideL FI_DEFAULT(1u));
 
+/**
+ * Computes min, max, mean, standard deviation and optionally a histogram of every channel in one pass.
+ * Histograms are returned one after the other in `histograms`, binsNumber bins per channel.
+ */
+DLL_API FIBOOL DLL_CALLCONV FreeImage_GetStatistics(FIBITMAP* dib, FISTATISTICS* stats, uint32_t binsNumber FI_DEFAULT(0), uint32_t* histograms FI_DEFAULT(NULL));
+
 DLL_API int DLL_CALLCONV FreeImage_GetAdjustColorsLookupTable(uint8_t *LUT, double brightness, double contrast, double gamma, FIBOOL invert);
+DLL_API int DLL_CALLCONV FreeImage_GetAdjustColorsLookupTable16(uint16_t *LUT, double brightness, double contrast, double gamma, FIBOOL invert);
 DLL_API FIBOOL DLL_CALLCONV FreeImage_AdjustColors(FIBITMAP *dib, double brightness, double contrast, double gamma, FIBOOL invert FI_DEFAULT(FALSE));
 DLL_API unsigned DLL_CALLCONV FreeImage_ApplyColorMapping(FIBITMAP *dib, FIRGBA8 *srccolors, FIRGBA8 *dstcolors, unsigned count, FIBOOL ignore_alpha, FIBOOL swap);
 DLL_API unsigned DLL_CALLCONV FreeImage_SwapColors(FIBITMAP *dib, FIRGBA8 *color_a, FIRGBA8 *color_b, FIBOOL ignore_alpha);
@@ -1354,6 +1533,10 @@ DLL_API FIBITMAP *DLL_CALLCONV FreeImage_GetChannel(FIBITMAP *dib, FREE_IMAGE_CO
 DLL_API FIBOOL DLL_CALLCONV FreeImage_SetChannel(FIBITMAP *dst, FIBITMAP *src, FREE_IMAGE_COLOR_CHANNEL channel);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_GetComplexChannel(FIBITMAP *src, FREE_IMAGE_COLOR_CHANNEL channel);
 DLL_API FIBOOL DLL_CALLCONV FreeImage_SetComplexChannel(FIBITMAP *dst, FIBITMAP *src, FREE_IMAGE_COLOR_CHANNEL channel);
+DLL_API FIBOOL DLL_CALLCONV FreeImage_SplitChannels(FIBITMAP *dib, FIBITMAP **channels);
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_MergeChannels(FIBITMAP **channels, unsigned count);
+DLL_API FIBOOL DLL_CALLCONV FreeImage_ConvertToPlanarBits(uint8_t *bits, FIBITMAP *dib, unsigned pitch FI_DEFAULT(0), FIBOOL topdown FI_DEFAULT(FALSE));
+DLL_API FIBOOL DLL_CALLCONV FreeImage_CreatePlanarView(uint8_t *bits, FREE_IMAGE_TYPE type, unsigned width, unsigned height, unsigned pitch, unsigned count, FIBITMAP **planes);
 
 // copy / paste / composite routines
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Copy(FIBITMAP *dib, int left, int top, int right, int bottom);
@@ -1361,13 +1544,23 @@ DLL_API FIBOOL DLL_CALLCONV FreeImage_Paste(FIBITMAP *dst, FIBITMAP *src, int le
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_CreateView(FIBITMAP *dib, unsigned left, unsigned top, unsigned right, unsigned bottom);
 
 DLL_API FIBOOL DLL_CALLCONV FreeImage_PreMultiplyWithAlpha(FIBITMAP *dib);
+DLL_API FIBOOL DLL_CALLCONV FreeImage_UnPreMultiplyWithAlpha(FIBITMAP *dib);
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_Composite(FIBITMAP *fg, FIBOOL useFileBkg FI_DEFAULT(FALSE), FIRGBA8 *appBkColor FI_DEFAULT(NULL), FIBITMAP *bg FI_DEFAULT(NULL));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_CompositeEx(FIBITMAP *fg, FIBOOL useFileBkg FI_DEFAULT(FALSE), FIRGBA8 *appBkColor FI_DEFAULT(NULL), FIBITMAP *bg FI_DEFAULT(NULL), int options FI_DEFAULT(FI_ALPHA_STRAIGHT));
 /**
  * Draws bitmap with specified alpha blending type
+ * Supported images are 8-bit greyscale, 24-bit and 32-bit FIT_BITMAP, FIT_UINT16, FIT_RGB16, FIT_RGBA16, FIT_FLOAT, FIT_RGBF and FIT_RGBAF,
+ * src and dst may have different types. Images without alpha channel are opaque,
+ * a dst without alpha channel receives the result composited over black.
  * @param left X offset of top left corner of drawn bitmap
  * @param top Y offset of top left corner of drawn bitmap
  */
 DLL_API FIBOOL DLL_CALLCONV FreeImage_DrawBitmap(FIBITMAP* dst, FIBITMAP* src, FREE_IMAGE_ALPHA_OPERATION alpha, int32_t left FI_DEFAULT(0), int32_t top FI_DEFAULT(0));
+/**
+ * Same as FreeImage_DrawBitmap, with straight or premultiplied colors
+ * @param options FI_ALPHA_STRAIGHT or FI_ALPHA_PREMULTIPLIED
+ */
+DLL_API FIBOOL DLL_CALLCONV FreeImage_DrawBitmapEx(FIBITMAP* dst, FIBITMAP* src, FREE_IMAGE_ALPHA_OPERATION alpha, int32_t left FI_DEFAULT(0), int32_t top FI_DEFAULT(0), int options FI_DEFAULT(FI_ALPHA_STRAIGHT));
 
 // background filling routines
 DLL_API FIBOOL DLL_CALLCONV FreeImage_FillBackground(FIBITMAP *dib, const void *color, int options FI_DEFAULT(0));
@@ -1377,6 +1570,7 @@ DLL_API FIBITMAP *DLL_CALLCONV FreeImage_AllocateExT(FREE_IMAGE_TYPE type, int w
 
 // miscellaneous algorithms
 DLL_API FIBITMAP *DLL_CALLCONV FreeImage_MultigridPoissonSolver(FIBITMAP *Laplacian, int ncycle FI_DEFAULT(3));
+DLL_API FIBITMAP *DLL_CALLCONV FreeImage_DCTPoissonSolver(FIBITMAP *Laplacian);
 
 /**
  * Finds pixels with min and max brightness.
@@ -171,6 +171,20 @@ namespace fi
         eCluster16x16 = FID_CLUSTER16x16
     };
 
+    enum class DiffusionAlgorithm
+    {
+        eNone           = FIDF_NONE,
+        eFloydSteinberg = FIDF_FLOYD_STEINBERG,
+        eSierraLite     = FIDF_SIERRA_LITE
+    };
+
+    enum class DepthDitherAlgorithm
+    {
+        eNone           = FIDD_NONE,
+        eOrdered        = FIDD_ORDERED,
+        eFloydSteinberg = FIDD_FLOYD_STEINBERG
+    };
+
     enum class ToneMappingAlgorithm
     {
         eClamp      = FITMO_CLAMP,
@@ -235,6 +249,14 @@ namespace fi
         eLanczos3   = FILTER_LANCZOS3,
     };
 
+    enum class BorderMode
+    {
+        eClamp  = FIBM_CLAMP,
+        eMirror = FIBM_MIRROR,
+        eWrap   = FIBM_WRAP,
+        eZero   = FIBM_ZERO
+    };
+
     enum class ColorChannel
     {
         eRgb   = FICC_RGB,
@@ -251,7 +273,42 @@ namespace fi
 
     enum class AlphaOperation
     {
-        eSrcAlpha = FIAO_SrcAlpha
+        eSrcAlpha = FIAO_SrcAlpha,
+        eClear    = FIAO_Clear,
+        eSrc      = FIAO_Src,
+        eDst      = FIAO_Dst,
+        eSrcOver  = FIAO_SrcOver,
+        eDstOver  = FIAO_DstOver,
+        eSrcIn    = FIAO_SrcIn,
+        eDstIn    = FIAO_DstIn,
+        eSrcOut   = FIAO_SrcOut,
+        eDstOut   = FIAO_DstOut,
+        eSrcAtop  = FIAO_SrcAtop,
+        eDstAtop  = FIAO_DstAtop,
+        eXor      = FIAO_Xor,
+        eMultiply = FIAO_Multiply,
+        eScreen   = FIAO_Screen,
+        eOverlay  = FIAO_Overlay,
+        eAdd      = FIAO_Add
+    };
+
+    enum class JpegOperation
+    {
+        eNone       = FIJPEG_OP_NONE,
+        eFlipH      = FIJPEG_OP_FLIP_H,
+        eFlipV      = FIJPEG_OP_FLIP_V,
+        eTranspose  = FIJPEG_OP_TRANSPOSE,
+        eTransverse = FIJPEG_OP_TRANSVERSE,
+        eRotate90   = FIJPEG_OP_ROTATE_90,
+        eRotate180  = FIJPEG_OP_ROTATE_180,
+        eRotate270  = FIJPEG_OP_ROTATE_270
+    };
+
+    enum class JpegMarkers
+    {
+        eAll         = FIJPEG_MARKERS_ALL,
+        eNone        = FIJPEG_MARKERS_NONE,
+        eOrientation = FIJPEG_MARKERS_ORIENTATION
     };
 
     enum class Severity
@@ -992,9 +1049,9 @@ namespace fi
             return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_ConvertToRGBA16, NativeHandle_()));
         }
 
-        Bitmap ConvertToStandardType(bool scaleLinear = true) const
+        Bitmap ConvertToStandardType(bool scaleLinear = true, DepthDitherAlgorithm dither = DepthDitherAlgorithm::eNone) const
         {
-            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_ConvertToStandardType, NativeHandle_(), scaleLinear));
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_ConvertToStandardTypeEx, NativeHandle_(), scaleLinear, static_cast<FREE_IMAGE_DEPTH_DITHER>(dither)));
         }
 
         Bitmap ConvertToType(ImageType dstType, bool scaleLinear = true) const
@@ -1012,6 +1069,11 @@ namespace fi
             return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_ColorQuantizeEx, NativeHandle_(), static_cast<FREE_IMAGE_QUANTIZE>(quantize), details::narrow_cast<int>(paletteSize), details::narrow_cast<int>(reserveSize), reservePalette));
         }
 
+        Bitmap MapToPalette(const FIRGBA8* palette, uint32_t paletteSize, DiffusionAlgorithm diffusion = DiffusionAlgorithm::eNone) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_MapToPalette, NativeHandle_(), palette, details::narrow_cast<int>(paletteSize), static_cast<FREE_IMAGE_DIFFUSION>(diffusion)));
+        }
+
         Bitmap Threshold(uint8_t t) const
         {
             return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Threshold, NativeHandle_(), t));
@@ -1022,9 +1084,9 @@ namespace fi
             return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Dither, NativeHandle_(), static_cast<FREE_IMAGE_DITHER>(algorithm)));
         }
 
-        Bitmap ToneMapping(ToneMappingAlgorithm tmo, double firstParam = 0.0, double secondParam = 0.0) const
+        Bitmap ToneMapping(ToneMappingAlgorithm tmo, double firstParam = 0.0, double secondParam = 0.0, DepthDitherAlgorithm dither = DepthDitherAlgorithm::eNone) const
         {
-            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_ToneMapping, NativeHandle_(), static_cast<FREE_IMAGE_TMO>(tmo), firstParam, secondParam));
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_ToneMappingEx, NativeHandle_(), static_cast<FREE_IMAGE_TMO>(tmo), firstParam, secondParam, static_cast<FREE_IMAGE_DEPTH_DITHER>(dither)));
         }
 
         Bitmap TmoDrago03(ToneMappingAlgorithm tmo, double gamma = 2.2, double exposure = 0.0) const
@@ -1149,6 +1211,36 @@ namespace fi
             return *this;
         }
 
+        Bitmap Transpose() const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Transpose, NativeHandle_()));
+        }
+
+        Bitmap Transverse() const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Transverse, NativeHandle_()));
+        }
+
+        Bitmap WarpAffine(const double* matrix, uint32_t dstWidth, uint32_t dstHeight, FilterType filter = FilterType::eBilinear, BorderMode border = BorderMode::eZero, const void* bkcolor = nullptr) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_WarpAffine, NativeHandle_(), matrix, details::narrow_cast<int>(dstWidth), details::narrow_cast<int>(dstHeight), static_cast<FREE_IMAGE_FILTER>(filter), static_cast<FREE_IMAGE_BORDER_MODE>(border), bkcolor));
+        }
+
+        Bitmap WarpPerspective(const double* matrix, uint32_t dstWidth, uint32_t dstHeight, FilterType filter = FilterType::eBilinear, BorderMode border = BorderMode::eZero, const void* bkcolor = nullptr) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_WarpPerspective, NativeHandle_(), matrix, details::narrow_cast<int>(dstWidth), details::narrow_cast<int>(dstHeight), static_cast<FREE_IMAGE_FILTER>(filter), static_cast<FREE_IMAGE_BORDER_MODE>(border), bkcolor));
+        }
+
+        Bitmap Remap(const Bitmap& mapX, const Bitmap& mapY, FilterType filter = FilterType::eBilinear, BorderMode border = BorderMode::eZero, const void* bkcolor = nullptr) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Remap, NativeHandle_(), mapX.NativeHandle_(), mapY.NativeHandle_(), static_cast<FREE_IMAGE_FILTER>(filter), static_cast<FREE_IMAGE_BORDER_MODE>(border), bkcolor));
+        }
+
+        Bitmap ConvertRemapMap() const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_ConvertRemapMap, NativeHandle_()));
+        }
+
         Bitmap Rescale(uint32_t dstWidth, uint32_t dstHeight, FilterType filter = FilterType::eCatmullRom) const
         {
             return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Rescale, NativeHandle_(), details::narrow_cast<int>(dstWidth), details::narrow_cast<int>(dstHeight), static_cast<FREE_IMAGE_FILTER>(filter)));
@@ -1165,12 +1257,54 @@ namespace fi
             return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_MakeThumbnail, NativeHandle_(), maxPixelSize, convert));
         }
 
+        Bitmap BoxBlur(uint32_t radius) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_BoxBlur, NativeHandle_(), details::narrow_cast<int>(radius)));
+        }
+
+        Bitmap GaussianBlur(double sigma) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_GaussianBlur, NativeHandle_(), sigma));
+        }
+
+        Bitmap UnsharpMask(double sigma, double amount, double threshold = 0.0) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_UnsharpMask, NativeHandle_(), sigma, amount, threshold));
+        }
+
+        Bitmap Convolve(const double* kernel, uint32_t width, uint32_t height, BorderMode border = BorderMode::eClamp) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Convolve, NativeHandle_(), kernel, details::narrow_cast<int>(width), details::narrow_cast<int>(height), static_cast<FREE_IMAGE_BORDER_MODE>(border)));
+        }
+
+        Bitmap Erode(uint32_t width, uint32_t height, const uint8_t* element = nullptr) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Erode, NativeHandle_(), details::narrow_cast<int>(width), details::narrow_cast<int>(height), element));
+        }
+
+        Bitmap Dilate(uint32_t width, uint32_t height, const uint8_t* element = nullptr) const
+        {
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Dilate, NativeHandle_(), details::narrow_cast<int>(width), details::narrow_cast<int>(height), element));
+        }
+
         Bitmap& AdjustCurve(const uint8_t* lut, ColorChannel channel)
         {
             FREEIMAGERE_CHECKED_CALL(FreeImage_AdjustCurve, NativeHandle_(), const_cast<uint8_t*>(lut), static_cast<FREE_IMAGE_COLOR_CHANNEL>(channel));
             return *this;
         }
 
+        Bitmap& AdjustCurve(const uint16_t* lut, ColorChannel channel)
+        {
+            FREEIMAGERE_CHECKED_CALL(FreeImage_AdjustCurve16, NativeHandle_(), lut, static_cast<FREE_IMAGE_COLOR_CHANNEL>(channel));
+            return *this;
+        }
+
+        Bitmap& AdjustChannelCurves(const void* red, const void* green, const void* blue, const void* alpha = nullptr)
+        {
+            FREEIMAGERE_CHECKED_CALL(FreeImage_AdjustChannelCurves, NativeHandle_(), red, green, blue, alpha);
+            return *this;
+        }
+
         Bitmap& AdjustGamma(double gamma)
         {
             FREEIMAGERE_CHECKED_CALL(FreeImage_AdjustGamma, NativeHandle_(), gamma);
@@ -1201,6 +1335,11 @@ namespace fi
             return FreeImage_MakeHistogram(NativeHandle_(), bins, minVal, maxVal, histR, strideR, histG, strideG, histB, strideB, histL, strideL);
         }
 
+        bool GetStatistics(FISTATISTICS* stats, uint32_t bins = 0, uint32_t* histograms = nullptr) const
+        {
+            return FreeImage_GetStatistics(NativeHandle_(), stats, bins, histograms);
+        }
+
         bool AdjustColors(double brightness, double contrast, double gamma, bool invert = false)
         {
             return FreeImage_AdjustColors(NativeHandle_(), brightness, contrast, gamma, invert);
@@ -1246,6 +1385,51 @@ namespace fi
             return FreeImage_SetComplexChannel(NativeHandle_(), src.NativeHandle_(), static_cast<FREE_IMAGE_COLOR_CHANNEL>(channel));
         }
 
+        std::vector<Bitmap> SplitChannels() const
+        {
+            FIBITMAP* channels[4]{};
+            FREEIMAGERE_CHECKED_CALL(FreeImage_SplitChannels, NativeHandle_(), channels);
+            std::vector<Bitmap> res;
+            for (FIBITMAP* channel : channels) {
+                if (channel) {
+                    res.emplace_back(channel);
+                }
+            }
+            return res;
+        }
+
+        static
+        Bitmap MergeChannels(const std::vector<Bitmap>& channels)
+        {
+            FIBITMAP* handles[4]{};
+            if (channels.size() > 4) {
+                throw ImageError("Bitmap[MergeChannels]: Too many channels");
+            }
+            for (size_t i = 0; i < channels.size(); ++i) {
+                handles[i] = channels[i].NativeHandle_();
+            }
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_MergeChannels, handles, details::narrow_cast<unsigned>(channels.size())));
+        }
+
+        void ConvertToPlanarBits(uint8_t* bits, uint32_t pitch = 0, bool topdown = false) const
+        {
+            FREEIMAGERE_CHECKED_CALL(FreeImage_ConvertToPlanarBits, bits, NativeHandle_(), pitch, topdown);
+        }
+
+        static
+        std::vector<Bitmap> CreatePlanarView(uint8_t* bits, ImageType type, uint32_t width, uint32_t height, uint32_t pitch, uint32_t count)
+        {
+            FIBITMAP* planes[4]{};
+            FREEIMAGERE_CHECKED_CALL(FreeImage_CreatePlanarView, bits, static_cast<FREE_IMAGE_TYPE>(type), width, height, pitch, count, planes);
+            std::vector<Bitmap> res;
+            for (FIBITMAP* plane : planes) {
+                if (plane) {
+                    res.emplace_back(plane);
+                }
+            }
+            return res;
+        }
+
         Bitmap Copy(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom) const
         {
             return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Copy, NativeHandle_(), details::narrow_cast<int>(left), details::narrow_cast<int>(top), details::narrow_cast<int>(right), details::narrow_cast<int>(bottom)));
@@ -1267,14 +1451,20 @@ namespace fi
             return *this;
         }
 
-        Bitmap Composite(bool useFileBkg = false, const FIRGBA8* appBkColor = nullptr, const Bitmap* bg = nullptr) const
+        Bitmap& UnPreMultiplyWithAlpha()
         {
-            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_Composite, NativeHandle_(), useFileBkg, const_cast<FIRGBA8*>(appBkColor), (bg ? bg->NativeHandle_() : nullptr)));
+            FREEIMAGERE_CHECKED_CALL(FreeImage_UnPreMultiplyWithAlpha, NativeHandle_());
+            return *this;
         }
 
-        Bitmap& DrawBitmap(const Bitmap& src, AlphaOperation alpha, int32_t left = 0, int32_t top = 0)
+        Bitmap Composite(bool useFileBkg = false, const FIRGBA8* appBkColor = nullptr, const Bitmap* bg = nullptr, bool premultiplied = false) const
         {
-            FREEIMAGERE_CHECKED_CALL(FreeImage_DrawBitmap, NativeHandle_(), src.NativeHandle_(), static_cast<FREE_IMAGE_ALPHA_OPERATION>(alpha), left, top);
+            return Bitmap(FREEIMAGERE_CHECKED_CALL(FreeImage_CompositeEx, NativeHandle_(), useFileBkg, const_cast<FIRGBA8*>(appBkColor), (bg ? bg->NativeHandle_() : nullptr), premultiplied ? FI_ALPHA_PREMULTIPLIED : FI_ALPHA_STRAIGHT));
+        }
+
+        Bitmap& DrawBitmap(const Bitmap& src, AlphaOperation alpha, int32_t left = 0, int32_t top = 0, bool premultiplied = false)
+        {
+            FREEIMAGERE_CHECKED_CALL(FreeImage_DrawBitmapEx, NativeHandle_(), src.NativeHandle_(), static_cast<FREE_IMAGE_ALPHA_OPERATION>(alpha), left, top, premultiplied ? FI_ALPHA_PREMULTIPLIED : FI_ALPHA_STRAIGHT);
             return *this;
         }
 
@@ -1340,6 +1530,12 @@ namespace fi
             return FreeImage_GetAdjustColorsLookupTable(lut, brightness, contrast, gamma, invert);
         }
 
+        static
+        int AdjustColorsLookupTable(uint16_t* lut, double brightness, double contrast, double gamma, bool invert)
+        {
+            return FreeImage_GetAdjustColorsLookupTable16(lut, brightness, contrast, gamma, invert);
+        }
+
     private:
         friend class MultiBitmap;
 
@@ -1540,6 +1736,122 @@ namespace fi
     };
 
 
+    /**
+     * Step of a lossless JPEG transform pipeline
+     */
+    class JpegStep
+    {
+    public:
+        static
+        JpegStep Transform(JpegOperation operation)
+        {
+            return JpegStep({ FIJPEG_STEP_TRANSFORM, static_cast<FREE_IMAGE_JPEG_OPERATION>(operation), 0, 0, 0, 0 });
+        }
+
+        /**
+         * Crop rectangle in the coordinates of the image transformed by the previous steps
+         */
+        static
+        JpegStep Crop(int left, int top, int right, int bottom)
+        {
+            return JpegStep({ FIJPEG_STEP_CROP, FIJPEG_OP_NONE, left, top, right, bottom });
+        }
+
+        static
+        JpegStep Grayscale()
+        {
+            return JpegStep({ FIJPEG_STEP_GRAYSCALE, FIJPEG_OP_NONE, 0, 0, 0, 0 });
+        }
+
+        static
+        JpegStep AutoOrient()
+        {
+            return JpegStep({ FIJPEG_STEP_AUTO_ORIENT, FIJPEG_OP_NONE, 0, 0, 0, 0 });
+        }
+
+        const FIJPEGSTEP& GetNative() const
+        {
+            return mStep;
+        }
+
+    private:
+        explicit
+        JpegStep(const FIJPEGSTEP& step)
+            : mStep(step)
+        { }
+
+        FIJPEGSTEP mStep;
+    };
+
+    namespace details
+    {
+        inline
+        std::vector<FIJPEGSTEP> NativeJpegSteps(const std::vector<JpegStep>& steps)
+        {
+            std::vector<FIJPEGSTEP> native;
+            native.reserve(steps.size());
+            for (const auto& step : steps) {
+                native.push_back(step.GetNative());
+            }
+            return native;
+        }
+
+    } // namespace details
+
+    /**
+     * Applies the steps of a lossless JPEG transform pipeline in a single pass over the DCT coefficients
+     */
+    inline
+    bool JpegTransformPipeline(const char* srcFile, const char* dstFile, const std::vector<JpegStep>& steps, JpegMarkers markers = JpegMarkers::eAll, bool perfect = true)
+    {
+        const auto native = details::NativeJpegSteps(steps);
+        return FreeImage_JPEGTransformPipeline(srcFile, dstFile, native.data(), details::narrow_cast<unsigned>(native.size()), static_cast<FREE_IMAGE_JPEG_MARKERS>(markers), static_cast<FIBOOL>(perfect));
+    }
+
+    inline
+    bool JpegTransformPipeline(const wchar_t* srcFile, const wchar_t* dstFile, const std::vector<JpegStep>& steps, JpegMarkers markers = JpegMarkers::eAll, bool perfect = true)
+    {
+        const auto native = details::NativeJpegSteps(steps);
+        return FreeImage_JPEGTransformPipelineU(srcFile, dstFile, native.data(), details::narrow_cast<unsigned>(native.size()), static_cast<FREE_IMAGE_JPEG_MARKERS>(markers), static_cast<FIBOOL>(perfect));
+    }
+
+    inline
+    bool JpegTransformPipeline(const std::filesystem::path& srcFile, const std::filesystem::path& dstFile, const std::vector<JpegStep>& steps, JpegMarkers markers = JpegMarkers::eAll, bool perfect = true)
+    {
+        return JpegTransformPipeline(srcFile.c_str(), dstFile.c_str(), steps, markers, perfect);
+    }
+
+    inline
+    bool JpegTransformPipeline(FreeImageIO* srcIo, fi_handle srcHandle, FreeImageIO* dstIo, fi_handle dstHandle, const std::vector<JpegStep>& steps, JpegMarkers markers = JpegMarkers::eAll, bool perfect = true)
+    {
+        const auto native = details::NativeJpegSteps(steps);
+        return FreeImage_JPEGTransformPipelineFromHandle(srcIo, srcHandle, dstIo, dstHandle, native.data(), details::narrow_cast<unsigned>(native.size()), static_cast<FREE_IMAGE_JPEG_MARKERS>(markers), static_cast<FIBOOL>(perfect));
+    }
+
+    inline
+    bool JpegTransformPipeline(FIMEMORY* srcStream, FIMEMORY* dstStream, const std::vector<JpegStep>& steps, JpegMarkers markers = JpegMarkers::eAll, bool perfect = true)
+    {
+        const auto native = details::NativeJpegSteps(steps);
+        return FreeImage_JPEGTransformPipelineFromMemory(srcStream, dstStream, native.data(), details::narrow_cast<unsigned>(native.size()), static_cast<FREE_IMAGE_JPEG_MARKERS>(markers), static_cast<FIBOOL>(perfect));
+    }
+
+    /**
+     * Applies the same pipeline to a batch of files, in parallel. Returns the result of each file
+     */
+    inline
+    std::vector<bool> JpegTransformBatch(const std::vector<const char*>& srcFiles, const std::vector<const char*>& dstFiles, const std::vector<JpegStep>& steps, JpegMarkers markers = JpegMarkers::eAll, bool perfect = true)
+    {
+        if (srcFiles.size() != dstFiles.size()) {
+            throw ImageError("[JpegTransformBatch]: Source and destination lists must have the same size");
+        }
+        const auto native = details::NativeJpegSteps(steps);
+        std::vector<FIBOOL> results(srcFiles.size(), FALSE);
+        FreeImage_JPEGTransformBatch(const_cast<const char**>(srcFiles.data()), const_cast<const char**>(dstFiles.data()), details::narrow_cast<unsigned>(srcFiles.size()),
+            native.data(), details::narrow_cast<unsigned>(native.size()), static_cast<FREE_IMAGE_JPEG_MARKERS>(markers), static_cast<FIBOOL>(perfect), results.data());
+        return std::vector<bool>(results.begin(), results.end());
+    }
+
+
     class Plugin2
     {
     public:
@@ -653,6 +653,68 @@ FreeImage_Clone(FIBITMAP *dib) {
 
 // ----------------------------------------------------------
 
+/**
+Tell whether the pixels of a bitmap belong to the caller : a wrapped user buffer or the bitmap of a view
+@param dib Bitmap
+@return Returns TRUE if the bitmap was allocated with FreeImage_AllocateHeaderForBits, FALSE otherwise
+*/
+FIBOOL
+FreeImage_HasExternalBits(FIBITMAP *dib) {
+	return (dib && ((FREEIMAGEHEADER *)dib->data)->external_bits) ? TRUE : FALSE;
+}
+
+/**
+Change the pixel format of a bitmap whose pixels were converted in place.
+The image type, bit depth and transparency settings are copied from 'format',
+which must have the same palette and masks layout as 'dib' (so that the pixels do not move).
+@param dib Converted bitmap
+@param format Bitmap of the target format
+*/
+void
+FreeImage_SetPixelFormat(FIBITMAP *dib, FIBITMAP *format) {
+	auto *fih = (FREEIMAGEHEADER *)dib->data;
+	auto *format_fih = (FREEIMAGEHEADER *)format->data;
+	auto *bih = FreeImage_GetInfoHeader(dib);
+	auto *format_bih = FreeImage_GetInfoHeader(format);
+
+	assert(bih->biClrUsed == format_bih->biClrUsed);
+	assert(bih->biCompression == format_bih->biCompression);
+
+	fih->type = format_fih->type;
+	fih->transparent = format_fih->transparent;
+	fih->transparency_count = format_fih->transparency_count;
+	memcpy(fih->transparent_table, format_fih->transparent_table, sizeof(fih->transparent_table));
+
+	bih->biBitCount = format_bih->biBitCount;
+}
+
+/**
+Replace the pixels of a bitmap by the ones of another bitmap, keeping the bitmap handle valid.
+'dib' keeps its metadata, ICC profile, thumbnail, background color and resolution,
+everything else (image type, size, palette, transparency, pixels) comes from 'src'.
+'src' is unloaded.
+@param dib Bitmap to update
+@param src Bitmap holding the new pixels
+*/
+void
+FreeImage_ReplacePixels(FIBITMAP *dib, FIBITMAP *src) {
+	auto *fih = (FREEIMAGEHEADER *)dib->data;
+	auto *src_fih = (FREEIMAGEHEADER *)src->data;
+
+	std::swap(fih->metadata, src_fih->metadata);
+	std::swap(fih->thumbnail, src_fih->thumbnail);
+	std::swap(fih->iccProfile, src_fih->iccProfile);
+	src_fih->bkgnd_color = fih->bkgnd_color;
+	FreeImage_SetDotsPerMeterX(src, FreeImage_GetDotsPerMeterX(dib));
+	FreeImage_SetDotsPerMeterY(src, FreeImage_GetDotsPerMeterY(dib));
+
+	// src now holds the old pixels and the resources of the converted image
+	std::swap(dib->data, src->data);
+	FreeImage_Unload(src);
+}
+
+// ----------------------------------------------------------
+
 uint8_t * DLL_CALLCONV
 FreeImage_GetBits(FIBITMAP *dib) {
 	if (!FreeImage_HasPixels(dib)) {
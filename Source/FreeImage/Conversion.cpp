@@ -436,6 +436,99 @@ FreeImage_ColorQuantizeEx(FIBITMAP *dib, FREE_IMAGE_QUANTIZE quantize, int Palet
 	return nullptr;
 }
 
+/**
+Stack the frames on top of each other into a single 24-bit image, so that NeuQuant and LFP
+see the pixels of all frames. Rows shorter than the widest frame repeat their last pixel.
+*/
+static FIBITMAP *
+StackFrames(FIBITMAP **frames, int count) {
+	unsigned width = 0;
+	unsigned height = 0;
+	for (int i = 0; i < count; i++) {
+		width = std::max(width, FreeImage_GetWidth(frames[i]));
+		height += FreeImage_GetHeight(frames[i]);
+	}
+	FIBITMAP *stack = FreeImage_Allocate(width, height, 24);
+	if (!stack) {
+		return nullptr;
+	}
+	unsigned y_stack = 0;
+	for (int i = 0; i < count; i++) {
+		const unsigned frame_width = FreeImage_GetWidth(frames[i]);
+		const unsigned bytespp = FreeImage_GetBPP(frames[i]) / 8;
+		for (unsigned y = 0; y < FreeImage_GetHeight(frames[i]); y++, y_stack++) {
+			const uint8_t *src_bits = FreeImage_GetScanLine(frames[i], y);
+			uint8_t *dst_bits = FreeImage_GetScanLine(stack, y_stack);
+			for (unsigned x = 0; x < width; x++, dst_bits += 3) {
+				const uint8_t *pixel = src_bits + std::min(x, frame_width - 1) * bytespp;
+				dst_bits[FI_RGBA_RED] = pixel[FI_RGBA_RED];
+				dst_bits[FI_RGBA_GREEN] = pixel[FI_RGBA_GREEN];
+				dst_bits[FI_RGBA_BLUE] = pixel[FI_RGBA_BLUE];
+			}
+		}
+	}
+	return stack;
+}
+
+/**
+Compute a single palette for a set of images, e.g. the frames of an animation, without mapping their pixels.
+The palette is then applied to every frame with FreeImage_MapToPalette, so that the quantizer runs once
+and all frames share the same colors.
+@param frames 24-bit or 32-bit FIT_BITMAP images, their sizes may differ
+@param count Number of images
+@param quantize Quantization algorithm, FIQ_LFPQUANT fails if the frames have more than PaletteSize colors
+@param PaletteSize Size of the palette, in [2..256]
+@param palette Receives the palette, at least PaletteSize entries
+@param ReserveSize Number of reserved colors, see FreeImage_ColorQuantizeEx
+@param ReservePalette Reserved colors, see FreeImage_ColorQuantizeEx
+@return Returns the number of colors of the palette, 0 if an error occured
+@see FreeImage_MapToPalette
+*/
+int DLL_CALLCONV
+FreeImage_ComputePalette(FIBITMAP **frames, int count, FREE_IMAGE_QUANTIZE quantize, int PaletteSize, FIRGBA8 *palette, int ReserveSize, FIRGBA8 *ReservePalette) {
+	if (!frames || (count <= 0) || !palette) {
+		return 0;
+	}
+	if (PaletteSize < 2) PaletteSize = 2;
+	if (PaletteSize > 256) PaletteSize = 256;
+	if (ReserveSize < 0) ReserveSize = 0;
+	if (ReserveSize > PaletteSize) ReserveSize = PaletteSize;
+	for (int i = 0; i < count; i++) {
+		if (!FreeImage_HasPixels(frames[i]) || (FreeImage_GetImageType(frames[i]) != FIT_BITMAP)) {
+			return 0;
+		}
+		const unsigned bpp = FreeImage_GetBPP(frames[i]);
+		if ((bpp != 24) && (bpp != 32)) {
+			return 0;
+		}
+	}
+
+	if (quantize == FIQ_WUQUANT) {
+		try {
+			WuQuantizer Q(nullptr);
+			return Q.ComputePalette(frames, count, PaletteSize, ReserveSize, ReservePalette, palette);
+		} catch (const char *) {
+			return 0;
+		}
+	}
+
+	// NeuQuant and LFP quantize a single image : quantize the stacked frames and keep the palette
+	FIBITMAP *stack = (count == 1) && (FreeImage_GetBPP(frames[0]) == 24) ? frames[0] : StackFrames(frames, count);
+	if (!stack) {
+		return 0;
+	}
+	FIBITMAP *dst = FreeImage_ColorQuantizeEx(stack, quantize, PaletteSize, ReserveSize, ReservePalette);
+	if (stack != frames[0]) {
+		FreeImage_Unload(stack);
+	}
+	if (!dst) {
+		return 0;
+	}
+	memcpy(palette, FreeImage_GetPalette(dst), PaletteSize * sizeof(FIRGBA8));
+	FreeImage_Unload(dst);
+	return PaletteSize;
+}
+
 // ==========================================================
 
 FIBITMAP * DLL_CALLCONV
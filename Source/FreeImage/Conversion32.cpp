@@ -24,6 +24,7 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ConversionSIMD.h"
 
 // ----------------------------------------------------------
 //  internal conversions X to 32 bits
@@ -54,7 +55,10 @@ FreeImage_ConvertLine4To32(uint8_t *target, uint8_t *source, int width_in_pixels
 
 void DLL_CALLCONV
 FreeImage_ConvertLine8To32(uint8_t *target, uint8_t *source, int width_in_pixels, FIRGBA8 *palette) {
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	const int converted = GetConvertLineKernels().line8To32(target, source, width_in_pixels, palette);
+	target += 4 * converted;
+
+	for (int cols = converted; cols < width_in_pixels; cols++) {
 		const uint8_t idx = source[cols];
 
 		target[FI_RGBA_BLUE]	= palette[idx].blue;
@@ -69,7 +73,10 @@ void DLL_CALLCONV
 FreeImage_ConvertLine16To32_555(uint8_t *target, uint8_t *source, int width_in_pixels) {
 	uint16_t *bits = (uint16_t *)source;
 
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	const int converted = GetConvertLineKernels().line16To32_555(target, source, width_in_pixels);
+	target += 4 * converted;
+
+	for (int cols = converted; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = (uint8_t)((((bits[cols] & FI16_555_RED_MASK) >> FI16_555_RED_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_GREEN] = (uint8_t)((((bits[cols] & FI16_555_GREEN_MASK) >> FI16_555_GREEN_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_BLUE]  = (uint8_t)((((bits[cols] & FI16_555_BLUE_MASK) >> FI16_555_BLUE_SHIFT) * 0xFF) / 0x1F);
@@ -82,7 +89,10 @@ void DLL_CALLCONV
 FreeImage_ConvertLine16To32_565(uint8_t *target, uint8_t *source, int width_in_pixels) {
 	uint16_t *bits = (uint16_t *)source;
 
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	const int converted = GetConvertLineKernels().line16To32_565(target, source, width_in_pixels);
+	target += 4 * converted;
+
+	for (int cols = converted; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = (uint8_t)((((bits[cols] & FI16_565_RED_MASK) >> FI16_565_RED_SHIFT) * 0xFF) / 0x1F);
 		target[FI_RGBA_GREEN] = (uint8_t)((((bits[cols] & FI16_565_GREEN_MASK) >> FI16_565_GREEN_SHIFT) * 0xFF) / 0x3F);
 		target[FI_RGBA_BLUE]  = (uint8_t)((((bits[cols] & FI16_565_BLUE_MASK) >> FI16_565_BLUE_SHIFT) * 0xFF) / 0x1F);
@@ -107,7 +117,11 @@ The bug occurs in release mode only, when the image height is equal to 537
 */
 void DLL_CALLCONV
 FreeImage_ConvertLine24To32(uint8_t *target, uint8_t *source, int width_in_pixels) {
-	for (int cols = 0; cols < width_in_pixels; cols++) {
+	const int converted = GetConvertLineKernels().line24To32(target, source, width_in_pixels);
+	target += 4 * converted;
+	source += 3 * converted;
+
+	for (int cols = converted; cols < width_in_pixels; cols++) {
 		target[FI_RGBA_RED]   = source[FI_RGBA_RED];
 		target[FI_RGBA_GREEN] = source[FI_RGBA_GREEN];
 		target[FI_RGBA_BLUE]  = source[FI_RGBA_BLUE];
@@ -25,6 +25,7 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ConversionSIMD.h"
 
 // ----------------------------------------------------------
 //  internal conversions X to 8 bits
@@ -76,7 +77,10 @@ FreeImage_ConvertLine16To8_565(uint8_t *target, uint8_t *source, int width_in_pi
 
 void DLL_CALLCONV
 FreeImage_ConvertLine24To8(uint8_t *target, uint8_t *source, int width_in_pixels) {
-	for (unsigned cols = 0; cols < (unsigned)width_in_pixels; cols++) {
+	const int converted = GetConvertLineKernels().line24To8(target, source, width_in_pixels);
+	source += 3 * converted;
+
+	for (unsigned cols = converted; cols < (unsigned)width_in_pixels; cols++) {
 		target[cols] = GREY(source[FI_RGBA_RED], source[FI_RGBA_GREEN], source[FI_RGBA_BLUE]);
 		source += 3;
 	}
@@ -84,7 +88,10 @@ FreeImage_ConvertLine24To8(uint8_t *target, uint8_t *source, int width_in_pixels
 
 void DLL_CALLCONV
 FreeImage_ConvertLine32To8(uint8_t *target, uint8_t *source, int width_in_pixels) {
-	for (unsigned cols = 0; cols < (unsigned)width_in_pixels; cols++) {
+	const int converted = GetConvertLineKernels().line32To8(target, source, width_in_pixels);
+	source += 4 * converted;
+
+	for (unsigned cols = converted; cols < (unsigned)width_in_pixels; cols++) {
 		target[cols] = GREY(source[FI_RGBA_RED], source[FI_RGBA_GREEN], source[FI_RGBA_BLUE]);
 		source += 4;
 	}
@@ -0,0 +1,123 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "ConversionDither.h"
+#include "SimdFloat4.h"
+#include <algorithm>
+
+namespace
+{
+	/**
+	16x16 Bayer matrix thresholds, (index + 0.5) / 256.
+	The index is the bit reversed interleaving of (x ^ y) and y.
+	*/
+	struct BayerMatrix
+	{
+		float thresholds[16][16];
+
+		BayerMatrix()
+		{
+			for (unsigned y = 0; y < 16; y++) {
+				for (unsigned x = 0; x < 16; x++) {
+					const unsigned xc = x ^ y;
+					unsigned index = 0;
+					for (unsigned bit = 0; bit < 4; bit++) {
+						index = (index << 2) | (((xc >> bit) & 1) << 1) | ((y >> bit) & 1);
+					}
+					thresholds[y][x] = (index + 0.5F) / 256;
+				}
+			}
+		}
+	};
+
+	const BayerMatrix bayer_matrix;
+
+	/** Clamp to [0, 255], NaN gives 0 */
+	inline float
+	ClampByte(float v) {
+		return (v > 0) ? std::min(v, 255.F) : 0.F;
+	}
+
+	inline bool
+	IsAlpha(unsigned channels, unsigned c) {
+		return (channels == 4) && (c == FI_RGBA_ALPHA);
+	}
+
+} // namespace
+
+const float*
+OrderedDitherThresholds(unsigned y) {
+	return bayer_matrix.thresholds[y % 16];
+}
+
+void
+OrderedDitherRow(const float *values, unsigned width, unsigned channels, unsigned y, FREE_IMAGE_DEPTH_DITHER dither, uint8_t *dst) {
+	// thresholds of 16 pixels, a multiple of 4 values for any channel count
+	const unsigned period = 16 * channels;
+	alignas(16) float pattern[64];
+	const float *thresholds = OrderedDitherThresholds(y);
+	for (unsigned x = 0; x < 16; x++) {
+		for (unsigned c = 0; c < channels; c++) {
+			pattern[x * channels + c] = ((dither == FIDD_ORDERED) && !IsAlpha(channels, c)) ? thresholds[x] : 0.5F;
+		}
+	}
+
+	const unsigned count = width * channels;
+	const Float4 zero = Float4::Set(0);
+	const Float4 max = Float4::Set(255);
+	alignas(16) float q[4];
+	for (unsigned i = 0, p = 0; i < count; i += 4) {
+		// the sum stays below 256, truncation gives floor(v + threshold)
+		(Min(Max(Float4::Load(values + i), zero), max) + Float4::Load(pattern + p)).Store(q);
+		const unsigned n = std::min(4U, count - i);
+		for (unsigned k = 0; k < n; k++) {
+			dst[i + k] = (uint8_t)q[k];
+		}
+		p += 4;
+		if (p == period) {
+			p = 0;
+		}
+	}
+}
+
+ErrorDiffusionDither::ErrorDiffusionDither(unsigned width, unsigned channels)
+	: m_width(width), m_channels(channels), m_errors(2 * (static_cast<size_t>(width) + 2) * channels, 0.F) {
+}
+
+void
+ErrorDiffusionDither::DitherRow(const float *values, uint8_t *dst) {
+	const size_t row_length = (static_cast<size_t>(m_width) + 2) * m_channels;
+	float *current = m_errors.data() + (m_row % 2) * row_length;
+	float *next = m_errors.data() + ((m_row + 1) % 2) * row_length;
+	const bool forward = (m_row % 2) == 0;
+	const ptrdiff_t ahead = forward ? (ptrdiff_t)m_channels : -(ptrdiff_t)m_channels;
+
+	for (unsigned i = 0; i < m_width; i++) {
+		const unsigned x = forward ? i : m_width - 1 - i;
+		const float *v = values + static_cast<size_t>(x) * m_channels;
+		uint8_t *out = dst + static_cast<size_t>(x) * m_channels;
+		float *e = current + (static_cast<size_t>(x) + 1) * m_channels;
+		float *n = next + (static_cast<size_t>(x) + 1) * m_channels;
+
+		for (unsigned c = 0; c < m_channels; c++) {
+			if (IsAlpha(m_channels, c)) {
+				out[c] = (uint8_t)(ClampByte(v[c]) + 0.5F);
+				continue;
+			}
+			const float value = ClampByte(ClampByte(v[c]) + e[c]);
+			const float q = (float)(int)(value + 0.5F);
+			const float error = value - q;
+			out[c] = (uint8_t)q;
+			e[ahead + c] += error * (7.F / 16);
+			n[-ahead + c] += error * (3.F / 16);
+			n[c] += error * (5.F / 16);
+			n[ahead + c] += error * (1.F / 16);
+		}
+	}
+
+	std::fill(current, current + row_length, 0.F);
+	m_row++;
+}
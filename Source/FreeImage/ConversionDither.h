@@ -0,0 +1,96 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#ifndef FREEIMAGE_CONVERSION_DITHER_H_
+#define FREEIMAGE_CONVERSION_DITHER_H_
+
+#include "FreeImage.h"
+#include "ParallelFor.h"
+#include <vector>
+
+// ----------------------------------------------------------
+//  Dithered reduction of high bit depth values to 8-bit
+// ----------------------------------------------------------
+
+/** Number of floats of a row buffer of 'count' values, rounded up to whole Float4 vectors */
+inline size_t
+DitherRowLength(size_t count) {
+	return (count + 3) & ~static_cast<size_t>(3);
+}
+
+/**
+Thresholds of the row y of the 16x16 Bayer matrix, in (0, 1).
+A value v in [0, 255] is dithered to floor(v + threshold), the mean of the output over the matrix is v.
+@return Returns 16 thresholds, one per column x % 16
+*/
+const float* OrderedDitherThresholds(unsigned y);
+
+/**
+Rounding or ordered dithering of a row of 'width' pixels of 'channels' interleaved values in [0, 255].
+Values out of range are clamped, NaN values give 0. The alpha channel of 4-channel pixels is rounded.
+Vectorized, rows can be processed in any order.
+@param values DitherRowLength(width * channels) values
+@param y Row index
+@param dither FIDD_NONE or FIDD_ORDERED
+@param dst Output row, width * channels bytes
+*/
+void OrderedDitherRow(const float *values, unsigned width, unsigned channels, unsigned y, FREE_IMAGE_DEPTH_DITHER dither, uint8_t *dst);
+
+/**
+Floyd & Steinberg error diffusion of the rows of an image, serpentine scan.
+The rows must be given in order, the alpha channel of 4-channel pixels is rounded.
+*/
+class ErrorDiffusionDither
+{
+public:
+	ErrorDiffusionDither(unsigned width, unsigned channels);
+
+	/** Dither the next row, see OrderedDitherRow */
+	void DitherRow(const float *values, uint8_t *dst);
+
+private:
+	unsigned m_width;
+	unsigned m_channels;
+	unsigned m_row = 0;
+	std::vector<float> m_errors;	// current and next row errors, one pixel of margin on both sides
+};
+
+/**
+Reduce the rows of an image to the 8-bit rows of dst, with the given dithering.
+Rounding and ordered dithering run in parallel over bands of rows, error diffusion is sequential.
+@param dst 8-, 24- or 32-bit destination image
+@param channels Number of values per pixel of dst
+@param src_row_bytes Amount of source data per row, used to size the bands
+@param load_row Called as load_row(unsigned y, float *values), fills the width * channels values of the row y
+in the channel order of dst, in [0, 255]. It may be called from several threads.
+*/
+template <typename LoadRow_>
+void DitherRowsToBytes(FIBITMAP *dst, unsigned channels, FREE_IMAGE_DEPTH_DITHER dither, size_t src_row_bytes, LoadRow_ load_row)
+{
+	const unsigned width = FreeImage_GetWidth(dst);
+	const unsigned height = FreeImage_GetHeight(dst);
+	const size_t length = DitherRowLength(static_cast<size_t>(width) * channels);
+
+	if (dither == FIDD_FLOYD_STEINBERG) {
+		std::vector<float> values(length);
+		ErrorDiffusionDither diffusion(width, channels);
+		for (unsigned y = 0; y < height; y++) {
+			load_row(y, values.data());
+			diffusion.DitherRow(values.data(), FreeImage_GetScanLine(dst, y));
+		}
+		return;
+	}
+
+	ParallelForRows(height, src_row_bytes + static_cast<size_t>(width) * channels, [&](unsigned first_row, unsigned end_row) {
+		std::vector<float> values(length);
+		for (unsigned y = first_row; y < end_row; y++) {
+			load_row(y, values.data());
+			OrderedDitherRow(values.data(), width, channels, y, dither, FreeImage_GetScanLine(dst, y));
+		}
+	});
+}
+
+#endif // FREEIMAGE_CONVERSION_DITHER_H_
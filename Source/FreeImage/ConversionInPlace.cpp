@@ -0,0 +1,156 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "FreeImage.h"
+#include "Utilities.h"
+#include "SimpleTools.h"
+#include <algorithm>
+#include <cstring>
+
+// ----------------------------------------------------------
+
+/**
+Convert a bitmap (or a band of a bitmap) to the target format
+*/
+static FIBITMAP*
+ConvertBitmap(FIBITMAP *src, FREE_IMAGE_TYPE dst_type, unsigned dst_bpp) {
+	if (dst_type != FIT_BITMAP) {
+		return FreeImage_ConvertToType(src, dst_type, TRUE);
+	}
+	switch (dst_bpp) {
+		case 4:
+			return FreeImage_ConvertTo4Bits(src);
+		case 8:
+			return FreeImage_ConvertTo8Bits(src);
+		case 16:
+			return FreeImage_ConvertTo16Bits565(src);
+		case 24:
+			return FreeImage_ConvertTo24Bits(src);
+		case 32:
+			return FreeImage_ConvertTo32Bits(src);
+	}
+	return nullptr;
+}
+
+/**
+Source rows of a bitmap, wrapped band by band
+*/
+struct BandSource {
+	uint8_t *bits;
+	unsigned pitch;
+	FREE_IMAGE_TYPE type;
+	unsigned width;
+	unsigned bpp;
+	unsigned masks[3];
+
+	explicit BandSource(FIBITMAP *dib)
+		: bits(FreeImage_GetBits(dib)), pitch(FreeImage_GetPitch(dib)), type(FreeImage_GetImageType(dib)),
+		  width(FreeImage_GetWidth(dib)), bpp(FreeImage_GetBPP(dib)),
+		  masks{ FreeImage_GetRedMask(dib), FreeImage_GetGreenMask(dib), FreeImage_GetBlueMask(dib) } {
+	}
+
+	/** Wrap the rows [first_row, end_row) */
+	FIBITMAP* view(unsigned first_row, unsigned end_row) const {
+		return FreeImage_AllocateHeaderForBits(bits + (size_t)first_row * pitch, pitch, type, width, end_row - first_row, bpp,
+			masks[0], masks[1], masks[2]);
+	}
+};
+
+/**
+Check that converted pixels can be written over the source pixels : pixels owned by the bitmap
+(not a wrapped user buffer nor the bitmap of a view, which other pixel formats must not overwrite),
+no palette nor masks on both sides (so that the pixels start at the same address) and lines not wider.
+*/
+static bool
+CanConvertInPlace(FIBITMAP *dib, FIBITMAP *format) {
+	auto has_header_data = [](FIBITMAP *bitmap) {
+		return (FreeImage_GetColorsUsed(bitmap) != 0) || FreeImage_HasRGBMasks(bitmap);
+	};
+	return !FreeImage_HasExternalBits(dib) && !has_header_data(dib) && !has_header_data(format) && (FreeImage_GetLine(format) <= FreeImage_GetLine(dib));
+}
+
+FIBOOL DLL_CALLCONV
+FreeImage_ConvertInPlace(FIBITMAP *dib, FREE_IMAGE_TYPE dst_type, unsigned dst_bpp) {
+	if (!FreeImage_HasPixels(dib)) {
+		return FALSE;
+	}
+	const FREE_IMAGE_TYPE src_type = FreeImage_GetImageType(dib);
+	if ((src_type == dst_type) && ((dst_type != FIT_BITMAP) || (FreeImage_GetBPP(dib) == dst_bpp))) {
+		return TRUE;
+	}
+
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+
+	// bands of about 256 KB of converted pixels
+	const size_t dst_line_estimate = (size_t)width * std::max(dst_bpp, 8U) / 8;
+	const unsigned band_rows = (unsigned)std::clamp<size_t>((256 * 1024) / std::max<size_t>(1, dst_line_estimate), 1, height);
+
+	// the first band tells whether the conversion exists and which format it produces
+
+	const BandSource source(dib);
+
+	UniqueBitmap band(nullptr, &::FreeImage_Unload);
+	{
+		UniqueBitmap view(source.view(0, band_rows), &::FreeImage_Unload);
+		if (!view) {
+			return FALSE;
+		}
+		band.reset(ConvertBitmap(view.get(), dst_type, dst_bpp));
+		if (!band) {
+			return FALSE;
+		}
+	}
+
+	if (!CanConvertInPlace(dib, band.get())) {
+		// wider pixels, different palette or external pixels : convert into a new buffer
+		UniqueBitmap converted(ConvertBitmap(dib, dst_type, dst_bpp), &::FreeImage_Unload);
+		if (!converted) {
+			return FALSE;
+		}
+		FreeImage_ReplacePixels(dib, converted.release());
+		return TRUE;
+	}
+
+	// switch to the target format : pixels stay at the same address, the pitch shrinks
+
+	FreeImage_SetPixelFormat(dib, band.get());
+	uint8_t *bits = FreeImage_GetBits(dib);
+	const unsigned dst_pitch = FreeImage_GetPitch(dib);
+	const unsigned dst_line = FreeImage_GetLine(dib);
+
+	// convert the bands in order, writing every converted row at its place with the new pitch.
+	// Rows are walked forward and the new pitch is not larger than the old one,
+	// so a band never overwrites the source rows of the next bands.
+
+	for (unsigned first_row = 0; first_row < height; first_row += band_rows) {
+		const unsigned end_row = std::min(height, first_row + band_rows);
+		if (first_row > 0) {
+			UniqueBitmap view(source.view(first_row, end_row), &::FreeImage_Unload);
+			band.reset(view ? ConvertBitmap(view.get(), dst_type, dst_bpp) : nullptr);
+		}
+		if (band) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				memcpy(bits + (size_t)y * dst_pitch, FreeImage_GetScanLine(band.get(), y - first_row), dst_line);
+			}
+			continue;
+		}
+		// low memory : retry the band one row at a time, so that the image is left half converted
+		// only when a single row cannot be converted
+		for (unsigned y = first_row; y < end_row; y++) {
+			UniqueBitmap view(source.view(y, y + 1), &::FreeImage_Unload);
+			UniqueBitmap row(view ? ConvertBitmap(view.get(), dst_type, dst_bpp) : nullptr, &::FreeImage_Unload);
+			if (!row) {
+				// the pixel format is already switched : the pixel values are undefined
+				FreeImage_OutputMessageProc(FIF_UNKNOWN, "FreeImage_ConvertInPlace: conversion failed at row %u", y);
+				return FALSE;
+			}
+			memcpy(bits + (size_t)y * dst_pitch, FreeImage_GetScanLine(row.get(), 0), dst_line);
+		}
+	}
+
+	return TRUE;
+}
@@ -0,0 +1,867 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "FreeImage.h"
+#include "ConversionSIMD.h"
+#include <atomic>
+#include <cstdlib>
+#include <string_view>
+
+#ifndef FREEIMAGE_BIGENDIAN
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define FI_SIMD_X86 1
+	#include <immintrin.h>
+	#if defined(__GNUC__) || defined(__clang__)
+		#define FI_TARGET_SSSE3 __attribute__((target("ssse3")))
+		#define FI_TARGET_AVX2 __attribute__((target("avx2")))
+	#else
+		#include <intrin.h>
+		#define FI_TARGET_SSSE3
+		#define FI_TARGET_AVX2
+	#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define FI_SIMD_NEON 1
+	#include <arm_neon.h>
+#endif
+#endif // FREEIMAGE_BIGENDIAN
+
+// ----------------------------------------------------------
+//  Scalar kernels : the exported routines do all the work
+// ----------------------------------------------------------
+
+static int
+NoLineKernel(uint8_t * /*target*/, const uint8_t * /*source*/, int /*width_in_pixels*/) {
+	return 0;
+}
+
+static int
+NoPaletteKernel(uint8_t * /*target*/, const uint8_t * /*source*/, int /*width_in_pixels*/, const FIRGBA8 * /*palette*/) {
+	return 0;
+}
+
+static const ConvertLineKernels s_scalar_kernels = {
+	NoLineKernel, NoLineKernel, NoLineKernel, NoLineKernel,
+	NoLineKernel, NoLineKernel, NoLineKernel, NoLineKernel,
+	NoPaletteKernel
+};
+
+static int
+NoSplitKernel(uint8_t *const * /*planes*/, const uint8_t * /*source*/, int /*width_in_pixels*/) {
+	return 0;
+}
+
+static int
+NoMergeKernel(uint8_t * /*target*/, const uint8_t *const * /*planes*/, int /*width_in_pixels*/) {
+	return 0;
+}
+
+static const ChannelLineKernels s_scalar_channel_kernels = {
+	{ { NoSplitKernel, NoSplitKernel }, { NoSplitKernel, NoSplitKernel }, { NoSplitKernel, NoSplitKernel } },
+	{ { NoMergeKernel, NoMergeKernel }, { NoMergeKernel, NoMergeKernel }, { NoMergeKernel, NoMergeKernel } }
+};
+
+#ifdef FI_SIMD_X86
+
+// ----------------------------------------------------------
+//  SSSE3 kernels
+// ----------------------------------------------------------
+
+/**
+Shuffle mask inserting a zero byte after each 24-bit pixel (4 pixels)
+*/
+FI_TARGET_SSSE3 static inline __m128i
+Expand24Mask_SSSE3() {
+	return _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+}
+
+/**
+Shuffle mask dropping the alpha byte of 32-bit pixels (4 pixels packed in the 12 low bytes)
+*/
+FI_TARGET_SSSE3 static inline __m128i
+Pack24Mask_SSSE3() {
+	return _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+}
+
+/**
+Greyscale value of 4 32-bit pixels, as 32-bit integers.
+The float operations are those of the GREY macro, in the same order, so that results are identical.
+*/
+FI_TARGET_SSSE3 static inline __m128i
+Grey4_SSSE3(__m128i pixels) {
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128 r = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8 * FI_RGBA_RED), mask));
+	const __m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8 * FI_RGBA_GREEN), mask));
+	const __m128 b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8 * FI_RGBA_BLUE), mask));
+	__m128 luma = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.2126F), r), _mm_mul_ps(_mm_set1_ps(0.7152F), g));
+	luma = _mm_add_ps(luma, _mm_mul_ps(_mm_set1_ps(0.0722F), b));
+	return _mm_cvttps_epi32(_mm_add_ps(luma, _mm_set1_ps(0.5F)));
+}
+
+/**
+Pack 16 greyscale values (4 x 4 32-bit integers in [0..255]) to bytes
+*/
+FI_TARGET_SSSE3 static inline __m128i
+PackGrey16_SSSE3(__m128i y0, __m128i y1, __m128i y2, __m128i y3) {
+	return _mm_packus_epi16(_mm_packs_epi32(y0, y1), _mm_packs_epi32(y2, y3));
+}
+
+/**
+Expand 8 16-bit pixels to 32-bit pixels.
+Channels are scaled with an exact integer form of (v * 0xFF) / 0x1F and (v * 0xFF) / 0x3F :
+mulhi((v << 4), 33693) and mulhi((v << 3), 33159).
+*/
+template <bool k565>
+FI_TARGET_SSSE3 static inline void
+Expand16_SSSE3(__m128i pixels, __m128i& lo, __m128i& hi) {
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i scale5 = _mm_set1_epi16((short)33693);
+	__m128i c[3];
+	if constexpr (k565) {
+		c[FI_RGBA_RED] = _mm_and_si128(_mm_srli_epi16(pixels, FI16_565_RED_SHIFT), mask5);
+		c[FI_RGBA_GREEN] = _mm_and_si128(_mm_srli_epi16(pixels, FI16_565_GREEN_SHIFT), _mm_set1_epi16(0x3F));
+		c[FI_RGBA_GREEN] = _mm_mulhi_epu16(_mm_slli_epi16(c[FI_RGBA_GREEN], 3), _mm_set1_epi16((short)33159));
+	} else {
+		c[FI_RGBA_RED] = _mm_and_si128(_mm_srli_epi16(pixels, FI16_555_RED_SHIFT), mask5);
+		c[FI_RGBA_GREEN] = _mm_and_si128(_mm_srli_epi16(pixels, FI16_555_GREEN_SHIFT), mask5);
+		c[FI_RGBA_GREEN] = _mm_mulhi_epu16(_mm_slli_epi16(c[FI_RGBA_GREEN], 4), scale5);
+	}
+	c[FI_RGBA_BLUE] = _mm_and_si128(pixels, mask5);
+	c[FI_RGBA_RED] = _mm_mulhi_epu16(_mm_slli_epi16(c[FI_RGBA_RED], 4), scale5);
+	c[FI_RGBA_BLUE] = _mm_mulhi_epu16(_mm_slli_epi16(c[FI_RGBA_BLUE], 4), scale5);
+
+	// bytes 0 and 1, bytes 2 and 3 (alpha) of each pixel
+	const __m128i c01 = _mm_or_si128(c[0], _mm_slli_epi16(c[1], 8));
+	const __m128i c23 = _mm_or_si128(c[2], _mm_set1_epi16((short)0xFF00));
+	lo = _mm_unpacklo_epi16(c01, c23);
+	hi = _mm_unpackhi_epi16(c01, c23);
+}
+
+FI_TARGET_SSSE3 static int
+Line24To32_SSSE3(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const __m128i expand = Expand24Mask_SSSE3();
+	const __m128i alpha = _mm_set1_epi32((int)FI_RGBA_ALPHA_MASK);
+	int cols = 0;
+	for (; cols + 16 <= width_in_pixels; cols += 16) {
+		const __m128i a = _mm_loadu_si128((const __m128i*)source);
+		const __m128i b = _mm_loadu_si128((const __m128i*)(source + 16));
+		const __m128i c = _mm_loadu_si128((const __m128i*)(source + 32));
+		_mm_storeu_si128((__m128i*)target, _mm_or_si128(_mm_shuffle_epi8(a, expand), alpha));
+		_mm_storeu_si128((__m128i*)(target + 16), _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), expand), alpha));
+		_mm_storeu_si128((__m128i*)(target + 32), _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), expand), alpha));
+		_mm_storeu_si128((__m128i*)(target + 48), _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), expand), alpha));
+		source += 48;
+		target += 64;
+	}
+	return cols;
+}
+
+FI_TARGET_SSSE3 static int
+Line32To24_SSSE3(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const __m128i pack = Pack24Mask_SSSE3();
+	int cols = 0;
+	for (; cols + 16 <= width_in_pixels; cols += 16) {
+		const __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)source), pack);
+		const __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + 16)), pack);
+		const __m128i s2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + 32)), pack);
+		const __m128i s3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + 48)), pack);
+		_mm_storeu_si128((__m128i*)target, _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+		_mm_storeu_si128((__m128i*)(target + 16), _mm_or_si128(_mm_srli_si128(s1, 4), _mm_slli_si128(s2, 8)));
+		_mm_storeu_si128((__m128i*)(target + 32), _mm_or_si128(_mm_srli_si128(s2, 8), _mm_slli_si128(s3, 4)));
+		source += 64;
+		target += 48;
+	}
+	return cols;
+}
+
+FI_TARGET_SSSE3 static int
+Line24To8_SSSE3(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const __m128i expand = Expand24Mask_SSSE3();
+	int cols = 0;
+	for (; cols + 16 <= width_in_pixels; cols += 16) {
+		const __m128i a = _mm_loadu_si128((const __m128i*)source);
+		const __m128i b = _mm_loadu_si128((const __m128i*)(source + 16));
+		const __m128i c = _mm_loadu_si128((const __m128i*)(source + 32));
+		const __m128i y0 = Grey4_SSSE3(_mm_shuffle_epi8(a, expand));
+		const __m128i y1 = Grey4_SSSE3(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), expand));
+		const __m128i y2 = Grey4_SSSE3(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), expand));
+		const __m128i y3 = Grey4_SSSE3(_mm_shuffle_epi8(_mm_srli_si128(c, 4), expand));
+		_mm_storeu_si128((__m128i*)(target + cols), PackGrey16_SSSE3(y0, y1, y2, y3));
+		source += 48;
+	}
+	return cols;
+}
+
+FI_TARGET_SSSE3 static int
+Line32To8_SSSE3(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	int cols = 0;
+	for (; cols + 16 <= width_in_pixels; cols += 16) {
+		const __m128i y0 = Grey4_SSSE3(_mm_loadu_si128((const __m128i*)source));
+		const __m128i y1 = Grey4_SSSE3(_mm_loadu_si128((const __m128i*)(source + 16)));
+		const __m128i y2 = Grey4_SSSE3(_mm_loadu_si128((const __m128i*)(source + 32)));
+		const __m128i y3 = Grey4_SSSE3(_mm_loadu_si128((const __m128i*)(source + 48)));
+		_mm_storeu_si128((__m128i*)(target + cols), PackGrey16_SSSE3(y0, y1, y2, y3));
+		source += 64;
+	}
+	return cols;
+}
+
+template <bool k565>
+FI_TARGET_SSSE3 static int
+Line16To24_SSSE3(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const __m128i pack = Pack24Mask_SSSE3();
+	int cols = 0;
+	for (; cols + 8 <= width_in_pixels; cols += 8) {
+		__m128i lo, hi;
+		Expand16_SSSE3<k565>(_mm_loadu_si128((const __m128i*)source), lo, hi);
+		const __m128i s0 = _mm_shuffle_epi8(lo, pack);
+		const __m128i s1 = _mm_shuffle_epi8(hi, pack);
+		_mm_storeu_si128((__m128i*)target, _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+		_mm_storel_epi64((__m128i*)(target + 16), _mm_srli_si128(s1, 4));
+		source += 16;
+		target += 24;
+	}
+	return cols;
+}
+
+template <bool k565>
+FI_TARGET_SSSE3 static int
+Line16To32_SSSE3(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	int cols = 0;
+	for (; cols + 8 <= width_in_pixels; cols += 8) {
+		__m128i lo, hi;
+		Expand16_SSSE3<k565>(_mm_loadu_si128((const __m128i*)source), lo, hi);
+		_mm_storeu_si128((__m128i*)target, lo);
+		_mm_storeu_si128((__m128i*)(target + 16), hi);
+		source += 16;
+		target += 32;
+	}
+	return cols;
+}
+
+static const ConvertLineKernels s_ssse3_kernels = {
+	Line24To32_SSSE3, Line32To24_SSSE3, Line24To8_SSSE3, Line32To8_SSSE3,
+	Line16To24_SSSE3<false>, Line16To24_SSSE3<true>, Line16To32_SSSE3<false>, Line16To32_SSSE3<true>,
+	NoPaletteKernel
+};
+
+// ----------------------------------------------------------
+//  SSSE3 channel kernels
+// ----------------------------------------------------------
+
+/**
+Shuffle masks of 3 interleaved channels of Size_ bytes, 48 bytes of pixels against 3 planes of 16 bytes.
+The plane k is the union of the shuffles of the 3 source vectors r by split[k][r],
+the target vector r is the union of the shuffles of the 3 planes k by merge[r][k].
+*/
+template <unsigned Size_>
+struct Shuffle3Masks
+{
+	alignas(16) int8_t split[3][3][16]{};
+	alignas(16) int8_t merge[3][3][16]{};
+
+	constexpr Shuffle3Masks() {
+		for (unsigned k = 0; k < 3; k++) {
+			for (unsigned r = 0; r < 3; r++) {
+				for (unsigned b = 0; b < 16; b++) {
+					// byte b of the plane k, from the interleaved byte 'from'
+					const unsigned from = ((b / Size_) * 3 + k) * Size_ + b % Size_;
+					split[k][r][b] = (from / 16 == r) ? (int8_t)(from % 16) : (int8_t)-128;
+					// byte b of the target vector r, from the byte 'to' of the plane of its channel
+					const unsigned value = (16 * r + b) / Size_;
+					const unsigned to = (value / 3) * Size_ + (16 * r + b) % Size_;
+					merge[r][k][b] = (value % 3 == k) ? (int8_t)to : (int8_t)-128;
+				}
+			}
+		}
+	}
+};
+
+/**
+Shuffle masks of 4 interleaved channels of Size_ bytes inside a vector : split gathers the values of
+the channel k in the 32-bit lane k, merge is the inverse permutation
+*/
+template <unsigned Size_>
+struct Shuffle4Masks
+{
+	alignas(16) int8_t split[16]{};
+	alignas(16) int8_t merge[16]{};
+
+	constexpr Shuffle4Masks() {
+		for (unsigned b = 0; b < 16; b++) {
+			const unsigned k = b / 4;
+			const unsigned from = ((b % 4) / Size_) * 4 * Size_ + k * Size_ + b % Size_;
+			split[b] = (int8_t)from;
+			merge[from] = (int8_t)b;
+		}
+	}
+};
+
+template <unsigned Size_>
+static constexpr Shuffle3Masks<Size_> s_shuffle3_masks{};
+
+template <unsigned Size_>
+static constexpr Shuffle4Masks<Size_> s_shuffle4_masks{};
+
+FI_TARGET_SSSE3 static inline __m128i
+Shuffle3_SSSE3(__m128i a, __m128i b, __m128i c, const int8_t (*masks)[16]) {
+	const __m128i ab = _mm_or_si128(_mm_shuffle_epi8(a, _mm_load_si128((const __m128i*)masks[0])), _mm_shuffle_epi8(b, _mm_load_si128((const __m128i*)masks[1])));
+	return _mm_or_si128(ab, _mm_shuffle_epi8(c, _mm_load_si128((const __m128i*)masks[2])));
+}
+
+FI_TARGET_SSSE3 static inline void
+Transpose4x32_SSSE3(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3) {
+	const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	r0 = _mm_unpacklo_epi64(t0, t1);
+	r1 = _mm_unpackhi_epi64(t0, t1);
+	r2 = _mm_unpacklo_epi64(t2, t3);
+	r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+template <unsigned Size_>
+FI_TARGET_SSSE3 static int
+Split3_SSSE3(uint8_t *const *planes, const uint8_t *source, int width_in_pixels) {
+	const auto& masks = s_shuffle3_masks<Size_>;
+	const int block = 16 / Size_;
+	int cols = 0;
+	for (; cols + block <= width_in_pixels; cols += block) {
+		const __m128i a = _mm_loadu_si128((const __m128i*)source);
+		const __m128i b = _mm_loadu_si128((const __m128i*)(source + 16));
+		const __m128i c = _mm_loadu_si128((const __m128i*)(source + 32));
+		_mm_storeu_si128((__m128i*)(planes[0] + cols * Size_), Shuffle3_SSSE3(a, b, c, masks.split[0]));
+		_mm_storeu_si128((__m128i*)(planes[1] + cols * Size_), Shuffle3_SSSE3(a, b, c, masks.split[1]));
+		_mm_storeu_si128((__m128i*)(planes[2] + cols * Size_), Shuffle3_SSSE3(a, b, c, masks.split[2]));
+		source += 48;
+	}
+	return cols;
+}
+
+template <unsigned Size_>
+FI_TARGET_SSSE3 static int
+Merge3_SSSE3(uint8_t *target, const uint8_t *const *planes, int width_in_pixels) {
+	const auto& masks = s_shuffle3_masks<Size_>;
+	const int block = 16 / Size_;
+	int cols = 0;
+	for (; cols + block <= width_in_pixels; cols += block) {
+		const __m128i p0 = _mm_loadu_si128((const __m128i*)(planes[0] + cols * Size_));
+		const __m128i p1 = _mm_loadu_si128((const __m128i*)(planes[1] + cols * Size_));
+		const __m128i p2 = _mm_loadu_si128((const __m128i*)(planes[2] + cols * Size_));
+		_mm_storeu_si128((__m128i*)target, Shuffle3_SSSE3(p0, p1, p2, masks.merge[0]));
+		_mm_storeu_si128((__m128i*)(target + 16), Shuffle3_SSSE3(p0, p1, p2, masks.merge[1]));
+		_mm_storeu_si128((__m128i*)(target + 32), Shuffle3_SSSE3(p0, p1, p2, masks.merge[2]));
+		target += 48;
+	}
+	return cols;
+}
+
+template <unsigned Size_>
+FI_TARGET_SSSE3 static int
+Split4_SSSE3(uint8_t *const *planes, const uint8_t *source, int width_in_pixels) {
+	const __m128i group = _mm_load_si128((const __m128i*)s_shuffle4_masks<Size_>.split);
+	const int block = 16 / Size_;
+	int cols = 0;
+	for (; cols + block <= width_in_pixels; cols += block) {
+		__m128i r0 = _mm_loadu_si128((const __m128i*)source);
+		__m128i r1 = _mm_loadu_si128((const __m128i*)(source + 16));
+		__m128i r2 = _mm_loadu_si128((const __m128i*)(source + 32));
+		__m128i r3 = _mm_loadu_si128((const __m128i*)(source + 48));
+		if (Size_ != 4) {
+			r0 = _mm_shuffle_epi8(r0, group);
+			r1 = _mm_shuffle_epi8(r1, group);
+			r2 = _mm_shuffle_epi8(r2, group);
+			r3 = _mm_shuffle_epi8(r3, group);
+		}
+		Transpose4x32_SSSE3(r0, r1, r2, r3);
+		_mm_storeu_si128((__m128i*)(planes[0] + cols * Size_), r0);
+		_mm_storeu_si128((__m128i*)(planes[1] + cols * Size_), r1);
+		_mm_storeu_si128((__m128i*)(planes[2] + cols * Size_), r2);
+		_mm_storeu_si128((__m128i*)(planes[3] + cols * Size_), r3);
+		source += 64;
+	}
+	return cols;
+}
+
+template <unsigned Size_>
+FI_TARGET_SSSE3 static int
+Merge4_SSSE3(uint8_t *target, const uint8_t *const *planes, int width_in_pixels) {
+	const __m128i ungroup = _mm_load_si128((const __m128i*)s_shuffle4_masks<Size_>.merge);
+	const int block = 16 / Size_;
+	int cols = 0;
+	for (; cols + block <= width_in_pixels; cols += block) {
+		__m128i r0 = _mm_loadu_si128((const __m128i*)(planes[0] + cols * Size_));
+		__m128i r1 = _mm_loadu_si128((const __m128i*)(planes[1] + cols * Size_));
+		__m128i r2 = _mm_loadu_si128((const __m128i*)(planes[2] + cols * Size_));
+		__m128i r3 = _mm_loadu_si128((const __m128i*)(planes[3] + cols * Size_));
+		Transpose4x32_SSSE3(r0, r1, r2, r3);
+		if (Size_ != 4) {
+			r0 = _mm_shuffle_epi8(r0, ungroup);
+			r1 = _mm_shuffle_epi8(r1, ungroup);
+			r2 = _mm_shuffle_epi8(r2, ungroup);
+			r3 = _mm_shuffle_epi8(r3, ungroup);
+		}
+		_mm_storeu_si128((__m128i*)target, r0);
+		_mm_storeu_si128((__m128i*)(target + 16), r1);
+		_mm_storeu_si128((__m128i*)(target + 32), r2);
+		_mm_storeu_si128((__m128i*)(target + 48), r3);
+		target += 64;
+	}
+	return cols;
+}
+
+static const ChannelLineKernels s_ssse3_channel_kernels = {
+	{ { Split3_SSSE3<1>, Split4_SSSE3<1> }, { Split3_SSSE3<2>, Split4_SSSE3<2> }, { Split3_SSSE3<4>, Split4_SSSE3<4> } },
+	{ { Merge3_SSSE3<1>, Merge4_SSSE3<1> }, { Merge3_SSSE3<2>, Merge4_SSSE3<2> }, { Merge3_SSSE3<4>, Merge4_SSSE3<4> } }
+};
+
+// ----------------------------------------------------------
+//  AVX2 kernels
+// ----------------------------------------------------------
+
+/**
+Load 8 24-bit pixels as 8 32-bit pixels (the alpha byte is zero).
+Reads 32 bytes, i.e. 8 bytes beyond the pixels.
+*/
+FI_TARGET_AVX2 static inline __m256i
+Load24As32_AVX2(const uint8_t *source) {
+	const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+	const __m256i expand = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i pixels = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)source), spread);
+	return _mm256_shuffle_epi8(pixels, expand);
+}
+
+/**
+Greyscale value of 8 32-bit pixels (see Grey4_SSSE3)
+*/
+FI_TARGET_AVX2 static inline __m256i
+Grey8_AVX2(__m256i pixels) {
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	const __m256 r = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, 8 * FI_RGBA_RED), mask));
+	const __m256 g = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, 8 * FI_RGBA_GREEN), mask));
+	const __m256 b = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, 8 * FI_RGBA_BLUE), mask));
+	__m256 luma = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.2126F), r), _mm256_mul_ps(_mm256_set1_ps(0.7152F), g));
+	luma = _mm256_add_ps(luma, _mm256_mul_ps(_mm256_set1_ps(0.0722F), b));
+	return _mm256_cvttps_epi32(_mm256_add_ps(luma, _mm256_set1_ps(0.5F)));
+}
+
+/**
+Pack 32 greyscale values (4 x 8 32-bit integers in [0..255]) to bytes
+*/
+FI_TARGET_AVX2 static inline __m256i
+PackGrey32_AVX2(__m256i y0, __m256i y1, __m256i y2, __m256i y3) {
+	// packing works within 128-bit lanes : restore the pixel order afterwards
+	const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(y0, y1), _mm256_packs_epi32(y2, y3));
+	return _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+FI_TARGET_AVX2 static int
+Line24To32_AVX2(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const __m256i alpha = _mm256_set1_epi32((int)FI_RGBA_ALPHA_MASK);
+	int cols = 0;
+	// 8 pixels per load, the last load must not read beyond the line
+	for (; (cols + 8) * 3 + 8 <= width_in_pixels * 3; cols += 8) {
+		_mm256_storeu_si256((__m256i*)target, _mm256_or_si256(Load24As32_AVX2(source), alpha));
+		source += 24;
+		target += 32;
+	}
+	return cols;
+}
+
+FI_TARGET_AVX2 static int
+Line32To24_AVX2(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const __m256i pack = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const __m256i gather = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+	int cols = 0;
+	for (; cols + 8 <= width_in_pixels; cols += 8) {
+		const __m256i pixels = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)source), pack), gather);
+		_mm_storeu_si128((__m128i*)target, _mm256_castsi256_si128(pixels));
+		_mm_storel_epi64((__m128i*)(target + 16), _mm256_extracti128_si256(pixels, 1));
+		source += 32;
+		target += 24;
+	}
+	return cols;
+}
+
+FI_TARGET_AVX2 static int
+Line24To8_AVX2(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	int cols = 0;
+	// 32 pixels per iteration, the last load must not read beyond the line
+	for (; (cols + 32) * 3 + 8 <= width_in_pixels * 3; cols += 32) {
+		const __m256i y0 = Grey8_AVX2(Load24As32_AVX2(source));
+		const __m256i y1 = Grey8_AVX2(Load24As32_AVX2(source + 24));
+		const __m256i y2 = Grey8_AVX2(Load24As32_AVX2(source + 48));
+		const __m256i y3 = Grey8_AVX2(Load24As32_AVX2(source + 72));
+		_mm256_storeu_si256((__m256i*)(target + cols), PackGrey32_AVX2(y0, y1, y2, y3));
+		source += 96;
+	}
+	return cols;
+}
+
+FI_TARGET_AVX2 static int
+Line32To8_AVX2(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	int cols = 0;
+	for (; cols + 32 <= width_in_pixels; cols += 32) {
+		const __m256i y0 = Grey8_AVX2(_mm256_loadu_si256((const __m256i*)source));
+		const __m256i y1 = Grey8_AVX2(_mm256_loadu_si256((const __m256i*)(source + 32)));
+		const __m256i y2 = Grey8_AVX2(_mm256_loadu_si256((const __m256i*)(source + 64)));
+		const __m256i y3 = Grey8_AVX2(_mm256_loadu_si256((const __m256i*)(source + 96)));
+		_mm256_storeu_si256((__m256i*)(target + cols), PackGrey32_AVX2(y0, y1, y2, y3));
+		source += 128;
+	}
+	return cols;
+}
+
+template <bool k565>
+FI_TARGET_AVX2 static int
+Line16To32_AVX2(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const __m256i mask5 = _mm256_set1_epi16(0x1F);
+	const __m256i scale5 = _mm256_set1_epi16((short)33693);
+	int cols = 0;
+	for (; cols + 16 <= width_in_pixels; cols += 16) {
+		const __m256i pixels = _mm256_loadu_si256((const __m256i*)source);
+		__m256i c[3];
+		if constexpr (k565) {
+			c[FI_RGBA_RED] = _mm256_and_si256(_mm256_srli_epi16(pixels, FI16_565_RED_SHIFT), mask5);
+			c[FI_RGBA_GREEN] = _mm256_and_si256(_mm256_srli_epi16(pixels, FI16_565_GREEN_SHIFT), _mm256_set1_epi16(0x3F));
+			c[FI_RGBA_GREEN] = _mm256_mulhi_epu16(_mm256_slli_epi16(c[FI_RGBA_GREEN], 3), _mm256_set1_epi16((short)33159));
+		} else {
+			c[FI_RGBA_RED] = _mm256_and_si256(_mm256_srli_epi16(pixels, FI16_555_RED_SHIFT), mask5);
+			c[FI_RGBA_GREEN] = _mm256_and_si256(_mm256_srli_epi16(pixels, FI16_555_GREEN_SHIFT), mask5);
+			c[FI_RGBA_GREEN] = _mm256_mulhi_epu16(_mm256_slli_epi16(c[FI_RGBA_GREEN], 4), scale5);
+		}
+		c[FI_RGBA_BLUE] = _mm256_and_si256(pixels, mask5);
+		c[FI_RGBA_RED] = _mm256_mulhi_epu16(_mm256_slli_epi16(c[FI_RGBA_RED], 4), scale5);
+		c[FI_RGBA_BLUE] = _mm256_mulhi_epu16(_mm256_slli_epi16(c[FI_RGBA_BLUE], 4), scale5);
+
+		const __m256i c01 = _mm256_or_si256(c[0], _mm256_slli_epi16(c[1], 8));
+		const __m256i c23 = _mm256_or_si256(c[2], _mm256_set1_epi16((short)0xFF00));
+		// unpacking works within 128-bit lanes : pixels 0-3 and 8-11, pixels 4-7 and 12-15
+		const __m256i lo = _mm256_unpacklo_epi16(c01, c23);
+		const __m256i hi = _mm256_unpackhi_epi16(c01, c23);
+		_mm256_storeu_si256((__m256i*)target, _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i*)(target + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+		source += 32;
+		target += 64;
+	}
+	return cols;
+}
+
+FI_TARGET_AVX2 static int
+Line8To32_AVX2(uint8_t *target, const uint8_t *source, int width_in_pixels, const FIRGBA8 *palette) {
+	const __m256i alpha = _mm256_set1_epi32((int)FI_RGBA_ALPHA_MASK);
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+	// FIRGBA8 entries are stored as RGBA
+	const __m256i order = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+#endif
+	int cols = 0;
+	for (; cols + 8 <= width_in_pixels; cols += 8) {
+		const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(source + cols)));
+		__m256i pixels = _mm256_i32gather_epi32((const int*)palette, index, 4);
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+		pixels = _mm256_shuffle_epi8(pixels, order);
+#endif
+		_mm256_storeu_si256((__m256i*)target, _mm256_or_si256(pixels, alpha));
+		target += 32;
+	}
+	return cols;
+}
+
+static const ConvertLineKernels s_avx2_kernels = {
+	Line24To32_AVX2, Line32To24_AVX2, Line24To8_AVX2, Line32To8_AVX2,
+	Line16To24_SSSE3<false>, Line16To24_SSSE3<true>, Line16To32_AVX2<false>, Line16To32_AVX2<true>,
+	Line8To32_AVX2
+};
+
+#endif // FI_SIMD_X86
+
+#ifdef FI_SIMD_NEON
+
+// ----------------------------------------------------------
+//  NEON kernels
+// ----------------------------------------------------------
+
+static int
+Line24To32_NEON(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	const uint8x16_t alpha = vdupq_n_u8(0xFF);
+	int cols = 0;
+	for (; cols + 16 <= width_in_pixels; cols += 16) {
+		const uint8x16x3_t rgb = vld3q_u8(source);
+		uint8x16x4_t rgba;
+		rgba.val[0] = rgb.val[0];
+		rgba.val[1] = rgb.val[1];
+		rgba.val[2] = rgb.val[2];
+		rgba.val[3] = alpha;
+		vst4q_u8(target, rgba);
+		source += 48;
+		target += 64;
+	}
+	return cols;
+}
+
+static int
+Line32To24_NEON(uint8_t *target, const uint8_t *source, int width_in_pixels) {
+	int cols = 0;
+	for (; cols + 16 <= width_in_pixels; cols += 16) {
+		const uint8x16x4_t rgba = vld4q_u8(source);
+		uint8x16x3_t rgb;
+		rgb.val[0] = rgba.val[0];
+		rgb.val[1] = rgba.val[1];
+		rgb.val[2] = rgba.val[2];
+		vst3q_u8(target, rgb);
+		source += 64;
+		target += 48;
+	}
+	return cols;
+}
+
+static const ConvertLineKernels s_neon_kernels = {
+	Line24To32_NEON, Line32To24_NEON, NoLineKernel, NoLineKernel,
+	NoLineKernel, NoLineKernel, NoLineKernel, NoLineKernel,
+	NoPaletteKernel
+};
+
+/**
+Structured loads and stores of 3 and 4 interleaved channels of 1, 2 and 4 bytes
+*/
+template <unsigned Size_>
+struct NeonChannels;
+
+template <>
+struct NeonChannels<1>
+{
+	using Vector = uint8x16_t;
+	static Vector Load(const uint8_t *p) { return vld1q_u8(p); }
+	static void Store(uint8_t *p, Vector v) { vst1q_u8(p, v); }
+	static uint8x16x3_t Load3(const uint8_t *p) { return vld3q_u8(p); }
+	static uint8x16x4_t Load4(const uint8_t *p) { return vld4q_u8(p); }
+	static void Store3(uint8_t *p, uint8x16x3_t v) { vst3q_u8(p, v); }
+	static void Store4(uint8_t *p, uint8x16x4_t v) { vst4q_u8(p, v); }
+};
+
+template <>
+struct NeonChannels<2>
+{
+	using Vector = uint16x8_t;
+	static Vector Load(const uint8_t *p) { return vld1q_u16((const uint16_t*)p); }
+	static void Store(uint8_t *p, Vector v) { vst1q_u16((uint16_t*)p, v); }
+	static uint16x8x3_t Load3(const uint8_t *p) { return vld3q_u16((const uint16_t*)p); }
+	static uint16x8x4_t Load4(const uint8_t *p) { return vld4q_u16((const uint16_t*)p); }
+	static void Store3(uint8_t *p, uint16x8x3_t v) { vst3q_u16((uint16_t*)p, v); }
+	static void Store4(uint8_t *p, uint16x8x4_t v) { vst4q_u16((uint16_t*)p, v); }
+};
+
+template <>
+struct NeonChannels<4>
+{
+	using Vector = uint32x4_t;
+	static Vector Load(const uint8_t *p) { return vld1q_u32((const uint32_t*)p); }
+	static void Store(uint8_t *p, Vector v) { vst1q_u32((uint32_t*)p, v); }
+	static uint32x4x3_t Load3(const uint8_t *p) { return vld3q_u32((const uint32_t*)p); }
+	static uint32x4x4_t Load4(const uint8_t *p) { return vld4q_u32((const uint32_t*)p); }
+	static void Store3(uint8_t *p, uint32x4x3_t v) { vst3q_u32((uint32_t*)p, v); }
+	static void Store4(uint8_t *p, uint32x4x4_t v) { vst4q_u32((uint32_t*)p, v); }
+};
+
+template <unsigned Size_, unsigned Channels_>
+static int
+Split_NEON(uint8_t *const *planes, const uint8_t *source, int width_in_pixels) {
+	using Neon = NeonChannels<Size_>;
+	const int block = 16 / Size_;
+	int cols = 0;
+	for (; cols + block <= width_in_pixels; cols += block) {
+		if constexpr (Channels_ == 3) {
+			const auto v = Neon::Load3(source);
+			for (unsigned k = 0; k < 3; k++) {
+				Neon::Store(planes[k] + cols * Size_, v.val[k]);
+			}
+		}
+		else {
+			const auto v = Neon::Load4(source);
+			for (unsigned k = 0; k < 4; k++) {
+				Neon::Store(planes[k] + cols * Size_, v.val[k]);
+			}
+		}
+		source += 16 * Channels_;
+	}
+	return cols;
+}
+
+template <unsigned Size_, unsigned Channels_>
+static int
+Merge_NEON(uint8_t *target, const uint8_t *const *planes, int width_in_pixels) {
+	using Neon = NeonChannels<Size_>;
+	const int block = 16 / Size_;
+	int cols = 0;
+	for (; cols + block <= width_in_pixels; cols += block) {
+		if constexpr (Channels_ == 3) {
+			decltype(Neon::Load3(target)) v;
+			for (unsigned k = 0; k < 3; k++) {
+				v.val[k] = Neon::Load(planes[k] + cols * Size_);
+			}
+			Neon::Store3(target, v);
+		}
+		else {
+			decltype(Neon::Load4(target)) v;
+			for (unsigned k = 0; k < 4; k++) {
+				v.val[k] = Neon::Load(planes[k] + cols * Size_);
+			}
+			Neon::Store4(target, v);
+		}
+		target += 16 * Channels_;
+	}
+	return cols;
+}
+
+static const ChannelLineKernels s_neon_channel_kernels = {
+	{ { Split_NEON<1, 3>, Split_NEON<1, 4> }, { Split_NEON<2, 3>, Split_NEON<2, 4> }, { Split_NEON<4, 3>, Split_NEON<4, 4> } },
+	{ { Merge_NEON<1, 3>, Merge_NEON<1, 4> }, { Merge_NEON<2, 3>, Merge_NEON<2, 4> }, { Merge_NEON<4, 3>, Merge_NEON<4, 4> } }
+};
+
+#endif // FI_SIMD_NEON
+
+// ----------------------------------------------------------
+//  Runtime dispatch
+// ----------------------------------------------------------
+
+/**
+Best instruction set supported by both the build and the CPU
+*/
+static FREE_IMAGE_SIMD
+DetectSIMDLevel() {
+#if defined(FI_SIMD_X86)
+	bool ssse3 = false;
+	bool avx2 = false;
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_cpu_init();
+	ssse3 = __builtin_cpu_supports("ssse3");
+	avx2 = __builtin_cpu_supports("avx2");
+#else
+	int info[4];
+	__cpuid(info, 0);
+	const int max_leaf = info[0];
+	__cpuid(info, 1);
+	ssse3 = (info[2] & (1 << 9)) != 0;
+	// AVX registers must be enabled by the OS (OSXSAVE and XCR0 bits 1 and 2)
+	const bool avx = ((info[2] & (1 << 27)) != 0) && ((info[2] & (1 << 28)) != 0) && ((_xgetbv(0) & 6) == 6);
+	if (avx && (max_leaf >= 7)) {
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#endif
+	return avx2 ? FISIMD_AVX2 : ssse3 ? FISIMD_SSSE3 : FISIMD_NONE;
+#elif defined(FI_SIMD_NEON)
+	return FISIMD_NEON;
+#else
+	return FISIMD_NONE;
+#endif
+}
+
+static FREE_IMAGE_SIMD
+GetSupportedSIMDLevel() {
+	static const FREE_IMAGE_SIMD level = DetectSIMDLevel();
+	return level;
+}
+
+static bool
+IsSIMDLevelSupported(FREE_IMAGE_SIMD level) {
+	const FREE_IMAGE_SIMD supported = GetSupportedSIMDLevel();
+	switch (level) {
+		case FISIMD_NONE:
+			return true;
+		case FISIMD_SSSE3:
+			return (supported == FISIMD_SSSE3) || (supported == FISIMD_AVX2);
+		case FISIMD_AVX2:
+		case FISIMD_NEON:
+			return supported == level;
+		default:
+			return false;
+	}
+}
+
+/**
+Initial level : the best supported one, unless the FREEIMAGE_SIMD environment variable
+asks for another one ("none", "ssse3", "avx2" or "neon")
+*/
+static FREE_IMAGE_SIMD
+GetInitialSIMDLevel() {
+	if (const char *env = std::getenv("FREEIMAGE_SIMD")) {
+		const std::string_view value(env);
+		if ((value == "none") || (value == "scalar")) {
+			return FISIMD_NONE;
+		}
+		const std::pair<std::string_view, FREE_IMAGE_SIMD> names[] = {
+			{ "ssse3", FISIMD_SSSE3 }, { "avx2", FISIMD_AVX2 }, { "neon", FISIMD_NEON }
+		};
+		for (const auto& [name, level] : names) {
+			if ((value == name) && IsSIMDLevelSupported(level)) {
+				return level;
+			}
+		}
+	}
+	return GetSupportedSIMDLevel();
+}
+
+static std::atomic<int>&
+CurrentSIMDLevel() {
+	static std::atomic<int> level{ (int)GetInitialSIMDLevel() };
+	return level;
+}
+
+FREE_IMAGE_SIMD DLL_CALLCONV
+FreeImage_GetSIMDLevel() {
+	return (FREE_IMAGE_SIMD)CurrentSIMDLevel().load(std::memory_order_relaxed);
+}
+
+FIBOOL DLL_CALLCONV
+FreeImage_SetSIMDLevel(FREE_IMAGE_SIMD level) {
+	if (!IsSIMDLevelSupported(level)) {
+		return FALSE;
+	}
+	CurrentSIMDLevel().store((int)level, std::memory_order_relaxed);
+	return TRUE;
+}
+
+const ConvertLineKernels&
+GetConvertLineKernels() {
+	switch (FreeImage_GetSIMDLevel()) {
+#ifdef FI_SIMD_X86
+		case FISIMD_SSSE3:
+			return s_ssse3_kernels;
+		case FISIMD_AVX2:
+			return s_avx2_kernels;
+#endif
+#ifdef FI_SIMD_NEON
+		case FISIMD_NEON:
+			return s_neon_kernels;
+#endif
+		default:
+			return s_scalar_kernels;
+	}
+}
+
+const ChannelLineKernels&
+GetChannelLineKernels() {
+	switch (FreeImage_GetSIMDLevel()) {
+#ifdef FI_SIMD_X86
+		case FISIMD_SSSE3:
+		case FISIMD_AVX2:
+			return s_ssse3_channel_kernels;
+#endif
+#ifdef FI_SIMD_NEON
+		case FISIMD_NEON:
+			return s_neon_channel_kernels;
+#endif
+		default:
+			return s_scalar_channel_kernels;
+	}
+}
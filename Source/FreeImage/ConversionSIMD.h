@@ -0,0 +1,69 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#ifndef FREEIMAGE_CONVERSION_SIMD_H_
+#define FREEIMAGE_CONVERSION_SIMD_H_
+
+#include "FreeImage.h"
+
+// ----------------------------------------------------------
+//  SIMD kernels of the line conversion routines
+// ----------------------------------------------------------
+
+/**
+Vectorized line conversion kernels, selected at runtime from the CPU features.
+A kernel converts the first pixels of a line, by blocks of its vector width,
+and returns the number of converted pixels : the caller converts the remaining ones.
+The scalar kernels convert nothing.
+*/
+struct ConvertLineKernels
+{
+	using LineKernel = int (*)(uint8_t *target, const uint8_t *source, int width_in_pixels);
+	using PaletteKernel = int (*)(uint8_t *target, const uint8_t *source, int width_in_pixels, const FIRGBA8 *palette);
+
+	LineKernel line24To32;
+	LineKernel line32To24;
+	LineKernel line24To8;
+	LineKernel line32To8;
+	LineKernel line16To24_555;
+	LineKernel line16To24_565;
+	LineKernel line16To32_555;
+	LineKernel line16To32_565;
+	PaletteKernel line8To32;
+};
+
+/**
+Get the kernels of the current SIMD level (see FreeImage_SetSIMDLevel)
+*/
+const ConvertLineKernels& GetConvertLineKernels();
+
+/**
+Vectorized deinterleave and interleave kernels of the channel routines, selected like the line conversion kernels.
+Planes are given in the memory order of the channels of a pixel. A kernel processes the first pixels of a line
+and returns their number : the caller processes the remaining ones. The scalar kernels process nothing.
+*/
+struct ChannelLineKernels
+{
+	using SplitKernel = int (*)(uint8_t *const *planes, const uint8_t *source, int width_in_pixels);
+	using MergeKernel = int (*)(uint8_t *target, const uint8_t *const *planes, int width_in_pixels);
+
+	/** Kernels of 3 and 4 channels of 1, 2 and 4 bytes, indexed by [ChannelKernelIndex(size)][channels - 3] */
+	SplitKernel split[3][2];
+	MergeKernel merge[3][2];
+};
+
+/** Index of the kernels of channels of 'size' bytes (1, 2 or 4) */
+inline unsigned
+ChannelKernelIndex(unsigned size) {
+	return (size == 1) ? 0 : (size == 2) ? 1 : 2;
+}
+
+/**
+Get the channel kernels of the current SIMD level (see FreeImage_SetSIMDLevel)
+*/
+const ChannelLineKernels& GetChannelLineKernels();
+
+#endif // FREEIMAGE_CONVERSION_SIMD_H_
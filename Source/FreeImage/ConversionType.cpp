@@ -22,6 +22,8 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ParallelFor.h"
+#include "ConversionDither.h"
 
 // ----------------------------------------------------------
 
@@ -52,14 +54,16 @@ CONVERT_TYPE<Tdst, Tsrc>::convert(FIBITMAP *src, FREE_IMAGE_TYPE dst_type) {
 
 	// convert from src_type to dst_type
 	
-	for (unsigned y = 0; y < height; y++) {
-		const Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
-		Tdst *dst_bits = reinterpret_cast<Tdst*>(FreeImage_GetScanLine(dst, y));
+	ParallelForRows(height, width * (sizeof(Tsrc) + sizeof(Tdst)), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; y++) {
+			const Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
+			Tdst *dst_bits = reinterpret_cast<Tdst*>(FreeImage_GetScanLine(dst, y));
 
-		for (unsigned x = 0; x < width; x++) {
-			*dst_bits++ = static_cast<Tdst>(*src_bits++);
+			for (unsigned x = 0; x < width; x++) {
+				*dst_bits++ = static_cast<Tdst>(*src_bits++);
+			}
 		}
-	}
+	});
 
 	return dst;
 }
@@ -68,18 +72,20 @@ CONVERT_TYPE<Tdst, Tsrc>::convert(FIBITMAP *src, FREE_IMAGE_TYPE dst_type) {
 /** Convert a greyscale image of type Tsrc to a 8-bit grayscale dib.
 	Conversion is done using either a linear scaling from [min, max] to [0, 255]
 	or a rounding from src_pixel to (uint8_t) clamp(q, 0, 255) where int q = int(src_pixel + 0.5); 
+	The rounding can be replaced by a dithering, see FREE_IMAGE_DEPTH_DITHER.
 */
 template<class Tsrc>
 class CONVERT_TO_BYTE
 {
 public:
-	FIBITMAP* convert(FIBITMAP *src, FIBOOL scale_linear);
+	FIBITMAP* convert(FIBITMAP *src, FIBOOL scale_linear, FREE_IMAGE_DEPTH_DITHER dither = FIDD_NONE);
+private:
+	FIBITMAP* ditherToByte(FIBITMAP *src, FIBITMAP *dst, double scale, double offset, FREE_IMAGE_DEPTH_DITHER dither);
 };
 
 template<class Tsrc> FIBITMAP* 
-CONVERT_TO_BYTE<Tsrc>::convert(FIBITMAP *src, FIBOOL scale_linear) {
+CONVERT_TO_BYTE<Tsrc>::convert(FIBITMAP *src, FIBOOL scale_linear, FREE_IMAGE_DEPTH_DITHER dither) {
 	FIBITMAP *dst{};
-	unsigned x, y;
 
 	const unsigned width	= FreeImage_GetWidth(src);
 	const unsigned height = FreeImage_GetHeight(src);
@@ -99,44 +105,85 @@ CONVERT_TO_BYTE<Tsrc>::convert(FIBITMAP *src, FIBOOL scale_linear) {
 
 	// convert the src image to dst
 	// (FIBITMAP are stored upside down)
+	const size_t row_bytes = width * (sizeof(Tsrc) + 1);
 	if (scale_linear) {
-		Tsrc max, min;
-		double scale;
-
-		// find the min and max value of the image
-		Tsrc l_min, l_max;
-		min = 255, max = 0;
-		for (y = 0; y < height; y++) {
-			Tsrc *bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
-			MAXMIN(bits, width, l_max, l_min);
-			if (l_max > max) max = l_max;
-			if (l_min < min) min = l_min;
-		}
+		struct MinMax {
+			Tsrc min, max;
+		};
+
+		// find the min and max value of the image (parallel reduction over bands of rows)
+		const MinMax range = ParallelReduceRows(height, width * sizeof(Tsrc), MinMax{ 255, 0 },
+			[&](MinMax& band, unsigned first_row, unsigned end_row) {
+				Tsrc l_min, l_max;
+				for (unsigned y = first_row; y < end_row; y++) {
+					Tsrc *bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
+					MAXMIN(bits, width, l_max, l_min);
+					if (l_max > band.max) band.max = l_max;
+					if (l_min < band.min) band.min = l_min;
+				}
+			},
+			[](MinMax& result, const MinMax& band) {
+				if (band.max > result.max) result.max = band.max;
+				if (band.min < result.min) result.min = band.min;
+			});
+
+		Tsrc max = range.max, min = range.min;
 		if (max == min) {
 			max = 255; min = 0;
 		}
 
 		// compute the scaling factor
-		scale = 255 / (double)(max - min);
+		const double scale = 255 / (double)(max - min);
+
+		if (dither != FIDD_NONE) {
+			return ditherToByte(src, dst, scale, (double)min, dither);
+		}
 
 		// scale to 8-bit
-		for (y = 0; y < height; y++) {
-			Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
-			uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
-			for (x = 0; x < width; x++) {
-				dst_bits[x] = (uint8_t)( scale * (src_bits[x] - min) + 0.5);
+		ParallelForRows(height, row_bytes, [&](unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
+				uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
+				for (unsigned x = 0; x < width; x++) {
+					dst_bits[x] = (uint8_t)( scale * (src_bits[x] - min) + 0.5);
+				}
 			}
-		}
+		});
+	} else if (dither != FIDD_NONE) {
+		return ditherToByte(src, dst, 1, 0, dither);
 	} else {
-		for (y = 0; y < height; y++) {
-			Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
-			uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
-			for (x = 0; x < width; x++) {
-				// rounding
-				int q = int(src_bits[x] + 0.5);
-				dst_bits[x] = (uint8_t) std::clamp(q, 0, 255);
+		ParallelForRows(height, row_bytes, [&](unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
+				uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
+				for (unsigned x = 0; x < width; x++) {
+					// rounding
+					int q = int(src_bits[x] + 0.5);
+					dst_bits[x] = (uint8_t) std::clamp(q, 0, 255);
+				}
 			}
-		}
+		});
+	}
+
+	return dst;
+}
+
+/** Scale to [0, 255], then dither to 8-bit
+*/
+template<class Tsrc> FIBITMAP* 
+CONVERT_TO_BYTE<Tsrc>::ditherToByte(FIBITMAP *src, FIBITMAP *dst, double scale, double offset, FREE_IMAGE_DEPTH_DITHER dither) {
+	const unsigned width = FreeImage_GetWidth(src);
+
+	try {
+		DitherRowsToBytes(dst, 1, dither, width * sizeof(Tsrc), [&](unsigned y, float *values) {
+			const Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
+			for (unsigned x = 0; x < width; x++) {
+				values[x] = (float)(scale * ((double)src_bits[x] - offset));
+			}
+		});
+	} catch (const std::bad_alloc&) {
+		FreeImage_Unload(dst);
+		return nullptr;
 	}
 
 	return dst;
@@ -165,14 +212,48 @@ CONVERT_TO_COMPLEX<Tsrc>::convert(FIBITMAP *src) {
 
 	// convert from src_type to FIT_COMPLEX
 	
-	for (unsigned y = 0; y < height; y++) {
-		const Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
-		FICOMPLEX *dst_bits = (FICOMPLEX *)FreeImage_GetScanLine(dst, y);
-
-		for (unsigned x = 0; x < width; x++) {
-			dst_bits[x].r = (double)src_bits[x];
-			dst_bits[x].i = 0;
+	ParallelForRows(height, width * (sizeof(Tsrc) + sizeof(FICOMPLEX)), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; y++) {
+			const Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
+			FICOMPLEX *dst_bits = (FICOMPLEX *)FreeImage_GetScanLine(dst, y);
+
+			for (unsigned x = 0; x < width; x++) {
+				dst_bits[x].r = (double)src_bits[x];
+				dst_bits[x].i = 0;
+			}
 		}
+	});
+
+	return dst;
+}
+
+/** Convert a RGB[A]16 or RGB[A]F image to a 24-bit or 32-bit dib.
+	Each channel is multiplied by 'scale' to [0, 255], then rounded or dithered, see FREE_IMAGE_DEPTH_DITHER.
+*/
+template<class Tsrc, unsigned channels>
+static FIBITMAP*
+ConvertColorToBytes(FIBITMAP *src, float scale, FREE_IMAGE_DEPTH_DITHER dither) {
+	const unsigned width = FreeImage_GetWidth(src);
+	const unsigned height = FreeImage_GetHeight(src);
+
+	FIBITMAP *dst = FreeImage_Allocate(width, height, 8 * channels, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+	if (!dst) return nullptr;
+
+	try {
+		DitherRowsToBytes(dst, channels, dither, width * sizeof(Tsrc), [&](unsigned y, float *values) {
+			const Tsrc *src_bits = reinterpret_cast<Tsrc*>(FreeImage_GetScanLine(src, y));
+			for (unsigned x = 0; x < width; x++, values += channels) {
+				values[FI_RGBA_RED] = scale * src_bits[x].red;
+				values[FI_RGBA_GREEN] = scale * src_bits[x].green;
+				values[FI_RGBA_BLUE] = scale * src_bits[x].blue;
+				if constexpr (channels == 4) {
+					values[FI_RGBA_ALPHA] = scale * src_bits[x].alpha;
+				}
+			}
+		});
+	} catch (const std::bad_alloc&) {
+		FreeImage_Unload(dst);
+		return nullptr;
 	}
 
 	return dst;
@@ -230,11 +311,17 @@ When the scale_linear parameter is TRUE, conversion is done by scaling linearly
 each pixel to an integer value between [0..255]. When it is FALSE, conversion is done 
 by rounding each float pixel to an integer between [0..255]. 
 For complex images, the magnitude is extracted as a double image, then converted according to the scale parameter. 
+RGB16 and RGBA16 images are converted to 24-bit and 32-bit images, [0..65535] being mapped to [0..255].
+RGBF and RGBAF images are converted to 24-bit and 32-bit images, [0..1] being mapped to [0..255] 
+(the scale_linear parameter does not apply to color images).
+The rounding to [0..255] can be replaced by an ordered dithering or an error diffusion, which avoids 
+the banding of smooth gradients. Rounding and ordered dithering run in parallel, error diffusion is sequential.
 @param image Image to convert
 @param scale_linear Linear scaling / rounding switch
+@param dither Rounding or dithering of the values, see FREE_IMAGE_DEPTH_DITHER
 */
 FIBITMAP* DLL_CALLCONV
-FreeImage_ConvertToStandardType(FIBITMAP *src, FIBOOL scale_linear) {
+FreeImage_ConvertToStandardTypeEx(FIBITMAP *src, FIBOOL scale_linear, FREE_IMAGE_DEPTH_DITHER dither) {
 	FIBITMAP *dst{};
 
 	if (!src) return nullptr;
@@ -248,22 +335,22 @@ FreeImage_ConvertToStandardType(FIBITMAP *src, FIBOOL scale_linear) {
 			dst = FreeImage_Clone(src);
 			break;
 		case FIT_UINT16:	// array of unsigned short: unsigned 16-bit
-			dst = convertUShortToByte.convert(src, scale_linear);
+			dst = convertUShortToByte.convert(src, scale_linear, dither);
 			break;
 		case FIT_INT16:		// array of short: signed 16-bit
-			dst = convertShortToByte.convert(src, scale_linear);
+			dst = convertShortToByte.convert(src, scale_linear, dither);
 			break;
 		case FIT_UINT32:	// array of unsigned long: unsigned 32-bit
-			dst = convertULongToByte.convert(src, scale_linear);
+			dst = convertULongToByte.convert(src, scale_linear, dither);
 			break;
 		case FIT_INT32:		// array of long: signed 32-bit
-			dst = convertLongToByte.convert(src, scale_linear);
+			dst = convertLongToByte.convert(src, scale_linear, dither);
 			break;
 		case FIT_FLOAT:		// array of float: 32-bit
-			dst = convertFloatToByte.convert(src, scale_linear);
+			dst = convertFloatToByte.convert(src, scale_linear, dither);
 			break;
 		case FIT_DOUBLE:	// array of double: 64-bit
-			dst = convertDoubleToByte.convert(src, scale_linear);
+			dst = convertDoubleToByte.convert(src, scale_linear, dither);
 			break;
 		case FIT_COMPLEX:	// array of FICOMPLEX: 2 x 64-bit
 			{
@@ -271,19 +358,23 @@ FreeImage_ConvertToStandardType(FIBITMAP *src, FIBOOL scale_linear) {
 				FIBITMAP *dib_double = FreeImage_GetComplexChannel(src, FICC_MAG);
 				if (dib_double) {
 					// Convert to a standard bitmap (linear scaling)
-					dst = convertDoubleToByte.convert(dib_double, scale_linear);
+					dst = convertDoubleToByte.convert(dib_double, scale_linear, dither);
 					// Free image of type FIT_DOUBLE
 					FreeImage_Unload(dib_double);
 				}
 			}
 			break;
 		case FIT_RGB16:		// 48-bit RGB image: 3 x 16-bit
+			dst = ConvertColorToBytes<FIRGB16, 3>(src, 255.F / 65535, dither);
 			break;
 		case FIT_RGBA16:	// 64-bit RGBA image: 4 x 16-bit
+			dst = ConvertColorToBytes<FIRGBA16, 4>(src, 255.F / 65535, dither);
 			break;
 		case FIT_RGBF:		// 96-bit RGB float image: 3 x 32-bit IEEE floating point
+			dst = ConvertColorToBytes<FIRGBF, 3>(src, 255.F, dither);
 			break;
 		case FIT_RGBAF:		// 128-bit RGBA float image: 4 x 32-bit IEEE floating point
+			dst = ConvertColorToBytes<FIRGBAF, 4>(src, 255.F, dither);
 			break;
 	}
 
@@ -297,6 +388,14 @@ FreeImage_ConvertToStandardType(FIBITMAP *src, FIBOOL scale_linear) {
 	return dst;
 }
 
+/** Convert image of any type to a standard 8-bit greyscale image, rounding the values.
+@see FreeImage_ConvertToStandardTypeEx
+*/
+FIBITMAP* DLL_CALLCONV
+FreeImage_ConvertToStandardType(FIBITMAP *src, FIBOOL scale_linear) {
+	return FreeImage_ConvertToStandardTypeEx(src, scale_linear, FIDD_NONE);
+}
+
 
 
 // ----------------------------------------------------------
@@ -487,6 +586,7 @@ FreeImage_ConvertToType(FIBITMAP *src, FREE_IMAGE_TYPE dst_type, FIBOOL scale_li
 					dst = FreeImage_ConvertToStandardType(src, scale_linear);
 					break;
 				case FIT_UINT16:
+					dst = FreeImage_ConvertToUINT16(src);
 					break;
 				case FIT_INT16:
 					break;
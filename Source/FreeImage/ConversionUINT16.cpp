@@ -21,6 +21,7 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include <algorithm>
 
 // ----------------------------------------------------------
 //   smart convert X to UINT16
@@ -60,6 +61,10 @@ FreeImage_ConvertToUINT16(FIBITMAP *dib) {
 			// allow conversion from 64-bit RGBA (ignore the alpha channel)
 			src = dib;
 			break;
+		case FIT_FLOAT:
+			// allow conversion from [0..1] float values
+			src = dib;
+			break;
 		default:
 			return nullptr;
 	}
@@ -121,6 +126,20 @@ FreeImage_ConvertToUINT16(FIBITMAP *dib) {
 		}
 		break;
 
+		case FIT_FLOAT:
+		{
+			for (unsigned y = 0; y < height; y++) {
+				auto *src_bits = (const float*)FreeImage_GetScanLine(src, y);
+				auto *dst_bits = (uint16_t*)FreeImage_GetScanLine(dst, y);
+				for (unsigned x = 0; x < width; x++) {
+					// clamp to [0..1], NaN gives 0
+					const float value = (src_bits[x] > 0) ? std::min(src_bits[x], 1.0F) : 0.0F;
+					dst_bits[x] = (uint16_t)(value * 65535.0F + 0.5F);
+				}
+			}
+		}
+		break;
+
 		default:
 			break;
 	}
@@ -118,6 +118,9 @@ struct MULTIBITMAPHEADER {
 	FREE_IMAGE_FORMAT cache_fif{ FIF_UNKNOWN };
 	int load_flags{ 0 };
 	void* persistent_data{ nullptr };
+	// FIMD_ANIMATION tags of the cached pages, indexed by cache reference
+	// (the cache format doesn't necessarily store them)
+	std::map<int, std::shared_ptr<FIBITMAP>> cached_metadata{};
 };
 
 // =====================================================================
@@ -143,6 +146,46 @@ FreeImage_GetMultiBitmapHeader(FIMULTIBITMAP *bitmap) {
 	return (MULTIBITMAPHEADER *)bitmap->data;
 }
 
+/**
+Copy the FIMD_ANIMATION tags of src to dst
+*/
+static void
+CopyAnimationMetadata(FIBITMAP *dst, FIBITMAP *src) {
+	FITAG *tag{};
+	if (FIMETADATA *mdhandle = FreeImage_FindFirstMetadata(FIMD_ANIMATION, src, &tag)) {
+		do {
+			FreeImage_SetMetadata(FIMD_ANIMATION, dst, FreeImage_GetTagKey(tag), tag);
+		} while (FreeImage_FindNextMetadata(mdhandle, &tag));
+		FreeImage_FindCloseMetadata(mdhandle);
+	}
+}
+
+/**
+Write a page to the cache, keeping its FIMD_ANIMATION tags aside
+@return Returns the cache reference of the page
+*/
+static int
+FreeImage_WritePageToCache(MULTIBITMAPHEADER *header, FIBITMAP *data, uint8_t *compressed_data, uint32_t compressed_size) {
+	const int ref = header->m_cachefile.writeFile(compressed_data, compressed_size);
+
+	header->cached_metadata.erase(ref);
+	if (FreeImage_GetMetadataCount(FIMD_ANIMATION, data) > 0) {
+		std::shared_ptr<FIBITMAP> metadata(FreeImage_AllocateHeader(TRUE, 1, 1, 8), &FreeImage_Unload);
+		if (metadata) {
+			CopyAnimationMetadata(metadata.get(), data);
+			header->cached_metadata[ref] = metadata;
+		}
+	}
+
+	return ref;
+}
+
+static void
+FreeImage_DeletePageFromCache(MULTIBITMAPHEADER *header, int ref) {
+	header->m_cachefile.deleteFile(ref);
+	header->cached_metadata.erase(ref);
+}
+
 static BlockListIterator DLL_CALLCONV
 FreeImage_FindBlock(FIMULTIBITMAP *bitmap, int position) {
 	assert(bitmap);
@@ -250,9 +293,9 @@ FIMULTIBITMAP* OpenMultiBitmapImpl(FREE_IMAGE_FORMAT fif, std::filesystem::path
 				// store the MULTIBITMAPHEADER in the surrounding FIMULTIBITMAP structure
 
 				if (header->handle) {
-					// open persistent data is supported
+					// open persistent data is supported (it is only used to read the source pages)
 					if (header->node->SupportsOpenPersistent()) {
-						header->persistent_data = header->node->OpenPersistent(&header->io, header->handle, header->read_only);
+						header->persistent_data = header->node->OpenPersistent(&header->io, header->handle, true);
 						// cache the page count
 						header->page_count = header->node->GetPageCount(&header->io, header->handle, header->persistent_data);
 					}
@@ -345,9 +388,9 @@ FreeImage_OpenMultiBitmapFromHandle(FREE_IMAGE_FORMAT fif, FreeImageIO *io, fi_h
 
 					// store the MULTIBITMAPHEADER in the surrounding FIMULTIBITMAP structure
 
-					// open persistent data is supported
+					// open persistent data is supported (it is only used to read the source pages)
 					if (header->node->SupportsOpenPersistent()) {
-						header->persistent_data = header->node->OpenPersistent(&header->io, header->handle, header->read_only);
+						header->persistent_data = header->node->OpenPersistent(&header->io, header->handle, true);
 						// cache the page count
 						header->page_count = header->node->GetPageCount(&header->io, header->handle, header->persistent_data);
 					}
@@ -447,6 +490,10 @@ bool SaveMultiBitmapToHandleImpl(FREE_IMAGE_FORMAT fif, FIMULTIBITMAP* bitmap, F
 							std::unique_ptr<FIMEMORY, decltype(&FreeImage_CloseMemory)> hmem(FreeImage_OpenMemory(compressed_data.get(), i->getSize()), &FreeImage_CloseMemory);
 							std::unique_ptr<FIBITMAP, decltype(&FreeImage_Unload)> dib(FreeImage_LoadFromMemory(header->cache_fif, hmem.get(), 0), &FreeImage_Unload);
 
+							if (auto metadata = header->cached_metadata.find(i->getReference()); dib && (metadata != header->cached_metadata.end())) {
+								CopyAnimationMetadata(dib.get(), metadata->second.get());
+							}
+
 							// save the data
 
 							success = dst_node->Save(dib.get(), dst_io, dst_handle, count, flags, dst_data);
@@ -460,9 +507,9 @@ bool SaveMultiBitmapToHandleImpl(FREE_IMAGE_FORMAT fif, FIMULTIBITMAP* bitmap, F
 				}
 			}
 
-			// close src data
+			// close src data (persistent data is closed with the multipage bitmap)
 
-			if (src_data && header->handle) {
+			if (src_data && header->handle && (src_data != header->persistent_data)) {
 				header->node->Close(&header->io, header->handle, src_data);
 			}
 
@@ -508,7 +555,7 @@ FreeImage_CloseMultiBitmap(FIMULTIBITMAP *bitmap, int flags) {
 						FreeImage_OutputMessageProc(header->fif, "Failed to open %s, %s", spool_name.c_str(), strerror(errno));
 						success = false;
 					} else {
-						success = SaveMultiBitmapToHandleImpl(header->fif, bitmap, &header->io, (fi_handle)f, header->persistent_data, flags);
+						success = SaveMultiBitmapToHandleImpl(header->fif, bitmap, &header->io, (fi_handle)f, nullptr, flags);
 
 						// close the files
 
@@ -614,7 +661,7 @@ FreeImage_SavePageToBlock(MULTIBITMAPHEADER *header, FIBITMAP *data) {
 	}
 
 	// write the compressed data to the cache
-	int ref = header->m_cachefile.writeFile(compressed_data, compressed_size);
+	int ref = FreeImage_WritePageToCache(header, data, compressed_data, compressed_size);
 	
 	res = PageBlock(BLOCK_REFERENCE, ref, compressed_size);
 	
@@ -678,7 +725,7 @@ FreeImage_DeletePage(FIMULTIBITMAP *bitmap, int page) {
 							break;
 
 						case BLOCK_REFERENCE :
-							header->m_cachefile.deleteFile(i->getReference());
+							FreeImage_DeletePageFromCache(header, i->getReference());
 							header->m_blocks.erase(i);
 							break;
 					}
@@ -770,10 +817,10 @@ FreeImage_UnlockPage(FIMULTIBITMAP *bitmap, FIBITMAP *page, FIBOOL changed) {
 				// write the data to the cache
 				
 				if (i->m_type == BLOCK_REFERENCE) {
-					header->m_cachefile.deleteFile(i->getReference());
+					FreeImage_DeletePageFromCache(header, i->getReference());
 				}
 
-				int iPage = header->m_cachefile.writeFile(compressed_data, compressed_size);
+				int iPage = FreeImage_WritePageToCache(header, page, compressed_data, compressed_size);
 				
 				*i = PageBlock(BLOCK_REFERENCE, iPage, compressed_size);
 
@@ -875,9 +922,9 @@ FreeImage_LoadMultiBitmapFromMemory(FREE_IMAGE_FORMAT fif, FIMEMORY *stream, int
 
 					// store the MULTIBITMAPHEADER in the surrounding FIMULTIBITMAP structure
 
-					// open persistent data is supported
+					// open persistent data is supported (it is only used to read the source pages)
 					if (header->node->SupportsOpenPersistent()) {
-						header->persistent_data = header->node->OpenPersistent(&header->io, header->handle, header->read_only);
+						header->persistent_data = header->node->OpenPersistent(&header->io, header->handle, true);
 						// cache the page count
 						header->page_count = header->node->GetPageCount(&header->io, header->handle, header->persistent_data);
 					}
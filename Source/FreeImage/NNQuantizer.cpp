@@ -33,6 +33,8 @@
 #include "Quantizers.h"
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ParallelFor.h"
+#include <vector>
 
 
 // Four primes near 500 - assume no image has a length so large
@@ -160,9 +162,9 @@ void NNQuantizer::inxbuild() {
 // Search for BGR values 0..255 (after net is unbiased) and return colour index
 // ----------------------------------------------------------------------------
 
-int NNQuantizer::inxsearch(int b, int g, int r) {
+int NNQuantizer::inxsearch(int b, int g, int r) const {
 	int i, j, dist, a, bestd;
-	int *p;
+	const int *p;
 	int best;
 
 	bestd = 1000;		// biggest possible dist is 256*3
@@ -491,17 +493,32 @@ FIBITMAP* NNQuantizer::Quantize(FIBITMAP *dib, int ReserveSize, FIRGBA8 *Reserve
 	inxbuild();
 
 	// 6) Write output image using inxsearch(b,g,r)
+	//    Rows are mapped in parallel, each band caches the index of the colours it has already searched
 
-	for (uint16_t rows = 0; rows < img_height; rows++) {
-		uint8_t *new_bits = FreeImage_GetScanLine(new_dib, rows);			
-		uint8_t *bits = FreeImage_GetScanLine(dib_ptr, rows);
+	const unsigned cache_size = 4096;
+	const uint32_t empty_entry = 0xFFFFFFFF;
 
-		for (uint16_t cols = 0; cols < img_width; cols++) {
-			new_bits[cols] = (uint8_t)inxsearch(bits[FI_RGBA_BLUE], bits[FI_RGBA_GREEN], bits[FI_RGBA_RED]);
+	ParallelForRows(img_height, img_width * 3, [&](unsigned first_row, unsigned end_row) {
+		// direct mapped cache : (colour << 8) | index
+		uint32_t cache[cache_size];
+		std::fill(cache, cache + cache_size, empty_entry);
 
-			bits += 3;
+		for (unsigned rows = first_row; rows < end_row; rows++) {
+			uint8_t *new_bits = FreeImage_GetScanLine(new_dib, rows);
+			const uint8_t *bits = FreeImage_GetScanLine(dib_ptr, rows);
+
+			for (int cols = 0; cols < img_width; cols++) {
+				const uint32_t color = (bits[FI_RGBA_BLUE] << 16) | (bits[FI_RGBA_GREEN] << 8) | bits[FI_RGBA_RED];
+				uint32_t& entry = cache[(color * 2654435761U) >> 20];
+				if ((entry >> 8) != color || entry == empty_entry) {
+					entry = (color << 8) | (uint32_t)inxsearch(bits[FI_RGBA_BLUE], bits[FI_RGBA_GREEN], bits[FI_RGBA_RED]);
+				}
+				new_bits[cols] = (uint8_t)entry;
+
+				bits += 3;
+			}
 		}
-	}
+	});
 
 	return (FIBITMAP*) new_dib;
 }
@@ -0,0 +1,281 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "FreeImage.h"
+#include "Utilities.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace
+{
+
+	// ----------------------------------------------------------
+	//  Exact nearest palette entry
+	// ----------------------------------------------------------
+
+	/**
+	Nearest palette entry, in squared RGB distance, of any 24-bit color.
+	The RGB cube is split into 16x16x16 cells. An entry can only be the nearest one to a color of a cell
+	if its distance to the cell is not larger than the smallest distance to the farthest corner of the cell,
+	so each cell keeps the list of those candidates and a lookup only compares the candidates.
+	Ties are resolved to the lowest index, as a search of the whole palette would.
+	*/
+	class PaletteLookup
+	{
+	public:
+		static constexpr unsigned CellBits = 4;
+		static constexpr unsigned CellsPerAxis = 1 << CellBits;
+		static constexpr unsigned CellSize = 256 / CellsPerAxis;
+		static constexpr unsigned CellCount = CellsPerAxis * CellsPerAxis * CellsPerAxis;
+
+		PaletteLookup(const FIRGBA8* palette, unsigned size)
+			: m_size(size), m_counts(CellCount), m_candidates(static_cast<size_t>(CellCount) * size)
+		{
+			for (unsigned i = 0; i < size; ++i) {
+				m_red[i] = palette[i].red;
+				m_green[i] = palette[i].green;
+				m_blue[i] = palette[i].blue;
+			}
+			ParallelForRows(CellCount, static_cast<size_t>(size) * 64, [this](unsigned first_cell, unsigned end_cell) {
+				for (unsigned cell = first_cell; cell < end_cell; ++cell) {
+					BuildCell(cell);
+				}
+			});
+		}
+
+		/** Index of the nearest palette entry of (r, g, b) */
+		unsigned Find(int r, int g, int b) const
+		{
+			const unsigned cell = Cell(r, g, b);
+			const uint8_t* candidate = &m_candidates[static_cast<size_t>(cell) * m_size];
+			const uint8_t* end = candidate + m_counts[cell];
+			unsigned best = *candidate;
+			int best_distance = Distance(best, r, g, b);
+			for (++candidate; candidate < end; ++candidate) {
+				const int d = Distance(*candidate, r, g, b);
+				if (d < best_distance) {
+					best_distance = d;
+					best = *candidate;
+				}
+			}
+			return best;
+		}
+
+		int Red(unsigned index) const { return m_red[index]; }
+		int Green(unsigned index) const { return m_green[index]; }
+		int Blue(unsigned index) const { return m_blue[index]; }
+
+	private:
+		unsigned m_size;
+		int m_red[256]{}, m_green[256]{}, m_blue[256]{};
+		std::vector<uint16_t> m_counts;
+		std::vector<uint8_t> m_candidates;
+
+		static unsigned Cell(int r, int g, int b)
+		{
+			const unsigned shift = 8 - CellBits;
+			return ((r >> shift) << (2 * CellBits)) | ((g >> shift) << CellBits) | (b >> shift);
+		}
+
+		int Distance(unsigned index, int r, int g, int b) const
+		{
+			const int dr = m_red[index] - r;
+			const int dg = m_green[index] - g;
+			const int db = m_blue[index] - b;
+			return dr * dr + dg * dg + db * db;
+		}
+
+		/** Squared distances of v to the nearest and to the farthest value of [low, low + CellSize - 1] */
+		static void AxisDistances(int v, int low, int& nearest, int& farthest)
+		{
+			const int high = low + static_cast<int>(CellSize) - 1;
+			const int d = (v < low) ? low - v : (v > high) ? v - high : 0;
+			const int f = std::max(std::abs(v - low), std::abs(v - high));
+			nearest = d * d;
+			farthest = f * f;
+		}
+
+		void BuildCell(unsigned cell)
+		{
+			const int low_r = static_cast<int>((cell >> (2 * CellBits)) * CellSize);
+			const int low_g = static_cast<int>(((cell >> CellBits) & (CellsPerAxis - 1)) * CellSize);
+			const int low_b = static_cast<int>((cell & (CellsPerAxis - 1)) * CellSize);
+
+			int min_distance[256];
+			int threshold = INT_MAX;
+			for (unsigned i = 0; i < m_size; ++i) {
+				int nr, fr, ng, fg, nb, fb;
+				AxisDistances(m_red[i], low_r, nr, fr);
+				AxisDistances(m_green[i], low_g, ng, fg);
+				AxisDistances(m_blue[i], low_b, nb, fb);
+				min_distance[i] = nr + ng + nb;
+				threshold = std::min(threshold, fr + fg + fb);
+			}
+
+			uint8_t* candidates = &m_candidates[static_cast<size_t>(cell) * m_size];
+			unsigned count = 0;
+			for (unsigned i = 0; i < m_size; ++i) {
+				if (min_distance[i] <= threshold) {
+					candidates[count++] = static_cast<uint8_t>(i);
+				}
+			}
+			m_counts[cell] = static_cast<uint16_t>(count);
+		}
+	};
+
+	// ----------------------------------------------------------
+	//  Error diffusion
+	// ----------------------------------------------------------
+
+	/**
+	Error diffusion kernel, in 1/16 of the error : 'ahead' goes to the next pixel of the row,
+	'below_behind', 'below' and 'below_ahead' to the previous, same and next pixels of the next row.
+	*/
+	struct DiffusionKernel
+	{
+		int ahead;
+		int below_behind;
+		int below;
+		int below_ahead;
+	};
+
+	constexpr DiffusionKernel FloydSteinbergKernel = { 7, 3, 5, 1 };
+	constexpr DiffusionKernel SierraLiteKernel = { 8, 4, 4, 0 };
+
+	/** Error accumulated in 1/16 units, rounded to the nearest integer */
+	inline int
+	DiffusedError(int error) {
+		return (error + (error >= 0 ? 8 : -8)) / 16;
+	}
+
+	/** Map the pixels of a row to their nearest palette entry */
+	void
+	MapRow(const PaletteLookup& lookup, const uint8_t* src_bits, unsigned bytespp, uint8_t* dst_bits, unsigned width) {
+		for (unsigned x = 0; x < width; ++x, src_bits += bytespp) {
+			dst_bits[x] = static_cast<uint8_t>(lookup.Find(src_bits[FI_RGBA_RED], src_bits[FI_RGBA_GREEN], src_bits[FI_RGBA_BLUE]));
+		}
+	}
+
+	/**
+	Serpentine error diffusion : even rows are scanned left to right, odd rows right to left,
+	which avoids the directional artifacts of a raster scan. The scan is sequential by nature.
+	*/
+	void
+	DiffuseImage(const PaletteLookup& lookup, FIBITMAP* src, FIBITMAP* dst, const DiffusionKernel& kernel) {
+		const unsigned width = FreeImage_GetWidth(src);
+		const unsigned height = FreeImage_GetHeight(src);
+		const unsigned bytespp = FreeImage_GetBPP(src) / 8;
+
+		// errors of the current and next rows, one pixel of margin on both sides
+		const size_t row_length = (static_cast<size_t>(width) + 2) * 3;
+		std::vector<int> errors(2 * row_length, 0);
+		int* current = errors.data();
+		int* next = current + row_length;
+
+		for (unsigned y = 0; y < height; ++y) {
+			const uint8_t* src_bits = FreeImage_GetScanLine(src, y);
+			uint8_t* dst_bits = FreeImage_GetScanLine(dst, y);
+			const bool forward = (y % 2) == 0;
+			const ptrdiff_t dir = forward ? 1 : -1;
+
+			for (unsigned i = 0; i < width; ++i) {
+				const unsigned x = forward ? i : width - 1 - i;
+				const uint8_t* pixel = src_bits + static_cast<size_t>(x) * bytespp;
+				int* e = current + (static_cast<size_t>(x) + 1) * 3;
+				int* n = next + (static_cast<size_t>(x) + 1) * 3;
+
+				const int r = std::clamp(pixel[FI_RGBA_RED] + DiffusedError(e[0]), 0, 255);
+				const int g = std::clamp(pixel[FI_RGBA_GREEN] + DiffusedError(e[1]), 0, 255);
+				const int b = std::clamp(pixel[FI_RGBA_BLUE] + DiffusedError(e[2]), 0, 255);
+				const unsigned index = lookup.Find(r, g, b);
+				dst_bits[x] = static_cast<uint8_t>(index);
+
+				const int error[3] = { r - lookup.Red(index), g - lookup.Green(index), b - lookup.Blue(index) };
+				for (int c = 0; c < 3; ++c) {
+					e[dir * 3 + c] += kernel.ahead * error[c];
+					n[-dir * 3 + c] += kernel.below_behind * error[c];
+					n[c] += kernel.below * error[c];
+					n[dir * 3 + c] += kernel.below_ahead * error[c];
+				}
+			}
+
+			std::swap(current, next);
+			std::fill(next, next + row_length, 0);
+		}
+	}
+
+} // namespace
+
+/**
+Map a 24-bit or 32-bit image onto a given palette, e.g. a palette computed once by FreeImage_ComputePalette
+for all the frames of an animation. Every pixel gets the nearest palette entry in RGB distance,
+optionally with error diffusion dithering (serpentine scan). The alpha channel is ignored.
+@param dib Source image, 24-bit or 32-bit FIT_BITMAP
+@param palette Palette of PaletteSize entries
+@param PaletteSize Number of palette entries, in [1..256]
+@param diffusion Error diffusion algorithm, FIDF_NONE maps every pixel to its nearest entry
+@return Returns an 8-bit palettized image with the given palette if successful, NULL otherwise
+@see FreeImage_ComputePalette
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_MapToPalette(FIBITMAP *dib, const FIRGBA8 *palette, int PaletteSize, FREE_IMAGE_DIFFUSION diffusion) {
+	if (!FreeImage_HasPixels(dib) || !palette || (PaletteSize < 1) || (PaletteSize > 256)) {
+		return nullptr;
+	}
+	const unsigned bpp = FreeImage_GetBPP(dib);
+	if ((FreeImage_GetImageType(dib) != FIT_BITMAP) || ((bpp != 24) && (bpp != 32))) {
+		return nullptr;
+	}
+	if ((diffusion != FIDF_NONE) && (diffusion != FIDF_FLOYD_STEINBERG) && (diffusion != FIDF_SIERRA_LITE)) {
+		return nullptr;
+	}
+
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+
+	FIBITMAP *dst = FreeImage_Allocate(width, height, 8);
+	if (!dst) {
+		return nullptr;
+	}
+	FIRGBA8 *dst_pal = FreeImage_GetPalette(dst);
+	memset(dst_pal, 0, 256 * sizeof(FIRGBA8));
+	memcpy(dst_pal, palette, PaletteSize * sizeof(FIRGBA8));
+
+	try {
+		const PaletteLookup lookup(palette, static_cast<unsigned>(PaletteSize));
+
+		switch (diffusion) {
+			case FIDF_FLOYD_STEINBERG:
+				DiffuseImage(lookup, dib, dst, FloydSteinbergKernel);
+				break;
+			case FIDF_SIERRA_LITE:
+				DiffuseImage(lookup, dib, dst, SierraLiteKernel);
+				break;
+			default:
+			{
+				const unsigned bytespp = bpp / 8;
+				ParallelForRows(height, static_cast<size_t>(width) * bytespp, [&](unsigned first_row, unsigned end_row) {
+					for (unsigned y = first_row; y < end_row; ++y) {
+						MapRow(lookup, FreeImage_GetScanLine(dib, y), bytespp, FreeImage_GetScanLine(dst, y), width);
+					}
+				});
+				break;
+			}
+		}
+	}
+	catch (const std::bad_alloc&) {
+		FreeImage_Unload(dst);
+		FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+		return nullptr;
+	}
+
+	// copy metadata from src to dst
+	FreeImage_CloneMetadata(dst, dib);
+
+	return dst;
+}
@@ -0,0 +1,144 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#ifndef FREEIMAGE_PARALLEL_FOR_H_
+#define FREEIMAGE_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------
+//  Row-band parallel executor
+// ----------------------------------------------------------
+
+/**
+Maximum number of threads used by the parallel image routines.
+Defaults to the number of hardware threads, the FREEIMAGE_THREADS environment variable overrides it.
+*/
+inline unsigned
+GetParallelThreadCount() {
+	static const unsigned thread_count = []() {
+		if (const char *env = std::getenv("FREEIMAGE_THREADS")) {
+			const int value = std::atoi(env);
+			if (value > 0) {
+				return (unsigned)value;
+			}
+		}
+		return std::max(1U, std::thread::hardware_concurrency());
+	}();
+	return thread_count;
+}
+
+/**
+Split the rows [0, height) into bands of at least 'min_band_bytes' of image data,
+small enough to balance the load between the threads.
+@param height Number of rows
+@param row_bytes Amount of data processed per row, used to size the bands
+@param thread_count Number of threads, set to the number of useful threads
+@return Returns the number of rows per band
+*/
+inline unsigned
+GetParallelBandRows(unsigned height, size_t row_bytes, unsigned& thread_count) {
+	const size_t min_band_bytes = 64 * 1024;
+
+	thread_count = GetParallelThreadCount();
+	unsigned band_rows = (unsigned)std::max<size_t>(1, min_band_bytes / std::max<size_t>(1, row_bytes));
+	if (thread_count > 1) {
+		// a few bands per thread, so that a slow band does not hold the others
+		band_rows = std::max(band_rows, height / (thread_count * 4));
+	}
+	band_rows = std::max(1U, std::min(band_rows, height));
+	thread_count = std::min(thread_count, (height + band_rows - 1) / band_rows);
+	return band_rows;
+}
+
+/**
+Run body(first_row, end_row) over bands of the rows [0, height), on several threads.
+Bands are handed out to the threads on demand, the calling thread takes its share.
+Small images are processed by the calling thread only.
+The body must not throw and may only write to the rows of its band.
+@param height Number of rows
+@param row_bytes Amount of data processed per row, used to size the bands
+@param body Band function, called as body(unsigned first_row, unsigned end_row)
+*/
+template <typename BandBody_>
+void ParallelForRows(unsigned height, size_t row_bytes, BandBody_ body)
+{
+	if (height == 0) {
+		return;
+	}
+	unsigned thread_count = 1;
+	const unsigned band_rows = GetParallelBandRows(height, row_bytes, thread_count);
+	if (thread_count <= 1) {
+		body(0U, height);
+		return;
+	}
+
+	const unsigned band_count = (height + band_rows - 1) / band_rows;
+	std::atomic<unsigned> next_band{ 0 };
+	auto worker = [&]() {
+		for (unsigned i = next_band++; i < band_count; i = next_band++) {
+			body(i * band_rows, std::min(height, (i + 1) * band_rows));
+		}
+	};
+
+	std::vector<std::thread> threads;
+	try {
+		for (unsigned i = 1; i < thread_count; i++) {
+			threads.emplace_back(worker);
+		}
+	} catch (const std::system_error&) {
+		// continue with the threads already started
+	}
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+/**
+Parallel reduction over bands of the rows [0, height).
+Each band is reduced from 'init' by reduce(value, first_row, end_row),
+then the band values are combined in row order with combine(value, band_value).
+@param height Number of rows
+@param row_bytes Amount of data processed per row, used to size the bands
+@param init Initial value of every band, and of the result
+@param reduce Band function, called as reduce(Ty_& value, unsigned first_row, unsigned end_row)
+@param combine Combination function, called as combine(Ty_& value, const Ty_& band_value)
+@return Returns the reduced value
+*/
+template <typename Ty_, typename BandReduce_, typename Combine_>
+Ty_ ParallelReduceRows(unsigned height, size_t row_bytes, const Ty_& init, BandReduce_ reduce, Combine_ combine)
+{
+	Ty_ result = init;
+	if (height == 0) {
+		return result;
+	}
+	unsigned thread_count = 1;
+	const unsigned band_rows = GetParallelBandRows(height, row_bytes, thread_count);
+	if (thread_count <= 1) {
+		reduce(result, 0U, height);
+		return result;
+	}
+
+	const unsigned band_count = (height + band_rows - 1) / band_rows;
+	std::vector<Ty_> values(band_count, init);
+	ParallelForRows(band_count, row_bytes * band_rows, [&](unsigned first_band, unsigned end_band) {
+		for (unsigned i = first_band; i < end_band; i++) {
+			reduce(values[i], i * band_rows, std::min(height, (i + 1) * band_rows));
+		}
+	});
+	for (const auto& value : values) {
+		combine(result, value);
+	}
+	return result;
+}
+
+#endif // FREEIMAGE_PARALLEL_FOR_H_
@@ -148,6 +148,19 @@ private:
 		}
 	}
 
+	void* DoOpenPersistent(FreeImageIO* io, fi_handle handle, bool open_for_reading) override {
+		if (mPlugin->open_persistent_proc) {
+			return mPlugin->open_persistent_proc(io, handle, static_cast<FIBOOL>(open_for_reading));
+		}
+		return nullptr;
+	}
+
+	void DoClosePersistent(FreeImageIO* io, fi_handle handle, void* data) override {
+		if (mPlugin->close_persistent_proc) {
+			mPlugin->close_persistent_proc(io, handle, data);
+		}
+	}
+
 	bool DoValidate(FreeImageIO* io, fi_handle handle) const override {
 		if (mPlugin->validate_proc) {
 			return mPlugin->validate_proc(io, handle);
@@ -212,6 +225,21 @@ private:
 		return false;
 	}
 
+	bool DoSupportsOpenPersistent() const override {
+		return (mPlugin->open_persistent_proc && mPlugin->close_persistent_proc);
+	}
+
+	bool DoLoadScanlines(FreeImageIO* io, fi_handle handle, int flags, FI_ScanlineProc scanline_proc, void* user_data) override {
+		if (mPlugin->load_scanlines_proc) {
+			return mPlugin->load_scanlines_proc(io, handle, flags, scanline_proc, user_data);
+		}
+		return false;
+	}
+
+	bool DoSupportsLoadScanlines() const override {
+		return (mPlugin->load_scanlines_proc != nullptr);
+	}
+
 
 	/** The actual plugin, holding the function pointers */
 	std::unique_ptr<Plugin> mPlugin = std::make_unique<Plugin>();
@@ -731,6 +759,48 @@ FreeImage_LoadFromHandle(FREE_IMAGE_FORMAT fif, FreeImageIO *io, fi_handle handl
 	return bitmap;
 }
 
+FIBOOL DLL_CALLCONV
+FreeImage_LoadScanlinesFromHandle(FREE_IMAGE_FORMAT fif, FreeImageIO *io, fi_handle handle, FI_ScanlineProc scanline_proc, void *user_data, int flags) {
+	if (!scanline_proc) {
+		return FALSE;
+	}
+	if (auto& plugins = PluginsRegistrySingleton::Instance()) {
+		if (auto it = plugins->FindFromFIF(fif); it != plugins->NodesCEnd()) {
+			auto& node = it->second;
+			if (node->SupportsLoadScanlines()) {
+				return node->LoadScanlines(io, handle, flags, scanline_proc, user_data) ? TRUE : FALSE;
+			}
+			// no streaming decoder : load the whole image and feed its rows
+			if (auto *dib = node->Load(io, handle, -1, flags & ~FIF_LOAD_NOPIXELS)) {
+				FIBOOL bContinue{TRUE};
+				const unsigned height = FreeImage_GetHeight(dib);
+				for (unsigned y = 0; (y < height) && bContinue; y++) {
+					bContinue = scanline_proc(dib, y, FreeImage_GetScanLine(dib, height - 1 - y), user_data);
+				}
+				FreeImage_Unload(dib);
+				return bContinue;
+			}
+		}
+	}
+	return FALSE;
+}
+
+FIBOOL DLL_CALLCONV
+FreeImage_LoadScanlines(FREE_IMAGE_FORMAT fif, const char *filename, FI_ScanlineProc scanline_proc, void *user_data, int flags) {
+	FreeImageIO io;
+	SetDefaultIO(&io);
+
+	FIBOOL bSuccess{FALSE};
+	if (auto *handle = fopen(filename, "rb")) {
+		bSuccess = FreeImage_LoadScanlinesFromHandle(fif, &io, (fi_handle)handle, scanline_proc, user_data, flags);
+		fclose(handle);
+	} else {
+		FreeImage_OutputMessageProc((int)fif, "FreeImage_LoadScanlines: failed to open file %s", filename);
+	}
+
+	return bSuccess;
+}
+
 FIBITMAP * DLL_CALLCONV
 FreeImage_Load(FREE_IMAGE_FORMAT fif, const char *filename, int flags) {
 	FreeImageIO io;
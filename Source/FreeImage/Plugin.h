@@ -108,6 +108,11 @@ public:
 		return DoLoad(io, handle, page, flags, data);
 	}
 
+	// stream the rows of the first image to a consumer, top-down
+	bool LoadScanlines(FreeImageIO* io, fi_handle handle, int flags, FI_ScanlineProc scanline_proc, void* user_data) {
+		return DoLoadScanlines(io, handle, flags, scanline_proc, user_data);
+	}
+
 	bool Save(FIBITMAP* dib, FreeImageIO* io, fi_handle handle, int page, int flags) {
 		bool success{ false };
 		if (DoSupportsOpenPersistent()) {
@@ -208,6 +213,10 @@ public:
 		return DoSupportsOpenPersistent();
 	}
 
+	bool SupportsLoadScanlines() const {
+		return DoSupportsLoadScanlines();
+	}
+
 private:
 	virtual void* DoOpen(FreeImageIO* io, fi_handle handle, bool open_for_reading) = 0;
 
@@ -254,6 +263,14 @@ private:
 		return false;
 	}
 
+	virtual bool DoLoadScanlines(FreeImageIO* /*io*/, fi_handle /*handle*/, int /*flags*/, FI_ScanlineProc /*scanline_proc*/, void* /*user_data*/) {
+		return false;
+	}
+
+	virtual bool DoSupportsLoadScanlines() const {
+		return false;
+	}
+
 private:
 	/** Handle to a user plugin DLL (NULL for standard plugins) */
 	void* mInstance{ nullptr };
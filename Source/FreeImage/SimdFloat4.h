@@ -0,0 +1,323 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#ifndef FREEIMAGE_SIMD_FLOAT4_H_
+#define FREEIMAGE_SIMD_FLOAT4_H_
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define FI_FLOAT4_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#define FI_FLOAT4_NEON 1
+	#include <arm_neon.h>
+#endif
+
+// ----------------------------------------------------------
+//  4 x float vector, one RGBA pixel per vector
+// ----------------------------------------------------------
+
+/**
+4 x float vector using the baseline SIMD instruction set of the target (SSE2 or NEON),
+with a scalar fallback. Lane 3 holds the alpha channel of a pixel.
+*/
+struct Float4
+{
+#if defined(FI_FLOAT4_SSE2)
+	using Native = __m128;
+	using NativeMask = __m128;
+#elif defined(FI_FLOAT4_NEON)
+	using Native = float32x4_t;
+	using NativeMask = uint32x4_t;
+#else
+	struct Native { float v[4]; };
+	struct NativeMask { bool v[4]; };
+#endif
+
+	/** Lane mask, result of the comparisons */
+	struct Mask {
+		NativeMask m;
+	};
+
+	Native v;
+
+	static Float4 Load(const float *p) {
+#if defined(FI_FLOAT4_SSE2)
+		return { _mm_loadu_ps(p) };
+#elif defined(FI_FLOAT4_NEON)
+		return { vld1q_f32(p) };
+#else
+		return { { { p[0], p[1], p[2], p[3] } } };
+#endif
+	}
+
+	void Store(float *p) const {
+#if defined(FI_FLOAT4_SSE2)
+		_mm_storeu_ps(p, v);
+#elif defined(FI_FLOAT4_NEON)
+		vst1q_f32(p, v);
+#else
+		std::copy(v.v, v.v + 4, p);
+#endif
+	}
+
+	static Float4 Set(float x) {
+#if defined(FI_FLOAT4_SSE2)
+		return { _mm_set1_ps(x) };
+#elif defined(FI_FLOAT4_NEON)
+		return { vdupq_n_f32(x) };
+#else
+		return { { { x, x, x, x } } };
+#endif
+	}
+
+	static Float4 Set(float x, float y, float z, float w) {
+		const float p[4] = { x, y, z, w };
+		return Load(p);
+	}
+
+	/** Broadcast lane 3 (alpha) */
+	Float4 SplatW() const {
+#if defined(FI_FLOAT4_SSE2)
+		return { _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)) };
+#elif defined(FI_FLOAT4_NEON)
+		return { vdupq_n_f32(vgetq_lane_f32(v, 3)) };
+#else
+		return Set(v.v[3]);
+#endif
+	}
+
+	/** Lanes 0 to 2 of this vector, lane 3 of w */
+	Float4 WithW(const Float4& w) const {
+#if defined(FI_FLOAT4_SSE2)
+		const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		return { _mm_or_ps(_mm_and_ps(mask, v), _mm_andnot_ps(mask, w.v)) };
+#elif defined(FI_FLOAT4_NEON)
+		return { vsetq_lane_f32(vgetq_lane_f32(w.v, 3), v, 3) };
+#else
+		return { { { v.v[0], v.v[1], v.v[2], w.v.v[3] } } };
+#endif
+	}
+
+	float W() const {
+#if defined(FI_FLOAT4_SSE2)
+		return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+#elif defined(FI_FLOAT4_NEON)
+		return vgetq_lane_f32(v, 3);
+#else
+		return v.v[3];
+#endif
+	}
+};
+
+#if defined(FI_FLOAT4_SSE2)
+
+inline Float4 operator+(const Float4& a, const Float4& b) { return { _mm_add_ps(a.v, b.v) }; }
+inline Float4 operator-(const Float4& a, const Float4& b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline Float4 operator*(const Float4& a, const Float4& b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline Float4 operator/(const Float4& a, const Float4& b) { return { _mm_div_ps(a.v, b.v) }; }
+inline Float4 Min(const Float4& a, const Float4& b) { return { _mm_min_ps(a.v, b.v) }; }
+inline Float4 Max(const Float4& a, const Float4& b) { return { _mm_max_ps(a.v, b.v) }; }
+inline Float4::Mask operator<=(const Float4& a, const Float4& b) { return { _mm_cmple_ps(a.v, b.v) }; }
+inline Float4::Mask operator>(const Float4& a, const Float4& b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+/** Lanes of a where the mask is set, lanes of b elsewhere */
+inline Float4 Select(const Float4::Mask& mask, const Float4& a, const Float4& b) {
+	return { _mm_or_ps(_mm_and_ps(mask.m, a.v), _mm_andnot_ps(mask.m, b.v)) };
+}
+
+#elif defined(FI_FLOAT4_NEON)
+
+inline Float4 operator+(const Float4& a, const Float4& b) { return { vaddq_f32(a.v, b.v) }; }
+inline Float4 operator-(const Float4& a, const Float4& b) { return { vsubq_f32(a.v, b.v) }; }
+inline Float4 operator*(const Float4& a, const Float4& b) { return { vmulq_f32(a.v, b.v) }; }
+inline Float4 operator/(const Float4& a, const Float4& b) {
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return { vdivq_f32(a.v, b.v) };
+#else
+	float x[4], y[4];
+	a.Store(x);
+	b.Store(y);
+	return Float4::Set(x[0] / y[0], x[1] / y[1], x[2] / y[2], x[3] / y[3]);
+#endif
+}
+inline Float4 Min(const Float4& a, const Float4& b) { return { vminq_f32(a.v, b.v) }; }
+inline Float4 Max(const Float4& a, const Float4& b) { return { vmaxq_f32(a.v, b.v) }; }
+inline Float4::Mask operator<=(const Float4& a, const Float4& b) { return { vcleq_f32(a.v, b.v) }; }
+inline Float4::Mask operator>(const Float4& a, const Float4& b) { return { vcgtq_f32(a.v, b.v) }; }
+inline Float4 Select(const Float4::Mask& mask, const Float4& a, const Float4& b) { return { vbslq_f32(mask.m, a.v, b.v) }; }
+
+#else
+
+namespace details
+{
+	template <typename Op_>
+	inline Float4 Float4Apply(const Float4& a, const Float4& b, Op_ op) {
+		return { { { op(a.v.v[0], b.v.v[0]), op(a.v.v[1], b.v.v[1]), op(a.v.v[2], b.v.v[2]), op(a.v.v[3], b.v.v[3]) } } };
+	}
+}
+
+inline Float4 operator+(const Float4& a, const Float4& b) { return details::Float4Apply(a, b, [](float x, float y) { return x + y; }); }
+inline Float4 operator-(const Float4& a, const Float4& b) { return details::Float4Apply(a, b, [](float x, float y) { return x - y; }); }
+inline Float4 operator*(const Float4& a, const Float4& b) { return details::Float4Apply(a, b, [](float x, float y) { return x * y; }); }
+inline Float4 operator/(const Float4& a, const Float4& b) { return details::Float4Apply(a, b, [](float x, float y) { return x / y; }); }
+inline Float4 Min(const Float4& a, const Float4& b) { return details::Float4Apply(a, b, [](float x, float y) { return y < x ? y : x; }); }
+inline Float4 Max(const Float4& a, const Float4& b) { return details::Float4Apply(a, b, [](float x, float y) { return x < y ? y : x; }); }
+inline Float4::Mask operator<=(const Float4& a, const Float4& b) {
+	return { { { a.v.v[0] <= b.v.v[0], a.v.v[1] <= b.v.v[1], a.v.v[2] <= b.v.v[2], a.v.v[3] <= b.v.v[3] } } };
+}
+inline Float4::Mask operator>(const Float4& a, const Float4& b) {
+	return { { { a.v.v[0] > b.v.v[0], a.v.v[1] > b.v.v[1], a.v.v[2] > b.v.v[2], a.v.v[3] > b.v.v[3] } } };
+}
+inline Float4 Select(const Float4::Mask& mask, const Float4& a, const Float4& b) {
+	return { { {
+		mask.m.v[0] ? a.v.v[0] : b.v.v[0], mask.m.v[1] ? a.v.v[1] : b.v.v[1],
+		mask.m.v[2] ? a.v.v[2] : b.v.v[2], mask.m.v[3] ? a.v.v[3] : b.v.v[3]
+	} } };
+}
+
+#endif
+
+// ----------------------------------------------------------
+//  Exponent and mantissa
+// ----------------------------------------------------------
+
+namespace details
+{
+#if defined(FI_FLOAT4_SSE2)
+
+	/** Round down the lanes of x, |x| < 2^22 */
+	inline Float4 Float4Floor(const Float4& x) {
+		const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+		return { _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x.v), _mm_set1_ps(1))) };
+	}
+
+	/** x = m * 2^e with m in [1, 2), for positive normal numbers */
+	inline void Float4Frexp(const Float4& x, Float4& m, Float4& e) {
+		const __m128i bits = _mm_castps_si128(x.v);
+		e.v = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+		m.v = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+	}
+
+	/** 2^n for integer values n in [-126, 127] */
+	inline Float4 Float4Exp2Int(const Float4& n) {
+		return { _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127)), 23)) };
+	}
+
+#elif defined(FI_FLOAT4_NEON)
+
+	inline Float4 Float4Floor(const Float4& x) {
+		const float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(x.v));
+		const uint32x4_t above = vcgtq_f32(t, x.v);
+		return { vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(above, vreinterpretq_u32_f32(vdupq_n_f32(1))))) };
+	}
+
+	inline void Float4Frexp(const Float4& x, Float4& m, Float4& e) {
+		const int32x4_t bits = vreinterpretq_s32_f32(x.v);
+		e.v = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(bits), 23)), vdupq_n_s32(127)));
+		m.v = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007FFFFF)), vdupq_n_s32(0x3F800000)));
+	}
+
+	inline Float4 Float4Exp2Int(const Float4& n) {
+		return { vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127)), 23)) };
+	}
+
+#else
+
+	template <typename Op_>
+	inline Float4 Float4Map(const Float4& x, Op_ op) {
+		return { { { op(x.v.v[0]), op(x.v.v[1]), op(x.v.v[2]), op(x.v.v[3]) } } };
+	}
+
+	inline Float4 Float4Floor(const Float4& x) {
+		return Float4Map(x, [](float a) { return std::floor(a); });
+	}
+
+	inline void Float4Frexp(const Float4& x, Float4& m, Float4& e) {
+		for (int i = 0; i < 4; i++) {
+			uint32_t bits;
+			std::memcpy(&bits, &x.v.v[i], sizeof(bits));
+			e.v.v[i] = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+			bits = (bits & 0x007FFFFF) | 0x3F800000;
+			std::memcpy(&m.v.v[i], &bits, sizeof(bits));
+		}
+	}
+
+	inline Float4 Float4Exp2Int(const Float4& n) {
+		return Float4Map(n, [](float a) {
+			const uint32_t bits = static_cast<uint32_t>(static_cast<int>(a) + 127) << 23;
+			float r;
+			std::memcpy(&r, &bits, sizeof(r));
+			return r;
+		});
+	}
+
+#endif
+}
+
+// ----------------------------------------------------------
+//  Logarithm, exponential and power approximations
+// ----------------------------------------------------------
+
+/**
+Base 2 logarithm. x is clamped to [FLT_MIN, FLT_MAX] (zero and negative values give -126), NaN values are kept.
+The mantissa is reduced to [sqrt(1/2), sqrt(2)) and log2 evaluated by the atanh series up to the 7th power :
+the error is below 1.5e-7 * max(1, |log2(x)|), float rounding included.
+*/
+inline Float4 Log2(const Float4& x) {
+	Float4 m, e;
+	details::Float4Frexp(Max(Min(x, Float4::Set(FLT_MAX)), Float4::Set(FLT_MIN)), m, e);
+	// m in [sqrt(1/2), sqrt(2))
+	const Float4::Mask high = Float4::Set(1.41421356F) <= m;
+	m = Select(high, m * Float4::Set(0.5F), m);
+	e = Select(high, e + Float4::Set(1), e);
+	const Float4 one = Float4::Set(1);
+	const Float4 t = (m - one) / (m + one);
+	const Float4 t2 = t * t;
+	// 2 / ln(2) * (t + t^3 / 3 + t^5 / 5 + t^7 / 7)
+	const Float4 poly = Float4::Set(2.88539008F) + t2 * (Float4::Set(0.961796694F) + t2 * (Float4::Set(0.577078016F) + t2 * Float4::Set(0.412198583F)));
+	// x <= x is false for NaN only
+	return Select(x <= x, e + t * poly, x);
+}
+
+/**
+Base 2 exponential. x is clamped to [-126, 127.49] so that the result is a normal number, NaN values are kept.
+2^x = 2^n * 2^f with n = round(x) and f in [-1/2, 1/2], 2^f is evaluated by its Taylor polynomial of degree 6 :
+the relative error is below 2.5e-7, float rounding included.
+*/
+inline Float4 Exp2(const Float4& x) {
+	const Float4 c = Max(Min(x, Float4::Set(127.49F)), Float4::Set(-126));
+	const Float4 n = details::Float4Floor(c + Float4::Set(0.5F));
+	const Float4 f = c - n;
+	// ln(2)^k / k!
+	const Float4 poly = Float4::Set(1) + f * (Float4::Set(0.693147181F) + f * (Float4::Set(0.240226507F) + f * (Float4::Set(0.0555041087F)
+		+ f * (Float4::Set(0.00961812911F) + f * (Float4::Set(0.00133335581F) + f * Float4::Set(0.000154035304F))))));
+	return Select(x <= x, poly * details::Float4Exp2Int(n), x);
+}
+
+/** Natural logarithm, see Log2 : the error is below 1e-7 * max(1, |log2(x)|) */
+inline Float4 Log(const Float4& x) {
+	return Log2(x) * Float4::Set(0.693147181F);
+}
+
+/** Natural exponential, see Exp2 : the relative error is below 2.5e-7 + 6e-8 * |x| */
+inline Float4 Exp(const Float4& x) {
+	return Exp2(x * Float4::Set(1.44269504F));
+}
+
+/**
+x^y for x > 0, computed as 2^(y * log2(x)). x is clamped as in Log2, so that 0^y is a tiny positive number for y > 0.
+When the result is a normal number, the relative error is below 2e-7 * (1 + |y * log2(x)|).
+*/
+inline Float4 Pow(const Float4& x, const Float4& y) {
+	return Exp2(y * Log2(x));
+}
+
+#endif // FREEIMAGE_SIMD_FLOAT4_H_
@@ -109,7 +109,7 @@ FreeImage_FindMinMax(FIBITMAP* dib, double* min_brightness, double* max_brightne
 		success = true;
 		break;
 	case FIT_INT16:
-		res = FindMinMax<int32_t>(dib);
+		res = FindMinMax<int16_t>(dib);
 		success = true;
 		break;
 	default:
@@ -140,29 +140,29 @@ namespace
 	template <typename PixelType_>
 	void FindMinMaxValueImpl(FIBITMAP* src, void* out_min_value, void* out_max_value)
 	{
-		PixelType_ minVal, maxVal;
-		PixelFill(minVal, std::numeric_limits<ToValueType<PixelType_>>::max());
-		PixelFill(maxVal, std::numeric_limits<ToValueType<PixelType_>>::lowest());
+		using ValueType = ToValueType<PixelType_>;
+		constexpr unsigned channels = PixelChannelsNumber<PixelType_>::value;
+		using Range = ChannelMinMax<ValueType, channels>;
 
 		const unsigned width = FreeImage_GetWidth(src);
 		const unsigned height = FreeImage_GetHeight(src);
 		const unsigned src_pitch = FreeImage_GetPitch(src);
+		const uint8_t* src_bits = FreeImage_GetBits(src);
+		const size_t count = (size_t)width * channels;
 
-		uint8_t* src_bits = FreeImage_GetBits(src);
-		for (unsigned y = 0; y < height; ++y) {
-			auto src_pixel = static_cast<PixelType_*>(static_cast<void*>(src_bits));
-			for (unsigned x = 0; x < width; ++x) {
-				const PixelType_ val = src_pixel[x];
-				SetChannel<0>(minVal, std::min(GetChannel<0>(minVal), GetChannel<0>(val)));
-				SetChannel<1>(minVal, std::min(GetChannel<1>(minVal), GetChannel<1>(val)));
-				SetChannel<2>(minVal, std::min(GetChannel<2>(minVal), GetChannel<2>(val)));
-				SetChannel<3>(minVal, std::min(GetChannel<3>(minVal), GetChannel<3>(val)));
-				SetChannel<0>(maxVal, std::max(GetChannel<0>(maxVal), GetChannel<0>(val)));
-				SetChannel<1>(maxVal, std::max(GetChannel<1>(maxVal), GetChannel<1>(val)));
-				SetChannel<2>(maxVal, std::max(GetChannel<2>(maxVal), GetChannel<2>(val)));
-				SetChannel<3>(maxVal, std::max(GetChannel<3>(maxVal), GetChannel<3>(val)));
+		// vectorized per band of rows, the bands run in parallel
+		const Range range = ParallelReduceRows(height, count * sizeof(ValueType), Range{}, [&](Range& band, unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; ++y) {
+				band.Add(static_cast<const ValueType*>(static_cast<const void*>(src_bits + (size_t)y * src_pitch)), count);
 			}
-			src_bits += src_pitch;
+		}, [](Range& result, const Range& band) {
+			result.Merge(band);
+		});
+
+		PixelType_ minVal, maxVal;
+		for (unsigned c = 0; c < channels; ++c) {
+			static_cast<ValueType*>(static_cast<void*>(&minVal))[c] = range.Min(c);
+			static_cast<ValueType*>(static_cast<void*>(&maxVal))[c] = range.Max(c);
 		}
 
 		if (out_min_value) {
@@ -249,7 +249,7 @@ FreeImage_FindMinMaxValue(FIBITMAP* dib, void* min_value, void* max_value)
 		FindMinMaxValueImpl<uint16_t>(dib, min_value, max_value);
 		break;
 	case FIT_INT16:
-		FindMinMaxValueImpl<uint16_t>(dib, min_value, max_value);
+		FindMinMaxValueImpl<int16_t>(dib, min_value, max_value);
 		break;
 	case FIT_COMPLEX:
 		FindMinMaxValueImpl<FICOMPLEX>(dib, min_value, max_value);
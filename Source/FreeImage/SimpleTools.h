@@ -8,7 +8,10 @@
 #define FREEIMAGE_SIMPLE_TOOLS_H_
 
 #include "ConversionYUV.h"
+#include "ParallelFor.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <tuple>
 #include <memory>
 
@@ -41,18 +44,19 @@ void BitmapTransform(FIBITMAP* dst, FIBITMAP* src, UnaryOperation_ unary_op)
 	const unsigned src_pitch = FreeImage_GetPitch(src);
 	const unsigned dst_pitch = FreeImage_GetPitch(dst);
 
-	const uint8_t* src_bits = FreeImage_GetBits(src);
-	uint8_t* dst_bits = FreeImage_GetBits(dst);
-
-	for (unsigned y = 0; y < height; ++y) {
-		auto src_pixel = static_cast<const SrcPixel_*>(static_cast<const void*>(src_bits));
-		auto dst_pixel = static_cast<DstPixel_*>(static_cast<void*>(dst_bits));
-		for (unsigned x = 0; x < width; ++x) {
-			dst_pixel[x] = unary_op(src_pixel[x]);
+	const uint8_t* const src_bits = FreeImage_GetBits(src);
+	uint8_t* const dst_bits = FreeImage_GetBits(dst);
+
+	// bands of rows are transformed in parallel : unary_op must be safe to call concurrently
+	ParallelForRows(height, (size_t)width * (sizeof(SrcPixel_) + sizeof(DstPixel_)), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; ++y) {
+			auto src_pixel = static_cast<const SrcPixel_*>(static_cast<const void*>(src_bits + (size_t)y * src_pitch));
+			auto dst_pixel = static_cast<DstPixel_*>(static_cast<void*>(dst_bits + (size_t)y * dst_pitch));
+			for (unsigned x = 0; x < width; ++x) {
+				dst_pixel[x] = unary_op(src_pixel[x]);
+			}
 		}
-		src_bits += src_pitch;
-		dst_bits += dst_pitch;
-	}
+	});
 }
 
 
@@ -316,15 +320,21 @@ struct YuvBrightness
 template <typename PixelTy_, typename BrightnessOp_ = Brightness>
 std::tuple<PixelTy_*, PixelTy_*, double, double> FindMinMax(FIBITMAP* src, BrightnessOp_ brightnessOp = BrightnessOp_{})
 {
-    PixelTy_* minIt{}, * maxIt{};
-    double minVal = 0.0, maxVal = 0.0;
-    if (src) {
-        const unsigned h = FreeImage_GetHeight(src);
-        const unsigned w = FreeImage_GetWidth(src);
-        const unsigned pitch = FreeImage_GetPitch(src);
-        auto srcLine = static_cast<uint8_t*>(static_cast<void*>(FreeImage_GetBits(src)));
-        for (unsigned j = 0; j < h; ++j, srcLine += pitch) {
-            auto pixIt = static_cast<PixelTy_*>(static_cast<void*>(srcLine));
+    using Result = std::tuple<PixelTy_*, PixelTy_*, double, double>;
+    if (!src) {
+        return Result{};
+    }
+    const unsigned h = FreeImage_GetHeight(src);
+    const unsigned w = FreeImage_GetWidth(src);
+    const unsigned pitch = FreeImage_GetPitch(src);
+    uint8_t* const bits = FreeImage_GetBits(src);
+
+    // bands of rows are searched in parallel and combined in row order,
+    // ties keep the first pixel as a sequential scan does
+    return ParallelReduceRows(h, (size_t)w * sizeof(PixelTy_), Result{}, [&](Result& band, unsigned first_row, unsigned end_row) {
+        auto& [minIt, maxIt, minVal, maxVal] = band;
+        for (unsigned j = first_row; j < end_row; ++j) {
+            auto pixIt = static_cast<PixelTy_*>(static_cast<void*>(bits + (size_t)j * pitch));
             for (unsigned i = 0; i < w; ++i, ++pixIt) {
                 if (IsNan(*pixIt)) {
                     continue;
@@ -346,10 +356,98 @@ std::tuple<PixelTy_*, PixelTy_*, double, double> FindMinMax(FIBITMAP* src, Brigh
                 }
             }
         }
-    }
-    return std::make_tuple(minIt, maxIt, minVal, maxVal);
+    }, [](Result& result, const Result& band) {
+        if (!std::get<0>(band)) {
+            return;
+        }
+        if (!std::get<0>(result)) {
+            result = band;
+            return;
+        }
+        if (std::get<2>(band) < std::get<2>(result)) {
+            std::get<0>(result) = std::get<0>(band);
+            std::get<2>(result) = std::get<2>(band);
+        }
+        if (std::get<3>(result) < std::get<3>(band)) {
+            std::get<1>(result) = std::get<1>(band);
+            std::get<3>(result) = std::get<3>(band);
+        }
+    });
 }
 
 
+/**
+Per channel minimum and maximum of interleaved values, Channels_ values per pixel.
+The values are reduced in blocks of Lanes values, a whole number of pixels and of 32 bytes,
+so that the block loops compile to vector min / max instructions. NaN values are ignored.
+*/
+template <typename Value_, unsigned Channels_>
+struct ChannelMinMax
+{
+    static constexpr unsigned Lanes = Channels_ * std::max<unsigned>(1, 32 / sizeof(Value_));
+
+    Value_ min[Lanes];
+    Value_ max[Lanes];
+
+    ChannelMinMax()
+    {
+        std::fill(min, min + Lanes, std::numeric_limits<Value_>::max());
+        std::fill(max, max + Lanes, std::numeric_limits<Value_>::lowest());
+    }
+
+    /** Add 'count' values, a whole number of pixels */
+    void Add(const Value_* values, size_t count)
+    {
+        Value_ lo[Lanes], hi[Lanes];
+        std::copy(min, min + Lanes, lo);
+        std::copy(max, max + Lanes, hi);
+        size_t i = 0;
+        for (; i + Lanes <= count; i += Lanes) {
+            for (unsigned k = 0; k < Lanes; ++k) {
+                const Value_ v = values[i + k];
+                lo[k] = (v < lo[k]) ? v : lo[k];
+                hi[k] = (hi[k] < v) ? v : hi[k];
+            }
+        }
+        // the remaining pixels start at lane 0
+        for (unsigned k = 0; i < count; ++i, ++k) {
+            const Value_ v = values[i];
+            lo[k] = (v < lo[k]) ? v : lo[k];
+            hi[k] = (hi[k] < v) ? v : hi[k];
+        }
+        std::copy(lo, lo + Lanes, min);
+        std::copy(hi, hi + Lanes, max);
+    }
+
+    void Merge(const ChannelMinMax& other)
+    {
+        for (unsigned k = 0; k < Lanes; ++k) {
+            min[k] = std::min(min[k], other.min[k]);
+            max[k] = std::max(max[k], other.max[k]);
+        }
+    }
+
+    /** Minimum of the channel c, in memory order */
+    Value_ Min(unsigned c) const
+    {
+        Value_ v = min[c];
+        for (unsigned k = c + Channels_; k < Lanes; k += Channels_) {
+            v = std::min(v, min[k]);
+        }
+        return v;
+    }
+
+    /** Maximum of the channel c, in memory order */
+    Value_ Max(unsigned c) const
+    {
+        Value_ v = max[c];
+        for (unsigned k = c + Channels_; k < Lanes; k += Channels_) {
+            v = std::max(v, max[k]);
+        }
+        return v;
+    }
+};
+
+
 
 #endif //FREEIMAGE_SIMPLE_TOOLS_H_
@@ -21,6 +21,7 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ToneMapping.h"
 
 /**
 Performs a tone mapping on a 48-bit RGB or a 96-bit RGBF image and returns a 24-bit image. 
@@ -30,40 +31,41 @@ When both parameters are set to zero, a default set of parameters is used.
 @param tmo Tone mapping operator
 @param first_param First parameter of the algorithm
 @param second_param Second parameter of the algorithm
+@param dither Rounding or dithering of the 8-bit channels, used by FITMO_DRAGO03, FITMO_REINHARD05 and FITMO_FATTAL02
 return Returns a 24-bit tone mapped image if successful, returns NULL otherwise
 */ 
 FIBITMAP * DLL_CALLCONV
-FreeImage_ToneMapping(FIBITMAP *dib, FREE_IMAGE_TMO tmo, double first_param, double second_param) {
+FreeImage_ToneMappingEx(FIBITMAP *dib, FREE_IMAGE_TMO tmo, double first_param, double second_param, FREE_IMAGE_DEPTH_DITHER dither) {
 	if (FreeImage_HasPixels(dib)) {
 		switch (tmo) {
 			// Adaptive logarithmic mapping (F. Drago, 2003)
 			case FITMO_DRAGO03:
 				if ((first_param == 0) && (second_param == 0)) {
 					// use default values (gamma = 2.2, exposure = 0)
-					return FreeImage_TmoDrago03(dib, 2.2, 0);
+					return TmoDrago03(dib, 2.2, 0, dither);
 				} else {
 					// use user's value
-					return FreeImage_TmoDrago03(dib, first_param, second_param);
+					return TmoDrago03(dib, first_param, second_param, dither);
 				}
 				break;
 			// Dynamic range reduction inspired by photoreceptor phhysiology (E. Reinhard, 2005)
 			case FITMO_REINHARD05:
 				if ((first_param == 0) && (second_param == 0)) {
 					// use default values by setting intensity to 0 and contrast to 0
-					return FreeImage_TmoReinhard05(dib, 0, 0);
+					return TmoReinhard05Ex(dib, 0, 0, 1, 0, dither);
 				} else {
 					// use user's value
-					return FreeImage_TmoReinhard05(dib, first_param, second_param);
+					return TmoReinhard05Ex(dib, first_param, second_param, 1, 0, dither);
 				}
 				break;
 			// Gradient Domain HDR Compression (R. Fattal, 2002)
 			case FITMO_FATTAL02:
 				if ((first_param == 0) && (second_param == 0)) {
 					// use default values by setting color saturation to 0.5 and attenuation to 0.85
-					return FreeImage_TmoFattal02(dib, 0.5, 0.85);
+					return TmoFattal02(dib, 0.5, 0.85, dither);
 				} else {
 					// use user's value
-					return FreeImage_TmoFattal02(dib, first_param, second_param);
+					return TmoFattal02(dib, first_param, second_param, dither);
 				}
 				break;
 
@@ -89,4 +91,13 @@ FreeImage_ToneMapping(FIBITMAP *dib, FREE_IMAGE_TMO tmo, double first_param, dou
 	return nullptr;
 }
 
+/**
+Performs a tone mapping on a 48-bit RGB or a 96-bit RGBF image and returns a 24-bit image, rounding the 8-bit channels.
+@see FreeImage_ToneMappingEx
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_ToneMapping(FIBITMAP *dib, FREE_IMAGE_TMO tmo, double first_param, double second_param) {
+	return FreeImage_ToneMappingEx(dib, tmo, first_param, second_param, FIDD_NONE);
+}
+
 
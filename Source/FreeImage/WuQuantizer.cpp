@@ -33,6 +33,8 @@
 #include "Quantizers.h"
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "ParallelFor.h"
+#include <vector>
 
 ///////////////////////////////////////////////////////////////////////
 
@@ -47,9 +49,9 @@
 // Constructor / Destructor
 
 WuQuantizer::WuQuantizer(FIBITMAP *dib) {
-	width = FreeImage_GetWidth(dib);
-	height = FreeImage_GetHeight(dib);
-	pitch = FreeImage_GetPitch(dib);
+	width = dib ? FreeImage_GetWidth(dib) : 0;
+	height = dib ? FreeImage_GetHeight(dib) : 0;
+	pitch = dib ? FreeImage_GetPitch(dib) : 0;
 	m_dib = dib;
 
 	gm2 = nullptr;
@@ -57,16 +59,18 @@ WuQuantizer::WuQuantizer(FIBITMAP *dib) {
 	Qadd = nullptr;
 
 	// Allocate 3D arrays
-	gm2 = static_cast<float*>(calloc(SIZE_3D, sizeof(float)));
-	wt = static_cast<int32_t*>(calloc(SIZE_3D, sizeof(int32_t)));
-	mr = static_cast<int32_t*>(calloc(SIZE_3D, sizeof(int32_t)));
-	mg = static_cast<int32_t*>(calloc(SIZE_3D, sizeof(int32_t)));
-	mb = static_cast<int32_t*>(calloc(SIZE_3D, sizeof(int32_t)));
-
-	// Allocate Qadd
-	Qadd = static_cast<uint16_t*>(calloc(static_cast<size_t>(width) * height, sizeof(uint16_t)));
+	gm2 = static_cast<double*>(calloc(SIZE_3D, sizeof(double)));
+	wt = static_cast<int64_t*>(calloc(SIZE_3D, sizeof(int64_t)));
+	mr = static_cast<int64_t*>(calloc(SIZE_3D, sizeof(int64_t)));
+	mg = static_cast<int64_t*>(calloc(SIZE_3D, sizeof(int64_t)));
+	mb = static_cast<int64_t*>(calloc(SIZE_3D, sizeof(int64_t)));
+
+	// Allocate Qadd (not needed when only the palette is computed)
+	if (dib) {
+		Qadd = static_cast<uint16_t*>(calloc(static_cast<size_t>(width) * height, sizeof(uint16_t)));
+	}
 
-	if (!gm2 || !wt || !mr || !mg || !mb || !Qadd) {
+	if (!gm2 || !wt || !mr || !mg || !mb || (dib && !Qadd)) {
 		if (gm2)	free(gm2);
 		if (wt)	free(wt);
 		if (mr)	free(mr);
@@ -91,65 +95,89 @@ WuQuantizer::~WuQuantizer() {
 // element 0 is for base or marginal value
 // NB: these must start out 0!
 
-// Build 3-D color histogram of counts, r/g/b, c^2
+// Partial histogram of a band of rows, the sums of squares are exact
+struct WuBandHistogram {
+	std::vector<int64_t> wt, mr, mg, mb;
+	std::vector<uint64_t> m2;
+
+	WuBandHistogram() : wt(SIZE_3D), mr(SIZE_3D), mg(SIZE_3D), mb(SIZE_3D), m2(SIZE_3D) {}
+};
+
+// Add the pixels of a 24-bit or 32-bit image to the 3-D color histogram of counts, r/g/b, c^2
+// and store the histogram cell of every pixel in qadd, if not NULL
+// The rows are split into one band per thread, the band histograms are merged at the end
 void 
-WuQuantizer::Hist3D(int32_t *vwt, int32_t *vmr, int32_t *vmg, int32_t *vmb, float *m2, int ReserveSize, FIRGBA8 *ReservePalette) {
-	int ind = 0;
-	int inr, ing, inb, table[256];
+WuQuantizer::Hist3D(FIBITMAP *dib, uint16_t *qadd_bits, int64_t *vwt, int64_t *vmr, int64_t *vmg, int64_t *vmb, double *m2) {
+	int table[256];
 	int i;
-	unsigned y, x;
 
 	for (i = 0; i < 256; i++)
 		table[i] = i * i;
 
-	if (FreeImage_GetBPP(m_dib) == 24) {
-		size_t rowOffset = 0;
-		for (y = 0; y < height; y++) {
-			uint8_t *bits = FreeImage_GetScanLine(m_dib, y);
-
-			for (x = 0; x < width; x++)	{
-				inr = (bits[FI_RGBA_RED] >> 3) + 1;
-				ing = (bits[FI_RGBA_GREEN] >> 3) + 1;
-				inb = (bits[FI_RGBA_BLUE] >> 3) + 1;
-				ind = INDEX(inr, ing, inb);
-				Qadd[rowOffset + x] = (uint16_t)ind;
-				// [inr][ing][inb]
-				vwt[ind]++;
-				vmr[ind] += bits[FI_RGBA_RED];
-				vmg[ind] += bits[FI_RGBA_GREEN];
-				vmb[ind] += bits[FI_RGBA_BLUE];
-				m2[ind] += (float)(table[bits[FI_RGBA_RED]] + table[bits[FI_RGBA_GREEN]] + table[bits[FI_RGBA_BLUE]]);
-				bits += 3;
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+	const unsigned bytespp = FreeImage_GetBPP(dib) / 8;
+	const size_t pixel_count = static_cast<size_t>(width) * height;
+	// bands of at least 64K pixels, so that merging the histograms stays cheap
+	const unsigned band_count = (unsigned)std::max<size_t>(1, std::min<size_t>({ GetParallelThreadCount(), height, pixel_count / (64 * 1024) }));
+	std::vector<WuBandHistogram> bands(band_count);
+
+	ParallelForRows(band_count, pixel_count * bytespp / band_count, [&](unsigned first_band, unsigned end_band) {
+		for (unsigned band = first_band; band < end_band; band++) {
+			WuBandHistogram& hist = bands[band];
+			const unsigned first_row = (unsigned)(static_cast<size_t>(height) * band / band_count);
+			const unsigned end_row = (unsigned)(static_cast<size_t>(height) * (band + 1) / band_count);
+			for (unsigned y = first_row; y < end_row; y++) {
+				const uint8_t *bits = FreeImage_GetScanLine(dib, y);
+				uint16_t *qadd = qadd_bits ? qadd_bits + static_cast<size_t>(y) * width : nullptr;
+
+				for (unsigned x = 0; x < width; x++) {
+					const int r = bits[FI_RGBA_RED];
+					const int g = bits[FI_RGBA_GREEN];
+					const int b = bits[FI_RGBA_BLUE];
+					const int cell_r = (r >> 3) + 1;
+					const int cell_g = (g >> 3) + 1;
+					const int cell_b = (b >> 3) + 1;
+					const int index = INDEX(cell_r, cell_g, cell_b);
+					if (qadd) {
+						qadd[x] = (uint16_t)index;
+					}
+					// [inr][ing][inb]
+					hist.wt[index]++;
+					hist.mr[index] += r;
+					hist.mg[index] += g;
+					hist.mb[index] += b;
+					hist.m2[index] += table[r] + table[g] + table[b];
+					bits += bytespp;
+				}
 			}
-			rowOffset += width;
 		}
-	} else {
-		size_t rowOffset = 0;
-		for (y = 0; y < height; y++) {
-			uint8_t *bits = FreeImage_GetScanLine(m_dib, y);
-
-			for (x = 0; x < width; x++)	{
-				inr = (bits[FI_RGBA_RED] >> 3) + 1;
-				ing = (bits[FI_RGBA_GREEN] >> 3) + 1;
-				inb = (bits[FI_RGBA_BLUE] >> 3) + 1;
-				ind = INDEX(inr, ing, inb);
-				Qadd[rowOffset + x] = (uint16_t)ind;
-				// [inr][ing][inb]
-				vwt[ind]++;
-				vmr[ind] += bits[FI_RGBA_RED];
-				vmg[ind] += bits[FI_RGBA_GREEN];
-				vmb[ind] += bits[FI_RGBA_BLUE];
-				m2[ind] += (float)(table[bits[FI_RGBA_RED]] + table[bits[FI_RGBA_GREEN]] + table[bits[FI_RGBA_BLUE]]);
-				bits += 4;
-			}
-			rowOffset += width;
+	});
+
+	for (i = 0; i < SIZE_3D; i++) {
+		uint64_t sum2 = 0;
+		for (const auto& hist : bands) {
+			vwt[i] += hist.wt[i];
+			vmr[i] += hist.mr[i];
+			vmg[i] += hist.mg[i];
+			vmb[i] += hist.mb[i];
+			sum2 += hist.m2[i];
 		}
+		m2[i] += (double)sum2;
 	}
+}
+
+// Give the reserved colors a weight larger than any histogram cell, so that they get their own box
+void
+WuQuantizer::Reserve3D(int ReserveSize, FIRGBA8 *ReservePalette) {
+	int ind = 0;
+	int inr, ing, inb;
+	int i;
 
 	if (ReserveSize > 0) {
-		int max = 0;
+		int64_t max = 0;
 		for (i = 0; i < SIZE_3D; i++) {
-			if (vwt[i] > max) max = vwt[i];
+			if (wt[i] > max) max = wt[i];
 		}
 		max++;
 		for (i = 0; i < ReserveSize; i++) {
@@ -161,7 +189,7 @@ WuQuantizer::Hist3D(int32_t *vwt, int32_t *vmr, int32_t *vmg, int32_t *vmb, floa
 			mr[ind] = max * ReservePalette[i].red;
 			mg[ind] = max * ReservePalette[i].green;
 			mb[ind] = max * ReservePalette[i].blue;
-			gm2[ind] = (float)max * (float)(table[ReservePalette[i].red] + table[ReservePalette[i].green] + table[ReservePalette[i].blue]);
+			gm2[ind] = (double)max * (double)(ReservePalette[i].red * ReservePalette[i].red + ReservePalette[i].green * ReservePalette[i].green + ReservePalette[i].blue * ReservePalette[i].blue);
 		}
 	}
 }
@@ -180,12 +208,12 @@ WuQuantizer::Hist3D(int32_t *vwt, int32_t *vmr, int32_t *vmg, int32_t *vmb, floa
 
 // Compute cumulative moments
 void 
-WuQuantizer::M3D(int32_t *vwt, int32_t *vmr, int32_t *vmg, int32_t *vmb, float *m2) {
+WuQuantizer::M3D(int64_t *vwt, int64_t *vmr, int64_t *vmg, int64_t *vmb, double *m2) {
 	unsigned ind1, ind2;
 	uint8_t i, r, g, b;
-	int32_t line, line_r, line_g, line_b;
-	int32_t area[33], area_r[33], area_g[33], area_b[33];
-	float line2, area2[33];
+	int64_t line, line_r, line_g, line_b;
+	int64_t area[33], area_r[33], area_g[33], area_b[33];
+	double line2, area2[33];
 
     for (r = 1; r <= 32; r++) {
 		for (i = 0; i <= 32; i++) {
@@ -219,8 +247,8 @@ WuQuantizer::M3D(int32_t *vwt, int32_t *vmr, int32_t *vmg, int32_t *vmb, float *
 }
 
 // Compute sum over a box of any given statistic
-int32_t 
-WuQuantizer::Vol( Box *cube, int32_t *mmt ) {
+int64_t 
+WuQuantizer::Vol( Box *cube, int64_t *mmt ) {
     return( mmt[INDEX(cube->r1, cube->g1, cube->b1)] 
 		  - mmt[INDEX(cube->r1, cube->g1, cube->b0)]
 		  - mmt[INDEX(cube->r1, cube->g0, cube->b1)]
@@ -240,8 +268,8 @@ WuQuantizer::Vol( Box *cube, int32_t *mmt ) {
 // Compute part of Vol(cube, mmt) that doesn't depend on r1, g1, or b1
 // (depending on dir)
 
-int32_t 
-WuQuantizer::Bottom(Box *cube, uint8_t dir, int32_t *mmt) {
+int64_t 
+WuQuantizer::Bottom(Box *cube, uint8_t dir, int64_t *mmt) {
     switch (dir)
 	{
 		case FI_RGBA_RED:
@@ -271,8 +299,8 @@ WuQuantizer::Bottom(Box *cube, uint8_t dir, int32_t *mmt) {
 // Compute remainder of Vol(cube, mmt), substituting pos for
 // r1, g1, or b1 (depending on dir)
 
-int32_t 
-WuQuantizer::Top(Box *cube, uint8_t dir, int pos, int32_t *mmt) {
+int64_t 
+WuQuantizer::Top(Box *cube, uint8_t dir, int pos, int64_t *mmt) {
     switch (dir)
 	{
 		case FI_RGBA_RED:
@@ -303,10 +331,10 @@ WuQuantizer::Top(Box *cube, uint8_t dir, int pos, int32_t *mmt) {
 
 float
 WuQuantizer::Var(Box *cube) {
-    float dr = (float) Vol(cube, mr); 
-    float dg = (float) Vol(cube, mg); 
-    float db = (float) Vol(cube, mb);
-    float xx =  gm2[INDEX(cube->r1, cube->g1, cube->b1)] 
+    double dr = (double) Vol(cube, mr); 
+    double dg = (double) Vol(cube, mg); 
+    double db = (double) Vol(cube, mb);
+    double xx =  gm2[INDEX(cube->r1, cube->g1, cube->b1)] 
 			-gm2[INDEX(cube->r1, cube->g1, cube->b0)]
 			 -gm2[INDEX(cube->r1, cube->g0, cube->b1)]
 			 +gm2[INDEX(cube->r1, cube->g0, cube->b0)]
@@ -315,7 +343,7 @@ WuQuantizer::Var(Box *cube) {
 			 +gm2[INDEX(cube->r0, cube->g0, cube->b1)]
 			 -gm2[INDEX(cube->r0, cube->g0, cube->b0)];
 
-    return (xx - (dr*dr+dg*dg+db*db)/(float)Vol(cube,wt));    
+    return (float)(xx - (dr*dr+dg*dg+db*db)/(double)Vol(cube,wt));    
 }
 
 // We want to minimize the sum of the variances of two subboxes.
@@ -325,15 +353,15 @@ WuQuantizer::Var(Box *cube) {
 // so we drop the minus sign and MAXIMIZE the sum of the two terms.
 
 float
-WuQuantizer::Maximize(Box *cube, uint8_t dir, int first, int last , int *cut, int32_t whole_r, int32_t whole_g, int32_t whole_b, int32_t whole_w) {
-	int32_t half_r, half_g, half_b, half_w;
+WuQuantizer::Maximize(Box *cube, uint8_t dir, int first, int last , int *cut, int64_t whole_r, int64_t whole_g, int64_t whole_b, int64_t whole_w) {
+	int64_t half_r, half_g, half_b, half_w;
 	int i;
 	float temp;
 
-    int32_t base_r = Bottom(cube, dir, mr);
-    int32_t base_g = Bottom(cube, dir, mg);
-    int32_t base_b = Bottom(cube, dir, mb);
-    int32_t base_w = Bottom(cube, dir, wt);
+    int64_t base_r = Bottom(cube, dir, mr);
+    int64_t base_g = Bottom(cube, dir, mg);
+    int64_t base_b = Bottom(cube, dir, mb);
+    int64_t base_w = Bottom(cube, dir, wt);
 
     float max = 0.0;
 
@@ -350,7 +378,7 @@ WuQuantizer::Maximize(Box *cube, uint8_t dir, int first, int last , int *cut, in
 		if (half_w == 0) {		// subbox could be empty of pixels!
 			continue;			// never split into an empty box
 		} else {
-			temp = ((float)half_r*half_r + (float)half_g*half_g + (float)half_b*half_b)/half_w;
+			temp = (float)(((double)half_r*half_r + (double)half_g*half_g + (double)half_b*half_b)/half_w);
 		}
 
 		half_r = whole_r - half_r;
@@ -361,7 +389,7 @@ WuQuantizer::Maximize(Box *cube, uint8_t dir, int first, int last , int *cut, in
         if (half_w == 0) {		// subbox could be empty of pixels!
 			continue;			// never split into an empty box
 		} else {
-			temp += ((float)half_r*half_r + (float)half_g*half_g + (float)half_b*half_b)/half_w;
+			temp += (float)(((double)half_r*half_r + (double)half_g*half_g + (double)half_b*half_b)/half_w);
 		}
 
     	if (temp > max) {
@@ -378,10 +406,10 @@ WuQuantizer::Cut(Box *set1, Box *set2) {
 	uint8_t dir;
 	int cutr, cutg, cutb;
 
-    int32_t whole_r = Vol(set1, mr);
-    int32_t whole_g = Vol(set1, mg);
-    int32_t whole_b = Vol(set1, mb);
-    int32_t whole_w = Vol(set1, wt);
+    int64_t whole_r = Vol(set1, mr);
+    int64_t whole_g = Vol(set1, mg);
+    int64_t whole_b = Vol(set1, mb);
+    int64_t whole_w = Vol(set1, wt);
 
     float maxr = Maximize(set1, FI_RGBA_RED, set1->r0+1, set1->r1, &cutr, whole_r, whole_g, whole_b, whole_w);    
 	float maxg = Maximize(set1, FI_RGBA_GREEN, set1->g0+1, set1->g1, &cutg, whole_r, whole_g, whole_b, whole_w);    
@@ -441,6 +469,67 @@ WuQuantizer::Mark(Box *cube, int label, uint8_t *tag) {
 	}
 }
 
+// Greedy partition of the color space into at most PaletteSize boxes
+// Returns the number of boxes
+int
+WuQuantizer::Partition(Box *cube, int PaletteSize) {
+	int	next;
+	int i;
+	int k;
+	float vv[MAXCOLOR], temp;
+
+	cube[0].r0 = cube[0].g0 = cube[0].b0 = 0;
+	cube[0].r1 = cube[0].g1 = cube[0].b1 = 32;
+	next = 0;
+
+	for (i = 1; i < PaletteSize; i++) {
+		if (Cut(&cube[next], &cube[i])) {
+			// volume test ensures we won't try to cut one-cell box
+			vv[next] = (cube[next].vol > 1) ? Var(&cube[next]) : 0;
+			vv[i] = (cube[i].vol > 1) ? Var(&cube[i]) : 0;
+		} else {
+			  vv[next] = 0.0;   // don't try to split this box again
+			  i--;              // didn't create box i
+		}
+
+		next = 0; temp = vv[0];
+
+		for (k = 1; k <= i; k++) {
+			if (vv[k] > temp) {
+				temp = vv[k]; next = k;
+			}
+		}
+
+		if (temp <= 0.0) {
+			  PaletteSize = i + 1;
+
+			  // Error: "Only got 'PaletteSize' boxes"
+
+			  break;
+		}
+	}
+
+	return PaletteSize;
+}
+
+// Palette of the mean color of each box
+void
+WuQuantizer::BuildPalette(Box *cube, int PaletteSize, FIRGBA8 *new_pal) {
+	for (int k = 0; k < PaletteSize ; k++) {
+		const int64_t weight = Vol(&cube[k], wt);
+
+		if (weight) {
+			new_pal[k].red	= (uint8_t)(((double)Vol(&cube[k], mr) / (double)weight) + 0.5);
+			new_pal[k].green = (uint8_t)(((double)Vol(&cube[k], mg) / (double)weight) + 0.5);
+			new_pal[k].blue	= (uint8_t)(((double)Vol(&cube[k], mb) / (double)weight) + 0.5);
+		} else {
+			// Error: bogus box 'k'
+
+			new_pal[k].red = new_pal[k].green = new_pal[k].blue = 0;		
+		}
+	}
+}
+
 // Wu Quantization algorithm
 FIBITMAP *
 WuQuantizer::Quantize(int PaletteSize, int ReserveSize, FIRGBA8 *ReservePalette) {
@@ -448,49 +537,17 @@ WuQuantizer::Quantize(int PaletteSize, int ReserveSize, FIRGBA8 *ReservePalette)
 
 	try {
 		Box	cube[MAXCOLOR];
-		int	next;
-		int32_t i, weight;
-		int k;
-		float vv[MAXCOLOR], temp;
 		
 		// Compute 3D histogram
 
-		Hist3D(wt, mr, mg, mb, gm2, ReserveSize, ReservePalette);
+		Hist3D(m_dib, Qadd, wt, mr, mg, mb, gm2);
+		Reserve3D(ReserveSize, ReservePalette);
 
 		// Compute moments
 
 		M3D(wt, mr, mg, mb, gm2);
 
-		cube[0].r0 = cube[0].g0 = cube[0].b0 = 0;
-		cube[0].r1 = cube[0].g1 = cube[0].b1 = 32;
-		next = 0;
-
-		for (i = 1; i < PaletteSize; i++) {
-			if (Cut(&cube[next], &cube[i])) {
-				// volume test ensures we won't try to cut one-cell box
-				vv[next] = (cube[next].vol > 1) ? Var(&cube[next]) : 0;
-				vv[i] = (cube[i].vol > 1) ? Var(&cube[i]) : 0;
-			} else {
-				  vv[next] = 0.0;   // don't try to split this box again
-				  i--;              // didn't create box i
-			}
-
-			next = 0; temp = vv[0];
-
-			for (k = 1; k <= i; k++) {
-				if (vv[k] > temp) {
-					temp = vv[k]; next = k;
-				}
-			}
-
-			if (temp <= 0.0) {
-				  PaletteSize = i + 1;
-
-				  // Error: "Only got 'PaletteSize' boxes"
-
-				  break;
-			}
-		}
+		PaletteSize = Partition(cube, PaletteSize);
 
 		// Partition done
 
@@ -510,40 +567,30 @@ WuQuantizer::Quantize(int PaletteSize, int ReserveSize, FIRGBA8 *ReservePalette)
 
 		// create an optimized palette
 
-		FIRGBA8 *new_pal = FreeImage_GetPalette(new_dib);
+		BuildPalette(cube, PaletteSize, FreeImage_GetPalette(new_dib));
 
 		tag = (uint8_t*)malloc(SIZE_3D * sizeof(uint8_t));
 		if (!tag) {
+			FreeImage_Unload(new_dib);
 			throw FI_MSG_ERROR_MEMORY;
 		}
 		memset(tag, 0, SIZE_3D * sizeof(uint8_t));
 
-		for (k = 0; k < PaletteSize ; k++) {
+		for (int k = 0; k < PaletteSize ; k++) {
 			Mark(&cube[k], k, tag);
-			weight = Vol(&cube[k], wt);
-
-			if (weight) {
-				new_pal[k].red	= (uint8_t)(((float)Vol(&cube[k], mr) / (float)weight) + 0.5f);
-				new_pal[k].green = (uint8_t)(((float)Vol(&cube[k], mg) / (float)weight) + 0.5f);
-				new_pal[k].blue	= (uint8_t)(((float)Vol(&cube[k], mb) / (float)weight) + 0.5f);
-			} else {
-				// Error: bogus box 'k'
-
-				new_pal[k].red = new_pal[k].green = new_pal[k].blue = 0;		
-			}
 		}
 
-		int npitch = FreeImage_GetPitch(new_dib);
+		// tag is the inverse colormap of the histogram cells
+		ParallelForRows(height, width, [&](unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				uint8_t *new_bits = FreeImage_GetScanLine(new_dib, y);
+				const uint16_t *qadd = Qadd + static_cast<size_t>(y) * width;
 
-		size_t rowOffset = 0;
-		for (unsigned y = 0; y < height; y++) {
-			uint8_t *new_bits = FreeImage_GetBits(new_dib) + (y * npitch);
-
-			for (unsigned x = 0; x < width; x++) {
-				new_bits[x] = tag[Qadd[rowOffset + x]];
+				for (unsigned x = 0; x < width; x++) {
+					new_bits[x] = tag[qadd[x]];
+				}
 			}
-			rowOffset += width;
-		}
+		});
 
 		// output 'new_pal' as color look-up table contents,
 		// 'new_bits' as the quantized image (array of table addresses).
@@ -557,3 +604,26 @@ WuQuantizer::Quantize(int PaletteSize, int ReserveSize, FIRGBA8 *ReservePalette)
 
 	return nullptr;
 }
+
+// Compute the palette of a set of images, without mapping their pixels
+// Returns the number of colors of the palette, 0 if an error occured
+int
+WuQuantizer::ComputePalette(FIBITMAP **dibs, int count, int PaletteSize, int ReserveSize, FIRGBA8 *ReservePalette, FIRGBA8 *palette) {
+	try {
+		Box	cube[MAXCOLOR];
+
+		for (int i = 0; i < count; i++) {
+			Hist3D(dibs[i], nullptr, wt, mr, mg, mb, gm2);
+		}
+		Reserve3D(ReserveSize, ReservePalette);
+
+		M3D(wt, mr, mg, mb, gm2);
+
+		PaletteSize = Partition(cube, PaletteSize);
+		BuildPalette(cube, PaletteSize, palette);
+		return PaletteSize;
+	} catch(...) {
+	}
+
+	return 0;
+}
@@ -23,7 +23,11 @@
 #include "FreeImage.h"
 #include "Utilities.h"
 #include "ToneMapping.h"
+#include "SimpleTools.h"
+#include "SimdFloat4.h"
+#include "ConversionDither.h"
 #include <algorithm>
+#include <vector>
 
 // ----------------------------------------------------------
 // Convert RGB to and from Yxy, same as in Reinhard et al. SIGGRAPH 2002
@@ -123,6 +127,147 @@ static const float XYZ2RGB[3][3] = {
 static const float EPSILON = 1e-06F;
 static const float INF = 1e+10F;
 
+// ----------------------------------------------------------
+//  Row functions
+// ----------------------------------------------------------
+
+void
+SplitRGBFRow(const FIRGBF *src, unsigned width, float *r, float *g, float *b) {
+	for (unsigned x = 0; x < width; x++) {
+		r[x] = src[x].red;
+		g[x] = src[x].green;
+		b[x] = src[x].blue;
+	}
+}
+
+void
+MergeRGBFRow(const float *r, const float *g, const float *b, unsigned width, FIRGBF *dst) {
+	for (unsigned x = 0; x < width; x++) {
+		dst[x].red = r[x];
+		dst[x].green = g[x];
+		dst[x].blue = b[x];
+	}
+}
+
+void
+ConvertRowRGBFToYxy(float *r, float *g, float *b, unsigned width) {
+	const Float4 zero = Float4::Set(0);
+	for (unsigned x = 0; x < width; x += 4) {
+		const Float4 R = Float4::Load(r + x), G = Float4::Load(g + x), B = Float4::Load(b + x);
+		const Float4 X = Float4::Set(RGB2XYZ[0][0]) * R + Float4::Set(RGB2XYZ[0][1]) * G + Float4::Set(RGB2XYZ[0][2]) * B;
+		const Float4 Y = Float4::Set(RGB2XYZ[1][0]) * R + Float4::Set(RGB2XYZ[1][1]) * G + Float4::Set(RGB2XYZ[1][2]) * B;
+		const Float4 Z = Float4::Set(RGB2XYZ[2][0]) * R + Float4::Set(RGB2XYZ[2][1]) * G + Float4::Set(RGB2XYZ[2][2]) * B;
+		const Float4 W = X + Y + Z;
+		const Float4::Mask positive = W > zero;
+		// the division of the non positive lanes is discarded
+		const Float4 safe_W = Select(positive, W, Float4::Set(1));
+		Select(positive, Y, zero).Store(r + x);				// Y
+		Select(positive, X / safe_W, zero).Store(g + x);	// x
+		Select(positive, Y / safe_W, zero).Store(b + x);	// y
+	}
+}
+
+void
+ConvertRowYxyToRGBF(float *Y, float *x, float *y, unsigned width) {
+	const Float4 epsilon = Float4::Set(EPSILON);
+	const Float4 one = Float4::Set(1);
+	for (unsigned i = 0; i < width; i += 4) {
+		const Float4 Yv = Float4::Load(Y + i), xv = Float4::Load(x + i), yv = Float4::Load(y + i);
+		// (Y > EPSILON) && (x > EPSILON) && (y > EPSILON), as the minimum of the three values
+		const Float4::Mask valid = Min(Yv, Min(xv, yv)) > epsilon;
+		const Float4 safe_x = Select(valid, xv, one);
+		const Float4 safe_y = Select(valid, yv, one);
+		const Float4 X = Select(valid, (safe_x * Yv) / safe_y, epsilon);
+		const Float4 Z = Select(valid, (X / safe_x) - X - Yv, epsilon);
+		const Float4 YY = Yv;
+		(Float4::Set(XYZ2RGB[0][0]) * X + Float4::Set(XYZ2RGB[0][1]) * YY + Float4::Set(XYZ2RGB[0][2]) * Z).Store(Y + i);	// R
+		(Float4::Set(XYZ2RGB[1][0]) * X + Float4::Set(XYZ2RGB[1][1]) * YY + Float4::Set(XYZ2RGB[1][2]) * Z).Store(x + i);	// G
+		(Float4::Set(XYZ2RGB[2][0]) * X + Float4::Set(XYZ2RGB[2][1]) * YY + Float4::Set(XYZ2RGB[2][2]) * Z).Store(y + i);	// B
+	}
+}
+
+void
+ConvertRowRGBFToY(const float *r, const float *g, const float *b, unsigned width, float *Y) {
+	const Float4 zero = Float4::Set(0);
+	for (unsigned x = 0; x < width; x += 4) {
+		const Float4 L = Float4::Set(0.2126F) * Float4::Load(r + x) + Float4::Set(0.7152F) * Float4::Load(g + x) + Float4::Set(0.0722F) * Float4::Load(b + x);
+		// (L > 0) ? L : 0, NaN included
+		Select(L > zero, L, zero).Store(Y + x);
+	}
+}
+
+void
+ConvertRowRGBFTo24(const float *r, const float *g, const float *b, unsigned width, uint8_t *dst, const float *thresholds) {
+	alignas(16) float rgb[3][4];
+	const Float4 zero = Float4::Set(0);
+	const Float4 scale = Float4::Set(255.F);
+	const float half[4] = { 0.5F, 0.5F, 0.5F, 0.5F };
+	for (unsigned x = 0; x < width; x += 4) {
+		// lanes are clamped to [0, 1] (NaN goes to 0), then rounded or dithered
+		const Float4 offset = Float4::Load(thresholds ? thresholds + (x % 16) : half);
+		(Min(Max(Float4::Load(r + x), zero), Float4::Set(1)) * scale + offset).Store(rgb[0]);
+		(Min(Max(Float4::Load(g + x), zero), Float4::Set(1)) * scale + offset).Store(rgb[1]);
+		(Min(Max(Float4::Load(b + x), zero), Float4::Set(1)) * scale + offset).Store(rgb[2]);
+		const unsigned count = std::min(4U, width - x);
+		for (unsigned i = 0; i < count; i++) {
+			dst[FI_RGBA_RED]   = (uint8_t)rgb[0][i];
+			dst[FI_RGBA_GREEN] = (uint8_t)rgb[1][i];
+			dst[FI_RGBA_BLUE]  = (uint8_t)rgb[2][i];
+			dst += 3;
+		}
+	}
+}
+
+void
+LuminanceStats::Accumulate(const float *Y, unsigned width) {
+	const unsigned quad_width = width & ~3U;
+	const Float4 contrast = Float4::Set(2.3e-5F);
+	const Float4 zero = Float4::Set(0);
+	Float4 max_lum = Float4::Set(maxLum), min_lum = Float4::Set(minLum);
+	Float4 sum = Float4::Set(0), sum_log = Float4::Set(0);
+	for (unsigned x = 0; x < quad_width; x += 4) {
+		// avoid negative values : (Y > 0) ? Y : 0, NaN included
+		const Float4 Yv = Float4::Load(Y + x);
+		const Float4 L = Select(Yv > zero, Yv, zero);
+		max_lum = Max(max_lum, L);
+		min_lum = Min(min_lum, L);
+		sum = sum + L;
+		sum_log = sum_log + Log(contrast + L);
+	}
+	alignas(16) float lanes[4][4];
+	max_lum.Store(lanes[0]);
+	min_lum.Store(lanes[1]);
+	sum.Store(lanes[2]);
+	sum_log.Store(lanes[3]);
+	for (unsigned i = 0; i < 4; i++) {
+		maxLum = std::max(maxLum, lanes[0][i]);
+		minLum = std::min(minLum, lanes[1][i]);
+		sumLum += lanes[2][i];
+		sumLogLum += lanes[3][i];
+	}
+	for (unsigned x = quad_width; x < width; x++) {
+		const float L = (Y[x] > 0) ? Y[x] : 0;
+		maxLum = std::max(maxLum, L);
+		minLum = std::min(minLum, L);
+		sumLum += L;
+		sumLogLum += Log(Float4::Set(2.3e-5F + L)).W();
+	}
+	count += width;
+}
+
+void
+LuminanceStats::Combine(const LuminanceStats& other) {
+	maxLum = std::max(maxLum, other.maxLum);
+	minLum = std::min(minLum, other.minLum);
+	sumLum += other.sumLum;
+	sumLogLum += other.sumLogLum;
+	count += other.count;
+}
+
+// ----------------------------------------------------------
+//  Image functions
+// ----------------------------------------------------------
+
 /**
 Convert in-place floating point RGB data to Yxy.<br>
 On output, pixel->red == Y, pixel->green == x, pixel->blue == y
@@ -131,38 +276,22 @@ On output, pixel->red == Y, pixel->green == x, pixel->blue == y
 */
 FIBOOL 
 ConvertInPlaceRGBFToYxy(FIBITMAP *dib) {
-	float result[3];
-
 	if (FreeImage_GetImageType(dib) != FIT_RGBF)
 		return FALSE;
 
 	const unsigned width  = FreeImage_GetWidth(dib);
 	const unsigned height = FreeImage_GetHeight(dib);
-	const unsigned pitch  = FreeImage_GetPitch(dib);
-	
-	auto *bits = (uint8_t*)FreeImage_GetBits(dib);
-	for (unsigned y = 0; y < height; y++) {
-		auto *pixel = (FIRGBF*)bits;
-		for (unsigned x = 0; x < width; x++) {
-			result[0] = result[1] = result[2] = 0;
-			for (int i = 0; i < 3; i++) {
-				result[i] += RGB2XYZ[i][0] * pixel[x].red;
-				result[i] += RGB2XYZ[i][1] * pixel[x].green;
-				result[i] += RGB2XYZ[i][2] * pixel[x].blue;
-			}
-			const float W = result[0] + result[1] + result[2];
-			const float Y = result[1];
-			if (W > 0) { 
-				pixel[x].red   = Y;			    // Y 
-				pixel[x].green = result[0] / W;	// x 
-				pixel[x].blue  = result[1] / W;	// y 	
-			} else {
-				pixel[x].red = pixel[x].green = pixel[x].blue = 0;
-			}
+
+	ParallelForRows(height, width * sizeof(FIRGBF), [&](unsigned first_row, unsigned end_row) {
+		std::vector<float> channels(3 * PaddedWidth(width));
+		float *r = channels.data(), *g = r + PaddedWidth(width), *b = g + PaddedWidth(width);
+		for (unsigned y = first_row; y < end_row; y++) {
+			auto *pixel = (FIRGBF*)FreeImage_GetScanLine(dib, y);
+			SplitRGBFRow(pixel, width, r, g, b);
+			ConvertRowRGBFToYxy(r, g, b, width);
+			MergeRGBFRow(r, g, b, width, pixel);
 		}
-		// next line
-		bits += pitch;
-	}
+	});
 
 	return TRUE;
 }
@@ -175,45 +304,22 @@ On input, pixel->red == Y, pixel->green == x, pixel->blue == y
 */
 FIBOOL 
 ConvertInPlaceYxyToRGBF(FIBITMAP *dib) {
-	float result[3];
-	float X, Y, Z;
-
 	if (FreeImage_GetImageType(dib) != FIT_RGBF)
 		return FALSE;
 
 	const unsigned width  = FreeImage_GetWidth(dib);
 	const unsigned height = FreeImage_GetHeight(dib);
-	const unsigned pitch  = FreeImage_GetPitch(dib);
-
-	auto *bits = (uint8_t*)FreeImage_GetBits(dib);
-	for (unsigned y = 0; y < height; y++) {
-		auto *pixel = (FIRGBF*)bits;
-		for (unsigned x = 0; x < width; x++) {
-			Y = pixel[x].red;	        // Y 
-			result[1] = pixel[x].green;	// x 
-			result[2] = pixel[x].blue;	// y 
-			if ((Y > EPSILON) && (result[1] > EPSILON) && (result[2] > EPSILON)) {
-				X = (result[1] * Y) / result[2];
-				Z = (X / result[1]) - X - Y;
-			} else {
-				X = Z = EPSILON;
-			}
-			pixel[x].red   = X;
-			pixel[x].green = Y;
-			pixel[x].blue  = Z;
-			result[0] = result[1] = result[2] = 0;
-			for (int i = 0; i < 3; i++) {
-				result[i] += XYZ2RGB[i][0] * pixel[x].red;
-				result[i] += XYZ2RGB[i][1] * pixel[x].green;
-				result[i] += XYZ2RGB[i][2] * pixel[x].blue;
-			}
-			pixel[x].red   = result[0];	// R
-			pixel[x].green = result[1];	// G
-			pixel[x].blue  = result[2];	// B
+
+	ParallelForRows(height, width * sizeof(FIRGBF), [&](unsigned first_row, unsigned end_row) {
+		std::vector<float> channels(3 * PaddedWidth(width));
+		float *Y = channels.data(), *x = Y + PaddedWidth(width), *y = x + PaddedWidth(width);
+		for (unsigned row = first_row; row < end_row; row++) {
+			auto *pixel = (FIRGBF*)FreeImage_GetScanLine(dib, row);
+			SplitRGBFRow(pixel, width, Y, x, y);
+			ConvertRowYxyToRGBF(Y, x, y, width);
+			MergeRGBFRow(Y, x, y, width, pixel);
 		}
-		// next line
-		bits += pitch;
-	}
+	});
 
 	return TRUE;
 }
@@ -234,41 +340,52 @@ LuminanceFromYxy(FIBITMAP *Yxy, float *maxLum, float *minLum, float *worldLum) {
 
 	const unsigned width  = FreeImage_GetWidth(Yxy);
 	const unsigned height = FreeImage_GetHeight(Yxy);
-	const unsigned pitch  = FreeImage_GetPitch(Yxy);
-
-	float max_lum = 0, min_lum = 0;
-	double sum = 0;
-
-	auto *bits = (const uint8_t*)FreeImage_GetBits(Yxy);
-	for (unsigned y = 0; y < height; y++) {
-		auto *pixel = (const FIRGBF*)bits;
-		for (unsigned x = 0; x < width; x++) {
-			const float Y = std::max(0.F, pixel[x].red);// avoid negative values
-			max_lum = std::max(max_lum, Y);	// max Luminance in the scene
-			min_lum = std::min(min_lum, Y);	// min Luminance in the scene
-			sum += log(2.3e-5F + Y);				// contrast constant in Tumblin paper
-		}
-		// next line
-		bits += pitch;
-	}
+
+	const LuminanceStats stats = ParallelReduceRows(height, width * sizeof(FIRGBF), LuminanceStats(),
+		[&](LuminanceStats& band, unsigned first_row, unsigned end_row) {
+			std::vector<float> Y(PaddedWidth(width));
+			for (unsigned y = first_row; y < end_row; y++) {
+				auto *pixel = (const FIRGBF*)FreeImage_GetScanLine(Yxy, y);
+				for (unsigned x = 0; x < width; x++) {
+					Y[x] = std::max(0.F, pixel[x].red);	// avoid negative values
+				}
+				band.Accumulate(Y.data(), width);
+			}
+		},
+		[](LuminanceStats& value, const LuminanceStats& band) { value.Combine(band); });
+
 	// maximum luminance
-	*maxLum = max_lum;
-	// minimum luminance
-	*minLum = min_lum;
-	// average log luminance
-	double avgLogLum = (sum / (static_cast<double>(width) * height));
+	*maxLum = std::max(0.F, stats.maxLum);
+	// minimum luminance (the luminance values are not negative)
+	*minLum = 0;
 	// world adaptation luminance
-	*worldLum = (float)exp(avgLogLum);
+	*worldLum = (float)exp(stats.sumLogLum / (static_cast<double>(width) * height));
 
 	return TRUE;
 }
 
+/**
+Error diffusion of a RGBF image to a 24-bit image
+*/
+static void
+DiffuseRGBFTo24(FIBITMAP *src, FIBITMAP *dst) {
+	const unsigned width = FreeImage_GetWidth(src);
+	DitherRowsToBytes(dst, 3, FIDD_FLOYD_STEINBERG, width * sizeof(FIRGBF), [&](unsigned y, float *values) {
+		const FIRGBF *pixel = (const FIRGBF*)FreeImage_GetScanLine(src, y);
+		for (unsigned x = 0; x < width; x++, values += 3) {
+			values[FI_RGBA_RED] = 255 * pixel[x].red;
+			values[FI_RGBA_GREEN] = 255 * pixel[x].green;
+			values[FI_RGBA_BLUE] = 255 * pixel[x].blue;
+		}
+	});
+}
+
 /**
 Clamp RGBF image highest values to display white, 
-then convert to 24-bit RGB
+then convert to 24-bit RGB, rounded or dithered
 */
 FIBITMAP* 
-ClampConvertRGBFTo24(FIBITMAP *src) {
+ClampConvertRGBFTo24(FIBITMAP *src, FREE_IMAGE_DEPTH_DITHER dither) {
 	if (FreeImage_GetImageType(src) != FIT_RGBF)
 		return FALSE;
 
@@ -278,32 +395,39 @@ ClampConvertRGBFTo24(FIBITMAP *src) {
 	FIBITMAP *dst = FreeImage_Allocate(width, height, 24, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
 	if (!dst) return nullptr;
 
-	const unsigned src_pitch  = FreeImage_GetPitch(src);
-	const unsigned dst_pitch  = FreeImage_GetPitch(dst);
-
-	auto *src_bits = (const uint8_t*)FreeImage_GetBits(src);
-	auto *dst_bits = (uint8_t*)FreeImage_GetBits(dst);
-
-	for (unsigned y = 0; y < height; y++) {
-		auto *src_pixel = (const FIRGBF*)src_bits;
-		auto *dst_pixel = dst_bits;
-		for (unsigned x = 0; x < width; x++) {
-			const float red   = (src_pixel[x].red > 1)   ? 1 : src_pixel[x].red;
-			const float green = (src_pixel[x].green > 1) ? 1 : src_pixel[x].green;
-			const float blue  = (src_pixel[x].blue > 1)  ? 1 : src_pixel[x].blue;
-			
-			dst_pixel[FI_RGBA_RED]   = (uint8_t)(255.F * red   + 0.5F);
-			dst_pixel[FI_RGBA_GREEN] = (uint8_t)(255.F * green + 0.5F);
-			dst_pixel[FI_RGBA_BLUE]  = (uint8_t)(255.F * blue  + 0.5F);
-			dst_pixel += 3;
-		}
-		src_bits += src_pitch;
-		dst_bits += dst_pitch;
+	if (dither == FIDD_FLOYD_STEINBERG) {
+		DiffuseRGBFTo24(src, dst);
+		return dst;
 	}
 
+	ParallelForRows(height, width * sizeof(FIRGBF), [&](unsigned first_row, unsigned end_row) {
+		std::vector<float> channels(3 * PaddedWidth(width));
+		float *r = channels.data(), *g = r + PaddedWidth(width), *b = g + PaddedWidth(width);
+		for (unsigned y = first_row; y < end_row; y++) {
+			SplitRGBFRow((const FIRGBF*)FreeImage_GetScanLine(src, y), width, r, g, b);
+			ConvertRowRGBFTo24(r, g, b, width, FreeImage_GetScanLine(dst, y), (dither == FIDD_ORDERED) ? OrderedDitherThresholds(y) : nullptr);
+		}
+	});
+
 	return dst;
 }
 
+void
+ToneMappedRows::StoreRow(unsigned y, const float *r, const float *g, const float *b, unsigned width) const {
+	if (m_dither == FIDD_FLOYD_STEINBERG) {
+		MergeRGBFRow(r, g, b, width, (FIRGBF*)FreeImage_GetScanLine(m_rgbf, y));
+	} else {
+		ConvertRowRGBFTo24(r, g, b, width, FreeImage_GetScanLine(m_dst, y), (m_dither == FIDD_ORDERED) ? OrderedDitherThresholds(y) : nullptr);
+	}
+}
+
+void
+ToneMappedRows::Finish() const {
+	if (m_dither == FIDD_FLOYD_STEINBERG) {
+		DiffuseRGBFTo24(m_rgbf, m_dst);
+	}
+}
+
 /**
 Extract the luminance channel L from a RGBF image. 
 Luminance is calculated from the sRGB model (RGB2XYZ matrix) 
@@ -324,24 +448,15 @@ ConvertRGBFToY(FIBITMAP *src) {
 	FIBITMAP *dst = FreeImage_AllocateT(FIT_FLOAT, width, height);
 	if (!dst) return nullptr;
 
-	const unsigned src_pitch  = FreeImage_GetPitch(src);
-	const unsigned dst_pitch  = FreeImage_GetPitch(dst);
-
-	
-	auto *src_bits = (const uint8_t*)FreeImage_GetBits(src);
-	auto *dst_bits = (uint8_t*)FreeImage_GetBits(dst);
-
-	for (unsigned y = 0; y < height; y++) {
-		auto *src_pixel = (const FIRGBF*)src_bits;
-		auto *dst_pixel = (float*)dst_bits;
-		for (unsigned x = 0; x < width; x++) {
-			const float L = LUMA_REC709(src_pixel[x].red, src_pixel[x].green, src_pixel[x].blue);
-			dst_pixel[x] = (L > 0) ? L : 0;
+	ParallelForRows(height, width * sizeof(FIRGBF), [&](unsigned first_row, unsigned end_row) {
+		std::vector<float> channels(4 * PaddedWidth(width));
+		float *r = channels.data(), *g = r + PaddedWidth(width), *b = g + PaddedWidth(width), *L = b + PaddedWidth(width);
+		for (unsigned y = first_row; y < end_row; y++) {
+			SplitRGBFRow((const FIRGBF*)FreeImage_GetScanLine(src, y), width, r, g, b);
+			ConvertRowRGBFToY(r, g, b, width, L);
+			std::copy(L, L + width, (float*)FreeImage_GetScanLine(dst, y));
 		}
-		// next line
-		src_bits += src_pitch;
-		dst_bits += dst_pitch;
-	}
+	});
 
 	return dst;
 }
@@ -361,35 +476,25 @@ LuminanceFromY(FIBITMAP *dib, float *maxLum, float *minLum, float *Lav, float *L
 	if (FreeImage_GetImageType(dib) != FIT_FLOAT)
 		return FALSE;
 
-	unsigned width  = FreeImage_GetWidth(dib);
-	unsigned height = FreeImage_GetHeight(dib);
-	unsigned pitch  = FreeImage_GetPitch(dib);
-
-	float max_lum = -1e20F, min_lum = 1e20F;
-	double sumLum = 0, sumLogLum = 0;
+	const unsigned width  = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
 
-	auto *bits = (const uint8_t*)FreeImage_GetBits(dib);
-	for (unsigned y = 0; y < height; y++) {
-		auto *pixel = (const float*)bits;
-		for (unsigned x = 0; x < width; x++) {
-			const float Y = pixel[x];
-			max_lum = (max_lum < Y) ? Y : max_lum;				// max Luminance in the scene
-			min_lum = ((Y > 0) && (min_lum < Y)) ? min_lum : Y;	// min Luminance in the scene
-			sumLum += Y;										// average luminance
-			sumLogLum += log(2.3e-5F + Y);						// contrast constant in Tumblin paper
-		}
-		// next line
-		bits += pitch;
-	}
+	const LuminanceStats stats = ParallelReduceRows(height, width * sizeof(float), LuminanceStats(),
+		[&](LuminanceStats& band, unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				band.Accumulate((const float*)FreeImage_GetScanLine(dib, y), width);
+			}
+		},
+		[](LuminanceStats& value, const LuminanceStats& band) { value.Combine(band); });
 
 	// maximum luminance
-	*maxLum = max_lum;
+	*maxLum = stats.maxLum;
 	// minimum luminance
-	*minLum = min_lum;
+	*minLum = stats.minLum;
 	// average luminance
-	*Lav = (float)(sumLum / (static_cast<double>(width) * height));
+	*Lav = (float)(stats.sumLum / stats.count);
 	// average log luminance, a.k.a. world adaptation luminance
-	*Llav = (float)exp(sumLogLum / (static_cast<double>(width) * height));
+	*Llav = (float)exp(stats.sumLogLum / stats.count);
 
 	return TRUE;
 }
@@ -22,6 +22,9 @@
 #include "FreeImage.h"
 #include "Utilities.h"
 #include "ToneMapping.h"
+#include "SimpleTools.h"
+#include "SimdFloat4.h"
+#include <vector>
 
 // ----------------------------------------------------------
 // Logarithmic mapping operator
@@ -31,217 +34,95 @@
 // Eurographics 2003.
 // ----------------------------------------------------------
 
-/**
-Bias function
-*/
-static inline double 
-biasFunction(const double b, const double x) {
-	return pow (x, b);		// pow(x, log(bias)/log(0.5)
-}
-
 /**
 Pad approximation of log(x + 1)
 x(6+x)/(6+4x) good if x < 1
 x*(6 + 0.7662x)/(5.9897 + 3.7658x) between 1 and 2
 See http://www.nezumi.demon.co.uk/consult/logx.htm
 */
-static inline double 
-pade_log(const double x) {
-	if (x < 1) {
-		return (x * (6 + x) / (6 + 4 * x));
-	} else if (x < 2) {
-		return (x * (6 + 0.7662 * x) / (5.9897 + 3.7658 * x));
-	}
-	return log(x + 1);
+static inline Float4 
+pade_log(const Float4& x) {
+	const Float4 low = x * (Float4::Set(6) + x) / (Float4::Set(6) + Float4::Set(4) * x);
+	const Float4 mid = x * (Float4::Set(6) + Float4::Set(0.7662F) * x) / (Float4::Set(5.9897F) + Float4::Set(3.7658F) * x);
+	const Float4 high = Log(x + Float4::Set(1));
+	return Select(Float4::Set(1) > x, low, Select(Float4::Set(2) > x, mid, high));
 }
 
 /**
-Log mapping operator
-@param dib Input / Output Yxy image
-@param maxLum Maximum luminance
-@param avgLum Average luminance (world adaptation luminance)
-@param biasParam Bias parameter (a zero value default to 0.85)
-@param exposure Exposure parameter (default to 0)
-@return Returns TRUE if successful, returns FALSE otherwise
+Log mapping operator parameters
 */
-static FIBOOL 
-ToneMappingDrago03(FIBITMAP *dib, const float maxLum, const float avgLum, float biasParam, const float exposure) {
-	const float LOG05 = -0.693147F;	// log(0.5) 
-
-	double Lmax, divider, interpol, biasP;
-	unsigned x, y;
-	double L;
-
-	if (FreeImage_GetImageType(dib) != FIT_RGBF)
-		return FALSE;
-
-	const unsigned width  = FreeImage_GetWidth(dib);
-	const unsigned height = FreeImage_GetHeight(dib);
-	const unsigned pitch  = FreeImage_GetPitch(dib);
-
-
-	// arbitrary Bias Parameter 
-	if (biasParam == 0) 
-		biasParam = 0.85F;
-
-	// normalize maximum luminance by average luminance
-	Lmax = maxLum / avgLum;
-	
-	divider = log10(Lmax+1);
-	biasP = log(biasParam)/LOG05;
-
-#if !defined(DRAGO03_FAST)
+struct Drago03 {
+	float scale;	// exposure / average luminance
+	float Lmax;		// maximum luminance normalized by average luminance
+	float divider;	// log10(Lmax + 1)
+	float biasP;	// log(bias) / log(0.5)
 
 	/**
-	Normal tone mapping of every pixel
-	further acceleration is obtained by a Pad approximation of log(x + 1)
+	@param maxLum Maximum luminance
+	@param avgLum Average luminance (world adaptation luminance)
+	@param biasParam Bias parameter (a zero value default to 0.85)
+	@param exposure Exposure parameter (default to 0)
 	*/
-	auto *bits = (uint8_t*)FreeImage_GetBits(dib);
-	for (y = 0; y < height; y++) {
-		auto *pixel = (FIRGBF*)bits;
-		for (x = 0; x < width; x++) {
-			double Yw = pixel[x].red / avgLum;
-			Yw *= exposure;
-			interpol = log(2 + biasFunction(biasP, Yw / Lmax) * 8);
-			L = pade_log(Yw);// log(Yw + 1)
-			pixel[x].red = (float)((L / interpol) / divider);
-		}
-		// next line
-		bits += pitch;
+	Drago03(float maxLum, float avgLum, float biasParam, float exposure) {
+		const double LOG05 = -0.693147;	// log(0.5) 
+
+		// arbitrary Bias Parameter 
+		if (biasParam == 0) 
+			biasParam = 0.85F;
+
+		// normalize maximum luminance by average luminance
+		scale = exposure / avgLum;
+		Lmax = maxLum / avgLum;
+		divider = (float)log10(Lmax + 1);
+		biasP = (float)(log(biasParam) / LOG05);
 	}
 
-#else
-	unsigned index;
-	int i, j;
-
-	unsigned max_width  = width - (width % 3);
-	unsigned max_height = height - (height % 3); 
-	unsigned fpitch = pitch / sizeof(FIRGBF);
-
 	/**
-	fast tone mapping
-	split the image into 3x3 pixel tiles and perform the computation for each group of 9 pixels
+	Map the luminance of a row, in place
 	further acceleration is obtained by a Pad approximation of log(x + 1)
-	=> produce artifacts and not so faster, so the code has been disabled
-	*/
-#define PIXEL(x, y)	image[y*fpitch + x].red
-
-	FIRGBF *image = (FIRGBF*)FreeImage_GetBits(dib);
-	for (y = 0; y < max_height; y += 3) {
-		for (x = 0; x < max_width; x += 3) {
-			double average = 0;
-			for (i = 0; i < 3; i++) {
-				for (j = 0; j < 3; j++) {
-					index = (y + i)*fpitch + (x + j);
-					image[index].red /= (float)avgLum;
-					image[index].red *= exposure; 
-					average += image[index].red;
-				}
-			}
-			average = average / 9 - PIXEL(x, y);
-			if (average > -1 && average < 1) {
-				interpol = log(2 + pow(PIXEL(x + 1, y + 1) / Lmax, biasP) * 8);
-				for (i = 0; i < 3; i++) {
-					for (j = 0; j < 3; j++) {
-						index = (y + i)*fpitch + (x + j);
-						L = pade_log(image[index].red);// log(image[index].red + 1)
-						image[index].red = (float)((L / interpol) / divider);
-					}
-				}
-			}
-			else {
-				for (i = 0; i < 3; i++) {
-					for (j = 0; j < 3; j++) {
-						index = (y + i)*fpitch + (x + j);
-						interpol = log(2 + pow(image[index].red / Lmax, biasP) * 8);
-						L = pade_log(image[index].red);// log(image[index].red + 1)
-						image[index].red = (float)((L / interpol) / divider);
-					}
-				}
-			}
-		} //x
-	} // y
-
-	/**
-	Normal tone mapping of every pixel for the remaining right and bottom bands
 	*/
-	uint8_t *bits;
-
-	// right band
-	bits = (uint8_t*)FreeImage_GetBits(dib);
-	for (y = 0; y < height; y++) {
-		FIRGBF *pixel = (FIRGBF*)bits;
-		for (x = max_width; x < width; x++) {
-			double Yw = pixel[x].red / avgLum;
-			Yw *= exposure;
-			interpol = log(2 + biasFunction(biasP, Yw / Lmax) * 8);
-			L = pade_log(Yw);// log(Yw + 1)
-			pixel[x].red = (float)((L / interpol) / divider);
-		}
-		// next line
-		bits += pitch;
-	}
-	// bottom band
-	bits = (uint8_t*)FreeImage_GetBits(dib);
-	for (y = max_height; y < height; y++) {
-		FIRGBF *pixel = (FIRGBF*)bits;
-		for (x = 0; x < max_width; x++) {
-			double Yw = pixel[x].red / avgLum;
-			Yw *= exposure;
-			interpol = log(2 + biasFunction(biasP, Yw / Lmax) * 8);
-			L = pade_log(Yw);// log(Yw + 1)
-			pixel[x].red = (float)((L / interpol) / divider);
+	void MapRow(float *Y, unsigned width) const {
+		for (unsigned x = 0; x < width; x += 4) {
+			const Float4 Yw = Float4::Load(Y + x) * Float4::Set(scale);
+			// bias function : pow(x, log(bias)/log(0.5))
+			const Float4 interpol = Log(Float4::Set(2) + Pow(Yw / Float4::Set(Lmax), Float4::Set(biasP)) * Float4::Set(8));
+			const Float4 L = pade_log(Yw);// log(Yw + 1)
+			((L / interpol) / Float4::Set(divider)).Store(Y + x);
 		}
-		// next line
-		bits += pitch;
 	}
-
-#endif	// DRAGO03_FAST
-
-	return TRUE;
-}
+};
 
 /**
 Custom gamma correction based on the ITU-R BT.709 standard
-@param dib RGBF image to be corrected
-@param gammaval Gamma value (2.2 is a good default value)
-@return Returns TRUE if successful, returns FALSE otherwise
 */
-static FIBOOL 
-REC709GammaCorrection(FIBITMAP *dib, const float gammaval) {
-	if (FreeImage_GetImageType(dib) != FIT_RGBF)
-		return FALSE;
-
+struct REC709Gamma {
 	float slope = 4.5F;
 	float start = 0.018F;
-	
-	const float fgamma = (float)((0.45 / gammaval) * 2);
-	if (gammaval >= 2.1F) {
-		start = (float)(0.018 / ((gammaval - 2) * 7.5));
-		slope = (float)(4.5 * ((gammaval - 2) * 7.5));
-	} else if (gammaval <= 1.9F) {
-		start = (float)(0.018 * ((2 - gammaval) * 7.5));
-		slope = (float)(4.5 / ((2 - gammaval) * 7.5));
-	}
-
-	const unsigned width  = FreeImage_GetWidth(dib);
-	const unsigned height = FreeImage_GetHeight(dib);
-	const unsigned pitch  = FreeImage_GetPitch(dib);
+	float fgamma;
 
-	auto *bits = (uint8_t*)FreeImage_GetBits(dib);
-	for (unsigned y = 0; y < height; y++) {
-		auto *pixel = (float*)bits;
-		for (unsigned x = 0; x < width; x++) {
-			for (int i = 0; i < 3; i++) {
-				*pixel = (*pixel <= start) ? *pixel * slope : (1.099F * pow(*pixel, fgamma) - 0.099F);
-				pixel++;
-			}
+	/**
+	@param gammaval Gamma value (2.2 is a good default value)
+	*/
+	explicit REC709Gamma(float gammaval) {
+		fgamma = (float)((0.45 / gammaval) * 2);
+		if (gammaval >= 2.1F) {
+			start = (float)(0.018 / ((gammaval - 2) * 7.5));
+			slope = (float)(4.5 * ((gammaval - 2) * 7.5));
+		} else if (gammaval <= 1.9F) {
+			start = (float)(0.018 * ((2 - gammaval) * 7.5));
+			slope = (float)(4.5 / ((2 - gammaval) * 7.5));
 		}
-		bits += pitch;
 	}
 
-	return TRUE;
-}
+	/** Correct a row channel, in place */
+	void CorrectRow(float *channel, unsigned width) const {
+		for (unsigned x = 0; x < width; x += 4) {
+			const Float4 v = Float4::Load(channel + x);
+			const Float4 curve = Float4::Set(1.099F) * Pow(v, Float4::Set(fgamma)) - Float4::Set(0.099F);
+			Select(v <= Float4::Set(start), v * Float4::Set(slope), curve).Store(channel + x);
+		}
+	}
+};
 
 // ----------------------------------------------------------
 //  Main algorithm
@@ -252,36 +133,68 @@ Apply the Adaptive Logarithmic Mapping operator to a HDR image and convert to 24
 @param src Input RGB16 or RGB[A]F image
 @param gamma Gamma correction (gamma > 0). 1 means no correction, 2.2 in the original paper.
 @param exposure Exposure parameter (0 means no correction, 0 in the original paper)
+@param dither Rounding or dithering of the 24-bit output
 @return Returns a 24-bit RGB image if successful, returns NULL otherwise
 */
-FIBITMAP* DLL_CALLCONV 
-FreeImage_TmoDrago03(FIBITMAP *src, double gamma, double exposure) {
-	float maxLum, minLum, avgLum;
-
+FIBITMAP*
+TmoDrago03(FIBITMAP *src, double gamma, double exposure, FREE_IMAGE_DEPTH_DITHER dither) {
 	if (!FreeImage_HasPixels(src)) return nullptr;
 
 	// working RGBF variable
 	auto *dib = FreeImage_ConvertToRGBF(src);
 	if (!dib) return nullptr;
 
+	const unsigned width  = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+	const unsigned padded_width = PaddedWidth(width);
+
+	FIBITMAP *dst = FreeImage_Allocate(width, height, 24, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+	if (!dst) {
+		FreeImage_Unload(dib);
+		return nullptr;
+	}
+
 	// default algorithm parameters
 	const float biasParam = 0.85F;
 	const float expoParam = (float)pow(2.0, exposure); //default exposure is 1, 2^0
 
-	// convert to Yxy
-	ConvertInPlaceRGBFToYxy(dib);
-	// get the luminance
-	LuminanceFromYxy(dib, &maxLum, &minLum, &avgLum);
-	// perform the tone mapping
-	ToneMappingDrago03(dib, maxLum, avgLum, biasParam, expoParam);
-	// convert back to RGBF
-	ConvertInPlaceYxyToRGBF(dib);
-	if (gamma != 1) {
-		// perform gamma correction
-		REC709GammaCorrection(dib, (float)gamma);
-	}
-	// clamp image highest values to display white, then convert to 24-bit RGB
-	FIBITMAP *dst = ClampConvertRGBFTo24(dib);
+	// get the luminance of the Yxy image, without storing it
+	const LuminanceStats stats = ParallelReduceRows(height, width * sizeof(FIRGBF), LuminanceStats(),
+		[&](LuminanceStats& band, unsigned first_row, unsigned end_row) {
+			std::vector<float> channels(3 * padded_width);
+			float *Y = channels.data(), *x = Y + padded_width, *y = x + padded_width;
+			for (unsigned row = first_row; row < end_row; row++) {
+				SplitRGBFRow((const FIRGBF*)FreeImage_GetScanLine(dib, row), width, Y, x, y);
+				ConvertRowRGBFToYxy(Y, x, y, width);
+				band.Accumulate(Y, width);
+			}
+		},
+		[](LuminanceStats& value, const LuminanceStats& band) { value.Combine(band); });
+	const float maxLum = std::max(0.F, stats.maxLum);
+	const float avgLum = (float)exp(stats.sumLogLum / stats.count);
+
+	// convert to Yxy, perform the tone mapping, convert back to RGBF, perform gamma correction,
+	// clamp image highest values to display white and convert to 24-bit RGB, row by row
+	const Drago03 drago(maxLum, avgLum, biasParam, expoParam);
+	const REC709Gamma correction((float)gamma);
+	const ToneMappedRows output(dib, dst, dither);
+	ParallelForRows(height, width * sizeof(FIRGBF), [&](unsigned first_row, unsigned end_row) {
+		std::vector<float> channels(3 * padded_width);
+		float *Y = channels.data(), *x = Y + padded_width, *y = x + padded_width;
+		for (unsigned row = first_row; row < end_row; row++) {
+			SplitRGBFRow((const FIRGBF*)FreeImage_GetScanLine(dib, row), width, Y, x, y);
+			ConvertRowRGBFToYxy(Y, x, y, width);
+			drago.MapRow(Y, width);
+			ConvertRowYxyToRGBF(Y, x, y, width);
+			if (gamma != 1) {
+				for (float *channel : { Y, x, y }) {
+					correction.CorrectRow(channel, width);
+				}
+			}
+			output.StoreRow(row, Y, x, y, width);
+		}
+	});
+	output.Finish();
 
 	// clean-up and return
 	FreeImage_Unload(dib);
@@ -291,3 +204,15 @@ FreeImage_TmoDrago03(FIBITMAP *src, double gamma, double exposure) {
 	
 	return dst;
 }
+
+/**
+Apply the Adaptive Logarithmic Mapping operator to a HDR image and convert to 24-bit RGB
+@param src Input RGB16 or RGB[A]F image
+@param gamma Gamma correction (gamma > 0). 1 means no correction, 2.2 in the original paper.
+@param exposure Exposure parameter (0 means no correction, 0 in the original paper)
+@return Returns a 24-bit RGB image if successful, returns NULL otherwise
+*/
+FIBITMAP* DLL_CALLCONV 
+FreeImage_TmoDrago03(FIBITMAP *src, double gamma, double exposure) {
+	return TmoDrago03(src, gamma, exposure, FIDD_NONE);
+}
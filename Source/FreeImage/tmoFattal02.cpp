@@ -559,8 +559,8 @@ static FIBITMAP* tmoFattal02(FIBITMAP *Y, float alpha, float beta) {
 		FreeImage_Unload(H); H = nullptr;
 		FreeImage_Unload(phy); phy = nullptr;
 
-		// solve the PDE (Poisson equation) using a multigrid solver and 3 cycles
-		FIBITMAP *U = FreeImage_MultigridPoissonSolver(divG, 3);
+		// solve the PDE (Poisson equation) with Neumann boundary conditions, using a DCT solver
+		FIBITMAP *U = FreeImage_DCTPoissonSolver(divG);
 		if (!U) throw(1);
 
 		FreeImage_Unload(divG);
@@ -602,10 +602,11 @@ Apply the Gradient Domain High Dynamic Range Compression to a RGBF image and con
 @param dib Input RGBF / RGB16 image
 @param color_saturation Color saturation (s parameter in the paper) in [0.4..0.6]
 @param attenuation Atenuation factor (beta parameter in the paper) in [0.8..0.9]
+@param dither Rounding or dithering of the 24-bit output
 @return Returns a 24-bit RGB image if successful, returns NULL otherwise
 */
-FIBITMAP* DLL_CALLCONV 
-FreeImage_TmoFattal02(FIBITMAP *dib, double color_saturation, double attenuation) {	
+FIBITMAP*
+TmoFattal02(FIBITMAP *dib, double color_saturation, double attenuation, FREE_IMAGE_DEPTH_DITHER dither) {	
 	const float alpha = 0.1F;									// parameter alpha = 0.1
 	const float beta = (float)std::clamp(attenuation, 0.8, 0.9);	// parameter beta = [0.8..0.9]
 	const float s = (float)std::clamp(color_saturation, 0.4, 0.6);// exponent s controls color saturation = [0.4..0.6]
@@ -667,7 +668,7 @@ FreeImage_TmoFattal02(FIBITMAP *dib, double color_saturation, double attenuation
 		FreeImage_Unload(Yout); Yout = nullptr;
 
 		// clamp image highest values to display white, then convert to 24-bit RGB
-		dst = ClampConvertRGBFTo24(src);
+		dst = ClampConvertRGBFTo24(src, dither);
 
 		// clean-up and return
 		FreeImage_Unload(src); src = nullptr;
@@ -684,3 +685,15 @@ FreeImage_TmoFattal02(FIBITMAP *dib, double color_saturation, double attenuation
 		return nullptr;
 	}
 }
+
+/**
+Apply the Gradient Domain High Dynamic Range Compression to a RGBF image and convert to 24-bit RGB
+@param dib Input RGBF / RGB16 image
+@param color_saturation Color saturation (s parameter in the paper) in [0.4..0.6]
+@param attenuation Atenuation factor (beta parameter in the paper) in [0.8..0.9]
+@return Returns a 24-bit RGB image if successful, returns NULL otherwise
+*/
+FIBITMAP* DLL_CALLCONV 
+FreeImage_TmoFattal02(FIBITMAP *dib, double color_saturation, double attenuation) {
+	return TmoFattal02(dib, color_saturation, attenuation, FIDD_NONE);
+}
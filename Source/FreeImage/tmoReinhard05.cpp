@@ -23,7 +23,10 @@
 #include "FreeImage.h"
 #include "Utilities.h"
 #include "ToneMapping.h"
+#include "SimpleTools.h"
+#include "SimdFloat4.h"
 #include <algorithm>
+#include <vector>
 
 // ----------------------------------------------------------
 // Global and/or local tone mapping operator
@@ -34,34 +37,63 @@
 //     Journal of Graphics Tools, vol. 7, no. 1, pp. 45-51, 2003.
 // ----------------------------------------------------------
 
+/**
+Statistics of the image used by the operator
+*/
+struct ImageStats {
+	LuminanceStats luminance;
+	double channelSum[3] = { 0, 0, 0 };
+
+	void Combine(const ImageStats& other) {
+		luminance.Combine(other.luminance);
+		for (int i = 0; i < 3; i++) {
+			channelSum[i] += other.channelSum[i];
+		}
+	}
+};
+
+/**
+Range of the tone mapped colors
+*/
+struct ColorRange {
+	float min_color = +1e6F;
+	float max_color = -1e6F;
+
+	void Accumulate(const float *color, unsigned count) {
+		for (unsigned i = 0; i < count; i++) {
+			max_color = (color[i] > max_color) ? color[i] : max_color;
+			min_color = (color[i] < min_color) ? color[i] : min_color;
+		}
+	}
+
+	void Combine(const ColorRange& other) {
+		max_color = std::max(max_color, other.max_color);
+		min_color = std::min(min_color, other.min_color);
+	}
+};
+
 /**
 Tone mapping operator
-@param dib Input / Output RGBF image
-@param Y Input luminance image version of dib
+@param dib Input RGBF image, used as working image
 @param f Overall intensity in range [-8:8] : default to 0
 @param m Contrast in range [0.3:1) : default to 0
 @param a Adaptation in range [0:1] : default to 1
 @param c Color correction in range [0:1] : default to 0
-@return Returns TRUE if successful, returns FALSE otherwise
-@see LuminanceFromY
+@return Returns a 24-bit RGB image if successful, returns NULL otherwise
 */
-static FIBOOL 
-ToneMappingReinhard05(FIBITMAP *dib, FIBITMAP *Y, float f, float m, float a, float c) {
+static FIBITMAP* 
+ToneMappingReinhard05(FIBITMAP *dib, float f, float m, float a, float c, FREE_IMAGE_DEPTH_DITHER dither) {
 	float Cav[3];		// channel average
 	float Lav = 0;		// average luminance
 	float Llav = 0;		// log average luminance
 	float minLum = 1;	// min luminance
 	float maxLum = 1;	// max luminance
-
-	float L;		// pixel luminance
-	float I_g, I_l; // global and local light adaptation
-	float I_a;		// interpolated pixel light adaptation
-	float k;		// key (low-key means overall dark image, high-key means overall light image)
+	float k = 0;		// key (low-key means overall dark image, high-key means overall light image)
 
 	// check input parameters 
 
-	if ((FreeImage_GetImageType(dib) != FIT_RGBF) || (FreeImage_GetImageType(Y) != FIT_FLOAT)) {
-		return FALSE;
+	if (FreeImage_GetImageType(dib) != FIT_RGBF) {
+		return nullptr;
 	}
 
 	f = std::clamp(f, -8.f, 8.f);
@@ -71,20 +103,54 @@ ToneMappingReinhard05(FIBITMAP *dib, FIBITMAP *Y, float f, float m, float a, flo
 
 	const unsigned width  = FreeImage_GetWidth(dib);
 	const unsigned height = FreeImage_GetHeight(dib);
-
-	const unsigned dib_pitch  = FreeImage_GetPitch(dib);
-	const unsigned y_pitch    = FreeImage_GetPitch(Y);
-
-	int i;
-	unsigned x, y;
-	uint8_t *bits{}, *Ybits{};
-
-	// get statistics about the data (but only if its really needed)
+	const unsigned padded_width = PaddedWidth(width);
+
+	FIBITMAP *dst = FreeImage_Allocate(width, height, 24, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+	if (!dst) return nullptr;
+
+	// get statistics about the data (but only if its really needed) in a single pass :
+	// luminance statistics, and channel averages that are not needed when (a == 1) or (c == 0)
+
+	const bool need_luminance = (m == 0) || ((a != 1) && (c != 1));
+	const bool need_channels = (a != 1) && (c != 0);
+	Cav[0] = Cav[1] = Cav[2] = 0;
+	if (need_luminance || need_channels) {
+		const ImageStats stats = ParallelReduceRows(height, width * sizeof(FIRGBF), ImageStats(),
+			[&](ImageStats& band, unsigned first_row, unsigned end_row) {
+				std::vector<float> channels(4 * padded_width);
+				float *r = channels.data(), *g = r + padded_width, *b = g + padded_width, *Y = b + padded_width;
+				for (unsigned y = first_row; y < end_row; y++) {
+					auto *pixel = (const FIRGBF*)FreeImage_GetScanLine(dib, y);
+					SplitRGBFRow(pixel, width, r, g, b);
+					ConvertRowRGBFToY(r, g, b, width, Y);
+					band.luminance.Accumulate(Y, width);
+					if (need_channels) {
+						float row_sum[3] = { 0, 0, 0 };
+						for (unsigned x = 0; x < width; x++) {
+							row_sum[0] += r[x];
+							row_sum[1] += g[x];
+							row_sum[2] += b[x];
+						}
+						for (int i = 0; i < 3; i++) {
+							band.channelSum[i] += row_sum[i];
+						}
+					}
+				}
+			},
+			[](ImageStats& value, const ImageStats& band) { value.Combine(band); });
+
+		const double image_size = (double)width * height;
+		maxLum = stats.luminance.maxLum;
+		minLum = stats.luminance.minLum;
+		Lav = (float)(stats.luminance.sumLum / image_size);
+		Llav = (float)exp(stats.luminance.sumLogLum / image_size);
+		for (int i = 0; i < 3; i++) {
+			Cav[i] = (float)(stats.channelSum[i] / image_size);
+		}
+	}
 
 	f = exp(-f);
-	if ((m == 0) || (a != 1) && (c != 1)) {
-		// avoid these calculations if its not needed after ...
-		LuminanceFromY(Y, &maxLum, &minLum, &Lav, &Llav);
+	if (need_luminance) {
 		k = (log(maxLum) - Llav) / (log(maxLum) - log(minLum));
 		if (k < 0) {
 			// pow(k, 1.4F) is undefined ...
@@ -96,108 +162,72 @@ ToneMappingReinhard05(FIBITMAP *dib, FIBITMAP *Y, float f, float m, float a, flo
 	}
 	m = (m > 0) ? m : (float)(0.3 + 0.7 * pow(k, 1.4F));
 
-	float max_color = -1e6F;
-	float min_color = +1e6F;
-
-	// tone map image
-
-	bits  = (uint8_t*)FreeImage_GetBits(dib);
-	Ybits = (uint8_t*)FreeImage_GetBits(Y);
-
-	if ((a == 1) && (c == 0)) {
-		// when using default values, use a fastest code
-
-		for (y = 0; y < height; y++) {
-			float *Y     = (float*)Ybits;
-			float *color = (float*)bits;
-
-			for (x = 0; x < width; x++) {
-				I_a = Y[x];	// luminance(x, y)
-				for (i = 0; i < 3; i++) {
-					*color /= ( *color + pow(f * I_a, m) );
-					
-					max_color = (*color > max_color) ? *color : max_color;
-					min_color = (*color < min_color) ? *color : min_color;
-
-					color++;
-				}
-			}
-			// next line
-			bits  += dib_pitch;
-			Ybits += y_pitch;
-		}
-	} else {
-		// complete algorithm
-
-		// channel averages
-
-		Cav[0] = Cav[1] = Cav[2] = 0;
-		if ((a != 1) && (c != 0)) {
-			// channel averages are not needed when (a == 1) or (c == 0)
-			bits = (uint8_t*)FreeImage_GetBits(dib);
-			for (y = 0; y < height; y++) {
-				auto *color = (const float*)bits;
-				for (x = 0; x < width; x++) {
-					for (i = 0; i < 3; i++) {
-						Cav[i] += *color;
-						color++;
+	// tone map image : color / (color + (f * I_a)^m), where I_a is the pixel light adaptation.
+	// The tone mapped colors replace the working image.
+
+	const ColorRange range = ParallelReduceRows(height, width * sizeof(FIRGBF), ColorRange(),
+		[&](ColorRange& band, unsigned first_row, unsigned end_row) {
+			std::vector<float> channels(4 * padded_width);
+			float *rgb[3] = { channels.data(), channels.data() + padded_width, channels.data() + 2 * padded_width };
+			float *L = channels.data() + 3 * padded_width;
+			const Float4 F = Float4::Set(f);
+			const Float4 M = Float4::Set(m);
+			for (unsigned y = first_row; y < end_row; y++) {
+				auto *pixel = (FIRGBF*)FreeImage_GetScanLine(dib, y);
+				SplitRGBFRow(pixel, width, rgb[0], rgb[1], rgb[2]);
+				ConvertRowRGBFToY(rgb[0], rgb[1], rgb[2], width, L);	// luminance(x, y)
+				if ((a == 1) && (c == 0)) {
+					// when using default values, the light adaptation is the luminance for the three channels
+					for (unsigned x = 0; x < width; x += 4) {
+						const Float4 P = Pow(F * Float4::Load(L + x), M);
+						for (float *channel : rgb) {
+							const Float4 color = Float4::Load(channel + x);
+							(color / (color + P)).Store(channel + x);
+						}
+					}
+				} else {
+					// complete algorithm
+					for (int i = 0; i < 3; i++) {
+						const Float4 I_g = Float4::Set(c * Cav[i] + (1 - c) * Lav);	// global light adaptation
+						for (unsigned x = 0; x < width; x += 4) {
+							const Float4 color = Float4::Load(rgb[i] + x);
+							const Float4 I_l = Float4::Set(c) * color + Float4::Set(1 - c) * Float4::Load(L + x);	// local light adaptation
+							const Float4 I_a = Float4::Set(a) * I_l + Float4::Set(1 - a) * I_g;
+							(color / (color + Pow(F * I_a, M))).Store(rgb[i] + x);
+						}
 					}
 				}
-				// next line
-				bits += dib_pitch;
-			}
-			const float image_size = (float)width * height;
-			for (i = 0; i < 3; i++) {
-				Cav[i] /= image_size;
-			}
-		}
-
-		// perform tone mapping
-
-		bits = (uint8_t*)FreeImage_GetBits(dib);
-		for (y = 0; y < height; y++) {
-			const float *Y     = (float*)Ybits;
-			auto *color = (float*)bits;
-
-			for (x = 0; x < width; x++) {
-				L = Y[x];	// luminance(x, y)
-				for (i = 0; i < 3; i++) {
-					I_l = c * *color + (1-c) * L;
-					I_g = c * Cav[i] + (1-c) * Lav;
-					I_a = a * I_l + (1-a) * I_g;
-					*color /= ( *color + pow(f * I_a, m) );
-					
-					max_color = (*color > max_color) ? *color : max_color;
-					min_color = (*color < min_color) ? *color : min_color;
-
-					color++;
+				for (const float *channel : rgb) {
+					band.Accumulate(channel, width);
 				}
+				MergeRGBFRow(rgb[0], rgb[1], rgb[2], width, pixel);
 			}
-			// next line
-			bits  += dib_pitch;
-			Ybits += y_pitch;
-		}
-	}
-
-	// normalize intensities
-
-	if (max_color != min_color) {
-		bits = (uint8_t*)FreeImage_GetBits(dib);
-		const float range = max_color - min_color;
-		for (y = 0; y < height; y++) {
-			auto *color = (float*)bits;
-			for(x = 0; x < width; x++) {
-				for (i = 0; i < 3; i++) {
-					*color = (*color - min_color) / range;
-					color++;
+		},
+		[](ColorRange& value, const ColorRange& band) { value.Combine(band); });
+
+	// normalize intensities, clamp image highest values to display white, then convert to 24-bit RGB
+
+	const ToneMappedRows output(dib, dst, dither);
+	ParallelForRows(height, width * sizeof(FIRGBF), [&](unsigned first_row, unsigned end_row) {
+		std::vector<float> channels(3 * padded_width);
+		float *rgb[3] = { channels.data(), channels.data() + padded_width, channels.data() + 2 * padded_width };
+		const Float4 min_color = Float4::Set(range.min_color);
+		const Float4 scale = Float4::Set(1 / (range.max_color - range.min_color));
+		for (unsigned y = first_row; y < end_row; y++) {
+			SplitRGBFRow((const FIRGBF*)FreeImage_GetScanLine(dib, y), width, rgb[0], rgb[1], rgb[2]);
+			if (range.max_color != range.min_color) {
+				for (float *channel : rgb) {
+					for (unsigned x = 0; x < width; x += 4) {
+						((Float4::Load(channel + x) - min_color) * scale).Store(channel + x);
+					}
 				}
 			}
-			// next line
-			bits += dib_pitch;
+			output.StoreRow(y, rgb[0], rgb[1], rgb[2], width);
 		}
-	}
+	});
+	output.Finish();
 
-	return TRUE;
+	return dst;
 }
 
 // ----------------------------------------------------------
@@ -212,28 +242,18 @@ User parameters control intensity, contrast, and level of adaptation
 @param contrast Contrast in range [0.3:1) : default to 0
 @param adaptation Adaptation in range [0:1] : default to 1
 @param color_correction Color correction in range [0:1] : default to 0
+@param dither Rounding or dithering of the 24-bit output
 @return Returns a 24-bit RGB image if successful, returns NULL otherwise
 */
-FIBITMAP* DLL_CALLCONV 
-FreeImage_TmoReinhard05Ex(FIBITMAP *src, double intensity, double contrast, double adaptation, double color_correction) {
+FIBITMAP*
+TmoReinhard05Ex(FIBITMAP *src, double intensity, double contrast, double adaptation, double color_correction, FREE_IMAGE_DEPTH_DITHER dither) {
 	if (!FreeImage_HasPixels(src)) return nullptr;
 
 	auto *dib = FreeImage_ConvertToRGBF(src);
 	if (!dib) return nullptr;
 
-	// get the Luminance channel
-	auto *Y = ConvertRGBFToY(dib);
-	if (!Y) {
-		FreeImage_Unload(dib);
-		return nullptr;
-	}
-
-	// perform the tone mapping
-	ToneMappingReinhard05(dib, Y, (float)intensity, (float)contrast, (float)adaptation, (float)color_correction);
-	// not needed anymore
-	FreeImage_Unload(Y);
-	// clamp image highest values to display white, then convert to 24-bit RGB
-	FIBITMAP *dst = ClampConvertRGBFTo24(dib);
+	// perform the tone mapping, the luminance is computed on the fly
+	FIBITMAP *dst = ToneMappingReinhard05(dib, (float)intensity, (float)contrast, (float)adaptation, (float)color_correction, dither);
 
 	// clean-up and return
 	FreeImage_Unload(dib);
@@ -244,6 +264,21 @@ FreeImage_TmoReinhard05Ex(FIBITMAP *src, double intensity, double contrast, doub
 	return dst;
 }
 
+/**
+Apply the global/local tone mapping operator to a RGBF image and convert to 24-bit RGB<br>
+User parameters control intensity, contrast, and level of adaptation
+@param src Input RGBF image
+@param intensity Overall intensity in range [-8:8] : default to 0
+@param contrast Contrast in range [0.3:1) : default to 0
+@param adaptation Adaptation in range [0:1] : default to 1
+@param color_correction Color correction in range [0:1] : default to 0
+@return Returns a 24-bit RGB image if successful, returns NULL otherwise
+*/
+FIBITMAP* DLL_CALLCONV 
+FreeImage_TmoReinhard05Ex(FIBITMAP *src, double intensity, double contrast, double adaptation, double color_correction) {
+	return TmoReinhard05Ex(src, intensity, contrast, adaptation, color_correction, FIDD_NONE);
+}
+
 /**
 Apply the global tone mapping operator to a RGBF image and convert to 24-bit RGB<br>
 User parameters control intensity and contrast
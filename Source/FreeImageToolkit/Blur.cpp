@@ -0,0 +1,314 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "FreeImage.h"
+#include "Utilities.h"
+#include "WorkImage.h"
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <vector>
+
+namespace
+{
+
+	// ----------------------------------------------------------
+	//  Extended box filter with running sums
+	// ----------------------------------------------------------
+
+	/**
+	Extended box filter : weight 1 for the offsets [-radius, radius], weight alpha for the offsets -radius-1 and radius+1.
+	A box filter has alpha == 0. The fractional weight gives any variance,
+	see P. Gwosdek, S. Grewenig, A. Bruhn, J. Weickert, Theoretical Foundations of Gaussian Convolution
+	by Extended Box Filtering. Scale Space and Variational Methods in Computer Vision, 2011.
+	*/
+	struct ExtendedBox
+	{
+		ptrdiff_t radius;
+		double alpha;
+		double scale;	// 1 / sum of the weights
+
+		ExtendedBox(ptrdiff_t r, double a)
+			: radius(r), alpha(a), scale(1 / (2 * r + 1 + 2 * a))
+		{}
+	};
+
+	/**
+	Extended box approximating a Gaussian of variance 'variance'
+	*/
+	ExtendedBox GaussianBox(double variance)
+	{
+		// largest box with a variance not larger than the target, the outer weights add the remaining variance
+		const ptrdiff_t r = static_cast<ptrdiff_t>(std::floor(0.5 * std::sqrt(12 * variance + 1) - 0.5));
+		const double box_variance = r * (r + 1) / 3.0;
+		const double alpha = (2 * r + 1) * (variance - box_variance) / (2 * ((r + 1) * (r + 1) - variance));
+		return ExtendedBox(r, std::clamp(alpha, 0.0, 1.0));
+	}
+
+	/** Number of extended box passes of the Gaussian approximation */
+	constexpr unsigned GaussianPasses = 3;
+
+	/**
+	Filter a line of 'length' samples, each made of 'lanes' interleaved values
+	(the channels of a row, or the columns of a strip of rows). Samples outside of the line repeat the end samples.
+	The cost per sample does not depend on the radius.
+	@param in Input samples
+	@param out Output samples, must not overlap the input
+	@param sums Running sums, 'lanes' values
+	*/
+	template <size_t Lanes_, typename Work_>
+	void ExtendedBoxLine(const Work_* in, Work_* out, size_t length, size_t lanes, const ExtendedBox& box, double* sums)
+	{
+		if constexpr (Lanes_ != 0) {
+			lanes = Lanes_;
+		}
+		const ptrdiff_t last = static_cast<ptrdiff_t>(length) - 1;
+		const ptrdiff_t r = box.radius;
+		auto sample = [&](ptrdiff_t i) {
+			return in + std::clamp<ptrdiff_t>(i, 0, last) * lanes;
+		};
+
+		// window [-r, r] around the first sample
+		const Work_* first = sample(0);
+		for (size_t l = 0; l < lanes; ++l) {
+			sums[l] = (r + 1) * static_cast<double>(first[l]);
+		}
+		for (ptrdiff_t i = 1; i <= std::min(r, last); ++i) {
+			const Work_* s = sample(i);
+			for (size_t l = 0; l < lanes; ++l) {
+				sums[l] += s[l];
+			}
+		}
+		if (r > last) {
+			const Work_* s = sample(last);
+			for (size_t l = 0; l < lanes; ++l) {
+				sums[l] += (r - last) * static_cast<double>(s[l]);
+			}
+		}
+
+		const double scale = box.scale;
+		const double alpha = box.alpha;
+		auto step = [&](ptrdiff_t x, const Work_* outer, const Work_* leaving, const Work_* entering) {
+			Work_* o = out + x * lanes;
+			if (alpha == 0) {
+				for (size_t l = 0; l < lanes; ++l) {
+					o[l] = static_cast<Work_>(sums[l] * scale);
+					sums[l] += static_cast<double>(entering[l]) - leaving[l];
+				}
+			}
+			else {
+				for (size_t l = 0; l < lanes; ++l) {
+					o[l] = static_cast<Work_>((sums[l] + alpha * (static_cast<double>(outer[l]) + entering[l])) * scale);
+					sums[l] += static_cast<double>(entering[l]) - leaving[l];
+				}
+			}
+		};
+
+		// samples whose window is inside the line need no clamping
+		const ptrdiff_t inner_first = std::min(r + 1, last + 1);
+		const ptrdiff_t inner_end = std::max(inner_first, last - r);
+		for (ptrdiff_t x = 0; x < inner_first; ++x) {
+			step(x, sample(x - r - 1), sample(x - r), sample(x + r + 1));
+		}
+		for (ptrdiff_t x = inner_first; x < inner_end; ++x) {
+			// x - r - 1 >= 0 and x + r + 1 <= last : the pointer is only formed inside the line
+			const Work_* outer = in + (x - r - 1) * lanes;
+			step(x, outer, outer + lanes, outer + (2 * r + 2) * lanes);
+		}
+		for (ptrdiff_t x = inner_end; x <= last; ++x) {
+			step(x, sample(x - r - 1), sample(x - r), sample(x + r + 1));
+		}
+	}
+
+	/** ExtendedBoxLine with the usual channel counts known at compile time */
+	template <typename Work_>
+	void ExtendedBoxRow(const Work_* in, Work_* out, size_t length, size_t channels, const ExtendedBox& box, double* sums)
+	{
+		switch (channels) {
+		case 1:
+			return ExtendedBoxLine<1>(in, out, length, channels, box, sums);
+		case 3:
+			return ExtendedBoxLine<3>(in, out, length, channels, box, sums);
+		case 4:
+			return ExtendedBoxLine<4>(in, out, length, channels, box, sums);
+		default:
+			return ExtendedBoxLine<0>(in, out, length, channels, box, sums);
+		}
+	}
+
+	// ----------------------------------------------------------
+	//  Separable filtering of an image
+	// ----------------------------------------------------------
+
+	/**
+	Line filter running the extended box passes
+	*/
+	template <typename Work_>
+	struct BoxPassesLine
+	{
+		const std::vector<ExtendedBox>* passes;
+		std::vector<double> sums;
+
+		void operator()(Work_* in, Work_* out, size_t length, size_t lanes)
+		{
+			sums.resize(lanes);
+			Work_* const result = out;
+			for (const auto& box : *passes) {
+				ExtendedBoxRow(in, out, length, lanes, box, sums.data());
+				std::swap(in, out);
+			}
+			if (in != result) {
+				std::copy(in, in + length * lanes, result);
+			}
+		}
+	};
+
+	/**
+	Run the extended box passes over the rows, then over the columns of the image
+	*/
+	template <typename Work_>
+	void FilterImage(WorkImage<Work_>& image, const std::vector<ExtendedBox>& passes)
+	{
+		const BoxPassesLine<Work_> line = { &passes, {} };
+		FilterRows(image, line);
+		FilterColumns(image, line);
+	}
+
+	/**
+	Sharpening parameters, see FreeImage_UnsharpMask
+	*/
+	struct Unsharp
+	{
+		double amount;
+		double threshold;
+	};
+
+	/**
+	Filter an image of 'channels' values of type Value_ per pixel.
+	@param unsharp If not NULL, the filtered image is the blurred mask of an unsharp masking
+	*/
+	template <typename Value_, typename Work_>
+	FIBITMAP* FilterBitmap(FIBITMAP* src, unsigned channels, const std::vector<ExtendedBox>& passes, const Unsharp* unsharp)
+	{
+		const unsigned width = FreeImage_GetWidth(src);
+		const unsigned height = FreeImage_GetHeight(src);
+
+		UniqueBitmap dst(FreeImage_Clone(src), &::FreeImage_Unload);
+		if (!dst) {
+			return nullptr;
+		}
+
+		try {
+			WorkImage<Work_> image(width, height, channels);
+			const size_t row_length = image.RowLength();
+
+			LoadImage<Value_>(src, image);
+			FilterImage(image, passes);
+
+			if (!unsharp) {
+				StoreImage<Value_>(image, dst.get());
+				return dst.release();
+			}
+
+			ParallelForRows(height, row_length * sizeof(Value_), [&](unsigned first_row, unsigned end_row) {
+				for (unsigned y = first_row; y < end_row; ++y) {
+					const Work_* filtered = image.Row(y);
+					auto dst_bits = reinterpret_cast<Value_*>(FreeImage_GetScanLine(dst.get(), y));
+					// sharpened = original + amount * (original - blurred), the alpha channel is left unchanged
+					const auto src_bits = reinterpret_cast<const Value_*>(FreeImage_GetScanLine(src, y));
+					const Work_ amount = static_cast<Work_>(unsharp->amount);
+					const Work_ threshold = static_cast<Work_>(unsharp->threshold);
+					for (size_t i = 0; i < row_length; ++i) {
+						if ((channels == 4) && (i % 4 == 3)) {
+							continue;
+						}
+						const Work_ v = static_cast<Work_>(src_bits[i]);
+						const Work_ detail = v - filtered[i];
+						if (std::abs(detail) >= threshold) {
+							dst_bits[i] = ToValue<Value_>(v + amount * detail);
+						}
+					}
+				}
+			});
+		}
+		catch (const std::bad_alloc&) {
+			FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+			return nullptr;
+		}
+
+		return dst.release();
+	}
+
+	/**
+	Filter an image of any standard type, see FilterStandardType
+	*/
+	FIBITMAP* Filter(FIBITMAP* src, const std::vector<ExtendedBox>& passes, const Unsharp* unsharp)
+	{
+		return FilterStandardType(src, [&](auto value, auto work, unsigned channels) {
+			return FilterBitmap<typename decltype(value)::type, typename decltype(work)::type>(src, channels, passes, unsharp);
+		});
+	}
+
+	/** Passes of the Gaussian approximation */
+	std::vector<ExtendedBox> GaussianPassList(double sigma)
+	{
+		return std::vector<ExtendedBox>(GaussianPasses, GaussianBox(sigma * sigma / GaussianPasses));
+	}
+
+} // namespace
+
+/**
+Box blur : every pixel becomes the mean of the (2 * radius + 1) x (2 * radius + 1) square around it.
+Pixels outside of the image repeat the edge pixels. The cost does not depend on the radius.
+Supported images are 8-bit greyscale, 24-bit and 32-bit FIT_BITMAP, and the FIT_UINT16, FIT_INT16, FIT_UINT32, FIT_INT32,
+FIT_FLOAT, FIT_DOUBLE, FIT_RGB16, FIT_RGBA16, FIT_RGBF and FIT_RGBAF types.
+@param dib Source image
+@param radius Radius of the box, 0 returns a copy of the image
+@return Returns the blurred image if successful, NULL otherwise
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_BoxBlur(FIBITMAP *dib, int radius) {
+	if (radius < 0) {
+		return nullptr;
+	}
+	return Filter(dib, { ExtendedBox(radius, 0) }, nullptr);
+}
+
+/**
+Gaussian blur, approximated by three extended box filters of the same variance as the Gaussian.
+The cost does not depend on sigma. Supported images are those of FreeImage_BoxBlur.
+@param dib Source image
+@param sigma Standard deviation of the Gaussian, in pixels
+@return Returns the blurred image if successful, NULL otherwise
+@see FreeImage_BoxBlur
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_GaussianBlur(FIBITMAP *dib, double sigma) {
+	if (!(sigma >= 0)) {
+		return nullptr;
+	}
+	return Filter(dib, GaussianPassList(sigma), nullptr);
+}
+
+/**
+Unsharp masking : sharpened = original + amount * (original - blurred), where blurred is the Gaussian blur of the image.
+Channels whose difference to the blurred image is below the threshold are left unchanged, the alpha channel is not sharpened.
+Supported images are those of FreeImage_BoxBlur.
+@param dib Source image
+@param sigma Standard deviation of the Gaussian blur, in pixels
+@param amount Strength of the sharpening (e.g. 0.5 to 1.5)
+@param threshold Minimum difference to sharpen, in pixel values (e.g. 0 to 10 for 8-bit channels)
+@return Returns the sharpened image if successful, NULL otherwise
+@see FreeImage_GaussianBlur
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_UnsharpMask(FIBITMAP *dib, double sigma, double amount, double threshold) {
+	if (!(sigma >= 0) || !(threshold >= 0)) {
+		return nullptr;
+	}
+	const Unsharp unsharp = { amount, threshold };
+	return Filter(dib, GaussianPassList(sigma), &unsharp);
+}
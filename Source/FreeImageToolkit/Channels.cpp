@@ -21,6 +21,8 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include "FreeImage/ConversionSIMD.h"
+#include "FreeImage/ParallelFor.h"
 
 
 /** @brief Retrieves the red, green, blue or alpha channel of a BGR[A] image. 
@@ -486,3 +488,359 @@ FreeImage_SetComplexChannel(FIBITMAP *dst, FIBITMAP *src, FREE_IMAGE_COLOR_CHANN
 
 	return TRUE;
 }
+
+// ----------------------------------------------------------
+//  Split / merge of all the channels of an image
+// ----------------------------------------------------------
+
+namespace
+{
+	/** Interleaved layout of a RGB[A] image, against one plane per channel */
+	struct ChannelLayout
+	{
+		FREE_IMAGE_TYPE plane_type;	// FIT_BITMAP (8-bit), FIT_UINT16 or FIT_FLOAT
+		unsigned channels;			// 3 or 4
+		unsigned size;				// bytes per value
+		unsigned offsets[4];		// position of the red, green, blue and alpha values in a pixel
+	};
+
+	/** Layout of a 24- or 32-bit, RGB[A]16 or RGB[A]F image */
+	bool
+	GetChannelLayout(FIBITMAP *dib, ChannelLayout& layout) {
+		const unsigned bpp = FreeImage_GetBPP(dib);
+		switch (FreeImage_GetImageType(dib)) {
+			case FIT_BITMAP:
+				if ((bpp != 24) && (bpp != 32)) {
+					return false;
+				}
+				layout = { FIT_BITMAP, bpp / 8, 1, { FI_RGBA_RED, FI_RGBA_GREEN, FI_RGBA_BLUE, FI_RGBA_ALPHA } };
+				return true;
+			case FIT_RGB16:
+			case FIT_RGBA16:
+				layout = { FIT_UINT16, bpp / 16, 2, { 0, 1, 2, 3 } };
+				return true;
+			case FIT_RGBF:
+			case FIT_RGBAF:
+				layout = { FIT_FLOAT, bpp / 32, 4, { 0, 1, 2, 3 } };
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	/** Layout of the image merged from 'count' planes of the given type */
+	bool
+	GetMergedLayout(FREE_IMAGE_TYPE plane_type, unsigned count, FREE_IMAGE_TYPE& image_type, unsigned& bpp, ChannelLayout& layout) {
+		if ((count != 3) && (count != 4)) {
+			return false;
+		}
+		switch (plane_type) {
+			case FIT_BITMAP:
+				image_type = FIT_BITMAP;
+				layout = { FIT_BITMAP, count, 1, { FI_RGBA_RED, FI_RGBA_GREEN, FI_RGBA_BLUE, FI_RGBA_ALPHA } };
+				break;
+			case FIT_UINT16:
+				image_type = (count == 3) ? FIT_RGB16 : FIT_RGBA16;
+				layout = { FIT_UINT16, count, 2, { 0, 1, 2, 3 } };
+				break;
+			case FIT_FLOAT:
+				image_type = (count == 3) ? FIT_RGBF : FIT_RGBAF;
+				layout = { FIT_FLOAT, count, 4, { 0, 1, 2, 3 } };
+				break;
+			default:
+				return false;
+		}
+		bpp = 8 * count * layout.size;
+		return true;
+	}
+
+	/** Bits per pixel of a plane of the given type, 0 if not supported */
+	unsigned
+	GetPlaneBPP(FREE_IMAGE_TYPE plane_type) {
+		switch (plane_type) {
+			case FIT_BITMAP:
+				return 8;
+			case FIT_UINT16:
+				return 16;
+			case FIT_FLOAT:
+				return 32;
+			default:
+				return 0;
+		}
+	}
+
+	template <typename Value_>
+	void
+	SplitValues(uint8_t *const *planes, const uint8_t *source, unsigned channels, unsigned first, unsigned width) {
+		const auto *src = reinterpret_cast<const Value_*>(source) + static_cast<size_t>(first) * channels;
+		for (unsigned x = first; x < width; x++) {
+			for (unsigned k = 0; k < channels; k++) {
+				reinterpret_cast<Value_*>(planes[k])[x] = *src++;
+			}
+		}
+	}
+
+	template <typename Value_>
+	void
+	MergeValues(uint8_t *target, const uint8_t *const *planes, unsigned channels, unsigned first, unsigned width) {
+		auto *dst = reinterpret_cast<Value_*>(target) + static_cast<size_t>(first) * channels;
+		for (unsigned x = first; x < width; x++) {
+			for (unsigned k = 0; k < channels; k++) {
+				*dst++ = reinterpret_cast<const Value_*>(planes[k])[x];
+			}
+		}
+	}
+
+	/**
+	Deinterleave the channels of a row, with the SIMD kernel of the layout for the first pixels.
+	@param rows Plane rows, in red, green, blue, alpha order
+	*/
+	void
+	SplitRow(const ChannelLayout& layout, uint8_t *const *rows, const uint8_t *source, unsigned width) {
+		uint8_t *planes[4]{};
+		for (unsigned c = 0; c < layout.channels; c++) {
+			planes[layout.offsets[c]] = rows[c];
+		}
+		const auto kernel = GetChannelLineKernels().split[ChannelKernelIndex(layout.size)][layout.channels - 3];
+		const unsigned first = (unsigned)kernel(planes, source, (int)width);
+		switch (layout.size) {
+			case 1:
+				SplitValues<uint8_t>(planes, source, layout.channels, first, width);
+				break;
+			case 2:
+				SplitValues<uint16_t>(planes, source, layout.channels, first, width);
+				break;
+			default:
+				SplitValues<float>(planes, source, layout.channels, first, width);
+				break;
+		}
+	}
+
+	/**
+	Interleave the channels of a row, see SplitRow
+	@param rows Plane rows, in red, green, blue, alpha order
+	*/
+	void
+	MergeRow(const ChannelLayout& layout, uint8_t *target, const uint8_t *const *rows, unsigned width) {
+		const uint8_t *planes[4]{};
+		for (unsigned c = 0; c < layout.channels; c++) {
+			planes[layout.offsets[c]] = rows[c];
+		}
+		const auto kernel = GetChannelLineKernels().merge[ChannelKernelIndex(layout.size)][layout.channels - 3];
+		const unsigned first = (unsigned)kernel(target, planes, (int)width);
+		switch (layout.size) {
+			case 1:
+				MergeValues<uint8_t>(target, planes, layout.channels, first, width);
+				break;
+			case 2:
+				MergeValues<uint16_t>(target, planes, layout.channels, first, width);
+				break;
+			default:
+				MergeValues<float>(target, planes, layout.channels, first, width);
+				break;
+		}
+	}
+
+	/** Row bytes of an image of a layout, used to size the bands of parallel rows */
+	size_t
+	LayoutRowBytes(const ChannelLayout& layout, unsigned width) {
+		return static_cast<size_t>(width) * layout.channels * layout.size * 2;
+	}
+
+} // namespace
+
+/** @brief Splits a RGB[A] image into one greyscale image per channel, in a single pass.
+
+24- and 32-bit images give 8-bit images, FIT_RGB[A]16 images give FIT_UINT16 images and
+FIT_RGB[A]F images give FIT_FLOAT images. The channels are deinterleaved with the SIMD
+instruction set of the current level (see FreeImage_SetSIMDLevel), in parallel over bands of rows.
+@param dib Input image to be processed.
+@param channels Output array of FreeImage_GetChannelsNumber(dib) images, in red, green, blue, alpha order.
+@return Returns TRUE if successful, FALSE otherwise. On failure, the output array is filled with NULL.
+@see FreeImage_MergeChannels, FreeImage_GetChannel
+*/
+FIBOOL DLL_CALLCONV
+FreeImage_SplitChannels(FIBITMAP *dib, FIBITMAP **channels) {
+	ChannelLayout layout;
+	if (!channels || !FreeImage_HasPixels(dib) || !GetChannelLayout(dib, layout)) {
+		return FALSE;
+	}
+
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+
+	FIBITMAP *planes[4]{};
+	for (unsigned c = 0; c < layout.channels; c++) {
+		planes[c] = FreeImage_AllocateT(layout.plane_type, width, height, GetPlaneBPP(layout.plane_type));
+		if (!planes[c]) {
+			for (unsigned k = 0; k < layout.channels; k++) {
+				FreeImage_Unload(planes[k]);
+				channels[k] = nullptr;
+			}
+			return FALSE;
+		}
+	}
+
+	ParallelForRows(height, LayoutRowBytes(layout, width), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; y++) {
+			uint8_t *rows[4]{};
+			for (unsigned c = 0; c < layout.channels; c++) {
+				rows[c] = FreeImage_GetScanLine(planes[c], y);
+			}
+			SplitRow(layout, rows, FreeImage_GetScanLine(dib, y), width);
+		}
+	});
+
+	for (unsigned c = 0; c < layout.channels; c++) {
+		// copy metadata from src to dst
+		FreeImage_CloneMetadata(planes[c], dib);
+		channels[c] = planes[c];
+	}
+	return TRUE;
+}
+
+/** @brief Merges 3 or 4 greyscale images into a RGB[A] image, in a single pass.
+
+This is the inverse of FreeImage_SplitChannels : 8-bit greyscale images give a 24- or 32-bit image,
+FIT_UINT16 images give a FIT_RGB[A]16 image and FIT_FLOAT images give a FIT_RGB[A]F image.
+@param channels Input images, in red, green, blue, alpha order, of the same type and size.
+The images may be views of a planar buffer, see FreeImage_CreatePlanarView.
+@param count Number of input images, 3 or 4.
+@return Returns the merged image if successful, NULL otherwise.
+@see FreeImage_SplitChannels, FreeImage_SetChannel
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_MergeChannels(FIBITMAP **channels, unsigned count) {
+	if (!channels || (count < 3) || (count > 4) || !FreeImage_HasPixels(channels[0])) {
+		return nullptr;
+	}
+
+	const FREE_IMAGE_TYPE plane_type = FreeImage_GetImageType(channels[0]);
+	const unsigned width = FreeImage_GetWidth(channels[0]);
+	const unsigned height = FreeImage_GetHeight(channels[0]);
+	for (unsigned c = 0; c < count; c++) {
+		if (!FreeImage_HasPixels(channels[c]) || (FreeImage_GetImageType(channels[c]) != plane_type)
+			|| (FreeImage_GetBPP(channels[c]) != GetPlaneBPP(plane_type))
+			|| (FreeImage_GetWidth(channels[c]) != width) || (FreeImage_GetHeight(channels[c]) != height)) {
+			return nullptr;
+		}
+		if ((plane_type == FIT_BITMAP) && (FreeImage_GetColorType(channels[c]) != FIC_MINISBLACK)) {
+			return nullptr;
+		}
+	}
+
+	FREE_IMAGE_TYPE image_type;
+	unsigned bpp;
+	ChannelLayout layout;
+	if (!GetMergedLayout(plane_type, count, image_type, bpp, layout)) {
+		return nullptr;
+	}
+	FIBITMAP *dst = FreeImage_AllocateT(image_type, width, height, bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+	if (!dst) {
+		return nullptr;
+	}
+
+	ParallelForRows(height, LayoutRowBytes(layout, width), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; y++) {
+			const uint8_t *rows[4]{};
+			for (unsigned c = 0; c < count; c++) {
+				rows[c] = FreeImage_GetScanLine(channels[c], y);
+			}
+			MergeRow(layout, FreeImage_GetScanLine(dst, y), rows, width);
+		}
+	});
+
+	// copy metadata from src to dst
+	FreeImage_CloneMetadata(dst, channels[0]);
+
+	return dst;
+}
+
+/** @brief Deinterleaves a RGB[A] image into a planar (channel first) buffer, e.g. an input tensor.
+
+The planes are stored one after the other in red, green, blue, alpha order, each plane holds
+FreeImage_GetHeight(dib) rows of 'pitch' bytes. Values keep their type : bytes for 24- and
+32-bit images, 16-bit unsigned integers for FIT_RGB[A]16 and floats for FIT_RGB[A]F.
+@param bits Output buffer of FreeImage_GetChannelsNumber(dib) * height * pitch bytes.
+@param dib Input image to be processed.
+@param pitch Bytes per plane row, 0 for packed rows of width values.
+@param topdown If TRUE, the first row of a plane is the top row of the image, the bottom one otherwise.
+Use FALSE to access the planes through FreeImage_CreatePlanarView.
+@return Returns TRUE if successful, FALSE otherwise.
+@see FreeImage_CreatePlanarView, FreeImage_SplitChannels
+*/
+FIBOOL DLL_CALLCONV
+FreeImage_ConvertToPlanarBits(uint8_t *bits, FIBITMAP *dib, unsigned pitch, FIBOOL topdown) {
+	ChannelLayout layout;
+	if (!bits || !FreeImage_HasPixels(dib) || !GetChannelLayout(dib, layout)) {
+		return FALSE;
+	}
+
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+	if (pitch == 0) {
+		pitch = width * layout.size;
+	}
+	else if (pitch < width * layout.size) {
+		return FALSE;
+	}
+	const size_t plane_size = static_cast<size_t>(height) * pitch;
+
+	ParallelForRows(height, LayoutRowBytes(layout, width), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; y++) {
+			const size_t row_offset = static_cast<size_t>(topdown ? height - 1 - y : y) * pitch;
+			uint8_t *rows[4]{};
+			for (unsigned c = 0; c < layout.channels; c++) {
+				rows[c] = bits + c * plane_size + row_offset;
+			}
+			SplitRow(layout, rows, FreeImage_GetScanLine(dib, y), width);
+		}
+	});
+
+	return TRUE;
+}
+
+/** @brief Wraps the planes of a planar buffer into greyscale images, without copying the pixels.
+
+Each plane of the buffer, laid out as by FreeImage_ConvertToPlanarBits with topdown = FALSE,
+becomes an image of the given type sharing the memory of the buffer : the toolkit functions
+working on greyscale images process the planes in place, and FreeImage_MergeChannels
+interleaves them back. The buffer must outlive the views, which are released by FreeImage_Unload.
+@param bits Planar buffer of count * height * pitch bytes.
+@param type Type of the planes : FIT_BITMAP (8-bit), FIT_UINT16 or FIT_FLOAT.
+@param width Plane width.
+@param height Plane height.
+@param pitch Bytes per plane row, 0 for packed rows of width values.
+@param count Number of planes, up to 4.
+@param planes Output array of count images.
+@return Returns TRUE if successful, FALSE otherwise. On failure, the output array is filled with NULL.
+@see FreeImage_ConvertToPlanarBits, FreeImage_AllocateHeaderForBits
+*/
+FIBOOL DLL_CALLCONV
+FreeImage_CreatePlanarView(uint8_t *bits, FREE_IMAGE_TYPE type, unsigned width, unsigned height, unsigned pitch, unsigned count, FIBITMAP **planes) {
+	const unsigned bpp = GetPlaneBPP(type);
+	if (!bits || !planes || (bpp == 0) || (width == 0) || (height == 0) || (count == 0) || (count > 4)) {
+		return FALSE;
+	}
+	if (pitch == 0) {
+		pitch = width * (bpp / 8);
+	}
+	else if (pitch < width * (bpp / 8)) {
+		return FALSE;
+	}
+	const size_t plane_size = static_cast<size_t>(height) * pitch;
+
+	for (unsigned c = 0; c < count; c++) {
+		planes[c] = FreeImage_AllocateHeaderForBits(bits + c * plane_size, pitch, type, (int)width, (int)height, (int)bpp, 0, 0, 0);
+		if (!planes[c]) {
+			for (unsigned k = 0; k < c; k++) {
+				FreeImage_Unload(planes[k]);
+			}
+			for (unsigned k = 0; k < count; k++) {
+				planes[k] = nullptr;
+			}
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
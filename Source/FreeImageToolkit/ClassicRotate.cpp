@@ -1,5 +1,5 @@
 // ==========================================================
-// Bitmap rotation by means of 3 shears.
+// Bitmap rotation by right angles and by any angle.
 //
 // Design and implementation by
 // - Herve Drolon (drolon@infonie.fr)
@@ -21,417 +21,283 @@
 // Use at your own risk!
 // ==========================================================
 
-/* 
- ============================================================
- References : 
- [1] Paeth A., A Fast Algorithm for General Raster Rotation. 
- Graphics Gems, p. 179, Andrew Glassner editor, Academic Press, 1990. 
- [2] Yariv E., High quality image rotation (rotate by shear). 
- [Online] http://www.codeproject.com/bitmap/rotatebyshear.asp
- [3] Treskunov A., Fast and high quality true-color bitmap rotation function.
- [Online] http://anton.treskunov.net/Software/doc/fast_and_high_quality_true_color_bitmap_rotation_function.html
- ============================================================
-*/
-
 #include "FreeImage.h"
 #include "Utilities.h"
-
-#define RBLOCK		64	// image blocks of RBLOCK*RBLOCK pixels
+#include "FreeImage/ParallelFor.h"
+#include "FreeImage/SimdFloat4.h"
 
+// --------------------------------------------------------------------------
+//  Right angle rotations and transpositions
 // --------------------------------------------------------------------------
 
 /**
-Skews a row horizontally (with filtered weights). 
-Limited to 45 degree skewing only. Filters two adjacent pixels.
-Parameter T can be uint8_t, uint16_t of float. 
-@param src Pointer to source image to rotate
-@param dst Pointer to destination image
-@param row Row index
-@param iOffset Skew offset
-@param dWeight Relative weight of right pixel
-@param bkcolor Background color
+Transpose of a block of Size x Size pixels of P bytes : the pixel k of the row i of the block
+at src goes to the pixel i of the row k of the block at dst.
+The row strides are signed, so that the flips of a rotation only change the addressing of the rows.
 */
-template <class T> void 
-HorizontalSkewT(FIBITMAP *src, FIBITMAP *dst, int row, int iOffset, double weight, const void *bkcolor = nullptr) {
-	int iXPos;
-
-	const unsigned src_width  = FreeImage_GetWidth(src);
-	const unsigned dst_width  = FreeImage_GetWidth(dst);
-
-	T pxlSrc[4], pxlLeft[4], pxlOldLeft[4];	// 4 = 4*sizeof(T) max
-	
-	// background
-	const T pxlBlack[4] = {0, 0, 0, 0 };
-	const T *pxlBkg = static_cast<const T*>(bkcolor); // assume at least bytespp and 4*sizeof(T) max
-	if (!pxlBkg) {
-		// default background color is black
-		pxlBkg = pxlBlack;
+template <unsigned P>
+struct BlockTranspose {
+	static constexpr unsigned Size = (P <= 4) ? 8 : 4;
+
+	static void Run(const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst, ptrdiff_t dst_stride) {
+		for (unsigned k = 0; k < Size; k++) {
+			uint8_t *dst_bits = dst + (ptrdiff_t)k * dst_stride;
+			const uint8_t *src_bits = src + k * P;
+			for (unsigned i = 0; i < Size; i++) {
+				memcpy(dst_bits + i * P, src_bits + (ptrdiff_t)i * src_stride, P);
+			}
+		}
 	}
+};
 
-	// calculate the number of bytes per pixel
-	const unsigned bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
-	// calculate the number of samples per pixel
-	const unsigned samples = bytespp / sizeof(T);
+#ifdef FI_FLOAT4_SSE2
 
-	uint8_t *src_bits = FreeImage_GetScanLine(src, row);
-	uint8_t *dst_bits = FreeImage_GetScanLine(dst, row);
+/** 8 x 8 bytes, transposed in registers by interleaving the rows, then the pairs and the quadruples of rows */
+template <>
+struct BlockTranspose<1> {
+	static constexpr unsigned Size = 8;
 
-	// fill gap left of skew with background
-	if (bkcolor) {
-		for (int k = 0; k < iOffset; k++) {
-			memcpy(&dst_bits[k * bytespp], bkcolor, bytespp);
+	static void Run(const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst, ptrdiff_t dst_stride) {
+		__m128i r[8];
+		for (int i = 0; i < 8; i++) {
+			r[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i * src_stride));
+		}
+		const __m128i a0 = _mm_unpacklo_epi8(r[0], r[1]);
+		const __m128i a1 = _mm_unpacklo_epi8(r[2], r[3]);
+		const __m128i a2 = _mm_unpacklo_epi8(r[4], r[5]);
+		const __m128i a3 = _mm_unpacklo_epi8(r[6], r[7]);
+		const __m128i b0 = _mm_unpacklo_epi16(a0, a1);
+		const __m128i b1 = _mm_unpackhi_epi16(a0, a1);
+		const __m128i b2 = _mm_unpacklo_epi16(a2, a3);
+		const __m128i b3 = _mm_unpackhi_epi16(a2, a3);
+		// columns (0, 1), (2, 3), (4, 5) and (6, 7)
+		const __m128i c[4] = {
+			_mm_unpacklo_epi32(b0, b2), _mm_unpackhi_epi32(b0, b2),
+			_mm_unpacklo_epi32(b1, b3), _mm_unpackhi_epi32(b1, b3)
+		};
+		for (int k = 0; k < 4; k++) {
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (2 * k) * dst_stride), c[k]);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (2 * k + 1) * dst_stride), _mm_unpackhi_epi64(c[k], c[k]));
 		}
-		AssignPixel((uint8_t*)&pxlOldLeft[0], (uint8_t*)bkcolor, bytespp);
-	} else {
-		if (iOffset > 0) {
-			memset(dst_bits, 0, iOffset * bytespp);
-		}		
-		memset(&pxlOldLeft[0], 0, bytespp);
 	}
+};
+
+/** 8 x 8 words, transposed in registers by interleaving the rows, then the pairs and the quadruples of rows */
+template <>
+struct BlockTranspose<2> {
+	static constexpr unsigned Size = 8;
 
-	for (unsigned i = 0; i < src_width; i++) {
-		// loop through row pixels
-		AssignPixel((uint8_t*)&pxlSrc[0], (uint8_t*)src_bits, bytespp);
-		// calculate weights
-		for (unsigned j = 0; j < samples; j++) {
-			pxlLeft[j] = static_cast<T>(pxlBkg[j] + (pxlSrc[j] - pxlBkg[j]) * weight + 0.5);
+	static void Run(const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst, ptrdiff_t dst_stride) {
+		__m128i r[8];
+		for (int i = 0; i < 8; i++) {
+			r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * src_stride));
 		}
-		// check boundaries 
-		iXPos = i + iOffset;
-		if ((iXPos >= 0) && (iXPos < (int)dst_width)) {
-			// update left over on source
-			for (unsigned j = 0; j < samples; j++) {
-				pxlSrc[j] = pxlSrc[j] - (pxlLeft[j] - pxlOldLeft[j]);
-			}
-			AssignPixel((uint8_t*)&dst_bits[iXPos*bytespp], (uint8_t*)&pxlSrc[0], bytespp);
+		__m128i a[8], b[8];
+		for (int i = 0; i < 4; i++) {
+			a[2 * i] = _mm_unpacklo_epi16(r[2 * i], r[2 * i + 1]);
+			a[2 * i + 1] = _mm_unpackhi_epi16(r[2 * i], r[2 * i + 1]);
 		}
-		// save leftover for next pixel in scan
-		AssignPixel((uint8_t*)&pxlOldLeft[0], (uint8_t*)&pxlLeft[0], bytespp);
-
-		// next pixel in scan
-		src_bits += bytespp;
-	}			
-
-	// go to rightmost point of skew
-	iXPos = src_width + iOffset; 
-
-	if ((iXPos >= 0) && (iXPos < (int)dst_width)) {
-		dst_bits = FreeImage_GetScanLine(dst, row) + iXPos * bytespp;
-
-		// If still in image bounds, put leftovers there
-		AssignPixel((uint8_t*)dst_bits, (uint8_t*)&pxlOldLeft[0], bytespp);
-
-		// clear to the right of the skewed line with background
-		dst_bits += bytespp;
-		if (bkcolor) {
-			for (unsigned i = 0; i < dst_width - iXPos - 1; i++) {
-				memcpy(&dst_bits[i * bytespp], bkcolor, bytespp);
-			}
-		} else {
-			memset(dst_bits, 0, bytespp * (dst_width - iXPos - 1));
+		for (int i = 0; i < 2; i++) {
+			// columns (0, 1), (2, 3), (4, 5), (6, 7) of the rows [4i, 4i + 4)
+			b[4 * i] = _mm_unpacklo_epi32(a[4 * i], a[4 * i + 2]);
+			b[4 * i + 1] = _mm_unpackhi_epi32(a[4 * i], a[4 * i + 2]);
+			b[4 * i + 2] = _mm_unpacklo_epi32(a[4 * i + 1], a[4 * i + 3]);
+			b[4 * i + 3] = _mm_unpackhi_epi32(a[4 * i + 1], a[4 * i + 3]);
+		}
+		for (int k = 0; k < 4; k++) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * k) * dst_stride), _mm_unpacklo_epi64(b[k], b[k + 4]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * k + 1) * dst_stride), _mm_unpackhi_epi64(b[k], b[k + 4]));
 		}
-
 	}
-}
+};
 
-/**
-Skews a row horizontally (with filtered weights). 
-Limited to 45 degree skewing only. Filters two adjacent pixels.
-@param src Pointer to source image to rotate
-@param dst Pointer to destination image
-@param row Row index
-@param iOffset Skew offset
-@param dWeight Relative weight of right pixel
-@param bkcolor Background color
-*/
-static void 
-HorizontalSkew(FIBITMAP *src, FIBITMAP *dst, int row, int iOffset, double dWeight, const void *bkcolor) {
-	FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(src);
+/** 4 x 4 double words, transposed in registers */
+template <>
+struct BlockTranspose<4> {
+	static constexpr unsigned Size = 4;
 
-	switch (image_type) {
-		case FIT_BITMAP:
-			switch (FreeImage_GetBPP(src)) {
-				case 8:
-				case 24:
-				case 32:
-					HorizontalSkewT<uint8_t>(src, dst, row, iOffset, dWeight, bkcolor);
-				break;
-			}
-			break;
-		case FIT_UINT16:
-		case FIT_RGB16:
-		case FIT_RGBA16:
-			HorizontalSkewT<uint16_t>(src, dst, row, iOffset, dWeight, bkcolor);
-			break;
-		case FIT_FLOAT:
-		case FIT_RGBF:
-		case FIT_RGBAF:
-			HorizontalSkewT<float>(src, dst, row, iOffset, dWeight, bkcolor);
-			break;
+	static void Run(const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst, ptrdiff_t dst_stride) {
+		const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + src_stride));
+		const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * src_stride));
+		const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * src_stride));
+		const __m128i a0 = _mm_unpacklo_epi32(r0, r1);
+		const __m128i a1 = _mm_unpacklo_epi32(r2, r3);
+		const __m128i a2 = _mm_unpackhi_epi32(r0, r1);
+		const __m128i a3 = _mm_unpackhi_epi32(r2, r3);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi64(a0, a1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + dst_stride), _mm_unpackhi_epi64(a0, a1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * dst_stride), _mm_unpacklo_epi64(a2, a3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * dst_stride), _mm_unpackhi_epi64(a2, a3));
 	}
-}
+};
+
+#endif // FI_FLOAT4_SSE2
 
 /**
-Skews a column vertically (with filtered weights). 
-Limited to 45 degree skewing only. Filters two adjacent pixels.
-Parameter T can be uint8_t, uint16_t of float. 
-@param src Pointer to source image to rotate
-@param dst Pointer to destination image
-@param col Column index
-@param iOffset Skew offset
-@param dWeight Relative weight of upper pixel
-@param bkcolor Background color
+Right angle mapping of the pixels of P bytes of src (src_width x src_height) to dst (src_height x src_width).
+In scanline coordinates, dst(x, y) = src(flip_cols ? src_width - 1 - y : y, flip_rows ? src_height - 1 - x : x).<br>
+The destination is processed by tiles of TileRows rows, in parallel. Inside a tile, the blocks are transposed
+column after column of blocks : the source segments read by a tile hold a whole cache line, the destination
+rows are written sequentially.
 */
-template <class T> void 
-VerticalSkewT(FIBITMAP *src, FIBITMAP *dst, int col, int iOffset, double weight, const void *bkcolor = nullptr) {
-	int iYPos;
-
-	unsigned src_height = FreeImage_GetHeight(src);
-	unsigned dst_height = FreeImage_GetHeight(dst);
-
-	T pxlSrc[4], pxlLeft[4], pxlOldLeft[4];	// 4 = 4*sizeof(T) max
-
-	// background
-	const T pxlBlack[4] = {0, 0, 0, 0 };
-	const T *pxlBkg = static_cast<const T*>(bkcolor); // assume at least bytespp and 4*sizeof(T) max
-	if (!pxlBkg) {
-		// default background color is black
-		pxlBkg = pxlBlack;
-	}
-
-	// calculate the number of bytes per pixel
-	const unsigned bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
-	// calculate the number of samples per pixel
-	const unsigned samples = bytespp / sizeof(T);
-
-	const unsigned src_pitch = FreeImage_GetPitch(src);
-	const unsigned dst_pitch = FreeImage_GetPitch(dst);
-	const unsigned index = col * bytespp;
+template <unsigned P>
+static void
+TransposeTiles(FIBITMAP *src, FIBITMAP *dst, bool flip_rows, bool flip_cols) {
+	using Block = BlockTranspose<P>;
+	constexpr unsigned N = Block::Size;
+	constexpr unsigned TileRows = std::max(4 * N, (64 / P + N - 1) / N * N);
 
-	const uint8_t *src_bits = FreeImage_GetBits(src) + index;
-	uint8_t *dst_bits = FreeImage_GetBits(dst) + index;
-
-	// fill gap above skew with background
-	if (bkcolor) {
-		for (int k = 0; k < iOffset; k++) {
-			memcpy(dst_bits, bkcolor, bytespp);
-			dst_bits += dst_pitch;
-		}
-		memcpy(&pxlOldLeft[0], bkcolor, bytespp);
-	} else {
-		for (int k = 0; k < iOffset; k++) {
-			memset(dst_bits, 0, bytespp);
-			dst_bits += dst_pitch;
-		}
-		memset(&pxlOldLeft[0], 0, bytespp);
-	}
-
-	for (unsigned i = 0; i < src_height; i++) {
-		// loop through column pixels
-		AssignPixel((uint8_t*)(&pxlSrc[0]), src_bits, bytespp);
-		// calculate weights
-		for (unsigned j = 0; j < samples; j++) {
-			pxlLeft[j] = static_cast<T>(pxlBkg[j] + (pxlSrc[j] - pxlBkg[j]) * weight + 0.5);
-		}
-		// check boundaries
-		iYPos = i + iOffset;
-		if ((iYPos >= 0) && (iYPos < (int)dst_height)) {
-			// update left over on source
-			for (unsigned j = 0; j < samples; j++) {
-				pxlSrc[j] = pxlSrc[j] - (pxlLeft[j] - pxlOldLeft[j]);
+	const unsigned src_width  = FreeImage_GetWidth(src);
+	const unsigned src_height = FreeImage_GetHeight(src);
+	const unsigned dst_width  = src_height;
+	const unsigned dst_height = src_width;
+	const ptrdiff_t src_pitch = FreeImage_GetPitch(src);
+	const ptrdiff_t dst_pitch = FreeImage_GetPitch(dst);
+	const uint8_t *src_bits = FreeImage_GetBits(src);
+	uint8_t *dst_bits = FreeImage_GetBits(dst);
+
+	// source pixel of the destination pixel (x, y)
+	auto source = [=](unsigned x, unsigned y) {
+		const unsigned sx = flip_cols ? src_width - 1 - y : y;
+		const unsigned sy = flip_rows ? src_height - 1 - x : x;
+		return src_bits + sy * src_pitch + sx * P;
+	};
+	// source step of the next destination column, destination step of the next source column
+	const ptrdiff_t src_stride = flip_rows ? -src_pitch : src_pitch;
+	const ptrdiff_t dst_stride = flip_cols ? -dst_pitch : dst_pitch;
+
+	const unsigned tile_count = (dst_height + TileRows - 1) / TileRows;
+	ParallelForRows(tile_count, 2 * static_cast<size_t>(TileRows) * dst_width * P, [&](unsigned first_tile, unsigned end_tile) {
+		for (unsigned tile = first_tile; tile < end_tile; tile++) {
+			const unsigned y_first = tile * TileRows;
+			const unsigned y_end = std::min(dst_height, y_first + TileRows);
+			for (unsigned x = 0; x < dst_width; x += N) {
+				const unsigned x_end = std::min(dst_width, x + N);
+				for (unsigned y = y_first; y < y_end; y += N) {
+					if ((x_end - x == N) && (y + N <= y_end)) {
+						// the first source column of the block is the one of its first or last row
+						const unsigned y_block = flip_cols ? y + N - 1 : y;
+						Block::Run(source(x, y_block), src_stride, dst_bits + y_block * dst_pitch + x * P, dst_stride);
+					} else {
+						for (unsigned yy = y; yy < std::min(y_end, y + N); yy++) {
+							uint8_t *dst_line = dst_bits + yy * dst_pitch;
+							for (unsigned xx = x; xx < x_end; xx++) {
+								memcpy(dst_line + xx * P, source(xx, yy), P);
+							}
+						}
+					}
+				}
 			}
-			dst_bits = FreeImage_GetScanLine(dst, iYPos) + index;
-			AssignPixel(dst_bits, (uint8_t*)(&pxlSrc[0]), bytespp);
 		}
-		// save leftover for next pixel in scan
-		AssignPixel((uint8_t*)(&pxlOldLeft[0]), (uint8_t*)(&pxlLeft[0]), bytespp);
-
-		// next pixel in scan
-		src_bits += src_pitch;
-	}
-	// go to bottom point of skew
-	iYPos = src_height + iOffset;
-
-	if ((iYPos >= 0) && (iYPos < (int)dst_height)) {
-		dst_bits = FreeImage_GetScanLine(dst, iYPos) + index;
+	});
+}
 
-		// if still in image bounds, put leftovers there				
-		AssignPixel((uint8_t*)(dst_bits), (uint8_t*)(&pxlOldLeft[0]), bytespp);
+/**
+Right angle mapping of 1-, 2- or 4-bit pixels, see TransposeTiles.
+The destination must be cleared.
+*/
+static void
+TransposeBits(FIBITMAP *src, FIBITMAP *dst, bool flip_rows, bool flip_cols) {
+	constexpr unsigned TileRows = 64;
+	constexpr unsigned TileColumns = 64;
 
-		// clear below skewed line with background
-		if (bkcolor) {
-			while (++iYPos < (int)dst_height) {					
-				dst_bits += dst_pitch;
-				AssignPixel((uint8_t*)(dst_bits), (uint8_t*)(bkcolor), bytespp);
-			}
-		} else {
-			while (++iYPos < (int)dst_height) {					
-				dst_bits += dst_pitch;
-				memset(dst_bits, 0, bytespp);
+	const unsigned bpp = FreeImage_GetBPP(src);
+	const unsigned mask = (1U << bpp) - 1;
+	const unsigned src_width  = FreeImage_GetWidth(src);
+	const unsigned src_height = FreeImage_GetHeight(src);
+	const unsigned dst_width  = src_height;
+	const unsigned dst_height = src_width;
+	const ptrdiff_t src_pitch = FreeImage_GetPitch(src);
+	const ptrdiff_t dst_pitch = FreeImage_GetPitch(dst);
+	const uint8_t *src_bits = FreeImage_GetBits(src);
+	uint8_t *dst_bits = FreeImage_GetBits(dst);
+
+	const unsigned tile_count = (dst_height + TileRows - 1) / TileRows;
+	ParallelForRows(tile_count, 2 * static_cast<size_t>(TileRows) * FreeImage_GetLine(dst), [&](unsigned first_tile, unsigned end_tile) {
+		for (unsigned tile = first_tile; tile < end_tile; tile++) {
+			const unsigned y_first = tile * TileRows;
+			const unsigned y_end = std::min(dst_height, y_first + TileRows);
+			for (unsigned x_first = 0; x_first < dst_width; x_first += TileColumns) {
+				const unsigned x_end = std::min(dst_width, x_first + TileColumns);
+				for (unsigned y = y_first; y < y_end; y++) {
+					const unsigned src_bit = (flip_cols ? src_width - 1 - y : y) * bpp;
+					const unsigned src_shift = 8 - bpp - (src_bit & 7);
+					const uint8_t *src_column = src_bits + (src_bit >> 3);
+					uint8_t *dst_line = dst_bits + y * dst_pitch;
+					for (unsigned x = x_first; x < x_end; x++) {
+						const unsigned sy = flip_rows ? src_height - 1 - x : x;
+						const unsigned value = (src_column[sy * src_pitch] >> src_shift) & mask;
+						const unsigned dst_bit = x * bpp;
+						dst_line[dst_bit >> 3] |= (uint8_t)(value << (8 - bpp - (dst_bit & 7)));
+					}
+				}
 			}
 		}
-	}
+	});
 }
 
 /**
-Skews a column vertically (with filtered weights). 
-Limited to 45 degree skewing only. Filters two adjacent pixels.
-@param src Pointer to source image to rotate
-@param dst Pointer to destination image
-@param col Column index
-@param iOffset Skew offset
-@param dWeight Relative weight of upper pixel
-@param bkcolor Background color
+Right angle mapping of an image of any type to a new image, see TransposeTiles.
+Only the pixels are copied.
+@return Returns a pointer to a newly allocated image if successful, returns NULL otherwise
 */
-static void 
-VerticalSkew(FIBITMAP *src, FIBITMAP *dst, int col, int iOffset, double dWeight, const void *bkcolor) {
-	FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(src);
+static FIBITMAP*
+RotateRightAngle(FIBITMAP *src, bool flip_rows, bool flip_cols) {
+	const unsigned bpp = FreeImage_GetBPP(src);
 
-	switch (image_type) {
-		case FIT_BITMAP:
-			switch (FreeImage_GetBPP(src)) {
-				case 8:
-				case 24:
-				case 32:
-					VerticalSkewT<uint8_t>(src, dst, col, iOffset, dWeight, bkcolor);
-					break;
-			}
+	FIBITMAP *dst = FreeImage_AllocateT(FreeImage_GetImageType(src), FreeImage_GetHeight(src), FreeImage_GetWidth(src), bpp,
+		FreeImage_GetRedMask(src), FreeImage_GetGreenMask(src), FreeImage_GetBlueMask(src));
+	if (!dst) return nullptr;
+
+	switch (bpp) {
+		case 1:
+		case 2:
+		case 4:
+			TransposeBits(src, dst, flip_rows, flip_cols);
 			break;
-		case FIT_UINT16:
-		case FIT_RGB16:
-		case FIT_RGBA16:
-			VerticalSkewT<uint16_t>(src, dst, col, iOffset, dWeight, bkcolor);
+		case 8:
+			TransposeTiles<1>(src, dst, flip_rows, flip_cols);
 			break;
-		case FIT_FLOAT:
-		case FIT_RGBF:
-		case FIT_RGBAF:
-			VerticalSkewT<float>(src, dst, col, iOffset, dWeight, bkcolor);
+		case 16:
+			TransposeTiles<2>(src, dst, flip_rows, flip_cols);
+			break;
+		case 24:
+			TransposeTiles<3>(src, dst, flip_rows, flip_cols);
+			break;
+		case 32:
+			TransposeTiles<4>(src, dst, flip_rows, flip_cols);
+			break;
+		case 48:
+			TransposeTiles<6>(src, dst, flip_rows, flip_cols);
+			break;
+		case 64:
+			TransposeTiles<8>(src, dst, flip_rows, flip_cols);
+			break;
+		case 96:
+			TransposeTiles<12>(src, dst, flip_rows, flip_cols);
+			break;
+		case 128:
+			TransposeTiles<16>(src, dst, flip_rows, flip_cols);
 			break;
+		default:
+			FreeImage_Unload(dst);
+			return nullptr;
 	}
-} 
+
+	return dst;
+}
 
 /**
 Rotates an image by 90 degrees (counter clockwise). 
-Precise rotation, no filters required.<br>
-Code adapted from CxImage (http://www.xdp.it/cximage.htm)
+Precise rotation, no filters required.
 @param src Pointer to source image to rotate
 @return Returns a pointer to a newly allocated rotated image if successful, returns NULL otherwise
 */
 static FIBITMAP* 
 Rotate90(FIBITMAP *src) {
-
-	const unsigned bpp = FreeImage_GetBPP(src);
-
-	const unsigned src_width  = FreeImage_GetWidth(src);
-	const unsigned src_height = FreeImage_GetHeight(src);	
-	const unsigned dst_width  = src_height;
-	const unsigned dst_height = src_width;
-
-	FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(src);
-
-	// allocate and clear dst image
-	FIBITMAP *dst = FreeImage_AllocateT(image_type, dst_width, dst_height, bpp);
-	if (!dst) return nullptr;
-
-	// get src and dst scan width
-	const unsigned src_pitch  = FreeImage_GetPitch(src);
-	const unsigned dst_pitch  = FreeImage_GetPitch(dst);
-
-	switch (image_type) {
-		case FIT_BITMAP:
-			if (bpp == 1) {
-				// speedy rotate for BW images
-
-				const uint8_t *bsrc  = FreeImage_GetBits(src);
-				uint8_t *bdest = FreeImage_GetBits(dst);
-
-				const uint8_t *dbitsmax = bdest + dst_height * dst_pitch - 1;
-
-				for (unsigned y = 0; y < src_height; y++) {
-					// figure out the column we are going to be copying to
-					const div_t div_r = div(y, 8);
-					// set bit pos of src column byte
-					const uint8_t bitpos = (uint8_t)(128 >> div_r.rem);
-					const uint8_t *srcdisp = bsrc + y * src_pitch;
-					for (unsigned x = 0; x < src_pitch; x++) {
-						// get source bits
-						const uint8_t *sbits = srcdisp + x;
-						// get destination column
-						uint8_t *nrow = bdest + (dst_height - 1 - (x * 8)) * dst_pitch + div_r.quot;
-						for (int z = 0; z < 8; z++) {
-						   // get destination byte
-							uint8_t *dbits = nrow - z * dst_pitch;
-							if ((dbits < bdest) || (dbits > dbitsmax)) break;
-							if (*sbits & (128 >> z)) *dbits |= bitpos;
-						}
-					}
-				}
-			}
-			else if ((bpp == 8) || (bpp == 24) || (bpp == 32)) {
-				// anything other than BW :
-				// This optimized version of rotation rotates image by smaller blocks. It is quite
-				// a bit faster than obvious algorithm, because it produces much less CPU cache misses.
-				// This optimization can be tuned by changing block size (RBLOCK). 96 is good value for current
-				// CPUs (tested on Athlon XP and Celeron D). Larger value (if CPU has enough cache) will increase
-				// speed somehow, but once you drop out of CPU's cache, things will slow down drastically.
-				// For older CPUs with less cache, lower value would yield better results.
-
-				const uint8_t *bsrc  = FreeImage_GetBits(src);  // source pixels
-				uint8_t *bdest = FreeImage_GetBits(dst);  // destination pixels
-
-				// calculate the number of bytes per pixel (1 for 8-bit, 3 for 24-bit or 4 for 32-bit)
-				const unsigned bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
-				
-				// for all image blocks of RBLOCK*RBLOCK pixels
-				
-				// x-segment
-				for (unsigned xs = 0; xs < dst_width; xs += RBLOCK) {
-					// y-segment
-					for (unsigned ys = 0; ys < dst_height; ys += RBLOCK) {
-						for (unsigned y = ys; y < std::min(dst_height, ys + RBLOCK); y++) {    // do rotation
-							const unsigned y2 = dst_height - y - 1;
-							// point to src pixel at (y2, xs)
-							const uint8_t *src_bits = bsrc + (xs * src_pitch) + (y2 * bytespp);
-							// point to dst pixel at (xs, y)
-							uint8_t *dst_bits = bdest + (y * dst_pitch) + (xs * bytespp);
-							for (unsigned x = xs; x < std::min(dst_width, xs + RBLOCK); x++) {
-								// dst.SetPixel(x, y, src.GetPixel(y2, x));
-								AssignPixel(dst_bits, src_bits, bytespp);
-								dst_bits += bytespp;
-								src_bits += src_pitch;
-							}
-						}
-					}
-				}
-			}
-			break;
-		case FIT_UINT16:
-		case FIT_RGB16:
-		case FIT_RGBA16:
-		case FIT_FLOAT:
-		case FIT_RGBF:
-		case FIT_RGBAF:
-		{
-			const uint8_t *bsrc  = FreeImage_GetBits(src);  // source pixels
-			uint8_t *bdest = FreeImage_GetBits(dst);  // destination pixels
-
-			// calculate the number of bytes per pixel
-			const unsigned bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
-
-			for (unsigned y = 0; y < dst_height; y++) {
-				const uint8_t *src_bits = bsrc + (src_width - 1 - y) * bytespp;
-				uint8_t *dst_bits = bdest + (y * dst_pitch);
-				for (unsigned x = 0; x < dst_width; x++) {
-					AssignPixel(dst_bits, src_bits, bytespp);
-					src_bits += src_pitch;
-					dst_bits += bytespp;
-				}
-			}
-		}
-		break;
-	}
-
-	return dst;
+	// dst(x, y) = src(src_width - 1 - y, x)
+	return RotateRightAngle(src, false, true);
 }
 
 /**
@@ -442,8 +308,6 @@ Precise rotation, no filters required.
 */
 static FIBITMAP* 
 Rotate180(FIBITMAP *src) {
-	int x, y, k, pos;
-
 	const int bpp = FreeImage_GetBPP(src);
 
 	const int src_width  = FreeImage_GetWidth(src);
@@ -456,20 +320,25 @@ Rotate180(FIBITMAP *src) {
 	FIBITMAP *dst = FreeImage_AllocateT(image_type, dst_width, dst_height, bpp);
 	if (!dst) return nullptr;
 
+	// every band of rows writes its own rows of dst
+	const size_t row_bytes = 2 * static_cast<size_t>(FreeImage_GetLine(src));
+
 	switch (image_type) {
 		case FIT_BITMAP:
 			if (bpp == 1) {
-				for (int y = 0; y < src_height; y++) {
-					const uint8_t *src_bits = FreeImage_GetScanLine(src, y);
-					uint8_t *dst_bits = FreeImage_GetScanLine(dst, dst_height - y - 1);
-					for (int x = 0; x < src_width; x++) {
-						// get bit at (x, y)
-						k = (src_bits[x >> 3] & (0x80 >> (x & 0x07))) != 0;
-						// set bit at (dst_width - x - 1, dst_height - y - 1)
-						pos = dst_width - x - 1;
-						k ? dst_bits[pos >> 3] |= (0x80 >> (pos & 0x7)) : dst_bits[pos >> 3] &= (0xFF7F >> (pos & 0x7));
+				ParallelForRows(src_height, row_bytes, [&](unsigned first_row, unsigned end_row) {
+					for (int y = first_row; y < (int)end_row; y++) {
+						const uint8_t *src_bits = FreeImage_GetScanLine(src, y);
+						uint8_t *dst_bits = FreeImage_GetScanLine(dst, dst_height - y - 1);
+						for (int x = 0; x < src_width; x++) {
+							// get bit at (x, y)
+							const int k = (src_bits[x >> 3] & (0x80 >> (x & 0x07))) != 0;
+							// set bit at (dst_width - x - 1, dst_height - y - 1)
+							const int pos = dst_width - x - 1;
+							k ? dst_bits[pos >> 3] |= (0x80 >> (pos & 0x7)) : dst_bits[pos >> 3] &= (0xFF7F >> (pos & 0x7));
+						}
 					}
-				}
+				});
 				break;
 			}
 			// else if ((bpp == 8) || (bpp == 24) || (bpp == 32)) FALL TROUGH
@@ -483,17 +352,19 @@ Rotate180(FIBITMAP *src) {
 			 // Calculate the number of bytes per pixel
 			const int bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
 
-			for (y = 0; y < src_height; y++) {
-				const uint8_t *src_bits = FreeImage_GetScanLine(src, y);
-				uint8_t *dst_bits = FreeImage_GetScanLine(dst, dst_height - y - 1) + (dst_width - 1) * bytespp;
-				for (x = 0; x < src_width; x++) {
-					// get pixel at (x, y)
-					// set pixel at (dst_width - x - 1, dst_height - y - 1)
-					AssignPixel(dst_bits, src_bits, bytespp);
-					src_bits += bytespp;
-					dst_bits -= bytespp;
+			ParallelForRows(src_height, row_bytes, [&](unsigned first_row, unsigned end_row) {
+				for (int y = first_row; y < (int)end_row; y++) {
+					const uint8_t *src_bits = FreeImage_GetScanLine(src, y);
+					uint8_t *dst_bits = FreeImage_GetScanLine(dst, dst_height - y - 1) + (dst_width - 1) * bytespp;
+					for (int x = 0; x < src_width; x++) {
+						// get pixel at (x, y)
+						// set pixel at (dst_width - x - 1, dst_height - y - 1)
+						AssignPixel(dst_bits, src_bits, bytespp);
+						src_bits += bytespp;
+						dst_bits -= bytespp;
+					}
 				}
-			}
+			});
 		}
 		break;
 	}
@@ -503,250 +374,53 @@ Rotate180(FIBITMAP *src) {
 
 /**
 Rotates an image by 270 degrees (counter clockwise). 
-Precise rotation, no filters required.<br>
-Code adapted from CxImage (http://www.xdp.it/cximage.htm)
+Precise rotation, no filters required.
 @param src Pointer to source image to rotate
 @return Returns a pointer to a newly allocated rotated image if successful, returns NULL otherwise
 */
 static FIBITMAP* 
 Rotate270(FIBITMAP *src) {
-	int x2, dlineup;
-
-	const unsigned bpp = FreeImage_GetBPP(src);
-
-	const unsigned src_width  = FreeImage_GetWidth(src);
-	const unsigned src_height = FreeImage_GetHeight(src);	
-	const unsigned dst_width  = src_height;
-	const unsigned dst_height = src_width;
-
-	FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(src);
-
-	// allocate and clear dst image
-	FIBITMAP *dst = FreeImage_AllocateT(image_type, dst_width, dst_height, bpp);
-	if (!dst) return nullptr;
-
-	// get src and dst scan width
-	const unsigned src_pitch  = FreeImage_GetPitch(src);
-	const unsigned dst_pitch  = FreeImage_GetPitch(dst);
-	
-	switch (image_type) {
-		case FIT_BITMAP:
-			if (bpp == 1) {
-				// speedy rotate for BW images
-				
-				const uint8_t *bsrc  = FreeImage_GetBits(src);
-				uint8_t *bdest = FreeImage_GetBits(dst);
-				const uint8_t *dbitsmax = bdest + dst_height * dst_pitch - 1;
-				dlineup = 8 * dst_pitch - dst_width;
-
-				for (unsigned y = 0; y < src_height; y++) {
-					// figure out the column we are going to be copying to
-					const div_t div_r = div(y + dlineup, 8);
-					// set bit pos of src column byte
-					const uint8_t bitpos = (uint8_t)(1 << div_r.rem);
-					const uint8_t *srcdisp = bsrc + y * src_pitch;
-					for (unsigned x = 0; x < src_pitch; x++) {
-						// get source bits
-						const uint8_t *sbits = srcdisp + x;
-						// get destination column
-						uint8_t *nrow = bdest + (x * 8) * dst_pitch + dst_pitch - 1 - div_r.quot;
-						for (unsigned z = 0; z < 8; z++) {
-						   // get destination byte
-							uint8_t *dbits = nrow + z * dst_pitch;
-							if ((dbits < bdest) || (dbits > dbitsmax)) break;
-							if (*sbits & (128 >> z)) *dbits |= bitpos;
-						}
-					}
-				}
-			} 
-			else if ((bpp == 8) || (bpp == 24) || (bpp == 32)) {
-				// anything other than BW :
-				// This optimized version of rotation rotates image by smaller blocks. It is quite
-				// a bit faster than obvious algorithm, because it produces much less CPU cache misses.
-				// This optimization can be tuned by changing block size (RBLOCK). 96 is good value for current
-				// CPUs (tested on Athlon XP and Celeron D). Larger value (if CPU has enough cache) will increase
-				// speed somehow, but once you drop out of CPU's cache, things will slow down drastically.
-				// For older CPUs with less cache, lower value would yield better results.
-
-				const uint8_t *bsrc  = FreeImage_GetBits(src);  // source pixels
-				uint8_t *bdest = FreeImage_GetBits(dst);  // destination pixels
-
-				// Calculate the number of bytes per pixel (1 for 8-bit, 3 for 24-bit or 4 for 32-bit)
-				const unsigned bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
-
-				// for all image blocks of RBLOCK*RBLOCK pixels
-
-				// x-segment
-				for (unsigned xs = 0; xs < dst_width; xs += RBLOCK) {
-					// y-segment
-					for (unsigned ys = 0; ys < dst_height; ys += RBLOCK) {
-						for (unsigned x = xs; x < std::min(dst_width, xs + RBLOCK); x++) {    // do rotation
-							x2 = dst_width - x - 1;
-							// point to src pixel at (ys, x2)
-							const uint8_t *src_bits = bsrc + (x2 * src_pitch) + (ys * bytespp);
-							// point to dst pixel at (x, ys)
-							uint8_t *dst_bits = bdest + (ys * dst_pitch) + (x * bytespp);
-							for (unsigned y = ys; y < std::min(dst_height, ys + RBLOCK); y++) {
-								// dst.SetPixel(x, y, src.GetPixel(y, x2));
-								AssignPixel(dst_bits, src_bits, bytespp);
-								src_bits += bytespp;
-								dst_bits += dst_pitch;
-							}
-						}
-					}
-				}
-			}
-			break;
-		case FIT_UINT16:
-		case FIT_RGB16:
-		case FIT_RGBA16:
-		case FIT_FLOAT:
-		case FIT_RGBF:
-		case FIT_RGBAF:
-		{
-			const uint8_t *bsrc  = FreeImage_GetBits(src);  // source pixels
-			uint8_t *bdest = FreeImage_GetBits(dst);  // destination pixels
-
-			// calculate the number of bytes per pixel
-			const unsigned bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
-
-			for (unsigned y = 0; y < dst_height; y++) {
-				const uint8_t *src_bits = bsrc + (src_height - 1) * src_pitch + y * bytespp;
-				uint8_t *dst_bits = bdest + (y * dst_pitch);
-				for (unsigned x = 0; x < dst_width; x++) {
-					AssignPixel(dst_bits, src_bits, bytespp);
-					src_bits -= src_pitch;
-					dst_bits += bytespp;
-				}
-			}
-		}
-		break;
-	}
-
-	return dst;
+	// dst(x, y) = src(y, src_height - 1 - x)
+	return RotateRightAngle(src, true, false);
 }
 
 /**
-Rotates an image by a given degree in range [-45 .. +45] (counter clockwise) 
-using the 3-shear technique.
+Rotates an image by a given angle (counter clockwise, in scanline coordinates), around its center.
+The destination is large enough to hold the whole rotated image, the uncovered pixels get the background color.
+Every pixel is interpolated in a single pass (bilinear), see FreeImage_WarpAffine.
 @param src Pointer to source image to rotate
-@param dAngle Rotation angle
+@param dAngle Rotation angle, in degrees
+@param bkcolor Background color, NULL for black
 @return Returns a pointer to a newly allocated rotated image if successful, returns NULL otherwise
 */
-static FIBITMAP* 
-Rotate45(FIBITMAP *src, double dAngle, const void *bkcolor) {
+static FIBITMAP*
+RotateFree(FIBITMAP *src, double dAngle, const void *bkcolor) {
 	const double ROTATE_PI = double(3.1415926535897932384626433832795);
 
-	unsigned u;
-
-	const unsigned bpp = FreeImage_GetBPP(src);
-
 	const double dRadAngle = dAngle * ROTATE_PI / double(180); // Angle in radians
-	const double dSinE = sin(dRadAngle);
-	const double dTan = tan(dRadAngle / 2);
+	const double dSin = sin(dRadAngle);
+	const double dCos = cos(dRadAngle);
 
 	const unsigned src_width  = FreeImage_GetWidth(src);
 	const unsigned src_height = FreeImage_GetHeight(src);
-
-	FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(src);
-
-	// Calc first shear (horizontal) destination image dimensions 
-	const unsigned width_1  = src_width + unsigned((double)src_height * fabs(dTan) + 0.5);
-	const unsigned height_1 = src_height; 
-
-	// Perform 1st shear (horizontal)
-	// ----------------------------------------------------------------------
-
-	// Allocate image for 1st shear
-	FIBITMAP *dst1 = FreeImage_AllocateT(image_type, width_1, height_1, bpp);
-	if (!dst1) {
-		return nullptr;
-	}
-	
-	for (u = 0; u < height_1; u++) {  
-		double dShear;
-
-		if (dTan >= 0)	{
-			// Positive angle
-			dShear = (u + 0.5) * dTan;
-		}
-		else {
-			// Negative angle
-			dShear = (double(u) - height_1 + 0.5) * dTan;
-		}
-		int iShear = int(floor(dShear));
-		HorizontalSkew(src, dst1, u, iShear, dShear - double(iShear), bkcolor);
-	}
-
-	// Perform 2nd shear  (vertical)
-	// ----------------------------------------------------------------------
-
-	// Calc 2nd shear (vertical) destination image dimensions
-	const unsigned width_2  = width_1;
-	unsigned height_2 = unsigned((double)src_width * fabs(dSinE) + (double)src_height * cos(dRadAngle) + 0.5) + 1;
-
-	// Allocate image for 2nd shear
-	FIBITMAP *dst2 = FreeImage_AllocateT(image_type, width_2, height_2, bpp);
-	if (!dst2) {
-		FreeImage_Unload(dst1);
-		return nullptr;
-	}
-
-	double dOffset;     // Variable skew offset
-	if (dSinE > 0)	{   
-		// Positive angle
-		dOffset = (src_width - 1.0) * dSinE;
-	}
-	else {
-		// Negative angle
-		dOffset = -dSinE * (double(src_width) - width_2);
-	}
-
-	for (u = 0; u < width_2; u++, dOffset -= dSinE) {
-		int iShear = int(floor(dOffset));
-		VerticalSkew(dst1, dst2, u, iShear, dOffset - double(iShear), bkcolor);
-	}
-
-	// Perform 3rd shear (horizontal)
-	// ----------------------------------------------------------------------
-
-	// Free result of 1st shear
-	FreeImage_Unload(dst1);
-
-	// Calc 3rd shear (horizontal) destination image dimensions
-	const unsigned width_3  = unsigned(double(src_height) * fabs(dSinE) + double(src_width) * cos(dRadAngle) + 0.5) + 1;
-	const unsigned height_3 = height_2;
-
-	// Allocate image for 3rd shear
-	FIBITMAP *dst3 = FreeImage_AllocateT(image_type, width_3, height_3, bpp);
-	if (!dst3) {
-		FreeImage_Unload(dst2);
-		return nullptr;
-	}
-
-	if (dSinE >= 0) {
-		// Positive angle
-		dOffset = (src_width - 1.0) * dSinE * -dTan;
-	}
-	else {
-		// Negative angle
-		dOffset = dTan * ( (src_width - 1.0) * -dSinE + (1.0 - height_3) );
-	}
-	for (u = 0; u < height_3; u++, dOffset += dTan) {
-		int iShear = int(floor(dOffset));
-		HorizontalSkew(dst2, dst3, u, iShear, dOffset - double(iShear), bkcolor);
-	}
-	// Free result of 2nd shear    
-	FreeImage_Unload(dst2);
-
-	// Return result of 3rd shear
-	return dst3;      
+	const unsigned dst_width  = unsigned(double(src_height) * fabs(dSin) + double(src_width) * fabs(dCos) + 0.5) + 1;
+	const unsigned dst_height = unsigned(double(src_width) * fabs(dSin) + double(src_height) * fabs(dCos) + 0.5) + 1;
+
+	// the angle is counter clockwise with y upwards, the warp matrix uses y downwards
+	const double src_cx = (src_width - 1.0) / 2, src_cy = (src_height - 1.0) / 2;
+	const double dst_cx = (dst_width - 1.0) / 2, dst_cy = (dst_height - 1.0) / 2;
+	const double matrix[6] = {
+		dCos, -dSin, dst_cx - (dCos * src_cx - dSin * src_cy),
+		dSin, dCos, dst_cy - (dSin * src_cx + dCos * src_cy)
+	};
+
+	return FreeImage_WarpAffine(src, matrix, dst_width, dst_height, FILTER_BILINEAR, FIBM_ZERO, bkcolor);
 }
 
 /**
 Rotates a 1-, 8-, 24- or 32-bit image by a given angle (given in degree). 
 Angle is unlimited, except for 1-bit images (limited to integer multiples of 90 degree). 
-3-shears technique is used.
+Integer multiples of 90 degree are exact, other angles are interpolated.
 @param src Pointer to source image to rotate
 @param dAngle Rotation angle
 @return Returns a pointer to a newly allocated rotated image if successful, returns NULL otherwise
@@ -757,8 +431,6 @@ RotateAny(FIBITMAP *src, double dAngle, const void *bkcolor) {
 		return nullptr;
 	}
 
-	FIBITMAP *image = src;
-
 	while (dAngle >= 360) {
 		// Bring angle to range of (-INF .. 360)
 		dAngle -= 360;
@@ -767,58 +439,21 @@ RotateAny(FIBITMAP *src, double dAngle, const void *bkcolor) {
 		// Bring angle to range of [0 .. 360) 
 		dAngle += 360;
 	}
-	if ((dAngle > 45) && (dAngle <= 135)) {
-		// Angle in (45 .. 135] 
-		// Rotate image by 90 degrees into temporary image,
-		// so it requires only an extra rotation angle 
-		// of -45 .. +45 to complete rotation.
-		image = Rotate90(src);
-		dAngle -= 90;
-	}
-	else if ((dAngle > 135) && (dAngle <= 225)) { 
-		// Angle in (135 .. 225] 
-		// Rotate image by 180 degrees into temporary image,
-		// so it requires only an extra rotation angle 
-		// of -45 .. +45 to complete rotation.
-		image = Rotate180(src);
-		dAngle -= 180;
-	}
-	else if ((dAngle > 225) && (dAngle <= 315)) { 
-		// Angle in (225 .. 315] 
-		// Rotate image by 270 degrees into temporary image,
-		// so it requires only an extra rotation angle 
-		// of -45 .. +45 to complete rotation.
-		image = Rotate270(src);
-		dAngle -= 270;
-	}
-
-	// If we got here, angle is in (-45 .. +45]
-
-	if (!image)	{
-		// Failed to allocate middle image
-		return nullptr;
-	}
 
 	if (0 == dAngle) {
-		if (image == src) {
-			// Nothing to do ...
-			return FreeImage_Clone(src);
-		} else {
-			// No more rotation needed
-			return image;
-		}
+		// Nothing to do ...
+		return FreeImage_Clone(src);
 	}
-	else {
-		// Perform last rotation
-		FIBITMAP *dst = Rotate45(image, dAngle, bkcolor);
-
-		if (src != image) {
-			// Middle image was required, free it now.
-			FreeImage_Unload(image);
-		}
-
-		return dst;
+	if (90 == dAngle) {
+		return Rotate90(src);
+	}
+	if (180 == dAngle) {
+		return Rotate180(src);
+	}
+	if (270 == dAngle) {
+		return Rotate270(src);
 	}
+	return RotateFree(src, dAngle, bkcolor);
 }
 
 // ==========================================================
@@ -915,3 +550,104 @@ FreeImage_Rotate(FIBITMAP *dib, double angle, const void *bkcolor) {
 	return nullptr;
 }
 
+/**
+Image translation and rotation, the destination has the size of the source.
+The destination pixel (x, y) is interpolated at the source position origin + R(angle) * ((x, y) - shift - origin),
+in pixels from the center of the top-left pixel, y downwards. Every pixel is interpolated in a single pass
+with a Catmull-Rom cubic, see FreeImage_WarpAffine for the supported images.
+@param dib Source image
+@param angle Rotation angle, in degrees
+@param x_shift Horizontal shift of the destination
+@param y_shift Vertical shift of the destination
+@param x_origin Horizontal position of the center of rotation
+@param y_origin Vertical position of the center of rotation
+@param use_mask If TRUE, the pixels mapped from outside of the source are black, otherwise the source is mirrored at its edges
+@return Returns the translated and rotated image if successful, returns NULL otherwise
+*/
+FIBITMAP * DLL_CALLCONV 
+FreeImage_RotateEx(FIBITMAP *dib, double angle, double x_shift, double y_shift, double x_origin, double y_origin, FIBOOL use_mask) {
+	if (!FreeImage_HasPixels(dib)) return nullptr;
+
+	const double ROTATE_PI = double(3.1415926535897932384626433832795);
+
+	const double dRadAngle = angle * ROTATE_PI / double(180); // Angle in radians
+	const double dSin = sin(dRadAngle);
+	const double dCos = cos(dRadAngle);
+
+	// forward mapping : dst = transpose(R) * (src - origin) + origin + shift
+	const double matrix[6] = {
+		dCos, dSin, x_origin + x_shift - (dCos * x_origin + dSin * y_origin),
+		-dSin, dCos, y_origin + y_shift - (dCos * y_origin - dSin * x_origin)
+	};
+
+	return FreeImage_WarpAffine(dib, matrix, FreeImage_GetWidth(dib), FreeImage_GetHeight(dib), FILTER_CATMULLROM, use_mask ? FIBM_ZERO : FIBM_MIRROR, nullptr);
+}
+
+
+// ==========================================================
+
+/**
+Copy the palette, transparency, background color, ICC profile and metadata of src
+to its right angle mapping dst. The horizontal and vertical resolutions are swapped.
+*/
+static void
+CloneRightAngleProperties(FIBITMAP *dst, FIBITMAP *src) {
+	if (const FIRGBA8 *src_pal = FreeImage_GetPalette(src)) {
+		memcpy(FreeImage_GetPalette(dst), src_pal, FreeImage_GetColorsUsed(src) * sizeof(FIRGBA8));
+	}
+	if (FreeImage_GetTransparencyCount(src) > 0) {
+		FreeImage_SetTransparencyTable(dst, FreeImage_GetTransparencyTable(src), FreeImage_GetTransparencyCount(src));
+	}
+	FIRGBA8 bkcolor;
+	if (FreeImage_GetBackgroundColor(src, &bkcolor)) {
+		FreeImage_SetBackgroundColor(dst, &bkcolor);
+	}
+	const FIICCPROFILE *icc = FreeImage_GetICCProfile(src);
+	if (icc && icc->data && (icc->size > 0)) {
+		FreeImage_CreateICCProfile(dst, icc->data, icc->size);
+	}
+
+	FreeImage_CloneMetadata(dst, src);
+	FreeImage_SetDotsPerMeterX(dst, FreeImage_GetDotsPerMeterY(src));
+	FreeImage_SetDotsPerMeterY(dst, FreeImage_GetDotsPerMeterX(src));
+}
+
+/**
+Transposes an image : mirror about the diagonal going from the top-left to the bottom-right corner,
+the row r of the result is the column r of the source. This undoes the Exif orientation 5.<br>
+Any image type and bit depth is supported. The blocks of pixels are transposed in registers
+and the image is processed by tiles, in parallel.
+@param dib Source image
+@return Returns a pointer to a newly allocated image of height x width pixels if successful, returns NULL otherwise
+@see FreeImage_Transverse
+*/
+FIBITMAP *DLL_CALLCONV 
+FreeImage_Transpose(FIBITMAP *dib) {
+	if (!FreeImage_HasPixels(dib)) return nullptr;
+
+	// scanlines are stored bottom-up : dst(x, y) = src(src_width - 1 - y, src_height - 1 - x)
+	FIBITMAP *dst = RotateRightAngle(dib, true, true);
+	if (dst) {
+		CloneRightAngleProperties(dst, dib);
+	}
+	return dst;
+}
+
+/**
+Transverses an image : mirror about the diagonal going from the top-right to the bottom-left corner,
+i.e. a rotation by 180 degrees of the transpose. This undoes the Exif orientation 7.
+@param dib Source image
+@return Returns a pointer to a newly allocated image of height x width pixels if successful, returns NULL otherwise
+@see FreeImage_Transpose
+*/
+FIBITMAP *DLL_CALLCONV 
+FreeImage_Transverse(FIBITMAP *dib) {
+	if (!FreeImage_HasPixels(dib)) return nullptr;
+
+	// scanlines are stored bottom-up : dst(x, y) = src(y, x)
+	FIBITMAP *dst = RotateRightAngle(dib, false, false);
+	if (dst) {
+		CloneRightAngleProperties(dst, dib);
+	}
+	return dst;
+}
@@ -23,8 +23,14 @@
 
 #include "FreeImage.h"
 #include "Utilities.h"
+#include <array>
 #include <complex>
 #include <cstring>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include "../FreeImage/SimpleTools.h"
 
 // ----------------------------------------------------------
@@ -133,6 +139,174 @@ FreeImage_Invert(FIBITMAP *src) {
 	return TRUE;
 }
 
+namespace
+{
+	/** Value k of a pixel after the lookup tables of Mask_ (bit k for the value k) */
+	template <unsigned Mask_, unsigned K_, typename Value_>
+	inline Value_
+	CurveValue(const Value_ *lut, Value_ value) {
+		if constexpr (((Mask_ >> K_) & 1) != 0) {
+			return lut[value];
+		}
+		else {
+			return value;
+		}
+	}
+
+	template <unsigned Mask_, unsigned K_, typename Value_>
+	inline void
+	StoreCurveValue(Value_ *bits, Value_ value) {
+		if constexpr (((Mask_ >> K_) & 1) != 0) {
+			bits[K_] = value;
+		}
+	}
+
+	/**
+	Apply the lookup tables of the values in Mask_ to a row of pixels of sizeof...(K_) values.
+	The pack expansions give constant offsets to every value, which keeps the tables in registers
+	and lets the lookups of a pixel be scheduled independently of its stores.
+	*/
+	template <typename Value_, unsigned Mask_, unsigned... K_>
+	void
+	ApplyCurvesRow(Value_ *bits, unsigned width, const Value_ *const *luts, std::integer_sequence<unsigned, K_...>) {
+		const Value_ *const tables[] = { luts[K_]... };
+		for (unsigned x = 0; x < width; x++, bits += sizeof...(K_)) {
+			// gather all the values of the pixel before storing any
+			const Value_ values[] = { CurveValue<Mask_, K_>(tables[K_], bits[K_])... };
+			(..., StoreCurveValue<Mask_, K_>(bits, values[K_]));
+		}
+	}
+
+	template <typename Value_, unsigned Channels_, unsigned... Masks_>
+	void
+	ApplyCurvesRow(unsigned mask, Value_ *bits, unsigned width, const Value_ *const *luts, std::integer_sequence<unsigned, Masks_...>) {
+		using RowFunction = void (*)(Value_*, unsigned, const Value_ *const *, std::make_integer_sequence<unsigned, Channels_>);
+		static constexpr RowFunction rows[] = { &ApplyCurvesRow<Value_, Masks_>... };
+		rows[mask](bits, width, luts, std::make_integer_sequence<unsigned, Channels_>{});
+	}
+
+	/**
+	Apply the lookup tables of an image in a single pass over the pixels, in parallel over bands of rows.
+	@param luts Lookup tables in the memory order of the values of a pixel, NULL leaves a value unchanged
+	*/
+	template <typename Value_, unsigned Channels_>
+	void
+	ApplyCurves(FIBITMAP *dib, const void *const *luts) {
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+
+		const Value_ *tables[Channels_];
+		unsigned mask = 0;
+		for (unsigned k = 0; k < Channels_; k++) {
+			tables[k] = static_cast<const Value_*>(luts[k]);
+			mask |= tables[k] ? (1U << k) : 0;
+		}
+		if (!mask) {
+			return;
+		}
+
+		ParallelForRows(height, (size_t)width * Channels_ * sizeof(Value_), [&](unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				auto *bits = reinterpret_cast<Value_*>(FreeImage_GetScanLine(dib, y));
+				ApplyCurvesRow<Value_, Channels_>(mask, bits, width, tables, std::make_integer_sequence<unsigned, (1U << Channels_)>{});
+			}
+		});
+	}
+
+	/** Per channel lookup tables of the FREE_IMAGE_COLOR_CHANNEL of FreeImage_AdjustCurve, in R, G, B, A order */
+	void
+	SelectCurveChannels(FREE_IMAGE_COLOR_CHANNEL channel, const void *LUT, const void *luts[4]) {
+		luts[0] = ((channel == FICC_RGB) || (channel == FICC_RED)) ? LUT : nullptr;
+		luts[1] = ((channel == FICC_RGB) || (channel == FICC_GREEN)) ? LUT : nullptr;
+		luts[2] = ((channel == FICC_RGB) || (channel == FICC_BLUE)) ? LUT : nullptr;
+		luts[3] = (channel == FICC_ALPHA) ? LUT : nullptr;
+	}
+
+} // namespace
+
+/** @brief Applies a lookup table (LUT) to every channel of an image in a single pass.
+
+Each channel gets its own LUT, a NULL LUT leaves its channel unchanged. All the
+channels are processed in one pass over the pixels, in parallel over bands of rows,
+which is faster than one FreeImage_AdjustCurve call per channel.<br>
+The type of the LUT values depends on the image type:<br>
+8-, 24- and 32-bit FIT_BITMAP images : uint8_t LUT of 256 entries.<br>
+FIT_UINT16, FIT_RGB16 and FIT_RGBA16 images : uint16_t LUT of 65536 entries.<br>
+Single channel images (8-bit greyscale and FIT_UINT16) are processed with the red LUT.
+The red, green and blue LUT of a palettized image are applied to its palette.
+@param dib Input/output image to be processed.
+@param red Lookup table of the red channel, or NULL.
+@param green Lookup table of the green channel, or NULL.
+@param blue Lookup table of the blue channel, or NULL.
+@param alpha Lookup table of the alpha channel, or NULL. Ignored by images without alpha channel.
+@return Returns TRUE if successful, FALSE otherwise (e.g. when the image type cannot be handled).
+@see FreeImage_AdjustCurve, FreeImage_AdjustCurve16
+*/
+FIBOOL DLL_CALLCONV
+FreeImage_AdjustChannelCurves(FIBITMAP *dib, const void *red, const void *green, const void *blue, const void *alpha) {
+	if (!FreeImage_HasPixels(dib)) {
+		return FALSE;
+	}
+
+	switch (FreeImage_GetImageType(dib)) {
+		case FIT_BITMAP:
+		{
+			const unsigned bpp = FreeImage_GetBPP(dib);
+			if (bpp == 8) {
+				if (FreeImage_GetColorType(dib) == FIC_PALETTE) {
+					// apply the LUT to the colormap
+					FIRGBA8 *rgb = FreeImage_GetPalette(dib);
+					for (unsigned pal = 0; pal < FreeImage_GetColorsUsed(dib); pal++, rgb++) {
+						rgb->red   = red   ? static_cast<const uint8_t*>(red)[rgb->red]     : rgb->red;
+						rgb->green = green ? static_cast<const uint8_t*>(green)[rgb->green] : rgb->green;
+						rgb->blue  = blue  ? static_cast<const uint8_t*>(blue)[rgb->blue]   : rgb->blue;
+					}
+				}
+				else {
+					ApplyCurves<uint8_t, 1>(dib, &red);
+				}
+				return TRUE;
+			}
+			if ((bpp != 24) && (bpp != 32)) {
+				return FALSE;
+			}
+			const void *luts[4] = {};
+			luts[FI_RGBA_RED] = red;
+			luts[FI_RGBA_GREEN] = green;
+			luts[FI_RGBA_BLUE] = blue;
+			if (bpp == 24) {
+				ApplyCurves<uint8_t, 3>(dib, luts);
+			}
+			else {
+				luts[FI_RGBA_ALPHA] = alpha;
+				ApplyCurves<uint8_t, 4>(dib, luts);
+			}
+			return TRUE;
+		}
+
+		case FIT_UINT16:
+			ApplyCurves<uint16_t, 1>(dib, &red);
+			return TRUE;
+
+		case FIT_RGB16:
+		{
+			const void *luts[3] = { red, green, blue };
+			ApplyCurves<uint16_t, 3>(dib, luts);
+			return TRUE;
+		}
+
+		case FIT_RGBA16:
+		{
+			const void *luts[4] = { red, green, blue, alpha };
+			ApplyCurves<uint16_t, 4>(dib, luts);
+			return TRUE;
+		}
+
+		default:
+			return FALSE;
+	}
+}
+
 /** @brief Perfoms an histogram transformation on a 8, 24 or 32-bit image 
 according to the values of a lookup table (LUT).
 
@@ -145,125 +319,57 @@ plane (R,G, and B). Otherwise, the LUT is applied to the specified channel only.
 @param LUT Lookup table. <b>The size of 'LUT' is assumed to be 256.</b>
 @param channel The color channel to be processed (only used with 24 & 32-bit DIB).
 @return Returns TRUE if successful, FALSE otherwise.
-@see FREE_IMAGE_COLOR_CHANNEL
+@see FREE_IMAGE_COLOR_CHANNEL, FreeImage_AdjustChannelCurves
 */
 FIBOOL DLL_CALLCONV 
 FreeImage_AdjustCurve(FIBITMAP *src, uint8_t *LUT, FREE_IMAGE_COLOR_CHANNEL channel) {
-	unsigned x, y;
-	uint8_t *bits{};
-
 	if (!FreeImage_HasPixels(src) || !LUT || (FreeImage_GetImageType(src) != FIT_BITMAP))
 		return FALSE;
 
-	int bpp = FreeImage_GetBPP(src);
+	const unsigned bpp = FreeImage_GetBPP(src);
 	if ((bpp != 8) && (bpp != 24) && (bpp != 32))
 		return FALSE;
 
-	// apply the LUT
-	switch (bpp) {
-
-		case 8 :
-		{
-			// if the dib has a colormap, apply the LUT to it
-			// else, apply the LUT to pixel values
-
-			if (FreeImage_GetColorType(src) == FIC_PALETTE) {
-				FIRGBA8 *rgb = FreeImage_GetPalette(src);
-				for (unsigned pal = 0; pal < FreeImage_GetColorsUsed(src); pal++) {
-					rgb->red   = LUT[rgb->red];
-					rgb->green = LUT[rgb->green];
-					rgb->blue  = LUT[rgb->blue];
-					rgb++;
-				}
-			}
-			else {
-				for (y = 0; y < FreeImage_GetHeight(src); y++) {
-					bits =  FreeImage_GetScanLine(src, y);
-					for (x = 0; x < FreeImage_GetWidth(src); x++) {
-						bits[x] = LUT[ bits[x] ];
-					}
-				}
-			}
-
-			break;
-		}
-
-		case 24 :
-		case 32 :
-		{
-			const int bytespp = FreeImage_GetLine(src) / FreeImage_GetWidth(src);
-
-			switch (channel) {
-				case FICC_RGB :
-					for (y = 0; y < FreeImage_GetHeight(src); y++) {
-						bits =  FreeImage_GetScanLine(src, y);
-						for (x = 0; x < FreeImage_GetWidth(src); x++) {
-							bits[FI_RGBA_BLUE]	= LUT[ bits[FI_RGBA_BLUE] ];	// B
-							bits[FI_RGBA_GREEN] = LUT[ bits[FI_RGBA_GREEN] ];	// G
-							bits[FI_RGBA_RED]	= LUT[ bits[FI_RGBA_RED] ];		// R
-							
-							bits += bytespp;
-						}
-					}
-					break;
-
-				case FICC_BLUE :
-					for (y = 0; y < FreeImage_GetHeight(src); y++) {
-						bits =  FreeImage_GetScanLine(src, y);
-						for (x = 0; x < FreeImage_GetWidth(src); x++) {
-							bits[FI_RGBA_BLUE] = LUT[ bits[FI_RGBA_BLUE] ];		// B
-							
-							bits += bytespp;
-						}
-					}
-					break;
+	if (bpp == 8) {
+		// the LUT is applied to the palette or to the grey values, whatever the channel
+		return FreeImage_AdjustChannelCurves(src, LUT, LUT, LUT, nullptr);
+	}
+	const void *luts[4];
+	SelectCurveChannels(channel, LUT, luts);
+	return FreeImage_AdjustChannelCurves(src, luts[0], luts[1], luts[2], luts[3]);
+}
 
-				case FICC_GREEN :
-					for (y = 0; y < FreeImage_GetHeight(src); y++) {
-						bits =  FreeImage_GetScanLine(src, y);
-						for (x = 0; x < FreeImage_GetWidth(src); x++) {
-							bits[FI_RGBA_GREEN] = LUT[ bits[FI_RGBA_GREEN] ];	// G
-							
-							bits += bytespp;
-						}
-					}
-					break;
+/** @brief Perfoms an histogram transformation on a FIT_UINT16, FIT_RGB16 or FIT_RGBA16
+image according to the values of a 16-bit lookup table (LUT).
 
-				case FICC_RED :
-					for (y = 0; y < FreeImage_GetHeight(src); y++) {
-						bits =  FreeImage_GetScanLine(src, y);
-						for (x = 0; x < FreeImage_GetWidth(src); x++) {
-							bits[FI_RGBA_RED] = LUT[ bits[FI_RGBA_RED] ];		// R
-							
-							bits += bytespp;
-						}
-					}
-					break;
-					
-				case FICC_ALPHA :
-					if (32 == bpp) {
-						for (y = 0; y < FreeImage_GetHeight(src); y++) {
-							bits =  FreeImage_GetScanLine(src, y);
-							for (x = 0; x < FreeImage_GetWidth(src); x++) {
-								bits[FI_RGBA_ALPHA] = LUT[ bits[FI_RGBA_ALPHA] ];	// A
-								
-								bits += bytespp;
-							}
-						}
-					}
-					break;
+This is the 16-bit counterpart of FreeImage_AdjustCurve : FIT_UINT16 images get
+the LUT whatever the channel, FICC_RGB applies it to the red, green and blue
+channels, otherwise it is applied to the specified channel only.
+@param src Input image to be processed.
+@param LUT Lookup table. <b>The size of 'LUT' is assumed to be 65536.</b>
+@param channel The color channel to be processed (only used with FIT_RGB16 and FIT_RGBA16).
+@return Returns TRUE if successful, FALSE otherwise.
+@see FreeImage_AdjustCurve, FreeImage_AdjustChannelCurves
+*/
+FIBOOL DLL_CALLCONV
+FreeImage_AdjustCurve16(FIBITMAP *src, const uint16_t *LUT, FREE_IMAGE_COLOR_CHANNEL channel) {
+	if (!FreeImage_HasPixels(src) || !LUT)
+		return FALSE;
 
-				default:
-					break;
-			}
-			break;
-		}
+	const FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(src);
+	if (image_type == FIT_UINT16) {
+		return FreeImage_AdjustChannelCurves(src, LUT, nullptr, nullptr, nullptr);
 	}
+	if ((image_type != FIT_RGB16) && (image_type != FIT_RGBA16))
+		return FALSE;
 
-	return TRUE;
+	const void *luts[4];
+	SelectCurveChannels(channel, LUT, luts);
+	return FreeImage_AdjustChannelCurves(src, luts[0], luts[1], luts[2], luts[3]);
 }
 
-/** @brief Performs gamma correction on a 8, 24 or 32-bit image.
+/** @brief Performs gamma correction on a 8, 24 or 32-bit image, or a 16-bit or float image
+(see FreeImage_AdjustColors).
 
 @param src Input image to be processed.
 @param gamma Gamma value to use. A value of 1.0 leaves the image alone, 
@@ -276,6 +382,11 @@ FreeImage_AdjustGamma(FIBITMAP *src, double gamma) {
 
 	if (!FreeImage_HasPixels(src) || (gamma <= 0))
 		return FALSE;
+
+	if (FreeImage_GetImageType(src) != FIT_BITMAP) {
+		// 16-bit and float images
+		return FreeImage_AdjustColors(src, 0, 0, gamma, FALSE);
+	}
 	
 	// Build the lookup table
 
@@ -292,7 +403,8 @@ FreeImage_AdjustGamma(FIBITMAP *src, double gamma) {
 	return FreeImage_AdjustCurve(src, LUT, FICC_RGB);
 }
 
-/** @brief Adjusts the brightness of a 8, 24 or 32-bit image by a certain amount.
+/** @brief Adjusts the brightness of a 8, 24 or 32-bit image, or a 16-bit or float
+image (see FreeImage_AdjustColors), by a certain amount.
 
 @param src Input image to be processed.
 @param percentage Where -100 <= percentage <= 100<br>
@@ -307,6 +419,11 @@ FreeImage_AdjustBrightness(FIBITMAP *src, double percentage) {
 
 	if (!FreeImage_HasPixels(src))
 		return FALSE;
+
+	if (FreeImage_GetImageType(src) != FIT_BITMAP) {
+		// 16-bit and float images
+		return FreeImage_AdjustColors(src, percentage, 0, 1, FALSE);
+	}
 	
 	// Build the lookup table
 	const double scale = (100 + percentage) / 100;
@@ -318,7 +435,8 @@ FreeImage_AdjustBrightness(FIBITMAP *src, double percentage) {
 	return FreeImage_AdjustCurve(src, LUT, FICC_RGB);
 }
 
-/** @brief Adjusts the contrast of a 8, 24 or 32-bit image by a certain amount.
+/** @brief Adjusts the contrast of a 8, 24 or 32-bit image, or a 16-bit or float
+image (see FreeImage_AdjustColors), by a certain amount.
 
 @param src Input image to be processed.
 @param percentage Where -100 <= percentage <= 100<br>
@@ -333,6 +451,11 @@ FreeImage_AdjustContrast(FIBITMAP *src, double percentage) {
 
 	if (!FreeImage_HasPixels(src))
 		return FALSE;
+
+	if (FreeImage_GetImageType(src) != FIT_BITMAP) {
+		// 16-bit and float images
+		return FreeImage_AdjustColors(src, 0, percentage, 1, FALSE);
+	}
 	
 	// Build the lookup table
 	const double scale = (100 + percentage) / 100;
@@ -356,93 +479,52 @@ bit depth is not supported (nothing is done).
 */
 FIBOOL DLL_CALLCONV 
 FreeImage_GetHistogram(FIBITMAP *src, uint32_t *histo, FREE_IMAGE_COLOR_CHANNEL channel) {
-	uint8_t pixel;
-	uint8_t *bits{};
-	unsigned x, y;
-
 	if (!FreeImage_HasPixels(src) || !histo) return FALSE;
 
 	const unsigned width  = FreeImage_GetWidth(src);
 	const unsigned height = FreeImage_GetHeight(src);
 	const unsigned bpp    = FreeImage_GetBPP(src);
 
-	if (bpp == 8) {
-		// clear histogram array
-		memset(histo, 0, 256 * sizeof(uint32_t));
-		// compute histogram for black channel
-		for (y = 0; y < height; y++) {
-			bits = FreeImage_GetScanLine(src, y);
-			for (x = 0; x < width; x++) {
-				// get pixel value
-				pixel = bits[x];
-				histo[pixel]++;
-			}
-		}
-		return TRUE;
+	if ((bpp != 8) && (bpp != 24) && (bpp != 32)) {
+		return FALSE;
 	}
-	else if ((bpp == 24) || (bpp == 32)) {
-		int bytespp = bpp / 8;	// bytes / pixel
-
-		// clear histogram array
-		memset(histo, 0, 256 * sizeof(uint32_t));
-
-		switch (channel) {
-			case FICC_RED:
-				// compute histogram for red channel
-				for (y = 0; y < height; y++) {
-					bits =  FreeImage_GetScanLine(src, y);
-					for (x = 0; x < width; x++) {
-						pixel = bits[FI_RGBA_RED];	// R
-						histo[pixel]++;
-						bits += bytespp;
-					}
-				}
-				return TRUE;
-
-			case FICC_GREEN:
-				// compute histogram for green channel
-				for (y = 0; y < height; y++) {
-					bits =  FreeImage_GetScanLine(src, y);
-					for (x = 0; x < width; x++) {
-						pixel = bits[FI_RGBA_GREEN];	// G
-						histo[pixel]++;
-						bits += bytespp;
-					}
+	if ((bpp != 8) && (channel != FICC_RED) && (channel != FICC_GREEN) && (channel != FICC_BLUE) && (channel != FICC_BLACK) && (channel != FICC_RGB)) {
+		return FALSE;
+	}
+	const unsigned bytespp = bpp / 8;	// bytes / pixel
+
+	// every band of rows counts its own histogram, the histograms are summed at the end
+	using Histogram = std::array<uint32_t, 256>;
+	const Histogram total = ParallelReduceRows(height, (size_t)width * bytespp, Histogram{}, [&](Histogram& band, unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(src, y);
+			if (bpp == 8) {
+				// black channel
+				for (unsigned x = 0; x < width; x++) {
+					band[bits[x]]++;
 				}
-				return TRUE;
-
-			case FICC_BLUE:
-				// compute histogram for blue channel
-				for (y = 0; y < height; y++) {
-					bits =  FreeImage_GetScanLine(src, y);
-					for (x = 0; x < width; x++) {
-						pixel = bits[FI_RGBA_BLUE];	// B
-						histo[pixel]++;
-						bits += bytespp;
-					}
+			}
+			else if ((channel == FICC_BLACK) || (channel == FICC_RGB)) {
+				for (unsigned x = 0; x < width; x++, bits += bytespp) {
+					// RGB to GREY conversion
+					band[GREY(bits[FI_RGBA_RED], bits[FI_RGBA_GREEN], bits[FI_RGBA_BLUE])]++;
 				}
-				return TRUE;
-
-			case FICC_BLACK:
-			case FICC_RGB:
-				// compute histogram for black channel
-				for (y = 0; y < height; y++) {
-					bits =  FreeImage_GetScanLine(src, y);
-					for (x = 0; x < width; x++) {
-						// RGB to GREY conversion
-						pixel = GREY(bits[FI_RGBA_RED], bits[FI_RGBA_GREEN], bits[FI_RGBA_BLUE]);
-						histo[pixel]++;
-						bits += bytespp;
-					}
+			}
+			else {
+				const unsigned offset = (channel == FICC_RED) ? FI_RGBA_RED : (channel == FICC_GREEN) ? FI_RGBA_GREEN : FI_RGBA_BLUE;
+				for (unsigned x = 0; x < width; x++, bits += bytespp) {
+					band[bits[offset]]++;
 				}
-				return TRUE;
-				
-			default:
-				return FALSE;
+			}
 		}
-	}
+	}, [](Histogram& result, const Histogram& band) {
+		for (unsigned i = 0; i < 256; i++) {
+			result[i] += band[i];
+		}
+	});
 
-	return FALSE;
+	memcpy(histo, total.data(), 256 * sizeof(uint32_t));
+	return TRUE;
 }
 
 
@@ -474,11 +556,58 @@ namespace
 			++mHist[i * mStride];
 		}
 
+		/** Add the counts of a contiguous histogram of binsNumber bins */
+		void Merge(const uint32_t* hist, uint32_t binsNumber) const
+		{
+			for (uint32_t i = 0; i < binsNumber; ++i) {
+				mHist[i * mStride] += hist[i];
+			}
+		}
+
 	private:
 		uint32_t* mHist;
 		uint32_t mStride;
 	};
 
+	/**
+	Histograms of all the builders in one pass over the image.
+	Every band of rows counts into its own contiguous histograms, the bands run in parallel
+	and their histograms are summed into the builders at the end.
+	*/
+	template <typename PixelType_, typename IndexFunction_, typename... Builders_, size_t... Is_>
+	void BuildHistogramsImpl(FIBITMAP* dib, uint32_t binsNumber, const IndexFunction_& indexFunction, std::index_sequence<Is_...>, const Builders_&... builders)
+	{
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+		const unsigned pitch = FreeImage_GetPitch(dib);
+		const uint8_t* bits = FreeImage_GetBits(dib);
+
+		using Counts = std::vector<uint32_t>;
+		const Counts total = ParallelReduceRows(height, static_cast<size_t>(width) * sizeof(PixelType_), Counts(sizeof...(Builders_) * static_cast<size_t>(binsNumber), 0u),
+			[&](Counts& band, unsigned first_row, unsigned end_row) {
+				const std::tuple<Builders_...> local{ Builders_(band.data() + Is_ * binsNumber, 1u)... };
+				for (unsigned y = first_row; y < end_row; ++y) {
+					const auto* pixel = static_cast<const PixelType_*>(static_cast<const void*>(bits + static_cast<size_t>(y) * pitch));
+					for (unsigned x = 0; x < width; ++x) {
+						std::apply([&](const auto&... b) { (..., b.Add(pixel[x], indexFunction)); }, local);
+					}
+				}
+			},
+			[](Counts& result, const Counts& band) {
+				for (size_t i = 0; i < result.size(); ++i) {
+					result[i] += band[i];
+				}
+			});
+
+		(..., builders.Merge(total.data() + Is_ * binsNumber, binsNumber));
+	}
+
+	template <typename PixelType_, typename IndexFunction_, typename... Builders_>
+	void BuildHistograms(FIBITMAP* dib, uint32_t binsNumber, const IndexFunction_& indexFunction, const Builders_&... builders)
+	{
+		BuildHistogramsImpl<PixelType_>(dib, binsNumber, indexFunction, std::index_sequence_for<Builders_...>{}, builders...);
+	}
+
 	template <typename PixelType_>
 	class HistogramFloat
 	{
@@ -519,9 +648,7 @@ namespace
 				return std::min(i, mBinsNumber - 1);
 			};
 
-			BitmapForEach<PixelType_>(mBitmap, [&](const PixelType_& p, uint32_t /*x*/, uint32_t /*y*/) {
-				(..., builders.Add(p, CalculateBinIndex));
-			});
+			BuildHistograms<PixelType_>(mBitmap, mBinsNumber, CalculateBinIndex, builders...);
 			return true;
 		}
 
@@ -567,9 +694,7 @@ namespace
 				return std::min(i, mBinsNumber - 1);
 			};
 
-			BitmapForEach<PixelType_>(mBitmap, [&](const PixelType_& p, uint32_t /*x*/, uint32_t /*y*/) {
-				(..., builders.Add(p, CalculateBinIndexSigned));
-			});
+			BuildHistograms<PixelType_>(mBitmap, mBinsNumber, CalculateBinIndexSigned, builders...);
 			return true;
 		}
 
@@ -612,9 +737,7 @@ namespace
 					return std::min(i, mBinsNumber - 1);
 				};
 
-				BitmapForEach<PixelType_>(mBitmap, [&](const PixelType_& p, uint32_t /*x*/, uint32_t /*y*/) {
-					(..., builders.Add(p, CalculateBinIndexWithoutScale));
-				});
+				BuildHistograms<PixelType_>(mBitmap, mBinsNumber, CalculateBinIndexWithoutScale, builders...);
 			}
 			else {
 				const auto CalculateBinIndexWithScale = [&](const ValueType& value) {
@@ -623,9 +746,7 @@ namespace
 					return std::min(i, mBinsNumber - 1);
 				};
 
-				BitmapForEach<PixelType_>(mBitmap, [&](const PixelType_& p, uint32_t /*x*/, uint32_t /*y*/) {
-					(..., builders.Add(p, CalculateBinIndexWithScale));
-				});
+				BuildHistograms<PixelType_>(mBitmap, mBinsNumber, CalculateBinIndexWithScale, builders...);
 			}
 			return true;
 		}
@@ -805,131 +926,559 @@ FreeImage_MakeHistogram(FIBITMAP* dib, uint32_t binsNumber, void* outMinVal, voi
 	ClearHistogram(histL, strideL, binsNumber);
 
 	bool success = FALSE;
-	switch (FreeImage_GetImageType(dib)) {
-	case FIT_BITMAP: {
-			const auto bpp = FreeImage_GetBPP(dib);
-			const auto colorType = FreeImage_GetColorType2(dib);
-			if ((colorType == FIC_RGBALPHA || colorType == FIC_YUV) && (bpp == 32)) {
-				success = InvokeWithBuilders(HistogramUInt<FIRGBA8>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR), HistogramBuilder<SelectGreen>(histG, strideG),
-					HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+	try {
+		switch (FreeImage_GetImageType(dib)) {
+		case FIT_BITMAP: {
+				const auto bpp = FreeImage_GetBPP(dib);
+				const auto colorType = FreeImage_GetColorType2(dib);
+				if ((colorType == FIC_RGBALPHA || colorType == FIC_YUV) && (bpp == 32)) {
+					success = InvokeWithBuilders(HistogramUInt<FIRGBA8>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR), HistogramBuilder<SelectGreen>(histG, strideG),
+						HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+				}
+				else if ((colorType == FIC_RGB || colorType == FIC_YUV) && (bpp == 24)) {
+					success = InvokeWithBuilders(HistogramUInt<FIRGB8>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR), HistogramBuilder<SelectGreen>(histG, strideG),
+						HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+				}
+				else if (colorType == FIC_MINISBLACK && bpp == 8) {
+					success = InvokeWithBuilders(HistogramUInt<uint8_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
+				}
+				if (success) {
+					SetIntMinMax<uint8_t>(outMinVal, outMaxVal);
+				}
+			}
+			break;
+		case FIT_RGBF: {
+				float minVal{}, maxVal{};
+				if (!FindHistogramBounds<FIRGBF>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
+					break;
+				}
+				success = InvokeWithBuilders(HistogramFloat<FIRGBF>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectRed>(histR, strideR),
+					HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+			}
+			break;
+		case FIT_RGBAF: {
+				float minVal{}, maxVal{};
+				if (!FindHistogramBounds<FIRGBAF>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
+					break;
+				}
+				success = InvokeWithBuilders(HistogramFloat<FIRGBAF>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectRed>(histR, strideR),
+					HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+			}
+			break;
+		case FIT_COMPLEX: {
+				double minVal{}, maxVal{};
+				if (!FindHistogramBounds<FICOMPLEX>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
+					break;
+				}
+				success = InvokeWithBuilders(HistogramFloat<FICOMPLEX>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectReal>(histR, strideR),
+					HistogramBuilder<SelectImag>(histG, strideG), HistogramBuilder<SelectAbs>(histB, strideB));
+			}
+			break;
+		case FIT_COMPLEXF: {
+				float minVal{}, maxVal{};
+				if (!FindHistogramBounds<FICOMPLEXF>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
+					break;
+				}
+				success = InvokeWithBuilders(HistogramFloat<FICOMPLEXF>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectReal>(histR, strideR),
+					HistogramBuilder<SelectImag>(histG, strideG), HistogramBuilder<SelectAbs>(histB, strideB));
 			}
-			else if ((colorType == FIC_RGB || colorType == FIC_YUV) && (bpp == 24)) {
-				success = InvokeWithBuilders(HistogramUInt<FIRGB8>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR), HistogramBuilder<SelectGreen>(histG, strideG),
-					HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+			break;
+		case FIT_DOUBLE: {
+				double minVal{}, maxVal{};
+				if (!FindHistogramBounds<double>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
+					break;
+				}
+				success = InvokeWithBuilders(HistogramFloat<double>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectIdentity>(histR, strideR));
 			}
-			else if (colorType == FIC_MINISBLACK && bpp == 8) {
-				success = InvokeWithBuilders(HistogramUInt<uint8_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
+			break;
+		case FIT_FLOAT: {
+				float minVal{}, maxVal{};
+				if (!FindHistogramBounds<float>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
+					break;
+				}
+				success = InvokeWithBuilders(HistogramFloat<float>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectIdentity>(histR, strideR));
 			}
+			break;
+		case FIT_RGBA32:
+			success = InvokeWithBuilders(HistogramUInt<FIRGBA32>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
+				HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
 			if (success) {
-				SetIntMinMax<uint8_t>(outMinVal, outMaxVal);
+				SetIntMinMax<uint32_t>(outMinVal, outMaxVal);
 			}
-		}
-		break;
-	case FIT_RGBF: {
-			float minVal{}, maxVal{};
-			if (!FindHistogramBounds<FIRGBF>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
-				break;
+			break;
+		case FIT_RGB32:
+			success = InvokeWithBuilders(HistogramUInt<FIRGB32>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
+				HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+			if (success) {
+				SetIntMinMax<uint32_t>(outMinVal, outMaxVal);
 			}
-			success = InvokeWithBuilders(HistogramFloat<FIRGBF>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectRed>(histR, strideR),
+			break;
+		case FIT_RGBA16:
+			success = InvokeWithBuilders(HistogramUInt<FIRGBA16>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
 				HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
-		}
-		break;
-	case FIT_RGBAF: {
-			float minVal{}, maxVal{};
-			if (!FindHistogramBounds<FIRGBAF>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
-				break;
+			if (success) {
+				SetIntMinMax<uint16_t>(outMinVal, outMaxVal);
 			}
-			success = InvokeWithBuilders(HistogramFloat<FIRGBAF>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectRed>(histR, strideR),
+			break;
+		case FIT_RGB16:
+			success = InvokeWithBuilders(HistogramUInt<FIRGB16>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
 				HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
+			if (success) {
+				SetIntMinMax<uint16_t>(outMinVal, outMaxVal);
+			}
+			break;
+		case FIT_UINT32:
+			success = InvokeWithBuilders(HistogramUInt<uint32_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
+			if (success) {
+				SetIntMinMax<uint32_t>(outMinVal, outMaxVal);
+			}
+			break;
+		case FIT_INT32:
+			success = InvokeWithBuilders(HistogramSInt<int32_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
+			if (success) {
+				SetIntMinMax<int32_t>(outMinVal, outMaxVal);
+			}
+			break;
+		case FIT_UINT16:
+			success = InvokeWithBuilders(HistogramUInt<uint16_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
+			if (success) {
+				SetIntMinMax<uint16_t>(outMinVal, outMaxVal);
+			}
+			break;
+		case FIT_INT16:
+			success = InvokeWithBuilders(HistogramSInt<int16_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
+			if (success) {
+				SetIntMinMax<int16_t>(outMinVal, outMaxVal);
+			}
+			break;
+		default:
+			return FALSE;
 		}
-		break;
-	case FIT_COMPLEX: {
-			double minVal{}, maxVal{};
-			if (!FindHistogramBounds<FICOMPLEX>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
-				break;
+	}
+	catch (const std::bad_alloc&) {
+		FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+		return FALSE;
+	}
+
+	return success ? TRUE : FALSE;
+}
+
+
+// ----------------------------------------------------------
+//   Image statistics
+// ----------------------------------------------------------
+
+namespace
+{
+
+	/**
+	Per channel count, mean and sum of squared deviations of interleaved values, Channels_ values per pixel.
+	Values are summed as differences to the first pending value of their lane, exactly in 64-bit integers
+	for 8-bit and 16-bit values, in doubles otherwise. The sums are flushed into a mean and a sum of squared
+	deviations, and partial results are combined with the pairwise update of Chan et al.,
+	so that the variance does not suffer from the cancellation of E[x^2] - mean^2.
+	Lanes as in ChannelMinMax, NaN values are not counted.
+	*/
+	template <typename Value_, unsigned Channels_>
+	struct ChannelMoments
+	{
+		static constexpr unsigned Lanes = ChannelMinMax<Value_, Channels_>::Lanes;
+		static constexpr bool Exact = std::is_integral_v<Value_> && (sizeof(Value_) <= 2);
+		using Sum = std::conditional_t<Exact, int64_t, double>;
+		using Sum2 = std::conditional_t<Exact, uint64_t, double>;
+
+		// pending values, as sums of differences to 'shift'
+		Sum shift[Lanes]{};
+		Sum sum[Lanes]{};
+		Sum2 sum2[Lanes]{};
+		uint64_t pending[Lanes]{};
+
+		// flushed values
+		uint64_t count[Lanes]{};
+		double mean[Lanes]{};
+		double m2[Lanes]{};
+
+		/** Add 'count' values, a whole number of pixels */
+		void Add(const Value_* values, size_t n)
+		{
+			size_t i = 0;
+			for (; i + Lanes <= n; i += Lanes) {
+				for (unsigned k = 0; k < Lanes; ++k) {
+					Accumulate(k, values[i + k]);
+				}
+			}
+			for (unsigned k = 0; i < n; ++i, ++k) {
+				Accumulate(k, values[i]);
 			}
-			success = InvokeWithBuilders(HistogramFloat<FICOMPLEX>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectReal>(histR, strideR),
-				HistogramBuilder<SelectImag>(histG, strideG), HistogramBuilder<SelectAbs>(histB, strideB));
 		}
-		break;
-	case FIT_COMPLEXF: {
-			float minVal{}, maxVal{};
-			if (!FindHistogramBounds<FICOMPLEXF>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
-				break;
+
+		void Merge(const ChannelMoments& other)
+		{
+			ChannelMoments flushed = other;
+			flushed.Flush();
+			Flush();
+			for (unsigned k = 0; k < Lanes; ++k) {
+				Combine(count[k], mean[k], m2[k], flushed.count[k], flushed.mean[k], flushed.m2[k]);
 			}
-			success = InvokeWithBuilders(HistogramFloat<FICOMPLEXF>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectReal>(histR, strideR),
-				HistogramBuilder<SelectImag>(histG, strideG), HistogramBuilder<SelectAbs>(histB, strideB));
 		}
-		break;
-	case FIT_DOUBLE: {
-			double minVal{}, maxVal{};
-			if (!FindHistogramBounds<double>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
-				break;
+
+		/** Count, mean and standard deviation of the channel c, in memory order */
+		void Get(unsigned c, uint64_t& n, double& mu, double& stddev) const
+		{
+			ChannelMoments flushed = *this;
+			flushed.Flush();
+			n = 0;
+			mu = 0;
+			double m = 0;
+			for (unsigned k = c; k < Lanes; k += Channels_) {
+				Combine(n, mu, m, flushed.count[k], flushed.mean[k], flushed.m2[k]);
 			}
-			success = InvokeWithBuilders(HistogramFloat<double>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectIdentity>(histR, strideR));
+			stddev = n ? std::sqrt(std::max(0.0, m / n)) : 0;
 		}
-		break;
-	case FIT_FLOAT: {
-			float minVal{}, maxVal{};
-			if (!FindHistogramBounds<float>(dib, minVal, maxVal, outMinVal, outMaxVal)) {
-				break;
+
+	private:
+		static void Combine(uint64_t& n, double& mu, double& m, uint64_t nb, double mub, double mb)
+		{
+			if (nb == 0) {
+				return;
+			}
+			if (n == 0) {
+				n = nb;
+				mu = mub;
+				m = mb;
+				return;
 			}
-			success = InvokeWithBuilders(HistogramFloat<float>(dib, binsNumber, minVal, maxVal), HistogramBuilder<SelectIdentity>(histR, strideR));
+			const double total = static_cast<double>(n + nb);
+			const double delta = mub - mu;
+			mu += delta * (nb / total);
+			m += mb + delta * delta * (static_cast<double>(n) * nb / total);
+			n += nb;
 		}
-		break;
-	case FIT_RGBA32:
-		success = InvokeWithBuilders(HistogramUInt<FIRGBA32>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
-			HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
-		if (success) {
-			SetIntMinMax<uint32_t>(outMinVal, outMaxVal);
+
+		void Flush()
+		{
+			for (unsigned k = 0; k < Lanes; ++k) {
+				if (pending[k]) {
+					const double n = static_cast<double>(pending[k]);
+					const double s = static_cast<double>(sum[k]);
+					Combine(count[k], mean[k], m2[k], pending[k], static_cast<double>(shift[k]) + s / n, std::max(0.0, static_cast<double>(sum2[k]) - s * s / n));
+					sum[k] = 0;
+					sum2[k] = 0;
+					pending[k] = 0;
+				}
+			}
 		}
-		break;
-	case FIT_RGB32:
-		success = InvokeWithBuilders(HistogramUInt<FIRGB32>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
-			HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
-		if (success) {
-			SetIntMinMax<uint32_t>(outMinVal, outMaxVal);
+
+		void Accumulate(unsigned k, Value_ v)
+		{
+			if constexpr (Exact) {
+				if (!pending[k]) {
+					shift[k] = v;
+				}
+				const Sum d = static_cast<Sum>(v) - shift[k];
+				sum[k] += d;
+				sum2[k] += static_cast<Sum2>(d * d);
+				++pending[k];
+			}
+			else if (v == v) {
+				if (!pending[k]) {
+					shift[k] = static_cast<double>(v);
+				}
+				const double d = static_cast<double>(v) - shift[k];
+				sum[k] += d;
+				sum2[k] += d * d;
+				++pending[k];
+			}
 		}
-		break;
-	case FIT_RGBA16:
-		success = InvokeWithBuilders(HistogramUInt<FIRGBA16>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
-			HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
-		if (success) {
-			SetIntMinMax<uint16_t>(outMinVal, outMaxVal);
+	};
+
+	/**
+	Histogram bin of a value : the bins of integer values span the whole range of the type,
+	those of floating point values span [minVal, maxVal].
+	*/
+	template <typename Value_>
+	class StatisticsBin
+	{
+	public:
+		StatisticsBin(uint32_t binsNumber, double minVal, double maxVal)
+			: mLast(binsNumber - 1)
+			, mBinsNumber(binsNumber)
+			, mMin(minVal)
+			, mScale((maxVal > minVal) ? binsNumber / (maxVal - minVal) : 0.0)
+		{ }
+
+		uint32_t operator()(Value_ v) const
+		{
+			constexpr uint32_t bits = 8 * sizeof(Value_);
+			if constexpr (std::is_floating_point_v<Value_>) {
+				const double i = (v - mMin) * mScale;
+				return (i > 0) ? std::min(static_cast<uint32_t>(std::min(i, 4294967295.0)), mLast) : 0u;
+			}
+			else if constexpr (std::is_signed_v<Value_>) {
+				const auto u = static_cast<uint64_t>(static_cast<int64_t>(v) - std::numeric_limits<Value_>::min());
+				return std::min(static_cast<uint32_t>((u * mBinsNumber) >> bits), mLast);
+			}
+			else {
+				return std::min(static_cast<uint32_t>((static_cast<uint64_t>(v) * mBinsNumber) >> bits), mLast);
+			}
 		}
-		break;
-	case FIT_RGB16:
-		success = InvokeWithBuilders(HistogramUInt<FIRGB16>(dib, binsNumber), HistogramBuilder<SelectRed>(histR, strideR),
-			HistogramBuilder<SelectGreen>(histG, strideG), HistogramBuilder<SelectBlue>(histB, strideB), HistogramBuilder<SelectRgbBrightness>(histL, strideL));
-		if (success) {
-			SetIntMinMax<uint16_t>(outMinVal, outMaxVal);
+
+	private:
+		uint32_t mLast;
+		uint64_t mBinsNumber;
+		double mMin;
+		double mScale;
+	};
+
+	/** Memory index of the channel c, in red, green, blue, alpha order */
+	template <typename PixelType_>
+	unsigned MemoryIndex(unsigned c)
+	{
+		if constexpr (std::is_same_v<PixelType_, FIRGB8> || std::is_same_v<PixelType_, FIRGBA8>) {
+			const unsigned index[4] = { FI_RGBA_RED, FI_RGBA_GREEN, FI_RGBA_BLUE, FI_RGBA_ALPHA };
+			return index[c];
 		}
-		break;
-	case FIT_UINT32:
-		success = InvokeWithBuilders(HistogramUInt<uint32_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
-		if (success) {
-			SetIntMinMax<uint32_t>(outMinVal, outMaxVal);
+		else {
+			return c;
 		}
-		break;
-	case FIT_INT32:
-		success = InvokeWithBuilders(HistogramSInt<int32_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
-		if (success) {
-			SetIntMinMax<int32_t>(outMinVal, outMaxVal);
+	}
+
+	/**
+	Statistics of 8-bit channels : a single counting pass gives the exact histogram of every channel,
+	the statistics and the requested histograms are derived from it.
+	*/
+	template <typename PixelType_>
+	bool ComputeByteStatistics(FIBITMAP* dib, FISTATISTICS* stats, uint32_t binsNumber, uint32_t* histograms)
+	{
+		constexpr unsigned channels = PixelChannelsNumber<PixelType_>::value;
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+
+		using Counts = std::vector<uint32_t>;
+		const Counts total = ParallelReduceRows(height, static_cast<size_t>(width) * channels, Counts(channels * 256, 0u), [&](Counts& band, unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; ++y) {
+				const uint8_t* bits = FreeImage_GetScanLine(dib, y);
+				for (unsigned x = 0; x < width; ++x, bits += channels) {
+					for (unsigned c = 0; c < channels; ++c) {
+						++band[c * 256 + bits[c]];
+					}
+				}
+			}
+		}, [](Counts& result, const Counts& band) {
+			for (size_t i = 0; i < result.size(); ++i) {
+				result[i] += band[i];
+			}
+		});
+
+		memset(stats, 0, sizeof(FISTATISTICS));
+		stats->channels = channels;
+		const StatisticsBin<uint8_t> bin(binsNumber, 0, 0);
+		for (unsigned c = 0; c < channels; ++c) {
+			const uint32_t* counts = total.data() + MemoryIndex<PixelType_>(c) * 256;
+			uint64_t n = 0, sum = 0;
+			int lo = -1, hi = -1;
+			for (unsigned v = 0; v < 256; ++v) {
+				if (counts[v]) {
+					lo = (lo < 0) ? static_cast<int>(v) : lo;
+					hi = static_cast<int>(v);
+					n += counts[v];
+					sum += static_cast<uint64_t>(counts[v]) * v;
+				}
+			}
+			// second pass over the histogram for the deviations
+			const double mean = static_cast<double>(sum) / n;
+			double m2 = 0;
+			for (unsigned v = 0; v < 256; ++v) {
+				const double d = v - mean;
+				m2 += counts[v] * d * d;
+			}
+			stats->count[c] = n;
+			stats->min[c] = lo;
+			stats->max[c] = hi;
+			stats->mean[c] = mean;
+			stats->stddev[c] = std::sqrt(m2 / n);
+			if (histograms) {
+				uint32_t* hist = histograms + c * static_cast<size_t>(binsNumber);
+				std::fill(hist, hist + binsNumber, 0u);
+				for (unsigned v = 0; v < 256; ++v) {
+					hist[bin(static_cast<uint8_t>(v))] += counts[v];
+				}
+			}
 		}
-		break;
-	case FIT_UINT16:
-		success = InvokeWithBuilders(HistogramUInt<uint16_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
-		if (success) {
-			SetIntMinMax<uint16_t>(outMinVal, outMaxVal);
+		return true;
+	}
+
+	template <typename PixelType_>
+	bool ComputeStatistics(FIBITMAP* dib, FISTATISTICS* stats, uint32_t binsNumber, uint32_t* histograms)
+	{
+		using ValueType = ToValueType<PixelType_>;
+		constexpr unsigned channels = PixelChannelsNumber<PixelType_>::value;
+		using Range = ChannelMinMax<ValueType, channels>;
+
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+		const unsigned pitch = FreeImage_GetPitch(dib);
+		const uint8_t* bits = FreeImage_GetBits(dib);
+		const size_t count = static_cast<size_t>(width) * channels;
+		const size_t row_bytes = count * sizeof(ValueType);
+		const auto row = [&](unsigned y) {
+			return static_cast<const ValueType*>(static_cast<const void*>(bits + static_cast<size_t>(y) * pitch));
+		};
+
+		// the bins of floating point values span the range of each channel, found by a first pass
+		std::vector<StatisticsBin<ValueType>> bins;
+		if (histograms) {
+			if constexpr (std::is_floating_point_v<ValueType>) {
+				const Range range = ParallelReduceRows(height, row_bytes, Range{}, [&](Range& band, unsigned first_row, unsigned end_row) {
+					for (unsigned y = first_row; y < end_row; ++y) {
+						band.Add(row(y), count);
+					}
+				}, [](Range& result, const Range& band) {
+					result.Merge(band);
+				});
+				for (unsigned c = 0; c < channels; ++c) {
+					bins.emplace_back(binsNumber, range.Min(c), range.Max(c));
+				}
+			}
+			else {
+				bins.assign(channels, StatisticsBin<ValueType>(binsNumber, 0, 0));
+			}
 		}
-		break;
-	case FIT_INT16:
-		success = InvokeWithBuilders(HistogramSInt<int16_t>(dib, binsNumber), HistogramBuilder<SelectIdentity>(histR, strideR));
-		if (success) {
-			SetIntMinMax<int16_t>(outMinVal, outMaxVal);
+
+		struct Band
+		{
+			Range range;
+			ChannelMoments<ValueType, channels> moments;
+			std::vector<uint32_t> counts;	// histograms of the channels, in memory order
+		};
+		Band init;
+		if (histograms) {
+			init.counts.assign(channels * static_cast<size_t>(binsNumber), 0u);
 		}
-		break;
-	default:
+
+		// every row is read once, for the range, the sums and the histograms
+		const Band total = ParallelReduceRows(height, row_bytes, init, [&](Band& band, unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; ++y) {
+				const ValueType* values = row(y);
+				band.range.Add(values, count);
+				band.moments.Add(values, count);
+				if (histograms) {
+					for (size_t i = 0; i < count; i += channels) {
+						for (unsigned c = 0; c < channels; ++c) {
+							const ValueType v = values[i + c];
+							if (!IsNan(v)) {
+								++band.counts[c * static_cast<size_t>(binsNumber) + bins[c](v)];
+							}
+						}
+					}
+				}
+			}
+		}, [](Band& result, const Band& band) {
+			result.range.Merge(band.range);
+			result.moments.Merge(band.moments);
+			for (size_t i = 0; i < result.counts.size(); ++i) {
+				result.counts[i] += band.counts[i];
+			}
+		});
+
+		memset(stats, 0, sizeof(FISTATISTICS));
+		stats->channels = channels;
+		for (unsigned c = 0; c < channels; ++c) {
+			const unsigned m = MemoryIndex<PixelType_>(c);
+			total.moments.Get(m, stats->count[c], stats->mean[c], stats->stddev[c]);
+			if (stats->count[c] > 0) {
+				stats->min[c] = static_cast<double>(total.range.Min(m));
+				stats->max[c] = static_cast<double>(total.range.Max(m));
+			}
+			if (histograms) {
+				memcpy(histograms + c * static_cast<size_t>(binsNumber), total.counts.data() + m * static_cast<size_t>(binsNumber), binsNumber * sizeof(uint32_t));
+			}
+		}
+		return true;
+	}
+
+} // namespace
+
+/**
+Per channel statistics and histograms of an image, computed in a single parallel pass over the pixels.
+Channels are red, green, blue and alpha for color images, the value for one channel images.
+The bins of integer images span the whole range of the pixel type, as FreeImage_MakeHistogram does.
+The bins of floating point images span the [min, max] range of each channel, found by a first pass
+when histograms are requested. NaN values are ignored.
+Supported images are 8-bit greyscale, 24-bit and 32-bit FIT_BITMAP, FIT_UINT16, FIT_INT16, FIT_UINT32, FIT_INT32,
+FIT_FLOAT, FIT_DOUBLE, FIT_RGB16, FIT_RGBA16, FIT_RGB32, FIT_RGBA32, FIT_RGBF and FIT_RGBAF.
+@param dib Source image
+@param stats Receives the statistics
+@param binsNumber Number of bins per channel, ignored without histograms
+@param histograms Optional, receives stats->channels histograms of binsNumber bins, one after the other
+@return Returns TRUE if successful, FALSE otherwise
+*/
+FIBOOL DLL_CALLCONV
+FreeImage_GetStatistics(FIBITMAP* dib, FISTATISTICS* stats, uint32_t binsNumber, uint32_t* histograms)
+{
+	if (!FreeImage_HasPixels(dib) || !stats || (histograms && binsNumber < 1)) {
+		return FALSE;
+	}
+
+	bool success = false;
+	try {
+		switch (FreeImage_GetImageType(dib)) {
+		case FIT_BITMAP: {
+				const auto bpp = FreeImage_GetBPP(dib);
+				const auto colorType = FreeImage_GetColorType2(dib);
+				if ((colorType == FIC_RGBALPHA) && (bpp == 32)) {
+					success = ComputeByteStatistics<FIRGBA8>(dib, stats, binsNumber, histograms);
+				}
+				else if ((colorType == FIC_RGB) && (bpp == 24)) {
+					success = ComputeByteStatistics<FIRGB8>(dib, stats, binsNumber, histograms);
+				}
+				else if ((colorType == FIC_MINISBLACK) && (bpp == 8)) {
+					success = ComputeByteStatistics<uint8_t>(dib, stats, binsNumber, histograms);
+				}
+			}
+			break;
+		case FIT_UINT16:
+			success = ComputeStatistics<uint16_t>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_INT16:
+			success = ComputeStatistics<int16_t>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_UINT32:
+			success = ComputeStatistics<uint32_t>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_INT32:
+			success = ComputeStatistics<int32_t>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_FLOAT:
+			success = ComputeStatistics<float>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_DOUBLE:
+			success = ComputeStatistics<double>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_RGB16:
+			success = ComputeStatistics<FIRGB16>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_RGBA16:
+			success = ComputeStatistics<FIRGBA16>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_RGB32:
+			success = ComputeStatistics<FIRGB32>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_RGBA32:
+			success = ComputeStatistics<FIRGBA32>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_RGBF:
+			success = ComputeStatistics<FIRGBF>(dib, stats, binsNumber, histograms);
+			break;
+		case FIT_RGBAF:
+			success = ComputeStatistics<FIRGBAF>(dib, stats, binsNumber, histograms);
+			break;
+		default:
+			break;
+		}
+	}
+	catch (const std::bad_alloc&) {
+		FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
 		return FALSE;
 	}
 
@@ -940,6 +1489,162 @@ FreeImage_MakeHistogram(FIBITMAP* dib, uint32_t binsNumber, void* outMinVal, voi
 // ----------------------------------------------------------
 
 
+namespace
+{
+	/**
+	Brightness, contrast and gamma adjustment of FreeImage_AdjustColors, on values in [0, maxValue].
+	The contrast is applied first, then the brightness and the gamma, each result is clamped to [0, maxValue].
+	*/
+	class ColorAdjustment
+	{
+	public:
+		ColorAdjustment(double brightness, double contrast, double gamma, double maxValue)
+			: m_max(maxValue), m_middle(maxValue * 128 / 255),
+			m_contrast((100.0 + contrast) / 100.0), m_brightness((100.0 + brightness) / 100.0),
+			m_adjust_contrast(contrast != 0.0), m_adjust_brightness(brightness != 0.0), m_adjust_gamma((gamma > 0) && (gamma != 1.0)) {
+			if (m_adjust_gamma) {
+				m_exponent = 1 / gamma;
+				m_gamma_scale = maxValue * pow(maxValue, -m_exponent);
+			}
+		}
+
+		/** Number of adjustments made by the operator */
+		int Count() const {
+			return (m_adjust_contrast ? 1 : 0) + (m_adjust_brightness ? 1 : 0) + (m_adjust_gamma ? 1 : 0);
+		}
+
+		double operator()(double value) const {
+			return Gamma(Linear(value));
+		}
+
+		/** Contrast and brightness adjustment of a value in [0, maxValue] */
+		double Linear(double value) const {
+			if (m_adjust_contrast) {
+				value = std::clamp(m_middle + (value - m_middle) * m_contrast, 0.0, m_max);
+			}
+			if (m_adjust_brightness) {
+				value = std::clamp(value * m_brightness, 0.0, m_max);
+			}
+			return value;
+		}
+
+		/** Gamma correction of a value in [0, maxValue] */
+		double Gamma(double value) const {
+			if (m_adjust_gamma) {
+				value = std::clamp(pow(value, m_exponent) * m_gamma_scale, 0.0, m_max);
+			}
+			return value;
+		}
+
+		bool AdjustsGamma() const {
+			return m_adjust_gamma;
+		}
+
+	private:
+		double m_max;
+		double m_middle;
+		double m_contrast;
+		double m_brightness;
+		double m_exponent = 1.0;
+		double m_gamma_scale = 1.0;
+		bool m_adjust_contrast;
+		bool m_adjust_brightness;
+		bool m_adjust_gamma;
+	};
+
+	/** Lookup table of all the values of an unsigned integer type, see FreeImage_GetAdjustColorsLookupTable */
+	template <typename Value_>
+	int
+	MakeAdjustColorsLookupTable(Value_ *LUT, double brightness, double contrast, double gamma, FIBOOL invert) {
+		constexpr unsigned maxValue = std::numeric_limits<Value_>::max();
+		const ColorAdjustment adjustment(brightness, contrast, gamma, maxValue);
+		for (unsigned i = 0; i <= maxValue; i++) {
+			const auto value = (Value_)floor(adjustment(i) + 0.5);
+			LUT[i] = invert ? (Value_)(maxValue - value) : value;
+		}
+		// return the number of adjustments made
+		return adjustment.Count() + (invert ? 1 : 0);
+	}
+
+	/**
+	Color adjustment of float values in [0, 1]. Contrast and brightness are evaluated directly,
+	the gamma curve is approximated by cubic pieces, which interpolate the exact curve at the ends and at
+	two inner points of every segment, so evaluating it costs a multiply-add chain instead of a pow.
+	The first segment, where the derivative of the gamma curve is unbounded, is evaluated exactly.
+	*/
+	class FloatColorAdjustment
+	{
+	public:
+		static constexpr unsigned Segments = 1024;
+
+		FloatColorAdjustment(const ColorAdjustment& adjustment, bool invert)
+			: m_adjustment(adjustment), m_invert(invert) {
+			if (adjustment.AdjustsGamma()) {
+				m_coefficients.resize(Segments);
+				for (unsigned i = 0; i < Segments; i++) {
+					double f[4];
+					for (unsigned k = 0; k < 4; k++) {
+						f[k] = adjustment.Gamma((3.0 * i + k) / (3.0 * Segments));
+					}
+					// Newton forward differences in s = 3 u, expanded as a polynomial of u in [0, 1]
+					const double d1 = f[1] - f[0];
+					const double d2 = f[2] - 2 * f[1] + f[0];
+					const double d3 = f[3] - 3 * f[2] + 3 * f[1] - f[0];
+					auto& c = m_coefficients[i];
+					c[0] = (float)f[0];
+					c[1] = (float)(3 * (d1 - d2 / 2 + d3 / 3));
+					c[2] = (float)(9 * (d2 - d3) / 2);
+					c[3] = (float)(27 * d3 / 6);
+				}
+			}
+		}
+
+		/** Adjusted value of v, v is clamped to [0, 1] and NaN gives the adjusted 0 */
+		float operator()(float v) const {
+			float value = (float)m_adjustment.Linear((v > 0) ? std::min(v, 1.F) : 0.F);
+			if (!m_coefficients.empty()) {
+				const float t = value * Segments;
+				if (t < 1) {
+					value = (float)m_adjustment.Gamma(value);
+				}
+				else {
+					const unsigned i = std::min((unsigned)t, Segments - 1);
+					const float u = t - (float)i;
+					const auto& c = m_coefficients[i];
+					value = std::clamp(((c[3] * u + c[2]) * u + c[1]) * u + c[0], 0.F, 1.F);
+				}
+			}
+			return m_invert ? 1.F - value : value;
+		}
+
+	private:
+		ColorAdjustment m_adjustment;
+		bool m_invert;
+		std::vector<std::array<float, 4>> m_coefficients;
+	};
+
+	/** Adjust the color channels of a FIT_FLOAT, FIT_RGBF or FIT_RGBAF image, the alpha channel is left unchanged */
+	void
+	AdjustFloatColors(FIBITMAP *dib, const FloatColorAdjustment& adjustment) {
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+		const unsigned floatspp = FreeImage_GetBPP(dib) / (8 * sizeof(float));
+		const unsigned channels = std::min(floatspp, 3U);
+
+		ParallelForRows(height, (size_t)width * floatspp * sizeof(float), [&](unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				auto *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(dib, y));
+				for (unsigned x = 0; x < width; x++, bits += floatspp) {
+					for (unsigned c = 0; c < channels; c++) {
+						bits[c] = adjustment(bits[c]);
+					}
+				}
+			}
+		});
+	}
+
+} // namespace
+
 /** @brief Creates a lookup table to be used with FreeImage_AdjustCurve() which
  may adjust brightness and contrast, correct gamma and invert the image with a
  single call to FreeImage_AdjustCurve().
@@ -996,67 +1701,32 @@ FreeImage_MakeHistogram(FIBITMAP* dib, uint32_t binsNumber, void* outMinVal, voi
  */
 int DLL_CALLCONV
 FreeImage_GetAdjustColorsLookupTable(uint8_t *LUT, double brightness, double contrast, double gamma, FIBOOL invert) {
-	double dblLUT[256];
-	double value;
-	int result = 0;
-
-	if ((brightness == 0.0) && (contrast == 0.0) && (gamma == 1.0) && (!invert)) {
-		// nothing to do, if all arguments have their default values
-		// return a blind LUT
-		for (int i = 0; i < 256; i++) {
-			LUT[i] = (uint8_t)i;
-		}
-		return 0;
-	}
+	return MakeAdjustColorsLookupTable(LUT, brightness, contrast, gamma, invert);
+}
 
-	// first, create a blind LUT, which does nothing to the image
-	for (int i = 0; i < 256; i++) {
-		dblLUT[i] = i;
-	}
+/** @brief Creates a 16-bit lookup table to be used with FreeImage_AdjustCurve16()
+ which may adjust brightness and contrast, correct gamma and invert the image with
+ a single call to FreeImage_AdjustCurve16().
 
-	if (contrast != 0.0) {
-		// modify lookup table with contrast adjustment data
-		const double v = (100.0 + contrast) / 100.0;
-		for (int i = 0; i < 256; i++) {
-			value = 128 + (dblLUT[i] - 128) * v;
-			dblLUT[i] = std::clamp(value, 0.0, 255.0);
-		}
-		result++;
-	}
+ This is the 16-bit counterpart of FreeImage_GetAdjustColorsLookupTable(), the
+ adjustments are the same, scaled to the [0, 65535] range.
 
-	if (brightness != 0.0) {
-		// modify lookup table with brightness adjustment data
-		const double v = (100.0 + brightness) / 100.0;
-		for (int i = 0; i < 256; i++) {
-			value = dblLUT[i] * v;
-			dblLUT[i] = std::clamp(value, 0.0, 255.0);
-		}
-		result++;
-	}
-
-	if ((gamma > 0) && (gamma != 1.0)) {
-		// modify lookup table with gamma adjustment data
-		double exponent = 1 / gamma;
-		const double v = 255.0 * (double)pow((double)255, -exponent);
-		for (int i = 0; i < 256; i++) {
-			value = pow(dblLUT[i], exponent) * v;
-			dblLUT[i] = std::clamp(value, 0.0, 255.0);
-		}
-		result++;
-	}
-
-	if (!invert) {
-		for (int i = 0; i < 256; i++) {
-			LUT[i] = (uint8_t)floor(dblLUT[i] + 0.5);
-		}
-	} else {
-		for (int i = 0; i < 256; i++) {
-			LUT[i] = 255 - (uint8_t)floor(dblLUT[i] + 0.5);
-		}
-		result++;
+ @param LUT Output lookup table to be used with FreeImage_AdjustCurve16(). <b>The
+ size of 'LUT' is assumed to be 65536.</b>
+ @param brightness Percentage brightness value where -100 <= brightness <= 100
+ @param contrast Percentage contrast value where -100 <= contrast <= 100
+ @param gamma Gamma value to be used for gamma correction, ignored if not greater than zero.
+ @param invert If set to TRUE, the image will be inverted.
+ @return Returns the number of adjustments applied to the resulting lookup table
+ compared to a blind lookup table.
+ @see FreeImage_GetAdjustColorsLookupTable
+ */
+int DLL_CALLCONV
+FreeImage_GetAdjustColorsLookupTable16(uint16_t *LUT, double brightness, double contrast, double gamma, FIBOOL invert) {
+	if (!LUT) {
+		return 0;
 	}
-	// return the number of adjustments made
-	return result;
+	return MakeAdjustColorsLookupTable(LUT, brightness, contrast, gamma, invert);
 }
 
 /** @brief Adjusts an image's brightness, contrast and gamma as well as it may
@@ -1070,6 +1740,10 @@ FreeImage_GetAdjustColorsLookupTable(uint8_t *LUT, double brightness, double con
  
  This function relies on FreeImage_GetAdjustColorsLookupTable(), which creates a
  single lookup table, that combines all adjustment operations requested.
+ FIT_UINT16, FIT_RGB16 and FIT_RGBA16 images use the 16-bit lookup table of
+ FreeImage_GetAdjustColorsLookupTable16(). FIT_FLOAT, FIT_RGBF and FIT_RGBAF images
+ get the same adjustments over [0, 1], with a piecewise cubic approximation of the
+ gamma curve. Values out of that range are clamped. The alpha channel is never changed.
  
  Furthermore, the lookup table created by FreeImage_GetAdjustColorsLookupTable()
  does not depend on the order, in which each single adjustment operation is
@@ -1107,21 +1781,56 @@ FreeImage_GetAdjustColorsLookupTable(uint8_t *LUT, double brightness, double con
  */
 FIBOOL DLL_CALLCONV
 FreeImage_AdjustColors(FIBITMAP *dib, double brightness, double contrast, double gamma, FIBOOL invert) {
-	uint8_t LUT[256];
-
-	if (!FreeImage_HasPixels(dib) || (FreeImage_GetImageType(dib) != FIT_BITMAP)) {
+	if (!FreeImage_HasPixels(dib)) {
 		return FALSE;
 	}
 
-	int bpp = FreeImage_GetBPP(dib);
-	if ((bpp != 8) && (bpp != 24) && (bpp != 32)) {
-		return FALSE;
-	}
+	try {
+		switch (FreeImage_GetImageType(dib)) {
+			case FIT_BITMAP:
+			{
+				const unsigned bpp = FreeImage_GetBPP(dib);
+				if ((bpp != 8) && (bpp != 24) && (bpp != 32)) {
+					return FALSE;
+				}
+				uint8_t LUT[256];
+				if (FreeImage_GetAdjustColorsLookupTable(LUT, brightness, contrast, gamma, invert)) {
+					return FreeImage_AdjustCurve(dib, LUT, FICC_RGB);
+				}
+				return FALSE;
+			}
 
-	if (FreeImage_GetAdjustColorsLookupTable(LUT, brightness, contrast, gamma, invert)) {
-		return FreeImage_AdjustCurve(dib, LUT, FICC_RGB);
+			case FIT_UINT16:
+			case FIT_RGB16:
+			case FIT_RGBA16:
+			{
+				std::vector<uint16_t> LUT(65536);
+				if (FreeImage_GetAdjustColorsLookupTable16(LUT.data(), brightness, contrast, gamma, invert)) {
+					return FreeImage_AdjustCurve16(dib, LUT.data(), FICC_RGB);
+				}
+				return FALSE;
+			}
+
+			case FIT_FLOAT:
+			case FIT_RGBF:
+			case FIT_RGBAF:
+			{
+				const ColorAdjustment adjustment(brightness, contrast, gamma, 1.0);
+				if ((adjustment.Count() == 0) && !invert) {
+					return FALSE;
+				}
+				AdjustFloatColors(dib, FloatColorAdjustment(adjustment, invert != FALSE));
+				return TRUE;
+			}
+
+			default:
+				return FALSE;
+		}
+	}
+	catch (const std::bad_alloc&) {
+		FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+		return FALSE;
 	}
-	return FALSE;
 }
 
 /** @brief Applies color mapping for one or several colors on a 1-, 4- or 8-bit
@@ -0,0 +1,445 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "FreeImage.h"
+#include "Utilities.h"
+#include "WorkImage.h"
+#include "FreeImage/SimdFloat4.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+
+	// ----------------------------------------------------------
+	//  Borders
+	// ----------------------------------------------------------
+
+	/**
+	Copy a line of 'length' samples of 'lanes' values, with 'before' and 'after' border samples.
+	@param constant Value of the samples outside of the line when BorderIndex returns -1
+	*/
+	template <typename Work_>
+	void PadLine(const Work_* in, size_t length, size_t lanes, size_t before, size_t after,
+		FREE_IMAGE_BORDER_MODE border, Work_ constant, Work_* padded)
+	{
+		std::copy(in, in + length * lanes, padded + before * lanes);
+		auto border_sample = [&](ptrdiff_t i, Work_* dst) {
+			const ptrdiff_t index = BorderIndex(i, static_cast<ptrdiff_t>(length), border);
+			if (index < 0) {
+				std::fill(dst, dst + lanes, constant);
+			}
+			else {
+				std::copy(in + index * lanes, in + (index + 1) * lanes, dst);
+			}
+		};
+		for (size_t i = 0; i < before; ++i) {
+			border_sample(static_cast<ptrdiff_t>(i) - static_cast<ptrdiff_t>(before), padded + i * lanes);
+		}
+		for (size_t i = 0; i < after; ++i) {
+			border_sample(static_cast<ptrdiff_t>(length + i), padded + (before + length + i) * lanes);
+		}
+	}
+
+	// ----------------------------------------------------------
+	//  Line operations
+	// ----------------------------------------------------------
+
+	/** acc[i] += weight * src[i] */
+	template <typename Work_>
+	inline void AddScaled(Work_* acc, const Work_* src, Work_ weight, size_t count)
+	{
+		size_t i = 0;
+		if constexpr (std::is_same_v<Work_, float>) {
+			const Float4 w = Float4::Set(weight);
+			for (; i + 4 <= count; i += 4) {
+				(Float4::Load(acc + i) + w * Float4::Load(src + i)).Store(acc + i);
+			}
+		}
+		for (; i < count; ++i) {
+			acc[i] += weight * src[i];
+		}
+	}
+
+	/** Erosion : minimum of the values */
+	struct MinOp
+	{
+		template <typename Value_>
+		static Value_ Identity() {
+			return std::numeric_limits<Value_>::has_infinity ? std::numeric_limits<Value_>::infinity() : std::numeric_limits<Value_>::max();
+		}
+		template <typename Value_>
+		static Value_ Apply(Value_ a, Value_ b) { return (b < a) ? b : a; }
+		static Float4 Apply(const Float4& a, const Float4& b) { return Min(a, b); }
+	};
+
+	/** Dilation : maximum of the values */
+	struct MaxOp
+	{
+		template <typename Value_>
+		static Value_ Identity() {
+			return std::numeric_limits<Value_>::has_infinity ? -std::numeric_limits<Value_>::infinity() : std::numeric_limits<Value_>::lowest();
+		}
+		template <typename Value_>
+		static Value_ Apply(Value_ a, Value_ b) { return (a < b) ? b : a; }
+		static Float4 Apply(const Float4& a, const Float4& b) { return Max(a, b); }
+	};
+
+	/** dst[i] = op(a[i], b[i]), dst may be a or b */
+	template <typename Op_, typename Value_>
+	inline void CombineLines(Value_* dst, const Value_* a, const Value_* b, size_t count)
+	{
+		size_t i = 0;
+		if constexpr (std::is_same_v<Value_, float>) {
+			for (; i + 4 <= count; i += 4) {
+				Op_::Apply(Float4::Load(a + i), Float4::Load(b + i)).Store(dst + i);
+			}
+		}
+		for (; i < count; ++i) {
+			dst[i] = Op_::Apply(a[i], b[i]);
+		}
+	}
+
+	// ----------------------------------------------------------
+	//  Separable filters
+	// ----------------------------------------------------------
+
+	/**
+	Line filter of a 1D convolution : out[x] = sum of weights[t] * in[x + t - anchor]
+	*/
+	template <typename Work_>
+	struct ConvolutionLine
+	{
+		std::vector<Work_> weights;
+		size_t anchor;
+		FREE_IMAGE_BORDER_MODE border;
+		std::vector<Work_> padded;
+
+		void operator()(Work_* in, Work_* out, size_t length, size_t lanes)
+		{
+			const size_t size = weights.size();
+			padded.resize((length + size - 1) * lanes);
+			PadLine(in, length, lanes, anchor, size - 1 - anchor, border, Work_(0), padded.data());
+
+			const size_t count = length * lanes;
+			std::fill(out, out + count, Work_(0));
+			for (size_t t = 0; t < size; ++t) {
+				if (weights[t] != 0) {
+					AddScaled(out, padded.data() + t * lanes, weights[t], count);
+				}
+			}
+		}
+	};
+
+	/**
+	Line filter of a 1D erosion or dilation : out[x] = op of in[x - anchor] ... in[x - anchor + size - 1].
+	Samples outside of the line are ignored. Small windows are combined directly, larger ones with
+	the van Herk / Gil-Werman algorithm whose cost per sample does not depend on the size of the window, see
+	M. van Herk, A fast algorithm for local minimum and maximum filters on rectangular and octagonal kernels.
+	Pattern Recognition Letters 13, 1992.
+	*/
+	template <typename Op_, typename Value_>
+	struct MorphologyLine
+	{
+		size_t size;
+		size_t anchor;
+		std::vector<Value_> padded, forward, backward;
+
+		void operator()(Value_* in, Value_* out, size_t length, size_t lanes)
+		{
+			const size_t count = length * lanes;
+			if (size == 1) {
+				std::copy(in, in + count, out);
+				return;
+			}
+
+			// the padded line is made of whole blocks of 'size' samples
+			const size_t blocks = (length + 2 * (size - 1)) / size;
+			const size_t padded_length = blocks * size;
+			padded.resize(padded_length * lanes);
+			PadLine(in, length, lanes, anchor, padded_length - length - anchor, FIBM_ZERO, Op_::template Identity<Value_>(), padded.data());
+			const Value_* p = padded.data();
+
+			if (size <= 3) {
+				CombineLines<Op_>(out, p, p + lanes, count);
+				if (size == 3) {
+					CombineLines<Op_>(out, out, p + 2 * lanes, count);
+				}
+				return;
+			}
+
+			// forward : running op from the start of each block, backward : from the end of each block.
+			// The window [x, x + size - 1] covers the end of a block and the start of the next one.
+			forward.resize(padded_length * lanes);
+			backward.resize(padded_length * lanes);
+			for (size_t block = 0; block < padded_length; block += size) {
+				Value_* f = forward.data() + block * lanes;
+				Value_* b = backward.data() + block * lanes;
+				const Value_* s = p + block * lanes;
+				std::copy(s, s + lanes, f);
+				for (size_t i = 1; i < size; ++i) {
+					CombineLines<Op_>(f + i * lanes, f + (i - 1) * lanes, s + i * lanes, lanes);
+				}
+				std::copy(s + (size - 1) * lanes, s + size * lanes, b + (size - 1) * lanes);
+				for (size_t i = size - 1; i-- > 0; ) {
+					CombineLines<Op_>(b + i * lanes, b + (i + 1) * lanes, s + i * lanes, lanes);
+				}
+			}
+			CombineLines<Op_>(out, backward.data(), forward.data() + (size - 1) * lanes, count);
+		}
+	};
+
+	/**
+	Split a kernel into a column and a row vector, kernel[y * width + x] == column[y] * row[x]
+	@return Returns true if the kernel is separable
+	*/
+	bool SplitSeparable(const double* kernel, size_t width, size_t height, std::vector<double>& column, std::vector<double>& row)
+	{
+		const size_t size = width * height;
+		const size_t pivot = std::max_element(kernel, kernel + size, [](double a, double b) { return std::abs(a) < std::abs(b); }) - kernel;
+		const double p = kernel[pivot];
+		if (p == 0) {
+			column.assign(height, 0);
+			row.assign(width, 0);
+			return true;
+		}
+
+		// row through the largest coefficient, column through it divided by the coefficient
+		const size_t py = pivot / width;
+		const size_t px = pivot % width;
+		row.assign(kernel + py * width, kernel + (py + 1) * width);
+		column.resize(height);
+		for (size_t y = 0; y < height; ++y) {
+			column[y] = kernel[y * width + px] / p;
+		}
+
+		const double tolerance = 1e-9 * std::abs(p);
+		for (size_t y = 0; y < height; ++y) {
+			for (size_t x = 0; x < width; ++x) {
+				if (std::abs(kernel[y * width + x] - column[y] * row[x]) > tolerance) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// ----------------------------------------------------------
+	//  Non-separable filters
+	// ----------------------------------------------------------
+
+	/**
+	Run a 2D filter over the rows of an image : every kernel row adds the source row it covers into the destination row.
+	Kernel rows are given top-down and centered on (kernel_width / 2, kernel_height / 2).
+	@param constant Value of the pixels outside of the image when BorderIndex returns -1, the rows made of it are skipped
+	@param init Initial value of the destination rows
+	@param kernel_row Called as kernel_row(Work_* dst_row, const Work_* padded_row, size_t ky, size_t count),
+	where padded_row starts kernel_width / 2 pixels left of the source row
+	*/
+	template <typename Work_, typename KernelRow_>
+	void Filter2D(const WorkImage<Work_>& src, WorkImage<Work_>& dst, size_t kernel_width, size_t kernel_height,
+		FREE_IMAGE_BORDER_MODE border, Work_ constant, Work_ init, KernelRow_ kernel_row)
+	{
+		const size_t row_length = src.RowLength();
+		const size_t anchor_x = kernel_width / 2;
+		const ptrdiff_t anchor_y = static_cast<ptrdiff_t>(kernel_height / 2);
+		std::atomic<bool> out_of_memory{ false };
+
+		ParallelForRows(static_cast<unsigned>(src.height), row_length * sizeof(Work_) * kernel_width * kernel_height, [&](unsigned first_row, unsigned end_row) {
+			try {
+				std::vector<Work_> padded((src.width + kernel_width - 1) * src.channels);
+				for (unsigned y = first_row; y < end_row; ++y) {
+					Work_* dst_row = dst.Row(y);
+					std::fill(dst_row, dst_row + row_length, init);
+					for (size_t ky = 0; ky < kernel_height; ++ky) {
+						// kernel rows go top-down, scanlines bottom-up
+						const ptrdiff_t sy = BorderIndex(static_cast<ptrdiff_t>(y) + anchor_y - static_cast<ptrdiff_t>(ky), static_cast<ptrdiff_t>(src.height), border);
+						if (sy < 0) {
+							continue;
+						}
+						PadLine(src.Row(sy), src.width, src.channels, anchor_x, kernel_width - 1 - anchor_x, border, constant, padded.data());
+						kernel_row(dst_row, padded.data(), ky, row_length);
+					}
+				}
+			}
+			catch (const std::bad_alloc&) {
+				out_of_memory = true;
+			}
+		});
+		if (out_of_memory) {
+			throw std::bad_alloc();
+		}
+	}
+
+	// ----------------------------------------------------------
+	//  Bitmaps
+	// ----------------------------------------------------------
+
+	/**
+	Convolve an image of 'channels' values of type Value_ per pixel
+	*/
+	template <typename Value_, typename Work_>
+	FIBITMAP* ConvolveBitmap(FIBITMAP* src, unsigned channels, const double* kernel, size_t kernel_width, size_t kernel_height, FREE_IMAGE_BORDER_MODE border)
+	{
+		UniqueBitmap dst(FreeImage_Clone(src), &::FreeImage_Unload);
+		if (!dst) {
+			return nullptr;
+		}
+
+		try {
+			WorkImage<Work_> image(FreeImage_GetWidth(src), FreeImage_GetHeight(src), channels);
+			LoadImage<Value_>(src, image);
+
+			std::vector<double> column, row;
+			if (SplitSeparable(kernel, kernel_width, kernel_height, column, row)) {
+				// two 1D passes, the column goes bottom-up like the scanlines
+				if ((kernel_width > 1) || (row[0] != 1)) {
+					FilterRows(image, ConvolutionLine<Work_>{ std::vector<Work_>(row.begin(), row.end()), kernel_width / 2, border, {} });
+				}
+				if ((kernel_height > 1) || (column[0] != 1)) {
+					FilterColumns(image, ConvolutionLine<Work_>{ std::vector<Work_>(column.rbegin(), column.rend()), kernel_height - 1 - kernel_height / 2, border, {} });
+				}
+				StoreImage<Value_>(image, dst.get());
+			}
+			else {
+				const std::vector<Work_> weights(kernel, kernel + kernel_width * kernel_height);
+				WorkImage<Work_> result(image.width, image.height, channels);
+				Filter2D(image, result, kernel_width, kernel_height, border, Work_(0), Work_(0), [&](Work_* dst_row, const Work_* padded, size_t ky, size_t count) {
+					for (size_t kx = 0; kx < kernel_width; ++kx) {
+						const Work_ weight = weights[ky * kernel_width + kx];
+						if (weight != 0) {
+							AddScaled(dst_row, padded + kx * channels, weight, count);
+						}
+					}
+				});
+				StoreImage<Value_>(result, dst.get());
+			}
+		}
+		catch (const std::bad_alloc&) {
+			FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+			return nullptr;
+		}
+
+		return dst.release();
+	}
+
+	/**
+	Erode or dilate an image of 'channels' values of type Value_ per pixel
+	@param element Structuring element, NULL for a rectangle
+	*/
+	template <typename Op_, typename Value_>
+	FIBITMAP* MorphologyBitmap(FIBITMAP* src, unsigned channels, size_t element_width, size_t element_height, const uint8_t* element)
+	{
+		const size_t element_size = element_width * element_height;
+		if (element && std::all_of(element, element + element_size, [](uint8_t e) { return e == 0; })) {
+			return nullptr;
+		}
+		const bool rectangle = !element || std::all_of(element, element + element_size, [](uint8_t e) { return e != 0; });
+
+		UniqueBitmap dst(FreeImage_Clone(src), &::FreeImage_Unload);
+		if (!dst) {
+			return nullptr;
+		}
+
+		try {
+			WorkImage<Value_> image(FreeImage_GetWidth(src), FreeImage_GetHeight(src), channels);
+			LoadImage<Value_>(src, image);
+
+			if (rectangle) {
+				FilterRows(image, MorphologyLine<Op_, Value_>{ element_width, element_width / 2, {}, {}, {} });
+				FilterColumns(image, MorphologyLine<Op_, Value_>{ element_height, element_height - 1 - element_height / 2, {}, {}, {} });
+				StoreImage<Value_>(image, dst.get());
+			}
+			else {
+				const Value_ identity = Op_::template Identity<Value_>();
+				WorkImage<Value_> result(image.width, image.height, channels);
+				Filter2D(image, result, element_width, element_height, FIBM_ZERO, identity, identity, [&](Value_* dst_row, const Value_* padded, size_t ky, size_t count) {
+					for (size_t kx = 0; kx < element_width; ++kx) {
+						if (element[ky * element_width + kx]) {
+							CombineLines<Op_>(dst_row, dst_row, padded + kx * channels, count);
+						}
+					}
+				});
+				StoreImage<Value_>(result, dst.get());
+			}
+		}
+		catch (const std::bad_alloc&) {
+			FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+			return nullptr;
+		}
+
+		return dst.release();
+	}
+
+	template <typename Op_>
+	FIBITMAP* Morphology(FIBITMAP* dib, int width, int height, const uint8_t* element)
+	{
+		if ((width <= 0) || (height <= 0)) {
+			return nullptr;
+		}
+		return FilterStandardType(dib, [&](auto value, auto, unsigned channels) {
+			return MorphologyBitmap<Op_, typename decltype(value)::type>(dib, channels, width, height, element);
+		});
+	}
+
+} // namespace
+
+/**
+Convolution of an image with a kernel of width x height coefficients, given row by row from the top-left coefficient.
+The kernel is centered on the coefficient (width / 2, height / 2) and is not flipped : every pixel becomes the sum
+of the kernel coefficients multiplied by the pixels under them (correlation). Separable kernels are detected and
+applied as a row pass followed by a column pass. Integer pixels are rounded and clamped to their range.
+Supported images are those of FreeImage_BoxBlur.
+@param dib Source image
+@param kernel Kernel coefficients, width x height values
+@param width Kernel width
+@param height Kernel height
+@param border Values of the pixels outside of the image
+@return Returns the filtered image if successful, NULL otherwise
+@see FreeImage_BoxBlur
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_Convolve(FIBITMAP *dib, const double *kernel, int width, int height, FREE_IMAGE_BORDER_MODE border) {
+	if (!kernel || (width <= 0) || (height <= 0) || (border < FIBM_CLAMP) || (border > FIBM_ZERO)) {
+		return nullptr;
+	}
+	return FilterStandardType(dib, [&](auto value, auto work, unsigned channels) {
+		return ConvolveBitmap<typename decltype(value)::type, typename decltype(work)::type>(dib, channels, kernel, width, height, border);
+	});
+}
+
+/**
+Erosion of an image : every channel of a pixel becomes the minimum of the channel under the structuring element.
+The element is centered on (width / 2, height / 2) and pixels outside of the image are ignored.
+Rectangles cost the same for any size (van Herk / Gil-Werman algorithm).
+Supported images are those of FreeImage_BoxBlur.
+@param dib Source image
+@param width Width of the structuring element
+@param height Height of the structuring element
+@param element Structuring element, width x height values given row by row from the top-left one,
+a non-zero value selects the pixel. NULL selects the whole rectangle.
+@return Returns the eroded image if successful, NULL otherwise
+@see FreeImage_Dilate
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_Erode(FIBITMAP *dib, int width, int height, const uint8_t *element) {
+	return Morphology<MinOp>(dib, width, height, element);
+}
+
+/**
+Dilation of an image : every channel of a pixel becomes the maximum of the channel under the structuring element.
+Parameters are those of FreeImage_Erode.
+@return Returns the dilated image if successful, NULL otherwise
+@see FreeImage_Erode
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_Dilate(FIBITMAP *dib, int width, int height, const uint8_t *element) {
+	return Morphology<MaxOp>(dib, width, height, element);
+}
@@ -0,0 +1,533 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "FreeImage.h"
+#include "Utilities.h"
+#include "ToneMapping.h"
+#include "FreeImage/SimpleTools.h"
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <new>
+#include <vector>
+
+// ----------------------------------------------------------
+// Poisson solver based on the discrete cosine transform
+// Reference:
+// [1] J. Makhoul, A fast cosine transform in one and two dimensions,
+// IEEE Transactions on Acoustics, Speech, and Signal Processing, vol. 28(1), pp. 27-34, 1980.
+// [2] L. I. Bluestein, A linear filtering approach to the computation of discrete Fourier transform,
+// IEEE Transactions on Audio and Electroacoustics, vol. 18(4), pp. 451-455, 1970.
+// ----------------------------------------------------------
+
+namespace
+{
+	using Complex = std::complex<double>;
+
+	constexpr double Pi = 3.14159265358979323846;
+
+	/** Product of complex numbers, without the NaN and infinity handling of std::complex */
+	inline Complex Mul(const Complex& a, const Complex& b) {
+		return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+	}
+
+	/** Largest prime factor transformed by the generic butterfly, larger ones use Bluestein's algorithm */
+	constexpr size_t MaxGenericRadix = 61;
+
+	/**
+	Complex forward DFT of any length : X(k) = sum x(j) exp(-2 i pi j k / n).
+	Lengths made of prime factors up to MaxGenericRadix use a mixed radix decimation in time,
+	other lengths use Bluestein's algorithm over a power of 2 length.
+	A plan is read-only once built and may be shared between threads, each thread using its own scratch buffer.
+	*/
+	class FFT
+	{
+	public:
+		explicit FFT(size_t n)
+			: n_(n)
+		{
+			size_t remaining = n;
+			std::vector<size_t> radices;
+			while (remaining % 4 == 0) {
+				radices.push_back(4);
+				remaining /= 4;
+			}
+			if (remaining % 2 == 0) {
+				radices.push_back(2);
+				remaining /= 2;
+			}
+			for (size_t p = 3; p * p <= remaining; p += 2) {
+				while (remaining % p == 0) {
+					radices.push_back(p);
+					remaining /= p;
+				}
+			}
+			if (remaining > 1) {
+				radices.push_back(remaining);
+			}
+
+			for (size_t p : radices) {
+				if (p > MaxGenericRadix) {
+					InitBluestein();
+					return;
+				}
+			}
+			size_t m = n;
+			for (size_t p : radices) {
+				m /= p;
+				factors_.push_back(p);
+				factors_.push_back(m);
+				max_radix_ = std::max(max_radix_, p);
+			}
+			twiddles_.resize(n);
+			for (size_t k = 0; k < n; k++) {
+				twiddles_[k] = std::polar(1.0, -2 * Pi * static_cast<double>(k) / static_cast<double>(n));
+			}
+		}
+
+		/** Number of Complex values of the scratch buffer of Forward */
+		size_t ScratchSize() const {
+			return inner_ ? 2 * inner_->n_ + inner_->ScratchSize() : max_radix_;
+		}
+
+		/**
+		Forward transform, out must not overlap in
+		@param scratch Buffer of ScratchSize() values
+		*/
+		void Forward(const Complex* in, Complex* out, Complex* scratch) const {
+			if (n_ == 1) {
+				out[0] = in[0];
+			}
+			else if (inner_) {
+				Bluestein(in, out, scratch);
+			}
+			else {
+				Work(out, in, 1, factors_.data(), scratch);
+			}
+		}
+
+	private:
+		size_t n_;
+		std::vector<size_t> factors_;		// (radix, remaining length) pairs of the decimation
+		size_t max_radix_ = 0;
+		std::vector<Complex> twiddles_;		// exp(-2 i pi k / n)
+		std::unique_ptr<FFT> inner_;		// power of 2 transform of Bluestein's algorithm
+		std::vector<Complex> chirp_;		// exp(-i pi k^2 / n)
+		std::vector<Complex> spectrum_;		// transform of the conjugate chirp, divided by the inner length
+
+		/**
+		Bluestein's algorithm : j k = (j^2 + k^2 - (k - j)^2) / 2 turns the DFT into a convolution with a chirp,
+		computed by power of 2 transforms
+		*/
+		void InitBluestein() {
+			size_t m = 1;
+			while (m < 2 * n_ - 1) {
+				m *= 2;
+			}
+			inner_ = std::make_unique<FFT>(m);
+			chirp_.resize(n_);
+			for (size_t k = 0; k < n_; k++) {
+				// k^2 mod 2n keeps the angle accurate for large k
+				const size_t k2 = (k * k) % (2 * n_);
+				chirp_[k] = std::polar(1.0, -Pi * static_cast<double>(k2) / static_cast<double>(n_));
+			}
+			std::vector<Complex> b(m), scratch(inner_->ScratchSize());
+			for (size_t k = 0; k < n_; k++) {
+				b[k] = std::conj(chirp_[k]);
+				if (k > 0) {
+					b[m - k] = b[k];
+				}
+			}
+			spectrum_.resize(m);
+			inner_->Forward(b.data(), spectrum_.data(), scratch.data());
+			for (auto& s : spectrum_) {
+				s /= static_cast<double>(m);
+			}
+		}
+
+		void Bluestein(const Complex* in, Complex* out, Complex* scratch) const {
+			const size_t m = inner_->n_;
+			Complex* a = scratch;
+			Complex* A = scratch + m;
+			Complex* inner_scratch = scratch + 2 * m;
+			for (size_t k = 0; k < n_; k++) {
+				a[k] = Mul(in[k], chirp_[k]);
+			}
+			std::fill(a + n_, a + m, Complex());
+			inner_->Forward(a, A, inner_scratch);
+			// the inverse transform is the conjugate of the forward transform of the conjugate
+			for (size_t k = 0; k < m; k++) {
+				A[k] = std::conj(Mul(A[k], spectrum_[k]));
+			}
+			inner_->Forward(A, a, inner_scratch);
+			for (size_t k = 0; k < n_; k++) {
+				out[k] = Mul(std::conj(a[k]), chirp_[k]);
+			}
+		}
+
+		/**
+		Decimation in time : transforms of the p interleaved sub-sequences of length m, then radix p butterflies
+		@param fstride Stride of the input samples, and of the twiddle factors
+		*/
+		void Work(Complex* out, const Complex* in, size_t fstride, const size_t* factors, Complex* scratch) const {
+			const size_t p = factors[0];
+			const size_t m = factors[1];
+			Complex* const end = out + p * m;
+			if (m == 1) {
+				for (Complex* o = out; o != end; ++o, in += fstride) {
+					*o = *in;
+				}
+			}
+			else {
+				for (Complex* o = out; o != end; o += m, in += fstride) {
+					Work(o, in, fstride * p, factors + 2, scratch);
+				}
+			}
+			switch (p) {
+				case 2:
+					Butterfly2(out, fstride, m);
+					break;
+				case 3:
+					Butterfly3(out, fstride, m);
+					break;
+				case 4:
+					Butterfly4(out, fstride, m);
+					break;
+				case 5:
+					Butterfly5(out, fstride, m);
+					break;
+				default:
+					ButterflyGeneric(out, fstride, m, p, scratch);
+					break;
+			}
+		}
+
+		void Butterfly2(Complex* out, size_t fstride, size_t m) const {
+			for (size_t k = 0; k < m; k++) {
+				const Complex t = Mul(out[k + m], twiddles_[k * fstride]);
+				out[k + m] = out[k] - t;
+				out[k] += t;
+			}
+		}
+
+		void Butterfly3(Complex* out, size_t fstride, size_t m) const {
+			// imaginary part of exp(-2 i pi / 3)
+			const double epi3 = twiddles_[fstride * m].imag();
+			for (size_t k = 0; k < m; k++) {
+				Complex* f = out + k;
+				const Complex s1 = Mul(f[m], twiddles_[k * fstride]);
+				const Complex s2 = Mul(f[2 * m], twiddles_[2 * k * fstride]);
+				const Complex s3 = s1 + s2;
+				const Complex s0 = (s1 - s2) * epi3;
+				const Complex h = f[0] - 0.5 * s3;
+				f[0] += s3;
+				f[2 * m] = Complex(h.real() + s0.imag(), h.imag() - s0.real());
+				f[m] = Complex(h.real() - s0.imag(), h.imag() + s0.real());
+			}
+		}
+
+		void Butterfly4(Complex* out, size_t fstride, size_t m) const {
+			for (size_t k = 0; k < m; k++) {
+				Complex* f = out + k;
+				const Complex s0 = Mul(f[m], twiddles_[k * fstride]);
+				const Complex s1 = Mul(f[2 * m], twiddles_[2 * k * fstride]);
+				const Complex s2 = Mul(f[3 * m], twiddles_[3 * k * fstride]);
+				const Complex s5 = f[0] - s1;
+				const Complex s6 = f[0] + s1;
+				const Complex s3 = s0 + s2;
+				const Complex s4 = s0 - s2;
+				f[0] = s6 + s3;
+				f[2 * m] = s6 - s3;
+				// -i * s4 and i * s4
+				f[m] = Complex(s5.real() + s4.imag(), s5.imag() - s4.real());
+				f[3 * m] = Complex(s5.real() - s4.imag(), s5.imag() + s4.real());
+			}
+		}
+
+		void Butterfly5(Complex* out, size_t fstride, size_t m) const {
+			// exp(-2 i pi / 5) and exp(-4 i pi / 5)
+			const Complex ya = twiddles_[fstride * m];
+			const Complex yb = twiddles_[2 * fstride * m];
+			for (size_t k = 0; k < m; k++) {
+				Complex* f = out + k;
+				const Complex s0 = f[0];
+				const Complex s1 = Mul(f[m], twiddles_[k * fstride]);
+				const Complex s2 = Mul(f[2 * m], twiddles_[2 * k * fstride]);
+				const Complex s3 = Mul(f[3 * m], twiddles_[3 * k * fstride]);
+				const Complex s4 = Mul(f[4 * m], twiddles_[4 * k * fstride]);
+				const Complex s7 = s1 + s4;
+				const Complex s10 = s1 - s4;
+				const Complex s8 = s2 + s3;
+				const Complex s9 = s2 - s3;
+				f[0] = s0 + s7 + s8;
+				const Complex s5 = s0 + s7 * ya.real() + s8 * yb.real();
+				const Complex s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(), -s10.real() * ya.imag() - s9.real() * yb.imag());
+				f[m] = s5 - s6;
+				f[4 * m] = s5 + s6;
+				const Complex s11 = s0 + s7 * yb.real() + s8 * ya.real();
+				const Complex s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(), s10.real() * yb.imag() - s9.real() * ya.imag());
+				f[2 * m] = s11 + s12;
+				f[3 * m] = s11 - s12;
+			}
+		}
+
+		void ButterflyGeneric(Complex* out, size_t fstride, size_t m, size_t p, Complex* scratch) const {
+			for (size_t u = 0; u < m; u++) {
+				for (size_t q = 0; q < p; q++) {
+					scratch[q] = out[u + q * m];
+				}
+				for (size_t q1 = 0; q1 < p; q1++) {
+					const size_t k = u + q1 * m;
+					const size_t step = fstride * k;
+					Complex sum = scratch[0];
+					size_t index = 0;
+					for (size_t q = 1; q < p; q++) {
+						index += step;
+						if (index >= n_) {
+							index -= n_;
+						}
+						sum += Mul(scratch[q], twiddles_[index]);
+					}
+					out[k] = sum;
+				}
+			}
+		}
+	};
+
+	/**
+	Type II discrete cosine transform X(k) = sum x(j) cos(pi k (2j + 1) / 2n) and its exact inverse,
+	computed by a complex transform of length n [1]. Two real lines are transformed at once,
+	as the real and imaginary parts of the complex sequence.
+	*/
+	class DCT
+	{
+	public:
+		explicit DCT(size_t n)
+			: n_(n), fft_(n), shift_(n)
+		{
+			for (size_t k = 0; k < n; k++) {
+				shift_[k] = std::polar(1.0, -Pi * static_cast<double>(k) / static_cast<double>(2 * n));
+			}
+		}
+
+		size_t Length() const { return n_; }
+
+		/** Number of Complex values of the buffers of Forward and Inverse */
+		size_t BufferSize() const {
+			return 2 * n_ + fft_.ScratchSize();
+		}
+
+		/**
+		In place forward transform of the lines a and b, of samples 'stride' values apart
+		@param b Second line, may be NULL
+		@param buffer Buffer of BufferSize() values
+		*/
+		void Forward(float* a, float* b, size_t stride, Complex* buffer) const {
+			Complex* v = buffer;
+			Complex* V = buffer + n_;
+			// v = even samples, followed by the odd samples in reverse order
+			for (size_t j = 0; 2 * j < n_; j++) {
+				v[j] = Complex(a[2 * j * stride], b ? b[2 * j * stride] : 0);
+			}
+			for (size_t j = 0; 2 * j + 1 < n_; j++) {
+				v[n_ - 1 - j] = Complex(a[(2 * j + 1) * stride], b ? b[(2 * j + 1) * stride] : 0);
+			}
+			fft_.Forward(v, V, buffer + 2 * n_);
+			for (size_t k = 0; k < n_; k++) {
+				// transforms of the real and imaginary parts, from the hermitian symmetry of real sequences
+				const Complex Vk = V[k];
+				const Complex Vnk = std::conj(V[k == 0 ? 0 : n_ - k]);
+				const Complex A = 0.5 * (Vk + Vnk);
+				const Complex d = 0.5 * (Vk - Vnk);
+				const Complex B(d.imag(), -d.real());
+				a[k * stride] = static_cast<float>(Mul(A, shift_[k]).real());
+				if (b) {
+					b[k * stride] = static_cast<float>(Mul(B, shift_[k]).real());
+				}
+			}
+		}
+
+		/**
+		In place inverse transform of the lines a and b, see Forward
+		*/
+		void Inverse(float* a, float* b, size_t stride, Complex* buffer) const {
+			Complex* V = buffer;
+			Complex* v = buffer + n_;
+			for (size_t k = 0; k < n_; k++) {
+				// V(k) = (X(k) - i X(n - k)) exp(i pi k / 2n), with X(n) = 0
+				const Complex shift = std::conj(shift_[k]);
+				const Complex Va = Mul(Complex(a[k * stride], k == 0 ? 0 : -a[(n_ - k) * stride]), shift);
+				const Complex Vb = b ? Mul(Complex(b[k * stride], k == 0 ? 0 : -b[(n_ - k) * stride]), shift) : Complex();
+				// conjugate of Va + i Vb, for the inverse complex transform
+				V[k] = std::conj(Complex(Va.real() - Vb.imag(), Va.imag() + Vb.real()));
+			}
+			fft_.Forward(V, v, buffer + 2 * n_);
+			const double scale = 1.0 / static_cast<double>(n_);
+			for (size_t j = 0; 2 * j < n_; j++) {
+				a[2 * j * stride] = static_cast<float>(v[j].real() * scale);
+				if (b) {
+					b[2 * j * stride] = static_cast<float>(-v[j].imag() * scale);
+				}
+			}
+			for (size_t j = 0; 2 * j + 1 < n_; j++) {
+				a[(2 * j + 1) * stride] = static_cast<float>(v[n_ - 1 - j].real() * scale);
+				if (b) {
+					b[(2 * j + 1) * stride] = static_cast<float>(-v[n_ - 1 - j].imag() * scale);
+				}
+			}
+		}
+
+	private:
+		size_t n_;
+		FFT fft_;
+		std::vector<Complex> shift_;	// exp(-i pi k / 2n)
+	};
+
+	/** Number of columns transformed together by the column pass */
+	constexpr unsigned StripColumns = 16;
+
+	/**
+	Forward or inverse 2D transform of a FIT_FLOAT image, in place : rows are transformed by pairs,
+	then columns by strips copied to a contiguous buffer.
+	@return Returns false when out of memory
+	*/
+	bool Transform2D(FIBITMAP* U, const DCT& row_dct, const DCT& column_dct, bool inverse) {
+		const unsigned width = FreeImage_GetWidth(U);
+		const unsigned height = FreeImage_GetHeight(U);
+		std::atomic<bool> out_of_memory{ false };
+
+		auto transform = [inverse](const DCT& dct, float* a, float* b, size_t stride, Complex* buffer) {
+			if (inverse) {
+				dct.Inverse(a, b, stride, buffer);
+			}
+			else {
+				dct.Forward(a, b, stride, buffer);
+			}
+		};
+
+		// rows
+		const unsigned row_pairs = (height + 1) / 2;
+		ParallelForRows(row_pairs, 2 * width * sizeof(Complex), [&](unsigned first_pair, unsigned end_pair) {
+			try {
+				std::vector<Complex> buffer(row_dct.BufferSize());
+				for (unsigned pair = first_pair; pair < end_pair; pair++) {
+					const unsigned y = 2 * pair;
+					float* a = reinterpret_cast<float*>(FreeImage_GetScanLine(U, y));
+					float* b = (y + 1 < height) ? reinterpret_cast<float*>(FreeImage_GetScanLine(U, y + 1)) : nullptr;
+					transform(row_dct, a, b, 1, buffer.data());
+				}
+			}
+			catch (const std::bad_alloc&) {
+				out_of_memory = true;
+			}
+		});
+
+		// columns
+		const unsigned strip_count = (width + StripColumns - 1) / StripColumns;
+		ParallelForRows(strip_count, static_cast<size_t>(height) * StripColumns * sizeof(Complex), [&](unsigned first_strip, unsigned end_strip) {
+			try {
+				std::vector<Complex> buffer(column_dct.BufferSize());
+				std::vector<float> strip(static_cast<size_t>(height) * StripColumns);
+				for (unsigned s = first_strip; s < end_strip; s++) {
+					const unsigned x0 = s * StripColumns;
+					const unsigned columns = std::min(StripColumns, width - x0);
+					for (unsigned y = 0; y < height; y++) {
+						const float* row = reinterpret_cast<const float*>(FreeImage_GetScanLine(U, y)) + x0;
+						std::copy(row, row + columns, strip.data() + static_cast<size_t>(y) * StripColumns);
+					}
+					for (unsigned c = 0; c < columns; c += 2) {
+						float* a = strip.data() + c;
+						float* b = (c + 1 < columns) ? a + 1 : nullptr;
+						transform(column_dct, a, b, StripColumns, buffer.data());
+					}
+					for (unsigned y = 0; y < height; y++) {
+						const float* values = strip.data() + static_cast<size_t>(y) * StripColumns;
+						std::copy(values, values + columns, reinterpret_cast<float*>(FreeImage_GetScanLine(U, y)) + x0);
+					}
+				}
+			}
+			catch (const std::bad_alloc&) {
+				out_of_memory = true;
+			}
+		});
+
+		return !out_of_memory;
+	}
+
+	/** Eigenvalues 2 cos(pi k / n) - 2 of the second difference with reflected boundaries */
+	std::vector<double> SecondDifferenceEigenvalues(unsigned n) {
+		std::vector<double> values(n);
+		for (unsigned k = 0; k < n; k++) {
+			values[k] = 2 * std::cos(Pi * k / n) - 2;
+		}
+		return values;
+	}
+
+} // namespace
+
+/**
+Poisson solver based on the discrete cosine transform.
+This routine solves the Poisson equation Laplacian(U) = Laplacian on the rectangular domain of the image,
+with Neumann boundary conditions (the image is reflected across its edges), remaps the result pixels to [0..1]
+and returns the solution. The discrete Laplacian is the 5-point stencil : the divergence of forward differences,
+taken with backward differences, is solved exactly. The mean of the solution is not defined by the equation,
+and the mean of the Laplacian is ignored.<br>
+Unlike FreeImage_MultigridPoissonSolver, the image is not padded to a (2^j + 1)x(2^j + 1) square :
+the working memory is about the size of the result, and rows and columns are transformed in parallel.
+@param Laplacian Laplacian image (FIT_FLOAT)
+@return Returns the solved PDE equations if successful, returns NULL otherwise
+@see FreeImage_MultigridPoissonSolver
+*/
+FIBITMAP* DLL_CALLCONV
+FreeImage_DCTPoissonSolver(FIBITMAP *Laplacian) {
+	if (!FreeImage_HasPixels(Laplacian) || (FreeImage_GetImageType(Laplacian) != FIT_FLOAT)) {
+		return nullptr;
+	}
+
+	const unsigned width = FreeImage_GetWidth(Laplacian);
+	const unsigned height = FreeImage_GetHeight(Laplacian);
+
+	UniqueBitmap U(FreeImage_Clone(Laplacian), &::FreeImage_Unload);
+	if (!U) {
+		return nullptr;
+	}
+
+	try {
+		const DCT row_dct(width);
+		const DCT column_dct(height);
+		const std::vector<double> row_values = SecondDifferenceEigenvalues(width);
+		const std::vector<double> column_values = SecondDifferenceEigenvalues(height);
+
+		if (!Transform2D(U.get(), row_dct, column_dct, false)) {
+			throw std::bad_alloc();
+		}
+
+		// the Laplacian is diagonal in the cosine basis
+		ParallelForRows(height, width * sizeof(float), [&](unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; y++) {
+				float* coefficients = reinterpret_cast<float*>(FreeImage_GetScanLine(U.get(), y));
+				for (unsigned x = 0; x < width; x++) {
+					const double eigenvalue = row_values[x] + column_values[y];
+					coefficients[x] = (eigenvalue != 0) ? static_cast<float>(coefficients[x] / eigenvalue) : 0;
+				}
+			}
+		});
+
+		if (!Transform2D(U.get(), row_dct, column_dct, true)) {
+			throw std::bad_alloc();
+		}
+	}
+	catch (const std::bad_alloc&) {
+		FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+		return nullptr;
+	}
+
+	// remap pixels to [0..1]
+	NormalizeY(U.get(), 0, 1);
+
+	return U.release();
+}
@@ -22,6 +22,348 @@
 #include "FreeImage.h"
 #include "Utilities.h"
 #include "FreeImage/SimpleTools.h"
+#include "FreeImage/SimdFloat4.h"
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+namespace
+{
+
+	// ----------------------------------------------------------
+	//  Alpha arithmetic : integer products are rounded as (x * a + max / 2) / max,
+	//  computed without division
+	// ----------------------------------------------------------
+
+	/** (v + 127) / 255, for v <= 255 * 255 */
+	inline uint32_t Div255(uint32_t v)
+	{
+		v += 128;
+		return (v + (v >> 8)) >> 8;
+	}
+
+	/** (v + 32767) / 65535, for v <= 65535 * 65535 */
+	inline uint32_t Div65535(uint32_t v)
+	{
+		v += 32768;
+		return (v + (v >> 16)) >> 16;
+	}
+
+#if defined(FI_FLOAT4_SSE2)
+	static_assert(FI_RGBA_ALPHA == 3, "the SSE2 kernels expect the alpha channel in the last byte of a pixel");
+
+	/** Div255 of 8 16-bit lanes */
+	inline __m128i Div255_SSE2(__m128i v)
+	{
+		v = _mm_add_epi16(v, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+	}
+
+	/** Div65535 of 4 32-bit lanes, sign extended from 16 bits for _mm_packs_epi32 */
+	inline __m128i Div65535_SSE2(__m128i v)
+	{
+		v = _mm_add_epi32(v, _mm_set1_epi32(32768));
+		return _mm_srai_epi32(_mm_add_epi32(v, _mm_srli_epi32(v, 16)), 16);
+	}
+
+	/** Broadcast the alpha channel of 2 pixels with 16-bit channels */
+	inline __m128i SplatAlpha16_SSE2(__m128i v)
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	/** Color channels of a, alpha channels of b */
+	inline __m128i SelectColor_SSE2(__m128i alpha_mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(alpha_mask, b), _mm_andnot_si128(alpha_mask, a));
+	}
+#endif
+
+	// ----------------------------------------------------------
+	//  Premultiplication of a line of RGBA pixels
+	// ----------------------------------------------------------
+
+	void PreMultiplyLine(FIRGBA8* pixels, unsigned width)
+	{
+		unsigned x = 0;
+#if defined(FI_FLOAT4_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+		for (; x + 4 <= width; x += 4) {
+			const auto p = reinterpret_cast<__m128i*>(pixels + x);
+			const __m128i v = _mm_loadu_si128(p);
+			const __m128i lo = _mm_unpacklo_epi8(v, zero);
+			const __m128i hi = _mm_unpackhi_epi8(v, zero);
+			const __m128i r = _mm_packus_epi16(Div255_SSE2(_mm_mullo_epi16(lo, SplatAlpha16_SSE2(lo))), Div255_SSE2(_mm_mullo_epi16(hi, SplatAlpha16_SSE2(hi))));
+			_mm_storeu_si128(p, SelectColor_SSE2(alpha_mask, r, v));
+		}
+#endif
+		for (; x < width; ++x) {
+			FIRGBA8& p = pixels[x];
+			const uint32_t alpha = p.alpha;
+			p.red   = static_cast<uint8_t>(Div255(p.red * alpha));
+			p.green = static_cast<uint8_t>(Div255(p.green * alpha));
+			p.blue  = static_cast<uint8_t>(Div255(p.blue * alpha));
+		}
+	}
+
+	void PreMultiplyLine(FIRGBA16* pixels, unsigned width)
+	{
+		unsigned x = 0;
+#if defined(FI_FLOAT4_SSE2)
+		const __m128i alpha_mask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+		for (; x + 2 <= width; x += 2) {
+			const auto p = reinterpret_cast<__m128i*>(pixels + x);
+			const __m128i v = _mm_loadu_si128(p);
+			const __m128i alpha = SplatAlpha16_SSE2(v);
+			const __m128i lo = _mm_mullo_epi16(v, alpha);
+			const __m128i hi = _mm_mulhi_epu16(v, alpha);
+			const __m128i r = _mm_packs_epi32(Div65535_SSE2(_mm_unpacklo_epi16(lo, hi)), Div65535_SSE2(_mm_unpackhi_epi16(lo, hi)));
+			_mm_storeu_si128(p, SelectColor_SSE2(alpha_mask, r, v));
+		}
+#endif
+		for (; x < width; ++x) {
+			FIRGBA16& p = pixels[x];
+			const uint32_t alpha = p.alpha;
+			p.red   = static_cast<uint16_t>(Div65535(p.red * alpha));
+			p.green = static_cast<uint16_t>(Div65535(p.green * alpha));
+			p.blue  = static_cast<uint16_t>(Div65535(p.blue * alpha));
+		}
+	}
+
+	void PreMultiplyLine(FIRGBAF* pixels, unsigned width)
+	{
+		const Float4 one = Float4::Set(1.0f);
+		for (unsigned x = 0; x < width; ++x) {
+			float* p = &pixels[x].red;
+			const Float4 v = Float4::Load(p);
+			(v * v.SplatW().WithW(one)).Store(p);
+		}
+	}
+
+	// ----------------------------------------------------------
+	//  Inverse of the premultiplication : color = min(max, (color * max + alpha / 2) / alpha),
+	//  colors of transparent pixels are black
+	// ----------------------------------------------------------
+
+	/** Unpremultiplied 8-bit values, indexed by alpha * 256 + color */
+	const uint8_t* UnPreMultiplyTable()
+	{
+		static const std::vector<uint8_t> table = []() {
+			std::vector<uint8_t> values(256 * 256, 0);
+			for (uint32_t alpha = 1; alpha < 256; ++alpha) {
+				for (uint32_t color = 0; color < 256; ++color) {
+					values[alpha * 256 + color] = static_cast<uint8_t>(std::min<uint32_t>(255, (color * 255 + alpha / 2) / alpha));
+				}
+			}
+			return values;
+		}();
+		return table.data();
+	}
+
+	void UnPreMultiplyLine(FIRGBA8* pixels, unsigned width)
+	{
+		const uint8_t* table = UnPreMultiplyTable();
+		for (unsigned x = 0; x < width; ++x) {
+			FIRGBA8& p = pixels[x];
+			const uint8_t* colors = table + 256 * p.alpha;
+			p.red   = colors[p.red];
+			p.green = colors[p.green];
+			p.blue  = colors[p.blue];
+		}
+	}
+
+	void UnPreMultiplyLine(FIRGBA16* pixels, unsigned width)
+	{
+		auto unpremultiply = [](uint32_t color, uint32_t alpha) {
+			return static_cast<uint16_t>(std::min<uint32_t>(65535, (color * 65535 + alpha / 2) / alpha));
+		};
+		for (unsigned x = 0; x < width; ++x) {
+			FIRGBA16& p = pixels[x];
+			const uint32_t alpha = p.alpha;
+			if (alpha == 0) {
+				p.red = p.green = p.blue = 0;
+			}
+			else if (alpha != 65535) {
+				p.red   = unpremultiply(p.red, alpha);
+				p.green = unpremultiply(p.green, alpha);
+				p.blue  = unpremultiply(p.blue, alpha);
+			}
+		}
+	}
+
+	void UnPreMultiplyLine(FIRGBAF* pixels, unsigned width)
+	{
+		const Float4 zero = Float4::Set(0.0f);
+		for (unsigned x = 0; x < width; ++x) {
+			float* p = &pixels[x].red;
+			const Float4 v = Float4::Load(p);
+			const Float4 alpha = v.SplatW();
+			Select(alpha > zero, v / alpha, zero).WithW(v).Store(p);
+		}
+	}
+
+	/**
+	Run line_op(pixels, width) on the lines of a 32-bit, RGBA16 or RGBAF image, in parallel
+	@return Returns FALSE if the image type is not supported
+	*/
+	template <typename LineOperation_>
+	FIBOOL ForEachAlphaLine(FIBITMAP* dib, LineOperation_ line_op)
+	{
+		if (!FreeImage_HasPixels(dib)) {
+			return FALSE;
+		}
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+
+		auto for_each_line = [&](auto* pixel_type) {
+			using Pixel_ = std::remove_pointer_t<decltype(pixel_type)>;
+			ParallelForRows(height, width * sizeof(Pixel_), [&](unsigned first_row, unsigned end_row) {
+				for (unsigned y = first_row; y < end_row; ++y) {
+					line_op(reinterpret_cast<Pixel_*>(FreeImage_GetScanLine(dib, y)), width);
+				}
+			});
+			return TRUE;
+		};
+
+		switch (FreeImage_GetImageType(dib)) {
+		case FIT_BITMAP:
+			if (FreeImage_GetBPP(dib) != 32) {
+				return FALSE;
+			}
+			return for_each_line(static_cast<FIRGBA8*>(nullptr));
+		case FIT_RGBA16:
+			return for_each_line(static_cast<FIRGBA16*>(nullptr));
+		case FIT_RGBAF:
+			return for_each_line(static_cast<FIRGBAF*>(nullptr));
+		default:
+			return FALSE;
+		}
+	}
+
+	// ----------------------------------------------------------
+	//  Composition of a line of RGBA pixels over a background line
+	// ----------------------------------------------------------
+
+	/**
+	Composite 32-bit foreground pixels over 32-bit background pixels (alpha ignored), result in bg
+	*/
+	void CompositeOverLine(uint8_t* bg, const uint8_t* fg, unsigned width, bool premultiplied)
+	{
+		unsigned x = 0;
+#if defined(FI_FLOAT4_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i max = _mm_set1_epi16(255);
+		auto blend = [&](__m128i f, __m128i b) {
+			const __m128i alpha = SplatAlpha16_SSE2(f);
+			const __m128i b_part = _mm_mullo_epi16(b, _mm_sub_epi16(max, alpha));
+			return premultiplied
+				? _mm_add_epi16(f, Div255_SSE2(b_part))
+				: Div255_SSE2(_mm_add_epi16(_mm_mullo_epi16(f, alpha), b_part));
+		};
+		for (; x + 4 <= width; x += 4) {
+			const __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fg + 4 * x));
+			const auto p = reinterpret_cast<__m128i*>(bg + 4 * x);
+			const __m128i b = _mm_loadu_si128(p);
+			const __m128i lo = blend(_mm_unpacklo_epi8(f, zero), _mm_unpacklo_epi8(b, zero));
+			const __m128i hi = blend(_mm_unpackhi_epi8(f, zero), _mm_unpackhi_epi8(b, zero));
+			_mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; x < width; ++x) {
+			const uint8_t* f = fg + 4 * x;
+			uint8_t* b = bg + 4 * x;
+			const uint32_t alpha = f[FI_RGBA_ALPHA];
+			for (unsigned c = 0; c < 3; ++c) {
+				const uint32_t b_part = b[c] * (255 - alpha);
+				b[c] = static_cast<uint8_t>(premultiplied ? std::min<uint32_t>(255, f[c] + Div255(b_part)) : Div255(f[c] * alpha + b_part));
+			}
+		}
+	}
+
+	inline uint16_t CompositeChannel(uint16_t f, uint16_t alpha, uint16_t b, bool premultiplied)
+	{
+		const uint32_t b_part = b * (65535u - alpha);
+		return static_cast<uint16_t>(premultiplied ? std::min<uint32_t>(65535, f + Div65535(b_part)) : Div65535(f * static_cast<uint32_t>(alpha) + b_part));
+	}
+
+	inline float CompositeChannel(float f, float alpha, float b, bool premultiplied)
+	{
+		return (premultiplied ? f : f * alpha) + b * (1.0f - alpha);
+	}
+
+	/** Composite RGBA16 or RGBAF foreground pixels over RGB16 or RGBF background pixels */
+	template <typename FgPixel_, typename Pixel_>
+	void CompositeOverLine(Pixel_* dst, const FgPixel_* fg, const Pixel_* bg, unsigned width, bool premultiplied)
+	{
+		for (unsigned x = 0; x < width; ++x) {
+			const FgPixel_& f = fg[x];
+			dst[x].red   = CompositeChannel(f.red, f.alpha, bg[x].red, premultiplied);
+			dst[x].green = CompositeChannel(f.green, f.alpha, bg[x].green, premultiplied);
+			dst[x].blue  = CompositeChannel(f.blue, f.alpha, bg[x].blue, premultiplied);
+		}
+	}
+
+	/** 8-bit color converted to the range of a pixel type */
+	template <typename Pixel_>
+	Pixel_ MakeColor(uint8_t red, uint8_t green, uint8_t blue)
+	{
+		using Value_ = ToValueType<Pixel_>;
+		auto scale = [](uint8_t v) {
+			if constexpr (std::is_floating_point_v<Value_>) {
+				return static_cast<Value_>(v / 255.0f);
+			}
+			else {
+				return static_cast<Value_>(v * (std::numeric_limits<Value_>::max() / 255));
+			}
+		};
+		Pixel_ p{};
+		p.red   = scale(red);
+		p.green = scale(green);
+		p.blue  = scale(blue);
+		return p;
+	}
+
+	/** Fill a background line with a color, or with a checkerboard pattern if color is NULL */
+	template <typename Pixel_>
+	void FillBackgroundLine(Pixel_* line, unsigned y, unsigned width, const Pixel_* color)
+	{
+		if (color) {
+			std::fill(line, line + width, *color);
+			return;
+		}
+		const Pixel_ dark = MakeColor<Pixel_>(192, 192, 192);
+		const Pixel_ light = MakeColor<Pixel_>(255, 255, 255);
+		for (unsigned x = 0; x < width; ++x) {
+			line[x] = (((y & 0x8) == 0) ^ ((x & 0x8) == 0)) ? dark : light;
+		}
+	}
+
+	/** Composite a RGBA16 or RGBAF image into a RGB16 or RGBF image */
+	template <typename FgPixel_, typename Pixel_>
+	void CompositeRows(FIBITMAP* dst, FIBITMAP* fg, FIBITMAP* bg, const FIRGBA8* bkcolor, bool premultiplied)
+	{
+		const unsigned width = FreeImage_GetWidth(fg);
+		const unsigned height = FreeImage_GetHeight(fg);
+		const Pixel_ color = bkcolor ? MakeColor<Pixel_>(bkcolor->red, bkcolor->green, bkcolor->blue) : Pixel_{};
+
+		ParallelForRows(height, width * (sizeof(FgPixel_) + 2 * sizeof(Pixel_)), [&](unsigned first_row, unsigned end_row) {
+			std::vector<Pixel_> fill(width);
+			for (unsigned y = first_row; y < end_row; ++y) {
+				const Pixel_* bg_line = fill.data();
+				if (bkcolor || !bg) {
+					FillBackgroundLine(fill.data(), y, width, bkcolor ? &color : nullptr);
+				}
+				else {
+					bg_line = reinterpret_cast<const Pixel_*>(FreeImage_GetScanLine(bg, y));
+				}
+				CompositeOverLine(reinterpret_cast<Pixel_*>(FreeImage_GetScanLine(dst, y)), reinterpret_cast<const FgPixel_*>(FreeImage_GetScanLine(fg, y)), bg_line, width, premultiplied);
+			}
+		});
+	}
+
+} // namespace
 
 
 /**
@@ -31,56 +373,57 @@ The equation for computing a composited sample value is:<br>
 output = alpha * foreground + (1-alpha) * background<br>
 where alpha and the input and output sample values are expressed as fractions in the range 0 to 1. 
 For colour images, the computation is done separately for R, G, and B samples.
+With premultiplied foreground colors, the equation is output = foreground + (1-alpha) * background.
+
+Supported foreground images are 8-bit and 32-bit FIT_BITMAP (composited into a 24-bit image),
+FIT_RGBA16 (composited into a FIT_RGB16 image) and FIT_RGBAF (composited into a FIT_RGBF image).
 
 @param fg Foreground image
 @param useFileBkg If TRUE and a file background is present, use it as the background color
 @param appBkColor If not equal to NULL, and useFileBkg is FALSE, use this color as the background color
-@param bg If not equal to NULL and useFileBkg is FALSE and appBkColor is NULL, use this as the background image
+@param bg If not equal to NULL and useFileBkg is FALSE and appBkColor is NULL, use this as the background image. 
+Its size must be the size of fg, and its type the type of the composite image.
+@param options FI_ALPHA_STRAIGHT or FI_ALPHA_PREMULTIPLIED, tells whether the colors of fg are premultiplied by alpha
 @return Returns the composite image if successful, returns NULL otherwise
 @see FreeImage_IsTransparent, FreeImage_HasBackgroundColor
 */
 FIBITMAP * DLL_CALLCONV
-FreeImage_Composite(FIBITMAP *fg, FIBOOL useFileBkg, FIRGBA8 *appBkColor, FIBITMAP *bg) {
+FreeImage_CompositeEx(FIBITMAP *fg, FIBOOL useFileBkg, FIRGBA8 *appBkColor, FIBITMAP *bg, int options) {
 	if (!FreeImage_HasPixels(fg)) return nullptr;
 
-	const int width  = FreeImage_GetWidth(fg);
-	const int height = FreeImage_GetHeight(fg);
-	const int bpp    = FreeImage_GetBPP(fg);
-
-	if ((bpp != 8) && (bpp != 32))
-		return nullptr;
+	const unsigned width  = FreeImage_GetWidth(fg);
+	const unsigned height = FreeImage_GetHeight(fg);
+	const unsigned bpp    = FreeImage_GetBPP(fg);
+	const bool premultiplied = (options & FI_ALPHA_PREMULTIPLIED) != 0;
+
+	// type of the composite image
+	FREE_IMAGE_TYPE dst_type = FIT_BITMAP;
+	switch (FreeImage_GetImageType(fg)) {
+		case FIT_BITMAP:
+			if ((bpp != 8) && (bpp != 32)) {
+				return nullptr;
+			}
+			break;
+		case FIT_RGBA16:
+			dst_type = FIT_RGB16;
+			break;
+		case FIT_RGBAF:
+			dst_type = FIT_RGBF;
+			break;
+		default:
+			return nullptr;
+	}
 
 	if (bg) {
-		const int bg_width  = FreeImage_GetWidth(bg);
-		const int bg_height = FreeImage_GetHeight(bg);
-		const int bg_bpp    = FreeImage_GetBPP(bg);
-		if ((bg_width != width) || (bg_height != height) || (bg_bpp != 24))
+		if ((FreeImage_GetWidth(bg) != width) || (FreeImage_GetHeight(bg) != height) || (FreeImage_GetImageType(bg) != dst_type))
+			return nullptr;
+		if ((dst_type == FIT_BITMAP) && (FreeImage_GetBPP(bg) != 24))
 			return nullptr;
 	}
 
-	int bytespp = (bpp == 8) ? 1 : 4;
-
-	
-	int x, y, c;
-	uint8_t alpha = 0, not_alpha;
-	uint8_t index;
-	FIRGBA8 fgc;	// foreground color
 	FIRGBA8 bkc;	// background color
-
-	memset(&fgc, 0, sizeof(FIRGBA8));
 	memset(&bkc, 0, sizeof(FIRGBA8));
 
-	// allocate the composite image
-	FIBITMAP *composite = FreeImage_Allocate(width, height, 24, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
-	if (!composite) return nullptr;
-
-	// get the palette
-	const FIRGBA8 *pal = FreeImage_GetPalette(fg);
-
-	// retrieve the alpha table from the foreground image
-	FIBOOL bIsTransparent = FreeImage_IsTransparent(fg);
-	const uint8_t *trns = FreeImage_GetTransparencyTable(fg);
-
 	// retrieve the background color from the foreground image
 	FIBOOL bHasBkColor = FALSE;
 
@@ -100,82 +443,51 @@ FreeImage_Composite(FIBITMAP *fg, FIBOOL useFileBkg, FIRGBA8 *appBkColor, FIBITM
 		}
 	}
 
-	for (y = 0; y < height; y++) {
-		// foreground
-		uint8_t *fg_bits = FreeImage_GetScanLine(fg, y);
-		// background
-		uint8_t *bg_bits = FreeImage_GetScanLine(bg, y);
-		// composite image
-		uint8_t *cp_bits = FreeImage_GetScanLine(composite, y);
-
-		for (x = 0; x < width; x++) {
-
-			// foreground color + alpha
-
-			if (bpp == 8) {
-				// get the foreground color
-				index = fg_bits[0];
-				memcpy(&fgc, &pal[index], sizeof(FIRGBA8));
-				// get the alpha
-				if (bIsTransparent) {
-					alpha = trns[index];
-				} else {
-					alpha = 255;
-				}
-			}
-			else if (bpp == 32) {
-				// get the foreground color
-				fgc.blue  = fg_bits[FI_RGBA_BLUE];
-				fgc.green = fg_bits[FI_RGBA_GREEN];
-				fgc.red   = fg_bits[FI_RGBA_RED];
-				// get the alpha
-				alpha = fg_bits[FI_RGBA_ALPHA];
-			}
-
-			// background color
+	// allocate the composite image
+	FIBITMAP *composite = (dst_type == FIT_BITMAP)
+		? FreeImage_Allocate(width, height, 24, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK)
+		: FreeImage_AllocateT(dst_type, width, height);
+	if (!composite) return nullptr;
 
-			if (!bHasBkColor) {
-				if (bg) {
-					// get the background color from the background image
-					bkc.blue  = bg_bits[FI_RGBA_BLUE];
-					bkc.green = bg_bits[FI_RGBA_GREEN];
-					bkc.red   = bg_bits[FI_RGBA_RED];
-				}
-				else {
-					// use a checkerboard pattern
-					c = (((y & 0x8) == 0) ^ ((x & 0x8) == 0)) * 192;
-					c = c ? c : 255;
-					bkc.blue  = (uint8_t)c;
-					bkc.green = (uint8_t)c;
-					bkc.red   = (uint8_t)c;
+	switch (dst_type) {
+		case FIT_RGB16:
+			CompositeRows<FIRGBA16, FIRGB16>(composite, fg, bg, bHasBkColor ? &bkc : nullptr, premultiplied);
+			break;
+		case FIT_RGBF:
+			CompositeRows<FIRGBAF, FIRGBF>(composite, fg, bg, bHasBkColor ? &bkc : nullptr, premultiplied);
+			break;
+		default: {
+			// get the palette and the alpha table of 8-bit images
+			FIRGBA8 *pal = FreeImage_GetPalette(fg);
+			const uint8_t *trns = FreeImage_IsTransparent(fg) ? FreeImage_GetTransparencyTable(fg) : nullptr;
+			const unsigned trns_count = FreeImage_GetTransparencyCount(fg);
+
+			// foreground and background lines are composited as 32-bit pixels
+			ParallelForRows(height, width * 11, [&](unsigned first_row, unsigned end_row) {
+				std::vector<uint8_t> fg_line((bpp == 8) ? 4 * width : 0);
+				std::vector<uint8_t> bg_line(4 * width);
+				for (unsigned y = first_row; y < end_row; ++y) {
+					const uint8_t *fg_bits = FreeImage_GetScanLine(fg, y);
+					if (bpp == 8) {
+						FreeImage_ConvertLine8To32(fg_line.data(), const_cast<uint8_t*>(fg_bits), width, pal);
+						if (trns) {
+							for (unsigned x = 0; x < width; ++x) {
+								fg_line[4 * x + FI_RGBA_ALPHA] = (fg_bits[x] < trns_count) ? trns[fg_bits[x]] : 0xFF;
+							}
+						}
+						fg_bits = fg_line.data();
+					}
+					if (!bHasBkColor && bg) {
+						FreeImage_ConvertLine24To32(bg_line.data(), FreeImage_GetScanLine(bg, y), width);
+					}
+					else {
+						FillBackgroundLine(reinterpret_cast<FIRGBA8*>(bg_line.data()), y, width, bHasBkColor ? &bkc : nullptr);
+					}
+					CompositeOverLine(bg_line.data(), fg_bits, width, premultiplied);
+					FreeImage_ConvertLine32To24(FreeImage_GetScanLine(composite, y), bg_line.data(), width);
 				}
-			}
-
-			// composition
-
-			if (alpha == 0) {
-				// output = background
-				cp_bits[FI_RGBA_BLUE] = bkc.blue;
-				cp_bits[FI_RGBA_GREEN] = bkc.green;
-				cp_bits[FI_RGBA_RED] = bkc.red;
-			}
-			else if (alpha == 255) {
-				// output = foreground
-				cp_bits[FI_RGBA_BLUE] = fgc.blue;
-				cp_bits[FI_RGBA_GREEN] = fgc.green;
-				cp_bits[FI_RGBA_RED] = fgc.red;
-			}
-			else {
-				// output = alpha * foreground + (1-alpha) * background
-				not_alpha = (uint8_t)~alpha;
-				cp_bits[FI_RGBA_BLUE] = (uint8_t)((alpha * (uint16_t)fgc.blue  + not_alpha * (uint16_t)bkc.blue) >> 8);
-				cp_bits[FI_RGBA_GREEN] = (uint8_t)((alpha * (uint16_t)fgc.green + not_alpha * (uint16_t)bkc.green) >> 8);
-				cp_bits[FI_RGBA_RED] = (uint8_t)((alpha * (uint16_t)fgc.red   + not_alpha * (uint16_t)bkc.red) >> 8);
-			}
-
-			fg_bits += bytespp;
-			bg_bits += 3;
-			cp_bits += 3;
+			});
+			break;
 		}
 	}
 
@@ -186,80 +498,109 @@ FreeImage_Composite(FIBITMAP *fg, FIBOOL useFileBkg, FIRGBA8 *appBkColor, FIBITM
 }
 
 /**
-Pre-multiplies a 32-bit image's red-, green- and blue channels with it's alpha channel 
-for to be used with e.g. the Windows GDI function AlphaBlend(). 
+@brief Composite a straight alpha foreground image against a background color or a background image.
+@see FreeImage_CompositeEx
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_Composite(FIBITMAP *fg, FIBOOL useFileBkg, FIRGBA8 *appBkColor, FIBITMAP *bg) {
+	return FreeImage_CompositeEx(fg, useFileBkg, appBkColor, bg, FI_ALPHA_STRAIGHT);
+}
+
+/**
+Pre-multiplies the red-, green- and blue channels of a 32-bit, FIT_RGBA16 or FIT_RGBAF image with its alpha channel, 
+for to be used with e.g. the Windows GDI function AlphaBlend(), or to resize and composite images without color halos. 
 The transformation changes the red-, green- and blue channels according to the following equation:  
-channel(x, y) = channel(x, y) * alpha_channel(x, y) / 255  
+channel(x, y) = channel(x, y) * alpha_channel(x, y) / max  
+where max is 255 for 32-bit images, 65535 for FIT_RGBA16 images and 1 for FIT_RGBAF images. 
+Integer results are rounded to the nearest value.
 @param dib Input/Output dib to be premultiplied
 @return Returns TRUE on success, FALSE otherwise (e.g. when the bitdepth of the source dib cannot be handled). 
+@see FreeImage_UnPreMultiplyWithAlpha
 */
 FIBOOL DLL_CALLCONV 
 FreeImage_PreMultiplyWithAlpha(FIBITMAP *dib) {
-	if (!FreeImage_HasPixels(dib)) return FALSE;
-	
-	if ((FreeImage_GetBPP(dib) != 32) || (FreeImage_GetImageType(dib) != FIT_BITMAP)) {
-		return FALSE;
-	}
+	return ForEachAlphaLine(dib, [](auto *pixels, unsigned width) { PreMultiplyLine(pixels, width); });
+}
 
-	const int width = FreeImage_GetWidth(dib);
-	const int height = FreeImage_GetHeight(dib);
-
-	for (int y = 0; y < height; y++) {
-		uint8_t *bits = FreeImage_GetScanLine(dib, y);
-		for (int x = 0; x < width; x++, bits += 4) {
-			const uint8_t alpha = bits[FI_RGBA_ALPHA];
-			// slightly faster: care for two special cases
-			if (alpha == 0x00) {
-				// special case for alpha == 0x00
-				// color * 0x00 / 0xFF = 0x00
-				bits[FI_RGBA_BLUE] = 0x00;
-				bits[FI_RGBA_GREEN] = 0x00;
-				bits[FI_RGBA_RED] = 0x00;
-			} else if (alpha == 0xFF) {
-				// nothing to do for alpha == 0xFF
-				// color * 0xFF / 0xFF = color
-				continue;
-			} else {
-				bits[FI_RGBA_BLUE] = (uint8_t)( (alpha * (uint16_t)bits[FI_RGBA_BLUE] + 127) / 255 );
-				bits[FI_RGBA_GREEN] = (uint8_t)( (alpha * (uint16_t)bits[FI_RGBA_GREEN] + 127) / 255 );
-				bits[FI_RGBA_RED] = (uint8_t)( (alpha * (uint16_t)bits[FI_RGBA_RED] + 127) / 255 );
-			}
-		}
-	}
-	return TRUE;
+/**
+Reverts FreeImage_PreMultiplyWithAlpha on a 32-bit, FIT_RGBA16 or FIT_RGBAF image :  
+channel(x, y) = channel(x, y) * max / alpha_channel(x, y)  
+Integer results are rounded to the nearest value and clamped to max, 
+the colors of fully transparent pixels are set to 0.
+@param dib Input/Output dib to be unpremultiplied
+@return Returns TRUE on success, FALSE otherwise (e.g. when the bitdepth of the source dib cannot be handled). 
+@see FreeImage_PreMultiplyWithAlpha
+*/
+FIBOOL DLL_CALLCONV 
+FreeImage_UnPreMultiplyWithAlpha(FIBITMAP *dib) {
+	return ForEachAlphaLine(dib, [](auto *pixels, unsigned width) { UnPreMultiplyLine(pixels, width); });
 }
 
 
 namespace
 {
 
-	template <typename DstPixel_, typename SrcPixel_ = DstPixel_, typename BinaryOperation_>
-	void DrawRoi(FIBITMAP* dst, FIBITMAP* src, int32_t left, int32_t top, BinaryOperation_ binary_op)
+	/**
+	Rows of src drawn on dst, in top-down coordinates
+	*/
+	struct DrawArea
 	{
-		const int32_t dstW = static_cast<int32_t>(FreeImage_GetWidth(dst));
-		const int32_t dstH = static_cast<int32_t>(FreeImage_GetHeight(dst));
-		const int32_t srcW = static_cast<int32_t>(FreeImage_GetWidth(src));
-		const int32_t srcH = static_cast<int32_t>(FreeImage_GetHeight(src));
+		int32_t dstLeft;		// first column in dst
+		int32_t dstTop;			// first row in dst
+		int32_t srcLeft;		// first column in src
+		int32_t srcTop;			// first row in src
+		int32_t width;
+		int32_t height;
+
+		DrawArea(FIBITMAP* dst, FIBITMAP* src, int32_t left, int32_t top)
+		{
+			const int32_t dstW = static_cast<int32_t>(FreeImage_GetWidth(dst));
+			const int32_t dstH = static_cast<int32_t>(FreeImage_GetHeight(dst));
+			const int32_t srcW = static_cast<int32_t>(FreeImage_GetWidth(src));
+			const int32_t srcH = static_cast<int32_t>(FreeImage_GetHeight(src));
+
+			dstLeft = std::max(0, left);
+			dstTop  = std::max(0, top);
+			srcLeft = dstLeft - left;
+			srcTop  = dstTop - top;
+			width   = std::max(0, std::min(left + srcW, dstW) - dstLeft);
+			height  = std::max(0, std::min(top + srcH, dstH) - dstTop);
+		}
 
-		if (left + srcW <= 0 || top + srcH <= 0) {
-			return;
+		/** Scanline of dst at a row of the area */
+		uint8_t* DstLine(FIBITMAP* dst, unsigned y) const
+		{
+			return FreeImage_GetScanLine(dst, FreeImage_GetHeight(dst) - 1 - (dstTop + y));
 		}
 
-		const int32_t roiLeft   = std::max(0, left);
-		const int32_t roiTop    = std::max(0, top);
-		const int32_t roiRight  = std::min(left + srcW, dstW);
-		const int32_t roiBottom = std::min(top + srcH, dstH);
+		/** Scanline of src at a row of the area */
+		const uint8_t* SrcLine(FIBITMAP* src, unsigned y) const
+		{
+			return FreeImage_GetScanLine(src, FreeImage_GetHeight(src) - 1 - (srcTop + y));
+		}
+
+		/** Run band_op(first_row, end_row) on bands of rows, in parallel */
+		template <typename BandOperation_>
+		void ForEachBand(size_t row_bytes, BandOperation_ band_op) const
+		{
+			ParallelForRows(static_cast<unsigned>(height), static_cast<size_t>(width) * row_bytes, band_op);
+		}
+	};
 
-		const int32_t offsetX = roiLeft - left;
-		const int32_t offsetY = roiTop - top;
 
-		for (int32_t y = roiBottom - roiTop; y > 0; --y) {
-			const auto srcLine = static_cast<const SrcPixel_*>(static_cast<const void*>(FreeImage_GetScanLine(src, srcH - y - offsetY))) + offsetX;
-			const auto dstLine = static_cast<DstPixel_*>(static_cast<void*>(FreeImage_GetScanLine(dst, dstH - roiTop - y))) + roiLeft;
-			for (int32_t x = 0; x < roiRight - roiLeft; ++x) {
-				binary_op(dstLine[x], srcLine[x]);
+	template <typename DstPixel_, typename SrcPixel_ = DstPixel_, typename BinaryOperation_>
+	void DrawRoi(FIBITMAP* dst, FIBITMAP* src, int32_t left, int32_t top, BinaryOperation_ binary_op)
+	{
+		const DrawArea area(dst, src, left, top);
+		area.ForEachBand(sizeof(DstPixel_) + sizeof(SrcPixel_), [&](unsigned first_row, unsigned end_row) {
+			for (unsigned y = first_row; y < end_row; ++y) {
+				const auto srcLine = static_cast<const SrcPixel_*>(static_cast<const void*>(area.SrcLine(src, y))) + area.srcLeft;
+				const auto dstLine = static_cast<DstPixel_*>(static_cast<void*>(area.DstLine(dst, y))) + area.dstLeft;
+				for (int32_t x = 0; x < area.width; ++x) {
+					binary_op(dstLine[x], srcLine[x]);
+				}
 			}
-		}
+		});
 	}
 
 
@@ -309,56 +650,335 @@ namespace
 	};
 
 
-} // namespace
-
+	// ----------------------------------------------------------
+	//  Compositing engine : rows are loaded as RGBA floats in [0, 1],
+	//  composited with the Float4 SIMD vector and stored back
+	// ----------------------------------------------------------
 
+	template <typename Ty_>
+	inline float ToUnit(Ty_ v)
+	{
+		if constexpr (std::is_floating_point_v<Ty_>) {
+			return static_cast<float>(v);
+		}
+		else {
+			return static_cast<float>(v) * (1.0f / std::numeric_limits<Ty_>::max());
+		}
+	}
 
-FIBOOL DLL_CALLCONV
-FreeImage_DrawBitmap(FIBITMAP* dst, FIBITMAP* src, FREE_IMAGE_ALPHA_OPERATION alpha, int32_t left, int32_t top)
-{
-	if (!FreeImage_HasPixels(dst) || !FreeImage_HasPixels(src)) {
-		return FALSE;
+	template <typename Ty_>
+	inline Ty_ FromUnit(float v)
+	{
+		if constexpr (std::is_floating_point_v<Ty_>) {
+			return static_cast<Ty_>(v);
+		}
+		else {
+			return static_cast<Ty_>(std::clamp(v, 0.0f, 1.0f) * std::numeric_limits<Ty_>::max() + 0.5f);
+		}
 	}
 
-	if (FreeImage_GetImageType(dst) != FIT_BITMAP || FreeImage_GetImageType(src) != FIT_BITMAP) {
-		return FALSE;
+	/** Convert a line of pixels to RGBA floats, pixels without alpha are opaque */
+	template <typename Pixel_>
+	void LoadLine(const void* line, float* rgba, unsigned width)
+	{
+		const auto pixels = static_cast<const Pixel_*>(line);
+		for (unsigned x = 0; x < width; ++x, rgba += 4) {
+			const Pixel_& p = pixels[x];
+			if constexpr (PixelChannelsNumber<Pixel_>::value == 1) {
+				rgba[0] = rgba[1] = rgba[2] = ToUnit(p);
+				rgba[3] = 1.0f;
+			}
+			else {
+				rgba[0] = ToUnit(p.red);
+				rgba[1] = ToUnit(p.green);
+				rgba[2] = ToUnit(p.blue);
+				rgba[3] = (PixelChannelsNumber<Pixel_>::value == 4) ? ToUnit(GetChannel<3>(p)) : 1.0f;
+			}
+		}
 	}
 
-	const auto srcColor = FreeImage_GetColorType2(src);
-	const auto dstColor = FreeImage_GetColorType2(dst);
-	if (!SupportedColorType(srcColor) || !SupportedColorType(dstColor)) {
-		return FALSE;
+	/** Convert a line of RGBA floats to pixels, greyscale pixels get the luminance */
+	template <typename Pixel_>
+	void StoreLine(void* line, const float* rgba, unsigned width)
+	{
+		using Value_ = ToValueType<Pixel_>;
+		const auto pixels = static_cast<Pixel_*>(line);
+		for (unsigned x = 0; x < width; ++x, rgba += 4) {
+			Pixel_& p = pixels[x];
+			if constexpr (PixelChannelsNumber<Pixel_>::value == 1) {
+				p = FromUnit<Value_>(LUMA_REC709(rgba[0], rgba[1], rgba[2]));
+			}
+			else {
+				p.red   = FromUnit<Value_>(rgba[0]);
+				p.green = FromUnit<Value_>(rgba[1]);
+				p.blue  = FromUnit<Value_>(rgba[2]);
+				SetChannel<3>(p, FromUnit<Value_>(rgba[3]));
+			}
+		}
 	}
 
-	const auto srcBpp = FreeImage_GetBPP(src);
-	const auto dstBpp = FreeImage_GetBPP(dst);
+	/** Composite premultiplied pixels */
+	template <FREE_IMAGE_ALPHA_OPERATION Op_>
+	inline Float4 CompositePixel(const Float4& s, const Float4& d)
+	{
+		const Float4 one = Float4::Set(1.0f);
+		const Float4 as = s.SplatW();
+		const Float4 ab = d.SplatW();
 
-	if (srcColor != dstColor || srcBpp != dstBpp) {
-		// Implement if necessary
-		return FALSE;
+		if constexpr (Op_ == FIAO_Clear) {
+			return Float4::Set(0.0f);
+		}
+		else if constexpr (Op_ == FIAO_Src) {
+			return s;
+		}
+		else if constexpr (Op_ == FIAO_Dst) {
+			return d;
+		}
+		else if constexpr (Op_ == FIAO_SrcOver) {
+			return s + d * (one - as);
+		}
+		else if constexpr (Op_ == FIAO_DstOver) {
+			return s * (one - ab) + d;
+		}
+		else if constexpr (Op_ == FIAO_SrcIn) {
+			return s * ab;
+		}
+		else if constexpr (Op_ == FIAO_DstIn) {
+			return d * as;
+		}
+		else if constexpr (Op_ == FIAO_SrcOut) {
+			return s * (one - ab);
+		}
+		else if constexpr (Op_ == FIAO_DstOut) {
+			return d * (one - as);
+		}
+		else if constexpr (Op_ == FIAO_SrcAtop) {
+			return s * ab + d * (one - as);
+		}
+		else if constexpr (Op_ == FIAO_DstAtop) {
+			return s * (one - ab) + d * as;
+		}
+		else if constexpr (Op_ == FIAO_Xor) {
+			return s * (one - ab) + d * (one - as);
+		}
+		else if constexpr (Op_ == FIAO_Multiply) {
+			// alpha lane : as + ab - as * ab
+			return s * (one - ab) + d * (one - as) + s * d;
+		}
+		else if constexpr (Op_ == FIAO_Screen) {
+			return s + d - s * d;
+		}
+		else if constexpr (Op_ == FIAO_Overlay) {
+			// as * ab * Overlay(Cb, Cs), written with premultiplied values
+			const Float4 two = Float4::Set(2.0f);
+			const Float4 dark = two * s * d;
+			const Float4 light = as * ab - two * (ab - d) * (as - s);
+			return s * (one - ab) + d * (one - as) + Select(d + d <= ab, dark, light);
+		}
+		else if constexpr (Op_ == FIAO_Add) {
+			return Min(s + d, Float4::Set(std::numeric_limits<float>::max()).WithW(one));
+		}
+		else {
+			static_assert(Op_ == FIAO_SrcAlpha);
+			// dst alpha is ignored and left unchanged
+			return (s + d * (one - as)).WithW(d);
+		}
 	}
-	
-	if (alpha != FIAO_SrcAlpha) {
-		// Implement if necessary
-		return FALSE;
+
+	/** Composite a line of src RGBA floats into a line of dst RGBA floats */
+	template <FREE_IMAGE_ALPHA_OPERATION Op_>
+	void CompositeLine(float* dst, const float* src, unsigned width, bool premultiplied, bool dst_alpha)
+	{
+		const Float4 one = Float4::Set(1.0f);
+		const Float4 zero = Float4::Set(0.0f);
+		for (unsigned x = 0; x < width; ++x, dst += 4, src += 4) {
+			Float4 s = Float4::Load(src);
+			Float4 d = Float4::Load(dst);
+			if (!premultiplied) {
+				s = s * s.SplatW().WithW(one);
+			}
+			if constexpr (Op_ == FIAO_SrcAlpha) {
+				CompositePixel<Op_>(s, d).Store(dst);
+				continue;
+			}
+			if (!premultiplied) {
+				d = d * d.SplatW().WithW(one);
+			}
+			Float4 r = CompositePixel<Op_>(s, d);
+			if (!premultiplied && dst_alpha) {
+				const Float4 ar = r.SplatW();
+				r = Select(ar > zero, r / ar.WithW(one), zero);
+			}
+			r.Store(dst);
+		}
+	}
+
+	using LoadLineProc = void (*)(const void* line, float* rgba, unsigned width);
+	using StoreLineProc = void (*)(void* line, const float* rgba, unsigned width);
+	using CompositeLineProc = void (*)(float* dst, const float* src, unsigned width, bool premultiplied, bool dst_alpha);
+
+	/** Pixel format of a bitmap drawn by the compositing engine */
+	struct DrawFormat
+	{
+		LoadLineProc load{};
+		StoreLineProc store{};
+		unsigned pixelSize{};
+		bool hasAlpha{};
+	};
+
+	template <typename Pixel_>
+	DrawFormat MakeDrawFormat()
+	{
+		return { &LoadLine<Pixel_>, &StoreLine<Pixel_>, static_cast<unsigned>(sizeof(Pixel_)), PixelChannelsNumber<Pixel_>::value == 4 };
 	}
 
-	if (srcBpp == 32) {
-		DrawRoi<FIRGBA8>(dst, src, left, top, BlendSrcAlpha{});
+	/** Get the pixel format of a bitmap, returns false for unsupported bitmaps */
+	bool GetDrawFormat(FIBITMAP* dib, DrawFormat& format)
+	{
+		switch (FreeImage_GetImageType(dib)) {
+		case FIT_BITMAP:
+			switch (FreeImage_GetBPP(dib)) {
+			case 8:
+				if ((FreeImage_GetColorType(dib) != FIC_MINISBLACK) || FreeImage_IsTransparent(dib)) {
+					return false;
+				}
+				format = MakeDrawFormat<uint8_t>();
+				return true;
+			case 24:
+				format = MakeDrawFormat<FIRGB8>();
+				return true;
+			case 32:
+				format = MakeDrawFormat<FIRGBA8>();
+				return true;
+			default:
+				return false;
+			}
+		case FIT_UINT16:
+			format = MakeDrawFormat<uint16_t>();
+			return true;
+		case FIT_RGB16:
+			format = MakeDrawFormat<FIRGB16>();
+			return true;
+		case FIT_RGBA16:
+			format = MakeDrawFormat<FIRGBA16>();
+			return true;
+		case FIT_FLOAT:
+			format = MakeDrawFormat<float>();
+			return true;
+		case FIT_RGBF:
+			format = MakeDrawFormat<FIRGBF>();
+			return true;
+		case FIT_RGBAF:
+			format = MakeDrawFormat<FIRGBAF>();
+			return true;
+		default:
+			return false;
+		}
 	}
-	else if (srcBpp == 24) {
-		DrawRoi<FIRGB8>(dst, src, left, top, BlendSrcAlpha{});
+
+	CompositeLineProc GetCompositeLine(FREE_IMAGE_ALPHA_OPERATION alpha)
+	{
+		switch (alpha) {
+		case FIAO_SrcAlpha: return &CompositeLine<FIAO_SrcAlpha>;
+		case FIAO_Clear:    return &CompositeLine<FIAO_Clear>;
+		case FIAO_Src:      return &CompositeLine<FIAO_Src>;
+		case FIAO_Dst:      return &CompositeLine<FIAO_Dst>;
+		case FIAO_SrcOver:  return &CompositeLine<FIAO_SrcOver>;
+		case FIAO_DstOver:  return &CompositeLine<FIAO_DstOver>;
+		case FIAO_SrcIn:    return &CompositeLine<FIAO_SrcIn>;
+		case FIAO_DstIn:    return &CompositeLine<FIAO_DstIn>;
+		case FIAO_SrcOut:   return &CompositeLine<FIAO_SrcOut>;
+		case FIAO_DstOut:   return &CompositeLine<FIAO_DstOut>;
+		case FIAO_SrcAtop:  return &CompositeLine<FIAO_SrcAtop>;
+		case FIAO_DstAtop:  return &CompositeLine<FIAO_DstAtop>;
+		case FIAO_Xor:      return &CompositeLine<FIAO_Xor>;
+		case FIAO_Multiply: return &CompositeLine<FIAO_Multiply>;
+		case FIAO_Screen:   return &CompositeLine<FIAO_Screen>;
+		case FIAO_Overlay:  return &CompositeLine<FIAO_Overlay>;
+		case FIAO_Add:      return &CompositeLine<FIAO_Add>;
+		default:
+			return nullptr;
+		}
 	}
-	else if (srcBpp == 8) {
-		if (FreeImage_IsTransparent(src)) {
-			// Implement if necessary
+
+	FIBOOL DrawComposite(FIBITMAP* dst, FIBITMAP* src, FREE_IMAGE_ALPHA_OPERATION alpha, int32_t left, int32_t top, bool premultiplied)
+	{
+		DrawFormat srcFormat, dstFormat;
+		if (!GetDrawFormat(src, srcFormat) || !GetDrawFormat(dst, dstFormat)) {
+			return FALSE;
+		}
+		const CompositeLineProc composite = GetCompositeLine(alpha);
+		if (!composite) {
 			return FALSE;
 		}
-		DrawRoi<uint8_t>(dst, src, left, top, BlendSrcAlpha{});
+
+		const DrawArea area(dst, src, left, top);
+		area.ForEachBand(dstFormat.pixelSize + srcFormat.pixelSize, [&](unsigned first_row, unsigned end_row) {
+			const unsigned width = static_cast<unsigned>(area.width);
+			std::vector<float> buffer(static_cast<size_t>(width) * 8);
+			float* dstRgba = buffer.data();
+			float* srcRgba = dstRgba + static_cast<size_t>(width) * 4;
+
+			for (unsigned y = first_row; y < end_row; ++y) {
+				uint8_t* dstLine = area.DstLine(dst, y) + area.dstLeft * dstFormat.pixelSize;
+				const uint8_t* srcLine = area.SrcLine(src, y) + area.srcLeft * srcFormat.pixelSize;
+				srcFormat.load(srcLine, srcRgba, width);
+				dstFormat.load(dstLine, dstRgba, width);
+				composite(dstRgba, srcRgba, width, premultiplied, dstFormat.hasAlpha);
+				dstFormat.store(dstLine, dstRgba, width);
+			}
+		});
+		return TRUE;
 	}
-	else {
+
+
+} // namespace
+
+
+
+FIBOOL DLL_CALLCONV
+FreeImage_DrawBitmapEx(FIBITMAP* dst, FIBITMAP* src, FREE_IMAGE_ALPHA_OPERATION alpha, int32_t left, int32_t top, int options)
+{
+	if (!FreeImage_HasPixels(dst) || !FreeImage_HasPixels(src)) {
 		return FALSE;
 	}
 
-	return TRUE;
+	const bool premultiplied = (options & FI_ALPHA_PREMULTIPLIED) == FI_ALPHA_PREMULTIPLIED;
+
+	if ((alpha == FIAO_SrcAlpha) && !premultiplied
+		&& (FreeImage_GetImageType(dst) == FIT_BITMAP) && (FreeImage_GetImageType(src) == FIT_BITMAP)
+		&& (FreeImage_GetBPP(src) == FreeImage_GetBPP(dst))) {
+
+		// integer blending of identical 8-bit formats
+
+		const auto srcColor = FreeImage_GetColorType2(src);
+		const auto dstColor = FreeImage_GetColorType2(dst);
+		if (!SupportedColorType(srcColor) || !SupportedColorType(dstColor)) {
+			return FALSE;
+		}
+
+		const auto srcBpp = FreeImage_GetBPP(src);
+		if (srcColor == dstColor) {
+			if (srcBpp == 32) {
+				DrawRoi<FIRGBA8>(dst, src, left, top, BlendSrcAlpha{});
+				return TRUE;
+			}
+			else if (srcBpp == 24) {
+				DrawRoi<FIRGB8>(dst, src, left, top, BlendSrcAlpha{});
+				return TRUE;
+			}
+			else if ((srcBpp == 8) && !FreeImage_IsTransparent(src)) {
+				DrawRoi<uint8_t>(dst, src, left, top, BlendSrcAlpha{});
+				return TRUE;
+			}
+		}
+	}
+
+	return DrawComposite(dst, src, alpha, left, top, premultiplied);
+}
+
+FIBOOL DLL_CALLCONV
+FreeImage_DrawBitmap(FIBITMAP* dst, FIBITMAP* src, FREE_IMAGE_ALPHA_OPERATION alpha, int32_t left, int32_t top)
+{
+	return FreeImage_DrawBitmapEx(dst, src, alpha, left, top, FI_ALPHA_STRAIGHT);
 }
@@ -39,6 +39,7 @@ extern "C" {
 #include "FreeImage.h"
 #include "Utilities.h"
 #include "FreeImageIO.h"
+#include "FreeImage/ParallelFor.h"
 
 #if FREEIMAGE_WITH_LIBJPEG
 
@@ -95,19 +96,18 @@ ls_jpeg_output_message (j_common_ptr cinfo) {
 // ----------------------------------------------------------
 
 /**
-Build a crop string. 
+Normalize a crop rectangle. 
 
-@param crop Output crop string
 @param left Specifies the left position of the cropped rectangle
 @param top Specifies the top position of the cropped rectangle
 @param right Specifies the right position of the cropped rectangle
 @param bottom Specifies the bottom position of the cropped rectangle
 @param width Image width
 @param height Image height
-@return Returns TRUE if successful, returns FALSE otherwise
+@return Returns TRUE if the rectangle crops the image, returns FALSE if it is empty or the whole image
 */
 static FIBOOL
-getCropString(char* crop, size_t cropSize, int* left, int* top, int* right, int* bottom, int width, int height) {
+getCropRect(int* left, int* top, int* right, int* bottom, int width, int height) {
 	if (!left || !top || !right || !bottom) {
 		return FALSE;
 	}
@@ -148,20 +148,304 @@ getCropString(char* crop, size_t cropSize, int* left, int* top, int* right, int*
 		return FALSE;
 	}
 
-	// build the crop option
-	snprintf(crop, cropSize, "%dx%d+%d+%d", *right - *left, *bottom - *top, *left, *top);
-
 	return TRUE;
 }
 
+/**
+Select the transform option of an operation. 
+
+@param operation Lossless transformation
+@param trimH Set to TRUE if the transformation trims the partial right edge block
+@param trimV Set to TRUE if the transformation trims the partial bottom edge block
+@param swappedDim Set to TRUE if the transformation swaps the image dimensions
+@return Returns the transform option
+*/
+static JXFORM_CODE
+getTransformCode(FREE_IMAGE_JPEG_OPERATION operation, FIBOOL* trimH, FIBOOL* trimV, FIBOOL* swappedDim) {
+	*trimH = FALSE;
+	*trimV = FALSE;
+	*swappedDim = FALSE;
+
+	switch (operation) {
+		case FIJPEG_OP_FLIP_H:		// horizontal flip
+			*trimH = TRUE;
+			return JXFORM_FLIP_H;
+		case FIJPEG_OP_FLIP_V:		// vertical flip
+			*trimV = TRUE;
+			return JXFORM_FLIP_V;
+		case FIJPEG_OP_TRANSPOSE:	// transpose across UL-to-LR axis
+			*swappedDim = TRUE;
+			return JXFORM_TRANSPOSE;
+		case FIJPEG_OP_TRANSVERSE:	// transpose across UR-to-LL axis
+			*trimH = TRUE;
+			*trimV = TRUE;
+			*swappedDim = TRUE;
+			return JXFORM_TRANSVERSE;
+		case FIJPEG_OP_ROTATE_90:	// 90-degree clockwise rotation
+			*trimH = TRUE;
+			*swappedDim = TRUE;
+			return JXFORM_ROT_90;
+		case FIJPEG_OP_ROTATE_180:	// 180-degree rotation
+			*trimH = TRUE;
+			*trimV = TRUE;
+			return JXFORM_ROT_180;
+		case FIJPEG_OP_ROTATE_270:	// 270-degree clockwise (or 90 ccw)
+			*trimV = TRUE;
+			*swappedDim = TRUE;
+			return JXFORM_ROT_270;
+		default:
+		case FIJPEG_OP_NONE:		// no transformation
+			return JXFORM_NONE;
+	}
+}
+
+// ----------------------------------------------------------
+//   Transform pipeline
+// ----------------------------------------------------------
+
+namespace {
+
+/**
+Orientation of an image with respect to the source image :
+optional transposition, followed by optional horizontal and vertical flips.
+*/
+struct Orientation {
+	bool transpose = false;
+	bool flipH = false;
+	bool flipV = false;
+
+	bool operator==(const Orientation&) const = default;
+};
+
+// orientations of the operations, in FREE_IMAGE_JPEG_OPERATION order
+const Orientation operationOrientations[] = {
+	{ false, false, false },	// FIJPEG_OP_NONE
+	{ false, true, false },		// FIJPEG_OP_FLIP_H
+	{ false, false, true },		// FIJPEG_OP_FLIP_V
+	{ true, false, false },		// FIJPEG_OP_TRANSPOSE
+	{ true, true, true },		// FIJPEG_OP_TRANSVERSE
+	{ true, true, false },		// FIJPEG_OP_ROTATE_90
+	{ false, true, true },		// FIJPEG_OP_ROTATE_180
+	{ true, false, true }		// FIJPEG_OP_ROTATE_270
+};
+
+// operations restoring the upright image, by Exif orientation
+const FREE_IMAGE_JPEG_OPERATION exifOrientationOperations[] = {
+	FIJPEG_OP_NONE, FIJPEG_OP_NONE, FIJPEG_OP_FLIP_H, FIJPEG_OP_ROTATE_180, FIJPEG_OP_FLIP_V,
+	FIJPEG_OP_TRANSPOSE, FIJPEG_OP_ROTATE_90, FIJPEG_OP_TRANSVERSE, FIJPEG_OP_ROTATE_270
+};
+
+FREE_IMAGE_JPEG_OPERATION
+orientationOperation(const Orientation& orientation) {
+	for (int op = FIJPEG_OP_NONE; op <= FIJPEG_OP_ROTATE_270; op++) {
+		if (operationOrientations[op] == orientation) {
+			return (FREE_IMAGE_JPEG_OPERATION)op;
+		}
+	}
+	return FIJPEG_OP_NONE;
+}
+
+/** Orientation of 'then' applied after 'first' */
+Orientation
+compose(const Orientation& first, const Orientation& then) {
+	// the flips of the composition are the image of the origin corner
+	bool x = first.flipH, y = first.flipV;
+	if (then.transpose) {
+		std::swap(x, y);
+	}
+	return { first.transpose != then.transpose, x != then.flipH, y != then.flipV };
+}
+
+Orientation
+inverse(const Orientation& orientation) {
+	for (const Orientation& candidate : operationOrientations) {
+		if (compose(orientation, candidate) == Orientation{}) {
+			return candidate;
+		}
+	}
+	return {};
+}
+
+/** Rectangle of an image of width x height pixels, moved by an orientation */
+struct Rect {
+	int left, top, right, bottom;
+
+	Rect oriented(const Orientation& orientation, int width, int height) const {
+		Rect r = *this;
+		if (orientation.transpose) {
+			r = { top, left, bottom, right };
+			std::swap(width, height);
+		}
+		if (orientation.flipH) {
+			r = { width - r.right, r.top, width - r.left, r.bottom };
+		}
+		if (orientation.flipV) {
+			r = { r.left, height - r.bottom, r.right, height - r.top };
+		}
+		return r;
+	}
+};
+
+/**
+Steps of a pipeline reduced to a single transformation over DCT coefficients :
+output = crop of (orientation of the source), with the crop given in source coordinates.
+*/
+struct TransformPlan {
+	Orientation orientation;
+	Rect crop{};
+	bool grayscale = false;
+	bool autoOrient = false;
+};
+
+/**
+Find the orientation tag of the Exif marker.
+@param marker_list Saved markers of the source
+@param bigEndian Set to the byte order of the Exif data
+@return Returns a pointer to the orientation value in the marker data, or NULL
+*/
+uint8_t*
+findExifOrientation(jpeg_saved_marker_ptr marker_list, bool& bigEndian) {
+	for (jpeg_saved_marker_ptr marker = marker_list; marker; marker = marker->next) {
+		if ((marker->marker != JPEG_APP0 + 1) || (marker->data_length < 6 + 8) || (memcmp(marker->data, "Exif\0\0", 6) != 0)) {
+			continue;
+		}
+		uint8_t *tiff = marker->data + 6;
+		const size_t size = marker->data_length - 6;
+		if ((tiff[0] == 'M') && (tiff[1] == 'M')) {
+			bigEndian = true;
+		} else if ((tiff[0] == 'I') && (tiff[1] == 'I')) {
+			bigEndian = false;
+		} else {
+			continue;
+		}
+		auto read16 = [&](size_t pos) { return bigEndian ? (tiff[pos] << 8) | tiff[pos + 1] : tiff[pos] | (tiff[pos + 1] << 8); };
+		auto read32 = [&](size_t pos) { return bigEndian ? ((size_t)read16(pos) << 16) | read16(pos + 2) : ((size_t)read16(pos + 2) << 16) | read16(pos); };
+
+		// IFD0 entries
+		const size_t ifd = read32(4);
+		if (ifd + 2 > size) {
+			continue;
+		}
+		const unsigned count = read16(ifd);
+		for (unsigned i = 0; (i < count) && (ifd + 2 + 12 * (i + 1) <= size); i++) {
+			const size_t entry = ifd + 2 + 12 * i;
+			// SHORT orientation tag
+			if ((read16(entry) == 0x0112) && (read16(entry + 2) == 3)) {
+				return tiff + entry + 8;
+			}
+		}
+	}
+	return nullptr;
+}
+
+/** Minimal big-endian Exif marker, with the orientation tag only */
+void
+writeExifOrientation(j_compress_ptr dstinfo, unsigned orientation) {
+	const JOCTET exif[] = {
+		'E', 'x', 'i', 'f', 0, 0,
+		'M', 'M', 0, 42, 0, 0, 0, 8,			// TIFF header, IFD0 at offset 8
+		0, 1,									// 1 entry
+		0x01, 0x12, 0, 3, 0, 0, 0, 1, 0, (JOCTET)orientation, 0, 0,	// orientation, SHORT, count 1
+		0, 0, 0, 0								// no next IFD
+	};
+	jpeg_write_marker(dstinfo, JPEG_APP0 + 1, exif, sizeof(exif));
+}
+
+bool
+isICCProfile(jpeg_saved_marker_ptr marker) {
+	return (marker->marker == JPEG_APP0 + 2) && (marker->data_length >= 12) && (memcmp(marker->data, "ICC_PROFILE", 12) == 0);
+}
+
+/**
+Size of an image axis once the partial edge iMCU is dropped.
+@param size Size in pixels
+@param iMCUSize iMCU size in pixels
+@param trim Set to true if the transform drops the partial edge iMCU of this axis
+*/
+int
+trimmedSize(int size, int iMCUSize, bool trim) {
+	return (trim && (size >= iMCUSize)) ? size - size % iMCUSize : size;
+}
+
+/**
+Reduce the steps of a pipeline to a transform plan.
+@param width Source width
+@param height Source height
+@param exifOrientation Exif orientation of the source, 1 if none
+@return Returns false if a step is invalid
+*/
+bool
+makeTransformPlan(const FIJPEGSTEP *steps, unsigned count, int width, int height, unsigned exifOrientation, TransformPlan& plan) {
+	plan.crop = { 0, 0, width, height };
+
+	for (unsigned i = 0; i < count; i++) {
+		const FIJPEGSTEP& step = steps[i];
+		switch (step.type) {
+			case FIJPEG_STEP_TRANSFORM:
+				if ((step.operation < FIJPEG_OP_NONE) || (step.operation > FIJPEG_OP_ROTATE_270)) {
+					return false;
+				}
+				plan.orientation = compose(plan.orientation, operationOrientations[step.operation]);
+				break;
+			case FIJPEG_STEP_AUTO_ORIENT:
+				plan.orientation = compose(plan.orientation, operationOrientations[exifOrientationOperations[exifOrientation]]);
+				plan.autoOrient = true;
+				break;
+			case FIJPEG_STEP_GRAYSCALE:
+				plan.grayscale = true;
+				break;
+			case FIJPEG_STEP_CROP:
+			{
+				// the current image is the oriented crop
+				const Rect current = plan.crop.oriented(plan.orientation, width, height);
+				const int currentWidth = current.right - current.left;
+				const int currentHeight = current.bottom - current.top;
+				Rect crop = { step.left, step.top, step.right, step.bottom };
+				if (getCropRect(&crop.left, &crop.top, &crop.right, &crop.bottom, currentWidth, currentHeight)) {
+					// back to the coordinates of the source crop
+					const Orientation back = inverse(plan.orientation);
+					crop = crop.oriented(back, currentWidth, currentHeight);
+					plan.crop = { plan.crop.left + crop.left, plan.crop.top + crop.top, plan.crop.left + crop.right, plan.crop.top + crop.bottom };
+				}
+				break;
+			}
+			default:
+				return false;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+/**
+Apply a transform pipeline in a single pass over the DCT coefficients.
+
+@param steps Pipeline steps
+@param count Number of steps
+@param markers Extra markers to copy
+@param left Optional final crop, in the coordinates of the transformed image, set to the actual output rectangle
+@param top See left
+@param right See left
+@param bottom See left
+@param perfect If TRUE, fail if there are non-transformable edge blocks, otherwise trim them
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
 static FIBOOL
-JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO* dst_io, fi_handle dst_handle, FREE_IMAGE_JPEG_OPERATION operation, int* left, int* top, int* right, int* bottom, FIBOOL perfect) {
+JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO* dst_io, fi_handle dst_handle, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers, int* left, int* top, int* right, int* bottom, FIBOOL perfect) {
 	const FIBOOL onlyReturnCropRect = (!dst_io || !dst_handle);
 	const long stream_start = onlyReturnCropRect ? 0 : dst_io->tell_proc(dst_handle);
 	FIBOOL swappedDim = FALSE;
 	FIBOOL trimH = FALSE;
 	FIBOOL trimV = FALSE;
 
+	if ((count > 0) && !steps) {
+		return FALSE;
+	}
+	if ((markers != FIJPEG_MARKERS_ALL) && (markers != FIJPEG_MARKERS_NONE) && (markers != FIJPEG_MARKERS_ORIENTATION)) {
+		return FALSE;
+	}
+
 	// Set up the jpeglib structures
 	jpeg_decompress_struct srcinfo;
 	jpeg_compress_struct dstinfo;
@@ -180,53 +464,13 @@ JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO*
 	memset(&dstinfo, 0, sizeof(dstinfo));
 	memset(&transfoptions, 0, sizeof(transfoptions));
 
-	// Copy all extra markers from source file
+	// Save all extra markers from source file, the marker policy is applied when copying them
 	copyoption = JCOPYOPT_ALL;
 
 	// Set up default JPEG parameters
 	transfoptions.force_grayscale = FALSE;
 	transfoptions.crop = FALSE;
 
-	// Select the transform option
-	switch (operation) {
-		case FIJPEG_OP_FLIP_H:		// horizontal flip
-			transfoptions.transform = JXFORM_FLIP_H;
-			trimH = TRUE;
-			break;
-		case FIJPEG_OP_FLIP_V:		// vertical flip
-			transfoptions.transform = JXFORM_FLIP_V;
-			trimV = TRUE;
-			break;
-		case FIJPEG_OP_TRANSPOSE:	// transpose across UL-to-LR axis
-			transfoptions.transform = JXFORM_TRANSPOSE;
-			swappedDim = TRUE;
-			break;
-		case FIJPEG_OP_TRANSVERSE:	// transpose across UR-to-LL axis
-			transfoptions.transform = JXFORM_TRANSVERSE;
-			trimH = TRUE;
-			trimV = TRUE;
-			swappedDim = TRUE;
-			break;
-		case FIJPEG_OP_ROTATE_90:	// 90-degree clockwise rotation
-			transfoptions.transform = JXFORM_ROT_90;
-			trimH = TRUE;
-			swappedDim = TRUE;
-			break;
-		case FIJPEG_OP_ROTATE_180:	// 180-degree rotation
-			trimH = TRUE;
-			trimV = TRUE;
-			transfoptions.transform = JXFORM_ROT_180;
-			break;
-		case FIJPEG_OP_ROTATE_270:	// 270-degree clockwise (or 90 ccw)
-			transfoptions.transform = JXFORM_ROT_270;
-			trimV = TRUE;
-			swappedDim = TRUE;
-			break;
-		default:
-		case FIJPEG_OP_NONE:		// no transformation
-			transfoptions.transform = JXFORM_NONE;
-			break;
-	}
 	// (perfect == TRUE) ==> fail if there is non-transformable edge blocks
 	transfoptions.perfect = (perfect == TRUE) ? TRUE : FALSE;
 	// Drop non-transformable edge blocks: trim off any partial edge MCUs that the transform can't handle.
@@ -255,13 +499,59 @@ JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO*
 		// Read the file header
 		jpeg_read_header(&srcinfo, TRUE);
 
-		// crop option
-		char crop[64];
-		const FIBOOL hasCrop = getCropString(crop, std::size(crop), left, top, right, bottom, swappedDim ? srcinfo.image_height : srcinfo.image_width, swappedDim ? srcinfo.image_width : srcinfo.image_height);
+		// Reduce the steps to a single transformation
+		bool bigEndian = false;
+		uint8_t *orientationTag = findExifOrientation(srcinfo.marker_list, bigEndian);
+		unsigned sourceOrientation = 0;
+		if (orientationTag) {
+			sourceOrientation = bigEndian ? orientationTag[1] : orientationTag[0];
+		}
+
+		TransformPlan plan;
+		const unsigned exifOrientation = ((sourceOrientation >= 1) && (sourceOrientation <= 8)) ? sourceOrientation : 1;
+		if (!makeTransformPlan(steps, count, (int)srcinfo.image_width, (int)srcinfo.image_height, exifOrientation, plan)) {
+			FreeImage_OutputMessageProc(FIF_JPEG, "Invalid transformation step");
+			throw(1);
+		}
+		transfoptions.transform = getTransformCode(orientationOperation(plan.orientation), &trimH, &trimV, &swappedDim);
+		transfoptions.force_grayscale = plan.grayscale ? TRUE : FALSE;
+
+		// iMCU of the source, as computed by jtransform_request_workspace
+		const bool singleComponent = plan.grayscale || (srcinfo.num_components == 1);
+		const int iMCUWidth = singleComponent ? DCTSIZE : srcinfo.max_h_samp_factor * DCTSIZE;
+		const int iMCUHeight = singleComponent ? DCTSIZE : srcinfo.max_v_samp_factor * DCTSIZE;
+
+		// the transform drops the partial edge iMCUs it cannot move (perfect == FALSE),
+		// the steps apply to the remaining part of the source
+		const int sourceWidth = trimmedSize((int)srcinfo.image_width, iMCUWidth, swappedDim ? trimV : trimH);
+		const int sourceHeight = trimmedSize((int)srcinfo.image_height, iMCUHeight, swappedDim ? trimH : trimV);
+		if ((sourceWidth != (int)srcinfo.image_width) || (sourceHeight != (int)srcinfo.image_height)) {
+			plan = {};
+			makeTransformPlan(steps, count, sourceWidth, sourceHeight, exifOrientation, plan);
+		}
+
+		const int fullWidth = swappedDim ? srcinfo.image_height : srcinfo.image_width;
+		const int fullHeight = swappedDim ? srcinfo.image_width : srcinfo.image_height;
+		const int transformedFullWidth = swappedDim ? sourceHeight : sourceWidth;
+		const int transformedFullHeight = swappedDim ? sourceWidth : sourceHeight;
+
+		// crop option, in the coordinates of the transformed image
+		Rect crop = plan.crop.oriented(plan.orientation, sourceWidth, sourceHeight);
+		if (left && top && right && bottom) {
+			// final crop of the caller
+			const int cropWidth = crop.right - crop.left;
+			const int cropHeight = crop.bottom - crop.top;
+			if (getCropRect(left, top, right, bottom, cropWidth, cropHeight)) {
+				crop = { crop.left + *left, crop.top + *top, crop.left + *right, crop.top + *bottom };
+			}
+		}
+		const FIBOOL hasCrop = (crop.left != 0) || (crop.top != 0) || (crop.right != transformedFullWidth) || (crop.bottom != transformedFullHeight);
 
 		if (hasCrop) {
-			if (!jtransform_parse_crop_spec(&transfoptions, crop)) {
-				FreeImage_OutputMessageProc(FIF_JPEG, "Bogus crop argument %s", crop);
+			char cropSpec[64];
+			snprintf(cropSpec, std::size(cropSpec), "%dx%d+%d+%d", crop.right - crop.left, crop.bottom - crop.top, crop.left, crop.top);
+			if (!jtransform_parse_crop_spec(&transfoptions, cropSpec)) {
+				FreeImage_OutputMessageProc(FIF_JPEG, "Bogus crop argument %s", cropSpec);
 				throw(1);
 			}
 		}
@@ -281,19 +571,6 @@ JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO*
 			// transform, which might have trimed the image,
 			// and crop itself, which is adjusted to lie on a iMCU boundary
 
-			const int fullWidth = swappedDim ? srcinfo.image_height : srcinfo.image_width;
-			const int fullHeight = swappedDim ? srcinfo.image_width : srcinfo.image_height;
-
-			int transformedFullWidth = fullWidth;
-			int transformedFullHeight = fullHeight;
-
-			if (trimH && transformedFullWidth/transfoptions.iMCU_sample_width > 0) {
-				transformedFullWidth = (transformedFullWidth/transfoptions.iMCU_sample_width) * transfoptions.iMCU_sample_width;
-			}
-			if (trimV && transformedFullHeight/transfoptions.iMCU_sample_height > 0) {
-				transformedFullHeight = (transformedFullHeight/transfoptions.iMCU_sample_height) * transfoptions.iMCU_sample_height;
-			}
-
 			const int trimmedWidth = fullWidth - transformedFullWidth;
 			const int trimmedHeight = fullHeight - transformedFullHeight;
 
@@ -346,6 +623,36 @@ JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO*
 		// Start compressor (note no image data is actually written here)
 		jpeg_write_coefficients(&dstinfo, dst_coef_arrays);
 
+		// Apply the marker policy to the saved markers
+		const unsigned outputOrientation = plan.autoOrient ? 1 : sourceOrientation;
+		switch (markers) {
+			case FIJPEG_MARKERS_NONE:
+				srcinfo.marker_list = nullptr;
+				break;
+			case FIJPEG_MARKERS_ORIENTATION:
+			{
+				// keep the ICC profile only, behind a new Exif marker
+				jpeg_saved_marker_ptr *link = &srcinfo.marker_list;
+				while (*link) {
+					if (isICCProfile(*link)) {
+						link = &(*link)->next;
+					} else {
+						*link = (*link)->next;
+					}
+				}
+				if (orientationTag) {
+					writeExifOrientation(&dstinfo, outputOrientation);
+				}
+				break;
+			}
+			default:
+				if (orientationTag && plan.autoOrient) {
+					orientationTag[0] = bigEndian ? 0 : 1;
+					orientationTag[1] = bigEndian ? 1 : 0;
+				}
+				break;
+		}
+
 		// Copy to the output file any extra markers that we want to preserve
 		jcopy_markers_execute(&srcinfo, &dstinfo, copyoption);
 
@@ -368,8 +675,21 @@ JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO*
 	return TRUE;
 }
 
+static FIBOOL
+JPEGTransformFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO* dst_io, fi_handle dst_handle, FREE_IMAGE_JPEG_OPERATION operation, int* left, int* top, int* right, int* bottom, FIBOOL perfect) {
+	FIJPEGSTEP step{};
+	step.type = FIJPEG_STEP_TRANSFORM;
+	step.operation = ((operation >= FIJPEG_OP_NONE) && (operation <= FIJPEG_OP_ROTATE_270)) ? operation : FIJPEG_OP_NONE;
+	return JPEGTransformFromHandle(src_io, src_handle, dst_io, dst_handle, &step, 1, FIJPEG_MARKERS_ALL, left, top, right, bottom, perfect);
+}
+
 #else // FREEIMAGE_WITH_LIBJPEG
 
+static FIBOOL
+JPEGTransformFromHandle(FreeImageIO*, fi_handle, FreeImageIO*, fi_handle, const FIJPEGSTEP*, unsigned, FREE_IMAGE_JPEG_MARKERS, int*, int*, int*, int*, FIBOOL) {
+	return FALSE;
+}
+
 static FIBOOL
 JPEGTransformFromHandle(FreeImageIO*, fi_handle, FreeImageIO*, fi_handle, FREE_IMAGE_JPEG_OPERATION, int*, int*, int*, int*, FIBOOL) {
 	return FALSE;
@@ -636,3 +956,103 @@ FreeImage_JPEGTransformCombinedFromMemory(FIMEMORY* src_stream, FIMEMORY* dst_st
 	return FreeImage_JPEGTransformFromHandle(&io, src, &io, dst, operation, left, top, right, bottom, perfect);
 }
 
+// --------------------------------------------------------------------------
+//   Transform pipeline
+// --------------------------------------------------------------------------
+
+/**
+Apply a list of lossless operations in a single pass over the DCT coefficients.
+Transformations and crops are combined into one transformation followed by one crop,
+FIJPEG_STEP_AUTO_ORIENT restores the upright image given by the Exif orientation of the source.
+
+@param steps Pipeline steps, applied in order
+@param count Number of steps
+@param markers Extra markers copied to the output
+@param perfect If TRUE, fail if there are non-transformable edge blocks, otherwise trim them
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+FIBOOL DLL_CALLCONV
+FreeImage_JPEGTransformPipelineFromHandle(FreeImageIO* src_io, fi_handle src_handle, FreeImageIO* dst_io, fi_handle dst_handle, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers, FIBOOL perfect) {
+	return JPEGTransformFromHandle(src_io, src_handle, dst_io, dst_handle, steps, count, markers, nullptr, nullptr, nullptr, nullptr, perfect);
+}
+
+FIBOOL DLL_CALLCONV
+FreeImage_JPEGTransformPipeline(const char *src_file, const char *dst_file, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers, FIBOOL perfect) {
+	FreeImageIO io;
+	fi_handle src;
+	fi_handle dst;
+
+	if (!src_file || !dst_file || !openStdIO(src_file, dst_file, &io, &src, &dst)) {
+		return FALSE;
+	}
+
+	FIBOOL ret = JPEGTransformFromHandle(&io, src, &io, dst, steps, count, markers, nullptr, nullptr, nullptr, nullptr, perfect);
+
+	closeStdIO(src, dst);
+
+	return ret;
+}
+
+FIBOOL DLL_CALLCONV
+FreeImage_JPEGTransformPipelineU(const wchar_t *src_file, const wchar_t *dst_file, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers, FIBOOL perfect) {
+	FreeImageIO io;
+	fi_handle src;
+	fi_handle dst;
+
+	if (!src_file || !dst_file || !openStdIOU(src_file, dst_file, &io, &src, &dst)) {
+		return FALSE;
+	}
+
+	FIBOOL ret = JPEGTransformFromHandle(&io, src, &io, dst, steps, count, markers, nullptr, nullptr, nullptr, nullptr, perfect);
+
+	closeStdIO(src, dst);
+
+	return ret;
+}
+
+FIBOOL DLL_CALLCONV
+FreeImage_JPEGTransformPipelineFromMemory(FIMEMORY* src_stream, FIMEMORY* dst_stream, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers, FIBOOL perfect) {
+	FreeImageIO io;
+	fi_handle src;
+	fi_handle dst;
+
+	if (!src_stream || !dst_stream || !getMemIO(src_stream, dst_stream, &io, &src, &dst)) {
+		return FALSE;
+	}
+
+	return JPEGTransformFromHandle(&io, src, &io, dst, steps, count, markers, nullptr, nullptr, nullptr, nullptr, perfect);
+}
+
+/**
+Apply the same transform pipeline to a list of files, several files at a time.
+
+@param src_files Source files
+@param dst_files Destination files, a destination may be its source file
+@param file_count Number of files
+@param results Optional output array of file_count results
+@return Returns the number of files successfully transformed
+@see FreeImage_JPEGTransformPipeline
+*/
+unsigned DLL_CALLCONV
+FreeImage_JPEGTransformBatch(const char **src_files, const char **dst_files, unsigned file_count, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers, FIBOOL perfect, FIBOOL *results) {
+	if (!src_files || !dst_files) {
+		return 0;
+	}
+
+	std::atomic<unsigned> succeeded{ 0 };
+
+	// one band per file or few files, a JPEG file is worth about a megabyte of work
+	ParallelForRows(file_count, 1024 * 1024, [&](unsigned first_file, unsigned end_file) {
+		for (unsigned i = first_file; i < end_file; i++) {
+			const FIBOOL ret = FreeImage_JPEGTransformPipeline(src_files[i], dst_files[i], steps, count, markers, perfect);
+			if (results) {
+				results[i] = ret;
+			}
+			if (ret) {
+				succeeded++;
+			}
+		}
+	});
+
+	return succeeded;
+}
@@ -22,6 +22,9 @@
 // ==========================================================
 
 #include "Resize.h"
+#include "FreeImage/ParallelFor.h"
+#include <array>
+#include <new>
 
 /**
 Returns the color type of a bitmap. In contrast to FreeImage_GetColorType,
@@ -136,6 +139,39 @@ GetRGBAPalette(FIBITMAP *dib, FIRGBA8 * const buffer) {
 	return buffer;
 }
 
+/**
+Returns the table of the 8-bit sRGB values decoded to linear light, in the range [0, 1]
+*/
+static const float *
+GetSRGBToLinearTable() {
+	static const std::array<float, 256> table = []() {
+		std::array<float, 256> values{};
+		for (unsigned i = 0; i < 256; i++) {
+			const double c = i / 255.0;
+			values[i] = (float)((c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+		}
+		return values;
+	}();
+	return table.data();
+}
+
+/**
+Returns the table of the 16-bit linear light values encoded to 8-bit sRGB values
+*/
+static const uint8_t *
+GetLinearToSRGBTable() {
+	static const std::vector<uint8_t> table = []() {
+		std::vector<uint8_t> values(65536);
+		for (unsigned i = 0; i < 65536; i++) {
+			const double c = i / 65535.0;
+			const double v = (c <= 0.0031308) ? 12.92 * c : 1.055 * pow(c, 1 / 2.4) - 0.055;
+			values[i] = (uint8_t)std::clamp<int>((int)(v * 255 + 0.5), 0, 0xFF);
+		}
+		return values;
+	}();
+	return table.data();
+}
+
 // --------------------------------------------------------------------------
 
 CWeightsTable::CWeightsTable(CGenericFilter *pFilter, unsigned uDstSize, unsigned uSrcSize) {
@@ -317,6 +353,10 @@ FIBITMAP* CResizeEngine::scale(FIBITMAP *src, unsigned dst_width, unsigned dst_h
 		return (out != src) ? out : FreeImage_Clone(src);
 	}
 
+	if (((flags & FI_RESCALE_LINEAR_LIGHT) == FI_RESCALE_LINEAR_LIGHT) && (image_type == FIT_BITMAP) && ((src_bpp == 24) || (src_bpp == 32))) {
+		return scaleLinearLight(src, dst_width, dst_height, src_left, FreeImage_GetHeight(src) - src_height - src_top, src_width, src_height);
+	}
+
 	FIRGBA8 pal_buffer[256];
 	const FIRGBA8 *src_pal{};
 
@@ -505,6 +545,150 @@ FIBITMAP* CResizeEngine::scale(FIBITMAP *src, unsigned dst_width, unsigned dst_h
 	return dst;
 } 
 
+FIBITMAP* CResizeEngine::scaleLinearLight(FIBITMAP *src, unsigned dst_width, unsigned dst_height, unsigned src_offset_x, unsigned src_offset_y, unsigned src_width, unsigned src_height) {
+	const unsigned bpp = FreeImage_GetBPP(src);
+	const unsigned bytespp = bpp / 8;
+	const bool bHasAlpha = (bpp == 32);
+
+	FIBITMAP *dst = FreeImage_AllocateT(FIT_BITMAP, dst_width, dst_height, bpp, 0, 0, 0);
+	if (!dst) {
+		return nullptr;
+	}
+
+	try {
+		// filtered rows : premultiplied linear colors and alpha, 16-bit fixed point. 
+		// Fully transparent pixels keep their straight colors instead, so that the color 
+		// of transparent areas survives the rescaling
+		std::vector<FIRGBA16> tmp((size_t)dst_width * src_height);
+
+		auto to_fixed = [](float v) {
+			return (uint16_t)std::clamp<int>((int)(v * 65535 + 0.5f), 0, 0xFFFF);
+		};
+
+		// horizontal pass : decode the sRGB values while filtering each source row
+
+		{
+			CWeightsTable weightsTable(m_pFilter, dst_width, src_width);
+			const float * const to_linear = GetSRGBToLinearTable();
+
+			ParallelForRows(src_height, (size_t)src_width * bytespp, [&](unsigned first_row, unsigned end_row) {
+				for (unsigned y = first_row; y < end_row; y++) {
+					const uint8_t * const src_bits = FreeImage_GetScanLine(src, y + src_offset_y) + src_offset_x * bytespp;
+					FIRGBA16 *tmp_bits = tmp.data() + (size_t)y * dst_width;
+
+					for (unsigned x = 0; x < dst_width; x++) {
+						const unsigned iLeft = weightsTable.getLeftBoundary(x);				// retrieve left boundary
+						const unsigned iLimit = weightsTable.getRightBoundary(x) - iLeft;	// retrieve right boundary
+						const uint8_t *pixel = src_bits + iLeft * bytespp;
+						float r = 0, g = 0, b = 0, a = 0;
+
+						for (unsigned i = 0; i < iLimit; i++) {
+							// weight each neighboring pixel by its alpha
+							const float weight = (float)weightsTable.getWeight(x, i);
+							const float alpha_weight = bHasAlpha ? weight * pixel[FI_RGBA_ALPHA] * (1.0f / 255) : weight;
+							r += alpha_weight * to_linear[pixel[FI_RGBA_RED]];
+							g += alpha_weight * to_linear[pixel[FI_RGBA_GREEN]];
+							b += alpha_weight * to_linear[pixel[FI_RGBA_BLUE]];
+							a += alpha_weight;
+							pixel += bytespp;
+						}
+
+						tmp_bits[x].alpha = to_fixed(a);
+						if (tmp_bits[x].alpha == 0) {
+							// fully transparent : filter the straight colors
+							float w = 0;
+							r = g = b = 0;
+							pixel = src_bits + iLeft * bytespp;
+							for (unsigned i = 0; i < iLimit; i++) {
+								const float weight = (float)weightsTable.getWeight(x, i);
+								r += weight * to_linear[pixel[FI_RGBA_RED]];
+								g += weight * to_linear[pixel[FI_RGBA_GREEN]];
+								b += weight * to_linear[pixel[FI_RGBA_BLUE]];
+								w += weight;
+								pixel += bytespp;
+							}
+							if (w > 0) {
+								r /= w;
+								g /= w;
+								b /= w;
+							}
+						}
+						tmp_bits[x].red = to_fixed(r);
+						tmp_bits[x].green = to_fixed(g);
+						tmp_bits[x].blue = to_fixed(b);
+					}
+				}
+			});
+		}
+
+		// vertical pass : filter the rows, unpremultiply and encode to sRGB
+
+		CWeightsTable weightsTable(m_pFilter, dst_height, src_height);
+		const uint8_t * const to_srgb = GetLinearToSRGBTable();
+
+		ParallelForRows(dst_height, (size_t)dst_width * sizeof(FIRGBA16), [&](unsigned first_row, unsigned end_row) {
+			// premultiplied colors and alpha, then straight colors and weight of the fully transparent pixels
+			std::vector<float> sum(8 * (size_t)dst_width);
+
+			for (unsigned y = first_row; y < end_row; y++) {
+				const unsigned iLeft = weightsTable.getLeftBoundary(y);				// retrieve left boundary
+				const unsigned iLimit = weightsTable.getRightBoundary(y) - iLeft;	// retrieve right boundary
+
+				// accumulate whole rows, for a sequential memory access
+				std::fill(sum.begin(), sum.end(), 0.0f);
+				for (unsigned i = 0; i < iLimit; i++) {
+					const float weight = (float)weightsTable.getWeight(y, i);
+					const FIRGBA16 *tmp_bits = tmp.data() + (size_t)(iLeft + i) * dst_width;
+					float *s = sum.data();
+					for (unsigned x = 0; x < dst_width; x++, s += 8) {
+						if (tmp_bits[x].alpha) {
+							s[0] += weight * tmp_bits[x].red;
+							s[1] += weight * tmp_bits[x].green;
+							s[2] += weight * tmp_bits[x].blue;
+							s[3] += weight * tmp_bits[x].alpha;
+						} else {
+							s[4] += weight * tmp_bits[x].red;
+							s[5] += weight * tmp_bits[x].green;
+							s[6] += weight * tmp_bits[x].blue;
+							s[7] += weight;
+						}
+					}
+				}
+
+				uint8_t *dst_bits = FreeImage_GetScanLine(dst, y);
+				const float *s = sum.data();
+				for (unsigned x = 0; x < dst_width; x++, s += 8, dst_bits += bytespp) {
+					if (s[3] <= 0) {
+						// fully transparent : keep the straight colors of the transparent pixels
+						const float inv_weight = (s[7] > 0) ? 1 / s[7] : 0;
+						dst_bits[FI_RGBA_RED]	= to_srgb[to_fixed(s[4] * inv_weight * (1.0f / 65535))];
+						dst_bits[FI_RGBA_GREEN]	= to_srgb[to_fixed(s[5] * inv_weight * (1.0f / 65535))];
+						dst_bits[FI_RGBA_BLUE]	= to_srgb[to_fixed(s[6] * inv_weight * (1.0f / 65535))];
+						if (bHasAlpha) {
+							dst_bits[FI_RGBA_ALPHA] = 0;
+						}
+						continue;
+					}
+					// colors are divided by alpha (this also cancels the rounding of the weights for opaque images)
+					const float inv_alpha = 1 / s[3];
+					dst_bits[FI_RGBA_RED]	= to_srgb[to_fixed(s[0] * inv_alpha)];
+					dst_bits[FI_RGBA_GREEN]	= to_srgb[to_fixed(s[1] * inv_alpha)];
+					dst_bits[FI_RGBA_BLUE]	= to_srgb[to_fixed(s[2] * inv_alpha)];
+					if (bHasAlpha) {
+						dst_bits[FI_RGBA_ALPHA] = (uint8_t)std::clamp<int>((int)(s[3] * (255.0f / 65535) + 0.5f), 0, 0xFF);
+					}
+				}
+			}
+		});
+	}
+	catch (const std::bad_alloc&) {
+		FreeImage_Unload(dst);
+		return nullptr;
+	}
+
+	return dst;
+}
+
 void CResizeEngine::horizontalFilter(FIBITMAP *const src, unsigned height, unsigned src_width, unsigned src_offset_x, unsigned src_offset_y, const FIRGBA8 *const src_pal, FIBITMAP *const dst, unsigned dst_width) {
 
 	// allocate and calculate the contributions
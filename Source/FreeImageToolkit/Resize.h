@@ -161,6 +161,22 @@ public:
 
 private:
 
+	/**
+	Scale a 24-bit or 32-bit image in linear light (see FI_RESCALE_LINEAR_LIGHT).
+	The horizontal pass decodes the sRGB values through a table and stores
+	alpha premultiplied 16-bit linear values, the vertical pass encodes the result back to sRGB.
+
+	@param src Source image
+	@param dst_width Destination image width
+	@param dst_height Destination image height
+	@param src_offset_x
+	@param src_offset_y
+	@param src_width Width of the source rectangle to be scaled
+	@param src_height Height of the source rectangle to be scaled
+	@return Returns the scaled image if successful, returns NULL otherwise
+	*/
+	FIBITMAP* scaleLinearLight(FIBITMAP *src, unsigned dst_width, unsigned dst_height, unsigned src_offset_x, unsigned src_offset_y, unsigned src_width, unsigned src_height);
+
 	/**
 	Performs horizontal image filtering
 
@@ -0,0 +1,794 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#include "FreeImage.h"
+#include "Utilities.h"
+#include "Filters.h"
+#include "WorkImage.h"
+#include "FreeImage/SimdFloat4.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+
+	// ----------------------------------------------------------
+	//  Interpolation kernels
+	// ----------------------------------------------------------
+
+	/** Number of sub-pixel positions of the weight tables, the positions are rounded to 1/Phases pixel */
+	constexpr int PhaseBits = 8;
+	constexpr int Phases = 1 << PhaseBits;
+
+	/** Positions far outside of any image are clamped to +/- MaxPosition, which fits 32-bit fixed point positions */
+	constexpr double MaxPosition = 1 << 22;
+
+	/** Sampling position along an axis : pixel floor(p) and sub-pixel phase in [0, Phases] */
+	struct Position
+	{
+		ptrdiff_t pixel;
+		int phase;
+	};
+
+	/** Position of p, NaN is far outside of the image */
+	inline Position FixedPosition(double p)
+	{
+		p = (p > -MaxPosition) ? std::min(p, MaxPosition) : -MaxPosition;
+		auto pixel = static_cast<ptrdiff_t>(p);
+		if (pixel > p) {
+			--pixel;
+		}
+		return { pixel, static_cast<int>((p - pixel) * Phases + 0.5) };
+	}
+
+	/** Position of a fixed point value in 1/Phases pixel */
+	inline Position FixedPosition(int64_t p)
+	{
+		return { static_cast<ptrdiff_t>(p >> PhaseBits), static_cast<int>(p & (Phases - 1)) };
+	}
+
+	/**
+	Weights of a separable interpolation kernel at Phases + 1 sub-pixel positions in [0, 1].
+	A sample at the position p is interpolated from the pixels floor(p) - radius + 1 ... floor(p) + radius,
+	the weights of every position sum to 1. The nearest neighbour kernel uses the single pixel round(p).
+	*/
+	template <typename Work_>
+	struct KernelTable
+	{
+		bool nearest = false;
+		int radius = 0;
+		int taps = 1;				// pixels per axis
+		std::vector<Work_> weights;	// taps weights per position
+
+		explicit KernelTable(FREE_IMAGE_FILTER filter)
+		{
+			std::unique_ptr<CGenericFilter> kernel;
+			switch (filter) {
+				case FILTER_BILINEAR:
+					kernel = std::make_unique<CBilinearFilter>();
+					break;
+				case FILTER_BICUBIC:
+					kernel = std::make_unique<CBicubicFilter>();
+					break;
+				case FILTER_BSPLINE:
+					kernel = std::make_unique<CBSplineFilter>();
+					break;
+				case FILTER_CATMULLROM:
+					kernel = std::make_unique<CCatmullRomFilter>();
+					break;
+				case FILTER_LANCZOS3:
+					kernel = std::make_unique<CLanczos3Filter>();
+					break;
+				case FILTER_BOX:
+				default:
+					nearest = true;
+					return;
+			}
+
+			radius = static_cast<int>(std::ceil(kernel->GetWidth()));
+			taps = 2 * radius;
+			weights.resize(static_cast<size_t>(Phases + 1) * taps);
+			for (int phase = 0; phase <= Phases; ++phase) {
+				const double t = static_cast<double>(phase) / Phases;
+				double w[8], sum = 0;
+				for (int k = 0; k < taps; ++k) {
+					w[k] = kernel->Filter(t + radius - 1 - k);
+					// the zeros of the kernels at whole pixel distances are not exact, e.g. those of sinc
+					if (std::abs(w[k]) < 1e-9) {
+						w[k] = 0;
+					}
+					sum += w[k];
+				}
+				for (int k = 0; k < taps; ++k) {
+					weights[static_cast<size_t>(phase) * taps + k] = static_cast<Work_>(w[k] / sum);
+				}
+			}
+		}
+
+		/** Weights of the pixels position.pixel - radius + 1 ... position.pixel + radius */
+		const Work_* Weights(const Position& position) const
+		{
+			return weights.data() + static_cast<size_t>(position.phase) * taps;
+		}
+	};
+
+	// ----------------------------------------------------------
+	//  Pixels
+	// ----------------------------------------------------------
+
+	/** Pixel of Channels_ values of type Value_, as a vector of floats */
+	template <typename Value_, unsigned Channels_>
+	inline Float4 LoadPixel(const Value_* p)
+	{
+		alignas(16) float v[4] = { 0, 0, 0, 0 };
+		for (unsigned c = 0; c < Channels_; ++c) {
+			v[c] = static_cast<float>(p[c]);
+		}
+		return Float4::Load(v);
+	}
+
+#ifdef FI_FLOAT4_SSE2
+	/** 24-bit and 32-bit pixels, widened in registers */
+	inline Float4 WidenBytes(uint32_t bytes)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(bytes)), zero);
+		return { _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)) };
+	}
+
+	template <>
+	inline Float4 LoadPixel<uint8_t, 3>(const uint8_t* p)
+	{
+		return WidenBytes(p[0] | (p[1] << 8) | (p[2] << 16));
+	}
+
+	template <>
+	inline Float4 LoadPixel<uint8_t, 4>(const uint8_t* p)
+	{
+		uint32_t bytes;
+		memcpy(&bytes, p, sizeof(bytes));
+		return WidenBytes(bytes);
+	}
+#endif // FI_FLOAT4_SSE2
+
+	/** Working values converted to a pixel, unsigned values are rounded and clamped */
+	template <typename Value_, typename Work_, unsigned Channels_>
+	inline void StorePixel(const Work_* values, Value_* dst)
+	{
+		for (unsigned c = 0; c < Channels_; ++c) {
+			if constexpr (std::is_unsigned_v<Value_> && std::is_same_v<Work_, float>) {
+				const float v = std::clamp(values[c], 0.F, static_cast<float>(std::numeric_limits<Value_>::max()));
+				dst[c] = static_cast<Value_>(v + 0.5F);
+			}
+			else {
+				dst[c] = ToValue<Value_>(values[c]);
+			}
+		}
+	}
+
+	// ----------------------------------------------------------
+	//  Sampling
+	// ----------------------------------------------------------
+
+	/**
+	Interpolation of the pixels of an image of Channels_ values of type Value_ per pixel,
+	with a kernel of Taps_ x Taps_ pixels, 1 for the nearest pixel. Pixels of up to 4 float channels are interpolated as vectors.
+	*/
+	template <typename Value_, typename Work_, unsigned Channels_, int Taps_>
+	struct Sampler
+	{
+		static constexpr bool Vector = std::is_same_v<Work_, float> && (Channels_ > 1);
+
+		const uint8_t* bits;
+		ptrdiff_t pitch;
+		ptrdiff_t width;
+		ptrdiff_t height;
+		FREE_IMAGE_BORDER_MODE border;
+		const Work_* constant;		// Channels_ values of the pixels outside of the image, for FIBM_ZERO
+
+		const Value_* Pixel(ptrdiff_t x, ptrdiff_t y) const
+		{
+			return reinterpret_cast<const Value_*>(bits + y * pitch) + x * Channels_;
+		}
+
+		/** Interpolation of the pixels [x0, x0 + Taps_) x [y0, y0 + Taps_), all inside of the image */
+		void Inside(ptrdiff_t x0, ptrdiff_t y0, const Work_* wx, const Work_* wy, Work_* result) const
+		{
+			if constexpr (Vector) {
+				Float4 weights[Taps_];
+				for (int k = 0; k < Taps_; ++k) {
+					weights[k] = Float4::Set(wx[k]);
+				}
+				Float4 acc = Float4::Set(0);
+				for (int j = 0; j < Taps_; ++j) {
+					const Value_* p = Pixel(x0, y0 + j);
+					Float4 line = weights[0] * LoadPixel<Value_, Channels_>(p);
+					for (int k = 1; k < Taps_; ++k) {
+						line = line + weights[k] * LoadPixel<Value_, Channels_>(p + k * Channels_);
+					}
+					acc = acc + Float4::Set(wy[j]) * line;
+				}
+				alignas(16) float v[4];
+				acc.Store(v);
+				std::copy(v, v + Channels_, result);
+			}
+			else {
+				std::fill(result, result + Channels_, Work_(0));
+				for (int j = 0; j < Taps_; ++j) {
+					const Value_* p = Pixel(x0, y0 + j);
+					Work_ line[Channels_] = {};
+					for (int k = 0; k < Taps_; ++k) {
+						for (unsigned c = 0; c < Channels_; ++c) {
+							line[c] += wx[k] * static_cast<Work_>(p[k * Channels_ + c]);
+						}
+					}
+					for (unsigned c = 0; c < Channels_; ++c) {
+						result[c] += wy[j] * line[c];
+					}
+				}
+			}
+		}
+
+		/** Interpolation of the pixels [x0, x0 + Taps_) x [y0, y0 + Taps_), read through the border mode */
+		void Border(ptrdiff_t x0, ptrdiff_t y0, const Work_* wx, const Work_* wy, Work_* result) const
+		{
+			ptrdiff_t columns[Taps_], rows[Taps_];
+			for (int k = 0; k < Taps_; ++k) {
+				columns[k] = BorderIndex(x0 + k, width, border);
+				rows[k] = BorderIndex(y0 + k, height, border);
+			}
+			std::fill(result, result + Channels_, Work_(0));
+			for (int j = 0; j < Taps_; ++j) {
+				Work_ line[Channels_] = {};
+				for (int k = 0; k < Taps_; ++k) {
+					const Value_* p = ((rows[j] < 0) || (columns[k] < 0)) ? nullptr : Pixel(columns[k], rows[j]);
+					for (unsigned c = 0; c < Channels_; ++c) {
+						line[c] += wx[k] * (p ? static_cast<Work_>(p[c]) : constant[c]);
+					}
+				}
+				for (unsigned c = 0; c < Channels_; ++c) {
+					result[c] += wy[j] * line[c];
+				}
+			}
+		}
+	};
+
+
+	// ----------------------------------------------------------
+	//  Mappings
+	// ----------------------------------------------------------
+
+	// A mapping gives the source position of the destination pixel (x, y), in scanline coordinates :
+	// void Map(unsigned x, unsigned y, Position& sx, Position& sy) const
+
+	/** Affine mapping : sx = m[0] * x + m[1] * y + m[2], sy = m[3] * x + m[4] * y + m[5] */
+	struct AffineMapping
+	{
+		double m[6];
+
+		void Map(unsigned x, unsigned y, Position& sx, Position& sy) const
+		{
+			sx = FixedPosition(m[0] * x + m[1] * y + m[2]);
+			sy = FixedPosition(m[3] * x + m[4] * y + m[5]);
+		}
+	};
+
+	/** Projective mapping : (sx, sy) = (m[0] * x + m[1] * y + m[2], m[3] * x + m[4] * y + m[5]) / (m[6] * x + m[7] * y + m[8]) */
+	struct PerspectiveMapping
+	{
+		double m[9];
+
+		void Map(unsigned x, unsigned y, Position& sx, Position& sy) const
+		{
+			const double w = m[6] * x + m[7] * y + m[8];
+			// points of the line at infinity, and points behind the projection plane, are outside of the image
+			const double scale = (w > 0) ? 1 / w : std::numeric_limits<double>::quiet_NaN();
+			sx = FixedPosition((m[0] * x + m[1] * y + m[2]) * scale);
+			sy = FixedPosition((m[3] * x + m[4] * y + m[5]) * scale);
+		}
+	};
+
+	/**
+	Mapping by lookup tables : maps of the destination size, giving the source position of every pixel
+	as FIT_FLOAT pixels, or as FIT_INT32 fixed point values in 1/Phases pixel.
+	The maps are in top-down coordinates, the y values are flipped to scanlines.
+	*/
+	template <typename Map_>
+	struct LookupMapping
+	{
+		const uint8_t* x_bits;
+		ptrdiff_t x_pitch;
+		const uint8_t* y_bits;
+		ptrdiff_t y_pitch;
+		std::conditional_t<std::is_floating_point_v<Map_>, Map_, int64_t> src_top;		// source scanline of the top row, in the map unit
+
+		void Map(unsigned x, unsigned y, Position& sx, Position& sy) const
+		{
+			const Map_ mx = reinterpret_cast<const Map_*>(x_bits + y * x_pitch)[x];
+			const Map_ my = reinterpret_cast<const Map_*>(y_bits + y * y_pitch)[x];
+			if constexpr (std::is_floating_point_v<Map_>) {
+				sx = FixedPosition(static_cast<double>(mx));
+				sy = FixedPosition(static_cast<double>(src_top) - my);
+			}
+			else {
+				sx = FixedPosition(static_cast<int64_t>(mx));
+				sy = FixedPosition(src_top - my);
+			}
+		}
+	};
+
+	// ----------------------------------------------------------
+	//  Warp
+	// ----------------------------------------------------------
+
+	/** Destination tiles are TileSize x TileSize pixels, the source pixels of a tile stay in the cache for most mappings */
+	constexpr unsigned TileSize = 64;
+
+	/**
+	Warp of an image of Channels_ values of type Value_ per pixel.
+	Every destination pixel is interpolated at its source position, there is no intermediate image.
+	Bands of rows are processed in parallel, tile by tile.
+	@param constant Value of the pixels outside of the image for FIBM_ZERO, Channels_ values
+	*/
+	template <typename Value_, typename Work_, unsigned Channels_, int Taps_, typename Mapping_>
+	void WarpPixels(FIBITMAP* src, FIBITMAP* dst, const Mapping_& mapping, const KernelTable<Work_>& table,
+		FREE_IMAGE_BORDER_MODE border, const Work_* constant)
+	{
+		const Sampler<Value_, Work_, Channels_, Taps_> sampler{ FreeImage_GetBits(src), static_cast<ptrdiff_t>(FreeImage_GetPitch(src)),
+			static_cast<ptrdiff_t>(FreeImage_GetWidth(src)), static_cast<ptrdiff_t>(FreeImage_GetHeight(src)), border, constant };
+		const unsigned dst_width = FreeImage_GetWidth(dst);
+		const unsigned dst_height = FreeImage_GetHeight(dst);
+		uint8_t* dst_bits = FreeImage_GetBits(dst);
+		const ptrdiff_t dst_pitch = FreeImage_GetPitch(dst);
+
+		// every pixel reads Taps_ x Taps_ source pixels
+		const size_t row_bytes = static_cast<size_t>(dst_width) * Channels_ * sizeof(Value_) * Taps_ * Taps_;
+
+		ParallelForRows(dst_height, row_bytes, [&](unsigned first_row, unsigned end_row) {
+			for (unsigned tile_y = first_row; tile_y < end_row; tile_y += TileSize) {
+				const unsigned tile_end_y = std::min(tile_y + TileSize, end_row);
+				for (unsigned tile_x = 0; tile_x < dst_width; tile_x += TileSize) {
+					const unsigned tile_end_x = std::min(tile_x + TileSize, dst_width);
+
+					for (unsigned y = tile_y; y < tile_end_y; ++y) {
+						auto* pixel = reinterpret_cast<Value_*>(dst_bits + y * dst_pitch) + static_cast<size_t>(tile_x) * Channels_;
+
+						for (unsigned x = tile_x; x < tile_end_x; ++x, pixel += Channels_) {
+							Position sx, sy;
+							mapping.Map(x, y, sx, sy);
+
+							if constexpr (Taps_ == 1) {
+								// nearest pixel
+								const ptrdiff_t ix = BorderIndex(sx.pixel + (sx.phase >= Phases / 2), sampler.width, border);
+								const ptrdiff_t iy = BorderIndex(sy.pixel + (sy.phase >= Phases / 2), sampler.height, border);
+								if ((ix < 0) || (iy < 0)) {
+									StorePixel<Value_, Work_, Channels_>(constant, pixel);
+								}
+								else {
+									std::copy_n(sampler.Pixel(ix, iy), Channels_, pixel);
+								}
+							}
+							else {
+								Work_ result[4];
+								const ptrdiff_t x0 = sx.pixel - table.radius + 1;
+								const ptrdiff_t y0 = sy.pixel - table.radius + 1;
+								const Work_* wx = table.Weights(sx);
+								const Work_* wy = table.Weights(sy);
+
+								if ((x0 >= 0) && (y0 >= 0) && (x0 + Taps_ <= sampler.width) && (y0 + Taps_ <= sampler.height)) {
+									sampler.Inside(x0, y0, wx, wy, result);
+								}
+								else if ((border == FIBM_ZERO) && ((x0 >= sampler.width) || (y0 >= sampler.height) || (x0 + Taps_ <= 0) || (y0 + Taps_ <= 0))) {
+									// the whole kernel is outside of the image
+									std::copy(constant, constant + Channels_, result);
+								}
+								else {
+									sampler.Border(x0, y0, wx, wy, result);
+								}
+								StorePixel<Value_, Work_, Channels_>(result, pixel);
+							}
+						}
+					}
+				}
+			}
+		});
+	}
+
+	/** Dispatch on the kernel size */
+	template <typename Value_, typename Work_, unsigned Channels_, typename Mapping_>
+	void WarpChannels(FIBITMAP* src, FIBITMAP* dst, const Mapping_& mapping, const KernelTable<Work_>& table,
+		FREE_IMAGE_BORDER_MODE border, const Work_* constant)
+	{
+		switch (table.nearest ? 1 : table.taps) {
+			case 1:
+				WarpPixels<Value_, Work_, Channels_, 1>(src, dst, mapping, table, border, constant);
+				break;
+			case 2:
+				WarpPixels<Value_, Work_, Channels_, 2>(src, dst, mapping, table, border, constant);
+				break;
+			case 4:
+				WarpPixels<Value_, Work_, Channels_, 4>(src, dst, mapping, table, border, constant);
+				break;
+			default:
+				WarpPixels<Value_, Work_, Channels_, 6>(src, dst, mapping, table, border, constant);
+				break;
+		}
+	}
+
+	/** Copy the palette, the transparency, the background color, the ICC profile and the metadata of src to dst */
+	void CopyImageProperties(FIBITMAP* dst, FIBITMAP* src)
+	{
+		if (FIRGBA8* dst_pal = FreeImage_GetPalette(dst)) {
+			memcpy(dst_pal, FreeImage_GetPalette(src), FreeImage_GetColorsUsed(src) * sizeof(FIRGBA8));
+			FreeImage_SetTransparencyTable(dst, FreeImage_GetTransparencyTable(src), FreeImage_GetTransparencyCount(src));
+		}
+		FIRGBA8 background;
+		if (FreeImage_GetBackgroundColor(src, &background)) {
+			FreeImage_SetBackgroundColor(dst, &background);
+		}
+		const FIICCPROFILE* icc = FreeImage_GetICCProfile(src);
+		if (icc && icc->data && (icc->size > 0)) {
+			FreeImage_CreateICCProfile(dst, icc->data, icc->size);
+		}
+		FreeImage_CloneMetadata(dst, src);
+	}
+
+	/**
+	Warp an image of 'channels' values of type Value_ per pixel
+	*/
+	template <typename Value_, typename Work_, typename Mapping_>
+	FIBITMAP* WarpBitmap(FIBITMAP* src, unsigned channels, const Mapping_& mapping, int dst_width, int dst_height,
+		FREE_IMAGE_FILTER filter, FREE_IMAGE_BORDER_MODE border, const void* bkcolor)
+	{
+		UniqueBitmap dst(FreeImage_AllocateT(FreeImage_GetImageType(src), dst_width, dst_height, FreeImage_GetBPP(src),
+			FreeImage_GetRedMask(src), FreeImage_GetGreenMask(src), FreeImage_GetBlueMask(src)), &::FreeImage_Unload);
+		if (!dst) {
+			return nullptr;
+		}
+
+		Work_ constant[4] = {};
+		if (bkcolor) {
+			const auto* values = static_cast<const Value_*>(bkcolor);
+			std::copy(values, values + channels, constant);
+		}
+
+		try {
+			const KernelTable<Work_> table(filter);
+			switch (channels) {
+				case 1:
+					WarpChannels<Value_, Work_, 1>(src, dst.get(), mapping, table, border, constant);
+					break;
+				case 3:
+					WarpChannels<Value_, Work_, 3>(src, dst.get(), mapping, table, border, constant);
+					break;
+				case 4:
+					WarpChannels<Value_, Work_, 4>(src, dst.get(), mapping, table, border, constant);
+					break;
+				default:
+					return nullptr;
+			}
+		}
+		catch (const std::bad_alloc&) {
+			FreeImage_OutputMessageProc(FIF_UNKNOWN, FI_MSG_ERROR_MEMORY);
+			return nullptr;
+		}
+
+		CopyImageProperties(dst.get(), src);
+
+		return dst.release();
+	}
+
+	/**
+	Warp a 1-bit or 4-bit image : the indices are expanded to 8-bit, sampled with the nearest pixel and packed again
+	*/
+	template <typename Mapping_>
+	FIBITMAP* WarpPackedBitmap(FIBITMAP* dib, const Mapping_& mapping, int dst_width, int dst_height,
+		FREE_IMAGE_BORDER_MODE border, const void* bkcolor)
+	{
+		const unsigned bpp = FreeImage_GetBPP(dib);
+		if (bkcolor && (*static_cast<const uint8_t*>(bkcolor) >= (1U << bpp))) {
+			return nullptr;
+		}
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+
+		UniqueBitmap indices(FreeImage_Allocate(width, height, 8), &::FreeImage_Unload);
+		if (!indices) {
+			return nullptr;
+		}
+		for (unsigned y = 0; y < height; ++y) {
+			const uint8_t* src_bits = FreeImage_GetScanLine(dib, y);
+			uint8_t* bits = FreeImage_GetScanLine(indices.get(), y);
+			for (unsigned x = 0; x < width; ++x) {
+				bits[x] = (bpp == 1) ? ((src_bits[x >> 3] >> (7 - (x & 7))) & 0x01) : ((x & 1) ? LOWNIBBLE(src_bits[x >> 1]) : (src_bits[x >> 1] >> 4));
+			}
+		}
+
+		UniqueBitmap warped(WarpBitmap<uint8_t, float>(indices.get(), 1, mapping, dst_width, dst_height, FILTER_BOX, border, bkcolor), &::FreeImage_Unload);
+		UniqueBitmap dst(FreeImage_Allocate(dst_width, dst_height, bpp), &::FreeImage_Unload);
+		if (!warped || !dst) {
+			return nullptr;
+		}
+		for (int y = 0; y < dst_height; ++y) {
+			const uint8_t* bits = FreeImage_GetScanLine(warped.get(), y);
+			uint8_t* dst_bits = FreeImage_GetScanLine(dst.get(), y);
+			memset(dst_bits, 0, FreeImage_GetLine(dst.get()));
+			for (int x = 0; x < dst_width; ++x) {
+				dst_bits[x >> (bpp == 1 ? 3 : 1)] |= (bpp == 1) ? (bits[x] << (7 - (x & 7))) : (bits[x] << ((x & 1) ? 0 : 4));
+			}
+		}
+		CopyImageProperties(dst.get(), dib);
+
+		return dst.release();
+	}
+
+	/**
+	Warp a 16-bit RGB555 or RGB565 image through a 24-bit image
+	*/
+	template <typename Mapping_>
+	FIBITMAP* Warp16BitBitmap(FIBITMAP* dib, const Mapping_& mapping, int dst_width, int dst_height,
+		FREE_IMAGE_FILTER filter, FREE_IMAGE_BORDER_MODE border, const void* bkcolor)
+	{
+		const bool rgb565 = IS_FORMAT_RGB565(dib);
+		uint8_t background[3] = {};
+		if (bkcolor) {
+			uint16_t pixel;
+			memcpy(&pixel, bkcolor, sizeof(pixel));
+			if (rgb565) {
+				FreeImage_ConvertLine16To24_565(background, reinterpret_cast<uint8_t*>(&pixel), 1);
+			}
+			else {
+				FreeImage_ConvertLine16To24_555(background, reinterpret_cast<uint8_t*>(&pixel), 1);
+			}
+		}
+
+		UniqueBitmap rgb(FreeImage_ConvertTo24Bits(dib), &::FreeImage_Unload);
+		if (!rgb) {
+			return nullptr;
+		}
+		UniqueBitmap warped(WarpBitmap<uint8_t, float>(rgb.get(), 3, mapping, dst_width, dst_height, filter, border, background), &::FreeImage_Unload);
+		if (!warped) {
+			return nullptr;
+		}
+		FIBITMAP* dst = rgb565 ? FreeImage_ConvertTo16Bits565(warped.get()) : FreeImage_ConvertTo16Bits555(warped.get());
+		if (dst) {
+			CopyImageProperties(dst, dib);
+		}
+		return dst;
+	}
+
+	/** Warp any supported image, palettized, 1-bit and 4-bit images are sampled with the nearest pixel */
+	template <typename Mapping_>
+	FIBITMAP* WarpImage(FIBITMAP* dib, const Mapping_& mapping, int dst_width, int dst_height,
+		FREE_IMAGE_FILTER filter, FREE_IMAGE_BORDER_MODE border, const void* bkcolor)
+	{
+		// source positions are clamped to +/- MaxPosition
+		if ((FreeImage_GetWidth(dib) > MaxPosition) || (FreeImage_GetHeight(dib) > MaxPosition)) {
+			return nullptr;
+		}
+		if (FreeImage_GetImageType(dib) == FIT_BITMAP) {
+			switch (FreeImage_GetBPP(dib)) {
+				case 1:
+				case 4:
+					return WarpPackedBitmap(dib, mapping, dst_width, dst_height, border, bkcolor);
+				case 8:
+					if (FreeImage_GetColorType(dib) == FIC_PALETTE) {
+						return WarpBitmap<uint8_t, float>(dib, 1, mapping, dst_width, dst_height, FILTER_BOX, border, bkcolor);
+					}
+					break;
+				case 16:
+					return Warp16BitBitmap(dib, mapping, dst_width, dst_height, filter, border, bkcolor);
+			}
+		}
+		return FilterStandardType(dib, [&](auto value, auto work, unsigned channels) {
+			return WarpBitmap<typename decltype(value)::type, typename decltype(work)::type>(dib, channels, mapping, dst_width, dst_height, filter, border, bkcolor);
+		});
+	}
+
+	/** 3 x 3 matrix product a * b, row by row */
+	void Multiply3x3(const double* a, const double* b, double* result)
+	{
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				result[3 * i + j] = a[3 * i] * b[j] + a[3 * i + 1] * b[3 + j] + a[3 * i + 2] * b[6 + j];
+			}
+		}
+	}
+
+	/** Mapping between top-down coordinates and scanline coordinates, in both directions */
+	void FlipRows(double top, double* matrix)
+	{
+		const double flip[9] = { 1, 0, 0, 0, -1, top, 0, 0, 1 };
+		std::copy(flip, flip + 9, matrix);
+	}
+
+} // namespace
+
+/**
+Affine transformation of an image, sampled in a single pass : every destination pixel is interpolated
+at its source position through the inverse mapping, without intermediate images. Rows are processed in parallel.<br>
+Coordinates are given in pixels from the center of the top-left pixel, x to the right and y downwards.
+The matrix maps the source coordinates to the destination coordinates :
+dst_x = matrix[0] * x + matrix[1] * y + matrix[2], dst_y = matrix[3] * x + matrix[4] * y + matrix[5].<br>
+The interpolation kernel is not widened for reductions : for a strong reduction, rescale the image first.
+Palettized images, and all 1-bit and 4-bit images, are sampled with the nearest pixel.
+16-bit RGB555 and RGB565 images are interpolated as 24-bit images. Integer pixels are rounded and clamped to their range.
+Supported images are those of FreeImage_BoxBlur, and 1-, 4-, 8-bit palettized and 16-bit images, up to 4194304 (2^22)
+pixels wide and high.
+@param dib Source image
+@param matrix 2 x 3 affine matrix, row by row
+@param dst_width Width of the destination image
+@param dst_height Height of the destination image
+@param filter Interpolation kernel : FILTER_BOX is the nearest pixel, FILTER_BILINEAR, FILTER_BICUBIC,
+FILTER_CATMULLROM, FILTER_BSPLINE and FILTER_LANCZOS3 are interpolated over 2 x 2, 4 x 4 or 6 x 6 pixels
+@param border Values of the pixels outside of the image
+@param bkcolor Value of the pixels outside of the image for FIBM_ZERO, given as a pixel of the image type
+(a palette index for palettized, 1-bit and 4-bit images), NULL for zero
+@return Returns the warped image if successful, NULL otherwise
+@see FreeImage_WarpPerspective, FreeImage_Remap
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_WarpAffine(FIBITMAP *dib, const double *matrix, int dst_width, int dst_height, FREE_IMAGE_FILTER filter, FREE_IMAGE_BORDER_MODE border, const void *bkcolor) {
+	if (!FreeImage_HasPixels(dib) || !matrix || (dst_width <= 0) || (dst_height <= 0) || (border < FIBM_CLAMP) || (border > FIBM_ZERO)) {
+		return nullptr;
+	}
+	const double det = matrix[0] * matrix[4] - matrix[1] * matrix[3];
+	if (!std::isfinite(det) || (det == 0)) {
+		return nullptr;
+	}
+
+	// inverse mapping, from the destination to the source
+	const double a = matrix[4] / det, b = -matrix[1] / det;
+	const double d = -matrix[3] / det, e = matrix[0] / det;
+	const double c = -(a * matrix[2] + b * matrix[5]);
+	const double f = -(d * matrix[2] + e * matrix[5]);
+
+	// scanlines are stored bottom-up : y = height - 1 - scanline, in the source and in the destination
+	const double src_top = FreeImage_GetHeight(dib) - 1.0;
+	const double dst_top = dst_height - 1.0;
+	const AffineMapping mapping{ {
+		a, -b, c + b * dst_top,
+		-d, e, src_top - f - e * dst_top
+	} };
+
+	return WarpImage(dib, mapping, dst_width, dst_height, filter, border, bkcolor);
+}
+
+/**
+Perspective transformation of an image, e.g. the rectification of a photographed document,
+sampled in a single pass as FreeImage_WarpAffine.<br>
+The homography maps the source coordinates to the destination coordinates :
+dst_x = (matrix[0] * x + matrix[1] * y + matrix[2]) / w, dst_y = (matrix[3] * x + matrix[4] * y + matrix[5]) / w,
+with w = matrix[6] * x + matrix[7] * y + matrix[8]. Coordinates are those of FreeImage_WarpAffine.
+Source points with w <= 0 are behind the projection plane : the destination pixels they map to are border pixels.
+@param dib Source image
+@param matrix 3 x 3 homography, row by row
+@param dst_width Width of the destination image
+@param dst_height Height of the destination image
+@param filter Interpolation kernel, see FreeImage_WarpAffine
+@param border Values of the pixels outside of the image
+@param bkcolor Value of the pixels outside of the image for FIBM_ZERO, see FreeImage_WarpAffine
+@return Returns the warped image if successful, NULL otherwise
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_WarpPerspective(FIBITMAP *dib, const double *matrix, int dst_width, int dst_height, FREE_IMAGE_FILTER filter, FREE_IMAGE_BORDER_MODE border, const void *bkcolor) {
+	if (!FreeImage_HasPixels(dib) || !matrix || (dst_width <= 0) || (dst_height <= 0) || (border < FIBM_CLAMP) || (border > FIBM_ZERO)) {
+		return nullptr;
+	}
+
+	// inverse mapping, from the destination to the source : adjugate of the matrix, 
+	// the scale does not matter but its sign does, w keeps the sign of the forward mapping
+	const double* m = matrix;
+	double inverse[9] = {
+		m[4] * m[8] - m[5] * m[7], m[2] * m[7] - m[1] * m[8], m[1] * m[5] - m[2] * m[4],
+		m[5] * m[6] - m[3] * m[8], m[0] * m[8] - m[2] * m[6], m[2] * m[3] - m[0] * m[5],
+		m[3] * m[7] - m[4] * m[6], m[1] * m[6] - m[0] * m[7], m[0] * m[4] - m[1] * m[3]
+	};
+	const double det = m[0] * inverse[0] + m[1] * inverse[3] + m[2] * inverse[6];
+	if (!std::isfinite(det) || (det == 0)) {
+		return nullptr;
+	}
+	if (det < 0) {
+		for (double& v : inverse) {
+			v = -v;
+		}
+	}
+
+	// scanlines are stored bottom-up, in the source and in the destination
+	double src_flip[9], dst_flip[9], flipped[9];
+	FlipRows(FreeImage_GetHeight(dib) - 1.0, src_flip);
+	FlipRows(dst_height - 1.0, dst_flip);
+	PerspectiveMapping mapping;
+	Multiply3x3(src_flip, inverse, flipped);
+	Multiply3x3(flipped, dst_flip, mapping.m);
+
+	return WarpImage(dib, mapping, dst_width, dst_height, filter, border, bkcolor);
+}
+
+/**
+Geometric transformation of an image by lookup tables, e.g. a lens undistortion : the destination pixel (x, y)
+is interpolated at the source position (map_x(x, y), map_y(x, y)). The destination has the size of the maps.
+Coordinates are those of FreeImage_WarpAffine.<br>
+The maps are FIT_FLOAT images, or FIT_INT32 images of fixed point positions computed once
+by FreeImage_ConvertRemapMap for a repeated use : they are read faster and take the same memory.
+@param dib Source image
+@param map_x Source x of every destination pixel
+@param map_y Source y of every destination pixel, a map of the same type and size as map_x
+@param filter Interpolation kernel, see FreeImage_WarpAffine
+@param border Values of the pixels outside of the image
+@param bkcolor Value of the pixels outside of the image for FIBM_ZERO, see FreeImage_WarpAffine
+@return Returns the remapped image if successful, NULL otherwise
+@see FreeImage_ConvertRemapMap
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_Remap(FIBITMAP *dib, FIBITMAP *map_x, FIBITMAP *map_y, FREE_IMAGE_FILTER filter, FREE_IMAGE_BORDER_MODE border, const void *bkcolor) {
+	if (!FreeImage_HasPixels(dib) || !FreeImage_HasPixels(map_x) || !FreeImage_HasPixels(map_y) || (border < FIBM_CLAMP) || (border > FIBM_ZERO)) {
+		return nullptr;
+	}
+	const FREE_IMAGE_TYPE map_type = FreeImage_GetImageType(map_x);
+	const int width = static_cast<int>(FreeImage_GetWidth(map_x));
+	const int height = static_cast<int>(FreeImage_GetHeight(map_x));
+	if ((FreeImage_GetImageType(map_y) != map_type) || (static_cast<int>(FreeImage_GetWidth(map_y)) != width) || (static_cast<int>(FreeImage_GetHeight(map_y)) != height)) {
+		return nullptr;
+	}
+
+	const unsigned src_top = FreeImage_GetHeight(dib) - 1;
+	switch (map_type) {
+		case FIT_FLOAT:
+		{
+			const LookupMapping<float> mapping{ FreeImage_GetBits(map_x), static_cast<ptrdiff_t>(FreeImage_GetPitch(map_x)),
+				FreeImage_GetBits(map_y), static_cast<ptrdiff_t>(FreeImage_GetPitch(map_y)), static_cast<float>(src_top) };
+			return WarpImage(dib, mapping, width, height, filter, border, bkcolor);
+		}
+		case FIT_INT32:
+		{
+			const LookupMapping<int32_t> mapping{ FreeImage_GetBits(map_x), static_cast<ptrdiff_t>(FreeImage_GetPitch(map_x)),
+				FreeImage_GetBits(map_y), static_cast<ptrdiff_t>(FreeImage_GetPitch(map_y)), static_cast<int64_t>(src_top) << PhaseBits };
+			return WarpImage(dib, mapping, width, height, filter, border, bkcolor);
+		}
+		default:
+			return nullptr;
+	}
+}
+
+/**
+Convert a FIT_FLOAT map of FreeImage_Remap to fixed point positions, in 1/256 pixel.
+A map used for several images (e.g. the frames of a camera) is converted once,
+the remapping then skips the conversion of the positions. NaN values are positions outside of any image.
+@param map FIT_FLOAT map
+@return Returns a FIT_INT32 map of the same size if successful, NULL otherwise
+*/
+FIBITMAP * DLL_CALLCONV
+FreeImage_ConvertRemapMap(FIBITMAP *map) {
+	if (!FreeImage_HasPixels(map) || (FreeImage_GetImageType(map) != FIT_FLOAT)) {
+		return nullptr;
+	}
+	const unsigned width = FreeImage_GetWidth(map);
+	const unsigned height = FreeImage_GetHeight(map);
+	FIBITMAP *dst = FreeImage_AllocateT(FIT_INT32, width, height);
+	if (!dst) {
+		return nullptr;
+	}
+
+	ParallelForRows(height, static_cast<size_t>(width) * 8, [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; ++y) {
+			const auto* src_bits = reinterpret_cast<const float*>(FreeImage_GetScanLine(map, y));
+			auto* dst_bits = reinterpret_cast<int32_t*>(FreeImage_GetScanLine(dst, y));
+			for (unsigned x = 0; x < width; ++x) {
+				const Position p = FixedPosition(static_cast<double>(src_bits[x]));
+				dst_bits[x] = static_cast<int32_t>(p.pixel * Phases + p.phase);
+			}
+		}
+	});
+
+	return dst;
+}
@@ -0,0 +1,269 @@
+//===========================================================
+// FreeImage Re(surrected)
+// Modified fork from the original FreeImage 3.18
+// with updated dependencies and extended features.
+//===========================================================
+
+#ifndef FREEIMAGE_WORK_IMAGE_H_
+#define FREEIMAGE_WORK_IMAGE_H_
+
+#include "FreeImage.h"
+#include "FreeImage/SimpleTools.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// ----------------------------------------------------------
+//  Images converted to a working type, for the neighbourhood filters
+// ----------------------------------------------------------
+
+/** Values of a row converted to the working type */
+template <typename Value_, typename Work_>
+void LoadRow(const void* src, Work_* dst, size_t count)
+{
+	const auto values = static_cast<const Value_*>(src);
+	for (size_t i = 0; i < count; ++i) {
+		dst[i] = static_cast<Work_>(values[i]);
+	}
+}
+
+/** Working values converted to a row, integer values are rounded and clamped */
+template <typename Value_, typename Work_>
+inline Value_ ToValue(Work_ v)
+{
+	if constexpr (std::is_integral_v<Value_> && !std::is_integral_v<Work_>) {
+		const Work_ rounded = std::floor(v + Work_(0.5));
+		return static_cast<Value_>(std::clamp<Work_>(rounded, static_cast<Work_>(std::numeric_limits<Value_>::min()), static_cast<Work_>(std::numeric_limits<Value_>::max())));
+	}
+	else {
+		return static_cast<Value_>(v);
+	}
+}
+
+/**
+Image converted to the working type, with its channels interleaved.
+Rows are stored in the scanline order of the bitmap (bottom-up).
+*/
+template <typename Work_>
+struct WorkImage
+{
+	size_t width;		// pixels per row
+	size_t height;
+	size_t channels;
+	std::vector<Work_> values;
+
+	WorkImage(size_t w, size_t h, size_t c)
+		: width(w), height(h), channels(c), values(w * h * c)
+	{}
+
+	size_t RowLength() const { return width * channels; }
+	Work_* Row(size_t y) { return values.data() + y * RowLength(); }
+	const Work_* Row(size_t y) const { return values.data() + y * RowLength(); }
+};
+
+/** Load the pixels of a bitmap made of Value_ channels */
+template <typename Value_, typename Work_>
+void LoadImage(FIBITMAP* src, WorkImage<Work_>& image)
+{
+	const size_t row_length = image.RowLength();
+	ParallelForRows(static_cast<unsigned>(image.height), row_length * sizeof(Value_), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; ++y) {
+			LoadRow<Value_>(FreeImage_GetScanLine(src, y), image.Row(y), row_length);
+		}
+	});
+}
+
+/** Store the pixels of an image into a bitmap made of Value_ channels */
+template <typename Value_, typename Work_>
+void StoreImage(const WorkImage<Work_>& image, FIBITMAP* dst)
+{
+	const size_t row_length = image.RowLength();
+	ParallelForRows(static_cast<unsigned>(image.height), row_length * sizeof(Value_), [&](unsigned first_row, unsigned end_row) {
+		for (unsigned y = first_row; y < end_row; ++y) {
+			const Work_* values = image.Row(y);
+			auto dst_bits = reinterpret_cast<Value_*>(FreeImage_GetScanLine(dst, y));
+			for (size_t i = 0; i < row_length; ++i) {
+				dst_bits[i] = ToValue<Value_>(values[i]);
+			}
+		}
+	});
+}
+
+// ----------------------------------------------------------
+//  Borders
+// ----------------------------------------------------------
+
+/**
+Index of the sample i of a line of n samples, for the border mode.
+@return Returns the index of the sample in [0, n), or -1 when the sample is a constant
+*/
+inline ptrdiff_t BorderIndex(ptrdiff_t i, ptrdiff_t n, FREE_IMAGE_BORDER_MODE border)
+{
+	if ((i >= 0) && (i < n)) {
+		return i;
+	}
+	switch (border) {
+	case FIBM_MIRROR:
+		if (n == 1) {
+			return 0;
+		}
+		else {
+			const ptrdiff_t period = 2 * n - 2;
+			i = std::abs(i) % period;
+			return (i < n) ? i : period - i;
+		}
+	case FIBM_WRAP:
+		i %= n;
+		return (i < 0) ? i + n : i;
+	case FIBM_ZERO:
+		return -1;
+	case FIBM_CLAMP:
+	default:
+		return std::clamp<ptrdiff_t>(i, 0, n - 1);
+	}
+}
+
+// ----------------------------------------------------------
+//  Line filters over the rows and the columns of an image
+// ----------------------------------------------------------
+
+/**
+A line filter is a copyable function object called as line(Work_* in, Work_* out, size_t length, size_t lanes).
+It filters a line of 'length' samples, each made of 'lanes' interleaved values, from 'in' to 'out'.
+The input values may be overwritten. Every band of rows or columns uses its own copy of the filter,
+so that the filter may keep scratch buffers. Out of memory errors are reported as std::bad_alloc.
+*/
+
+/** Width of the column strips of FilterColumns, in values */
+constexpr size_t StripLength = 256;
+
+/**
+Run a line filter over every row of the image, the channels are the lanes of the line
+*/
+template <typename Work_, typename LineFilter_>
+void FilterRows(WorkImage<Work_>& image, const LineFilter_& line)
+{
+	const size_t row_length = image.RowLength();
+	std::atomic<bool> out_of_memory{ false };
+
+	ParallelForRows(static_cast<unsigned>(image.height), row_length * sizeof(Work_), [&](unsigned first_row, unsigned end_row) {
+		try {
+			LineFilter_ band_line(line);
+			std::vector<Work_> tmp(row_length);
+			for (unsigned y = first_row; y < end_row; ++y) {
+				Work_* row = image.Row(y);
+				band_line(row, tmp.data(), image.width, image.channels);
+				std::copy(tmp.begin(), tmp.end(), row);
+			}
+		}
+		catch (const std::bad_alloc&) {
+			out_of_memory = true;
+		}
+	});
+	if (out_of_memory) {
+		throw std::bad_alloc();
+	}
+}
+
+/**
+Run a line filter over every column of the image, bottom-up.
+The columns are filtered by strips : the rows of a strip are copied together,
+so that the lanes of the line are the values of a strip row and are contiguous.
+*/
+template <typename Work_, typename LineFilter_>
+void FilterColumns(WorkImage<Work_>& image, const LineFilter_& line)
+{
+	const size_t row_length = image.RowLength();
+	const size_t strip_count = (row_length + StripLength - 1) / StripLength;
+	std::atomic<bool> out_of_memory{ false };
+
+	ParallelForRows(static_cast<unsigned>(strip_count), image.height * StripLength * sizeof(Work_), [&](unsigned first_strip, unsigned end_strip) {
+		try {
+			LineFilter_ band_line(line);
+			std::vector<Work_> a(image.height * StripLength), b(image.height * StripLength);
+			for (unsigned strip = first_strip; strip < end_strip; ++strip) {
+				const size_t offset = strip * StripLength;
+				const size_t lanes = std::min(StripLength, row_length - offset);
+				for (size_t y = 0; y < image.height; ++y) {
+					const Work_* row = image.Row(y) + offset;
+					std::copy(row, row + lanes, a.data() + y * lanes);
+				}
+				band_line(a.data(), b.data(), image.height, lanes);
+				for (size_t y = 0; y < image.height; ++y) {
+					std::copy(b.data() + y * lanes, b.data() + (y + 1) * lanes, image.Row(y) + offset);
+				}
+			}
+		}
+		catch (const std::bad_alloc&) {
+			out_of_memory = true;
+		}
+	});
+	if (out_of_memory) {
+		throw std::bad_alloc();
+	}
+}
+
+// ----------------------------------------------------------
+//  Image types of the neighbourhood filters
+// ----------------------------------------------------------
+
+/**
+Call filter(std::type_identity<Value_>, std::type_identity<Work_>, unsigned channels) with the channel type,
+the working type and the number of channels of an image : 8-bit greyscale, 24-bit and 32-bit bitmaps,
+and the integer, floating point and RGB(A) types. Integer channels of up to 16 bits are filtered as float values,
+32-bit integers as double values. Palettized, 1-bit, 4-bit, 16-bit and complex images are not supported.
+@return Returns the result of the filter, NULL for the unsupported images
+*/
+template <typename Filter_>
+FIBITMAP* FilterStandardType(FIBITMAP* src, Filter_ filter)
+{
+	using std::type_identity;
+
+	if (!FreeImage_HasPixels(src)) {
+		return nullptr;
+	}
+	switch (FreeImage_GetImageType(src)) {
+	case FIT_BITMAP:
+		switch (FreeImage_GetBPP(src)) {
+		case 8:
+			if ((FreeImage_GetColorType(src) != FIC_MINISBLACK) && (FreeImage_GetColorType(src) != FIC_MINISWHITE)) {
+				return nullptr;
+			}
+			return filter(type_identity<uint8_t>{}, type_identity<float>{}, 1U);
+		case 24:
+			return filter(type_identity<uint8_t>{}, type_identity<float>{}, 3U);
+		case 32:
+			return filter(type_identity<uint8_t>{}, type_identity<float>{}, 4U);
+		default:
+			return nullptr;
+		}
+	case FIT_UINT16:
+		return filter(type_identity<uint16_t>{}, type_identity<float>{}, 1U);
+	case FIT_INT16:
+		return filter(type_identity<int16_t>{}, type_identity<float>{}, 1U);
+	case FIT_UINT32:
+		return filter(type_identity<uint32_t>{}, type_identity<double>{}, 1U);
+	case FIT_INT32:
+		return filter(type_identity<int32_t>{}, type_identity<double>{}, 1U);
+	case FIT_FLOAT:
+		return filter(type_identity<float>{}, type_identity<float>{}, 1U);
+	case FIT_DOUBLE:
+		return filter(type_identity<double>{}, type_identity<double>{}, 1U);
+	case FIT_RGB16:
+		return filter(type_identity<uint16_t>{}, type_identity<float>{}, 3U);
+	case FIT_RGBA16:
+		return filter(type_identity<uint16_t>{}, type_identity<float>{}, 4U);
+	case FIT_RGBF:
+		return filter(type_identity<float>{}, type_identity<float>{}, 3U);
+	case FIT_RGBAF:
+		return filter(type_identity<float>{}, type_identity<float>{}, 4U);
+	default:
+		return nullptr;
+	}
+}
+
+#endif // FREEIMAGE_WORK_IMAGE_H_
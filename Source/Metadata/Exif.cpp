@@ -997,22 +997,20 @@ RotateExif(FIBITMAP **dib) {
 				case 4:		// "bottom, left side" => flip up-down
 					FreeImage_FlipVertical(*dib);
 					break;
-				case 5:		// "left side, top" => +90 + flip up-down
-					rotated = FreeImage_Rotate(*dib, 90);
+				case 5:		// "left side, top" => transpose (+90 + flip up-down)
+					rotated = FreeImage_Transpose(*dib);
 					FreeImage_Unload(*dib);
 					*dib = rotated;
-					FreeImage_FlipVertical(*dib);
 					break;
 				case 6:		// "right side, top" => -90
 					rotated = FreeImage_Rotate(*dib, -90);
 					FreeImage_Unload(*dib);
 					*dib = rotated;
 					break;
-				case 7:		// "right side, bottom" => -90 + flip up-down
-					rotated = FreeImage_Rotate(*dib, -90);
+				case 7:		// "right side, bottom" => transverse (-90 + flip up-down)
+					rotated = FreeImage_Transverse(*dib);
 					FreeImage_Unload(*dib);
 					*dib = rotated;
-					FreeImage_FlipVertical(*dib);
 					break;
 				case 8:		// "left side, bottom" => +90
 					rotated = FreeImage_Rotate(*dib, 90);
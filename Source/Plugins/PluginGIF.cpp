@@ -74,6 +74,10 @@ struct PageInfo {
 //GIF defines a max of 12 bits per code
 #define MAX_LZW_CODE			4096
 
+//Size of the compressor hash dictionary, must be a power of 2 and at least 2 * MAX_LZW_CODE
+#define LZW_HASH_BITS			13
+#define LZW_HASH_SIZE			(1 << LZW_HASH_BITS)
+
 class StringTable
 {
 public:
@@ -102,8 +106,16 @@ protected:
 	int firstPixelPassed; // A specific flag that indicates if the first pixel
 	                      // of the whole image had already been read
 
-	std::string m_strings[MAX_LZW_CODE]; //This is what is really the "string table" data for the Decompressor
-	int* m_strmap;
+	//Decompressor string table: every code is stored as <prefix code, suffix byte>,
+	//strings are written backwards straight into the output buffer
+	uint16_t m_codePrefix[MAX_LZW_CODE];
+	uint16_t m_codeLength[MAX_LZW_CODE];
+	uint8_t m_codeSuffix[MAX_LZW_CODE];
+	uint8_t m_codeFirst[MAX_LZW_CODE];
+
+	//Compressor dictionary: open addressing hash of <prefix code << 8 | pixel> -> code
+	int m_hashKey[LZW_HASH_SIZE];
+	uint16_t m_hashCode[LZW_HASH_SIZE];
 
 	//input buffer
 	uint8_t *m_buffer;
@@ -182,10 +194,6 @@ StringTable::StringTable()
 {
 	m_buffer = nullptr;
 	firstPixelPassed = 0; // Still no pixel read
-	// Maximum number of entries in the map is MAX_LZW_CODE * 256 
-	// (aka 2**12 * 2**8 => a 20 bits key)
-	// This Map could be optmized to only handle MAX_LZW_CODE * 2**(m_bpp)
-	m_strmap = new(std::nothrow) int[1<<20];
 }
 
 StringTable::~StringTable()
@@ -193,10 +201,6 @@ StringTable::~StringTable()
 	if (m_buffer) {
 		delete [] m_buffer;
 	}
-	if (m_strmap) {
-		delete [] m_strmap;
-		m_strmap = nullptr;
-	}
 }
 
 void StringTable::Initialize(int minCodeSize)
@@ -280,31 +284,37 @@ bool StringTable::Compress(uint8_t *buf, int *len)
 		return false;
 	}
 
-	int mask = (1 << m_bpp) - 1;
+	const int mask = (1 << m_bpp) - 1;
 	uint8_t *bufpos = buf;
+	uint8_t *const bufend = buf + *len;
 	while (m_bufferPos < m_bufferSize) {
 		//get the current pixel value
-		char ch = (char)((m_buffer[m_bufferPos] >> m_bufferShift) & mask);
+		const int ch = (m_buffer[m_bufferPos] >> m_bufferShift) & mask;
 
-		// The next prefix is : 
-		// <the previous LZW code (on 12 bits << 8)> | <the code of the current pixel (on 8 bits)>
-		int nextprefix = (((m_prefix)<<8)&0xFFF00) + (ch & 0x000FF);
 		if (firstPixelPassed) {
-			
-			if (m_strmap[nextprefix] > 0) {
-				m_prefix = m_strmap[nextprefix];
+			// The dictionary key is : 
+			// <the previous LZW code (on 12 bits << 8)> | <the code of the current pixel (on 8 bits)>
+			const int key = (m_prefix << 8) | ch;
+			unsigned slot = ((unsigned)key * 0x9E3779B1u) >> (32 - LZW_HASH_BITS);
+			while (m_hashKey[slot] != key && m_hashKey[slot] >= 0) {
+				slot = (slot + 1) & (LZW_HASH_SIZE - 1);
+			}
+
+			if (m_hashKey[slot] == key) {
+				m_prefix = m_hashCode[slot];
 			} else {
 				m_partial |= m_prefix << m_partialSize;
 				m_partialSize += m_codeSize;
 				//grab full bytes for the output buffer
-				while (m_partialSize >= 8 && bufpos - buf < *len) {
+				while (m_partialSize >= 8 && bufpos < bufend) {
 					*bufpos++ = (uint8_t)m_partial;
 					m_partial >>= 8;
 					m_partialSize -= 8;
 				}
 
-				//add the code to the "table map"
-				m_strmap[nextprefix] = m_nextCode;
+				//add the code to the dictionary
+				m_hashKey[slot] = key;
+				m_hashCode[slot] = (uint16_t)m_nextCode;
 
 				//increment the next highest valid code, increase the code size
 				if (m_nextCode == (1 << m_codeSize)) {
@@ -319,42 +329,25 @@ bool StringTable::Compress(uint8_t *buf, int *len)
 					ClearCompressorTable();
 				}
 
-				// Only keep the 8 lowest bits (prevent problems with "negative chars")
-				m_prefix = ch & 0x000FF;
-			}
-
-			//increment to the next pixel
-			if (m_bufferShift > 0 && !(m_bufferPos + 1 == m_bufferSize && m_bufferShift <= m_slack)) {
-				m_bufferShift -= m_bpp;
-			} else {
-				m_bufferPos++;
-				m_bufferShift = 8 - m_bpp;
-			}
-
-			//jump out here if the output buffer is full
-			if (bufpos - buf == *len) {
-				return true;
+				m_prefix = ch;
 			}
-		
 		} else {
 			// Specific behavior for the first pixel of the whole image
+			firstPixelPassed = 1;
+			m_prefix = ch;
+		}
 
-			firstPixelPassed=1;
-			// Only keep the 8 lowest bits (prevent problems with "negative chars")
-			m_prefix = ch & 0x000FF;
-
-			//increment to the next pixel
-			if (m_bufferShift > 0 && !(m_bufferPos + 1 == m_bufferSize && m_bufferShift <= m_slack)) {
-				m_bufferShift -= m_bpp;
-			} else {
-				m_bufferPos++;
-				m_bufferShift = 8 - m_bpp;
-			}
+		//increment to the next pixel
+		if (m_bufferShift > 0 && !(m_bufferPos + 1 == m_bufferSize && m_bufferShift <= m_slack)) {
+			m_bufferShift -= m_bpp;
+		} else {
+			m_bufferPos++;
+			m_bufferShift = 8 - m_bpp;
+		}
 
-			//jump out here if the output buffer is full
-			if (bufpos - buf == *len) {
-				return true;
-			}
+		//jump out here if the output buffer is full
+		if (bufpos == bufend) {
+			return true;
 		}
 	}
 
@@ -371,15 +364,16 @@ bool StringTable::Decompress(uint8_t *buf, int *len)
 	}
 
 	uint8_t *bufpos = buf;
+	uint8_t *const bufend = buf + *len;
 	for ( ; m_bufferPos < m_bufferSize; m_bufferPos++ ) {
 		m_partial |= (int)m_buffer[m_bufferPos] << m_partialSize;
 		m_partialSize += 8;
 		while (m_partialSize >= m_codeSize) {
-			int code = m_partial & m_codeMask;
+			const int code = m_partial & m_codeMask;
 			m_partial >>= m_codeSize;
 			m_partialSize -= m_codeSize;
 
-			if (code > m_nextCode || /*(m_nextCode == MAX_LZW_CODE && code != m_clearCode) || */code == m_endCode) {
+			if (code > m_nextCode || code == m_endCode || (code == m_nextCode && m_oldCode == MAX_LZW_CODE)) {
 				m_done = true;
 				*len = (int)(bufpos - buf);
 				return true;
@@ -391,10 +385,14 @@ bool StringTable::Decompress(uint8_t *buf, int *len)
 
 			//add new string to string table, if not the first pass since a clear code
 			if (m_oldCode != MAX_LZW_CODE && m_nextCode < MAX_LZW_CODE) {
-				m_strings[m_nextCode] = m_strings[m_oldCode] + m_strings[code == m_nextCode ? m_oldCode : code][0];
+				m_codePrefix[m_nextCode] = (uint16_t)m_oldCode;
+				m_codeSuffix[m_nextCode] = m_codeFirst[code == m_nextCode ? m_oldCode : code];
+				m_codeFirst[m_nextCode] = m_codeFirst[m_oldCode];
+				m_codeLength[m_nextCode] = (uint16_t)(m_codeLength[m_oldCode] + 1);
 			}
 
-			if ((int)m_strings[code].size() > *len - (bufpos - buf)) {
+			const int length = m_codeLength[code];
+			if (length > bufend - bufpos) {
 				//out of space, stuff the code back in for next time
 				m_partial <<= m_codeSize;
 				m_partialSize += m_codeSize;
@@ -404,9 +402,15 @@ bool StringTable::Decompress(uint8_t *buf, int *len)
 				return true;
 			}
 
-			//output the string into the buffer
-			memcpy(bufpos, m_strings[code].data(), m_strings[code].size());
-			bufpos += m_strings[code].size();
+			//output the whole string into the buffer, walking the prefix chain from the last byte
+			uint8_t *dst = bufpos + length - 1;
+			int link = code;
+			while (link >= m_clearCode) {
+				*dst-- = m_codeSuffix[link];
+				link = m_codePrefix[link];
+			}
+			*dst = (uint8_t)link;
+			bufpos += length;
 
 			//increment the next highest valid code, add a bit to the mask if we need to increase the code size
 			if (m_oldCode != MAX_LZW_CODE && m_nextCode < MAX_LZW_CODE) {
@@ -435,9 +439,7 @@ void StringTable::Done(void)
 
 void StringTable::ClearCompressorTable(void)
 {
-	if (m_strmap) {
-		memset(m_strmap, 0xFF, sizeof(unsigned int)*(1<<20));
-	}
+	memset(m_hashKey, 0xFF, sizeof(m_hashKey));
 	m_nextCode = m_endCode + 1;
 
 	m_prefix = 0;
@@ -447,8 +449,10 @@ void StringTable::ClearCompressorTable(void)
 void StringTable::ClearDecompressorTable(void)
 {
 	for (int i = 0; i < m_clearCode; i++) {
-		m_strings[i].resize(1);
-		m_strings[i][0] = (char)i;
+		m_codePrefix[i] = 0;
+		m_codeSuffix[i] = (uint8_t)i;
+		m_codeFirst[i] = (uint8_t)i;
+		m_codeLength[i] = 1;
 	}
 	m_nextCode = m_endCode + 1;
 
@@ -768,13 +772,15 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 						continue;
 					}
 					if (info.disposal_method == GIF_DISPOSAL_BACKGROUND) {
+						// frames may extend past the logical screen : clip them
+						const int visible_width = std::min((int)info.width, (int)logicalwidth - (int)info.left);
 						for (y = 0; y < info.height; y++) {
 							const int scanidx = logicalheight - (y + info.top) - 1;
 							if (scanidx < 0) {
 								break;  // If data is corrupt, don't calculate in invalid scanline
 							}
 							scanline = (FIRGBA8 *)FreeImage_GetScanLine(dib.get(), scanidx) + info.left;
-							for (x = 0; x < info.width; x++) {
+							for (x = 0; x < visible_width; x++) {
 								*scanline++ = background;
 							}
 						}
@@ -800,6 +806,7 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 						}
 					}
 					//copy page data into logical buffer, with full alpha opaqueness
+					const int visible_width = std::min((int)info.width, (int)logicalwidth - (int)info.left);
 					for (y = 0; y < info.height; y++) {
 						const int scanidx = logicalheight - (y + info.top) - 1;
 						if (scanidx < 0) {
@@ -807,7 +814,7 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 						}
 						scanline = (FIRGBA8 *)FreeImage_GetScanLine(dib.get(), scanidx) + info.left;
 						uint8_t *pageline = FreeImage_GetScanLine(pagedib, info.height - y - 1);
-						for (x = 0; x < info.width; x++) {
+						for (x = 0; x < visible_width; x++) {
 							if (!have_transparent || *pageline != transparent_color) {
 								*scanline = pal[*pageline];
 								scanline->alpha = 255;
@@ -914,39 +921,60 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 		//Image Data Sub-blocks
 		int x = 0, xpos = 0, y = 0, shift = 8 - bpp, mask = (1 << bpp) - 1, interlacepass = 0;
 		uint8_t *scanline = FreeImage_GetScanLine(dib.get(), height - 1);
-		uint8_t buf[4096];
+
+		//moves the output to the next scanline, returns false when the whole frame is filled
+		auto nextLine = [&]() -> bool {
+			if (interlaced) {
+				y += g_GifInterlaceIncrement[interlacepass];
+				if (y >= height && ++interlacepass < GIF_INTERLACE_PASSES) {
+					y = g_GifInterlaceOffset[interlacepass];
+				}
+			} else {
+				y++;
+			}
+			if (y >= height) {
+				stringtable->Done();
+				return false;
+			}
+			x = xpos = 0;
+			shift = 8 - bpp;
+			scanline = FreeImage_GetScanLine(dib.get(), height - y - 1);
+			return true;
+		};
+
+		//decoded strings are emitted in bulk, a large buffer keeps the number of Decompress calls low
+		std::vector<uint8_t> buf(std::max<size_t>(16384, width));
 		io->read_proc(&b, 1, 1, handle);
 		while (b) {
 			io->read_proc(stringtable->FillInputBuffer(b), b, 1, handle);
-			int size = sizeof(buf);
-			while (stringtable->Decompress(buf, &size)) {
-				for ( int i = 0; i < size; i++ ) {
-					scanline[xpos] |= (buf[i] & mask) << shift;
-					if (shift > 0) {
-						shift -= bpp;
-					} else {
-						xpos++;
-						shift = 8 - bpp;
+			int size = (int)buf.size();
+			while (stringtable->Decompress(buf.data(), &size)) {
+				if (bpp == 8) {
+					//8-bit pixels map 1:1 to bytes, copy whole runs of the scanline at once
+					for (int i = 0; i < size; ) {
+						const int run = std::min(size - i, width - x);
+						memcpy(scanline + x, buf.data() + i, run);
+						i += run;
+						x += run;
+						if (x >= width && !nextLine()) {
+							break;
+						}
 					}
-					if (++x >= width) {
-						if (interlaced) {
-							y += g_GifInterlaceIncrement[interlacepass];
-							if (y >= height && ++interlacepass < GIF_INTERLACE_PASSES) {
-								y = g_GifInterlaceOffset[interlacepass];
-							}
+				} else {
+					for (int i = 0; i < size; i++) {
+						scanline[xpos] |= (buf[i] & mask) << shift;
+						if (shift > 0) {
+							shift -= bpp;
 						} else {
-							y++;
+							xpos++;
+							shift = 8 - bpp;
 						}
-						if (y >= height) {
-							stringtable->Done();
+						if (++x >= width && !nextLine()) {
 							break;
 						}
-						x = xpos = 0;
-						shift = 8 - bpp;
-						scanline = FreeImage_GetScanLine(dib.get(), height - y - 1);
 					}
 				}
-				size = sizeof(buf);
+				size = (int)buf.size();
 			}
 			io->read_proc(&b, 1, 1, handle);
 		}
@@ -31,15 +31,21 @@
 #include "Utilities.h"
 
 #include "../Metadata/FreeImageTag.h"
+#include "../FreeImage/ParallelFor.h"
+#include "FreeImageIO.h"
 
 // ----------------------------------------------------------
 
 #define PNG_BYTES_TO_CHECK 8
 
+//! maximum size of the IDAT / fdAT chunks written by the plugin (libpng writes its own IDAT chunks)
+#define PNG_MAX_IDAT_SIZE 0x100000
+
 #undef PNG_Z_DEFAULT_COMPRESSION	// already used in ../LibPNG/pnglibconf.h
 
 // ----------------------------------------------------------
 
+#include <cstddef>
 #include <functional>
 #include "zlib.h"
 #include "png.h"
@@ -57,6 +63,210 @@ typedef struct {
 
 static int s_format_id;
 
+// ==========================================================
+// APNG context
+// ==========================================================
+
+// fcTL dispose operations
+#define APNG_DISPOSE_OP_NONE		0
+#define APNG_DISPOSE_OP_BACKGROUND	1
+#define APNG_DISPOSE_OP_PREVIOUS	2
+
+// fcTL blend operations
+#define APNG_BLEND_OP_SOURCE		0
+#define APNG_BLEND_OP_OVER			1
+
+// FIMD_ANIMATION "DisposalMethod" values (same as the GIF plugin)
+#define GIF_DISPOSAL_UNSPECIFIED	0
+#define GIF_DISPOSAL_LEAVE			1
+#define GIF_DISPOSAL_BACKGROUND		2
+#define GIF_DISPOSAL_PREVIOUS		3
+
+/**
+Frame control (fcTL chunk) of an animation frame
+*/
+struct APNGFrameControl {
+	uint32_t width{}, height{};
+	uint32_t x_offset{}, y_offset{};
+	uint16_t delay_num{}, delay_den{};
+	uint8_t dispose_op{ APNG_DISPOSE_OP_NONE };
+	uint8_t blend_op{ APNG_BLEND_OP_SOURCE };
+};
+
+/**
+Animation frame found when reading a file : frame control and location of the compressed data
+*/
+struct APNGReadFrame {
+	APNGFrameControl fc;
+	//! stream offset and size of the IDAT or fdAT payloads (without the fdAT sequence number)
+	std::vector<std::pair<long, uint32_t>> segments;
+};
+
+/**
+Memory of the frame decoders of an animation. 
+libpng cannot restart a read struct on a new image, so each frame is decoded by its own png_struct, 
+built from the blocks freed by the previous frame : once the first frame is decoded, 
+decoding the next frames of the same size doesn't allocate memory.
+*/
+class APNGMemoryPool {
+	//! header of a block, keeps the block size and the alignment of the user data
+	union BlockHeader {
+		png_alloc_size_t size;
+		std::max_align_t align;
+	};
+	//! maximum number of free blocks kept
+	static const size_t max_blocks = 64;
+	//! free blocks
+	std::vector<BlockHeader*> m_blocks;
+
+public:
+	APNGMemoryPool() = default;
+	APNGMemoryPool(const APNGMemoryPool&) = delete;
+	APNGMemoryPool& operator=(const APNGMemoryPool&) = delete;
+
+	~APNGMemoryPool() {
+		for (BlockHeader *block : m_blocks) {
+			free(block);
+		}
+	}
+
+	void* Allocate(png_alloc_size_t size) {
+		for (size_t i = m_blocks.size(); i-- > 0; ) {
+			BlockHeader *block = m_blocks[i];
+			if (block->size == size) {
+				m_blocks.erase(m_blocks.begin() + i);
+				return block + 1;
+			}
+		}
+		if (size > SIZE_MAX - sizeof(BlockHeader)) {
+			return nullptr;
+		}
+		auto *block = (BlockHeader*)malloc(sizeof(BlockHeader) + size);
+		if (!block) {
+			return nullptr;
+		}
+		block->size = size;
+		return block + 1;
+	}
+
+	void Release(void *ptr) {
+		if (ptr) {
+			if (m_blocks.size() == max_blocks) {
+				free(m_blocks.front());
+				m_blocks.erase(m_blocks.begin());
+			}
+			m_blocks.push_back((BlockHeader*)ptr - 1);
+		}
+	}
+};
+
+/**
+Animation frame added when writing a file : frame control and compressed data
+*/
+struct APNGWriteFrame {
+	APNGFrameControl fc;
+	//! concatenated IDAT payloads of the encoded frame
+	std::vector<uint8_t> data;
+};
+
+/**
+Data shared between Open, PageCount, Load, Save and Close. 
+The plugin supports persistent open : a multipage bitmap keeps the context while it is open, 
+so that the chunk layout is scanned once and sequential access to the frames of an animation 
+decodes and composites each frame only once. 
+When writing, the frames of a multipage bitmap are accumulated and the APNG file is written on Close.
+*/
+struct PNGContext {
+	//! true when the context is used to read a file
+	bool read{};
+
+	// --- read mode
+
+	//! stream position of the PNG signature
+	long start{};
+	//! true when the chunk layout has been scanned
+	bool scanned{};
+	//! true when the stream is a valid APNG
+	bool animated{};
+	//! acTL number of plays (0 means infinite looping)
+	uint32_t num_plays{};
+	//! IHDR payload
+	uint8_t ihdr[13]{};
+	//! raw chunks found between IHDR and the first IDAT (PLTE, tRNS, gAMA, iCCP, ...), except the APNG chunks
+	std::vector<uint8_t> header_chunks;
+	//! frames of the animation
+	std::vector<APNGReadFrame> frames;
+	//! index of the frame composited in canvas (-1 if none)
+	int canvas_frame{ -1 };
+	//! top-down 32-bit canvas, using the FreeImage channel order
+	std::vector<uint8_t> canvas;
+	//! frame area saved before drawing a frame disposed with APNG_DISPOSE_OP_PREVIOUS
+	std::vector<uint8_t> previous;
+	//! signature, IHDR and header chunks fed to the frame decoders, the IHDR holds the size of the last decoded frame
+	std::vector<uint8_t> frame_header;
+	//! read buffer of the frame data
+	std::vector<uint8_t> frame_data;
+	//! last decoded frame, top-down 32-bit, using the FreeImage channel order
+	std::vector<uint8_t> frame_pixels;
+	//! memory of the frame decoders
+	APNGMemoryPool frame_memory;
+
+	// --- write mode
+
+	//! image type of the first frame, used for all frames
+	FREE_IMAGE_TYPE anim_type{ FIT_UNKNOWN };
+	//! canvas size (size of the first frame)
+	uint32_t anim_width{}, anim_height{};
+	//! IHDR bit depth, color type, compression, filter and interlace method of the first frame
+	uint8_t anim_format[5]{};
+	//! acTL number of plays
+	uint32_t anim_num_plays{};
+	//! chunks of the first frame written before the first IDAT (starting with IHDR)
+	std::vector<uint8_t> anim_header;
+	//! chunks of the first frame written after the last IDAT (except IEND)
+	std::vector<uint8_t> anim_trailer;
+	//! frames of the animation
+	std::vector<APNGWriteFrame> anim_frames;
+};
+
+// ==========================================================
+// Metadata helpers
+// ==========================================================
+
+static FIBOOL 
+FreeImage_SetMetadataEx(FREE_IMAGE_MDMODEL model, FIBITMAP *dib, const char *key, uint16_t id, FREE_IMAGE_MDTYPE type, uint32_t count, uint32_t length, const void *value)
+{
+	bool bSuccess{};
+	if (std::unique_ptr<FITAG, decltype(&FreeImage_DeleteTag)> tag(FreeImage_CreateTag(), &FreeImage_DeleteTag); tag) {
+		bSuccess = FreeImage_SetTagKey(tag.get(), key);
+		bSuccess = bSuccess && FreeImage_SetTagID(tag.get(), id);
+		bSuccess = bSuccess && FreeImage_SetTagType(tag.get(), type);
+		bSuccess = bSuccess && FreeImage_SetTagCount(tag.get(), count);
+		bSuccess = bSuccess && FreeImage_SetTagLength(tag.get(), length);
+		bSuccess = bSuccess && FreeImage_SetTagValue(tag.get(), value);
+		if (model == FIMD_ANIMATION) {
+			const TagLib& s = TagLib::instance();
+			// get the tag description
+			const char *description = s.getTagDescription(TagLib::ANIMATION, id);
+			bSuccess = bSuccess && FreeImage_SetTagDescription(tag.get(), description);
+		}
+		// store the tag
+		bSuccess = bSuccess && FreeImage_SetMetadata(model, dib, key, tag.get());
+	}
+	return bSuccess ? TRUE : FALSE;
+}
+
+static FIBOOL 
+FreeImage_GetMetadataEx(FREE_IMAGE_MDMODEL model, FIBITMAP *dib, const char *key, FREE_IMAGE_MDTYPE type, FITAG **tag)
+{
+	if (FreeImage_GetMetadata(model, dib, key, tag)) {
+		if (FreeImage_GetTagType(*tag) == type) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 // ==========================================================
 // libpng interface
 // ==========================================================
@@ -70,6 +280,18 @@ _ReadProc(png_structp png_ptr, unsigned char *data, png_size_t size) {
 	}
 }
 
+static png_voidp
+_PoolMalloc(png_structp png_ptr, png_alloc_size_t size) {
+	auto *pool = (APNGMemoryPool*)png_get_mem_ptr(png_ptr);
+	return pool->Allocate(size);
+}
+
+static void
+_PoolFree(png_structp png_ptr, png_voidp ptr) {
+	auto *pool = (APNGMemoryPool*)png_get_mem_ptr(png_ptr);
+	pool->Release(ptr);
+}
+
 static void
 _WriteProc(png_structp png_ptr, unsigned char *data, png_size_t size) {
     pfi_ioStructure pfio = (pfi_ioStructure)png_get_io_ptr(png_ptr);
@@ -82,6 +304,11 @@ _FlushProc(png_structp png_ptr) {
 	// empty flush implementation
 }
 
+static void
+_DiscardProc(png_structp /*png_ptr*/, unsigned char* /*data*/, png_size_t /*size*/) {
+	// the data is dropped, see SkipImageData
+}
+
 static void
 error_handler(png_structp png_ptr, const char *error) {
 	FreeImage_OutputMessageProc(s_format_id, error);
@@ -306,6 +533,206 @@ SupportsNoPixels() {
 
 // --------------------------------------------------------------------------
 
+static void * DLL_CALLCONV
+Open(FreeImageIO *io, fi_handle handle, FIBOOL read) {
+	auto *ctx = new(std::nothrow) PNGContext;
+	if (ctx) {
+		ctx->read = read ? true : false;
+		if (read && handle) {
+			// the chunk layout is scanned on demand : loading the default image doesn't need it
+			ctx->start = io->tell_proc(handle);
+		}
+	}
+	return ctx;
+}
+
+static FIBOOL
+WriteAnimation(FreeImageIO *io, fi_handle handle, PNGContext *ctx);
+
+static void DLL_CALLCONV
+Close(FreeImageIO *io, fi_handle handle, void *data) {
+	auto *ctx = (PNGContext*)data;
+	if (ctx) {
+		if (!ctx->read && !ctx->anim_frames.empty()) {
+			// frames were added through the multipage API : write the animation
+			WriteAnimation(io, handle, ctx);
+		}
+		delete ctx;
+	}
+}
+
+/**
+Scan the chunk layout of a PNG stream, without reading the image data. 
+If the stream is an APNG, store the frame controls and the location of the frame data.
+@param io FreeImage IO
+@param handle Input stream
+@param ctx Plugin context
+*/
+static void
+ScanChunks(FreeImageIO *io, fi_handle handle, PNGContext *ctx) {
+	ctx->scanned = true;
+	ctx->animated = false;
+	ctx->header_chunks.clear();
+	ctx->frames.clear();
+	ctx->canvas_frame = -1;
+	ctx->frame_header.clear();
+
+	uint32_t num_frames = 0;
+	bool has_actl = false;
+	bool has_ihdr = false;
+	bool idat_found = false;
+	bool valid = true;
+
+	uint8_t chunk_header[8];
+	uint8_t payload[26];
+
+	io->seek_proc(handle, ctx->start, SEEK_SET);
+	if ((io->read_proc(chunk_header, 1, PNG_BYTES_TO_CHECK, handle) != PNG_BYTES_TO_CHECK) || (png_sig_cmp(chunk_header, 0, PNG_BYTES_TO_CHECK) != 0)) {
+		return;
+	}
+
+	while (io->read_proc(chunk_header, 1, 8, handle) == 8) {
+		const uint32_t length = png_get_uint_32(chunk_header);
+		if (length > PNG_UINT_31_MAX) {
+			break;
+		}
+		const long data_offset = io->tell_proc(handle);
+		const uint8_t *type = chunk_header + 4;
+
+		if (memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+		if (memcmp(type, "IHDR", 4) == 0) {
+			if ((length != 13) || (io->read_proc(ctx->ihdr, 1, 13, handle) != 13)) {
+				break;
+			}
+			has_ihdr = true;
+		}
+		else if (memcmp(type, "acTL", 4) == 0) {
+			if (!idat_found && (length == 8) && (io->read_proc(payload, 1, 8, handle) == 8)) {
+				num_frames = png_get_uint_32(payload);
+				ctx->num_plays = png_get_uint_32(payload + 4);
+				has_actl = true;
+			}
+		}
+		else if (memcmp(type, "fcTL", 4) == 0) {
+			if ((length != 26) || (io->read_proc(payload, 1, 26, handle) != 26)) {
+				valid = false;
+				break;
+			}
+			APNGReadFrame frame;
+			frame.fc.width = png_get_uint_32(payload + 4);
+			frame.fc.height = png_get_uint_32(payload + 8);
+			frame.fc.x_offset = png_get_uint_32(payload + 12);
+			frame.fc.y_offset = png_get_uint_32(payload + 16);
+			frame.fc.delay_num = png_get_uint_16(payload + 20);
+			frame.fc.delay_den = png_get_uint_16(payload + 22);
+			frame.fc.dispose_op = payload[24];
+			frame.fc.blend_op = payload[25];
+
+			// the frame must lie inside the canvas
+			const uint64_t canvas_width = png_get_uint_32(ctx->ihdr);
+			const uint64_t canvas_height = png_get_uint_32(ctx->ihdr + 4);
+			if (!has_ihdr || !frame.fc.width || !frame.fc.height || 
+				((uint64_t)frame.fc.x_offset + frame.fc.width > canvas_width) || ((uint64_t)frame.fc.y_offset + frame.fc.height > canvas_height) ||
+				(frame.fc.dispose_op > APNG_DISPOSE_OP_PREVIOUS) || (frame.fc.blend_op > APNG_BLEND_OP_OVER)) {
+				valid = false;
+				break;
+			}
+			if (!idat_found && ((frame.fc.width != canvas_width) || (frame.fc.height != canvas_height) || frame.fc.x_offset || frame.fc.y_offset)) {
+				// the default image is the first frame : it must fill the canvas
+				valid = false;
+				break;
+			}
+			ctx->frames.push_back(std::move(frame));
+		}
+		else if (memcmp(type, "IDAT", 4) == 0) {
+			if (!idat_found && (ctx->frames.size() > 1)) {
+				valid = false;
+				break;
+			}
+			idat_found = true;
+			if (ctx->frames.size() == 1) {
+				// the default image is the first frame of the animation
+				ctx->frames[0].segments.emplace_back(data_offset, length);
+			}
+		}
+		else if (memcmp(type, "fdAT", 4) == 0) {
+			if (idat_found && (length > 4) && !ctx->frames.empty()) {
+				ctx->frames.back().segments.emplace_back(data_offset + 4, length - 4);
+			}
+		}
+		else if (has_ihdr && !idat_found) {
+			// keep the other header chunks (PLTE, tRNS, gAMA, iCCP, ...), they are shared by all frames
+			const size_t pos = ctx->header_chunks.size();
+			ctx->header_chunks.resize(pos + 8 + length + 4);
+			memcpy(&ctx->header_chunks[pos], chunk_header, 8);
+			if (io->read_proc(&ctx->header_chunks[pos + 8], 1, length + 4, handle) != length + 4) {
+				ctx->header_chunks.resize(pos);
+				break;
+			}
+		}
+
+		// skip the chunk data and the CRC
+		io->seek_proc(handle, data_offset + (long)length + 4, SEEK_SET);
+	}
+
+	// frames without data (e.g. truncated file) are ignored
+	while (!ctx->frames.empty() && ctx->frames.back().segments.empty()) {
+		ctx->frames.pop_back();
+	}
+	if (ctx->frames.size() > num_frames) {
+		ctx->frames.resize(num_frames);
+	}
+
+	ctx->animated = has_actl && valid && idat_found && !ctx->frames.empty();
+
+	if (ctx->animated) {
+		// a first frame disposed with APNG_DISPOSE_OP_PREVIOUS is treated as APNG_DISPOSE_OP_BACKGROUND
+		if (ctx->frames[0].fc.dispose_op == APNG_DISPOSE_OP_PREVIOUS) {
+			ctx->frames[0].fc.dispose_op = APNG_DISPOSE_OP_BACKGROUND;
+		}
+	} else {
+		ctx->header_chunks.clear();
+		ctx->frames.clear();
+	}
+}
+
+static int DLL_CALLCONV
+PageCount(FreeImageIO *io, fi_handle handle, void *data) {
+	auto *ctx = (PNGContext*)data;
+	if (!ctx || !ctx->read || !handle) {
+		return 1;
+	}
+	if (!ctx->scanned) {
+		ScanChunks(io, handle, ctx);
+	}
+	return ctx->animated ? (int)ctx->frames.size() : 1;
+}
+
+// --------------------------------------------------------------------------
+
+/**
+Set the gamma correction of the decoder. 
+Unlike the example in the libpng documentation, we have *no* idea where
+this file may have come from--so if it doesn't have a file gamma, don't
+do any correction ("do no harm")
+@param png_ptr PNG handle
+@param info_ptr PNG info handle
+@param flags Decoder flags
+*/
+static void
+ConfigureGamma(png_structp png_ptr, png_infop info_ptr, int flags) {
+	if (png_get_valid(png_ptr, info_ptr, PNG_INFO_gAMA)) {
+		double gamma = 0;
+		double screen_gamma = 2.2;
+
+		if (png_get_gAMA(png_ptr, info_ptr, &gamma) && ( flags & PNG_IGNOREGAMMA ) != PNG_IGNOREGAMMA) {
+			png_set_gamma(png_ptr, screen_gamma, gamma);
+		}
+	}
+}
+
 /**
 Configure the decoder so that decoded pixels are compatible with a FREE_IMAGE_TYPE format. 
 Set conversion instructions as needed. 
@@ -320,14 +747,28 @@ static FIBOOL
 ConfigureDecoder(png_structp png_ptr, png_infop info_ptr, int flags, FREE_IMAGE_TYPE *output_image_type) {
 	// get original image info
 	const int color_type = png_get_color_type(png_ptr, info_ptr);
-	const int bit_depth = png_get_bit_depth(png_ptr, info_ptr);
-	const int pixel_depth = bit_depth * png_get_channels(png_ptr, info_ptr);
+	int bit_depth = png_get_bit_depth(png_ptr, info_ptr);
+	int pixel_depth = bit_depth * png_get_channels(png_ptr, info_ptr);
 
 	FREE_IMAGE_TYPE image_type = FIT_BITMAP;	// assume standard image type
 
 	// check for transparency table or single transparent color
 	FIBOOL bIsTransparent = png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS) == PNG_INFO_tRNS ? TRUE : FALSE;
 
+	if (((flags & PNG_LOAD_8BIT) == PNG_LOAD_8BIT) && (bit_depth == 16)) {
+		// scale 16-bit samples down to 8-bit (with rounding), then handle the image as a 8-bit one
+		png_set_scale_16(png_ptr);
+		bit_depth = 8;
+		pixel_depth /= 2;
+
+		// a 16-bit transparent shade cannot be stored in a 8-bit transparency table
+		// expand it to a full alpha channel instead
+		if (bIsTransparent && (color_type == PNG_COLOR_TYPE_GRAY)) {
+			png_set_tRNS_to_alpha(png_ptr);
+			png_set_gray_to_rgb(png_ptr);
+		}
+	}
+
 	// check allowed combinations of colour type and bit depth
 	// then get converted FreeImage type
 
@@ -457,6 +898,16 @@ ConfigureDecoder(png_structp png_ptr, png_infop info_ptr, int flags, FREE_IMAGE_
 		return FALSE;
 	}
 
+	if ((flags & PNG_LOAD_RGBA) == PNG_LOAD_RGBA) {
+		// expand palette and low bit depth greyscale to 8-bit, tRNS to alpha and greyscale to RGB, 
+		// then add an opaque alpha channel to images without one
+		png_set_expand(png_ptr);
+		png_set_gray_to_rgb(png_ptr);
+		png_set_add_alpha(png_ptr, 0xFFFF, PNG_FILLER_AFTER);
+
+		image_type = (bit_depth == 16) ? FIT_RGBA16 : FIT_BITMAP;
+	}
+
 #ifndef FREEIMAGE_BIGENDIAN
 	if ((image_type == FIT_UINT16) || (image_type == FIT_RGB16) || (image_type == FIT_RGBA16)) {
 		// turn on 16-bit byte swapping
@@ -465,25 +916,15 @@ ConfigureDecoder(png_structp png_ptr, png_infop info_ptr, int flags, FREE_IMAGE_
 #endif						
 
 #if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
-	if ((image_type == FIT_BITMAP) && ((color_type == PNG_COLOR_TYPE_RGB) || (color_type == PNG_COLOR_TYPE_RGB_ALPHA))) {
+	if ((image_type == FIT_BITMAP) && ((color_type == PNG_COLOR_TYPE_RGB) || (color_type == PNG_COLOR_TYPE_RGB_ALPHA) || ((flags & PNG_LOAD_RGBA) == PNG_LOAD_RGBA))) {
 		// flip the RGB pixels to BGR (or RGBA to BGRA)
 		png_set_bgr(png_ptr);
 	}
 #endif
 
 	// gamma correction
-	// unlike the example in the libpng documentation, we have *no* idea where
-	// this file may have come from--so if it doesn't have a file gamma, don't
-	// do any correction ("do no harm")
-
-	if (png_get_valid(png_ptr, info_ptr, PNG_INFO_gAMA)) {
-		double gamma = 0;
-		double screen_gamma = 2.2;
 
-		if (png_get_gAMA(png_ptr, info_ptr, &gamma) && ( flags & PNG_IGNOREGAMMA ) != PNG_IGNOREGAMMA) {
-			png_set_gamma(png_ptr, screen_gamma, gamma);
-		}
-	}
+	ConfigureGamma(png_ptr, info_ptr, flags);
 
 	// all transformations have been registered; now update info_ptr data		
 	png_read_update_info(png_ptr, info_ptr);
@@ -494,105 +935,565 @@ ConfigureDecoder(png_structp png_ptr, png_infop info_ptr, int flags, FREE_IMAGE_
 	return TRUE;
 }
 
-static FIBITMAP * DLL_CALLCONV
-Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
-	png_uint_32 width, height;
-	int color_type;
-	int bit_depth;
-	int pixel_depth = 0;	// pixel_depth = bit_depth * channels
+// --------------------------------------------------------------------------
 
-    fi_ioStructure fio;
-    fio.s_handle = handle;
-	fio.s_io = io;
-    
-	if (handle) {
-		FIBOOL header_only = (flags & FIF_LOAD_NOPIXELS) == FIF_LOAD_NOPIXELS;
+/**
+Append a chunk to a memory stream
+@param stream Output stream
+@param type Chunk type
+@param data Chunk data
+@param length Chunk data length
+*/
+static void
+AppendChunk(std::vector<uint8_t>& stream, const char *type, const uint8_t *data, uint32_t length) {
+	uint8_t buffer[8];
+	png_save_uint_32(buffer, length);
+	memcpy(buffer + 4, type, 4);
+	stream.insert(stream.end(), buffer, buffer + 8);
+	// note : crc32 with a null buffer returns the initial value, not the crc
+	uLong crc = crc32(0, (const Bytef*)type, 4);
+	if (length) {
+		stream.insert(stream.end(), data, data + length);
+		crc = crc32(crc, (const Bytef*)data, length);
+	}
+	png_save_uint_32(buffer, (png_uint_32)crc);
+	stream.insert(stream.end(), buffer, buffer + 4);
+}
 
-		try {		
-			// check to see if the file is in fact a PNG file
+/**
+Progressive decoding state of an animation frame
+*/
+struct APNGFrameDecoder {
+	//! top-down output buffer, width x height x 4 bytes
+	uint8_t *pixels;
+	uint32_t width, height;
+	//! decoder flags
+	int flags;
+	//! true when the end of the frame has been reached
+	bool done;
+};
 
-			uint8_t png_check[PNG_BYTES_TO_CHECK];
+static void
+_FrameInfoCallback(png_structp png_ptr, png_infop info_ptr) {
+	const auto *decoder = (APNGFrameDecoder*)png_get_progressive_ptr(png_ptr);
 
-			io->read_proc(png_check, PNG_BYTES_TO_CHECK, 1, handle);
+	// expand any color type and bit depth to 8-bit RGBA
 
-			if (png_sig_cmp(png_check, (png_size_t)0, PNG_BYTES_TO_CHECK) != 0) {
-				return nullptr;	// Bad signature
-			}
-			
-			// create the chunk manage structure
+	png_set_expand(png_ptr);
+	png_set_strip_16(png_ptr);
+	png_set_gray_to_rgb(png_ptr);
+	png_set_add_alpha(png_ptr, 0xFF, PNG_FILLER_AFTER);
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+	png_set_bgr(png_ptr);
+#endif
+	ConfigureGamma(png_ptr, info_ptr, decoder->flags);
+	png_set_interlace_handling(png_ptr);
 
-			std::unique_ptr<png_struct, std::function<void(png_structp)>> png_ptr(png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, error_handler, warning_handler), [](png_structp v){ png_destroy_read_struct(&v, nullptr, nullptr); });
+	png_read_update_info(png_ptr, info_ptr);
 
-			if (!png_ptr) {
-				return nullptr;
-			}
+	if ((png_get_image_width(png_ptr, info_ptr) != decoder->width) || (png_get_image_height(png_ptr, info_ptr) != decoder->height) || (png_get_rowbytes(png_ptr, info_ptr) != (png_size_t)decoder->width * 4)) {
+		png_error(png_ptr, "Invalid APNG frame");
+	}
+}
 
-			// create the info structure
+static void
+_FrameRowCallback(png_structp png_ptr, png_bytep new_row, png_uint_32 row_num, int /*pass*/) {
+	const auto *decoder = (APNGFrameDecoder*)png_get_progressive_ptr(png_ptr);
+	// the rows of the later passes of an interlaced frame are combined with the previous ones
+	png_progressive_combine_row(png_ptr, decoder->pixels + (size_t)row_num * decoder->width * 4, new_row);
+}
 
-			std::unique_ptr<png_info, std::function<void(png_infop)>> info_ptr(png_create_info_struct(png_ptr.get()), [&png_ptr](png_infop v){ png_destroy_info_struct(png_ptr.get(), &v); });
+static void
+_FrameEndCallback(png_structp png_ptr, png_infop /*info_ptr*/) {
+	auto *decoder = (APNGFrameDecoder*)png_get_progressive_ptr(png_ptr);
+	decoder->done = true;
+}
 
-			if (!info_ptr) {
-				return nullptr;
-			}
+/**
+Decode a frame of an animation to 32-bit pixels, using the FreeImage channel order. 
+The frame is decoded progressively : the decoder is fed with the header chunks kept in the context, 
+then with the frame data read from the stream as IDAT chunks.
+@param io FreeImage IO
+@param handle Input stream
+@param ctx Plugin context, the frame is decoded into ctx->frame_pixels
+@param frame Animation frame
+@param flags Decoder flags
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+static FIBOOL
+DecodeFrame(FreeImageIO *io, fi_handle handle, PNGContext *ctx, const APNGReadFrame& frame, int flags) {
+	static const uint8_t png_signature[PNG_BYTES_TO_CHECK] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	static const uint8_t png_iend[12] = { 0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82 };
+	//! size of the reads of frame data
+	static const uint32_t read_size = 0x10000;
+
+	if (ctx->frame_header.empty()) {
+		ctx->frame_header.assign(png_signature, png_signature + PNG_BYTES_TO_CHECK);
+		AppendChunk(ctx->frame_header, "IHDR", ctx->ihdr, 13);
+		ctx->frame_header.insert(ctx->frame_header.end(), ctx->header_chunks.begin(), ctx->header_chunks.end());
+	}
 
-			// init the IO
+	// IHDR with the frame size : chunk type at offset 12, data at offset 16, CRC at offset 29
+	uint8_t *ihdr = &ctx->frame_header[PNG_BYTES_TO_CHECK + 4];
+	png_save_uint_32(ihdr + 4, frame.fc.width);
+	png_save_uint_32(ihdr + 8, frame.fc.height);
+	png_save_uint_32(ihdr + 17, (png_uint_32)crc32(0, ihdr, 17));
 
-			png_set_read_fn(png_ptr.get(), &fio, _ReadProc);
-			
-			// PNG errors will be redirected here
+	ctx->frame_pixels.resize((size_t)frame.fc.width * frame.fc.height * 4);
+	APNGFrameDecoder decoder = { ctx->frame_pixels.data(), frame.fc.width, frame.fc.height, flags, false };
 
-			if (setjmp(png_jmpbuf(png_ptr.get()))) {
-				// assume error_handler was called before by the PNG library
-				throw((const char*)nullptr);
-			}
+	std::unique_ptr<png_struct, std::function<void(png_structp)>> png_ptr(png_create_read_struct_2(PNG_LIBPNG_VER_STRING, nullptr, error_handler, warning_handler, &ctx->frame_memory, _PoolMalloc, _PoolFree), [](png_structp v){ png_destroy_read_struct(&v, nullptr, nullptr); });
+	if (!png_ptr) {
+		return FALSE;
+	}
+	std::unique_ptr<png_info, std::function<void(png_infop)>> info_ptr(png_create_info_struct(png_ptr.get()), [&png_ptr](png_infop v){ png_destroy_info_struct(png_ptr.get(), &v); });
+	if (!info_ptr) {
+		return FALSE;
+	}
 
-			// because we have already read the signature...
+	// PNG errors will be redirected here
 
-			png_set_sig_bytes(png_ptr.get(), PNG_BYTES_TO_CHECK);
+	if (setjmp(png_jmpbuf(png_ptr.get()))) {
+		// assume error_handler was called before by the PNG library
+		return FALSE;
+	}
 
-			// read the IHDR chunk
+	png_set_benign_errors(png_ptr.get(), 1);
+	png_set_progressive_read_fn(png_ptr.get(), &decoder, _FrameInfoCallback, _FrameRowCallback, _FrameEndCallback);
 
-			png_read_info(png_ptr.get(), info_ptr.get());
-			png_get_IHDR(png_ptr.get(), info_ptr.get(), &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
+	png_process_data(png_ptr.get(), info_ptr.get(), ctx->frame_header.data(), ctx->frame_header.size());
 
-			// configure the decoder
+	// each IDAT or fdAT payload becomes an IDAT chunk
 
-			FREE_IMAGE_TYPE image_type = FIT_BITMAP;
+	ctx->frame_data.resize(read_size);
+	for (const auto& segment : frame.segments) {
+		uint8_t chunk[8];
+		png_save_uint_32(chunk, segment.second);
+		memcpy(chunk + 4, "IDAT", 4);
+		png_process_data(png_ptr.get(), info_ptr.get(), chunk, 8);
 
-			if (!ConfigureDecoder(png_ptr.get(), info_ptr.get(), flags, &image_type)) {
-				throw FI_MSG_ERROR_UNSUPPORTED_FORMAT;
+		uLong crc = crc32(0, chunk + 4, 4);
+		io->seek_proc(handle, segment.first, SEEK_SET);
+		for (uint32_t remaining = segment.second; remaining > 0; ) {
+			const uint32_t size = std::min(remaining, read_size);
+			if (io->read_proc(ctx->frame_data.data(), 1, size, handle) != size) {
+				png_error(png_ptr.get(), "Read error: invalid or corrupted APNG frame");
 			}
+			crc = crc32(crc, ctx->frame_data.data(), size);
+			png_process_data(png_ptr.get(), info_ptr.get(), ctx->frame_data.data(), size);
+			remaining -= size;
+		}
+		png_save_uint_32(chunk, (png_uint_32)crc);
+		png_process_data(png_ptr.get(), info_ptr.get(), chunk, 4);
+	}
 
-			// update image info
+	png_process_data(png_ptr.get(), info_ptr.get(), (png_bytep)png_iend, sizeof(png_iend));
 
-			color_type = png_get_color_type(png_ptr.get(), info_ptr.get());
-			bit_depth = png_get_bit_depth(png_ptr.get(), info_ptr.get());
-			pixel_depth = bit_depth * png_get_channels(png_ptr.get(), info_ptr.get());
+	return decoder.done ? TRUE : FALSE;
+}
 
-			// create a dib and write the bitmap header
-			// set up the dib palette, if needed
-			std::unique_ptr<FIBITMAP, decltype(&FreeImage_Unload)> dib(nullptr, &FreeImage_Unload);
-			switch (color_type) {
-				case PNG_COLOR_TYPE_RGB:
-				case PNG_COLOR_TYPE_RGB_ALPHA:
-					dib.reset(FreeImage_AllocateHeaderT(header_only, image_type, width, height, pixel_depth, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK));
-					break;
+/**
+Draw a decoded frame on the canvas, using the blend operation of the frame
+@param ctx Plugin context
+@param fc Frame control
+@param pixels Decoded frame
+*/
+static void
+BlendFrame(PNGContext *ctx, const APNGFrameControl& fc, const uint8_t *pixels) {
+	const size_t canvas_pitch = (size_t)png_get_uint_32(ctx->ihdr) * 4;
 
-				case PNG_COLOR_TYPE_PALETTE:
-					dib.reset(FreeImage_AllocateHeaderT(header_only, image_type, width, height, pixel_depth, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK));
-					if (dib) {
-						png_colorp png_palette{};
-						int palette_entries = 0;
+	for (uint32_t y = 0; y < fc.height; y++) {
+		uint8_t *dst = &ctx->canvas[(fc.y_offset + y) * canvas_pitch + (size_t)fc.x_offset * 4];
+		const uint8_t *src = pixels + (size_t)y * fc.width * 4;
 
-						png_get_PLTE(png_ptr.get(),info_ptr.get(), &png_palette, &palette_entries);
+		if (fc.blend_op == APNG_BLEND_OP_SOURCE) {
+			memcpy(dst, src, (size_t)fc.width * 4);
+			continue;
+		}
 
-						palette_entries = std::min((unsigned)palette_entries, FreeImage_GetColorsUsed(dib.get()));
+		// APNG_BLEND_OP_OVER : alpha compositing of non-premultiplied pixels
+		for (uint32_t x = 0; x < fc.width; x++, src += 4, dst += 4) {
+			const unsigned src_alpha = src[FI_RGBA_ALPHA];
+			if (src_alpha == 0xFF) {
+				memcpy(dst, src, 4);
+			} else if (src_alpha != 0) {
+				const unsigned dst_alpha = (dst[FI_RGBA_ALPHA] * (0xFF - src_alpha) + 127) / 0xFF;
+				const unsigned alpha = src_alpha + dst_alpha;
+				for (int c = 0; c < 4; c++) {
+					if (c != FI_RGBA_ALPHA) {
+						dst[c] = (uint8_t)((src[c] * src_alpha + dst[c] * dst_alpha + alpha / 2) / alpha);
+					}
+				}
+				dst[FI_RGBA_ALPHA] = (uint8_t)alpha;
+			}
+		}
+	}
+}
 
-						// store the palette
+/**
+Copy a frame area between the canvas and a buffer
+@param ctx Plugin context
+@param fc Frame control giving the area
+@param save If true, copy the canvas area to ctx->previous, otherwise restore the canvas area from ctx->previous
+*/
+static void
+CopyFrameArea(PNGContext *ctx, const APNGFrameControl& fc, bool save) {
+	const size_t canvas_pitch = (size_t)png_get_uint_32(ctx->ihdr) * 4;
+	const size_t line = (size_t)fc.width * 4;
 
-						FIRGBA8 *palette = FreeImage_GetPalette(dib.get());
-						for (int i = 0; i < palette_entries; i++) {
-							palette[i].red   = png_palette[i].red;
+	if (save) {
+		ctx->previous.resize(line * fc.height);
+	}
+	for (uint32_t y = 0; y < fc.height; y++) {
+		uint8_t *area = &ctx->canvas[(fc.y_offset + y) * canvas_pitch + (size_t)fc.x_offset * 4];
+		uint8_t *saved = &ctx->previous[y * line];
+		if (save) {
+			memcpy(saved, area, line);
+		} else {
+			memcpy(area, saved, line);
+		}
+	}
+}
+
+/**
+Composite the frames of an animation on the canvas, up to a given frame. 
+The canvas is kept in the context : going forward only decodes the new frames, 
+going backward restarts from the first frame.
+@param io FreeImage IO
+@param handle Input stream
+@param ctx Plugin context
+@param page Frame index
+@param flags Decoder flags
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+static FIBOOL
+ComposeFrame(FreeImageIO *io, fi_handle handle, PNGContext *ctx, int page, int flags) {
+	const size_t canvas_width = png_get_uint_32(ctx->ihdr);
+	const size_t canvas_height = png_get_uint_32(ctx->ihdr + 4);
+
+	if (page < ctx->canvas_frame) {
+		// rewind
+		ctx->canvas_frame = -1;
+	}
+	if (ctx->canvas_frame < 0) {
+		// the canvas starts fully transparent
+		ctx->canvas.assign(canvas_width * canvas_height * 4, 0);
+	}
+
+	while (ctx->canvas_frame < page) {
+		if (ctx->canvas_frame >= 0) {
+			// dispose the last drawn frame
+			const APNGFrameControl& last = ctx->frames[ctx->canvas_frame].fc;
+			if (last.dispose_op == APNG_DISPOSE_OP_BACKGROUND) {
+				for (uint32_t y = 0; y < last.height; y++) {
+					memset(&ctx->canvas[((last.y_offset + y) * canvas_width + last.x_offset) * 4], 0, (size_t)last.width * 4);
+				}
+			} else if (last.dispose_op == APNG_DISPOSE_OP_PREVIOUS) {
+				CopyFrameArea(ctx, last, false);
+			}
+		}
+
+		const APNGReadFrame& frame = ctx->frames[ctx->canvas_frame + 1];
+		if (frame.fc.dispose_op == APNG_DISPOSE_OP_PREVIOUS) {
+			CopyFrameArea(ctx, frame.fc, true);
+		}
+
+		if (!DecodeFrame(io, handle, ctx, frame, flags)) {
+			// the canvas is no longer valid
+			ctx->canvas_frame = -1;
+			return FALSE;
+		}
+		BlendFrame(ctx, frame.fc, ctx->frame_pixels.data());
+
+		ctx->canvas_frame++;
+	}
+
+	return TRUE;
+}
+
+// --------------------------------------------------------------------------
+// Row streaming
+// --------------------------------------------------------------------------
+
+/**
+Consumer of decoded PNG rows. 
+Rows are delivered top-down, in the pixel layout of the FreeImage output type.
+*/
+struct PNGRowConsumer {
+	virtual ~PNGRowConsumer() = default;
+	/** Returns false to stop decoding */
+	virtual bool PutRow(unsigned y, const uint8_t *row) = 0;
+};
+
+/**
+Store the rows into the scanlines of a bitmap
+*/
+struct PNGBitmapConsumer : public PNGRowConsumer {
+	FIBITMAP *dib;
+
+	explicit PNGBitmapConsumer(FIBITMAP *dib) : dib(dib) { }
+
+	bool PutRow(unsigned y, const uint8_t *row) override {
+		memcpy(FreeImage_GetScanLine(dib, FreeImage_GetHeight(dib) - 1 - y), row, FreeImage_GetLine(dib));
+		return true;
+	}
+};
+
+/**
+Forward the rows to a user callback, along with a header only bitmap describing them
+*/
+struct PNGCallbackConsumer : public PNGRowConsumer {
+	FIBITMAP *dib;
+	FI_ScanlineProc scanline_proc;
+	void *user_data;
+
+	PNGCallbackConsumer(FIBITMAP *dib, FI_ScanlineProc scanline_proc, void *user_data) : dib(dib), scanline_proc(scanline_proc), user_data(user_data) { }
+
+	bool PutRow(unsigned y, const uint8_t *row) override {
+		return scanline_proc(dib, y, row, user_data) != FALSE;
+	}
+};
+
+/**
+Box filter downscaler : each output pixel is the average of a factor x factor block of input pixels 
+(smaller blocks on the right and bottom edges). 
+Only one output row of accumulators is kept in memory.
+*/
+struct PNGBoxConsumer : public PNGRowConsumer {
+	PNGRowConsumer& next;
+	const unsigned factor;
+	const unsigned src_width, src_height;
+	const unsigned dst_width;
+	const unsigned samples;		// samples per pixel
+	const bool wide;			// 16-bit samples
+	std::vector<uint64_t> sums;
+	std::vector<uint8_t> line;
+	unsigned box_rows{ 0 };
+	unsigned dst_y{ 0 };
+
+	PNGBoxConsumer(PNGRowConsumer& next, unsigned factor, unsigned src_width, unsigned src_height, unsigned samples, bool wide)
+		: next(next), factor(factor), src_width(src_width), src_height(src_height), dst_width((src_width + factor - 1) / factor), samples(samples), wide(wide),
+		sums((size_t)dst_width * samples, 0), line((size_t)dst_width * samples * (wide ? 2 : 1)) { }
+
+	bool PutRow(unsigned y, const uint8_t *row) override {
+		uint64_t *sum = sums.data();
+		for (unsigned x = 0, count = 0; x < src_width; x++) {
+			for (unsigned c = 0; c < samples; c++) {
+				sum[c] += wide ? ((const uint16_t*)row)[c] : row[c];
+			}
+			row += wide ? 2 * samples : samples;
+			if (++count == factor) {
+				sum += samples;
+				count = 0;
+			}
+		}
+		if ((++box_rows < factor) && (y + 1 < src_height)) {
+			return true;
+		}
+
+		// output the averaged row
+		for (unsigned x = 0; x < dst_width; x++) {
+			const uint64_t area = (uint64_t)std::min(factor, src_width - x * factor) * box_rows;
+			for (unsigned c = 0; c < samples; c++) {
+				const size_t i = (size_t)x * samples + c;
+				const uint64_t value = (sums[i] + area / 2) / area;
+				if (wide) {
+					((uint16_t*)line.data())[i] = (uint16_t)value;
+				} else {
+					line[i] = (uint8_t)value;
+				}
+			}
+		}
+		std::fill(sums.begin(), sums.end(), 0);
+		box_rows = 0;
+
+		return next.PutRow(dst_y++, line.data());
+	}
+};
+
+/**
+Decode the image data of a PNG stream and feed the rows to a consumer
+@param png_ptr PNG handle, configured and updated
+@param info_ptr PNG info handle
+@param consumer Row consumer
+@return Returns true if all rows were consumed, false if the consumer stopped decoding
+*/
+static bool
+ReadRows(png_structp png_ptr, png_infop info_ptr, PNGRowConsumer& consumer) {
+	const png_uint_32 height = png_get_image_height(png_ptr, info_ptr);
+	const size_t row_bytes = png_get_rowbytes(png_ptr, info_ptr);
+
+	if (png_get_interlace_type(png_ptr, info_ptr) == PNG_INTERLACE_NONE) {
+		// a single row in memory
+		std::vector<uint8_t> row(row_bytes);
+		for (png_uint_32 y = 0; y < height; y++) {
+			png_read_row(png_ptr, row.data(), nullptr);
+			if (!consumer.PutRow(y, row.data())) {
+				return false;
+			}
+		}
+	} else {
+		// Adam7 passes scatter the pixels over the whole image : decode it all first
+		std::vector<uint8_t> pixels(row_bytes * height);
+		std::vector<png_bytep> row_pointers(height);
+		for (png_uint_32 y = 0; y < height; y++) {
+			row_pointers[y] = &pixels[y * row_bytes];
+		}
+		png_read_image(png_ptr, row_pointers.data());
+		for (png_uint_32 y = 0; y < height; y++) {
+			if (!consumer.PutRow(y, row_pointers[y])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+Keep original size info when using the scale option on loading
+*/
+static void 
+StoreSizeInfo(FIBITMAP *dib, png_uint_32 width, png_uint_32 height) {
+	char buffer[16];
+	uint32_t length = 0;	// include the NULL/0 value
+	length = (uint32_t)snprintf(buffer, std::size(buffer), "%u", (unsigned)width) + 1;
+	FreeImage_SetMetadataEx(FIMD_COMMENTS, dib, "OriginalPNGWidth", 0, FIDT_ASCII, length, length, buffer);
+	length = (uint32_t)snprintf(buffer, std::size(buffer), "%u", (unsigned)height) + 1;
+	FreeImage_SetMetadataEx(FIMD_COMMENTS, dib, "OriginalPNGHeight", 0, FIDT_ASCII, length, length, buffer);
+}
+
+// --------------------------------------------------------------------------
+
+/**
+Load the default image of a PNG file (for an APNG file, the image displayed by decoders without animation support). 
+When a scanline callback is given, the rows are streamed to the callback instead of being stored 
+and the returned bitmap is header only.
+@param io FreeImage IO
+@param handle Input stream
+@param flags Decoder flags. The upper 16 bits may hold a requested size : the image is then 
+box filtered down by the largest integer factor that keeps its largest side >= the requested size
+@param scanline_proc Optional row callback
+@param user_data Callback parameter
+@return Returns a dib if successful, returns NULL on error or if the callback stopped decoding
+*/
+static FIBITMAP *
+LoadDefaultImage(FreeImageIO *io, fi_handle handle, int flags, FI_ScanlineProc scanline_proc = nullptr, void *user_data = nullptr) {
+	png_uint_32 width, height;
+	int color_type;
+	int bit_depth;
+	int pixel_depth = 0;	// pixel_depth = bit_depth * channels
+
+    fi_ioStructure fio;
+    fio.s_handle = handle;
+	fio.s_io = io;
+    
+	if (handle) {
+		FIBOOL header_only = (flags & FIF_LOAD_NOPIXELS) == FIF_LOAD_NOPIXELS;
+
+		try {		
+			// check to see if the file is in fact a PNG file
+
+			uint8_t png_check[PNG_BYTES_TO_CHECK];
+
+			io->read_proc(png_check, PNG_BYTES_TO_CHECK, 1, handle);
+
+			if (png_sig_cmp(png_check, (png_size_t)0, PNG_BYTES_TO_CHECK) != 0) {
+				return nullptr;	// Bad signature
+			}
+			
+			// create the chunk manage structure
+
+			std::unique_ptr<png_struct, std::function<void(png_structp)>> png_ptr(png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, error_handler, warning_handler), [](png_structp v){ png_destroy_read_struct(&v, nullptr, nullptr); });
+
+			if (!png_ptr) {
+				return nullptr;
+			}
+
+			// create the info structure
+
+			std::unique_ptr<png_info, std::function<void(png_infop)>> info_ptr(png_create_info_struct(png_ptr.get()), [&png_ptr](png_infop v){ png_destroy_info_struct(png_ptr.get(), &v); });
+
+			if (!info_ptr) {
+				return nullptr;
+			}
+
+			// init the IO
+
+			png_set_read_fn(png_ptr.get(), &fio, _ReadProc);
+			
+			// PNG errors will be redirected here
+
+			if (setjmp(png_jmpbuf(png_ptr.get()))) {
+				// assume error_handler was called before by the PNG library
+				throw((const char*)nullptr);
+			}
+
+			// because we have already read the signature...
+
+			png_set_sig_bytes(png_ptr.get(), PNG_BYTES_TO_CHECK);
+
+			// read the IHDR chunk
+
+			png_read_info(png_ptr.get(), info_ptr.get());
+			png_get_IHDR(png_ptr.get(), info_ptr.get(), &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
+
+			// downscale while decoding if a size was requested
+
+			const unsigned requested_size = (unsigned)flags >> 16;
+			const unsigned scale = (requested_size > 0) ? std::max(1U, (unsigned)(std::max(width, height) / requested_size)) : 1;
+
+			if (scale > 1) {
+				// palette indices, low bit depth greyscale and transparent shades cannot be averaged
+				if ((color_type == PNG_COLOR_TYPE_PALETTE) || ((color_type == PNG_COLOR_TYPE_GRAY) && ((bit_depth < 8) || png_get_valid(png_ptr.get(), info_ptr.get(), PNG_INFO_tRNS)))) {
+					flags |= PNG_LOAD_RGBA;
+				}
+			}
+
+			const png_uint_32 dst_width = (width + scale - 1) / scale;
+			const png_uint_32 dst_height = (height + scale - 1) / scale;
+
+			// when streaming, pixels are not stored
+
+			const FIBOOL no_pixels = header_only || (scanline_proc != nullptr);
+
+			// configure the decoder
+
+			FREE_IMAGE_TYPE image_type = FIT_BITMAP;
+
+			if (!ConfigureDecoder(png_ptr.get(), info_ptr.get(), flags, &image_type)) {
+				throw FI_MSG_ERROR_UNSUPPORTED_FORMAT;
+			}
+
+			// update image info
+
+			color_type = png_get_color_type(png_ptr.get(), info_ptr.get());
+			bit_depth = png_get_bit_depth(png_ptr.get(), info_ptr.get());
+			pixel_depth = bit_depth * png_get_channels(png_ptr.get(), info_ptr.get());
+
+			// create a dib and write the bitmap header
+			// set up the dib palette, if needed
+			std::unique_ptr<FIBITMAP, decltype(&FreeImage_Unload)> dib(nullptr, &FreeImage_Unload);
+			switch (color_type) {
+				case PNG_COLOR_TYPE_RGB:
+				case PNG_COLOR_TYPE_RGB_ALPHA:
+					dib.reset(FreeImage_AllocateHeaderT(no_pixels, image_type, dst_width, dst_height, pixel_depth, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK));
+					break;
+
+				case PNG_COLOR_TYPE_PALETTE:
+					dib.reset(FreeImage_AllocateHeaderT(no_pixels, image_type, dst_width, dst_height, pixel_depth, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK));
+					if (dib) {
+						png_colorp png_palette{};
+						int palette_entries = 0;
+
+						png_get_PLTE(png_ptr.get(),info_ptr.get(), &png_palette, &palette_entries);
+
+						palette_entries = std::min((unsigned)palette_entries, FreeImage_GetColorsUsed(dib.get()));
+
+						// store the palette
+
+						FIRGBA8 *palette = FreeImage_GetPalette(dib.get());
+						for (int i = 0; i < palette_entries; i++) {
+							palette[i].red   = png_palette[i].red;
 							palette[i].green = png_palette[i].green;
 							palette[i].blue  = png_palette[i].blue;
 						}
@@ -600,7 +1501,7 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 					break;
 
 				case PNG_COLOR_TYPE_GRAY:
-					dib.reset(FreeImage_AllocateHeaderT(header_only, image_type, width, height, pixel_depth, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK));
+					dib.reset(FreeImage_AllocateHeaderT(no_pixels, image_type, dst_width, dst_height, pixel_depth, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK));
 
 					if (dib && (pixel_depth <= 8)) {
 						FIRGBA8 *palette = FreeImage_GetPalette(dib.get());
@@ -706,6 +1607,17 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 				FreeImage_CreateICCProfile(dib.get(), profile_data, profile_length);
 			}
 
+			if (scale > 1) {
+				// store original size info if a scaling was requested
+				StoreSizeInfo(dib.get(), width, height);
+			}
+
+			// check if the bitmap contains transparency, if so enable it in the header
+
+			if (FreeImage_GetBPP(dib.get()) == 32) {
+				FreeImage_SetTransparent(dib.get(), FIC_RGBALPHA == FreeImage_GetColorType(dib.get()));
+			}
+
 			// --- header only mode => clean-up and return
 
 			if (header_only) {
@@ -714,34 +1626,43 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 				return dib.release();
 			}
 
-			// set the individual row_pointers to point at the correct offsets
-
-			std::unique_ptr<void, decltype(&free)> safeRowPointers(malloc(height * sizeof(png_bytep)), &free);
-			if (!safeRowPointers) {
-				return nullptr;
-			}
-			auto **row_pointers = static_cast<png_bytepp>(safeRowPointers.get());
-
-			// read in the bitmap bits via the pointer table
 			// allow loading of PNG with minor errors (such as images with several IDAT chunks)
 
-			for (png_uint_32 k = 0; k < height; k++) {
-				row_pointers[height - 1 - k] = FreeImage_GetScanLine(dib.get(), k);
-			}
-
 			png_set_benign_errors(png_ptr.get(), 1);
-			png_read_image(png_ptr.get(), row_pointers);
 
-			// check if the bitmap contains transparency, if so enable it in the header
+			if ((scale == 1) && !scanline_proc) {
+				// decode straight into the bitmap
 
-			if (FreeImage_GetBPP(dib.get()) == 32) {
-				FreeImage_SetTransparent(dib.get(), FIC_RGBALPHA == FreeImage_GetColorType(dib.get()));
-			}
+				if (png_get_interlace_type(png_ptr.get(), info_ptr.get()) == PNG_INTERLACE_NONE) {
+					for (png_uint_32 y = 0; y < height; y++) {
+						png_read_row(png_ptr.get(), FreeImage_GetScanLine(dib.get(), height - 1 - y), nullptr);
+					}
+				} else {
+					// set the individual row_pointers to point at the correct offsets
+					std::vector<png_bytep> row_pointers(height);
+					for (png_uint_32 k = 0; k < height; k++) {
+						row_pointers[height - 1 - k] = FreeImage_GetScanLine(dib.get(), k);
+					}
+					png_read_image(png_ptr.get(), row_pointers.data());
+				}
+			} else {
+				// decode row by row through the consumer chain
+
+				PNGBitmapConsumer store(dib.get());
+				PNGCallbackConsumer callback(dib.get(), scanline_proc, user_data);
+				PNGRowConsumer *consumer = scanline_proc ? static_cast<PNGRowConsumer*>(&callback) : &store;
 
-			// cleanup
+				std::unique_ptr<PNGBoxConsumer> box;
+				if (scale > 1) {
+					box = std::make_unique<PNGBoxConsumer>(*consumer, scale, width, height, png_get_channels(png_ptr.get(), info_ptr.get()), bit_depth == 16);
+					consumer = box.get();
+				}
 
-			safeRowPointers.reset();
-			row_pointers = nullptr;
+				if (!ReadRows(png_ptr.get(), info_ptr.get(), *consumer)) {
+					// stopped by the consumer
+					return nullptr;
+				}
+			}
 
 			// read the rest of the file, getting any additional chunks in info_ptr
 
@@ -765,10 +1686,486 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 	return nullptr;
 }
 
-// --------------------------------------------------------------------------
+/**
+Load a frame of an APNG file, composited on the animation canvas
+@param io FreeImage IO
+@param handle Input stream
+@param ctx Plugin context
+@param page Frame index
+@param flags Decoder flags
+@return Returns a 32-bit dib if successful, returns NULL otherwise
+*/
+static FIBITMAP *
+LoadAnimationFrame(FreeImageIO *io, fi_handle handle, PNGContext *ctx, int page, int flags) {
+	const FIBOOL header_only = (flags & FIF_LOAD_NOPIXELS) == FIF_LOAD_NOPIXELS;
+
+	try {
+		if ((page < 0) || (page >= (int)ctx->frames.size())) {
+			throw "Invalid frame index";
+		}
+
+		const uint32_t width = png_get_uint_32(ctx->ihdr);
+		const uint32_t height = png_get_uint_32(ctx->ihdr + 4);
+
+		std::unique_ptr<FIBITMAP, decltype(&FreeImage_Unload)> dib(FreeImage_AllocateHeader(header_only, width, height, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK), &FreeImage_Unload);
+		if (!dib) {
+			throw FI_MSG_ERROR_DIB_MEMORY;
+		}
+
+		if (!header_only) {
+			if (!ComposeFrame(io, handle, ctx, page, flags)) {
+				// assume error_handler was called before by the PNG library
+				throw (const char*)nullptr;
+			}
+
+			// the canvas is top-down
+			const size_t line = (size_t)width * 4;
+			for (uint32_t y = 0; y < height; y++) {
+				memcpy(FreeImage_GetScanLine(dib.get(), height - 1 - y), &ctx->canvas[y * line], line);
+			}
+		}
+
+		// animation metadata
+
+		const APNGFrameControl& fc = ctx->frames[page].fc;
+		// a zero denominator means 1/100 second
+		const unsigned delay_den = fc.delay_den ? fc.delay_den : 100;
+		auto frame_time = (int32_t)((fc.delay_num * 1000 + delay_den / 2) / delay_den);
+		FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "FrameTime", ANIMTAG_FRAMETIME, FIDT_LONG, 1, 4, &frame_time);
+
+		if (page == 0) {
+			auto logical_width = (uint16_t)width;
+			auto logical_height = (uint16_t)height;
+			FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "LogicalWidth", ANIMTAG_LOGICALWIDTH, FIDT_SHORT, 1, 2, &logical_width);
+			FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "LogicalHeight", ANIMTAG_LOGICALHEIGHT, FIDT_SHORT, 1, 2, &logical_height);
+
+			// APNG and FreeImage use the same convention : 0 means infinite looping
+			auto loop = (int32_t)ctx->num_plays;
+			FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "Loop", ANIMTAG_LOOP, FIDT_LONG, 1, 4, &loop);
+		}
+
+		return dib.release();
+
+	} catch (const std::bad_alloc&) {
+		ctx->canvas_frame = -1;
+		FreeImage_OutputMessageProc(s_format_id, FI_MSG_ERROR_MEMORY);
+	} catch (const char *text) {
+		if (text) {
+			FreeImage_OutputMessageProc(s_format_id, text);
+		}
+	}
+
+	return nullptr;
+}
+
+static FIBITMAP * DLL_CALLCONV
+Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
+	auto *ctx = (PNGContext*)data;
+
+	if (handle && ctx && ctx->read) {
+		if (page >= 0) {
+			if (!ctx->scanned) {
+				ScanChunks(io, handle, ctx);
+			}
+			if (ctx->animated) {
+				return LoadAnimationFrame(io, handle, ctx, page, flags);
+			}
+		}
+		// the default image is read from the start of the stream
+		io->seek_proc(handle, ctx->start, SEEK_SET);
+	}
+
+	return LoadDefaultImage(io, handle, flags);
+}
 
 static FIBOOL DLL_CALLCONV
-Save(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int page, int flags, void *data) {
+LoadScanlines(FreeImageIO *io, fi_handle handle, int flags, FI_ScanlineProc scanline_proc, void *user_data) {
+	// the default image is streamed, the returned bitmap only holds its header and metadata
+	std::unique_ptr<FIBITMAP, decltype(&FreeImage_Unload)> dib(LoadDefaultImage(io, handle, flags & ~FIF_LOAD_NOPIXELS, scanline_proc, user_data), &FreeImage_Unload);
+	return dib ? TRUE : FALSE;
+}
+
+// --------------------------------------------------------------------------
+
+// ==========================================================
+// Parallel encoder
+// ==========================================================
+
+/**
+Description of the rows as written in the PNG stream
+*/
+struct PNGRowFormat {
+	//! number of bytes of a row, without the filter type byte
+	size_t row_bytes{};
+	//! distance between corresponding bytes of adjacent pixels (at least 1)
+	unsigned pixel_bytes{};
+	//! number of channels written for each pixel (24/32-bit and 16-bit images)
+	unsigned channels{};
+	//! 1-, 4- and 8-bit images are written as is (except for inverted monochrome images)
+	bool packed{};
+	bool invert_mono{};
+	//! set of PNG_FILTER_* filters to choose from
+	int filter_mask{};
+	int zlib_level{};
+	int zlib_strategy{};
+};
+
+/**
+Convert a FreeImage scanline to the layout of a PNG row, i.e. what libpng would write 
+after the bgr, swap, invert_mono and 32- to 24-bit transformations
+@param dib Input image
+@param png_y Row index, top-down
+@param fmt Row format
+@param dst Output row, fmt.row_bytes long
+*/
+static void
+ConvertRowToPNG(FIBITMAP *dib, unsigned png_y, const PNGRowFormat& fmt, uint8_t *dst) {
+	const unsigned width = FreeImage_GetWidth(dib);
+	const uint8_t *src = FreeImage_GetScanLine(dib, FreeImage_GetHeight(dib) - 1 - png_y);
+
+	if (fmt.packed) {
+		if (fmt.invert_mono) {
+			for (size_t i = 0; i < fmt.row_bytes; i++) {
+				dst[i] = (uint8_t)~src[i];
+			}
+		} else {
+			memcpy(dst, src, fmt.row_bytes);
+		}
+	} else if (FreeImage_GetImageType(dib) == FIT_BITMAP) {
+		// 24- or 32-bit pixels, written as RGB or RGBA
+		const unsigned src_bytes = FreeImage_GetBPP(dib) / 8;
+		for (unsigned x = 0; x < width; x++) {
+			dst[0] = src[FI_RGBA_RED];
+			dst[1] = src[FI_RGBA_GREEN];
+			dst[2] = src[FI_RGBA_BLUE];
+			if (fmt.channels == 4) {
+				dst[3] = src[FI_RGBA_ALPHA];
+			}
+			src += src_bytes;
+			dst += fmt.channels;
+		}
+	} else {
+		// 16-bit samples are stored in network byte order
+		const auto *src16 = (const uint16_t*)src;
+		for (size_t i = 0; i < fmt.row_bytes / 2; i++) {
+			dst[2 * i] = (uint8_t)(src16[i] >> 8);
+			dst[2 * i + 1] = (uint8_t)(src16[i] & 0xFF);
+		}
+	}
+}
+
+static inline uint8_t
+PaethPredictor(int a, int b, int c) {
+	const int p = a + b - c;
+	const int pa = abs(p - a);
+	const int pb = abs(p - b);
+	const int pc = abs(p - c);
+	if ((pa <= pb) && (pa <= pc)) {
+		return (uint8_t)a;
+	}
+	return (uint8_t)((pb <= pc) ? b : c);
+}
+
+/**
+Apply a PNG filter to a row
+@param type Filter type (PNG_FILTER_VALUE_*)
+@param row Current row
+@param prev Previous row (all zeros for the first row)
+@param fmt Row format
+@param dst Filtered row, starting with the filter type byte
+*/
+static void
+FilterRow(int type, const uint8_t *row, const uint8_t *prev, const PNGRowFormat& fmt, uint8_t *dst) {
+	const size_t n = fmt.row_bytes;
+	const unsigned bpp = fmt.pixel_bytes;
+
+	*dst++ = (uint8_t)type;
+
+	switch (type) {
+		case PNG_FILTER_VALUE_NONE:
+			memcpy(dst, row, n);
+			break;
+		case PNG_FILTER_VALUE_SUB:
+			memcpy(dst, row, bpp);
+			for (size_t i = bpp; i < n; i++) {
+				dst[i] = (uint8_t)(row[i] - row[i - bpp]);
+			}
+			break;
+		case PNG_FILTER_VALUE_UP:
+			for (size_t i = 0; i < n; i++) {
+				dst[i] = (uint8_t)(row[i] - prev[i]);
+			}
+			break;
+		case PNG_FILTER_VALUE_AVG:
+			for (size_t i = 0; i < bpp; i++) {
+				dst[i] = (uint8_t)(row[i] - (prev[i] >> 1));
+			}
+			for (size_t i = bpp; i < n; i++) {
+				dst[i] = (uint8_t)(row[i] - ((row[i - bpp] + prev[i]) >> 1));
+			}
+			break;
+		case PNG_FILTER_VALUE_PAETH:
+			for (size_t i = 0; i < bpp; i++) {
+				dst[i] = (uint8_t)(row[i] - prev[i]);
+			}
+			for (size_t i = bpp; i < n; i++) {
+				dst[i] = (uint8_t)(row[i] - PaethPredictor(row[i - bpp], prev[i], prev[i - bpp]));
+			}
+			break;
+	}
+}
+
+/**
+Filter a row using the filter set of the row format. 
+When several filters are allowed, the filter giving the minimum sum of absolute differences is used 
+(same heuristic as libpng).
+@param row Current row
+@param prev Previous row (all zeros for the first row)
+@param fmt Row format
+@param candidates Work buffers, one for each filter type, fmt.row_bytes + 1 long
+@return Returns the filtered row, starting with the filter type byte (one of the candidates)
+*/
+static const uint8_t*
+FilterRowAdaptive(const uint8_t *row, const uint8_t *prev, const PNGRowFormat& fmt, std::vector<uint8_t> (&candidates)[PNG_FILTER_VALUE_LAST]) {
+	static const int filters[PNG_FILTER_VALUE_LAST] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG, PNG_FILTER_PAETH };
+
+	int best_type = -1;
+	uint64_t best_sum = 0;
+	for (int type = PNG_FILTER_VALUE_NONE; type < PNG_FILTER_VALUE_LAST; type++) {
+		if (!(fmt.filter_mask & filters[type])) {
+			continue;
+		}
+		uint8_t *filtered = candidates[type].data();
+		FilterRow(type, row, prev, fmt, filtered);
+		if (fmt.filter_mask == filters[type]) {
+			// single filter
+			return filtered;
+		}
+		uint64_t sum = 0;
+		for (size_t i = 1; i <= fmt.row_bytes; i++) {
+			sum += (filtered[i] < 128) ? filtered[i] : 256 - filtered[i];
+		}
+		if ((best_type < 0) || (sum < best_sum)) {
+			best_type = type;
+			best_sum = sum;
+		}
+	}
+	if (best_type < 0) {
+		best_type = PNG_FILTER_VALUE_NONE;
+		FilterRow(best_type, row, prev, fmt, candidates[best_type].data());
+	}
+
+	return candidates[best_type].data();
+}
+
+/**
+Group of rows compressed by a worker thread
+*/
+struct PNGDeflateBand {
+	unsigned first_row{};
+	unsigned end_row{};
+	//! raw deflate data, ending on a byte boundary
+	std::vector<uint8_t> data;
+	//! adler32 checksum and size of the filtered rows
+	uLong adler{};
+	size_t length{};
+	bool success{};
+};
+
+/**
+Filter and compress a group of rows. 
+Every group except the last one ends with a sync flush, so that the groups can be concatenated 
+into a single deflate stream. The window is primed with the end of the previous group, 
+which keeps the compression ratio close to the single-threaded one.
+@param dib Input image
+@param fmt Row format
+@param band Group of rows to compress
+@param last_band TRUE for the last group of the image
+*/
+static void
+DeflateBand(FIBITMAP *dib, const PNGRowFormat& fmt, PNGDeflateBand& band, bool last_band) {
+	const size_t filtered_bytes = fmt.row_bytes + 1;
+	const size_t window_size = (size_t)1 << MAX_WBITS;
+
+	try {
+		std::vector<uint8_t> prev(fmt.row_bytes, 0), row(fmt.row_bytes);
+		std::vector<uint8_t> candidates[PNG_FILTER_VALUE_LAST];
+		for (auto& candidate : candidates) {
+			candidate.resize(filtered_bytes);
+		}
+
+		z_stream zs{};
+		if (deflateInit2(&zs, fmt.zlib_level, Z_DEFLATED, -MAX_WBITS, 8, fmt.zlib_strategy) != Z_OK) {
+			return;
+		}
+		std::unique_ptr<z_stream, decltype(&deflateEnd)> safe_stream(&zs, &deflateEnd);
+
+		// rebuild the end of the previous group, used as the preset dictionary
+
+		const unsigned dictionary_rows = (unsigned)std::min<size_t>(band.first_row, (window_size + filtered_bytes - 1) / filtered_bytes);
+		unsigned y = band.first_row - dictionary_rows;
+		if (y > 0) {
+			ConvertRowToPNG(dib, y - 1, fmt, prev.data());
+		}
+		if (dictionary_rows > 0) {
+			std::vector<uint8_t> dictionary;
+			dictionary.reserve(dictionary_rows * filtered_bytes);
+			for (; y < band.first_row; y++) {
+				ConvertRowToPNG(dib, y, fmt, row.data());
+				const uint8_t *filtered = FilterRowAdaptive(row.data(), prev.data(), fmt, candidates);
+				dictionary.insert(dictionary.end(), filtered, filtered + filtered_bytes);
+				std::swap(row, prev);
+			}
+			const size_t dictionary_size = std::min(dictionary.size(), window_size);
+			deflateSetDictionary(&zs, dictionary.data() + dictionary.size() - dictionary_size, (uInt)dictionary_size);
+		}
+
+		// compress the rows
+
+		uint8_t buffer[16384];
+		band.adler = adler32(0, nullptr, 0);
+		band.length = 0;
+
+		for (y = band.first_row; y < band.end_row; y++) {
+			ConvertRowToPNG(dib, y, fmt, row.data());
+			const uint8_t *filtered = FilterRowAdaptive(row.data(), prev.data(), fmt, candidates);
+			std::swap(row, prev);
+
+			band.adler = adler32(band.adler, filtered, (uInt)filtered_bytes);
+			band.length += filtered_bytes;
+
+			const int flush = (y + 1 < band.end_row) ? Z_NO_FLUSH : (last_band ? Z_FINISH : Z_SYNC_FLUSH);
+			zs.next_in = (Bytef*)filtered;
+			zs.avail_in = (uInt)filtered_bytes;
+			do {
+				zs.next_out = buffer;
+				zs.avail_out = sizeof(buffer);
+				const int ret = deflate(&zs, flush);
+				if ((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR)) {
+					return;
+				}
+				band.data.insert(band.data.end(), buffer, buffer + (sizeof(buffer) - zs.avail_out));
+			} while (zs.avail_out == 0);
+		}
+
+		band.success = true;
+
+	} catch (const std::bad_alloc&) {
+		band.success = false;
+	}
+}
+
+/**
+Write the image data as IDAT chunks, compressing groups of rows on several threads. 
+Must be called after png_write_info, the caller then calls SkipImageData and png_write_end.
+@param png_ptr PNG write structure
+@param dib Input image
+@param fmt Row format
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+static FIBOOL
+WriteImageDataParallel(png_structp png_ptr, FIBITMAP *dib, const PNGRowFormat& fmt) {
+	const unsigned height = FreeImage_GetHeight(dib);
+
+	// groups of about 256 KB of filtered data, at least 16 rows
+	const unsigned band_rows = (unsigned)std::max<size_t>(16, (256 * 1024) / (fmt.row_bytes + 1));
+	const unsigned band_count = (height + band_rows - 1) / band_rows;
+
+	std::vector<PNGDeflateBand> bands(band_count);
+	for (unsigned i = 0; i < band_count; i++) {
+		bands[i].first_row = i * band_rows;
+		bands[i].end_row = std::min(height, (i + 1) * band_rows);
+	}
+
+	// compress the groups, one group per parallel row
+
+	ParallelForRows(band_count, (size_t)band_rows * (fmt.row_bytes + 1), [&](unsigned first_band, unsigned end_band) {
+		for (unsigned i = first_band; i < end_band; i++) {
+			DeflateBand(dib, fmt, bands[i], i + 1 == band_count);
+		}
+	});
+
+	// zlib stream : header, deflate data of every group, adler32 checksum of the whole data
+
+	uLong adler = adler32(0, nullptr, 0);
+	for (const auto& band : bands) {
+		if (!band.success) {
+			return FALSE;
+		}
+		adler = adler32_combine(adler, band.adler, (z_off_t)band.length);
+	}
+
+	// same FLEVEL values as zlib
+	int level_flags = 3;
+	if ((fmt.zlib_level < 2) || (fmt.zlib_strategy >= Z_HUFFMAN_ONLY)) {
+		level_flags = 0;
+	} else if (fmt.zlib_level < 6) {
+		level_flags = 1;
+	} else if (fmt.zlib_level == 6) {
+		level_flags = 2;
+	}
+	uint8_t header[2] = { 0x78, (uint8_t)(level_flags << 6) };
+	header[1] += (uint8_t)((31 - ((header[0] << 8) | header[1]) % 31) % 31);
+	uint8_t trailer[4];
+	png_save_uint_32(trailer, (png_uint_32)adler);
+
+	// IDAT chunks of at most 1 MB
+
+	std::vector<uint8_t> chunk;
+	chunk.reserve(PNG_MAX_IDAT_SIZE);
+	chunk.insert(chunk.end(), header, header + 2);
+
+	for (const auto& band : bands) {
+		for (size_t pos = 0; pos < band.data.size(); ) {
+			const size_t length = std::min(band.data.size() - pos, PNG_MAX_IDAT_SIZE - chunk.size());
+			chunk.insert(chunk.end(), band.data.begin() + pos, band.data.begin() + pos + length);
+			pos += length;
+			if (chunk.size() == PNG_MAX_IDAT_SIZE) {
+				png_write_chunk(png_ptr, (png_const_bytep)"IDAT", chunk.data(), chunk.size());
+				chunk.clear();
+			}
+		}
+	}
+	chunk.insert(chunk.end(), trailer, trailer + 4);
+	png_write_chunk(png_ptr, (png_const_bytep)"IDAT", chunk.data(), chunk.size());
+
+	return TRUE;
+}
+
+/**
+Bring libpng to the end of the image data written by WriteImageDataParallel, so that png_write_end 
+can write the chunks following IDAT and IEND. libpng only reaches that state once it compressed every row 
+itself : blank rows are passed as stored deflate blocks, without filtering, to a write function dropping the data.
+@param png_ptr PNG write structure
+@param fmt Row format
+@param height Image height
+*/
+static void
+SkipImageData(png_structp png_ptr, const PNGRowFormat& fmt, unsigned height) {
+	png_voidp io_ptr = png_get_io_ptr(png_ptr);
+	png_set_write_fn(png_ptr, io_ptr, _DiscardProc, _FlushProc);
+	png_set_filter(png_ptr, 0, PNG_FILTER_NONE);
+	png_set_compression_level(png_ptr, Z_NO_COMPRESSION);
+
+	std::vector<uint8_t> row(fmt.row_bytes);
+	for (unsigned k = 0; k < height; k++) {
+		png_write_row(png_ptr, row.data());
+	}
+
+	png_set_write_fn(png_ptr, io_ptr, _WriteProc, _FlushProc);
+}
+
+/**
+Save a FIBITMAP as a PNG image
+@param io FreeImage IO
+@param dib The FIBITMAP to save
+@param handle Output stream
+@param flags FreeImage save flags
+@param color_type Color type of the saved image (usually FreeImage_GetColorType(dib))
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+static FIBOOL
+SaveImage(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int flags, FREE_IMAGE_COLOR_TYPE color_type) {
 	png_uint_32 width, height;
 	FIBOOL has_alpha_channel = FALSE;
 
@@ -842,22 +2239,6 @@ Save(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int page, int flags, void
 				interlace_type = PNG_INTERLACE_NONE;
 			}
 
-			// set the ZLIB compression level or default to PNG default compression level (ZLIB level = 6)
-			int zlib_level = flags & 0x0F;
-			if ((zlib_level >= 1) && (zlib_level <= 9)) {
-				png_set_compression_level(png_ptr.get(), zlib_level);
-			} else if ((flags & PNG_Z_NO_COMPRESSION) == PNG_Z_NO_COMPRESSION) {
-				png_set_compression_level(png_ptr.get(), Z_NO_COMPRESSION);
-			}
-
-			// filtered strategy works better for high color images
-			if (pixel_depth >= 16){
-				png_set_compression_strategy(png_ptr.get(), Z_FILTERED);
-				png_set_filter(png_ptr.get(), 0, PNG_FILTER_NONE|PNG_FILTER_SUB|PNG_FILTER_PAETH);
-			} else {
-				png_set_compression_strategy(png_ptr.get(), Z_DEFAULT_STRATEGY);
-			}
-
 			FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(dib);
 			if (image_type == FIT_BITMAP) {
 				// standard image type
@@ -871,7 +2252,48 @@ Save(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int page, int flags, void
 			FIBOOL bIsTransparent = 
 				(image_type == FIT_BITMAP) && FreeImage_IsTransparent(dib) && (FreeImage_GetTransparencyCount(dib) > 0) ? TRUE : FALSE;
 
-			switch (FreeImage_GetColorType(dib)) {
+			// set the ZLIB compression level or default to PNG default compression level (ZLIB level = 6)
+			PNGRowFormat row_format;
+			int zlib_level = flags & 0x0F;
+			if ((zlib_level < 1) || (zlib_level > 9)) {
+				if ((flags & PNG_Z_NO_COMPRESSION) == PNG_Z_NO_COMPRESSION) {
+					zlib_level = Z_NO_COMPRESSION;
+				} else if ((flags & PNG_ENCODE_FAST) == PNG_ENCODE_FAST) {
+					zlib_level = Z_BEST_SPEED;
+				} else if ((flags & PNG_ENCODE_SMALL) == PNG_ENCODE_SMALL) {
+					zlib_level = Z_BEST_COMPRESSION;
+				} else {
+					zlib_level = 6;
+				}
+			}
+			png_set_compression_level(png_ptr.get(), zlib_level);
+			row_format.zlib_level = zlib_level;
+
+			// choose the row filters (images written with a palette and low bit depth images are not filtered).
+			// Transparent greyscale images are written with a palette, other transparent images keep their color type
+			const bool png_palette = (color_type == FIC_PALETTE) || (bIsTransparent && ((color_type == FIC_MINISBLACK) || (color_type == FIC_MINISWHITE)));
+			const bool can_filter = (pixel_depth >= 8) && !png_palette;
+			if ((flags & PNG_ENCODE_FAST) == PNG_ENCODE_FAST) {
+				// a single cheap filter and run-length matches only
+				row_format.filter_mask = can_filter ? PNG_FILTER_SUB : PNG_FILTER_NONE;
+				row_format.zlib_strategy = Z_RLE;
+			} else if ((flags & PNG_ENCODE_SMALL) == PNG_ENCODE_SMALL) {
+				// the best filter for each row
+				row_format.filter_mask = can_filter ? PNG_ALL_FILTERS : PNG_FILTER_NONE;
+				row_format.zlib_strategy = Z_DEFAULT_STRATEGY;
+			} else if (pixel_depth >= 16) {
+				// filtered strategy works better for high color images
+				row_format.filter_mask = PNG_FILTER_NONE | PNG_FILTER_SUB | PNG_FILTER_PAETH;
+				row_format.zlib_strategy = Z_FILTERED;
+			} else {
+				// libpng default filters
+				row_format.filter_mask = can_filter ? PNG_ALL_FILTERS : PNG_FILTER_NONE;
+				row_format.zlib_strategy = Z_DEFAULT_STRATEGY;
+			}
+			png_set_compression_strategy(png_ptr.get(), row_format.zlib_strategy);
+			png_set_filter(png_ptr.get(), 0, row_format.filter_mask);
+
+			switch (color_type) {
 				case FIC_MINISWHITE:
 					if (!bIsTransparent) {
 						// Invert monochrome files to have 0 as black and 1 as white (no break here)
@@ -1006,6 +2428,24 @@ Save(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int page, int flags, void
 				number_passes = png_set_interlace_handling(png_ptr.get());
 			}
 
+			if (((flags & PNG_ENCODE_PARALLEL) == PNG_ENCODE_PARALLEL) && !bInterlaced && (zlib_level != Z_NO_COMPRESSION)) {
+				// the plugin filters the rows and writes the IDAT chunks itself
+				const unsigned channels = png_get_channels(png_ptr.get(), info_ptr.get());
+				row_format.row_bytes = png_get_rowbytes(png_ptr.get(), info_ptr.get());
+				row_format.pixel_bytes = std::max(1U, channels * bit_depth / 8);
+				row_format.channels = channels;
+				row_format.packed = (image_type == FIT_BITMAP) && (pixel_depth <= 8);
+				row_format.invert_mono = (color_type == FIC_MINISWHITE) && !bIsTransparent;
+
+				if (!WriteImageDataParallel(png_ptr.get(), dib, row_format)) {
+					throw FI_MSG_ERROR_MEMORY;
+				}
+				SkipImageData(png_ptr.get(), row_format, height);
+				png_write_end(png_ptr.get(), info_ptr.get());
+
+				return TRUE;
+			}
+
 			if ((pixel_depth == 32) && (!has_alpha_channel)) {
 				auto buffer = std::make_unique<uint8_t[]>(width * 3);
 
@@ -1041,6 +2481,288 @@ Save(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int page, int flags, void
 	return FALSE;
 }
 
+/**
+Encode a FIBITMAP as the next frame of an animation. 
+The first frame defines the canvas size, the pixel format and the loop count of the animation, 
+the next frames are converted to the image type of the first frame. 
+Frames of type FIT_BITMAP are stored as 32-bit RGBA, so that frames using different palettes can be mixed. 
+Frame position, duration and disposal are read from the FIMD_ANIMATION metadata (FrameLeft, FrameTop, FrameTime, DisposalMethod), 
+the frames smaller than the canvas are alpha blended over the previous frame.
+@param ctx Plugin context
+@param src The FIBITMAP to encode
+@param flags FreeImage save flags
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+static FIBOOL
+AddAnimationFrame(PNGContext *ctx, FIBITMAP *src, int flags) {
+	try {
+		const bool first_frame = ctx->anim_frames.empty();
+		FIBITMAP *dib = src;
+
+		// convert the frame to the pixel format of the animation
+
+		const FREE_IMAGE_TYPE image_type = first_frame ? FreeImage_GetImageType(dib) : ctx->anim_type;
+		std::unique_ptr<FIBITMAP, decltype(&FreeImage_Unload)> converted(nullptr, &FreeImage_Unload);
+		FREE_IMAGE_COLOR_TYPE color_type = FIC_RGBALPHA;
+
+		switch (image_type) {
+			case FIT_BITMAP:
+				if ((FreeImage_GetImageType(dib) != FIT_BITMAP) || (FreeImage_GetBPP(dib) != 32)) {
+					converted.reset(FreeImage_ConvertTo32Bits(dib));
+				}
+				color_type = FIC_RGBALPHA;
+				break;
+			case FIT_UINT16:
+			case FIT_RGB16:
+			case FIT_RGBA16:
+				if (FreeImage_GetImageType(dib) != image_type) {
+					converted.reset(FreeImage_ConvertToType(dib, image_type, TRUE));
+				}
+				color_type = (image_type == FIT_UINT16) ? FIC_MINISBLACK : (image_type == FIT_RGB16) ? FIC_RGB : FIC_RGBALPHA;
+				break;
+			default:
+				throw FI_MSG_ERROR_UNSUPPORTED_FORMAT;
+		}
+		if (converted) {
+			dib = converted.get();
+		} else if (FreeImage_GetImageType(dib) != image_type) {
+			throw FI_MSG_ERROR_UNSUPPORTED_FORMAT;
+		}
+
+		// encode the frame as a standalone PNG stream
+
+		FreeImageIO memory_io;
+		SetMemoryIO(&memory_io);
+		std::unique_ptr<FIMEMORY, decltype(&FreeImage_CloseMemory)> hmem(FreeImage_OpenMemory(), &FreeImage_CloseMemory);
+		if (!hmem || !SaveImage(&memory_io, dib, (fi_handle)hmem.get(), flags, color_type)) {
+			throw (const char*)nullptr;
+		}
+		uint8_t *stream{};
+		uint32_t stream_size = 0;
+		FreeImage_AcquireMemory(hmem.get(), &stream, &stream_size);
+
+		// split the stream : the image data become the frame data, 
+		// the other chunks of the first frame are written as the file chunks
+
+		APNGWriteFrame frame;
+		std::vector<uint8_t> header, trailer;
+		uint8_t format[5]{};
+		bool idat_found = false;
+
+		size_t pos = PNG_BYTES_TO_CHECK;
+		while (pos + 12 <= stream_size) {
+			const uint32_t length = png_get_uint_32(stream + pos);
+			const uint8_t *type = stream + pos + 4;
+			const uint8_t *chunk_data = stream + pos + 8;
+			if (pos + 12 + length > stream_size) {
+				break;
+			}
+			if (memcmp(type, "IEND", 4) == 0) {
+				break;
+			}
+			if (memcmp(type, "IHDR", 4) == 0) {
+				frame.fc.width = png_get_uint_32(chunk_data);
+				frame.fc.height = png_get_uint_32(chunk_data + 4);
+				memcpy(format, chunk_data + 8, 5);
+			}
+			if (memcmp(type, "IDAT", 4) == 0) {
+				frame.data.insert(frame.data.end(), chunk_data, chunk_data + length);
+				idat_found = true;
+			} else if (first_frame) {
+				std::vector<uint8_t>& chunks = idat_found ? trailer : header;
+				chunks.insert(chunks.end(), stream + pos, stream + pos + 12 + length);
+			}
+			pos += 12 + length;
+		}
+		if (!idat_found || !frame.fc.width || !frame.fc.height) {
+			throw "Failed to encode animation frame";
+		}
+
+		// frame control
+
+		FITAG *tag{};
+
+		if (!first_frame) {
+			if (memcmp(format, ctx->anim_format, 5) != 0) {
+				throw "All frames of an animation must have the same pixel format";
+			}
+			if (FreeImage_GetMetadataEx(FIMD_ANIMATION, src, "FrameLeft", FIDT_SHORT, &tag)) {
+				frame.fc.x_offset = *(uint16_t *)FreeImage_GetTagValue(tag);
+			}
+			if (FreeImage_GetMetadataEx(FIMD_ANIMATION, src, "FrameTop", FIDT_SHORT, &tag)) {
+				frame.fc.y_offset = *(uint16_t *)FreeImage_GetTagValue(tag);
+			}
+			if (((uint64_t)frame.fc.x_offset + frame.fc.width > ctx->anim_width) || ((uint64_t)frame.fc.y_offset + frame.fc.height > ctx->anim_height)) {
+				throw "Animation frame outside of the canvas";
+			}
+		}
+
+		// same default frame time as the GIF plugin
+		int32_t frame_time = 100;
+		if (FreeImage_GetMetadataEx(FIMD_ANIMATION, src, "FrameTime", FIDT_LONG, &tag)) {
+			frame_time = *(int32_t *)FreeImage_GetTagValue(tag);
+		}
+		frame.fc.delay_num = (uint16_t)std::clamp(frame_time, 0, 0xFFFF);
+		frame.fc.delay_den = 1000;
+
+		uint8_t disposal_method = GIF_DISPOSAL_UNSPECIFIED;
+		if (FreeImage_GetMetadataEx(FIMD_ANIMATION, src, "DisposalMethod", FIDT_BYTE, &tag)) {
+			disposal_method = *(uint8_t *)FreeImage_GetTagValue(tag);
+		}
+		switch (disposal_method) {
+			case GIF_DISPOSAL_BACKGROUND:
+				frame.fc.dispose_op = APNG_DISPOSE_OP_BACKGROUND;
+				break;
+			case GIF_DISPOSAL_PREVIOUS:
+				frame.fc.dispose_op = first_frame ? APNG_DISPOSE_OP_BACKGROUND : APNG_DISPOSE_OP_PREVIOUS;
+				break;
+			default:
+				frame.fc.dispose_op = APNG_DISPOSE_OP_NONE;
+				break;
+		}
+
+		// a frame covering the whole canvas replaces it, a smaller frame is drawn over the previous one
+		const bool full_frame = !frame.fc.x_offset && !frame.fc.y_offset && 
+			(first_frame || ((frame.fc.width == ctx->anim_width) && (frame.fc.height == ctx->anim_height)));
+		frame.fc.blend_op = full_frame ? APNG_BLEND_OP_SOURCE : APNG_BLEND_OP_OVER;
+
+		if (first_frame) {
+			ctx->anim_type = image_type;
+			ctx->anim_width = frame.fc.width;
+			ctx->anim_height = frame.fc.height;
+			memcpy(ctx->anim_format, format, 5);
+			ctx->anim_header = std::move(header);
+			ctx->anim_trailer = std::move(trailer);
+
+			// APNG and FreeImage use the same convention : 0 means infinite looping
+			ctx->anim_num_plays = 0;
+			if (FreeImage_GetMetadataEx(FIMD_ANIMATION, src, "Loop", FIDT_LONG, &tag)) {
+				ctx->anim_num_plays = (uint32_t)std::max(*(int32_t *)FreeImage_GetTagValue(tag), 0);
+			}
+		}
+
+		ctx->anim_frames.push_back(std::move(frame));
+
+		return TRUE;
+
+	} catch (const std::bad_alloc&) {
+		FreeImage_OutputMessageProc(s_format_id, FI_MSG_ERROR_MEMORY);
+	} catch (const char *text) {
+		if (text) {
+			FreeImage_OutputMessageProc(s_format_id, text);
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+Write a chunk to the output stream
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+static FIBOOL
+WriteChunk(FreeImageIO *io, fi_handle handle, const char *type, const uint8_t *data, uint32_t length) {
+	std::vector<uint8_t> chunk;
+	chunk.reserve(12 + length);
+	AppendChunk(chunk, type, data, length);
+	return (io->write_proc(chunk.data(), 1, (unsigned)chunk.size(), handle) == chunk.size()) ? TRUE : FALSE;
+}
+
+/**
+Write the frames added with AddAnimationFrame as an APNG file
+@param io FreeImage IO
+@param handle Output stream
+@param ctx Plugin context
+@return Returns TRUE if successful, returns FALSE otherwise
+*/
+static FIBOOL
+WriteAnimation(FreeImageIO *io, fi_handle handle, PNGContext *ctx) {
+	static const uint8_t png_signature[PNG_BYTES_TO_CHECK] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	// size of the IHDR chunk, at the start of the header chunks
+	const size_t ihdr_size = 12 + 13;
+
+	try {
+		bool bSuccess = (io->write_proc((void*)png_signature, 1, PNG_BYTES_TO_CHECK, handle) == PNG_BYTES_TO_CHECK);
+
+		// IHDR then acTL, then the other header chunks of the first frame
+		bSuccess = bSuccess && (io->write_proc(ctx->anim_header.data(), 1, (unsigned)ihdr_size, handle) == ihdr_size);
+
+		uint8_t actl[8];
+		png_save_uint_32(actl, (png_uint_32)ctx->anim_frames.size());
+		png_save_uint_32(actl + 4, ctx->anim_num_plays);
+		bSuccess = bSuccess && WriteChunk(io, handle, "acTL", actl, 8);
+
+		const size_t other_size = ctx->anim_header.size() - ihdr_size;
+		bSuccess = bSuccess && (io->write_proc(ctx->anim_header.data() + ihdr_size, 1, (unsigned)other_size, handle) == other_size);
+
+		// frames : the first one is also the default image
+
+		uint32_t sequence_number = 0;
+		std::vector<uint8_t> fdat;
+
+		for (size_t i = 0; (i < ctx->anim_frames.size()) && bSuccess; i++) {
+			const APNGWriteFrame& frame = ctx->anim_frames[i];
+
+			uint8_t fctl[26];
+			png_save_uint_32(fctl, sequence_number++);
+			png_save_uint_32(fctl + 4, frame.fc.width);
+			png_save_uint_32(fctl + 8, frame.fc.height);
+			png_save_uint_32(fctl + 12, frame.fc.x_offset);
+			png_save_uint_32(fctl + 16, frame.fc.y_offset);
+			png_save_uint_16(fctl + 20, frame.fc.delay_num);
+			png_save_uint_16(fctl + 22, frame.fc.delay_den);
+			fctl[24] = frame.fc.dispose_op;
+			fctl[25] = frame.fc.blend_op;
+			bSuccess = bSuccess && WriteChunk(io, handle, "fcTL", fctl, 26);
+
+			for (size_t pos = 0; (pos < frame.data.size()) && bSuccess; pos += PNG_MAX_IDAT_SIZE) {
+				const uint32_t length = (uint32_t)std::min(frame.data.size() - pos, (size_t)PNG_MAX_IDAT_SIZE);
+				if (i == 0) {
+					bSuccess = WriteChunk(io, handle, "IDAT", frame.data.data() + pos, length);
+				} else {
+					fdat.resize(4 + length);
+					png_save_uint_32(fdat.data(), sequence_number++);
+					memcpy(fdat.data() + 4, frame.data.data() + pos, length);
+					bSuccess = WriteChunk(io, handle, "fdAT", fdat.data(), 4 + length);
+				}
+			}
+		}
+
+		// other chunks of the first frame, then IEND
+
+		bSuccess = bSuccess && (io->write_proc(ctx->anim_trailer.data(), 1, (unsigned)ctx->anim_trailer.size(), handle) == ctx->anim_trailer.size());
+		bSuccess = bSuccess && WriteChunk(io, handle, "IEND", nullptr, 0);
+
+		if (!bSuccess) {
+			throw "Failed to write APNG file";
+		}
+
+		return TRUE;
+
+	} catch (const std::bad_alloc&) {
+		FreeImage_OutputMessageProc(s_format_id, FI_MSG_ERROR_MEMORY);
+	} catch (const char *text) {
+		FreeImage_OutputMessageProc(s_format_id, text);
+	}
+
+	return FALSE;
+}
+
+static FIBOOL DLL_CALLCONV
+Save(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int page, int flags, void *data) {
+	auto *ctx = (PNGContext*)data;
+
+	if (!dib || !handle) {
+		return FALSE;
+	}
+	if ((page >= 0) && ctx && !ctx->read) {
+		// multipage bitmap : add the page to the animation, which is written on Close
+		return AddAnimationFrame(ctx, dib, flags);
+	}
+
+	return SaveImage(io, dib, handle, flags, FreeImage_GetColorType(dib));
+}
+
 // ==========================================================
 //   Init
 // ==========================================================
@@ -1053,9 +2775,9 @@ InitPNG(Plugin *plugin, int format_id) {
 	plugin->description_proc = Description;
 	plugin->extension_proc = Extension;
 	plugin->regexpr_proc = RegExpr;
-	plugin->open_proc = nullptr;
-	plugin->close_proc = nullptr;
-	plugin->pagecount_proc = nullptr;
+	plugin->open_proc = Open;
+	plugin->close_proc = Close;
+	plugin->pagecount_proc = PageCount;
 	plugin->pagecapability_proc = nullptr;
 	plugin->load_proc = Load;
 	plugin->save_proc = Save;
@@ -1065,6 +2787,9 @@ InitPNG(Plugin *plugin, int format_id) {
 	plugin->supports_export_type_proc = SupportsExportType;
 	plugin->supports_icc_profiles_proc = SupportsICCProfiles;
 	plugin->supports_no_pixels_proc = SupportsNoPixels;
+	plugin->open_persistent_proc = Open;
+	plugin->close_persistent_proc = Close;
+	plugin->load_scanlines_proc = LoadScanlines;
 }
 
 
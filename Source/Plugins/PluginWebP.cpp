@@ -25,6 +25,7 @@
 #include "../Metadata/FreeImageTag.h"
 
 #include "webp/decode.h"
+#include "webp/demux.h"
 #include "webp/encode.h"
 #include "webp/mux.h"
 #include "dec/vp8i_dec.h"
@@ -35,6 +36,100 @@
 
 static int s_format_id;
 
+//! mask of the WEBP_METHOD_x save flags
+#define WEBP_METHOD_MASK	0x7000
+
+// ----------------------------------------------------------
+//   Plugin context
+// ----------------------------------------------------------
+
+/**
+Data shared between Open, Load, Save and Close. 
+When reading, the animation decoder is kept alive between two Load calls 
+so that sequential access to the frames of an animation decodes each frame only once. 
+When writing, the frames of a multipage bitmap are accumulated in the animation encoder 
+and the file is assembled on Close.
+*/
+struct WebPContext {
+	//! raw file data, referenced by the mux and the animation decoder (read mode)
+	WebPData bitstream{};
+	//! container of the image chunks and metadata
+	WebPMux *mux{};
+
+	//! animation decoder, created on first access to an animated file
+	WebPAnimDecoder *anim_decoder{};
+	//! output colorspace of the animation decoder
+	WEBP_CSP_MODE anim_mode{ MODE_LAST };
+	//! worker thread setting of the animation decoder
+	int anim_threads{ -1 };
+	//! index of the last frame returned by the animation decoder (-1 if none)
+	int anim_frame{ -1 };
+	//! canvas of the last frame returned by the animation decoder
+	uint8_t *anim_canvas{};
+
+	//! animation encoder, created on first call to Save with page >= 0
+	WebPAnimEncoder *anim_encoder{};
+	//! canvas size of the encoded animation
+	unsigned anim_width{}, anim_height{};
+	//! start time of the next encoded frame, in ms
+	int anim_timestamp{};
+	//! flags used for the first encoded frame
+	int anim_flags{};
+	//! ICC / XMP / Exif chunks of the first encoded frame, added to the file on Close
+	std::string anim_iccp, anim_xmp, anim_exif;
+
+	~WebPContext() {
+		if (anim_encoder) {
+			WebPAnimEncoderDelete(anim_encoder);
+		}
+		if (anim_decoder) {
+			WebPAnimDecoderDelete(anim_decoder);
+		}
+		if (mux) {
+			WebPMuxDelete(mux);
+		}
+		delete[] bitstream.bytes;
+	}
+};
+
+// ----------------------------------------------------------
+//   Metadata helpers
+// ----------------------------------------------------------
+
+static FIBOOL 
+FreeImage_SetMetadataEx(FREE_IMAGE_MDMODEL model, FIBITMAP *dib, const char *key, uint16_t id, FREE_IMAGE_MDTYPE type, uint32_t count, uint32_t length, const void *value)
+{
+	bool bSuccess{};
+	if (std::unique_ptr<FITAG, decltype(&FreeImage_DeleteTag)> tag(FreeImage_CreateTag(), &FreeImage_DeleteTag); tag) {
+		bSuccess = FreeImage_SetTagKey(tag.get(), key);
+		bSuccess = bSuccess && FreeImage_SetTagID(tag.get(), id);
+		bSuccess = bSuccess && FreeImage_SetTagType(tag.get(), type);
+		bSuccess = bSuccess && FreeImage_SetTagCount(tag.get(), count);
+		bSuccess = bSuccess && FreeImage_SetTagLength(tag.get(), length);
+		bSuccess = bSuccess && FreeImage_SetTagValue(tag.get(), value);
+		if (model == FIMD_ANIMATION) {
+			const TagLib& s = TagLib::instance();
+			// get the tag description
+			const char *description = s.getTagDescription(TagLib::ANIMATION, id);
+			bSuccess = bSuccess && FreeImage_SetTagDescription(tag.get(), description);
+		}
+		// store the tag
+		bSuccess = bSuccess && FreeImage_SetMetadata(model, dib, key, tag.get());
+	}
+	return bSuccess ? TRUE : FALSE;
+}
+
+static FIBOOL 
+FreeImage_GetMetadataEx(FREE_IMAGE_MDMODEL model, FIBITMAP *dib, const char *key, FREE_IMAGE_MDTYPE type, FITAG **tag)
+{
+	if (FreeImage_GetMetadata(model, dib, key, tag)) {
+		if (FreeImage_GetTagType(*tag) == type) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 // ----------------------------------------------------------
 //   Helpers for the load function
 // ----------------------------------------------------------
@@ -162,43 +257,73 @@ SupportsNoPixels() {
 
 static void * DLL_CALLCONV
 Open(FreeImageIO *io, fi_handle handle, FIBOOL read) {
-	WebPMux *mux{};
-	int copy_data = 1;	// 1 : copy data into the mux, 0 : keep a link to local data
+	auto ctx = std::make_unique<WebPContext>();
 
 	if (read) {
-		// create the MUX object from the input stream
-		WebPData bitstream;
 		// read the input file and put it in memory
-		if (!ReadFileToWebPData(io, handle, &bitstream)) {
+		if (!ReadFileToWebPData(io, handle, &ctx->bitstream)) {
 			return nullptr;
 		}
-		// create the MUX object
-		mux = WebPMuxCreate(&bitstream, copy_data);
-		// no longer needed since copy_data == 1
-		delete[] bitstream.bytes;
-		if (!mux) {
+		// create the MUX object, linked to the data owned by the context
+		ctx->mux = WebPMuxCreate(&ctx->bitstream, 0);
+		if (!ctx->mux) {
 			FreeImage_OutputMessageProc(s_format_id, "Failed to create mux object from file");
+			return nullptr;
 		}
 	} else {
 		// creates an empty mux object
-		mux = WebPMuxNew();
-		if (!mux) {
+		ctx->mux = WebPMuxNew();
+		if (!ctx->mux) {
 			FreeImage_OutputMessageProc(s_format_id, "Failed to create empty mux object");
+			return nullptr;
 		}
 	}
 
-	return mux;
+	return ctx.release();
 }
 
+static FIBOOL
+WriteAnimation(FreeImageIO *io, fi_handle handle, WebPContext *ctx);
+
 static void DLL_CALLCONV
 Close(FreeImageIO *io, fi_handle handle, void *data) {
-	WebPMux *mux = (WebPMux*)data;
-	if (mux) {
-		// free the MUX object
-		WebPMuxDelete(mux);
+	auto *ctx = (WebPContext*)data;
+	if (ctx) {
+		if (ctx->anim_encoder) {
+			// frames were added through the multipage API : assemble the animation
+			WriteAnimation(io, handle, ctx);
+		}
+		delete ctx;
 	}
 }
 
+/**
+Returns the number of frames of an animated file, or 1 for a still image
+*/
+static int
+GetFrameCount(WebPMux *mux) {
+	uint32_t webp_flags = 0;
+	if (WebPMuxGetFeatures(mux, &webp_flags) == WEBP_MUX_OK) {
+		if (webp_flags & ANIMATION_FLAG) {
+			int frame_count = 0;
+			if (WebPMuxNumChunks(mux, WEBP_CHUNK_ANMF, &frame_count) == WEBP_MUX_OK) {
+				return frame_count;
+			}
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int DLL_CALLCONV
+PageCount(FreeImageIO *io, fi_handle handle, void *data) {
+	auto *ctx = (WebPContext*)data;
+	if (!ctx || !ctx->mux) {
+		return 0;
+	}
+	return GetFrameCount(ctx->mux);
+}
+
 // ----------------------------------------------------------
 
 /**
@@ -255,8 +380,8 @@ DecodeImage(WebPData *webp_image, int flags) {
 
 		// --- Set decoding options ---
 
-		// use multi-threaded decoding
-		decoder_config.options.use_threads = 1;
+		// use multi-threaded decoding unless disabled by the caller
+		decoder_config.options.use_threads = ((flags & WEBP_LOAD_NOTHREADS) == WEBP_LOAD_NOTHREADS) ? 0 : 1;
 		// set output color space
 		output_buffer->colorspace = bitstream->has_alpha ? MODE_BGRA : MODE_BGR;
 
@@ -319,13 +444,184 @@ DecodeImage(WebPData *webp_image, int flags) {
 	return nullptr;
 }
 
-static FIBITMAP * DLL_CALLCONV
-Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
-	WebPMux *mux{};
-	WebPMuxFrameInfo webp_frame = { 0 };	// raw image
+/**
+Decode a frame of an animated WebP image and returns a 32-bit FIBITMAP image of the whole canvas. 
+Frames are composited (blending and disposal) by the animation decoder. 
+Decoding of frame N requires the frames 0..N-1 : the decoder is kept in the context and 
+rewinded only when a previous frame is requested.
+@param ctx Plugin context
+@param page Frame index
+@param flags FreeImage load flags
+@return Returns a dib if successfull, returns NULL otherwise
+*/
+static FIBITMAP *
+DecodeAnimationFrame(WebPContext *ctx, int page, int flags) {
+	const FIBOOL header_only = (flags & FIF_LOAD_NOPIXELS) == FIF_LOAD_NOPIXELS;
+
+	try {
+		// select the output colorspace matching the FreeImage memory layout
+		const bool premultiplied = (flags & WEBP_PREMULTIPLIED) == WEBP_PREMULTIPLIED;
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+		const WEBP_CSP_MODE color_mode = premultiplied ? MODE_bgrA : MODE_BGRA;
+#else
+		const WEBP_CSP_MODE color_mode = premultiplied ? MODE_rgbA : MODE_RGBA;
+#endif
+
+		// use multi-threaded decoding unless disabled by the caller
+		const int use_threads = ((flags & WEBP_LOAD_NOTHREADS) == WEBP_LOAD_NOTHREADS) ? 0 : 1;
+
+		if (!ctx->anim_decoder || (ctx->anim_mode != color_mode) || (ctx->anim_threads != use_threads)) {
+			if (ctx->anim_decoder) {
+				WebPAnimDecoderDelete(ctx->anim_decoder);
+				ctx->anim_decoder = nullptr;
+			}
+			WebPAnimDecoderOptions options;
+			if (!WebPAnimDecoderOptionsInit(&options)) {
+				throw "Library version mismatch";
+			}
+			options.color_mode = color_mode;
+			options.use_threads = use_threads;
+
+			ctx->anim_decoder = WebPAnimDecoderNew(&ctx->bitstream, &options);
+			if (!ctx->anim_decoder) {
+				throw FI_MSG_ERROR_PARSING;
+			}
+			ctx->anim_mode = color_mode;
+			ctx->anim_threads = use_threads;
+			ctx->anim_frame = -1;
+			ctx->anim_canvas = nullptr;
+		}
+
+		WebPAnimInfo anim_info;
+		if (!WebPAnimDecoderGetInfo(ctx->anim_decoder, &anim_info)) {
+			throw FI_MSG_ERROR_PARSING;
+		}
+		if ((page < 0) || ((uint32_t)page >= anim_info.frame_count)) {
+			throw "Invalid frame index";
+		}
+
+		const unsigned width = anim_info.canvas_width;
+		const unsigned height = anim_info.canvas_height;
+
+		std::unique_ptr<FIBITMAP, decltype(&FreeImage_Unload)> dib(FreeImage_AllocateHeader(header_only, width, height, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK), &FreeImage_Unload);
+		if (!dib) {
+			throw FI_MSG_ERROR_DIB_MEMORY;
+		}
+
+		if (!header_only) {
+			// rewind only if a previous frame is requested
+			if (page < ctx->anim_frame) {
+				WebPAnimDecoderReset(ctx->anim_decoder);
+				ctx->anim_frame = -1;
+				ctx->anim_canvas = nullptr;
+			}
+			while (ctx->anim_frame < page) {
+				int timestamp = 0;
+				if (!WebPAnimDecoderGetNext(ctx->anim_decoder, &ctx->anim_canvas, &timestamp)) {
+					ctx->anim_frame = -1;
+					ctx->anim_canvas = nullptr;
+					throw FI_MSG_ERROR_PARSING;
+				}
+				ctx->anim_frame++;
+			}
+
+			// the canvas is a top-down 32-bit buffer with the same channel order as the dib
+			const unsigned line = width * 4;
+			for (unsigned y = 0; y < height; y++) {
+				memcpy(FreeImage_GetScanLine(dib.get(), height - 1 - y), ctx->anim_canvas + y * line, line);
+			}
+		}
+
+		// animation metadata
+
+		const WebPDemuxer *demux = WebPAnimDecoderGetDemuxer(ctx->anim_decoder);
+		WebPIterator iter;
+		if (WebPDemuxGetFrame(demux, page + 1, &iter)) {
+			int32_t frame_time = iter.duration;
+			FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "FrameTime", ANIMTAG_FRAMETIME, FIDT_LONG, 1, 4, &frame_time);
+			WebPDemuxReleaseIterator(&iter);
+		}
+
+		if (page == 0) {
+			auto logical_width = (uint16_t)width;
+			auto logical_height = (uint16_t)height;
+			FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "LogicalWidth", ANIMTAG_LOGICALWIDTH, FIDT_SHORT, 1, 2, &logical_width);
+			FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "LogicalHeight", ANIMTAG_LOGICALHEIGHT, FIDT_SHORT, 1, 2, &logical_height);
+
+			// WebP and FreeImage use the same convention : 0 means infinite looping
+			auto loop = (int32_t)anim_info.loop_count;
+			FreeImage_SetMetadataEx(FIMD_ANIMATION, dib.get(), "Loop", ANIMTAG_LOOP, FIDT_LONG, 1, 4, &loop);
+
+			// background color is stored in [Blue, Green, Red, Alpha] byte order
+			FIRGBA8 bkcolor;
+			bkcolor.blue  = (uint8_t)(anim_info.bgcolor & 0xFF);
+			bkcolor.green = (uint8_t)((anim_info.bgcolor >> 8) & 0xFF);
+			bkcolor.red   = (uint8_t)((anim_info.bgcolor >> 16) & 0xFF);
+			bkcolor.alpha = (uint8_t)((anim_info.bgcolor >> 24) & 0xFF);
+			FreeImage_SetBackgroundColor(dib.get(), &bkcolor);
+		}
+
+		return dib.release();
+
+	} catch (const char *text) {
+		if (text) {
+			FreeImage_OutputMessageProc(s_format_id, text);
+		}
+	}
+	return nullptr;
+}
+
+/**
+Read the ICC profile, XMP and Exif chunks of a file
+*/
+static void
+ReadMetadata(WebPMux *mux, uint32_t webp_flags, FIBITMAP *dib) {
 	WebPData color_profile;	// ICC raw data
 	WebPData xmp_metadata;	// XMP raw data
 	WebPData exif_metadata;	// EXIF raw data
+	WebPMuxError error_status;
+
+	// get ICC profile
+	if (webp_flags & ICCP_FLAG) {
+		error_status = WebPMuxGetChunk(mux, "ICCP", &color_profile);
+		if (error_status == WEBP_MUX_OK) {
+			FreeImage_CreateICCProfile(dib, (void*)color_profile.bytes, (long)color_profile.size);
+		}
+	}
+
+	// get XMP metadata
+	if (webp_flags & XMP_FLAG) {
+		error_status = WebPMuxGetChunk(mux, "XMP ", &xmp_metadata);
+		if (error_status == WEBP_MUX_OK) {
+			// create a tag
+			if (std::unique_ptr<FITAG, decltype(&FreeImage_DeleteTag)> tag(FreeImage_CreateTag(), &FreeImage_DeleteTag); tag) {
+				FreeImage_SetTagKey(tag.get(), g_TagLib_XMPFieldName);
+				FreeImage_SetTagLength(tag.get(), (uint32_t)xmp_metadata.size);
+				FreeImage_SetTagCount(tag.get(), (uint32_t)xmp_metadata.size);
+				FreeImage_SetTagType(tag.get(), FIDT_ASCII);
+				FreeImage_SetTagValue(tag.get(), xmp_metadata.bytes);
+				
+				// store the tag
+				FreeImage_SetMetadata(FIMD_XMP, dib, FreeImage_GetTagKey(tag.get()), tag.get());
+			}
+		}
+	}
+
+	// get Exif metadata
+	if (webp_flags & EXIF_FLAG) {
+		error_status = WebPMuxGetChunk(mux, "EXIF", &exif_metadata);
+		if (error_status == WEBP_MUX_OK) {
+			// read the Exif raw data as a blob
+			jpeg_read_exif_profile_raw(dib, exif_metadata.bytes, (unsigned)exif_metadata.size);
+			// read and decode the Exif data
+			jpeg_read_exif_profile(dib, exif_metadata.bytes, (unsigned)exif_metadata.size);
+		}
+	}
+}
+
+static FIBITMAP * DLL_CALLCONV
+Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
+	WebPMuxFrameInfo webp_frame = { 0 };	// raw image
 	FIBITMAP *dib{};
 	WebPMuxError error_status;
 
@@ -334,11 +630,12 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 	}
 
 	try {
-		// get the MUX object
-		mux = (WebPMux*)data;
-		if (!mux) {
+		// get the plugin context
+		auto *ctx = (WebPContext*)data;
+		if (!ctx || !ctx->mux) {
 			throw (1);
 		}
+		WebPMux *mux = ctx->mux;
 		
 		// gets the feature flags from the mux object
 		uint32_t webp_flags = 0;
@@ -347,6 +644,16 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 			throw (1);
 		}
 
+		if (webp_flags & ANIMATION_FLAG) {
+			// decode a frame of the animation (can be limited to the header if flags uses FIF_LOAD_NOPIXELS)
+			dib = DecodeAnimationFrame(ctx, (page < 0) ? 0 : page, flags);
+			if (!dib) {
+				throw (1);
+			}
+			ReadMetadata(mux, webp_flags, dib);
+			return dib;
+		}
+
 		// get image data
 		error_status = WebPMuxGetFrame(mux, 1, &webp_frame);
 
@@ -357,42 +664,7 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 				throw (1);
 			}
 			
-			// get ICC profile
-			if (webp_flags & ICCP_FLAG) {
-				error_status = WebPMuxGetChunk(mux, "ICCP", &color_profile);
-				if (error_status == WEBP_MUX_OK) {
-					FreeImage_CreateICCProfile(dib, (void*)color_profile.bytes, (long)color_profile.size);
-				}
-			}
-
-			// get XMP metadata
-			if (webp_flags & XMP_FLAG) {
-				error_status = WebPMuxGetChunk(mux, "XMP ", &xmp_metadata);
-				if (error_status == WEBP_MUX_OK) {
-					// create a tag
-					if (std::unique_ptr<FITAG, decltype(&FreeImage_DeleteTag)> tag(FreeImage_CreateTag(), &FreeImage_DeleteTag); tag) {
-						FreeImage_SetTagKey(tag.get(), g_TagLib_XMPFieldName);
-						FreeImage_SetTagLength(tag.get(), (uint32_t)xmp_metadata.size);
-						FreeImage_SetTagCount(tag.get(), (uint32_t)xmp_metadata.size);
-						FreeImage_SetTagType(tag.get(), FIDT_ASCII);
-						FreeImage_SetTagValue(tag.get(), xmp_metadata.bytes);
-						
-						// store the tag
-						FreeImage_SetMetadata(FIMD_XMP, dib, FreeImage_GetTagKey(tag.get()), tag.get());
-					}
-				}
-			}
-
-			// get Exif metadata
-			if (webp_flags & EXIF_FLAG) {
-				error_status = WebPMuxGetChunk(mux, "EXIF", &exif_metadata);
-				if (error_status == WEBP_MUX_OK) {
-					// read the Exif raw data as a blob
-					jpeg_read_exif_profile_raw(dib, exif_metadata.bytes, (unsigned)exif_metadata.size);
-					// read and decode the Exif data
-					jpeg_read_exif_profile(dib, exif_metadata.bytes, (unsigned)exif_metadata.size);
-				}
-			}
+			ReadMetadata(mux, webp_flags, dib);
 		}
 
 		WebPDataClear(&webp_frame.bitstream);
@@ -407,6 +679,98 @@ Load(FreeImageIO *io, fi_handle handle, int page, int flags, void *data) {
 
 // --------------------------------------------------------------------------
 
+/**
+Initialize the encoding parameters from the FreeImage save flags
+@param config Coding parameters
+@param picture Input buffer
+@param flags FreeImage save flags
+@return Returns TRUE if successfull, returns FALSE otherwise
+*/
+static FIBOOL
+InitEncoderConfig(WebPConfig *config, WebPPicture *picture, int flags) {
+	// Initialize encoding parameters to default values
+	if (!WebPConfigInit(config)) {
+		return FALSE;
+	}
+
+	// quality/speed trade-off (0=fast, 6=slower-better)
+	config->method = 6;
+	if ((flags & WEBP_METHOD_MASK) != 0) {
+		config->method = ((flags & WEBP_METHOD_MASK) / WEBP_METHOD_0) - 1;
+	}
+
+	// use multi-threaded encoding
+	if ((flags & WEBP_MULTITHREAD) == WEBP_MULTITHREAD) {
+		config->thread_level = 1;
+	}
+
+	if ((flags & WEBP_LOSSLESS) == WEBP_LOSSLESS) {
+		// lossless encoding
+		config->lossless = 1;
+		picture->use_argb = 1;
+	} else if ((flags & 0x7F) > 0) {
+		// lossy encoding
+		config->lossless = 0;
+		// quality is between 1 (smallest file) and 100 (biggest) - default to 75
+		config->quality = (float)(flags & 0x7F);
+		if (config->quality > 100) {
+			config->quality = 100;
+		}
+	}
+
+	// validate encoding parameters
+	return WebPValidateConfig(config) ? TRUE : FALSE;
+}
+
+/**
+Copy the pixels of a 24- or 32-bit dib into a WebP picture
+@param picture Input buffer, its size must be set
+@param dib The FIBITMAP to import
+@return Returns TRUE if successfull, returns FALSE otherwise
+*/
+static FIBOOL
+ImportPicture(WebPPicture *picture, FIBITMAP *dib) {
+	const unsigned bpp = FreeImage_GetBPP(dib);
+	const unsigned pitch = FreeImage_GetPitch(dib);
+
+	int success = 0;
+
+	// Invert dib scanlines
+	const FIBOOL bIsFlipped = FreeImage_FlipVertical(dib);
+
+	// convert dib buffer to output stream
+
+	const uint8_t *bits = FreeImage_GetBits(dib);
+
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+	switch (bpp) {
+		case 24:
+			success = WebPPictureImportBGR(picture, bits, pitch);
+			break;
+		case 32:
+			success = WebPPictureImportBGRA(picture, bits, pitch);
+			break;
+	}
+#else
+	switch (bpp) {
+		case 24:
+			success = WebPPictureImportRGB(picture, bits, pitch);
+			break;
+		case 32:
+			success = WebPPictureImportRGBA(picture, bits, pitch);
+			break;
+	}
+
+#endif // FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+
+	if (bIsFlipped) {
+		// invert dib scanlines
+		FreeImage_FlipVertical(dib);
+	}
+
+	return success ? TRUE : FALSE;
+}
+
 /**
 Encode a FIBITMAP to a WebP image
 @param hmem Memory output stream, containing on return the encoded image
@@ -419,13 +783,10 @@ EncodeImage(FIMEMORY *hmem, FIBITMAP *dib, int flags) {
 	WebPPicture picture;	// Input buffer
 	WebPConfig config;		// Coding parameters
 
-	FIBOOL bIsFlipped = FALSE;
-
 	try {
 		const unsigned width = FreeImage_GetWidth(dib);
 		const unsigned height = FreeImage_GetHeight(dib);
 		const unsigned bpp = FreeImage_GetBPP(dib);
-		const unsigned pitch = FreeImage_GetPitch(dib);
 
 		// check image type
 		FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(dib);
@@ -452,72 +813,151 @@ EncodeImage(FIMEMORY *hmem, FIBITMAP *dib, int flags) {
 
 		// --- Set encoding parameters ---
 
-		// Initialize encoding parameters to default values
-		WebPConfigInit(&config);
-
-		// quality/speed trade-off (0=fast, 6=slower-better)
-		config.method = 6;
-
-		if ((flags & WEBP_LOSSLESS) == WEBP_LOSSLESS) {
-			// lossless encoding
-			config.lossless = 1;
-			picture.use_argb = 1;
-		} else if ((flags & 0x7F) > 0) {
-			// lossy encoding
-			config.lossless = 0;
-			// quality is between 1 (smallest file) and 100 (biggest) - default to 75
-			config.quality = (float)(flags & 0x7F);
-			if (config.quality > 100) {
-				config.quality = 100;
-			}
-		}
-
-		// validate encoding parameters
-		if (WebPValidateConfig(&config) == 0) {
+		if (!InitEncoderConfig(&config, &picture, flags)) {
 			throw "Failed to initialize encoder";
 		}
 
 		// --- Perform encoding ---
 		
-		// Invert dib scanlines
-		bIsFlipped = FreeImage_FlipVertical(dib);
+		if (!ImportPicture(&picture, dib)) {
+			throw FI_MSG_ERROR_MEMORY;
+		}
 
+		if (!WebPEncode(&config, &picture)) {
+			throw "Failed to encode image";
+		}
 
-		// convert dib buffer to output stream
+		WebPPictureFree(&picture);
 
-		const uint8_t *bits = FreeImage_GetBits(dib);
+		return TRUE;
 
-#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
-		switch (bpp) {
-			case 24:
-				WebPPictureImportBGR(&picture, bits, pitch);
-				break;
-			case 32:
-				WebPPictureImportBGRA(&picture, bits, pitch);
-				break;
+	} catch (const char* text) {
+
+		WebPPictureFree(&picture);
+
+		if (text) {
+			FreeImage_OutputMessageProc(s_format_id, text);
 		}
-#else
-		switch (bpp) {
-			case 24:
-				WebPPictureImportRGB(&picture, bits, pitch);
-				break;
-			case 32:
-				WebPPictureImportRGBA(&picture, bits, pitch);
-				break;
+	}
+
+	return FALSE;
+}
+
+/**
+Add a FIBITMAP as the next frame of an animation. 
+The first frame defines the canvas size, the loop count and the background color of the animation. 
+All frames must have the size of the canvas (e.g. GIF frames loaded with GIF_PLAYBACK).
+@param ctx Plugin context
+@param dib The FIBITMAP to encode
+@param flags FreeImage save flags
+@return Returns TRUE if successfull, returns FALSE otherwise
+*/
+static FIBOOL
+AddAnimationFrame(WebPContext *ctx, FIBITMAP *dib, int flags) {
+	WebPPicture picture;	// Input buffer
+	WebPConfig config;		// Coding parameters
+
+	if (!WebPPictureInit(&picture)) {
+		FreeImage_OutputMessageProc(s_format_id, "Couldn't initialize WebPPicture");
+		return FALSE;
+	}
+
+	try {
+		const unsigned width = FreeImage_GetWidth(dib);
+		const unsigned height = FreeImage_GetHeight(dib);
+		const unsigned bpp = FreeImage_GetBPP(dib);
+
+		// check image type
+		FREE_IMAGE_TYPE image_type = FreeImage_GetImageType(dib);
+
+		if (!((image_type == FIT_BITMAP) && ((bpp == 24) || (bpp == 32))))  {
+			throw FI_MSG_ERROR_UNSUPPORTED_FORMAT;
 		}
 
-#endif // FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+		FITAG *tag{};
 
-		if (!WebPEncode(&config, &picture)) {
-			throw "Failed to encode image";
+		if (!ctx->anim_encoder) {
+			// check format limits
+			if (std::max(width, height) > WEBP_MAX_DIMENSION) {
+				throw "Unsupported image size";
+			}
+
+			WebPAnimEncoderOptions options;
+			if (!WebPAnimEncoderOptionsInit(&options)) {
+				throw "Library version mismatch";
+			}
+
+			// WebP and FreeImage use the same convention : 0 means infinite looping
+			if (FreeImage_GetMetadataEx(FIMD_ANIMATION, dib, "Loop", FIDT_LONG, &tag)) {
+				options.anim_params.loop_count = *(int32_t *)FreeImage_GetTagValue(tag);
+			}
+
+			// background color is stored in [Blue, Green, Red, Alpha] byte order
+			FIRGBA8 bkcolor;
+			if (FreeImage_GetBackgroundColor(dib, &bkcolor)) {
+				options.anim_params.bgcolor = ((uint32_t)bkcolor.alpha << 24) | ((uint32_t)bkcolor.red << 16) | ((uint32_t)bkcolor.green << 8) | (uint32_t)bkcolor.blue;
+			}
+
+			// search the best frame encoding (slower)
+			options.minimize_size = ((flags & WEBP_ANIM_MINSIZE) == WEBP_ANIM_MINSIZE) ? 1 : 0;
+
+			// every frame is a keyframe : larger file, faster random access
+			if ((flags & WEBP_ANIM_ALLKEYFRAMES) == WEBP_ANIM_ALLKEYFRAMES) {
+				options.kmin = 0;
+				options.kmax = 1;
+			}
+
+			ctx->anim_encoder = WebPAnimEncoderNew((int)width, (int)height, &options);
+			if (!ctx->anim_encoder) {
+				throw FI_MSG_ERROR_MEMORY;
+			}
+			ctx->anim_width = width;
+			ctx->anim_height = height;
+			ctx->anim_timestamp = 0;
+			ctx->anim_flags = flags;
+
+			// keep the metadata of the first frame, they are stored once for the whole file
+
+			FIICCPROFILE *iccProfile = FreeImage_GetICCProfile(dib);
+			if (iccProfile->size && iccProfile->data) {
+				ctx->anim_iccp.assign((const char*)iccProfile->data, (size_t)iccProfile->size);
+			}
+			if (FreeImage_GetMetadata(FIMD_XMP, dib, g_TagLib_XMPFieldName, &tag)) {
+				ctx->anim_xmp.assign((const char*)FreeImage_GetTagValue(tag), (size_t)FreeImage_GetTagLength(tag));
+			}
+			if (FreeImage_GetMetadata(FIMD_EXIF_RAW, dib, g_TagLib_ExifRawFieldName, &tag)) {
+				ctx->anim_exif.assign((const char*)FreeImage_GetTagValue(tag), (size_t)FreeImage_GetTagLength(tag));
+			}
+		}
+
+		if ((width != ctx->anim_width) || (height != ctx->anim_height)) {
+			throw "All frames of an animation must have the same size";
+		}
+
+		picture.width = (int)width;
+		picture.height = (int)height;
+
+		if (!InitEncoderConfig(&config, &picture, flags)) {
+			throw "Failed to initialize encoder";
+		}
+
+		if (!ImportPicture(&picture, dib)) {
+			throw FI_MSG_ERROR_MEMORY;
+		}
+
+		// the frame is copied by the encoder
+		if (!WebPAnimEncoderAdd(ctx->anim_encoder, &picture, ctx->anim_timestamp, &config)) {
+			throw WebPAnimEncoderGetError(ctx->anim_encoder);
 		}
 
 		WebPPictureFree(&picture);
 
-		if (bIsFlipped) {
-			// invert dib scanlines
-			FreeImage_FlipVertical(dib);
+		// same default frame time as the GIF plugin
+		int32_t frame_time = 100;
+		if (FreeImage_GetMetadataEx(FIMD_ANIMATION, dib, "FrameTime", FIDT_LONG, &tag)) {
+			frame_time = *(int32_t *)FreeImage_GetTagValue(tag);
 		}
+		ctx->anim_timestamp += std::max(frame_time, 0);
 
 		return TRUE;
 
@@ -525,11 +965,87 @@ EncodeImage(FIMEMORY *hmem, FIBITMAP *dib, int flags) {
 
 		WebPPictureFree(&picture);
 
-		if (bIsFlipped) {
-			// invert dib scanlines
-			FreeImage_FlipVertical(dib);
+		if (text) {
+			FreeImage_OutputMessageProc(s_format_id, text);
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+Assemble the frames added with AddAnimationFrame and write the animation to the output stream
+@param io FreeImage IO
+@param handle Output stream
+@param ctx Plugin context
+@return Returns TRUE if successfull, returns FALSE otherwise
+*/
+static FIBOOL
+WriteAnimation(FreeImageIO *io, fi_handle handle, WebPContext *ctx) {
+	WebPData anim_data = { 0 };
+	WebPData output_data = { 0 };
+	WebPMux *mux{};
+
+	const int copy_data = 1;	// 1 : copy data into the mux, 0 : keep a link to local data
+
+	try {
+		// a last empty frame gives the duration of the last frame
+		if (!WebPAnimEncoderAdd(ctx->anim_encoder, nullptr, ctx->anim_timestamp, nullptr)) {
+			throw WebPAnimEncoderGetError(ctx->anim_encoder);
+		}
+		if (!WebPAnimEncoderAssemble(ctx->anim_encoder, &anim_data)) {
+			throw WebPAnimEncoderGetError(ctx->anim_encoder);
+		}
+
+		const WebPData *result = &anim_data;
+
+		if (!ctx->anim_iccp.empty() || !ctx->anim_xmp.empty() || !ctx->anim_exif.empty()) {
+			// add the metadata chunks
+			mux = WebPMuxCreate(&anim_data, copy_data);
+			if (!mux) {
+				throw "Failed to create mux object";
+			}
+			const std::pair<const char*, const std::string*> chunks[] = {
+				{ "ICCP", &ctx->anim_iccp },
+				{ "XMP ", &ctx->anim_xmp },
+				{ "EXIF", &ctx->anim_exif }
+			};
+			for (const auto& chunk : chunks) {
+				if (!chunk.second->empty()) {
+					WebPData chunk_data;
+					chunk_data.bytes = (const uint8_t*)chunk.second->data();
+					chunk_data.size = chunk.second->size();
+					if (WebPMuxSetChunk(mux, chunk.first, &chunk_data, copy_data) != WEBP_MUX_OK) {
+						throw "Failed to write metadata";
+					}
+				}
+			}
+			if (WebPMuxAssemble(mux, &output_data) != WEBP_MUX_OK) {
+				throw "Failed to create webp output file";
+			}
+			result = &output_data;
+		}
+
+		// write the file to the output stream
+		if (io->write_proc((void*)result->bytes, 1, (unsigned)result->size, handle) != result->size) {
+			throw "Failed to write webp output file";
 		}
 
+		if (mux) {
+			WebPMuxDelete(mux);
+		}
+		WebPDataClear(&output_data);
+		WebPDataClear(&anim_data);
+
+		return TRUE;
+
+	} catch (const char* text) {
+		if (mux) {
+			WebPMuxDelete(mux);
+		}
+		WebPDataClear(&output_data);
+		WebPDataClear(&anim_data);
+
 		if (text) {
 			FreeImage_OutputMessageProc(s_format_id, text);
 		}
@@ -554,8 +1070,16 @@ Save(FreeImageIO *io, FIBITMAP *dib, fi_handle handle, int page, int flags, void
 
 	try {
 
+		// get the plugin context
+		auto *ctx = (WebPContext*)data;
+
+		if (page >= 0) {
+			// multipage bitmap : add the page to the animation, which is written on Close
+			return AddAnimationFrame(ctx, dib, flags);
+		}
+
 		// get the MUX object
-		mux = (WebPMux*)data;
+		mux = ctx->mux;
 		if (!mux) {
 			return FALSE;
 		}
@@ -667,7 +1191,7 @@ InitWEBP(Plugin *plugin, int format_id) {
 	plugin->regexpr_proc = RegExpr;
 	plugin->open_proc = Open;
 	plugin->close_proc = Close;
-	plugin->pagecount_proc = nullptr;
+	plugin->pagecount_proc = PageCount;
 	plugin->pagecapability_proc = nullptr;
 	plugin->load_proc = Load;
 	plugin->save_proc = Save;
@@ -48,8 +48,8 @@ typedef struct tagBox {
 } Box;
 
 protected:
-    float *gm2;
-	int32_t *wt, *mr, *mg, *mb;
+    double *gm2;
+	int64_t *wt, *mr, *mg, *mb;
 	uint16_t *Qadd;
 
 	// DIB data
@@ -58,24 +58,29 @@ protected:
 	FIBITMAP *m_dib;
 
 protected:
-    void Hist3D(int32_t *vwt, int32_t *vmr, int32_t *vmg, int32_t *vmb, float *m2, int ReserveSize, FIRGBA8 *ReservePalette);
-	void M3D(int32_t *vwt, int32_t *vmr, int32_t *vmg, int32_t *vmb, float *m2);
-	int32_t Vol(Box *cube, int32_t *mmt);
-	int32_t Bottom(Box *cube, uint8_t dir, int32_t *mmt);
-	int32_t Top(Box *cube, uint8_t dir, int pos, int32_t *mmt);
+    void Hist3D(FIBITMAP *dib, uint16_t *qadd, int64_t *vwt, int64_t *vmr, int64_t *vmg, int64_t *vmb, double *m2);
+	void Reserve3D(int ReserveSize, FIRGBA8 *ReservePalette);
+	void M3D(int64_t *vwt, int64_t *vmr, int64_t *vmg, int64_t *vmb, double *m2);
+	int64_t Vol(Box *cube, int64_t *mmt);
+	int64_t Bottom(Box *cube, uint8_t dir, int64_t *mmt);
+	int64_t Top(Box *cube, uint8_t dir, int pos, int64_t *mmt);
 	float Var(Box *cube);
 	float Maximize(Box *cube, uint8_t dir, int first, int last , int *cut,
-				   int32_t whole_r, int32_t whole_g, int32_t whole_b, int32_t whole_w);
+				   int64_t whole_r, int64_t whole_g, int64_t whole_b, int64_t whole_w);
 	bool Cut(Box *set1, Box *set2);
 	void Mark(Box *cube, int label, uint8_t *tag);
+	int Partition(Box *cube, int PaletteSize);
+	void BuildPalette(Box *cube, int PaletteSize, FIRGBA8 *palette);
 
 public:
-	// Constructor - Input parameter: DIB 24-bit to be quantized
+	// Constructor - Input parameter: DIB 24-bit to be quantized, NULL when only ComputePalette is used
     WuQuantizer(FIBITMAP *dib);
 	// Destructor
 	~WuQuantizer();
 	// Quantizer - Return value: quantized 8-bit (color palette) DIB
 	FIBITMAP* Quantize(int PaletteSize, int ReserveSize, FIRGBA8 *ReservePalette);
+	// Palette of a set of 24-bit or 32-bit DIBs - Return value: number of colors, 0 on error
+	int ComputePalette(FIBITMAP **dibs, int count, int PaletteSize, int ReserveSize, FIRGBA8 *ReservePalette, FIRGBA8 *palette);
 };
 
 
@@ -190,7 +195,7 @@ protected:
 	void inxbuild();
 
 	/// Search for BGR values 0..255 (after net is unbiased) and return colour index
-	int inxsearch(int b, int g, int r);
+	int inxsearch(int b, int g, int r) const;
 
 	/// Search for biased BGR values
 	int contest(int b, int g, int r);
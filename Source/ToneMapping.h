@@ -35,11 +35,82 @@ FIBOOL LuminanceFromY(FIBITMAP *dib, float *maxLum, float *minLum, float *Lav, f
 
 void NormalizeY(FIBITMAP *Y, float minPrct, float maxPrct);
 
-FIBITMAP* ClampConvertRGBFTo24(FIBITMAP *src);
+FIBITMAP* ClampConvertRGBFTo24(FIBITMAP *src, FREE_IMAGE_DEPTH_DITHER dither);
 
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef __cplusplus
+
+// ----------------------------------------------------------
+//  Row functions for the fused tone mapping passes.
+//  Channels of a row are stored in separate arrays of PaddedWidth(width) values,
+//  so that they are processed 4 pixels at a time.
+// ----------------------------------------------------------
+
+/** Number of values of a row channel array */
+inline unsigned PaddedWidth(unsigned width) {
+	return (width + 3) & ~3U;
+}
+
+void SplitRGBFRow(const FIRGBF *src, unsigned width, float *r, float *g, float *b);
+void MergeRGBFRow(const float *r, const float *g, const float *b, unsigned width, FIRGBF *dst);
+
+/** In-place RGB to Yxy : on output r == Y, g == x, b == y */
+void ConvertRowRGBFToYxy(float *r, float *g, float *b, unsigned width);
+/** In-place Yxy to RGB : on input Y == Y, x == x, y == y */
+void ConvertRowYxyToRGBF(float *Y, float *x, float *y, unsigned width);
+/** Rec. 709 luminance, negative values are set to zero */
+void ConvertRowRGBFToY(const float *r, const float *g, const float *b, unsigned width, float *Y);
+/** Clamp to [0, 1] and convert to 24-bit pixels, rounded or dithered with the 16 thresholds of an ordered dithering row */
+void ConvertRowRGBFTo24(const float *r, const float *g, const float *b, unsigned width, uint8_t *dst, const float *thresholds = nullptr);
+
+/**
+Last stage of the tone mapping operators : rows of RGB values in [0, 1] to 24-bit pixels.
+Rounded and ordered dithered rows are written directly, from any thread.
+Error diffusion needs the rows in order : they are stored back to the working RGBF image, then diffused by Finish.
+*/
+class ToneMappedRows {
+public:
+	ToneMappedRows(FIBITMAP *rgbf, FIBITMAP *dst, FREE_IMAGE_DEPTH_DITHER dither)
+		: m_rgbf(rgbf), m_dst(dst), m_dither(dither) {
+	}
+
+	/** Store the row y, the channel arrays are not modified */
+	void StoreRow(unsigned y, const float *r, const float *g, const float *b, unsigned width) const;
+
+	/** Complete the 24-bit image once all the rows are stored */
+	void Finish() const;
+
+private:
+	FIBITMAP *m_rgbf;
+	FIBITMAP *m_dst;
+	FREE_IMAGE_DEPTH_DITHER m_dither;
+};
+
+// Operators with a dithered 24-bit output, see FreeImage_ToneMappingEx
+
+FIBITMAP* TmoDrago03(FIBITMAP *src, double gamma, double exposure, FREE_IMAGE_DEPTH_DITHER dither);
+FIBITMAP* TmoReinhard05Ex(FIBITMAP *src, double intensity, double contrast, double adaptation, double color_correction, FREE_IMAGE_DEPTH_DITHER dither);
+FIBITMAP* TmoFattal02(FIBITMAP *src, double color_saturation, double attenuation, FREE_IMAGE_DEPTH_DITHER dither);
+
+/**
+Luminance statistics, accumulated row by row.
+Negative (and NaN) luminance values count as 0.
+*/
+struct LuminanceStats {
+	float maxLum = -1e20F;
+	float minLum = 1e20F;
+	double sumLum = 0;		// sum of the luminance
+	double sumLogLum = 0;	// sum of log(2.3e-5 + luminance), contrast constant in Tumblin paper
+	double count = 0;
+
+	void Accumulate(const float *Y, unsigned width);
+	void Combine(const LuminanceStats& other);
+};
+
+#endif // __cplusplus
+
 #endif // FREEIMAGE_TONE_MAPPING_H
 
@@ -70,6 +70,13 @@
 void* FreeImage_Aligned_Malloc(size_t amount, size_t alignment);
 void FreeImage_Aligned_Free(void* mem);
 
+// Pixel format changes of an existing bitmap (see FreeImage_ConvertInPlace)
+// defined in BitmapAccess.cpp
+
+FIBOOL FreeImage_HasExternalBits(FIBITMAP *dib);
+void FreeImage_SetPixelFormat(FIBITMAP *dib, FIBITMAP *format);
+void FreeImage_ReplacePixels(FIBITMAP *dib, FIBITMAP *src);
+
 
 
 // ==========================================================
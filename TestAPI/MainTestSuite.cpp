@@ -115,6 +115,9 @@ int main(int argc, char *argv[]) {
 	testCreateView("exif.jpg", 0);
 #endif
 
+	// test GIF LZW codec
+	testGIF("sample.gif");
+
 #if FREEIMAGE_WITH_LIBTIFF
 	// test loading / saving / converting image types using the TIFF plugin
 	testImageTypeTIFF(width, height);
@@ -127,6 +130,15 @@ int main(int argc, char *argv[]) {
 #endif
 
 #if FREEIMAGE_WITH_LIBPNG
+	// test PNG encoder presets
+	testPNGEncode();
+
+	// test PNG row streaming decoder
+	testPNGDecode();
+
+	// test APNG reading / writing
+	testAPNG("sample.gif");
+
 	// test memory IO
 	testMemIO("sample.png");
 
@@ -137,6 +149,11 @@ int main(int argc, char *argv[]) {
 	testImageChannels(width, height);
 #endif
 
+#if FREEIMAGE_WITH_LIBWEBP
+	// test WebP still images and animations
+	testWebP("webp_out.webp");
+#endif
+
 #if FREEIMAGE_WITH_LIBJXR
 	// test memory IO
 	testMemIO("exif.jxr");
@@ -161,10 +178,29 @@ int main(int argc, char *argv[]) {
 	// other tests
 	testConvertToFloat();
 	testConvertToColor();
+	testConvertLineSIMD();
+	testConvertToType();
+	testConvertInPlace();
+	testDrawBitmap();
+	testPreMultiplyWithAlpha();
+	testRescaleLinearLight();
+	testBlur();
+	testConvolve();
 	testFindMinMax();
 	testTmoClamp();
 	testTmoLinear();
+	testTmoDrago03();
+	testTmoReinhard05();
+	testPoissonSolver();
+	testQuantize();
+	testDepthDither();
+	testRotate();
+	testWarpAffine();
+	testWarpPerspective();
 	testHistogram();
+	testImageStatistics();
+	testAdjustCurves();
+	testSplitMergeChannels();
 
 #if defined(FREEIMAGE_LIB) || !defined(WIN32)
 	FreeImage_DeInitialise();
@@ -0,0 +1,225 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+#ifndef TEST_REFERENCE_LZW_H
+#define TEST_REFERENCE_LZW_H
+
+#include "TestSuite.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// ----------------------------------------------------------
+//   Reference GIF LZW encoder
+//
+//   The string table compressor of PluginGIF.cpp before the
+//   hashed dictionary : a 1M entry map indexed by
+//   <prefix code << 8 | pixel>, cleared on every table reset.
+//   The tests check that the plugin output matches it byte
+//   for byte, the benchmarks compare both.
+// ----------------------------------------------------------
+
+class ReferenceLZWEncoder
+{
+public:
+	ReferenceLZWEncoder(int minCodeSize, int bpp, int width) : m_strmap(1 << 20) {
+		m_minCodeSize = minCodeSize;
+		m_clearCode = 1 << m_minCodeSize;
+		m_endCode = m_clearCode + 1;
+		m_bpp = bpp;
+		m_slack = (8 - ((width * bpp) % 8)) % 8;
+		m_partial = 0;
+		m_partialSize = 0;
+		m_firstPixelPassed = false;
+		m_bufferSize = m_bufferPos = m_bufferShift = 0;
+
+		ClearCompressorTable();
+		m_partial |= m_clearCode << m_partialSize;
+		m_partialSize += m_codeSize;
+		ClearCompressorTable();
+	}
+
+	uint8_t *FillInputBuffer(int len) {
+		m_buffer.resize(len);
+		m_bufferSize = len;
+		m_bufferPos = 0;
+		m_bufferShift = 8 - m_bpp;
+		return m_buffer.data();
+	}
+
+	bool Compress(uint8_t *buf, int *len) {
+		if (m_bufferSize == 0) {
+			return false;
+		}
+
+		const int mask = (1 << m_bpp) - 1;
+		uint8_t *bufpos = buf;
+		while (m_bufferPos < m_bufferSize) {
+			const int ch = (m_buffer[m_bufferPos] >> m_bufferShift) & mask;
+
+			if (m_firstPixelPassed) {
+				const int nextprefix = ((m_prefix << 8) & 0xFFF00) + ch;
+				if (m_strmap[nextprefix] > 0) {
+					m_prefix = m_strmap[nextprefix];
+				} else {
+					m_partial |= m_prefix << m_partialSize;
+					m_partialSize += m_codeSize;
+					while (m_partialSize >= 8 && bufpos - buf < *len) {
+						*bufpos++ = (uint8_t)m_partial;
+						m_partial >>= 8;
+						m_partialSize -= 8;
+					}
+
+					m_strmap[nextprefix] = m_nextCode;
+					if (m_nextCode == (1 << m_codeSize)) {
+						m_codeSize++;
+					}
+					m_nextCode++;
+
+					if (m_nextCode == 4096) {
+						m_partial |= m_clearCode << m_partialSize;
+						m_partialSize += m_codeSize;
+						ClearCompressorTable();
+					}
+
+					m_prefix = ch;
+				}
+			} else {
+				m_firstPixelPassed = true;
+				m_prefix = ch;
+			}
+
+			if (m_bufferShift > 0 && !(m_bufferPos + 1 == m_bufferSize && m_bufferShift <= m_slack)) {
+				m_bufferShift -= m_bpp;
+			} else {
+				m_bufferPos++;
+				m_bufferShift = 8 - m_bpp;
+			}
+
+			if (bufpos - buf == *len) {
+				return true;
+			}
+		}
+
+		m_bufferSize = 0;
+		*len = (int)(bufpos - buf);
+		return true;
+	}
+
+	int CompressEnd(uint8_t *buf) {
+		int len = 0;
+		m_partial |= m_prefix << m_partialSize;
+		m_partialSize += m_codeSize;
+		while (m_partialSize >= 8) {
+			*buf++ = (uint8_t)m_partial;
+			m_partial >>= 8;
+			m_partialSize -= 8;
+			len++;
+		}
+		m_partial |= m_endCode << m_partialSize;
+		m_partialSize += m_codeSize;
+		while (m_partialSize > 0) {
+			*buf++ = (uint8_t)m_partial;
+			m_partial >>= 8;
+			m_partialSize -= 8;
+			len++;
+		}
+		return len;
+	}
+
+private:
+	int m_minCodeSize, m_clearCode, m_endCode, m_nextCode;
+	int m_bpp, m_slack;
+	int m_prefix;
+	int m_codeSize;
+	int m_partial, m_partialSize;
+	bool m_firstPixelPassed;
+
+	std::vector<int> m_strmap;
+
+	std::vector<uint8_t> m_buffer;
+	int m_bufferSize, m_bufferPos, m_bufferShift;
+
+	void ClearCompressorTable() {
+		memset(m_strmap.data(), 0xFF, m_strmap.size() * sizeof(int));
+		m_nextCode = m_endCode + 1;
+		m_prefix = 0;
+		m_codeSize = m_minCodeSize + 1;
+	}
+};
+
+/**
+Encode the pixels of a 1-, 4- or 8-bit image the way the GIF writer did before the hashed dictionary : 
+LZW minimum code size, image data sub-blocks and block terminator.
+*/
+inline std::vector<uint8_t>
+encodeReferenceLZW(FIBITMAP *dib, bool interlaced) {
+	static const int interlace_offset[] = { 0, 4, 2, 1 };
+	static const int interlace_increment[] = { 8, 8, 4, 2 };
+	const int bpp = (int)FreeImage_GetBPP(dib);
+	const int width = (int)FreeImage_GetWidth(dib);
+	const int height = (int)FreeImage_GetHeight(dib);
+	const int line = (int)FreeImage_GetLine(dib);
+
+	std::vector<uint8_t> data;
+	const uint8_t minCodeSize = (uint8_t)(bpp == 1 ? 2 : bpp);
+	data.push_back(minCodeSize);
+	ReferenceLZWEncoder encoder(minCodeSize, bpp, width);
+
+	uint8_t buf[255], *bufptr = buf;
+	int size = sizeof(buf);
+	int y = 0, pass = 0;
+	while (y < height) {
+		memcpy(encoder.FillInputBuffer(line), FreeImage_GetScanLine(dib, height - y - 1), line);
+		while (encoder.Compress(bufptr, &size)) {
+			bufptr += size;
+			if (bufptr - buf == sizeof(buf)) {
+				data.push_back((uint8_t)sizeof(buf));
+				data.insert(data.end(), buf, buf + sizeof(buf));
+				size = sizeof(buf);
+				bufptr = buf;
+			} else {
+				size = (int)(sizeof(buf) - (bufptr - buf));
+			}
+		}
+		if (interlaced) {
+			y += interlace_increment[pass];
+			if (y >= height && ++pass < 4) {
+				y = interlace_offset[pass];
+			}
+		} else {
+			y++;
+		}
+	}
+
+	// the last codes may spill over into a tiny additional sub-block
+	size = (int)(bufptr - buf);
+	uint8_t last[4];
+	const int w = encoder.CompressEnd(last);
+	std::vector<uint8_t> tail(buf, buf + size);
+	tail.insert(tail.end(), last, last + w);
+	for (size_t pos = 0; pos < tail.size(); pos += sizeof(buf)) {
+		const size_t count = std::min(tail.size() - pos, sizeof(buf));
+		data.push_back((uint8_t)count);
+		data.insert(data.end(), tail.begin() + pos, tail.begin() + pos + count);
+	}
+	data.push_back(0);
+	return data;
+}
+
+#endif // TEST_REFERENCE_LZW_H
@@ -30,6 +30,8 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 
+#include <memory>
+
 #if (defined(WIN32) || defined(__WIN32__))
 #if (defined(_DEBUG))
 #include <crtdbg.h>
@@ -40,6 +42,16 @@
 // Some useful tools
 // ==========================================================
 FIBITMAP* createZonePlateImage(unsigned width, unsigned height, int scale);
+unsigned nextRandom(unsigned& seed);
+void fillRandom(FIBITMAP *dib, unsigned seed);
+FIBITMAP* createAnimationFrame(unsigned width, unsigned height, int frame);
+FIBITMAP* createScreenshot(unsigned width, unsigned height);
+
+/** Bitmaps and memory streams released when they go out of scope */
+using UniqueBitmap = std::unique_ptr<FIBITMAP, decltype(&::FreeImage_Unload)>;
+using UniqueMemory = std::unique_ptr<FIMEMORY, decltype(&::FreeImage_CloseMemory)>;
+
+UniqueBitmap makePattern(FREE_IMAGE_TYPE type, unsigned width, unsigned height, unsigned bpp = 0);
 
 // Test plugins capabilities
 // ==========================================================
@@ -77,10 +89,28 @@ void testMultiPageMemory(const char *lpszPathName);
 
 void testJPEG();
 
+// GIF test suite
+// ==========================================================
+
+void testGIF(const char *lpszPathName);
+
+// PNG test suite
+// ==========================================================
+
+void testPNGEncode();
+void testPNGDecode();
+void testAPNG(const char *lpszPathName);
+
+// WebP test suite
+// ==========================================================
+
+void testWebP(const char *lpszPathName);
+
 // Channels test suite
 // ==========================================================
 
 void testImageChannels(unsigned width, unsigned height);
+void testSplitMergeChannels();
 
 
 // Thumbnails test suite
@@ -99,10 +129,28 @@ void testCreateView(const char *lpszPathName, int flags);
 
 void testConvertToFloat();
 void testConvertToColor();
+void testConvertLineSIMD();
+void testConvertToType();
+void testConvertInPlace();
+void testDrawBitmap();
+void testPreMultiplyWithAlpha();
+void testRescaleLinearLight();
+void testBlur();
+void testConvolve();
 void testFindMinMax();
 void testTmoClamp();
 void testTmoLinear();
+void testTmoDrago03();
+void testTmoReinhard05();
+void testPoissonSolver();
+void testQuantize();
+void testDepthDither();
+void testRotate();
+void testWarpAffine();
+void testWarpPerspective();
 void testHistogram();
+void testImageStatistics();
+void testAdjustCurves();
 void testHeif(FREE_IMAGE_FORMAT fif, const char* src_path, const char* dst_path);
 void testJpegXl(FREE_IMAGE_FORMAT fif, const char* src_path, const char* dst_path);
 
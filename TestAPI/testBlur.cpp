@@ -0,0 +1,173 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------
+
+namespace {
+
+	/** Box blur of a 24-bit image computed by direct summation, edges are repeated */
+	double referenceBox(FIBITMAP *dib, int x, int y, int c, int radius) {
+		const int width = FreeImage_GetWidth(dib);
+		const int height = FreeImage_GetHeight(dib);
+		double sum = 0;
+		for (int j = y - radius; j <= y + radius; j++) {
+			const uint8_t *bits = FreeImage_GetScanLine(dib, std::clamp(j, 0, height - 1));
+			for (int i = x - radius; i <= x + radius; i++) {
+				sum += bits[3 * std::clamp(i, 0, width - 1) + c];
+			}
+		}
+		return sum / ((2 * radius + 1) * (2 * radius + 1));
+	}
+
+	/** Check that an image has the value of its first pixel everywhere */
+	bool isFlat(FIBITMAP *dib) {
+		const unsigned line = FreeImage_GetLine(dib);
+		const unsigned pixel = FreeImage_GetBPP(dib) / 8;
+		const uint8_t *first = FreeImage_GetScanLine(dib, 0);
+		for (unsigned y = 0; y < FreeImage_GetHeight(dib); y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(dib, y);
+			for (unsigned x = 0; x < line; x++) {
+				if (bits[x] != first[x % pixel]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+} // namespace
+
+/**
+Test FreeImage_BoxBlur, FreeImage_GaussianBlur and FreeImage_UnsharpMask
+*/
+void testBlur() {
+	printf("testBlur ...\n");
+
+	// box blur against a direct summation
+	{
+		UniqueBitmap dib(FreeImage_Allocate(37, 23, 24), &::FreeImage_Unload);
+		fillRandom(dib.get(), 1);
+		for (int radius : { 0, 1, 3, 50 }) {
+			UniqueBitmap blurred(FreeImage_BoxBlur(dib.get(), radius), &::FreeImage_Unload);
+			assert(blurred && FreeImage_GetBPP(blurred.get()) == 24);
+			for (int y = 0; y < 23; y++) {
+				const uint8_t *bits = FreeImage_GetScanLine(blurred.get(), y);
+				for (int x = 0; x < 37; x++) {
+					for (int c = 0; c < 3; c++) {
+						assert(std::fabs(bits[3 * x + c] - referenceBox(dib.get(), x, y, c, radius)) <= 0.5 + 1e-3);
+					}
+				}
+			}
+		}
+		assert(!FreeImage_BoxBlur(dib.get(), -1));
+	}
+
+	// Gaussian impulse response : unit sum, variance sigma^2 along each axis
+	{
+		const int size = 201, center = 100;
+		UniqueBitmap impulse(FreeImage_AllocateT(FIT_DOUBLE, size, size), &::FreeImage_Unload);
+		((double*)FreeImage_GetScanLine(impulse.get(), center))[center] = 1;
+		for (double sigma : { 0.7, 2.0, 5.5, 15.0 }) {
+			UniqueBitmap blurred(FreeImage_GaussianBlur(impulse.get(), sigma), &::FreeImage_Unload);
+			assert(blurred);
+			double sum = 0, variance_x = 0, variance_y = 0;
+			for (int y = 0; y < size; y++) {
+				const double *bits = (double*)FreeImage_GetScanLine(blurred.get(), y);
+				for (int x = 0; x < size; x++) {
+					sum += bits[x];
+					variance_x += bits[x] * (x - center) * (x - center);
+					variance_y += bits[x] * (y - center) * (y - center);
+				}
+			}
+			assert(std::fabs(sum - 1) < 1e-9);
+			assert(std::fabs(variance_x - sigma * sigma) < 1e-6 * sigma * sigma);
+			assert(std::fabs(variance_y - sigma * sigma) < 1e-6 * sigma * sigma);
+			// three box passes are a quadratic spline : the peak is within 7% of the Gaussian peak along each axis
+			const double peak = ((double*)FreeImage_GetScanLine(blurred.get(), center))[center];
+			const double gaussian_peak = 1 / (2 * 3.14159265358979 * sigma * sigma);
+			assert(std::fabs(peak - gaussian_peak) < 0.2 * gaussian_peak);
+		}
+	}
+
+	// flat images of every supported type stay flat
+	{
+		const FREE_IMAGE_TYPE types[] = { FIT_UINT16, FIT_INT16, FIT_UINT32, FIT_INT32, FIT_FLOAT, FIT_DOUBLE, FIT_RGB16, FIT_RGBA16, FIT_RGBF, FIT_RGBAF };
+		for (FREE_IMAGE_TYPE type : types) {
+			UniqueBitmap dib(FreeImage_AllocateT(type, 29, 17), &::FreeImage_Unload);
+			const unsigned pixel = FreeImage_GetBPP(dib.get()) / 8;
+			std::vector<uint8_t> value(pixel);
+			for (unsigned i = 0; i < pixel; i++) {
+				value[i] = (uint8_t)(0x35 + i);
+			}
+			assert(FreeImage_Fill(dib.get(), value.data(), pixel));
+			UniqueBitmap box(FreeImage_BoxBlur(dib.get(), 4), &::FreeImage_Unload);
+			UniqueBitmap gaussian(FreeImage_GaussianBlur(dib.get(), 3), &::FreeImage_Unload);
+			UniqueBitmap sharp(FreeImage_UnsharpMask(dib.get(), 3, 1.5), &::FreeImage_Unload);
+			assert(box && gaussian && sharp);
+			assert(FreeImage_GetImageType(box.get()) == type);
+			if ((type != FIT_FLOAT) && (type != FIT_RGBF) && (type != FIT_RGBAF)) {
+				assert(isFlat(box.get()) && isFlat(gaussian.get()) && isFlat(sharp.get()));
+			}
+		}
+		UniqueBitmap grey(FreeImage_Allocate(16, 16, 8), &::FreeImage_Unload);
+		UniqueBitmap grey_blurred(FreeImage_GaussianBlur(grey.get(), 2), &::FreeImage_Unload);
+		assert(grey_blurred && FreeImage_GetBPP(grey_blurred.get()) == 8);
+	}
+
+	// unsharp mask : overshoot at an edge, alpha and small details are kept
+	{
+		UniqueBitmap dib(FreeImage_Allocate(32, 8, 32), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 8; y++) {
+			FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < 32; x++) {
+				const uint8_t v = (x < 16) ? 60 : 180;
+				bits[x].red = bits[x].green = bits[x].blue = v;
+				bits[x].alpha = (uint8_t)(x * 8);
+			}
+		}
+		UniqueBitmap sharp(FreeImage_UnsharpMask(dib.get(), 1.5, 1.0), &::FreeImage_Unload);
+		assert(sharp);
+		const FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(sharp.get(), 4);
+		assert(bits[15].red < 60 && bits[16].red > 180);
+		assert(bits[0].red == 60 && bits[31].red == 180);
+		for (unsigned x = 0; x < 32; x++) {
+			assert(bits[x].alpha == x * 8);
+		}
+		UniqueBitmap kept(FreeImage_UnsharpMask(dib.get(), 1.5, 1.0, 200), &::FreeImage_Unload);
+		assert(memcmp(FreeImage_GetBits(kept.get()), FreeImage_GetBits(dib.get()), FreeImage_GetPitch(dib.get()) * 8) == 0);
+	}
+
+	// unsupported images
+	{
+		UniqueBitmap dib4(FreeImage_Allocate(16, 16, 4), &::FreeImage_Unload);
+		assert(!FreeImage_GaussianBlur(dib4.get(), 1));
+		UniqueBitmap palette(FreeImage_Allocate(16, 16, 8), &::FreeImage_Unload);
+		FreeImage_GetPalette(palette.get())[3].red = 200;
+		assert(!FreeImage_BoxBlur(palette.get(), 1));
+		UniqueBitmap complex(FreeImage_AllocateT(FIT_COMPLEX, 16, 16), &::FreeImage_Unload);
+		assert(!FreeImage_UnsharpMask(complex.get(), 1, 1));
+	}
+}
@@ -21,6 +21,9 @@
 
 
 #include "TestSuite.h"
+#include <cstring>
+#include <random>
+#include <vector>
 
 // Local test functions
 // ----------------------------------------------------------
@@ -125,3 +128,154 @@ void testImageChannels(unsigned width, unsigned height) {
 	testRGBAChannels(FIT_RGBF, width, height, FALSE);
 	testRGBAChannels(FIT_RGBAF, width, height, TRUE);
 }
+
+/**
+Fill an image with random values, floats in [0, 1]
+*/
+static void fillRandomImage(FIBITMAP *dib, std::mt19937& rng) {
+	const unsigned height = FreeImage_GetHeight(dib);
+	const unsigned line = FreeImage_GetLine(dib);
+	const bool is_float = (FreeImage_GetImageType(dib) == FIT_RGBF) || (FreeImage_GetImageType(dib) == FIT_RGBAF);
+	std::uniform_real_distribution<float> unit(0.F, 1.F);
+	for (unsigned y = 0; y < height; y++) {
+		uint8_t *bits = FreeImage_GetScanLine(dib, y);
+		if (is_float) {
+			float *values = (float*)bits;
+			for (unsigned i = 0; i < line / sizeof(float); i++) {
+				values[i] = unit(rng);
+			}
+		}
+		else {
+			for (unsigned i = 0; i < line; i++) {
+				bits[i] = (uint8_t)rng();
+			}
+		}
+	}
+}
+
+/**
+Check that the first width pixels of the rows of two images are the same
+*/
+static bool equalImages(FIBITMAP *a, FIBITMAP *b) {
+	if ((FreeImage_GetImageType(a) != FreeImage_GetImageType(b)) || (FreeImage_GetBPP(a) != FreeImage_GetBPP(b))
+		|| (FreeImage_GetWidth(a) != FreeImage_GetWidth(b)) || (FreeImage_GetHeight(a) != FreeImage_GetHeight(b))) {
+		return false;
+	}
+	const size_t row_bytes = (size_t)FreeImage_GetWidth(a) * FreeImage_GetBPP(a) / 8;
+	for (unsigned y = 0; y < FreeImage_GetHeight(a); y++) {
+		if (memcmp(FreeImage_GetScanLine(a, y), FreeImage_GetScanLine(b, y), row_bytes) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+Split and merge round trips of every RGB[A] type, at every SIMD level supported by the CPU,
+checked against FreeImage_GetChannel
+*/
+void testSplitMergeChannels() {
+	printf("testSplitMergeChannels ...\n");
+
+	const FREE_IMAGE_SIMD initial_level = FreeImage_GetSIMDLevel();
+	std::vector<FREE_IMAGE_SIMD> levels = { FISIMD_NONE };
+	for (FREE_IMAGE_SIMD level : { FISIMD_SSSE3, FISIMD_AVX2, FISIMD_NEON }) {
+		if (FreeImage_SetSIMDLevel(level)) {
+			levels.push_back(level);
+		}
+	}
+
+	struct ImageFormat {
+		FREE_IMAGE_TYPE type;
+		unsigned bpp;
+		unsigned channels;
+		FREE_IMAGE_TYPE plane_type;
+	};
+	const ImageFormat formats[] = {
+		{ FIT_BITMAP, 24, 3, FIT_BITMAP }, { FIT_BITMAP, 32, 4, FIT_BITMAP },
+		{ FIT_RGB16, 48, 3, FIT_UINT16 }, { FIT_RGBA16, 64, 4, FIT_UINT16 },
+		{ FIT_RGBF, 96, 3, FIT_FLOAT }, { FIT_RGBAF, 128, 4, FIT_FLOAT }
+	};
+	const FREE_IMAGE_COLOR_CHANNEL colors[] = { FICC_RED, FICC_GREEN, FICC_BLUE, FICC_ALPHA };
+
+	std::mt19937 rng(1234);
+	const unsigned height = 5;
+	for (FREE_IMAGE_SIMD level : levels) {
+		assert(FreeImage_SetSIMDLevel(level));
+		for (const ImageFormat& format : formats) {
+			for (unsigned width : { 1U, 5U, 16U, 31U, 64U, 67U, 130U }) {
+				FIBITMAP *src = FreeImage_AllocateT(format.type, width, height, format.bpp);
+				assert(src != NULL);
+				fillRandomImage(src, rng);
+
+				// split, against one channel at a time
+				FIBITMAP *channels[4] = {};
+				assert(FreeImage_SplitChannels(src, channels));
+				for (unsigned c = 0; c < format.channels; c++) {
+					assert(channels[c] != NULL);
+					assert(FreeImage_GetImageType(channels[c]) == format.plane_type);
+					FIBITMAP *channel = FreeImage_GetChannel(src, colors[c]);
+					assert(equalImages(channels[c], channel));
+					FreeImage_Unload(channel);
+				}
+
+				// merge
+				FIBITMAP *merged = FreeImage_MergeChannels(channels, format.channels);
+				assert(merged != NULL);
+				assert(equalImages(merged, src));
+				FreeImage_Unload(merged);
+
+				// planar buffer, bottom-up rows of padded planes
+				const unsigned pitch = width * (FreeImage_GetBPP(channels[0]) / 8) + 12;
+				std::vector<uint8_t> buffer((size_t)format.channels * height * pitch);
+				assert(FreeImage_ConvertToPlanarBits(buffer.data(), src, pitch, FALSE));
+				FIBITMAP *planes[4] = {};
+				assert(FreeImage_CreatePlanarView(buffer.data(), format.plane_type, width, height, pitch, format.channels, planes));
+				for (unsigned c = 0; c < format.channels; c++) {
+					assert(equalImages(planes[c], channels[c]));
+				}
+				merged = FreeImage_MergeChannels(planes, format.channels);
+				assert(merged != NULL);
+				assert(equalImages(merged, src));
+				FreeImage_Unload(merged);
+				for (unsigned c = 0; c < format.channels; c++) {
+					FreeImage_Unload(planes[c]);
+				}
+
+				// top-down packed planes
+				const size_t packed_row = (size_t)width * (FreeImage_GetBPP(channels[0]) / 8);
+				assert(FreeImage_ConvertToPlanarBits(buffer.data(), src, 0, TRUE));
+				for (unsigned c = 0; c < format.channels; c++) {
+					for (unsigned y = 0; y < height; y++) {
+						const uint8_t *row = buffer.data() + (c * height + (height - 1 - y)) * packed_row;
+						assert(memcmp(row, FreeImage_GetScanLine(channels[c], y), packed_row) == 0);
+					}
+				}
+
+				for (unsigned c = 0; c < format.channels; c++) {
+					FreeImage_Unload(channels[c]);
+				}
+				FreeImage_Unload(src);
+			}
+		}
+	}
+	FreeImage_SetSIMDLevel(initial_level);
+
+	// unsupported images
+	{
+		FIBITMAP *channels[4] = {};
+		FIBITMAP *src = FreeImage_Allocate(16, 16, 8);
+		assert(!FreeImage_SplitChannels(src, channels));
+		assert(FreeImage_MergeChannels(channels, 3) == NULL);
+		FreeImage_Unload(src);
+
+		channels[0] = FreeImage_AllocateT(FIT_UINT16, 16, 16);
+		channels[1] = FreeImage_AllocateT(FIT_UINT16, 16, 16);
+		channels[2] = FreeImage_AllocateT(FIT_UINT16, 16, 15);
+		assert(FreeImage_MergeChannels(channels, 3) == NULL);
+		assert(FreeImage_MergeChannels(channels, 2) == NULL);
+		for (FIBITMAP *channel : channels) {
+			FreeImage_Unload(channel);
+		}
+	}
+}
@@ -21,6 +21,9 @@
 
 
 #include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <memory>
 #include <limits>
 #include <vector>
@@ -161,3 +164,288 @@ void testHistogram()
 	assert(hist[31] == 0);
 }
 
+
+/**
+Test FreeImage_GetStatistics against per channel scans and FreeImage_MakeHistogram
+*/
+void testImageStatistics()
+{
+	printf("testImageStatistics ...\n");
+
+	// 24-bit : every channel matches a direct computation and FreeImage_GetHistogram
+	{
+		const unsigned width = 1000, height = 700;
+		UniqueBitmap bmp(FreeImage_Allocate(width, height, 24), &::FreeImage_Unload);
+		uint32_t seed = 12345;
+		for (unsigned y = 0; y < height; y++) {
+			uint8_t *bits = FreeImage_GetScanLine(bmp.get(), y);
+			for (unsigned x = 0; x < width; x++, bits += 3) {
+				seed = seed * 1664525u + 1013904223u;
+				bits[FI_RGBA_RED] = (uint8_t)(20 + (seed >> 24) % 200);
+				bits[FI_RGBA_GREEN] = (uint8_t)((x + y) % 256);
+				bits[FI_RGBA_BLUE] = (uint8_t)(100 + (x % 7));
+			}
+		}
+
+		FISTATISTICS stats;
+		std::vector<uint32_t> hist(3 * 256);
+		assert(FreeImage_GetStatistics(bmp.get(), &stats, 256, hist.data()));
+		assert(stats.channels == 3);
+
+		const unsigned offsets[3] = { FI_RGBA_RED, FI_RGBA_GREEN, FI_RGBA_BLUE };
+		for (unsigned c = 0; c < 3; c++) {
+			std::vector<uint32_t> expected(256);
+			double sum = 0, sum2 = 0;
+			unsigned lo = 255, hi = 0;
+			for (unsigned y = 0; y < height; y++) {
+				const uint8_t *bits = FreeImage_GetScanLine(bmp.get(), y);
+				for (unsigned x = 0; x < width; x++) {
+					const unsigned v = bits[3 * x + offsets[c]];
+					expected[v]++;
+					sum += v;
+					sum2 += (double)v * v;
+					lo = std::min(lo, v);
+					hi = std::max(hi, v);
+				}
+			}
+			const double n = (double)width * height;
+			const double mean = sum / n;
+			assert(stats.count[c] == width * height);
+			assert(stats.min[c] == lo && stats.max[c] == hi);
+			assert(std::abs(stats.mean[c] - mean) < 1e-9);
+			assert(std::abs(stats.stddev[c] - std::sqrt(sum2 / n - mean * mean)) < 1e-6);
+
+			assert(std::equal(expected.begin(), expected.end(), hist.begin() + c * 256));
+
+			std::vector<uint32_t> made(256);
+			uint8_t histMin{}, histMax{};
+			assert(FreeImage_MakeHistogram(bmp.get(), 256, &histMin, &histMax, c == 0 ? made.data() : nullptr, 1, c == 1 ? made.data() : nullptr, 1, c == 2 ? made.data() : nullptr, 1));
+			assert(made == expected);
+		}
+	}
+
+	// large values with a small spread : the deviation does not cancel out
+	{
+		const unsigned width = 300, height = 200;
+		UniqueBitmap bmp(FreeImage_AllocateT(FIT_DOUBLE, width, height), &::FreeImage_Unload);
+		UniqueBitmap bmp16(FreeImage_AllocateT(FIT_UINT16, width, height), &::FreeImage_Unload);
+		for (unsigned y = 0; y < height; y++) {
+			double *bits = (double*)FreeImage_GetScanLine(bmp.get(), y);
+			uint16_t *bits16 = (uint16_t*)FreeImage_GetScanLine(bmp16.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				bits[x] = 1e9 + (((x + y) % 2) ? 0.5 : -0.5);
+				bits16[x] = (uint16_t)(65000 + ((x + y) % 2));
+			}
+		}
+		FISTATISTICS stats;
+		assert(FreeImage_GetStatistics(bmp.get(), &stats, 0, nullptr));
+		assert(std::abs(stats.mean[0] - 1e9) < 1e-6);
+		assert(std::abs(stats.stddev[0] - 0.5) < 1e-6);
+		assert(FreeImage_GetStatistics(bmp16.get(), &stats, 0, nullptr));
+		assert(std::abs(stats.mean[0] - 65000.5) < 1e-9);
+		assert(std::abs(stats.stddev[0] - 0.5) < 1e-9);
+	}
+
+	// floating point : NaN values are ignored, the bins span the range of each channel
+	{
+		UniqueBitmap bmp(FreeImage_AllocateT(FIT_FLOAT, 100, 50), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 50; y++) {
+			float *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(bmp.get(), y));
+			for (unsigned x = 0; x < 100; x++) {
+				bits[x] = (x == 7) ? std::numeric_limits<float>::quiet_NaN() : -2.0f + 0.04f * x;
+			}
+		}
+		FISTATISTICS stats;
+		uint32_t hist[4] = {};
+		assert(FreeImage_GetStatistics(bmp.get(), &stats, 4, hist));
+		assert(stats.channels == 1 && stats.count[0] == 99 * 50);
+		assert(stats.min[0] == -2.0 && std::abs(stats.max[0] - (-2.0 + 0.04 * 99)) < 1e-5);
+		assert(hist[0] + hist[1] + hist[2] + hist[3] == 99 * 50);
+		assert(hist[0] == 24 * 50 && hist[3] == 25 * 50);
+	}
+
+	// signed 16-bit values keep their sign
+	{
+		UniqueBitmap bmp(FreeImage_AllocateT(FIT_INT16, 40, 3), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 3; y++) {
+			int16_t *bits = reinterpret_cast<int16_t*>(FreeImage_GetScanLine(bmp.get(), y));
+			for (unsigned x = 0; x < 40; x++) {
+				bits[x] = (int16_t)(x * 100 - 1500 + y);
+			}
+		}
+		int16_t minVal = 0, maxVal = 0;
+		assert(FreeImage_FindMinMaxValue(bmp.get(), &minVal, &maxVal));
+		assert(minVal == -1500 && maxVal == 2402);
+		FISTATISTICS stats;
+		assert(FreeImage_GetStatistics(bmp.get(), &stats));
+		assert(stats.min[0] == -1500 && stats.max[0] == 2402);
+		assert(std::abs(stats.mean[0] - (1950 - 1500 + 1)) < 1e-9);
+	}
+
+	// auto-levels input : one statistics pass against min / max and a histogram of every channel
+	{
+		const unsigned width = 515, height = 341;
+		UniqueBitmap bmp(FreeImage_Allocate(width, height, 24), &::FreeImage_Unload);
+		for (unsigned y = 0; y < height; y++) {
+			uint8_t *bits = FreeImage_GetScanLine(bmp.get(), y);
+			for (unsigned x = 0; x < 3 * width; x++) {
+				bits[x] = (uint8_t)(x * 7 + y * 3 + (x * y >> 5));
+			}
+		}
+		std::vector<uint32_t> hist(3 * 256), hist2(3 * 256);
+		FISTATISTICS stats;
+		assert(FreeImage_GetStatistics(bmp.get(), &stats, 256, hist.data()));
+
+		FIRGB8 minVal, maxVal;
+		uint8_t histMin{}, histMax{};
+		assert(FreeImage_FindMinMaxValue(bmp.get(), &minVal, &maxVal));
+		assert(FreeImage_MakeHistogram(bmp.get(), 256, &histMin, &histMax, hist2.data(), 1, hist2.data() + 256, 1, hist2.data() + 512, 1));
+		assert(stats.min[0] == minVal.red && stats.max[2] == maxVal.blue);
+		assert(hist == hist2);
+	}
+}
+
+/**
+Test the 16-bit and float paths of FreeImage_AdjustColors and the fused per channel curves
+*/
+void testAdjustCurves()
+{
+	printf("testAdjustCurves ...\n");
+
+	// the 16-bit lookup table is the 8-bit one at 16-bit precision
+	{
+		uint8_t lut8[256];
+		std::vector<uint16_t> lut16(65536);
+		assert(FreeImage_GetAdjustColorsLookupTable(lut8, 20.0, -15.0, 1.8, TRUE) == 4);
+		assert(FreeImage_GetAdjustColorsLookupTable16(lut16.data(), 20.0, -15.0, 1.8, TRUE) == 4);
+		for (unsigned v = 0; v < 256; v++) {
+			assert(std::abs(lut16[v * 257] / 257.0 - lut8[v]) <= 1.0);
+		}
+		assert(FreeImage_GetAdjustColorsLookupTable16(lut16.data(), 0, 0, 1.0, FALSE) == 0);
+		for (unsigned v = 0; v < 65536; v++) {
+			assert(lut16[v] == v);
+		}
+	}
+
+	// fused curves : every channel gets its own table, NULL leaves a channel alone
+	{
+		const unsigned width = 300, height = 200;
+		UniqueBitmap bmp(FreeImage_AllocateT(FIT_RGBA16, width, height), &::FreeImage_Unload);
+		for (unsigned y = 0; y < height; y++) {
+			FIRGBA16 *bits = reinterpret_cast<FIRGBA16*>(FreeImage_GetScanLine(bmp.get(), y));
+			for (unsigned x = 0; x < width; x++) {
+				bits[x].red = (uint16_t)(x * 211 + y);
+				bits[x].green = (uint16_t)(y * 307);
+				bits[x].blue = (uint16_t)(x * y);
+				bits[x].alpha = (uint16_t)(65535 - x);
+			}
+		}
+		std::vector<uint16_t> square(65536), reverse(65536), half(65536);
+		for (unsigned v = 0; v < 65536; v++) {
+			square[v] = (uint16_t)((uint64_t)v * v / 65535);
+			reverse[v] = (uint16_t)(65535 - v);
+			half[v] = (uint16_t)(v / 2);
+		}
+		assert(FreeImage_AdjustChannelCurves(bmp.get(), square.data(), nullptr, reverse.data(), half.data()));
+		assert(FreeImage_AdjustCurve16(bmp.get(), half.data(), FICC_GREEN));
+		for (unsigned y = 0; y < height; y++) {
+			const FIRGBA16 *bits = reinterpret_cast<FIRGBA16*>(FreeImage_GetScanLine(bmp.get(), y));
+			for (unsigned x = 0; x < width; x++) {
+				assert(bits[x].red == square[(uint16_t)(x * 211 + y)]);
+				assert(bits[x].green == (uint16_t)(y * 307) / 2);
+				assert(bits[x].blue == reverse[(uint16_t)(x * y)]);
+				assert(bits[x].alpha == (65535 - x) / 2);
+			}
+		}
+	}
+
+	// 32-bit : the fused pass gives the same pixels as one FreeImage_AdjustCurve per channel
+	{
+		const unsigned width = 257, height = 99;
+		UniqueBitmap fused(FreeImage_Allocate(width, height, 32), &::FreeImage_Unload);
+		for (unsigned y = 0; y < height; y++) {
+			uint8_t *bits = FreeImage_GetScanLine(fused.get(), y);
+			for (unsigned x = 0; x < 4 * width; x++) {
+				bits[x] = (uint8_t)(x * 13 + y * 5);
+			}
+		}
+		UniqueBitmap separate(FreeImage_Clone(fused.get()), &::FreeImage_Unload);
+		uint8_t luts[4][256];
+		for (unsigned c = 0; c < 4; c++) {
+			for (unsigned v = 0; v < 256; v++) {
+				luts[c][v] = (uint8_t)(v * (c + 3) + c);
+			}
+		}
+		assert(FreeImage_AdjustChannelCurves(fused.get(), luts[0], luts[1], luts[2], luts[3]));
+		assert(FreeImage_AdjustCurve(separate.get(), luts[0], FICC_RED));
+		assert(FreeImage_AdjustCurve(separate.get(), luts[1], FICC_GREEN));
+		assert(FreeImage_AdjustCurve(separate.get(), luts[2], FICC_BLUE));
+		assert(FreeImage_AdjustCurve(separate.get(), luts[3], FICC_ALPHA));
+		for (unsigned y = 0; y < height; y++) {
+			assert(memcmp(FreeImage_GetScanLine(fused.get(), y), FreeImage_GetScanLine(separate.get(), y), 4 * width) == 0);
+		}
+	}
+
+	// float : the piecewise cubic path follows the exact adjustment, alpha is left alone
+	{
+		const double brightness = 10.0, contrast = 25.0, gamma = 2.2;
+		const auto exact = [&](double v) {
+			const double middle = 128.0 / 255.0;
+			v = std::clamp(v, 0.0, 1.0);
+			v = std::clamp(middle + (v - middle) * (100.0 + contrast) / 100.0, 0.0, 1.0);
+			v = std::clamp(v * (100.0 + brightness) / 100.0, 0.0, 1.0);
+			return 1.0 - std::pow(v, 1 / gamma);
+		};
+		const unsigned width = 1000, height = 10;
+		UniqueBitmap bmp(FreeImage_AllocateT(FIT_RGBAF, width, height), &::FreeImage_Unload);
+		for (unsigned y = 0; y < height; y++) {
+			FIRGBAF *bits = reinterpret_cast<FIRGBAF*>(FreeImage_GetScanLine(bmp.get(), y));
+			for (unsigned x = 0; x < width; x++) {
+				bits[x].red = (float)x / (width - 1);
+				bits[x].green = (float)(x * 7 % width) / width + 0.0001f * y;
+				bits[x].blue = 1.5f - (float)x / 500;
+				bits[x].alpha = 0.25f;
+			}
+		}
+		UniqueBitmap src(FreeImage_Clone(bmp.get()), &::FreeImage_Unload);
+		assert(FreeImage_AdjustColors(bmp.get(), brightness, contrast, gamma, TRUE));
+		double error = 0;
+		for (unsigned y = 0; y < height; y++) {
+			const FIRGBAF *bits = reinterpret_cast<FIRGBAF*>(FreeImage_GetScanLine(bmp.get(), y));
+			const FIRGBAF *orig = reinterpret_cast<FIRGBAF*>(FreeImage_GetScanLine(src.get(), y));
+			for (unsigned x = 0; x < width; x++) {
+				error = std::max(error, std::abs(bits[x].red - exact(orig[x].red)));
+				error = std::max(error, std::abs(bits[x].green - exact(orig[x].green)));
+				error = std::max(error, std::abs(bits[x].blue - exact(orig[x].blue)));
+				assert(bits[x].alpha == 0.25f);
+			}
+		}
+		assert(error < 1e-4);
+		assert(!FreeImage_AdjustColors(bmp.get(), 0, 0, 1.0, FALSE));
+	}
+
+	// colour grading of a 16-bit master : one fused pass against one curve per channel
+	{
+		const unsigned width = 515, height = 341;
+		UniqueBitmap bmp(FreeImage_AllocateT(FIT_RGB16, width, height), &::FreeImage_Unload);
+		for (unsigned y = 0; y < height; y++) {
+			uint16_t *bits = reinterpret_cast<uint16_t*>(FreeImage_GetScanLine(bmp.get(), y));
+			for (unsigned x = 0; x < 3 * width; x++) {
+				bits[x] = (uint16_t)(x * 37 + y * 101);
+			}
+		}
+		std::vector<uint16_t> luts[3];
+		for (unsigned c = 0; c < 3; c++) {
+			luts[c].resize(65536);
+			assert(FreeImage_GetAdjustColorsLookupTable16(luts[c].data(), 5.0 * c, 10.0, 1.0 + 0.2 * c, FALSE));
+		}
+		UniqueBitmap copy(FreeImage_Clone(bmp.get()), &::FreeImage_Unload);
+		assert(FreeImage_AdjustChannelCurves(bmp.get(), luts[0].data(), luts[1].data(), luts[2].data()));
+		assert(FreeImage_AdjustCurve16(copy.get(), luts[0].data(), FICC_RED));
+		assert(FreeImage_AdjustCurve16(copy.get(), luts[1].data(), FICC_GREEN));
+		assert(FreeImage_AdjustCurve16(copy.get(), luts[2].data(), FICC_BLUE));
+		for (unsigned y = 0; y < height; y++) {
+			assert(memcmp(FreeImage_GetScanLine(bmp.get(), y), FreeImage_GetScanLine(copy.get(), y), 6 * width) == 0);
+		}
+	}
+}
@@ -0,0 +1,258 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------
+
+/**
+Fill a greyscale image with a pattern, the extreme values being in the first and last rows
+*/
+template <class T>
+static void
+fillPattern(FIBITMAP *dib, T min_value, T max_value) {
+	const unsigned width = FreeImage_GetWidth(dib);
+	const unsigned height = FreeImage_GetHeight(dib);
+	for (unsigned y = 0; y < height; y++) {
+		T *bits = reinterpret_cast<T*>(FreeImage_GetScanLine(dib, y));
+		for (unsigned x = 0; x < width; x++) {
+			const double t = (double)((x * 7 + y * 13) % 1000) / 1000.0;
+			bits[x] = (T)(min_value + 0.25 * (max_value - min_value) + t * 0.5 * (max_value - min_value));
+		}
+	}
+	reinterpret_cast<T*>(FreeImage_GetScanLine(dib, height - 1))[width / 2] = min_value;
+	reinterpret_cast<T*>(FreeImage_GetScanLine(dib, 0))[width / 3] = max_value;
+}
+
+/**
+Check a conversion to 8-bit with linear scaling against a reference computed here
+*/
+template <class T>
+static void
+checkScaleToByte(FREE_IMAGE_TYPE type, unsigned width, unsigned height, T min_value, T max_value) {
+	UniqueBitmap src(FreeImage_AllocateT(type, width, height), &::FreeImage_Unload);
+	assert(src != nullptr);
+	fillPattern<T>(src.get(), min_value, max_value);
+
+	UniqueBitmap dst(FreeImage_ConvertToType(src.get(), FIT_BITMAP, TRUE), &::FreeImage_Unload);
+	assert(dst != nullptr);
+	assert(FreeImage_GetBPP(dst.get()) == 8);
+
+	// same rule as the library : the range starts from [0, 255]
+	const T range_min = (T)std::min<double>(min_value, 255);
+	const T range_max = (T)std::max<double>(max_value, 0);
+	const double scale = 255 / (double)(range_max - range_min);
+	for (unsigned y = 0; y < height; y++) {
+		const T *src_bits = reinterpret_cast<T*>(FreeImage_GetScanLine(src.get(), y));
+		const uint8_t *dst_bits = FreeImage_GetScanLine(dst.get(), y);
+		for (unsigned x = 0; x < width; x++) {
+			assert(dst_bits[x] == (uint8_t)(scale * (src_bits[x] - range_min) + 0.5));
+		}
+	}
+	// the extreme values were found
+	assert(FreeImage_GetScanLine(dst.get(), height - 1)[width / 2] == 0);
+	assert(FreeImage_GetScanLine(dst.get(), 0)[width / 3] == 255);
+}
+
+/**
+Test FreeImage_ConvertToType on greyscale scientific images
+*/
+void testConvertToType() {
+	printf("testConvertToType ...\n");
+
+	// sizes below and above the parallel threshold, odd widths for MAXMIN
+	checkScaleToByte<uint16_t>(FIT_UINT16, 7, 3, 100, 60000);
+	checkScaleToByte<uint16_t>(FIT_UINT16, 1023, 771, 300, 40000);
+	checkScaleToByte<int16_t>(FIT_INT16, 640, 480, -20000, 30000);
+	checkScaleToByte<uint32_t>(FIT_UINT32, 333, 1000, 1000, 4000000);
+	checkScaleToByte<float>(FIT_FLOAT, 1024, 768, -1.5f, 2.5f);
+	checkScaleToByte<double>(FIT_DOUBLE, 801, 601, 0.0, 1e6);
+
+	// rounding to 8-bit
+	{
+		const unsigned width = 1000, height = 700;
+		UniqueBitmap src(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+		assert(src != nullptr);
+		fillPattern<float>(src.get(), -100.0f, 400.0f);
+		UniqueBitmap dst(FreeImage_ConvertToType(src.get(), FIT_BITMAP, FALSE), &::FreeImage_Unload);
+		assert(dst != nullptr);
+		for (unsigned y = 0; y < height; y++) {
+			const float *src_bits = reinterpret_cast<float*>(FreeImage_GetScanLine(src.get(), y));
+			const uint8_t *dst_bits = FreeImage_GetScanLine(dst.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				const int q = int(src_bits[x] + 0.5);
+				assert(dst_bits[x] == (uint8_t)std::clamp(q, 0, 255));
+			}
+		}
+	}
+
+	// widening and complex conversions
+	{
+		const unsigned width = 900, height = 500;
+		UniqueBitmap src(FreeImage_AllocateT(FIT_INT16, width, height), &::FreeImage_Unload);
+		assert(src != nullptr);
+		fillPattern<int16_t>(src.get(), -30000, 30000);
+
+		UniqueBitmap dbl(FreeImage_ConvertToType(src.get(), FIT_DOUBLE, FALSE), &::FreeImage_Unload);
+		UniqueBitmap cpx(FreeImage_ConvertToType(src.get(), FIT_COMPLEX, FALSE), &::FreeImage_Unload);
+		assert(dbl != nullptr && cpx != nullptr);
+		for (unsigned y = 0; y < height; y++) {
+			const int16_t *src_bits = reinterpret_cast<int16_t*>(FreeImage_GetScanLine(src.get(), y));
+			const double *dbl_bits = reinterpret_cast<double*>(FreeImage_GetScanLine(dbl.get(), y));
+			const FICOMPLEX *cpx_bits = reinterpret_cast<FICOMPLEX*>(FreeImage_GetScanLine(cpx.get(), y));
+			for (unsigned x = 0; x < width; x++) {
+				assert(dbl_bits[x] == (double)src_bits[x]);
+				assert((cpx_bits[x].r == (double)src_bits[x]) && (cpx_bits[x].i == 0));
+			}
+		}
+	}
+}
+
+// ----------------------------------------------------------
+
+/**
+Compare two images of the same format, pixel data only
+*/
+static bool
+samePixels(FIBITMAP *a, FIBITMAP *b) {
+	if ((FreeImage_GetImageType(a) != FreeImage_GetImageType(b)) || (FreeImage_GetBPP(a) != FreeImage_GetBPP(b))) {
+		return false;
+	}
+	if ((FreeImage_GetWidth(a) != FreeImage_GetWidth(b)) || (FreeImage_GetHeight(a) != FreeImage_GetHeight(b))) {
+		return false;
+	}
+	for (unsigned y = 0; y < FreeImage_GetHeight(a); y++) {
+		if (memcmp(FreeImage_GetScanLine(a, y), FreeImage_GetScanLine(b, y), FreeImage_GetLine(a)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+Convert an image in place and compare the result with the allocating conversion
+*/
+static void
+checkConvertInPlace(FREE_IMAGE_TYPE src_type, unsigned src_bpp, FREE_IMAGE_TYPE dst_type, unsigned dst_bpp, bool in_place) {
+	const unsigned width = 1001, height = 333;
+
+	UniqueBitmap dib(FreeImage_AllocateT(src_type, width, height, src_bpp), &::FreeImage_Unload);
+	assert(dib != nullptr);
+	fillRandom(dib.get(), src_type * 100 + src_bpp);
+	if ((src_type == FIT_FLOAT) || (src_type == FIT_RGBF) || (src_type == FIT_RGBAF)) {
+		// avoid NaN values, which do not compare equal
+		FreeImage_Unload(dib.release());
+		dib.reset(FreeImage_AllocateT(src_type, width, height));
+		for (unsigned y = 0; y < height; y++) {
+			float *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(dib.get(), y));
+			const unsigned count = width * FreeImage_GetBPP(dib.get()) / 32;
+			for (unsigned x = 0; x < count; x++) {
+				bits[x] = (float)((x * 31 + y * 17) % 1000) / 500.0f;
+			}
+		}
+	}
+	FreeImage_SetMetadataKeyValue(FIMD_COMMENTS, dib.get(), "Comment", "in place");
+
+	FIBITMAP *reference = nullptr;
+	if (dst_type == FIT_BITMAP) {
+		reference = (dst_bpp == 24) ? FreeImage_ConvertTo24Bits(dib.get()) : (dst_bpp == 32) ? FreeImage_ConvertTo32Bits(dib.get()) : FreeImage_ConvertTo8Bits(dib.get());
+	} else {
+		reference = FreeImage_ConvertToType(dib.get(), dst_type, TRUE);
+	}
+	UniqueBitmap expected(reference, &::FreeImage_Unload);
+	assert(expected != nullptr);
+
+	const uint8_t *bits = FreeImage_GetBits(dib.get());
+	assert(FreeImage_ConvertInPlace(dib.get(), dst_type, dst_bpp));
+	assert((FreeImage_GetBits(dib.get()) == bits) == in_place);
+	assert(samePixels(dib.get(), expected.get()));
+	assert(FreeImage_GetPitch(dib.get()) == FreeImage_GetPitch(expected.get()));
+
+	// the bitmap keeps its metadata
+	FITAG *tag = nullptr;
+	assert(FreeImage_GetMetadata(FIMD_COMMENTS, dib.get(), "Comment", &tag));
+	assert(strcmp((const char*)FreeImage_GetTagValue(tag), "in place") == 0);
+}
+
+/**
+Test FreeImage_ConvertInPlace
+*/
+void testConvertInPlace() {
+	printf("testConvertInPlace ...\n");
+
+	// narrowing conversions reuse the pixel buffer
+	checkConvertInPlace(FIT_BITMAP, 32, FIT_BITMAP, 24, true);
+	checkConvertInPlace(FIT_RGBA16, 64, FIT_RGB16, 0, true);
+	checkConvertInPlace(FIT_RGBA16, 64, FIT_BITMAP, 32, true);
+	checkConvertInPlace(FIT_RGB16, 48, FIT_BITMAP, 24, true);
+	checkConvertInPlace(FIT_RGBA16, 64, FIT_UINT16, 0, true);
+	checkConvertInPlace(FIT_RGBAF, 128, FIT_RGBF, 0, true);
+	checkConvertInPlace(FIT_RGBF, 96, FIT_FLOAT, 0, true);
+	checkConvertInPlace(FIT_FLOAT, 32, FIT_UINT16, 0, true);
+
+	// wider pixels or a palette need a new buffer
+	checkConvertInPlace(FIT_BITMAP, 24, FIT_BITMAP, 32, false);
+	checkConvertInPlace(FIT_BITMAP, 24, FIT_BITMAP, 8, false);
+	checkConvertInPlace(FIT_RGB16, 48, FIT_RGBAF, 0, false);
+
+	// unknown conversions leave the image unchanged
+	{
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_RGBF, 16, 16), &::FreeImage_Unload);
+		assert(!FreeImage_ConvertInPlace(dib.get(), FIT_COMPLEX));
+		assert(!FreeImage_ConvertInPlace(dib.get(), FIT_BITMAP, 7));
+		assert(FreeImage_GetImageType(dib.get()) == FIT_RGBF);
+	}
+
+	// wrapped buffers and views are converted into a new buffer, the memory they share is left unchanged
+	{
+		const unsigned width = 100, height = 50, pitch = 512;
+		std::vector<uint8_t> buffer(pitch * height);
+		UniqueBitmap dib(FreeImage_AllocateHeaderForBits(buffer.data(), pitch, FIT_BITMAP, width, height, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK), &::FreeImage_Unload);
+		assert(dib != nullptr);
+		fillRandom(dib.get(), 42);
+		const std::vector<uint8_t> original = buffer;
+		UniqueBitmap expected(FreeImage_ConvertTo24Bits(dib.get()), &::FreeImage_Unload);
+		assert(FreeImage_ConvertInPlace(dib.get(), FIT_BITMAP, 24));
+		assert(FreeImage_GetBits(dib.get()) != buffer.data());
+		assert(buffer == original);
+		assert(samePixels(dib.get(), expected.get()));
+	}
+	{
+		UniqueBitmap parent(FreeImage_AllocateT(FIT_RGBAF, 64, 48), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 48; y++) {
+			float *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(parent.get(), y));
+			for (unsigned x = 0; x < 64 * 4; x++) {
+				bits[x] = (float)((x * 31 + y * 17) % 1000) / 500.0f;
+			}
+		}
+		UniqueBitmap original(FreeImage_Clone(parent.get()), &::FreeImage_Unload);
+		UniqueBitmap view(FreeImage_CreateView(parent.get(), 8, 4, 40, 36), &::FreeImage_Unload);
+		assert(view != nullptr);
+		UniqueBitmap expected(FreeImage_ConvertToType(view.get(), FIT_RGBF, TRUE), &::FreeImage_Unload);
+		assert(FreeImage_ConvertInPlace(view.get(), FIT_RGBF));
+		assert(FreeImage_GetImageType(view.get()) == FIT_RGBF && samePixels(view.get(), expected.get()));
+		assert(samePixels(parent.get(), original.get()));
+	}
+}
@@ -0,0 +1,122 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+// ----------------------------------------------------------
+
+using LineConverter = std::function<void(uint8_t *target, uint8_t *source, int width)>;
+
+struct LineConversion {
+	const char *name;
+	unsigned src_bpp;
+	unsigned dst_bpp;
+	LineConverter convert;
+};
+
+/**
+Convert a line at the current SIMD level.
+The target buffer is surrounded by guard bytes, checked for overwrites.
+*/
+static std::vector<uint8_t>
+convertLine(const LineConversion& conversion, std::vector<uint8_t>& source, int width) {
+	const size_t guard = 64;
+	const size_t size = (size_t)width * conversion.dst_bpp / 8;
+	std::vector<uint8_t> target(size + 2 * guard, 0xA5);
+	conversion.convert(target.data() + guard, source.data(), width);
+	for (size_t i = 0; i < guard; i++) {
+		assert(target[i] == 0xA5);
+		assert(target[guard + size + i] == 0xA5);
+	}
+	return std::vector<uint8_t>(target.begin() + guard, target.begin() + guard + size);
+}
+
+/**
+Check the SIMD line conversion kernels against the scalar code, at every level supported by the CPU
+*/
+void testConvertLineSIMD() {
+	printf("testConvertLineSIMD ...\n");
+
+	const FREE_IMAGE_SIMD initial_level = FreeImage_GetSIMDLevel();
+
+	std::mt19937 rng(1234);
+	std::vector<FIRGBA8> palette(256);
+	for (auto& color : palette) {
+		const uint32_t value = rng();
+		memcpy(&color, &value, sizeof(color));
+	}
+
+	const LineConversion conversions[] = {
+		{ "24To32", 24, 32, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine24To32(t, s, w); } },
+		{ "32To24", 32, 24, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine32To24(t, s, w); } },
+		{ "24To8", 24, 8, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine24To8(t, s, w); } },
+		{ "32To8", 32, 8, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine32To8(t, s, w); } },
+		{ "16To24_555", 16, 24, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To24_555(t, s, w); } },
+		{ "16To24_565", 16, 24, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To24_565(t, s, w); } },
+		{ "16To32_555", 16, 32, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To32_555(t, s, w); } },
+		{ "16To32_565", 16, 32, [](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine16To32_565(t, s, w); } },
+		{ "8To32", 8, 32, [&palette](uint8_t *t, uint8_t *s, int w) { FreeImage_ConvertLine8To32(t, s, w, palette.data()); } }
+	};
+
+	std::vector<FREE_IMAGE_SIMD> levels;
+	for (FREE_IMAGE_SIMD level : { FISIMD_SSSE3, FISIMD_AVX2, FISIMD_NEON }) {
+		if (FreeImage_SetSIMDLevel(level)) {
+			levels.push_back(level);
+		}
+	}
+	// unsupported levels are rejected
+	assert(levels.size() < 3);
+	assert(FreeImage_SetSIMDLevel(FISIMD_NONE));
+	assert(FreeImage_GetSIMDLevel() == FISIMD_NONE);
+
+	// every line width up to a few vectors, then a large one
+	std::vector<int> widths;
+	for (int width = 0; width <= 100; width++) {
+		widths.push_back(width);
+	}
+	widths.push_back(1921);
+
+	for (const auto& conversion : conversions) {
+		for (int width : widths) {
+			// the source line is exactly sized so that overreads are caught by memory checkers
+			std::vector<uint8_t> source((size_t)width * conversion.src_bpp / 8);
+			for (auto& value : source) {
+				value = (uint8_t)rng();
+			}
+
+			FreeImage_SetSIMDLevel(FISIMD_NONE);
+			const std::vector<uint8_t> expected = convertLine(conversion, source, width);
+
+			for (FREE_IMAGE_SIMD level : levels) {
+				FreeImage_SetSIMDLevel(level);
+				const std::vector<uint8_t> result = convertLine(conversion, source, width);
+				if (result != expected) {
+					printf("%s : mismatch at SIMD level %d, width %d\n", conversion.name, (int)level, width);
+					assert(false);
+				}
+			}
+		}
+	}
+
+	FreeImage_SetSIMDLevel(initial_level);
+}
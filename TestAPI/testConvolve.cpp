@@ -0,0 +1,257 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------
+
+namespace {
+
+	/** Sample i of a line of n samples for a border mode, -1 outside of the line with FIBM_ZERO */
+	int borderIndex(int i, int n, FREE_IMAGE_BORDER_MODE border) {
+		switch (border) {
+			case FIBM_CLAMP:
+				return std::clamp(i, 0, n - 1);
+			case FIBM_MIRROR:
+				while ((i < 0) || (i >= n)) {
+					i = (i < 0) ? -i : 2 * (n - 1) - i;
+					if (n == 1) {
+						i = 0;
+					}
+				}
+				return i;
+			case FIBM_WRAP:
+				return ((i % n) + n) % n;
+			default:
+				return ((i < 0) || (i >= n)) ? -1 : i;
+		}
+	}
+
+	/**
+	Convolution of the channel c of a pixel by direct summation.
+	x and y are display coordinates (top-down), the kernel is given top-down.
+	*/
+	template <typename Value>
+	double referenceConvolve(FIBITMAP *dib, unsigned channels, int x, int y, int c, const double *kernel, int kw, int kh, FREE_IMAGE_BORDER_MODE border) {
+		const int width = FreeImage_GetWidth(dib);
+		const int height = FreeImage_GetHeight(dib);
+		double sum = 0;
+		for (int ky = 0; ky < kh; ky++) {
+			const int sy = borderIndex(y + ky - kh / 2, height, border);
+			for (int kx = 0; kx < kw; kx++) {
+				const int sx = borderIndex(x + kx - kw / 2, width, border);
+				if ((sx >= 0) && (sy >= 0)) {
+					const Value *bits = (const Value*)FreeImage_GetScanLine(dib, height - 1 - sy);
+					sum += kernel[ky * kw + kx] * bits[channels * sx + c];
+				}
+			}
+		}
+		return sum;
+	}
+
+	/** Erosion (or dilation) of an 8-bit image by direct search, pixels outside of the image are ignored */
+	int referenceMorphology(FIBITMAP *dib, int x, int y, const uint8_t *element, int ew, int eh, bool dilate) {
+		const int width = FreeImage_GetWidth(dib);
+		const int height = FreeImage_GetHeight(dib);
+		int result = dilate ? 0 : 255;
+		for (int ky = 0; ky < eh; ky++) {
+			const int sy = y + ky - eh / 2;
+			for (int kx = 0; kx < ew; kx++) {
+				const int sx = x + kx - ew / 2;
+				if ((sx < 0) || (sx >= width) || (sy < 0) || (sy >= height) || (element && !element[ky * ew + kx])) {
+					continue;
+				}
+				const int v = FreeImage_GetScanLine(dib, height - 1 - sy)[sx];
+				result = dilate ? std::max(result, v) : std::min(result, v);
+			}
+		}
+		return result;
+	}
+
+	void checkMorphology(FIBITMAP *dib, int ew, int eh, const uint8_t *element) {
+		const int width = FreeImage_GetWidth(dib);
+		const int height = FreeImage_GetHeight(dib);
+		UniqueBitmap eroded(FreeImage_Erode(dib, ew, eh, element), &::FreeImage_Unload);
+		UniqueBitmap dilated(FreeImage_Dilate(dib, ew, eh, element), &::FreeImage_Unload);
+		assert(eroded && dilated);
+		for (int y = 0; y < height; y++) {
+			const uint8_t *e = FreeImage_GetScanLine(eroded.get(), height - 1 - y);
+			const uint8_t *d = FreeImage_GetScanLine(dilated.get(), height - 1 - y);
+			for (int x = 0; x < width; x++) {
+				assert(e[x] == referenceMorphology(dib, x, y, element, ew, eh, false));
+				assert(d[x] == referenceMorphology(dib, x, y, element, ew, eh, true));
+			}
+		}
+	}
+
+} // namespace
+
+/**
+Test FreeImage_Convolve, FreeImage_Erode and FreeImage_Dilate
+*/
+void testConvolve() {
+	printf("testConvolve ...\n");
+
+	const FREE_IMAGE_BORDER_MODE borders[] = { FIBM_CLAMP, FIBM_MIRROR, FIBM_WRAP, FIBM_ZERO };
+
+	struct Kernel {
+		int width, height;
+		std::vector<double> values;
+	};
+	std::vector<Kernel> kernels = {
+		// not separable, asymmetric
+		{ 3, 3, { 1, 2, 0, -1, 0.5, 3, 0, 0, -2 } },
+		{ 4, 2, { 1, 0, 0, 2, 0, 3, 1, 0 } },
+		// single row, single column, larger than the image
+		{ 7, 1, { 1, -2, 3, 0.5, 0, 1, 2 } },
+		{ 1, 5, { 2, 0, -1, 1, 3 } },
+		{ 31, 1, std::vector<double>(31, 1.0 / 31) },
+		{ 1, 1, { 2 } },
+	};
+	{
+		// separable, asymmetric : column x row
+		const double column[] = { 1, 2, -1 };
+		const double row[] = { 0.5, 1, 3, -1, 2 };
+		Kernel separable = { 5, 3, {} };
+		for (double c : column) {
+			for (double r : row) {
+				separable.values.push_back(c * r);
+			}
+		}
+		kernels.push_back(separable);
+	}
+
+	// floating point image against a direct summation, every border mode
+	{
+		const int width = 23, height = 17;
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+		unsigned seed = 1;
+		for (int y = 0; y < height; y++) {
+			float *bits = (float*)FreeImage_GetScanLine(dib.get(), y);
+			for (int x = 0; x < width; x++) {
+				bits[x] = (float)(nextRandom(seed) % 1000) / 10.0f;
+			}
+		}
+		for (const Kernel& kernel : kernels) {
+			for (FREE_IMAGE_BORDER_MODE border : borders) {
+				UniqueBitmap result(FreeImage_Convolve(dib.get(), kernel.values.data(), kernel.width, kernel.height, border), &::FreeImage_Unload);
+				assert(result && FreeImage_GetImageType(result.get()) == FIT_FLOAT);
+				for (int y = 0; y < height; y++) {
+					const float *bits = (const float*)FreeImage_GetScanLine(result.get(), height - 1 - y);
+					for (int x = 0; x < width; x++) {
+						const double expected = referenceConvolve<float>(dib.get(), 1, x, y, 0, kernel.values.data(), kernel.width, kernel.height, border);
+						assert(std::fabs(bits[x] - expected) < 1e-3 * std::max(1.0, std::fabs(expected)));
+					}
+				}
+			}
+		}
+	}
+
+	// 24-bit image : results are rounded and clamped
+	{
+		const int width = 37, height = 19;
+		UniqueBitmap dib(FreeImage_Allocate(width, height, 24), &::FreeImage_Unload);
+		fillRandom(dib.get(), 2);
+		const double sharpen[] = { 0, -1, 0, -1, 5, -1, 0, -1, 0 };
+		UniqueBitmap result(FreeImage_Convolve(dib.get(), sharpen, 3, 3, FIBM_MIRROR), &::FreeImage_Unload);
+		assert(result && FreeImage_GetBPP(result.get()) == 24);
+		for (int y = 0; y < height; y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(result.get(), height - 1 - y);
+			for (int x = 0; x < width; x++) {
+				for (int c = 0; c < 3; c++) {
+					const double expected = std::clamp(referenceConvolve<uint8_t>(dib.get(), 3, x, y, c, sharpen, 3, 3, FIBM_MIRROR), 0.0, 255.0);
+					assert(std::fabs(bits[3 * x + c] - expected) <= 0.5 + 1e-3);
+				}
+			}
+		}
+	}
+
+	// erosion and dilation against a direct search
+	{
+		UniqueBitmap dib(FreeImage_Allocate(41, 29, 8), &::FreeImage_Unload);
+		fillRandom(dib.get(), 3);
+		const int sizes[][2] = { { 1, 1 }, { 3, 3 }, { 2, 2 }, { 7, 5 }, { 16, 1 }, { 1, 9 }, { 33, 3 }, { 50, 40 } };
+		for (const auto& size : sizes) {
+			checkMorphology(dib.get(), size[0], size[1], nullptr);
+		}
+		const uint8_t cross[] = {
+			0, 0, 1, 0, 0,
+			0, 0, 1, 0, 0,
+			1, 1, 1, 1, 1,
+			0, 0, 1, 0, 0,
+			0, 0, 1, 0, 0
+		};
+		checkMorphology(dib.get(), 5, 5, cross);
+		const uint8_t corner[] = {
+			1, 0, 0,
+			1, 1, 1
+		};
+		checkMorphology(dib.get(), 3, 2, corner);
+		const uint8_t full[] = { 1, 1, 1, 1, 1, 1 };
+		checkMorphology(dib.get(), 3, 2, full);
+	}
+
+	// other types : channels are filtered separately
+	{
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_RGBA16, 9, 7), &::FreeImage_Unload);
+		FIRGBA16 *bits = (FIRGBA16*)FreeImage_GetScanLine(dib.get(), 3);
+		bits[4] = { 1000, 2000, 3000, 4000 };
+		UniqueBitmap dilated(FreeImage_Dilate(dib.get(), 3, 3), &::FreeImage_Unload);
+		UniqueBitmap eroded(FreeImage_Erode(dilated.get(), 3, 3), &::FreeImage_Unload);
+		assert(dilated && eroded);
+		for (unsigned y = 0; y < 7; y++) {
+			const FIRGBA16 *d = (const FIRGBA16*)FreeImage_GetScanLine(dilated.get(), y);
+			const FIRGBA16 *e = (const FIRGBA16*)FreeImage_GetScanLine(eroded.get(), y);
+			for (unsigned x = 0; x < 9; x++) {
+				const bool inside = (x >= 3) && (x <= 5) && (y >= 2) && (y <= 4);
+				assert(d[x].red == (inside ? 1000 : 0) && d[x].alpha == (inside ? 4000 : 0));
+				// closing of a single pixel gives it back
+				const bool center = (x == 4) && (y == 3);
+				assert(e[x].green == (center ? 2000 : 0) && e[x].blue == (center ? 3000 : 0));
+			}
+		}
+
+		UniqueBitmap grey(FreeImage_AllocateT(FIT_FLOAT, 8, 8), &::FreeImage_Unload);
+		((float*)FreeImage_GetScanLine(grey.get(), 0))[0] = -std::numeric_limits<float>::infinity();
+		UniqueBitmap eroded_grey(FreeImage_Erode(grey.get(), 5, 5), &::FreeImage_Unload);
+		assert(eroded_grey);
+		assert(std::isinf(((float*)FreeImage_GetScanLine(eroded_grey.get(), 2))[2]));
+		assert(((float*)FreeImage_GetScanLine(eroded_grey.get(), 3))[2] == 0);
+	}
+
+	// invalid parameters and unsupported images
+	{
+		UniqueBitmap dib(FreeImage_Allocate(16, 16, 24), &::FreeImage_Unload);
+		const double kernel[] = { 1 };
+		assert(!FreeImage_Convolve(dib.get(), nullptr, 1, 1));
+		assert(!FreeImage_Convolve(dib.get(), kernel, 0, 1));
+		assert(!FreeImage_Erode(dib.get(), 3, -1));
+		const uint8_t empty[] = { 0, 0, 0, 0 };
+		assert(!FreeImage_Dilate(dib.get(), 2, 2, empty));
+		UniqueBitmap palette(FreeImage_Allocate(16, 16, 8), &::FreeImage_Unload);
+		FreeImage_GetPalette(palette.get())[3].red = 200;
+		assert(!FreeImage_Convolve(palette.get(), kernel, 1, 1));
+		assert(!FreeImage_Erode(palette.get(), 3, 3));
+	}
+}
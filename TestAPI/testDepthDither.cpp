@@ -0,0 +1,177 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace {
+
+	/** RGB16 ramp spanning a few 8-bit levels, where rounding shows bands */
+	UniqueBitmap makeRamp16(unsigned width, unsigned height) {
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_RGB16, width, height), &::FreeImage_Unload);
+		for (unsigned y = 0; y < height; y++) {
+			auto *pixel = reinterpret_cast<FIRGB16*>(FreeImage_GetScanLine(dib.get(), y));
+			for (unsigned x = 0; x < width; x++) {
+				pixel[x].red = (uint16_t)(20000 + 4 * 257 * x / width);
+				pixel[x].green = (uint16_t)(40000 + 2 * 257 * y / height);
+				pixel[x].blue = 1000;
+			}
+		}
+		return dib;
+	}
+
+	/** Mean error of the 16x16 block averages of a 24-bit image against the exact RGB16 values */
+	double blockError(FIBITMAP *src, FIBITMAP *dst) {
+		const unsigned width = FreeImage_GetWidth(src), height = FreeImage_GetHeight(src);
+		double error = 0;
+		unsigned blocks = 0;
+		for (unsigned by = 0; by + 16 <= height; by += 16) {
+			for (unsigned bx = 0; bx + 16 <= width; bx += 16, blocks++) {
+				double diff[3] = {};
+				for (unsigned y = by; y < by + 16; y++) {
+					const auto *pixel = reinterpret_cast<const FIRGB16*>(FreeImage_GetScanLine(src, y));
+					const uint8_t *bits = FreeImage_GetScanLine(dst, y);
+					for (unsigned x = bx; x < bx + 16; x++) {
+						diff[0] += pixel[x].red / 257.0 - bits[3 * x + FI_RGBA_RED];
+						diff[1] += pixel[x].green / 257.0 - bits[3 * x + FI_RGBA_GREEN];
+						diff[2] += pixel[x].blue / 257.0 - bits[3 * x + FI_RGBA_BLUE];
+					}
+				}
+				error += (std::abs(diff[0]) + std::abs(diff[1]) + std::abs(diff[2])) / 256;
+			}
+		}
+		return error / blocks;
+	}
+
+	double meanValue(FIBITMAP *dib) {
+		double sum = 0;
+		for (unsigned y = 0; y < FreeImage_GetHeight(dib); y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(dib, y);
+			for (unsigned x = 0; x < FreeImage_GetWidth(dib); x++) {
+				sum += bits[x];
+			}
+		}
+		return sum / ((double)FreeImage_GetWidth(dib) * FreeImage_GetHeight(dib));
+	}
+
+} // namespace
+
+void testDepthDither()
+{
+	printf("testDepthDither ...\n");
+
+	// RGB16 to 24-bit : dithering keeps the local average of the 16-bit values
+	{
+		UniqueBitmap src = makeRamp16(256, 128);
+		UniqueBitmap none(FreeImage_ConvertToStandardTypeEx(src.get(), TRUE, FIDD_NONE), &::FreeImage_Unload);
+		UniqueBitmap ordered(FreeImage_ConvertToStandardTypeEx(src.get(), TRUE, FIDD_ORDERED), &::FreeImage_Unload);
+		UniqueBitmap diffused(FreeImage_ConvertToStandardTypeEx(src.get(), TRUE, FIDD_FLOYD_STEINBERG), &::FreeImage_Unload);
+		assert(none != nullptr && ordered != nullptr && diffused != nullptr);
+		assert(FreeImage_GetBPP(none.get()) == 24 && FreeImage_GetImageType(none.get()) == FIT_BITMAP);
+		const double none_error = blockError(src.get(), none.get());
+		assert(blockError(src.get(), ordered.get()) < 0.25 * none_error);
+		assert(blockError(src.get(), diffused.get()) < 0.25 * none_error);
+	}
+
+	// RGBA16 to 32-bit : the alpha channel is rounded, not dithered
+	{
+		UniqueBitmap src(FreeImage_AllocateT(FIT_RGBA16, 64, 32), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 32; y++) {
+			auto *pixel = reinterpret_cast<FIRGBA16*>(FreeImage_GetScanLine(src.get(), y));
+			for (unsigned x = 0; x < 64; x++) {
+				pixel[x] = { 300, 65535, 0, 0x8080 };
+			}
+		}
+		for (FREE_IMAGE_DEPTH_DITHER dither : { FIDD_NONE, FIDD_ORDERED, FIDD_FLOYD_STEINBERG }) {
+			UniqueBitmap dst(FreeImage_ConvertToStandardTypeEx(src.get(), TRUE, dither), &::FreeImage_Unload);
+			assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == 32);
+			for (unsigned y = 0; y < 32; y++) {
+				const uint8_t *bits = FreeImage_GetScanLine(dst.get(), y);
+				for (unsigned x = 0; x < 64; x++, bits += 4) {
+					assert(bits[FI_RGBA_ALPHA] == 128 && bits[FI_RGBA_GREEN] == 255 && bits[FI_RGBA_BLUE] == 0);
+					assert(bits[FI_RGBA_RED] <= 2);
+				}
+			}
+		}
+	}
+
+	// RGBF to 24-bit : values are clamped to [0, 1], NaN gives 0
+	{
+		UniqueBitmap src(FreeImage_AllocateT(FIT_RGBF, 40, 20), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 20; y++) {
+			auto *pixel = reinterpret_cast<FIRGBF*>(FreeImage_GetScanLine(src.get(), y));
+			for (unsigned x = 0; x < 40; x++) {
+				pixel[x] = { 2.F, -1.F, std::numeric_limits<float>::quiet_NaN() };
+			}
+		}
+		for (FREE_IMAGE_DEPTH_DITHER dither : { FIDD_NONE, FIDD_ORDERED, FIDD_FLOYD_STEINBERG }) {
+			UniqueBitmap dst(FreeImage_ConvertToStandardTypeEx(src.get(), TRUE, dither), &::FreeImage_Unload);
+			assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == 24);
+			const uint8_t *bits = FreeImage_GetScanLine(dst.get(), 10) + 3 * 20;
+			assert(bits[FI_RGBA_RED] == 255 && bits[FI_RGBA_GREEN] == 0 && bits[FI_RGBA_BLUE] == 0);
+		}
+	}
+
+	// greyscale : rounding is unchanged, ordered dithering keeps the mean value
+	{
+		UniqueBitmap src(FreeImage_AllocateT(FIT_FLOAT, 64, 64), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 64; y++) {
+			auto *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(src.get(), y));
+			std::fill(bits, bits + 64, 3.4F);
+		}
+		UniqueBitmap none(FreeImage_ConvertToStandardType(src.get(), FALSE), &::FreeImage_Unload);
+		UniqueBitmap ordered(FreeImage_ConvertToStandardTypeEx(src.get(), FALSE, FIDD_ORDERED), &::FreeImage_Unload);
+		UniqueBitmap diffused(FreeImage_ConvertToStandardTypeEx(src.get(), FALSE, FIDD_FLOYD_STEINBERG), &::FreeImage_Unload);
+		assert(none != nullptr && ordered != nullptr && diffused != nullptr);
+		assert(meanValue(none.get()) == 3);
+		assert(std::abs(meanValue(ordered.get()) - 3.4) < 0.01);
+		assert(std::abs(meanValue(diffused.get()) - 3.4) < 0.01);
+	}
+
+	// tone mapping with a dithered output
+	{
+		UniqueBitmap src(FreeImage_AllocateT(FIT_RGBF, 160, 96), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 96; y++) {
+			auto *pixel = reinterpret_cast<FIRGBF*>(FreeImage_GetScanLine(src.get(), y));
+			for (unsigned x = 0; x < 160; x++) {
+				pixel[x] = { 0.01F + x / 16.F, 0.5F + y / 48.F, 0.2F };
+			}
+		}
+		for (FREE_IMAGE_TMO tmo : { FITMO_DRAGO03, FITMO_REINHARD05, FITMO_FATTAL02 }) {
+			UniqueBitmap none(FreeImage_ToneMapping(src.get(), tmo), &::FreeImage_Unload);
+			assert(none != nullptr);
+			for (FREE_IMAGE_DEPTH_DITHER dither : { FIDD_ORDERED, FIDD_FLOYD_STEINBERG }) {
+				UniqueBitmap dst(FreeImage_ToneMappingEx(src.get(), tmo, 0, 0, dither), &::FreeImage_Unload);
+				assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == 24);
+				// same mean as the rounded image, every pixel within one level
+				const unsigned count = 160 * 3;
+				for (unsigned y = 0; y < 96; y++) {
+					const uint8_t *a = FreeImage_GetScanLine(none.get(), y);
+					const uint8_t *b = FreeImage_GetScanLine(dst.get(), y);
+					for (unsigned i = 0; i < count; i++) {
+						assert(std::abs(a[i] - b[i]) <= 1 || dither == FIDD_FLOYD_STEINBERG);
+					}
+				}
+				assert(std::abs(meanValue(dst.get()) - meanValue(none.get())) < 0.5);
+			}
+		}
+	}
+}
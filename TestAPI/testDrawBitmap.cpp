@@ -0,0 +1,280 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+// ----------------------------------------------------------
+
+namespace {
+
+	struct Straight {
+		double r, g, b, a;
+	};
+
+	/**
+	Reference compositing, written with straight colors as in the W3C Compositing and Blending specification
+	*/
+	Straight referenceComposite(FREE_IMAGE_ALPHA_OPERATION op, const Straight& s, const Straight& d) {
+		const double as = s.a, ab = d.a;
+		const double cs[3] = { s.r, s.g, s.b };
+		const double cb[3] = { d.r, d.g, d.b };
+		double co[3] = {};
+		double ao = 0;
+
+		if (op == FIAO_SrcAlpha) {
+			for (int c = 0; c < 3; c++) {
+				co[c] = as * cs[c] + (1 - as) * cb[c];
+			}
+			return { co[0], co[1], co[2], ab };
+		}
+
+		if (op <= FIAO_Xor) {
+			double fa = 0, fb = 0;
+			switch (op) {
+				case FIAO_Clear:	fa = 0; fb = 0; break;
+				case FIAO_Src:		fa = 1; fb = 0; break;
+				case FIAO_Dst:		fa = 0; fb = 1; break;
+				case FIAO_SrcOver:	fa = 1; fb = 1 - as; break;
+				case FIAO_DstOver:	fa = 1 - ab; fb = 1; break;
+				case FIAO_SrcIn:	fa = ab; fb = 0; break;
+				case FIAO_DstIn:	fa = 0; fb = as; break;
+				case FIAO_SrcOut:	fa = 1 - ab; fb = 0; break;
+				case FIAO_DstOut:	fa = 0; fb = 1 - as; break;
+				case FIAO_SrcAtop:	fa = ab; fb = 1 - as; break;
+				case FIAO_DstAtop:	fa = 1 - ab; fb = as; break;
+				case FIAO_Xor:		fa = 1 - ab; fb = 1 - as; break;
+				default: break;
+			}
+			ao = as * fa + ab * fb;
+			for (int c = 0; c < 3; c++) {
+				co[c] = as * fa * cs[c] + ab * fb * cb[c];
+			}
+		} else if (op == FIAO_Add) {
+			ao = std::min(as + ab, 1.0);
+			for (int c = 0; c < 3; c++) {
+				co[c] = as * cs[c] + ab * cb[c];
+			}
+		} else {
+			ao = as + ab - as * ab;
+			for (int c = 0; c < 3; c++) {
+				double blend = 0;
+				switch (op) {
+					case FIAO_Multiply:
+						blend = cs[c] * cb[c];
+						break;
+					case FIAO_Screen:
+						blend = cs[c] + cb[c] - cs[c] * cb[c];
+						break;
+					case FIAO_Overlay:
+						blend = (cb[c] <= 0.5) ? 2 * cs[c] * cb[c] : 1 - 2 * (1 - cs[c]) * (1 - cb[c]);
+						break;
+					default:
+						break;
+				}
+				co[c] = as * (1 - ab) * cs[c] + ab * (1 - as) * cb[c] + as * ab * blend;
+			}
+		}
+		if (ao <= 0) {
+			return { 0, 0, 0, 0 };
+		}
+		return { co[0] / ao, co[1] / ao, co[2] / ao, ao };
+	}
+
+	FIBITMAP* makePixel(const Straight& p, bool premultiplied) {
+		FIBITMAP *dib = FreeImage_AllocateT(FIT_RGBAF, 1, 1);
+		FIRGBAF *bits = reinterpret_cast<FIRGBAF*>(FreeImage_GetBits(dib));
+		const double k = premultiplied ? p.a : 1;
+		*bits = { (float)(p.r * k), (float)(p.g * k), (float)(p.b * k), (float)p.a };
+		return dib;
+	}
+
+	bool near(double a, double b) {
+		return std::fabs(a - b) < 1e-5;
+	}
+
+} // namespace
+
+/**
+Test FreeImage_DrawBitmap and FreeImage_DrawBitmapEx operators, formats and placement
+*/
+void testDrawBitmap() {
+	printf("testDrawBitmap ...\n");
+
+	// every operator on float pixels, straight and premultiplied alpha
+	{
+		const Straight samples[] = {
+			{ 0.2, 0.5, 0.9, 1.0 }, { 0.8, 0.3, 0.1, 0.6 }, { 0.4, 0.7, 0.6, 0.25 }, { 0.9, 0.1, 0.5, 0.0 }, { 0.6, 0.6, 0.3, 0.9 }
+		};
+		for (int op = FIAO_SrcAlpha; op <= FIAO_Add; op++) {
+			for (const auto& s : samples) {
+				for (const auto& d : samples) {
+					const Straight expected = referenceComposite((FREE_IMAGE_ALPHA_OPERATION)op, s, d);
+					for (bool premultiplied : { false, true }) {
+						UniqueBitmap src(makePixel(s, premultiplied), &::FreeImage_Unload);
+						UniqueBitmap dst(makePixel(d, premultiplied), &::FreeImage_Unload);
+						assert(FreeImage_DrawBitmapEx(dst.get(), src.get(), (FREE_IMAGE_ALPHA_OPERATION)op, 0, 0,
+							premultiplied ? FI_ALPHA_PREMULTIPLIED : FI_ALPHA_STRAIGHT));
+						const FIRGBAF result = *reinterpret_cast<FIRGBAF*>(FreeImage_GetBits(dst.get()));
+						const double k = (premultiplied && (op != FIAO_SrcAlpha)) ? expected.a : 1;
+						if (!premultiplied || (op != FIAO_SrcAlpha)) {
+							assert(near(result.alpha, expected.a));
+							if (expected.a > 0) {
+								assert(near(result.red, expected.r * k));
+								assert(near(result.green, expected.g * k));
+								assert(near(result.blue, expected.b * k));
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// src-alpha between identical 8-bit formats keeps its integer arithmetic
+	{
+		UniqueBitmap src(FreeImage_Allocate(40, 30, 32), &::FreeImage_Unload);
+		UniqueBitmap dst(FreeImage_Allocate(50, 20, 32), &::FreeImage_Unload);
+		fillRandom(src.get(), 1);
+		fillRandom(dst.get(), 2);
+		UniqueBitmap original(FreeImage_Clone(dst.get()), &::FreeImage_Unload);
+		const int left = 15, top = -4;
+		assert(FreeImage_DrawBitmap(dst.get(), src.get(), FIAO_SrcAlpha, left, top));
+		for (int y = 0; y < 20; y++) {
+			const FIRGBA8 *d = reinterpret_cast<FIRGBA8*>(FreeImage_GetScanLine(dst.get(), 19 - y));
+			const FIRGBA8 *o = reinterpret_cast<FIRGBA8*>(FreeImage_GetScanLine(original.get(), 19 - y));
+			for (int x = 0; x < 50; x++) {
+				const int sx = x - left, sy = y - top;
+				if ((sx < 0) || (sx >= 40) || (sy < 0) || (sy >= 30)) {
+					assert(memcmp(&d[x], &o[x], sizeof(FIRGBA8)) == 0);
+					continue;
+				}
+				const FIRGBA8& s = reinterpret_cast<FIRGBA8*>(FreeImage_GetScanLine(src.get(), 29 - sy))[sx];
+				const unsigned a = s.alpha;
+				auto blend = [a](uint8_t cs, uint8_t cd) {
+					return (a == 255) ? cs : (a == 0) ? cd : (uint8_t)((a * cs + (255 - a) * cd) / 255);
+				};
+				assert(d[x].red == blend(s.red, o[x].red));
+				assert(d[x].green == blend(s.green, o[x].green));
+				assert(d[x].blue == blend(s.blue, o[x].blue));
+				assert(d[x].alpha == o[x].alpha);
+			}
+		}
+	}
+
+	// mixed formats : 8-bit RGBA over 16-bit, float, 24-bit and greyscale images
+	{
+		UniqueBitmap src(FreeImage_Allocate(64, 48, 32), &::FreeImage_Unload);
+		fillRandom(src.get(), 3);
+		const FREE_IMAGE_TYPE types[] = { FIT_RGB16, FIT_RGBA16, FIT_RGBF, FIT_RGBAF, FIT_UINT16, FIT_FLOAT };
+		for (FREE_IMAGE_TYPE type : types) {
+			UniqueBitmap dst(FreeImage_AllocateT(type, 64, 48), &::FreeImage_Unload);
+			assert(FreeImage_DrawBitmap(dst.get(), src.get(), FIAO_SrcOver, 0, 0));
+		}
+
+		// over an opaque 24-bit image, src-over matches src-alpha
+		UniqueBitmap dst24(FreeImage_Allocate(64, 48, 24), &::FreeImage_Unload);
+		fillRandom(dst24.get(), 4);
+		UniqueBitmap dst24b(FreeImage_Clone(dst24.get()), &::FreeImage_Unload);
+		assert(FreeImage_DrawBitmap(dst24.get(), src.get(), FIAO_SrcOver, 0, 0));
+		UniqueBitmap dst32(FreeImage_ConvertTo32Bits(dst24b.get()), &::FreeImage_Unload);
+		assert(FreeImage_DrawBitmap(dst32.get(), src.get(), FIAO_SrcAlpha, 0, 0));
+		for (unsigned y = 0; y < 48; y++) {
+			const FIRGB8 *a = reinterpret_cast<FIRGB8*>(FreeImage_GetScanLine(dst24.get(), y));
+			const FIRGBA8 *b = reinterpret_cast<FIRGBA8*>(FreeImage_GetScanLine(dst32.get(), y));
+			for (unsigned x = 0; x < 64; x++) {
+				assert(std::abs(a[x].red - b[x].red) <= 1);
+				assert(std::abs(a[x].green - b[x].green) <= 1);
+				assert(std::abs(a[x].blue - b[x].blue) <= 1);
+			}
+		}
+
+		// a greyscale src on a greyscale dst stays exact
+		UniqueBitmap grey(FreeImage_Allocate(64, 48, 8), &::FreeImage_Unload);
+		UniqueBitmap grey_dst(FreeImage_AllocateT(FIT_UINT16, 64, 48), &::FreeImage_Unload);
+		fillRandom(grey.get(), 5);
+		assert(FreeImage_DrawBitmap(grey_dst.get(), grey.get(), FIAO_Src, 0, 0));
+		for (unsigned y = 0; y < 48; y++) {
+			const uint8_t *a = FreeImage_GetScanLine(grey.get(), y);
+			const uint16_t *b = reinterpret_cast<uint16_t*>(FreeImage_GetScanLine(grey_dst.get(), y));
+			for (unsigned x = 0; x < 64; x++) {
+				assert(b[x] == a[x] * 257);
+			}
+		}
+
+		// unsupported formats
+		UniqueBitmap dst4(FreeImage_Allocate(64, 48, 4), &::FreeImage_Unload);
+		assert(!FreeImage_DrawBitmap(dst4.get(), src.get(), FIAO_SrcOver, 0, 0));
+		UniqueBitmap dst_complex(FreeImage_AllocateT(FIT_COMPLEX, 64, 48), &::FreeImage_Unload);
+		assert(!FreeImage_DrawBitmap(dst_complex.get(), src.get(), FIAO_SrcOver, 0, 0));
+		UniqueBitmap palettized(FreeImage_Allocate(64, 48, 8), &::FreeImage_Unload);
+		FreeImage_GetPalette(palettized.get())[1] = { 0, 0, 255, 255 };
+		assert(!FreeImage_DrawBitmap(dst24.get(), palettized.get(), FIAO_SrcOver, 0, 0));
+	}
+
+	// mixed formats compared with a reference conversion of src
+	{
+		// an opaque 8-bit greyscale src replaces the pixels of a 24-bit dst
+		UniqueBitmap grey(FreeImage_Allocate(64, 48, 8), &::FreeImage_Unload);
+		fillRandom(grey.get(), 6);
+		UniqueBitmap dst24(FreeImage_Allocate(64, 48, 24), &::FreeImage_Unload);
+		fillRandom(dst24.get(), 7);
+		assert(FreeImage_DrawBitmap(dst24.get(), grey.get(), FIAO_SrcOver, 0, 0));
+		UniqueBitmap grey24(FreeImage_ConvertTo24Bits(grey.get()), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 48; y++) {
+			assert(memcmp(FreeImage_GetScanLine(dst24.get(), y), FreeImage_GetScanLine(grey24.get(), y), 64 * sizeof(FIRGB8)) == 0);
+		}
+
+		// RGBA16 over RGBAF, both with a varying alpha
+		UniqueBitmap src16(FreeImage_AllocateT(FIT_RGBA16, 64, 48), &::FreeImage_Unload);
+		fillRandom(src16.get(), 8);
+		UniqueBitmap dstf(FreeImage_AllocateT(FIT_RGBAF, 64, 48), &::FreeImage_Unload);
+		unsigned seed = 9;
+		for (unsigned y = 0; y < 48; y++) {
+			FIRGBAF *d = reinterpret_cast<FIRGBAF*>(FreeImage_GetScanLine(dstf.get(), y));
+			for (unsigned x = 0; x < 64; x++) {
+				d[x].red = (nextRandom(seed) % 256) / 255.F;
+				d[x].green = (nextRandom(seed) % 256) / 255.F;
+				d[x].blue = (nextRandom(seed) % 256) / 255.F;
+				d[x].alpha = (nextRandom(seed) % 256) / 255.F;
+			}
+		}
+		UniqueBitmap original(FreeImage_Clone(dstf.get()), &::FreeImage_Unload);
+		assert(FreeImage_DrawBitmap(dstf.get(), src16.get(), FIAO_SrcOver, 0, 0));
+		UniqueBitmap srcf(FreeImage_ConvertToRGBAF(src16.get()), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 48; y++) {
+			const FIRGBAF *d = reinterpret_cast<FIRGBAF*>(FreeImage_GetScanLine(dstf.get(), y));
+			const FIRGBAF *o = reinterpret_cast<FIRGBAF*>(FreeImage_GetScanLine(original.get(), y));
+			const FIRGBAF *s = reinterpret_cast<FIRGBAF*>(FreeImage_GetScanLine(srcf.get(), y));
+			for (unsigned x = 0; x < 64; x++) {
+				const Straight expected = referenceComposite(FIAO_SrcOver,
+					{ s[x].red, s[x].green, s[x].blue, s[x].alpha }, { o[x].red, o[x].green, o[x].blue, o[x].alpha });
+				assert(near(d[x].alpha, expected.a));
+				if (expected.a > 0) {
+					assert(near(d[x].red, expected.r));
+					assert(near(d[x].green, expected.g));
+					assert(near(d[x].blue, expected.b));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,165 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include "ReferenceLZW.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------
+
+static bool
+equalPixels(FIBITMAP *dib1, FIBITMAP *dib2) {
+	if ((FreeImage_GetWidth(dib1) != FreeImage_GetWidth(dib2)) || (FreeImage_GetHeight(dib1) != FreeImage_GetHeight(dib2)) || (FreeImage_GetBPP(dib1) != FreeImage_GetBPP(dib2))) {
+		return false;
+	}
+	const unsigned width = FreeImage_GetWidth(dib1);
+	const unsigned bpp = FreeImage_GetBPP(dib1);
+	for (unsigned y = 0; y < FreeImage_GetHeight(dib1); y++) {
+		const uint8_t *line1 = FreeImage_GetScanLine(dib1, y);
+		const uint8_t *line2 = FreeImage_GetScanLine(dib2, y);
+		// compare whole bytes, then the significant bits of the last byte
+		const unsigned bits = width * bpp;
+		if (memcmp(line1, line2, bits / 8) != 0) {
+			return false;
+		}
+		if (bits % 8) {
+			const uint8_t mask = (uint8_t)(0xFF << (8 - bits % 8));
+			if ((line1[bits / 8] & mask) != (line2[bits / 8] & mask)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+Locate the LZW data of the first image of a GIF stream, from the minimum code size to the block terminator
+*/
+static std::vector<uint8_t>
+firstImageData(FIMEMORY *hmem, bool *interlaced) {
+	uint8_t *data = nullptr;
+	uint32_t size = 0;
+	FreeImage_AcquireMemory(hmem, &data, &size);
+	assert(size > 13 && memcmp(data, "GIF", 3) == 0);
+
+	// header, logical screen descriptor and global color table
+	size_t pos = 13;
+	if (data[10] & 0x80) {
+		pos += 3 * (2 << (data[10] & 0x07));
+	}
+	// extensions
+	while (pos < size && data[pos] == 0x21) {
+		pos += 2;
+		while (pos < size && data[pos] != 0) {
+			pos += data[pos] + 1;
+		}
+		pos++;
+	}
+	// image descriptor and local color table
+	assert(pos + 10 < size && data[pos] == 0x2C);
+	const uint8_t packed = data[pos + 9];
+	*interlaced = (packed & 0x40) != 0;
+	pos += 10;
+	if (packed & 0x80) {
+		pos += 3 * (2 << (packed & 0x07));
+	}
+	// image data sub-blocks
+	const size_t start = pos++;
+	while (pos < size && data[pos] != 0) {
+		pos += data[pos] + 1;
+	}
+	assert(pos < size);
+	return std::vector<uint8_t>(data + start, data + pos + 1);
+}
+
+/**
+Encode a frame to GIF in memory, check the LZW data against the reference encoder, 
+then decode it back and check the pixels survived the LZW round trip
+*/
+static void
+roundTripGIF(FIBITMAP *dib) {
+	UniqueMemory hmem(FreeImage_OpenMemory(), &::FreeImage_CloseMemory);
+	FIBOOL bSuccess = FreeImage_SaveToMemory(FIF_GIF, dib, hmem.get(), 0);
+	assert(bSuccess);
+
+	bool interlaced = false;
+	const std::vector<uint8_t> encoded = firstImageData(hmem.get(), &interlaced);
+	assert(encoded == encodeReferenceLZW(dib, interlaced));
+
+	FreeImage_SeekMemory(hmem.get(), 0, SEEK_SET);
+	UniqueBitmap loaded(FreeImage_LoadFromMemory(FIF_GIF, hmem.get(), 0), &::FreeImage_Unload);
+	assert(loaded != nullptr);
+
+	assert(equalPixels(dib, loaded.get()));
+}
+
+// ----------------------------------------------------------
+
+void testGIF(const char *lpszPathName) {
+	printf("testGIF ...\n");
+
+	// LZW round trip of every page of a real world file
+	{
+		FIMULTIBITMAP *src = FreeImage_OpenMultiBitmap(FIF_GIF, lpszPathName, FALSE, TRUE, TRUE, 0);
+		assert(src != nullptr);
+		const int count = FreeImage_GetPageCount(src);
+		assert(count > 0);
+		for (int page = 0; page < count; page++) {
+			FIBITMAP *dib = FreeImage_LockPage(src, page);
+			assert(dib != nullptr);
+			roundTripGIF(dib);
+			FreeImage_UnlockPage(src, dib, FALSE);
+		}
+		FreeImage_CloseMultiBitmap(src, 0);
+	}
+
+	// larger synthetic animation frames, at every bit depth supported by the GIF writer
+	{
+		const unsigned width = 640;
+		const unsigned height = 480;
+		const int frames = 2;
+		for (unsigned bpp : { 8, 4, 1 }) {
+			for (int frame = 0; frame < frames; frame++) {
+				UniqueBitmap dib(createAnimationFrame(width, height, frame), &::FreeImage_Unload);
+				assert(dib != nullptr);
+				if (bpp == 4) {
+					dib.reset(FreeImage_ConvertTo4Bits(dib.get()));
+				} else if (bpp == 1) {
+					dib.reset(FreeImage_Threshold(dib.get(), 128));
+				}
+				assert(dib != nullptr && FreeImage_GetBPP(dib.get()) == bpp);
+				roundTripGIF(dib.get());
+			}
+		}
+	}
+
+	// noise fills the string table quickly, so the encoder restarts it many times
+	{
+		UniqueBitmap dib(FreeImage_Allocate(320, 240, 8), &::FreeImage_Unload);
+		assert(dib != nullptr);
+		fillRandom(dib.get(), 3);
+		FIRGBA8 *palette = FreeImage_GetPalette(dib.get());
+		for (unsigned i = 0; i < 256; i++) {
+			palette[i].red = palette[i].green = palette[i].blue = (uint8_t)i;
+		}
+		roundTripGIF(dib.get());
+	}
+}
@@ -21,6 +21,9 @@
 
 
 #include "TestSuite.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
 
 // Local test functions
 // ----------------------------------------------------------
@@ -194,6 +197,153 @@ void testJPEGSameFile(const char *src_file) {
 	assert(bResult);
 }
 
+static std::vector<uint8_t> transformInMemory(FIMEMORY *src, const FIJPEGSTEP *steps, unsigned count, FREE_IMAGE_JPEG_MARKERS markers) {
+	std::vector<uint8_t> result;
+	FIMEMORY *dst = FreeImage_OpenMemory();
+	FreeImage_SeekMemory(src, 0, SEEK_SET);
+	if (FreeImage_JPEGTransformPipelineFromMemory(src, dst, steps, count, markers, FALSE)) {
+		uint8_t *data = NULL;
+		uint32_t size = 0;
+		FreeImage_AcquireMemory(dst, &data, &size);
+		result.assign(data, data + size);
+	}
+	FreeImage_CloseMemory(dst);
+	return result;
+}
+
+static FIBITMAP* loadInMemory(const std::vector<uint8_t>& data, int flags) {
+	FIMEMORY *hmem = FreeImage_OpenMemory((uint8_t*)data.data(), (uint32_t)data.size());
+	FIBITMAP *dib = FreeImage_LoadFromMemory(FIF_JPEG, hmem, flags);
+	FreeImage_CloseMemory(hmem);
+	return dib;
+}
+
+/** Set the Exif orientation of a JPEG file in memory, returns false if the file has no orientation tag */
+static bool setExifOrientation(std::vector<uint8_t>& buffer, uint8_t orientation) {
+	// IFD entry of the orientation tag : SHORT, count 1, in Intel or Motorola byte order
+	const uint8_t intel[] = { 0x12, 0x01, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00 };
+	const uint8_t motorola[] = { 0x01, 0x12, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01 };
+	auto entry = std::search(buffer.begin(), buffer.end(), std::begin(intel), std::end(intel));
+	if ((entry != buffer.end()) && (buffer.end() - entry >= 10)) {
+		entry[8] = orientation;
+		entry[9] = 0;
+		return true;
+	}
+	entry = std::search(buffer.begin(), buffer.end(), std::begin(motorola), std::end(motorola));
+	if ((entry != buffer.end()) && (buffer.end() - entry >= 10)) {
+		entry[8] = 0;
+		entry[9] = orientation;
+		return true;
+	}
+	return false;
+}
+
+void testJPEGTransformPipeline(const char *src_file) {
+	FIBOOL bResult;
+
+	// load the source in memory
+	FILE *file = fopen(src_file, "rb");
+	assert(file != NULL);
+	std::vector<uint8_t> buffer;
+	uint8_t block[4096];
+	for (size_t n; (n = fread(block, 1, sizeof(block), file)) > 0; ) {
+		buffer.insert(buffer.end(), block, block + n);
+	}
+	fclose(file);
+	FIMEMORY *src = FreeImage_OpenMemory(buffer.data(), (uint32_t)buffer.size());
+
+	// consecutive transformations are combined
+	const FIJPEGSTEP rotate90[] = { { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_90, 0, 0, 0, 0 } };
+	const FIJPEGSTEP rotate180[] = { { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_180, 0, 0, 0, 0 } };
+	const FIJPEGSTEP twice90[] = { { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_90, 0, 0, 0, 0 }, { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_90, 0, 0, 0, 0 } };
+	const FIJPEGSTEP identity[] = { { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_FLIP_H, 0, 0, 0, 0 }, { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_90, 0, 0, 0, 0 }, { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_TRANSPOSE, 0, 0, 0, 0 }, { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_FLIP_V, 0, 0, 0, 0 }, { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_180, 0, 0, 0, 0 } };
+	const std::vector<uint8_t> once = transformInMemory(src, rotate180, 1, FIJPEG_MARKERS_ALL);
+	assert(!once.empty());
+	assert(transformInMemory(src, twice90, 2, FIJPEG_MARKERS_ALL) == once);
+	assert(transformInMemory(src, identity, 5, FIJPEG_MARKERS_ALL) == transformInMemory(src, NULL, 0, FIJPEG_MARKERS_ALL));
+
+	// a crop before a rotation is the rotated crop after it
+	const FIJPEGSTEP cropThenRotate[] = { { FIJPEG_STEP_CROP, FIJPEG_OP_NONE, 0, 0, 128, 64 }, { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_90, 0, 0, 0, 0 } };
+	FreeImage_SeekMemory(src, 0, SEEK_SET);
+	FIBITMAP *header = FreeImage_LoadFromMemory(FIF_JPEG, src, FIF_LOAD_NOPIXELS);
+	assert(header != NULL);
+	const int width = (int)FreeImage_GetWidth(header);
+	const int height = (int)FreeImage_GetHeight(header);
+	FreeImage_Unload(header);
+	const FIJPEGSTEP rotateThenCrop[] = { { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_ROTATE_90, 0, 0, 0, 0 }, { FIJPEG_STEP_CROP, FIJPEG_OP_NONE, height - 64, 0, height, 128 } };
+	const std::vector<uint8_t> cropped = transformInMemory(src, cropThenRotate, 2, FIJPEG_MARKERS_ALL);
+	assert(!cropped.empty());
+	assert(transformInMemory(src, rotateThenCrop, 2, FIJPEG_MARKERS_ALL) == cropped);
+
+	// upload normalization : upright, grayscale, markers reduced to the orientation and the ICC profile
+	const FIJPEGSTEP normalize[] = { { FIJPEG_STEP_AUTO_ORIENT, FIJPEG_OP_NONE, 0, 0, 0, 0 }, { FIJPEG_STEP_GRAYSCALE, FIJPEG_OP_NONE, 0, 0, 0, 0 } };
+	{
+		// source displayed rotated by 90 degrees
+		std::vector<uint8_t> rotated = buffer;
+		const bool hasOrientation = setExifOrientation(rotated, 6);
+		assert(hasOrientation);
+		FIMEMORY *hmem = FreeImage_OpenMemory(rotated.data(), (uint32_t)rotated.size());
+		const std::vector<uint8_t> normalized = transformInMemory(hmem, normalize, 2, FIJPEG_MARKERS_ORIENTATION);
+		FreeImage_CloseMemory(hmem);
+		assert(!normalized.empty());
+		assert(normalized.size() < buffer.size());
+
+		FIBITMAP *dib = loadInMemory(normalized, JPEG_DEFAULT);
+		assert(dib != NULL);
+		assert(FreeImage_GetBPP(dib) == 8);
+		assert(((int)FreeImage_GetWidth(dib) == height) && ((int)FreeImage_GetHeight(dib) == width));
+		FITAG *tag = NULL;
+		assert(FreeImage_GetMetadata(FIMD_EXIF_MAIN, dib, "Orientation", &tag));
+		assert(*(const uint16_t*)FreeImage_GetTagValue(tag) == 1);
+		FreeImage_Unload(dib);
+	}
+
+	// partial edge iMCUs dropped by a flip : the steps apply to the remaining part of the source
+	{
+		FIBITMAP *image = createZonePlateImage(100, 75, 64);
+		FIBITMAP *rgb = FreeImage_ConvertTo24Bits(image);
+		FIMEMORY *hmem = FreeImage_OpenMemory();
+		bResult = FreeImage_SaveToMemory(FIF_JPEG, rgb, hmem, JPEG_DEFAULT);
+		assert(bResult);
+		FreeImage_Unload(rgb);
+		FreeImage_Unload(image);
+
+		const FIJPEGSTEP flip[] = { { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_FLIP_H, 0, 0, 0, 0 } };
+		const FIJPEGSTEP flipThenCrop[] = { { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_FLIP_H, 0, 0, 0, 0 }, { FIJPEG_STEP_CROP, FIJPEG_OP_NONE, 0, 0, 32, 32 } };
+		const FIJPEGSTEP cropThenFlip[] = { { FIJPEG_STEP_CROP, FIJPEG_OP_NONE, 64, 0, 96, 32 }, { FIJPEG_STEP_TRANSFORM, FIJPEG_OP_FLIP_H, 0, 0, 0, 0 } };
+		const std::vector<uint8_t> flipped = transformInMemory(hmem, flip, 1, FIJPEG_MARKERS_ALL);
+		const std::vector<uint8_t> cropped = transformInMemory(hmem, flipThenCrop, 2, FIJPEG_MARKERS_ALL);
+		assert(!cropped.empty());
+		assert(transformInMemory(hmem, cropThenFlip, 2, FIJPEG_MARKERS_ALL) == cropped);
+		FreeImage_CloseMemory(hmem);
+
+		FIBITMAP *dib = loadInMemory(flipped, FIF_LOAD_NOPIXELS);
+		assert(dib != NULL);
+		assert((FreeImage_GetWidth(dib) == 96) && (FreeImage_GetHeight(dib) == 75));
+		FreeImage_Unload(dib);
+		dib = loadInMemory(cropped, FIF_LOAD_NOPIXELS);
+		assert(dib != NULL);
+		assert((FreeImage_GetWidth(dib) == 32) && (FreeImage_GetHeight(dib) == 32));
+		FreeImage_Unload(dib);
+	}
+
+	// invalid steps
+	const FIJPEGSTEP invalid[] = { { (FREE_IMAGE_JPEG_STEP)100, FIJPEG_OP_NONE, 0, 0, 0, 0 } };
+	assert(transformInMemory(src, invalid, 1, FIJPEG_MARKERS_ALL).empty());
+
+	FreeImage_CloseMemory(src);
+
+	// batch of files
+	const char *src_files[] = { src_file, src_file, "missing.jpg" };
+	const char *dst_files[] = { "test.jpg", "test2.jpg", "test3.jpg" };
+	FIBOOL results[3] = {};
+	const unsigned succeeded = FreeImage_JPEGTransformBatch(src_files, dst_files, 3, normalize, 2, FIJPEG_MARKERS_ORIENTATION, FALSE, results);
+	assert(succeeded == 2);
+	assert(results[0] && results[1] && !results[2]);
+	bResult = FreeImage_JPEGTransformPipeline("test2.jpg", "test2.jpg", rotate90, 1, FIJPEG_MARKERS_NONE, FALSE);
+	assert(bResult);
+}
+
 // Main test function
 // ----------------------------------------------------------
 
@@ -213,4 +363,7 @@ void testJPEG() {
 
 	// using the same file for src & dst is allowed
 	testJPEGSameFile(src_file);
+
+	// pipeline of lossless transformations, in memory and on a batch of files
+	testJPEGTransformPipeline(src_file);
 }
@@ -0,0 +1,567 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------
+
+static bool
+equalPixels(FIBITMAP *dib1, FIBITMAP *dib2) {
+	if ((FreeImage_GetWidth(dib1) != FreeImage_GetWidth(dib2)) || (FreeImage_GetHeight(dib1) != FreeImage_GetHeight(dib2)) || (FreeImage_GetBPP(dib1) != FreeImage_GetBPP(dib2))) {
+		return false;
+	}
+	if (FreeImage_GetImageType(dib1) != FreeImage_GetImageType(dib2)) {
+		return false;
+	}
+	// compare the significant bits of each line, not the padding
+	const unsigned bits = FreeImage_GetWidth(dib1) * FreeImage_GetBPP(dib1);
+	for (unsigned y = 0; y < FreeImage_GetHeight(dib1); y++) {
+		const uint8_t *line1 = FreeImage_GetScanLine(dib1, y);
+		const uint8_t *line2 = FreeImage_GetScanLine(dib2, y);
+		if (memcmp(line1, line2, bits / 8) != 0) {
+			return false;
+		}
+		if (bits % 8) {
+			const uint8_t mask = (uint8_t)(0xFF << (8 - bits % 8));
+			if ((line1[bits / 8] & mask) != (line2[bits / 8] & mask)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void
+setTag(FIBITMAP *dib, const char *key, FREE_IMAGE_MDTYPE type, uint32_t length, const void *value) {
+	FITAG *tag = FreeImage_CreateTag();
+	assert(tag != nullptr);
+	FreeImage_SetTagKey(tag, key);
+	FreeImage_SetTagType(tag, type);
+	FreeImage_SetTagCount(tag, 1);
+	FreeImage_SetTagLength(tag, length);
+	FreeImage_SetTagValue(tag, value);
+	FreeImage_SetMetadata(FIMD_ANIMATION, dib, key, tag);
+	FreeImage_DeleteTag(tag);
+}
+
+static int32_t
+getFrameTime(FIBITMAP *dib) {
+	FITAG *tag = nullptr;
+	if (FreeImage_GetMetadata(FIMD_ANIMATION, dib, "FrameTime", &tag) && (FreeImage_GetTagType(tag) == FIDT_LONG)) {
+		return *(const int32_t*)FreeImage_GetTagValue(tag);
+	}
+	return -1;
+}
+
+/**
+32-bit frame filled with a color, fully opaque
+*/
+static FIBITMAP*
+createFrame(unsigned width, unsigned height, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha) {
+	FIBITMAP *dib = FreeImage_Allocate(width, height, 32);
+	assert(dib != nullptr);
+	for (unsigned y = 0; y < height; y++) {
+		FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib, y);
+		for (unsigned x = 0; x < width; x++) {
+			bits[x].red = (uint8_t)(red ^ x);
+			bits[x].green = (uint8_t)(green ^ y);
+			bits[x].blue = blue;
+			bits[x].alpha = alpha;
+		}
+	}
+	return dib;
+}
+
+/**
+Expected canvas : copy a frame into the canvas, using top-down frame coordinates
+*/
+static void
+pasteFrame(FIBITMAP *canvas, FIBITMAP *frame, unsigned left, unsigned top) {
+	const unsigned height = FreeImage_GetHeight(canvas);
+	for (unsigned y = 0; y < FreeImage_GetHeight(frame); y++) {
+		uint8_t *dst = FreeImage_GetScanLine(canvas, height - 1 - (top + y)) + left * 4;
+		memcpy(dst, FreeImage_GetScanLine(frame, FreeImage_GetHeight(frame) - 1 - y), FreeImage_GetWidth(frame) * 4);
+	}
+}
+
+static void
+clearArea(FIBITMAP *canvas, unsigned left, unsigned top, unsigned width, unsigned height) {
+	const unsigned canvas_height = FreeImage_GetHeight(canvas);
+	for (unsigned y = 0; y < height; y++) {
+		memset(FreeImage_GetScanLine(canvas, canvas_height - 1 - (top + y)) + left * 4, 0, width * 4);
+	}
+}
+
+// ----------------------------------------------------------
+
+/**
+Write an animation with partial frames and disposal methods, read it back and check the composited pages
+*/
+static void
+testAPNGComposition(const char *lpszPathName) {
+	const unsigned width = 64, height = 48;
+
+	// frames of the animation
+	UniqueBitmap frame0(createFrame(width, height, 0x10, 0x20, 0x30, 0xFF), &::FreeImage_Unload);
+	UniqueBitmap frame1(createFrame(16, 16, 0xF0, 0x80, 0x00, 0xFF), &::FreeImage_Unload);
+	UniqueBitmap frame2(createFrame(8, 8, 0x00, 0xFF, 0x40, 0xFF), &::FreeImage_Unload);
+
+	int32_t loop = 3;
+	setTag(frame0.get(), "Loop", FIDT_LONG, 4, &loop);
+	int32_t frame_time = 40;
+	setTag(frame0.get(), "FrameTime", FIDT_LONG, 4, &frame_time);
+
+	uint16_t left = 8, top = 4;
+	setTag(frame1.get(), "FrameLeft", FIDT_SHORT, 2, &left);
+	setTag(frame1.get(), "FrameTop", FIDT_SHORT, 2, &top);
+	uint8_t disposal = 2;	// restore to background
+	setTag(frame1.get(), "DisposalMethod", FIDT_BYTE, 1, &disposal);
+	frame_time = 250;
+	setTag(frame1.get(), "FrameTime", FIDT_LONG, 4, &frame_time);
+
+	// expected pages
+	UniqueBitmap page0(FreeImage_Clone(frame0.get()), &::FreeImage_Unload);
+	UniqueBitmap page1(FreeImage_Clone(frame0.get()), &::FreeImage_Unload);
+	pasteFrame(page1.get(), frame1.get(), left, top);
+	UniqueBitmap page2(FreeImage_Clone(frame0.get()), &::FreeImage_Unload);
+	clearArea(page2.get(), left, top, 16, 16);
+	pasteFrame(page2.get(), frame2.get(), 0, 0);
+
+	// write the animation
+	{
+		FIMULTIBITMAP *out = FreeImage_OpenMultiBitmap(FIF_PNG, lpszPathName, TRUE, FALSE, TRUE);
+		assert(out != nullptr);
+		FreeImage_AppendPage(out, frame0.get());
+		FreeImage_AppendPage(out, frame1.get());
+		FreeImage_AppendPage(out, frame2.get());
+		FIBOOL bSuccess = FreeImage_CloseMultiBitmap(out, PNG_Z_BEST_SPEED);
+		assert(bSuccess);
+	}
+
+	// decoders without APNG support see the first frame
+	{
+		UniqueBitmap dib(FreeImage_Load(FIF_PNG, lpszPathName, 0), &::FreeImage_Unload);
+		assert(dib != nullptr);
+		UniqueBitmap dib32(FreeImage_ConvertTo32Bits(dib.get()), &::FreeImage_Unload);
+		assert(equalPixels(dib32.get(), page0.get()));
+	}
+
+	// composited pages, sequential then random access
+	{
+		FIMULTIBITMAP *src = FreeImage_OpenMultiBitmap(FIF_PNG, lpszPathName, FALSE, TRUE, TRUE);
+		assert(src != nullptr);
+		assert(FreeImage_GetPageCount(src) == 3);
+
+		FIBITMAP *expected[] = { page0.get(), page1.get(), page2.get() };
+		const int order[] = { 0, 1, 2, 1, 0, 2 };
+		for (int page : order) {
+			FIBITMAP *dib = FreeImage_LockPage(src, page);
+			assert(dib != nullptr);
+			assert(equalPixels(dib, expected[page]));
+			if (page == 0) {
+				FITAG *tag = nullptr;
+				FreeImage_GetMetadata(FIMD_ANIMATION, dib, "Loop", &tag);
+				assert(tag && (*(const int32_t*)FreeImage_GetTagValue(tag) == loop));
+				assert(getFrameTime(dib) == 40);
+			} else if (page == 1) {
+				assert(getFrameTime(dib) == 250);
+			} else {
+				assert(getFrameTime(dib) == 100);
+			}
+			FreeImage_UnlockPage(src, dib, FALSE);
+		}
+		FreeImage_CloseMultiBitmap(src, 0);
+	}
+}
+
+/**
+Opaque 32-bit noise frame, which doesn't compress
+*/
+static FIBITMAP*
+createNoiseFrame(unsigned width, unsigned height, unsigned seed) {
+	FIBITMAP *dib = FreeImage_Allocate(width, height, 32);
+	assert(dib != nullptr);
+	fillRandom(dib, seed);
+	for (unsigned y = 0; y < height; y++) {
+		FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib, y);
+		for (unsigned x = 0; x < width; x++) {
+			bits[x].alpha = 0xFF;
+		}
+	}
+	return dib;
+}
+
+/**
+Write an interlaced animation whose frames span several IDAT / fdAT chunks, read it back and check the composited pages
+*/
+static void
+testAPNGLargeFrames(const char *lpszPathName) {
+	const unsigned width = 600, height = 500;
+
+	UniqueBitmap frame0(createNoiseFrame(width, height, 11), &::FreeImage_Unload);
+	UniqueBitmap frame1(createNoiseFrame(300, 200, 12), &::FreeImage_Unload);
+	UniqueBitmap frame2(createNoiseFrame(width, height, 13), &::FreeImage_Unload);
+
+	uint16_t left = 100, top = 50;
+	setTag(frame1.get(), "FrameLeft", FIDT_SHORT, 2, &left);
+	setTag(frame1.get(), "FrameTop", FIDT_SHORT, 2, &top);
+
+	UniqueBitmap page1(FreeImage_Clone(frame0.get()), &::FreeImage_Unload);
+	pasteFrame(page1.get(), frame1.get(), left, top);
+
+	{
+		FIMULTIBITMAP *out = FreeImage_OpenMultiBitmap(FIF_PNG, lpszPathName, TRUE, FALSE, TRUE);
+		assert(out != nullptr);
+		FreeImage_AppendPage(out, frame0.get());
+		FreeImage_AppendPage(out, frame1.get());
+		FreeImage_AppendPage(out, frame2.get());
+		FIBOOL bSuccess = FreeImage_CloseMultiBitmap(out, PNG_Z_BEST_SPEED | PNG_INTERLACED);
+		assert(bSuccess);
+	}
+
+	FIMULTIBITMAP *src = FreeImage_OpenMultiBitmap(FIF_PNG, lpszPathName, FALSE, TRUE, TRUE);
+	assert(src != nullptr);
+	assert(FreeImage_GetPageCount(src) == 3);
+	FIBITMAP *expected[] = { frame0.get(), page1.get(), frame2.get() };
+	const int order[] = { 0, 1, 2, 0, 2 };
+	for (int page : order) {
+		FIBITMAP *dib = FreeImage_LockPage(src, page);
+		assert(dib != nullptr);
+		assert(equalPixels(dib, expected[page]));
+		FreeImage_UnlockPage(src, dib, FALSE);
+	}
+	FreeImage_CloseMultiBitmap(src, 0);
+}
+
+/**
+Convert a GIF animation to APNG in memory and compare the frames
+*/
+static void
+testAPNGFromGIF(const char *lpszPathName) {
+	FIMULTIBITMAP *gif = FreeImage_OpenMultiBitmap(FIF_GIF, lpszPathName, FALSE, TRUE, TRUE, GIF_PLAYBACK);
+	assert(gif != nullptr);
+	const int count = FreeImage_GetPageCount(gif);
+
+	UniqueMemory hmem(FreeImage_OpenMemory(), &::FreeImage_CloseMemory);
+	FIBOOL bSuccess = FreeImage_SaveMultiBitmapToMemory(FIF_PNG, gif, hmem.get(), 0);
+	assert(bSuccess);
+
+	FreeImage_SeekMemory(hmem.get(), 0, SEEK_SET);
+	FIMULTIBITMAP *apng = FreeImage_LoadMultiBitmapFromMemory(FIF_PNG, hmem.get(), 0);
+	assert(apng != nullptr);
+	assert(FreeImage_GetPageCount(apng) == count);
+
+	for (int page = 0; page < count; page++) {
+		FIBITMAP *src = FreeImage_LockPage(gif, page);
+		FIBITMAP *dst = FreeImage_LockPage(apng, page);
+		assert(src && dst);
+		assert(equalPixels(src, dst));
+		assert(getFrameTime(src) == getFrameTime(dst));
+		FreeImage_UnlockPage(apng, dst, FALSE);
+		FreeImage_UnlockPage(gif, src, FALSE);
+	}
+
+	FreeImage_CloseMultiBitmap(apng, 0);
+	FreeImage_CloseMultiBitmap(gif, 0);
+}
+
+/**
+Save an image with the given flags and check it reads back unchanged
+*/
+static void
+roundTripPNG(FIBITMAP *dib, int flags) {
+	UniqueMemory hmem(FreeImage_OpenMemory(), &::FreeImage_CloseMemory);
+	FIBOOL bSuccess = FreeImage_SaveToMemory(FIF_PNG, dib, hmem.get(), flags);
+	assert(bSuccess);
+
+	FreeImage_SeekMemory(hmem.get(), 0, SEEK_SET);
+	UniqueBitmap loaded(FreeImage_LoadFromMemory(FIF_PNG, hmem.get(), 0), &::FreeImage_Unload);
+	assert(loaded != nullptr);
+	if (FreeImage_GetColorType(dib) == FIC_MINISWHITE) {
+		// inverted greyscale images are read back as FIC_MINISBLACK
+		UniqueBitmap grey1(FreeImage_ConvertToGreyscale(dib), &::FreeImage_Unload);
+		UniqueBitmap grey2(FreeImage_ConvertToGreyscale(loaded.get()), &::FreeImage_Unload);
+		assert(equalPixels(grey1.get(), grey2.get()));
+	} else {
+		assert(equalPixels(dib, loaded.get()));
+	}
+}
+
+/**
+Check the PNG encoder presets on every pixel format written by the plugin
+*/
+void testPNGEncode() {
+	printf("testPNGEncode ...\n");
+
+	const int presets[] = { 
+		PNG_DEFAULT, PNG_ENCODE_FAST, PNG_ENCODE_SMALL, 
+		PNG_ENCODE_PARALLEL, PNG_ENCODE_PARALLEL | PNG_ENCODE_FAST, PNG_ENCODE_PARALLEL | PNG_ENCODE_SMALL, 
+		PNG_ENCODE_PARALLEL | PNG_Z_BEST_COMPRESSION 
+	};
+
+	// pixel formats, using an image height spanning several groups of rows in parallel mode
+	{
+		UniqueBitmap rgba(createScreenshot(331, 1200), &::FreeImage_Unload);
+		UniqueBitmap rgb(FreeImage_ConvertTo24Bits(rgba.get()), &::FreeImage_Unload);
+		UniqueBitmap gray(FreeImage_ConvertToGreyscale(rgba.get()), &::FreeImage_Unload);
+
+		// 0 is white
+		UniqueBitmap inverted(FreeImage_Clone(gray.get()), &::FreeImage_Unload);
+		FreeImage_Invert(inverted.get());
+		FIRGBA8 *palette = FreeImage_GetPalette(inverted.get());
+		for (int i = 0; i < 256; i++) {
+			palette[i].red = palette[i].green = palette[i].blue = (uint8_t)(255 - i);
+		}
+
+		std::vector<UniqueBitmap> images;
+		for (FIBITMAP *dib : {
+			FreeImage_Clone(rgba.get()),
+			FreeImage_Clone(rgb.get()),
+			FreeImage_Clone(gray.get()),
+			FreeImage_ColorQuantize(rgb.get(), FIQ_WUQUANT),
+			FreeImage_ConvertTo4Bits(gray.get()),
+			FreeImage_Threshold(gray.get(), 128),
+			FreeImage_Clone(inverted.get()),
+			FreeImage_ConvertToType(gray.get(), FIT_UINT16),
+			FreeImage_ConvertToType(rgb.get(), FIT_RGB16),
+			FreeImage_ConvertToType(rgba.get(), FIT_RGBA16) }) {
+			assert(dib != nullptr);
+			images.emplace_back(dib, &::FreeImage_Unload);
+		}
+		assert(FreeImage_GetColorType(images[6].get()) == FIC_MINISWHITE);
+
+		// transparent greyscale, written with a palette
+		UniqueBitmap transparent(FreeImage_Clone(gray.get()), &::FreeImage_Unload);
+		uint8_t table[256];
+		for (int i = 0; i < 256; i++) {
+			table[i] = (uint8_t)i;
+		}
+		FreeImage_SetTransparencyTable(transparent.get(), table, 256);
+		images.push_back(std::move(transparent));
+
+		// 1-bit, 0 is white
+		UniqueBitmap mono(FreeImage_Threshold(gray.get(), 128), &::FreeImage_Unload);
+		FreeImage_Invert(mono.get());
+		palette = FreeImage_GetPalette(mono.get());
+		std::swap(palette[0], palette[1]);
+		assert(FreeImage_GetColorType(mono.get()) == FIC_MINISWHITE);
+		images.push_back(std::move(mono));
+
+		for (const auto& dib : images) {
+			for (int flags : presets) {
+				roundTripPNG(dib.get(), flags);
+			}
+		}
+	}
+}
+
+/**
+Scanline consumer used by testPNGDecode : rebuild the image from the streamed rows
+*/
+struct ScanlineCollector {
+	UniqueBitmap dib{ nullptr, &::FreeImage_Unload };
+	unsigned rows{ 0 };
+	unsigned stop_after{ 0 };	// 0 means never stop
+};
+
+static FIBOOL DLL_CALLCONV
+collectScanline(FIBITMAP *header, unsigned y, const uint8_t *bits, void *user_data) {
+	auto *collector = static_cast<ScanlineCollector*>(user_data);
+	if (!collector->dib) {
+		const unsigned bpp = FreeImage_GetBPP(header);
+		collector->dib.reset(FreeImage_AllocateT(FreeImage_GetImageType(header), FreeImage_GetWidth(header), FreeImage_GetHeight(header), bpp));
+		assert(collector->dib != nullptr);
+		if (FreeImage_GetColorsUsed(header)) {
+			memcpy(FreeImage_GetPalette(collector->dib.get()), FreeImage_GetPalette(header), FreeImage_GetColorsUsed(header) * sizeof(FIRGBA8));
+		}
+	}
+	// rows come top-down
+	assert(y == collector->rows);
+	const unsigned height = FreeImage_GetHeight(collector->dib.get());
+	memcpy(FreeImage_GetScanLine(collector->dib.get(), height - 1 - y), bits, FreeImage_GetLine(collector->dib.get()));
+	collector->rows++;
+	return (collector->rows != collector->stop_after) ? TRUE : FALSE;
+}
+
+/**
+Check the row streaming PNG decoder : scanline callback, 8-bit and RGBA conversions, downscaling on load
+*/
+void testPNGDecode() {
+	printf("testPNGDecode ...\n");
+
+	const char *lpszPathName = "decode.png";
+
+	UniqueBitmap rgba(createScreenshot(331, 200), &::FreeImage_Unload);
+	UniqueBitmap rgb(FreeImage_ConvertTo24Bits(rgba.get()), &::FreeImage_Unload);
+	UniqueBitmap gray(FreeImage_ConvertToGreyscale(rgba.get()), &::FreeImage_Unload);
+
+	std::vector<UniqueBitmap> images;
+	for (FIBITMAP *dib : {
+		FreeImage_Clone(rgba.get()),
+		FreeImage_Clone(rgb.get()),
+		FreeImage_Clone(gray.get()),
+		FreeImage_ColorQuantize(rgb.get(), FIQ_WUQUANT),
+		FreeImage_ConvertTo4Bits(gray.get()),
+		FreeImage_Threshold(gray.get(), 128),
+		FreeImage_ConvertToType(gray.get(), FIT_UINT16),
+		FreeImage_ConvertToType(rgb.get(), FIT_RGB16),
+		FreeImage_ConvertToType(rgba.get(), FIT_RGBA16) }) {
+		assert(dib != nullptr);
+		images.emplace_back(dib, &::FreeImage_Unload);
+	}
+
+	for (const auto& src : images) {
+		const FREE_IMAGE_TYPE type = FreeImage_GetImageType(src.get());
+		const unsigned bpp = FreeImage_GetBPP(src.get());
+
+		for (int save_flags : { PNG_DEFAULT, PNG_INTERLACED }) {
+			FIBOOL bSuccess = FreeImage_Save(FIF_PNG, src.get(), lpszPathName, save_flags);
+			assert(bSuccess);
+
+			UniqueBitmap full(FreeImage_Load(FIF_PNG, lpszPathName, 0), &::FreeImage_Unload);
+			assert(full != nullptr);
+			assert(equalPixels(src.get(), full.get()));
+
+			// streamed rows match the full decode
+			{
+				ScanlineCollector collector;
+				bSuccess = FreeImage_LoadScanlines(FIF_PNG, lpszPathName, collectScanline, &collector, 0);
+				assert(bSuccess);
+				assert(collector.rows == FreeImage_GetHeight(src.get()));
+				assert(equalPixels(full.get(), collector.dib.get()));
+			}
+
+			// the consumer can stop decoding
+			{
+				ScanlineCollector collector;
+				collector.stop_after = 10;
+				bSuccess = FreeImage_LoadScanlines(FIF_PNG, lpszPathName, collectScanline, &collector, 0);
+				assert(!bSuccess);
+				assert(collector.rows == 10);
+			}
+
+			// 16-bit samples scaled down to 8-bit
+			{
+				UniqueBitmap dib(FreeImage_Load(FIF_PNG, lpszPathName, PNG_LOAD_8BIT), &::FreeImage_Unload);
+				assert(dib != nullptr);
+				assert(FreeImage_GetImageType(dib.get()) == FIT_BITMAP);
+				if (type == FIT_BITMAP) {
+					assert(equalPixels(src.get(), dib.get()));
+				} else {
+					assert(FreeImage_GetBPP(dib.get()) == ((type == FIT_UINT16) ? 8U : (type == FIT_RGB16) ? 24U : 32U));
+					if (type == FIT_UINT16) {
+						// rounded to the nearest 8-bit value
+						for (unsigned y = 0; y < FreeImage_GetHeight(dib.get()); y++) {
+							const uint16_t *src_bits = (const uint16_t*)FreeImage_GetScanLine(src.get(), y);
+							const uint8_t *dst_bits = FreeImage_GetScanLine(dib.get(), y);
+							for (unsigned x = 0; x < FreeImage_GetWidth(dib.get()); x++) {
+								assert(dst_bits[x] == (src_bits[x] * 255U + 32767U) / 65535U);
+							}
+						}
+					}
+				}
+			}
+
+			// any color type expanded to RGBA
+			{
+				UniqueBitmap dib(FreeImage_Load(FIF_PNG, lpszPathName, PNG_LOAD_RGBA), &::FreeImage_Unload);
+				assert(dib != nullptr);
+				if (type == FIT_BITMAP) {
+					assert(FreeImage_GetBPP(dib.get()) == 32);
+					UniqueBitmap expected(FreeImage_ConvertTo32Bits(full.get()), &::FreeImage_Unload);
+					assert(equalPixels(expected.get(), dib.get()));
+				} else {
+					assert(FreeImage_GetImageType(dib.get()) == FIT_RGBA16);
+					UniqueBitmap expected(FreeImage_ConvertToType(full.get(), FIT_RGBA16), &::FreeImage_Unload);
+					if (type != FIT_UINT16) {
+						assert(equalPixels(expected.get(), dib.get()));
+					}
+				}
+			}
+		}
+
+		// box filter downscaling : the largest side is >= the requested size
+		{
+			const unsigned requested_size = 60;
+			const int flags = requested_size << 16;
+			UniqueBitmap dib(FreeImage_Load(FIF_PNG, lpszPathName, flags), &::FreeImage_Unload);
+			assert(dib != nullptr);
+			// 331 / 60 = 5
+			assert(FreeImage_GetWidth(dib.get()) == 67);
+			assert(FreeImage_GetHeight(dib.get()) == 40);
+			if (type == FIT_BITMAP) {
+				assert(FreeImage_GetBPP(dib.get()) == ((bpp == 24) ? 24U : (bpp == 8) && (FreeImage_GetColorType(src.get()) == FIC_MINISBLACK) ? 8U : 32U));
+			}
+			FITAG *tag = nullptr;
+			FreeImage_GetMetadata(FIMD_COMMENTS, dib.get(), "OriginalPNGWidth", &tag);
+			assert(tag && (strcmp((const char*)FreeImage_GetTagValue(tag), "331") == 0));
+
+			// header only probing reports the scaled size
+			UniqueBitmap header(FreeImage_Load(FIF_PNG, lpszPathName, flags | FIF_LOAD_NOPIXELS), &::FreeImage_Unload);
+			assert(header != nullptr && !FreeImage_HasPixels(header.get()));
+			assert(FreeImage_GetWidth(header.get()) == 67);
+
+			// streaming gives the same result
+			ScanlineCollector collector;
+			FIBOOL bSuccess = FreeImage_LoadScanlines(FIF_PNG, lpszPathName, collectScanline, &collector, flags);
+			assert(bSuccess);
+			assert(equalPixels(dib.get(), collector.dib.get()));
+
+			if (bpp == 24) {
+				// check a box average
+				unsigned sum[3] = { 0, 0, 0 };
+				for (unsigned y = 0; y < 5; y++) {
+					const uint8_t *bits = FreeImage_GetScanLine(src.get(), FreeImage_GetHeight(src.get()) - 1 - (10 + y));
+					for (unsigned x = 0; x < 5; x++) {
+						for (unsigned c = 0; c < 3; c++) {
+							sum[c] += bits[(20 + x) * 3 + c];
+						}
+					}
+				}
+				const uint8_t *bits = FreeImage_GetScanLine(dib.get(), FreeImage_GetHeight(dib.get()) - 1 - 2);
+				for (unsigned c = 0; c < 3; c++) {
+					assert(bits[4 * 3 + c] == (sum[c] + 12) / 25);
+				}
+			}
+		}
+	}
+
+	// formats without a streaming decoder load the image and feed its rows
+	{
+		FIBOOL bSuccess = FreeImage_Save(FIF_BMP, rgb.get(), "decode.bmp", 0);
+		assert(bSuccess);
+		ScanlineCollector collector;
+		bSuccess = FreeImage_LoadScanlines(FIF_BMP, "decode.bmp", collectScanline, &collector, 0);
+		assert(bSuccess);
+		assert(equalPixels(rgb.get(), collector.dib.get()));
+	}
+}
+
+// ----------------------------------------------------------
+
+void testAPNG(const char *lpszPathName) {
+	printf("testAPNG ...\n");
+
+	testAPNGComposition("apng.png");
+	testAPNGLargeFrames("apng_large.png");
+	testAPNGFromGIF(lpszPathName);
+}
@@ -0,0 +1,151 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace {
+
+	/** Smooth test function */
+	double potential(unsigned x, unsigned y, unsigned width, unsigned height) {
+		const double u = (x + 0.5) / width, v = (y + 0.5) / height;
+		return std::sin(3 * u + 1) * std::cos(2 * v) + 0.5 * u * u - v * v * v + 0.25 * std::sin(17 * u * v);
+	}
+
+	/** 5-point Laplacian of the potential, with the image reflected across its edges */
+	UniqueBitmap laplacian(unsigned width, unsigned height) {
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+		auto value = [&](int x, int y) {
+			x = std::clamp(x, 0, (int)width - 1);
+			y = std::clamp(y, 0, (int)height - 1);
+			return potential(x, y, width, height);
+		};
+		for (unsigned y = 0; y < height; y++) {
+			float *bits = (float*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				bits[x] = (float)(value(x - 1, y) + value(x + 1, y) + value(x, y - 1) + value(x, y + 1) - 4 * value(x, y));
+			}
+		}
+		return dib;
+	}
+
+	/** 5-point Laplacian of a Gaussian bump centered in the image, flat at the image edges */
+	UniqueBitmap bumpLaplacian(unsigned width, unsigned height) {
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+		const double cx = width / 2.0, cy = height / 2.0, sigma = std::min(width, height) / 10.0;
+		auto bump = [&](int x, int y) {
+			return std::exp(-((x - cx) * (x - cx) + (y - cy) * (y - cy)) / (2 * sigma * sigma));
+		};
+		for (unsigned y = 0; y < height; y++) {
+			float *bits = (float*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				bits[x] = (float)(bump(x - 1, y) + bump(x + 1, y) + bump(x, y - 1) + bump(x, y + 1) - 4 * bump(x, y));
+			}
+		}
+		return dib;
+	}
+
+	/** Largest difference between two FIT_FLOAT images of the same size */
+	double maxDifference(FIBITMAP *a, FIBITMAP *b) {
+		double difference = 0;
+		for (unsigned y = 0; y < FreeImage_GetHeight(a); y++) {
+			const float *bits_a = (const float*)FreeImage_GetScanLine(a, y);
+			const float *bits_b = (const float*)FreeImage_GetScanLine(b, y);
+			for (unsigned x = 0; x < FreeImage_GetWidth(a); x++) {
+				difference = std::max(difference, (double)std::abs(bits_a[x] - bits_b[x]));
+			}
+		}
+		return difference;
+	}
+
+	/** Largest difference between the solution and the potential remapped to [0..1] */
+	double solutionError(FIBITMAP *U) {
+		const unsigned width = FreeImage_GetWidth(U), height = FreeImage_GetHeight(U);
+		double minValue = 1e300, maxValue = -1e300;
+		for (unsigned y = 0; y < height; y++) {
+			for (unsigned x = 0; x < width; x++) {
+				minValue = std::min(minValue, potential(x, y, width, height));
+				maxValue = std::max(maxValue, potential(x, y, width, height));
+			}
+		}
+		double error = 0;
+		for (unsigned y = 0; y < height; y++) {
+			const float *bits = (const float*)FreeImage_GetScanLine(U, y);
+			for (unsigned x = 0; x < width; x++) {
+				const double expected = (potential(x, y, width, height) - minValue) / (maxValue - minValue);
+				error = std::max(error, std::abs(bits[x] - expected));
+			}
+		}
+		return error;
+	}
+
+} // namespace
+
+void testPoissonSolver()
+{
+	printf("testPoissonSolver ...\n");
+
+	// mixed radix, Bluestein (prime sizes above 61) and degenerate sizes
+	const unsigned sizes[][2] = { { 64, 48 }, { 67, 31 }, { 127, 90 }, { 1, 40 }, { 33, 1 }, { 257, 211 } };
+	for (const auto& size : sizes) {
+		UniqueBitmap L = laplacian(size[0], size[1]);
+		UniqueBitmap U(FreeImage_DCTPoissonSolver(L.get()), &::FreeImage_Unload);
+		assert(U != nullptr);
+		assert(FreeImage_GetImageType(U.get()) == FIT_FLOAT);
+		assert(FreeImage_GetWidth(U.get()) == size[0] && FreeImage_GetHeight(U.get()) == size[1]);
+		assert(solutionError(U.get()) < 1e-3);
+	}
+
+	// unsupported images
+	{
+		UniqueBitmap rgb(FreeImage_AllocateT(FIT_RGBF, 16, 16), &::FreeImage_Unload);
+		assert(FreeImage_DCTPoissonSolver(rgb.get()) == nullptr);
+		assert(FreeImage_DCTPoissonSolver(nullptr) == nullptr);
+	}
+
+	// gradient domain tone mapping, solved on the rectangular domain of the image
+	{
+		UniqueBitmap hdr(FreeImage_AllocateT(FIT_RGBF, 150, 97), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 97; y++) {
+			FIRGBF *pixel = (FIRGBF*)FreeImage_GetScanLine(hdr.get(), y);
+			for (unsigned x = 0; x < 150; x++) {
+				const float level = (float)std::exp(0.08 * x - 4 + 0.5 * std::sin(0.3 * y));
+				pixel[x].red = level;
+				pixel[x].green = 0.7F * level;
+				pixel[x].blue = 0.4F * level;
+			}
+		}
+		UniqueBitmap res(FreeImage_TmoFattal02(hdr.get()), &::FreeImage_Unload);
+		assert(res != nullptr && FreeImage_GetBPP(res.get()) == 24);
+		assert(FreeImage_GetWidth(res.get()) == 150 && FreeImage_GetHeight(res.get()) == 97);
+	}
+
+	// both solvers, on a rectangular domain : 
+	// the bump is flat at the edges, so the Neumann (DCT) and the zero padded (multigrid) boundaries give the same solution
+	{
+		UniqueBitmap L = bumpLaplacian(192, 108);
+		UniqueBitmap dct(FreeImage_DCTPoissonSolver(L.get()), &::FreeImage_Unload);
+		UniqueBitmap multigrid(FreeImage_MultigridPoissonSolver(L.get(), 3), &::FreeImage_Unload);
+		assert(dct != nullptr && multigrid != nullptr);
+		assert(FreeImage_GetWidth(multigrid.get()) == 192 && FreeImage_GetHeight(multigrid.get()) == 108);
+		assert(maxDifference(dct.get(), multigrid.get()) < 1e-3);
+	}
+}
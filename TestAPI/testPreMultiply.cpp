@@ -0,0 +1,258 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+// ----------------------------------------------------------
+
+namespace {
+
+	/** Straight 8-bit composition, rounded to nearest */
+	unsigned compositeRef8(unsigned f, unsigned a, unsigned b) {
+		return (f * a + b * (255 - a) + 127) / 255;
+	}
+
+} // namespace
+
+/**
+Test FreeImage_PreMultiplyWithAlpha, FreeImage_UnPreMultiplyWithAlpha, FreeImage_Composite and FreeImage_CompositeEx
+*/
+void testPreMultiplyWithAlpha() {
+	printf("testPreMultiplyWithAlpha ...\n");
+
+	// 32-bit : every (color, alpha) pair, width not a multiple of the vector width
+	{
+		const unsigned width = 259;
+		UniqueBitmap dib(FreeImage_Allocate(width, 256, 32), &::FreeImage_Unload);
+		for (unsigned a = 0; a < 256; a++) {
+			FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib.get(), a);
+			for (unsigned x = 0; x < width; x++) {
+				const unsigned c = x & 0xFF;
+				bits[x].red = (uint8_t)c;
+				bits[x].green = (uint8_t)(255 - c);
+				bits[x].blue = (uint8_t)(c ^ 0x55);
+				bits[x].alpha = (uint8_t)a;
+			}
+		}
+		assert(FreeImage_PreMultiplyWithAlpha(dib.get()));
+		for (unsigned a = 0; a < 256; a++) {
+			const FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib.get(), a);
+			for (unsigned x = 0; x < width; x++) {
+				const unsigned c = x & 0xFF;
+				assert(bits[x].red == (c * a + 127) / 255);
+				assert(bits[x].green == ((255 - c) * a + 127) / 255);
+				assert(bits[x].blue == ((c ^ 0x55) * a + 127) / 255);
+				assert(bits[x].alpha == a);
+			}
+		}
+		assert(FreeImage_UnPreMultiplyWithAlpha(dib.get()));
+		for (unsigned a = 0; a < 256; a++) {
+			const FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib.get(), a);
+			for (unsigned x = 0; x < width; x++) {
+				const unsigned c = x & 0xFF;
+				if (a == 0) {
+					assert(bits[x].red == 0 && bits[x].green == 0 && bits[x].blue == 0);
+				} else {
+					// the premultiplied value is rounded by 0.5 at most
+					const double tolerance = 127.5 / a + 0.5;
+					assert(std::abs((int)bits[x].red - (int)c) <= tolerance);
+					assert(std::abs((int)bits[x].green - (int)(255 - c)) <= tolerance);
+					if (a == 255) {
+						assert(bits[x].blue == (c ^ 0x55));
+					}
+				}
+				assert(bits[x].alpha == a);
+			}
+		}
+	}
+
+	// RGBA16
+	{
+		const unsigned width = 101, height = 67;
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_RGBA16, width, height), &::FreeImage_Unload);
+		fillRandom(dib.get(), 1);
+		UniqueBitmap src(FreeImage_Clone(dib.get()), &::FreeImage_Unload);
+		assert(FreeImage_PreMultiplyWithAlpha(dib.get()));
+		for (unsigned y = 0; y < height; y++) {
+			const FIRGBA16 *s = (FIRGBA16*)FreeImage_GetScanLine(src.get(), y);
+			const FIRGBA16 *d = (FIRGBA16*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				const uint64_t a = s[x].alpha;
+				assert(d[x].red == (s[x].red * a + 32767) / 65535);
+				assert(d[x].green == (s[x].green * a + 32767) / 65535);
+				assert(d[x].blue == (s[x].blue * a + 32767) / 65535);
+				assert(d[x].alpha == s[x].alpha);
+			}
+		}
+		assert(FreeImage_UnPreMultiplyWithAlpha(dib.get()));
+		for (unsigned y = 0; y < height; y++) {
+			const FIRGBA16 *s = (FIRGBA16*)FreeImage_GetScanLine(src.get(), y);
+			const FIRGBA16 *d = (FIRGBA16*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				const double tolerance = s[x].alpha ? 32767.5 / s[x].alpha + 0.5 : 0;
+				assert(std::abs((int)d[x].red - (int)(s[x].alpha ? s[x].red : 0)) <= tolerance);
+				assert(std::abs((int)d[x].blue - (int)(s[x].alpha ? s[x].blue : 0)) <= tolerance);
+				assert(d[x].alpha == s[x].alpha);
+			}
+		}
+	}
+
+	// RGBAF
+	{
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_RGBAF, 5, 1), &::FreeImage_Unload);
+		FIRGBAF *bits = (FIRGBAF*)FreeImage_GetScanLine(dib.get(), 0);
+		const float alphas[] = { 0.0f, 0.25f, 0.5f, 1.0f, 0.75f };
+		for (unsigned x = 0; x < 5; x++) {
+			bits[x].red = 0.2f * x;
+			bits[x].green = 1.5f;
+			bits[x].blue = 0.5f;
+			bits[x].alpha = alphas[x];
+		}
+		assert(FreeImage_PreMultiplyWithAlpha(dib.get()));
+		for (unsigned x = 0; x < 5; x++) {
+			assert(std::fabs(bits[x].red - 0.2f * x * alphas[x]) < 1e-6f);
+			assert(std::fabs(bits[x].green - 1.5f * alphas[x]) < 1e-6f);
+			assert(bits[x].alpha == alphas[x]);
+		}
+		assert(FreeImage_UnPreMultiplyWithAlpha(dib.get()));
+		assert(bits[0].red == 0 && bits[0].green == 0 && bits[0].blue == 0);
+		for (unsigned x = 1; x < 5; x++) {
+			assert(std::fabs(bits[x].red - 0.2f * x) < 1e-6f);
+			assert(std::fabs(bits[x].green - 1.5f) < 1e-6f);
+			assert(bits[x].alpha == alphas[x]);
+		}
+	}
+
+	// unsupported formats
+	{
+		UniqueBitmap dib24(FreeImage_Allocate(16, 16, 24), &::FreeImage_Unload);
+		assert(!FreeImage_PreMultiplyWithAlpha(dib24.get()));
+		assert(!FreeImage_UnPreMultiplyWithAlpha(dib24.get()));
+		UniqueBitmap dib_rgb16(FreeImage_AllocateT(FIT_RGB16, 16, 16), &::FreeImage_Unload);
+		assert(!FreeImage_PreMultiplyWithAlpha(dib_rgb16.get()));
+	}
+
+	// 32-bit composition over a background image, straight and premultiplied
+	{
+		const unsigned width = 37, height = 21;
+		UniqueBitmap fg(FreeImage_Allocate(width, height, 32), &::FreeImage_Unload);
+		UniqueBitmap bg(FreeImage_Allocate(width, height, 24), &::FreeImage_Unload);
+		fillRandom(fg.get(), 2);
+		fillRandom(bg.get(), 3);
+		UniqueBitmap straight(FreeImage_Composite(fg.get(), FALSE, NULL, bg.get()), &::FreeImage_Unload);
+		assert(straight && FreeImage_GetBPP(straight.get()) == 24);
+		UniqueBitmap premultiplied_fg(FreeImage_Clone(fg.get()), &::FreeImage_Unload);
+		assert(FreeImage_PreMultiplyWithAlpha(premultiplied_fg.get()));
+		UniqueBitmap premultiplied(FreeImage_CompositeEx(premultiplied_fg.get(), FALSE, NULL, bg.get(), FI_ALPHA_PREMULTIPLIED), &::FreeImage_Unload);
+		assert(premultiplied);
+		for (unsigned y = 0; y < height; y++) {
+			const uint8_t *f = FreeImage_GetScanLine(fg.get(), y);
+			const uint8_t *b = FreeImage_GetScanLine(bg.get(), y);
+			const uint8_t *s = FreeImage_GetScanLine(straight.get(), y);
+			const uint8_t *p = FreeImage_GetScanLine(premultiplied.get(), y);
+			for (unsigned x = 0; x < width; x++, f += 4, b += 3, s += 3, p += 3) {
+				for (unsigned c = 0; c < 3; c++) {
+					assert(s[c] == compositeRef8(f[c], f[FI_RGBA_ALPHA], b[c]));
+					assert(std::abs((int)p[c] - (int)s[c]) <= 1);
+				}
+			}
+		}
+	}
+
+	// 8-bit with transparency over an application color and over the checkerboard
+	{
+		UniqueBitmap fg(FreeImage_Allocate(32, 16, 8), &::FreeImage_Unload);
+		FIRGBA8 *pal = FreeImage_GetPalette(fg.get());
+		for (unsigned i = 0; i < 256; i++) {
+			pal[i].red = (uint8_t)i;
+			pal[i].green = (uint8_t)(i / 2);
+			pal[i].blue = 0;
+		}
+		uint8_t table[2] = { 0, 128 };
+		FreeImage_SetTransparencyTable(fg.get(), table, 2);
+		for (unsigned y = 0; y < 16; y++) {
+			uint8_t *bits = FreeImage_GetScanLine(fg.get(), y);
+			for (unsigned x = 0; x < 32; x++) {
+				bits[x] = (uint8_t)(x % 3);
+			}
+		}
+		FIRGBA8 color = { 0 };
+		color.red = 10;
+		color.green = 20;
+		color.blue = 200;
+		UniqueBitmap over_color(FreeImage_Composite(fg.get(), FALSE, &color), &::FreeImage_Unload);
+		UniqueBitmap over_checker(FreeImage_Composite(fg.get()), &::FreeImage_Unload);
+		assert(over_color && over_checker);
+		for (unsigned y = 0; y < 16; y++) {
+			const FIRGB8 *c = (FIRGB8*)FreeImage_GetScanLine(over_color.get(), y);
+			const FIRGB8 *k = (FIRGB8*)FreeImage_GetScanLine(over_checker.get(), y);
+			for (unsigned x = 0; x < 32; x++) {
+				const unsigned index = x % 3;
+				const unsigned alpha = (index < 2) ? table[index] : 255;
+				assert(c[x].red == compositeRef8(pal[index].red, alpha, color.red));
+				assert(c[x].blue == compositeRef8(pal[index].blue, alpha, color.blue));
+				const unsigned checker = (((y & 0x8) == 0) ^ ((x & 0x8) == 0)) ? 192 : 255;
+				assert(k[x].green == compositeRef8(pal[index].green, alpha, checker));
+			}
+		}
+	}
+
+	// RGBA16 and RGBAF composition
+	{
+		UniqueBitmap fg16(FreeImage_AllocateT(FIT_RGBA16, 19, 7), &::FreeImage_Unload);
+		UniqueBitmap bg16(FreeImage_AllocateT(FIT_RGB16, 19, 7), &::FreeImage_Unload);
+		fillRandom(fg16.get(), 4);
+		fillRandom(bg16.get(), 5);
+		UniqueBitmap result16(FreeImage_Composite(fg16.get(), FALSE, NULL, bg16.get()), &::FreeImage_Unload);
+		assert(result16 && FreeImage_GetImageType(result16.get()) == FIT_RGB16);
+		for (unsigned y = 0; y < 7; y++) {
+			const FIRGBA16 *f = (FIRGBA16*)FreeImage_GetScanLine(fg16.get(), y);
+			const FIRGB16 *b = (FIRGB16*)FreeImage_GetScanLine(bg16.get(), y);
+			const FIRGB16 *r = (FIRGB16*)FreeImage_GetScanLine(result16.get(), y);
+			for (unsigned x = 0; x < 19; x++) {
+				const uint64_t a = f[x].alpha;
+				assert(r[x].red == (f[x].red * a + b[x].red * (65535 - a) + 32767) / 65535);
+				assert(r[x].blue == (f[x].blue * a + b[x].blue * (65535 - a) + 32767) / 65535);
+			}
+		}
+		UniqueBitmap bg24(FreeImage_Allocate(19, 7, 24), &::FreeImage_Unload);
+		assert(!FreeImage_Composite(fg16.get(), FALSE, NULL, bg24.get()));
+
+		UniqueBitmap fgf(FreeImage_AllocateT(FIT_RGBAF, 3, 1), &::FreeImage_Unload);
+		FIRGBAF *f = (FIRGBAF*)FreeImage_GetScanLine(fgf.get(), 0);
+		for (unsigned x = 0; x < 3; x++) {
+			f[x].red = 0.5f;
+			f[x].green = 0.25f;
+			f[x].blue = 1.0f;
+			f[x].alpha = 0.5f * x;
+		}
+		FIRGBA8 white = { 255, 255, 255, 255 };
+		UniqueBitmap resultf(FreeImage_Composite(fgf.get(), FALSE, &white), &::FreeImage_Unload);
+		assert(resultf && FreeImage_GetImageType(resultf.get()) == FIT_RGBF);
+		const FIRGBF *r = (FIRGBF*)FreeImage_GetScanLine(resultf.get(), 0);
+		for (unsigned x = 0; x < 3; x++) {
+			const float a = 0.5f * x;
+			assert(std::fabs(r[x].red - (0.5f * a + (1 - a))) < 1e-6f);
+			assert(std::fabs(r[x].green - (0.25f * a + (1 - a))) < 1e-6f);
+		}
+	}
+}
@@ -0,0 +1,226 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+	/** Photo-like test image : smooth colour gradients with some noise */
+	UniqueBitmap makeImage(unsigned width, unsigned height, unsigned bpp) {
+		UniqueBitmap dib(FreeImage_Allocate(width, height, bpp), &::FreeImage_Unload);
+		const unsigned bytespp = bpp / 8;
+		unsigned seed = 11;
+		for (unsigned y = 0; y < height; y++) {
+			uint8_t *bits = FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				const int noise = (int)(nextRandom(seed) & 7) - 4;
+				bits[FI_RGBA_RED] = (uint8_t)std::clamp((int)(255 * x / width) + noise, 0, 255);
+				bits[FI_RGBA_GREEN] = (uint8_t)std::clamp((int)(127.5 + 127.5 * std::sin(0.01 * (x + y))) + noise, 0, 255);
+				bits[FI_RGBA_BLUE] = (uint8_t)std::clamp((int)(255 * y / height) - noise, 0, 255);
+				if (bytespp == 4) {
+					bits[FI_RGBA_ALPHA] = 0xFF;
+				}
+				bits += bytespp;
+			}
+		}
+		return dib;
+	}
+
+	int distance(const uint8_t *bits, const FIRGBA8& entry) {
+		return std::abs(bits[FI_RGBA_RED] - entry.red) + std::abs(bits[FI_RGBA_GREEN] - entry.green) + std::abs(bits[FI_RGBA_BLUE] - entry.blue);
+	}
+
+	/** Mean L1 distance between the image and its quantized version */
+	double meanError(FIBITMAP *src, FIBITMAP *dst) {
+		const unsigned width = FreeImage_GetWidth(src), height = FreeImage_GetHeight(src);
+		const unsigned bytespp = FreeImage_GetBPP(src) / 8;
+		const FIRGBA8 *palette = FreeImage_GetPalette(dst);
+		double error = 0;
+		for (unsigned y = 0; y < height; y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(src, y);
+			const uint8_t *index = FreeImage_GetScanLine(dst, y);
+			for (unsigned x = 0; x < width; x++, bits += bytespp) {
+				error += distance(bits, palette[index[x]]);
+			}
+		}
+		return error / ((double)width * height);
+	}
+
+	int squaredDistance(const uint8_t *bits, const FIRGBA8& entry) {
+		const int dr = bits[FI_RGBA_RED] - entry.red, dg = bits[FI_RGBA_GREEN] - entry.green, db = bits[FI_RGBA_BLUE] - entry.blue;
+		return dr * dr + dg * dg + db * db;
+	}
+
+	/** Mean error of the local average colour, over blocks of 8x8 pixels */
+	double blockError(FIBITMAP *src, FIBITMAP *dst) {
+		const unsigned width = FreeImage_GetWidth(src), height = FreeImage_GetHeight(src);
+		const unsigned bytespp = FreeImage_GetBPP(src) / 8;
+		const FIRGBA8 *palette = FreeImage_GetPalette(dst);
+		double error = 0;
+		unsigned blocks = 0;
+		for (unsigned by = 0; by + 8 <= height; by += 8) {
+			for (unsigned bx = 0; bx + 8 <= width; bx += 8, blocks++) {
+				int diff[3] = {};
+				for (unsigned y = by; y < by + 8; y++) {
+					const uint8_t *bits = FreeImage_GetScanLine(src, y) + bx * bytespp;
+					const uint8_t *index = FreeImage_GetScanLine(dst, y) + bx;
+					for (unsigned x = 0; x < 8; x++, bits += bytespp) {
+						diff[0] += bits[FI_RGBA_RED] - palette[index[x]].red;
+						diff[1] += bits[FI_RGBA_GREEN] - palette[index[x]].green;
+						diff[2] += bits[FI_RGBA_BLUE] - palette[index[x]].blue;
+					}
+				}
+				error += (std::abs(diff[0]) + std::abs(diff[1]) + std::abs(diff[2])) / 64.0;
+			}
+		}
+		return error / blocks;
+	}
+
+} // namespace
+
+void testQuantize()
+{
+	printf("testQuantize ...\n");
+
+	// Wu quantizer, 24-bit and 32-bit
+	for (unsigned bpp : { 24U, 32U }) {
+		UniqueBitmap src = makeImage(640, 480, bpp);
+		UniqueBitmap dst(FreeImage_ColorQuantizeEx(src.get(), FIQ_WUQUANT, 256), &::FreeImage_Unload);
+		assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == 8);
+		assert(meanError(src.get(), dst.get()) < 32);
+	}
+
+	// NeuQuant : every pixel is mapped to its nearest palette entry (L1 distance)
+	{
+		UniqueBitmap src = makeImage(320, 240, 24);
+		UniqueBitmap dst(FreeImage_ColorQuantizeEx(src.get(), FIQ_NNQUANT, 64), &::FreeImage_Unload);
+		assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == 8);
+		const FIRGBA8 *palette = FreeImage_GetPalette(dst.get());
+		for (unsigned y = 0; y < 240; y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(src.get(), y);
+			const uint8_t *index = FreeImage_GetScanLine(dst.get(), y);
+			for (unsigned x = 0; x < 320; x++, bits += 3) {
+				int best = 1000;
+				for (unsigned i = 0; i < 64; i++) {
+					best = std::min(best, distance(bits, palette[i]));
+				}
+				assert(distance(bits, palette[index[x]]) == best);
+			}
+		}
+	}
+
+	// reserved palette entries are kept
+	{
+		UniqueBitmap src = makeImage(160, 120, 24);
+		FIRGBA8 reserve[2] = { { 0, 0, 0, 0 }, { 255, 255, 255, 0 } };
+		UniqueBitmap dst(FreeImage_ColorQuantizeEx(src.get(), FIQ_WUQUANT, 16, 2, reserve), &::FreeImage_Unload);
+		assert(dst != nullptr);
+	}
+
+	// palette computed once for several frames, then applied to each frame
+	{
+		UniqueBitmap frame0 = makeImage(200, 150, 24);
+		UniqueBitmap frame1 = makeImage(180, 160, 32);
+		UniqueBitmap frame2 = makeImage(120, 90, 24);
+		FIBITMAP *frames[3] = { frame0.get(), frame1.get(), frame2.get() };
+		FIRGBA8 palette[256] = {}, again[256] = {};
+		const int size = FreeImage_ComputePalette(frames, 3, FIQ_WUQUANT, 64, palette);
+		assert(size >= 2 && size <= 64);
+		assert(FreeImage_ComputePalette(frames, 3, FIQ_WUQUANT, 64, again) == size);
+		assert(std::equal(palette, palette + size, again, [](const FIRGBA8& a, const FIRGBA8& b) {
+			return a.red == b.red && a.green == b.green && a.blue == b.blue;
+		}));
+		assert(FreeImage_ComputePalette(frames, 3, FIQ_NNQUANT, 32, again) == 32);
+		assert(FreeImage_ComputePalette(frames, 0, FIQ_WUQUANT, 64, again) == 0);
+
+		// no dithering : every pixel gets its nearest palette entry (squared distance, lowest index)
+		for (FIBITMAP *frame : frames) {
+			UniqueBitmap dst(FreeImage_MapToPalette(frame, palette, size), &::FreeImage_Unload);
+			assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == 8);
+			assert(FreeImage_GetPalette(dst.get())[size - 1].red == palette[size - 1].red);
+			const unsigned bytespp = FreeImage_GetBPP(frame) / 8;
+			for (unsigned y = 0; y < FreeImage_GetHeight(frame); y++) {
+				const uint8_t *bits = FreeImage_GetScanLine(frame, y);
+				const uint8_t *index = FreeImage_GetScanLine(dst.get(), y);
+				for (unsigned x = 0; x < FreeImage_GetWidth(frame); x++, bits += bytespp) {
+					int best = 0;
+					for (int i = 1; i < size; i++) {
+						if (squaredDistance(bits, palette[i]) < squaredDistance(bits, palette[best])) {
+							best = i;
+						}
+					}
+					assert(index[x] == best);
+				}
+			}
+		}
+	}
+
+	// the moments of many full HD frames exceed 32-bit sums : a dominant colour must keep its palette entry
+	{
+		const unsigned frame_count = 12;
+		std::vector<UniqueBitmap> owners;
+		std::vector<FIBITMAP*> frames;
+		for (unsigned i = 0; i < frame_count; i++) {
+			owners.push_back(makeImage(1920, 1080, 24));
+			FIBITMAP *frame = owners.back().get();
+			// light background over the upper 3/4 of the frame
+			for (unsigned y = 1080 / 4; y < 1080; y++) {
+				uint8_t *bits = FreeImage_GetScanLine(frame, y);
+				memset(bits, 250, 1920 * 3);
+			}
+			frames.push_back(frame);
+		}
+		FIRGBA8 palette[256] = {};
+		const int size = FreeImage_ComputePalette(frames.data(), (int)frame_count, FIQ_WUQUANT, 16, palette);
+		assert(size >= 2 && size <= 16);
+		const uint8_t background[4] = { 250, 250, 250, 250 };
+		int best = 1000;
+		for (int i = 0; i < size; i++) {
+			best = std::min(best, distance(background, palette[i]));
+		}
+		assert(best <= 3);
+	}
+
+	// error diffusion keeps the local average colour (the 8 corners of the RGB cube can reach any colour)
+	{
+		UniqueBitmap src = makeImage(256, 192, 24);
+		FIRGBA8 palette[8] = {};
+		const int size = 8;
+		for (int i = 0; i < size; i++) {
+			palette[i].red = (i & 1) ? 255 : 0;
+			palette[i].green = (i & 2) ? 255 : 0;
+			palette[i].blue = (i & 4) ? 255 : 0;
+		}
+		UniqueBitmap none(FreeImage_MapToPalette(src.get(), palette, size, FIDF_NONE), &::FreeImage_Unload);
+		UniqueBitmap fs(FreeImage_MapToPalette(src.get(), palette, size, FIDF_FLOYD_STEINBERG), &::FreeImage_Unload);
+		UniqueBitmap sierra(FreeImage_MapToPalette(src.get(), palette, size, FIDF_SIERRA_LITE), &::FreeImage_Unload);
+		assert(none != nullptr && fs != nullptr && sierra != nullptr);
+		const double none_error = blockError(src.get(), none.get());
+		assert(blockError(src.get(), fs.get()) < 0.1 * none_error);
+		assert(blockError(src.get(), sierra.get()) < 0.1 * none_error);
+		assert(FreeImage_MapToPalette(src.get(), palette, 0) == nullptr);
+		assert(FreeImage_MapToPalette(none.get(), palette, size) == nullptr);
+	}
+}
@@ -0,0 +1,152 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+// ----------------------------------------------------------
+
+namespace {
+
+	/** Rescale with FI_RESCALE_LINEAR_LIGHT */
+	FIBITMAP* rescaleLinear(FIBITMAP *src, int width, int height, FREE_IMAGE_FILTER filter) {
+		return FreeImage_RescaleRect(src, width, height, 0, 0, FreeImage_GetWidth(src), FreeImage_GetHeight(src), filter, FI_RESCALE_LINEAR_LIGHT);
+	}
+
+	/** Fill a 24-bit or 32-bit image with a one pixel checkerboard of two colors */
+	void fillCheckerboard(FIBITMAP *dib, const FIRGBA8& even, const FIRGBA8& odd) {
+		const unsigned bytespp = FreeImage_GetBPP(dib) / 8;
+		for (unsigned y = 0; y < FreeImage_GetHeight(dib); y++) {
+			uint8_t *bits = FreeImage_GetScanLine(dib, y);
+			for (unsigned x = 0; x < FreeImage_GetWidth(dib); x++, bits += bytespp) {
+				const FIRGBA8& c = ((x + y) & 1) ? odd : even;
+				bits[FI_RGBA_RED] = c.red;
+				bits[FI_RGBA_GREEN] = c.green;
+				bits[FI_RGBA_BLUE] = c.blue;
+				if (bytespp == 4) {
+					bits[FI_RGBA_ALPHA] = c.alpha;
+				}
+			}
+		}
+	}
+
+} // namespace
+
+/**
+Test FreeImage_RescaleRect with FI_RESCALE_LINEAR_LIGHT
+*/
+void testRescaleLinearLight() {
+	printf("testRescaleLinearLight ...\n");
+
+	// flat images keep their value
+	{
+		UniqueBitmap dib(FreeImage_Allocate(16, 12, 24), &::FreeImage_Unload);
+		for (unsigned v = 0; v < 256; v++) {
+			FIRGBA8 color = { (uint8_t)v, (uint8_t)(255 - v), (uint8_t)(v / 2), 255 };
+			fillCheckerboard(dib.get(), color, color);
+			UniqueBitmap small(rescaleLinear(dib.get(), 5, 7, FILTER_CATMULLROM), &::FreeImage_Unload);
+			UniqueBitmap large(rescaleLinear(dib.get(), 37, 29, FILTER_LANCZOS3), &::FreeImage_Unload);
+			assert(small && large);
+			for (FIBITMAP *result : { small.get(), large.get() }) {
+				assert(FreeImage_GetBPP(result) == 24);
+				for (unsigned y = 0; y < FreeImage_GetHeight(result); y++) {
+					const uint8_t *bits = FreeImage_GetScanLine(result, y);
+					for (unsigned x = 0; x < FreeImage_GetWidth(result); x++, bits += 3) {
+						assert(bits[FI_RGBA_BLUE] == color.blue);
+						assert(bits[FI_RGBA_GREEN] == color.green);
+						assert(bits[FI_RGBA_RED] == color.red);
+					}
+				}
+			}
+		}
+	}
+
+	// a black and white checkerboard averages to 50% light, not to 50% of the sRGB value
+	{
+		UniqueBitmap dib(FreeImage_Allocate(64, 64, 24), &::FreeImage_Unload);
+		fillCheckerboard(dib.get(), { 0, 0, 0, 255 }, { 255, 255, 255, 255 });
+		UniqueBitmap linear(rescaleLinear(dib.get(), 32, 32, FILTER_BOX), &::FreeImage_Unload);
+		UniqueBitmap direct(FreeImage_Rescale(dib.get(), 32, 32, FILTER_BOX), &::FreeImage_Unload);
+		assert(linear && direct);
+		for (unsigned y = 0; y < 32; y++) {
+			const uint8_t *l = FreeImage_GetScanLine(linear.get(), y);
+			const uint8_t *d = FreeImage_GetScanLine(direct.get(), y);
+			for (unsigned x = 0; x < 32 * 3; x++) {
+				assert(std::abs(l[x] - 188) <= 1);
+				assert(std::abs(d[x] - 128) <= 1);
+			}
+		}
+	}
+
+	// transparent pixels do not bleed their color
+	{
+		UniqueBitmap dib(FreeImage_Allocate(40, 30, 32), &::FreeImage_Unload);
+		fillCheckerboard(dib.get(), { 255, 0, 0, 255 }, { 0, 255, 0, 0 });
+		UniqueBitmap result(rescaleLinear(dib.get(), 20, 15, FILTER_BOX), &::FreeImage_Unload);
+		assert(result && FreeImage_GetBPP(result.get()) == 32);
+		for (unsigned y = 0; y < 15; y++) {
+			const FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(result.get(), y);
+			for (unsigned x = 0; x < 20; x++) {
+				assert(bits[x].red == 255 && bits[x].green == 0 && bits[x].blue == 0);
+				assert(std::abs(bits[x].alpha - 128) <= 1);
+			}
+		}
+	}
+
+	// fully transparent areas keep their color
+	{
+		UniqueBitmap dib(FreeImage_Allocate(40, 30, 32), &::FreeImage_Unload);
+		fillCheckerboard(dib.get(), { 200, 100, 50, 0 }, { 200, 100, 50, 0 });
+		for (unsigned y = 0; y < 30; y++) {
+			FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 30; x < 40; x++) {
+				bits[x] = { 0, 0, 255, 255 };
+			}
+		}
+		UniqueBitmap result(rescaleLinear(dib.get(), 20, 15, FILTER_CATMULLROM), &::FreeImage_Unload);
+		assert(result);
+		for (unsigned y = 0; y < 15; y++) {
+			const FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(result.get(), y);
+			for (unsigned x = 0; x < 13; x++) {
+				assert(bits[x].red == 200 && bits[x].green == 100 && bits[x].blue == 50 && bits[x].alpha == 0);
+			}
+		}
+	}
+
+	// sub rectangle : same result as rescaling a copy of the rectangle
+	{
+		UniqueBitmap dib(FreeImage_Allocate(64, 48, 32), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 48; y++) {
+			FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < 64; x++) {
+				bits[x] = { (uint8_t)(x * 4), (uint8_t)(y * 5), (uint8_t)((x * y) & 0xFF), (uint8_t)((x + y) % 5 ? 255 : (x * 7) & 0xFF) };
+			}
+		}
+		UniqueBitmap result(FreeImage_RescaleRect(dib.get(), 10, 10, 8, 2, 40, 40, FILTER_CATMULLROM, FI_RESCALE_LINEAR_LIGHT), &::FreeImage_Unload);
+		assert(result && FreeImage_GetWidth(result.get()) == 10 && FreeImage_GetHeight(result.get()) == 10);
+		UniqueBitmap rect(FreeImage_Copy(dib.get(), 8, 2, 40, 40), &::FreeImage_Unload);
+		UniqueBitmap expected(rescaleLinear(rect.get(), 10, 10, FILTER_CATMULLROM), &::FreeImage_Unload);
+		assert(expected);
+		for (unsigned y = 0; y < 10; y++) {
+			assert(memcmp(FreeImage_GetScanLine(result.get(), y), FreeImage_GetScanLine(expected.get(), y), 10 * sizeof(FIRGBA8)) == 0);
+		}
+	}
+}
@@ -0,0 +1,182 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cstring>
+#include <memory>
+
+namespace {
+
+	/** Compare the pixel (ax, ay) of a to the pixel (bx, by) of b, in scanline coordinates */
+	bool samePixel(FIBITMAP *a, unsigned ax, unsigned ay, FIBITMAP *b, unsigned bx, unsigned by) {
+		const unsigned bpp = FreeImage_GetBPP(a);
+		const uint8_t *a_bits = FreeImage_GetScanLine(a, ay);
+		const uint8_t *b_bits = FreeImage_GetScanLine(b, by);
+		if (bpp < 8) {
+			const unsigned mask = (1U << bpp) - 1;
+			const unsigned a_value = (a_bits[ax * bpp / 8] >> (8 - bpp - (ax * bpp) % 8)) & mask;
+			const unsigned b_value = (b_bits[bx * bpp / 8] >> (8 - bpp - (bx * bpp) % 8)) & mask;
+			return a_value == b_value;
+		}
+		const unsigned bytespp = bpp / 8;
+		return memcmp(a_bits + ax * bytespp, b_bits + bx * bytespp, bytespp) == 0;
+	}
+
+	enum class Mapping { Transpose, Transverse, Rotate90, Rotate180, Rotate270 };
+
+	/** Check dst against the mapping of src, pixel by pixel */
+	bool checkMapping(FIBITMAP *src, FIBITMAP *dst, Mapping mapping) {
+		const unsigned width = FreeImage_GetWidth(src), height = FreeImage_GetHeight(src);
+		const bool swapped = (mapping != Mapping::Rotate180);
+		if (FreeImage_GetWidth(dst) != (swapped ? height : width) || FreeImage_GetHeight(dst) != (swapped ? width : height)) {
+			return false;
+		}
+		for (unsigned y = 0; y < FreeImage_GetHeight(dst); y++) {
+			for (unsigned x = 0; x < FreeImage_GetWidth(dst); x++) {
+				unsigned sx = 0, sy = 0;
+				switch (mapping) {
+					case Mapping::Transpose:	sx = width - 1 - y;		sy = height - 1 - x;	break;
+					case Mapping::Transverse:	sx = y;					sy = x;					break;
+					case Mapping::Rotate90:		sx = y;					sy = height - 1 - x;	break;
+					case Mapping::Rotate180:	sx = width - 1 - x;		sy = height - 1 - y;	break;
+					case Mapping::Rotate270:	sx = width - 1 - y;		sy = x;					break;
+				}
+				if (!samePixel(dst, x, y, src, sx, sy)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool rotateSupported(FREE_IMAGE_TYPE type, unsigned bpp) {
+		switch (type) {
+			case FIT_BITMAP:
+				return (bpp == 1) || (bpp == 8) || (bpp == 24) || (bpp == 32);
+			case FIT_UINT16:
+			case FIT_RGB16:
+			case FIT_RGBA16:
+			case FIT_FLOAT:
+			case FIT_RGBF:
+			case FIT_RGBAF:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+} // namespace
+
+void testRotate()
+{
+	printf("testRotate ...\n");
+
+	const struct { FREE_IMAGE_TYPE type; unsigned bpp; } formats[] = {
+		{ FIT_BITMAP, 1 }, { FIT_BITMAP, 4 }, { FIT_BITMAP, 8 }, { FIT_BITMAP, 16 }, { FIT_BITMAP, 24 }, { FIT_BITMAP, 32 },
+		{ FIT_UINT16, 16 }, { FIT_FLOAT, 32 }, { FIT_DOUBLE, 64 }, { FIT_COMPLEX, 128 },
+		{ FIT_RGB16, 48 }, { FIT_RGBA16, 64 }, { FIT_RGBF, 96 }, { FIT_RGBAF, 128 }
+	};
+
+	// right angle mappings of sizes with partial blocks and tiles
+	for (const auto& format : formats) {
+		for (const auto& size : { std::make_pair(1U, 1U), std::make_pair(13U, 5U), std::make_pair(70U, 45U), std::make_pair(131U, 200U) }) {
+			UniqueBitmap src = makePattern(format.type, size.first, size.second, format.bpp);
+			assert(src != nullptr);
+
+			UniqueBitmap transposed(FreeImage_Transpose(src.get()), &::FreeImage_Unload);
+			UniqueBitmap transversed(FreeImage_Transverse(src.get()), &::FreeImage_Unload);
+			assert(transposed != nullptr && transversed != nullptr);
+			assert(FreeImage_GetImageType(transposed.get()) == format.type && FreeImage_GetBPP(transposed.get()) == format.bpp);
+			assert(checkMapping(src.get(), transposed.get(), Mapping::Transpose));
+			assert(checkMapping(src.get(), transversed.get(), Mapping::Transverse));
+
+			if (rotateSupported(format.type, format.bpp)) {
+				UniqueBitmap rotated90(FreeImage_Rotate(src.get(), 90), &::FreeImage_Unload);
+				UniqueBitmap rotated180(FreeImage_Rotate(src.get(), 180), &::FreeImage_Unload);
+				UniqueBitmap rotated270(FreeImage_Rotate(src.get(), 270), &::FreeImage_Unload);
+				assert(rotated90 != nullptr && rotated180 != nullptr && rotated270 != nullptr);
+				assert(checkMapping(src.get(), rotated90.get(), Mapping::Rotate90));
+				assert(checkMapping(src.get(), rotated180.get(), Mapping::Rotate180));
+				assert(checkMapping(src.get(), rotated270.get(), Mapping::Rotate270));
+			}
+		}
+	}
+
+	// the transpose is a rotation by 90 degrees followed by a vertical flip (Exif orientation 5)
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 37, 29, 24);
+		UniqueBitmap transposed(FreeImage_Transpose(src.get()), &::FreeImage_Unload);
+		UniqueBitmap rotated(FreeImage_Rotate(src.get(), 90), &::FreeImage_Unload);
+		assert(FreeImage_FlipVertical(rotated.get()));
+		for (unsigned y = 0; y < 37; y++) {
+			assert(memcmp(FreeImage_GetScanLine(transposed.get(), y), FreeImage_GetScanLine(rotated.get(), y), 29 * 3) == 0);
+		}
+	}
+
+	// palette and resolution
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 20, 10, 8);
+		FIRGBA8 *palette = FreeImage_GetPalette(src.get());
+		for (unsigned i = 0; i < 256; i++) {
+			palette[i].red = (uint8_t)i;
+			palette[i].green = (uint8_t)(255 - i);
+			palette[i].blue = (uint8_t)(i / 2);
+		}
+		FreeImage_SetDotsPerMeterX(src.get(), 1000);
+		FreeImage_SetDotsPerMeterY(src.get(), 2000);
+		UniqueBitmap dst(FreeImage_Transpose(src.get()), &::FreeImage_Unload);
+		assert(memcmp(FreeImage_GetPalette(dst.get()), palette, 256 * sizeof(FIRGBA8)) == 0);
+		assert(FreeImage_GetDotsPerMeterX(dst.get()) == 2000 && FreeImage_GetDotsPerMeterY(dst.get()) == 1000);
+		assert(FreeImage_Transpose(nullptr) == nullptr);
+	}
+
+	// FreeImage_RotateEx : shifts and right angles are exact
+	{
+		for (const auto& format : formats) {
+			if (!rotateSupported(format.type, format.bpp)) {
+				continue;
+			}
+			UniqueBitmap src = makePattern(format.type, 33, 33, format.bpp);
+			UniqueBitmap rotated(FreeImage_RotateEx(src.get(), 90, 0, 0, 16, 16, TRUE), &::FreeImage_Unload);
+			UniqueBitmap expected(FreeImage_Rotate(src.get(), 90), &::FreeImage_Unload);
+			assert(rotated != nullptr && FreeImage_GetImageType(rotated.get()) == format.type);
+			for (unsigned y = 0; y < 33; y++) {
+				assert(memcmp(FreeImage_GetScanLine(rotated.get(), y), FreeImage_GetScanLine(expected.get(), y), FreeImage_GetLine(src.get())) == 0);
+			}
+		}
+
+		// dst(x, y) = src(x - 3, y + 2), y downwards : black or mirrored outside of the source
+		UniqueBitmap src = makePattern(FIT_BITMAP, 40, 30, 24);
+		UniqueBitmap masked(FreeImage_RotateEx(src.get(), 0, 3, -2, 0, 0, TRUE), &::FreeImage_Unload);
+		UniqueBitmap mirrored(FreeImage_RotateEx(src.get(), 0, 3, -2, 0, 0, FALSE), &::FreeImage_Unload);
+		assert(masked != nullptr && mirrored != nullptr);
+		auto pixel = [](FIBITMAP *dib, unsigned x, unsigned y) {
+			return FreeImage_GetScanLine(dib, FreeImage_GetHeight(dib) - 1 - y) + 3 * x;
+		};
+		const uint8_t black[3] = {};
+		for (unsigned y = 0; y < 30; y++) {
+			for (unsigned x = 0; x < 40; x++) {
+				const int sx = (int)x - 3, sy = (int)y + 2;
+				const int mx = std::abs(sx), my = (sy >= 30) ? 2 * 29 - sy : sy;
+				assert(memcmp(pixel(masked.get(), x, y), (sx < 0 || sy >= 30) ? black : pixel(src.get(), sx, sy), 3) == 0);
+				assert(memcmp(pixel(mirrored.get(), x, y), pixel(src.get(), mx, my), 3) == 0);
+			}
+		}
+	}
+}
@@ -21,8 +21,10 @@
 
 
 #include "TestSuite.h"
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <vector>
 
 
 void testTmoClamp()
@@ -298,5 +300,250 @@ void testTmoLinear()
 	}
 }
 
+// ----------------------------------------------------------
+//  Drago03 and Reinhard05 operators against a double precision scalar implementation
+// ----------------------------------------------------------
+
+namespace {
+
+	const double RGB2XYZ[3][3] = {
+		{ 0.41239083, 0.35758433, 0.18048081 },
+		{ 0.21263903, 0.71516865, 0.072192319 },
+		{ 0.019330820, 0.11919473, 0.95053220 }
+	};
+	const double XYZ2RGB[3][3] = {
+		{ 3.2409699, -1.5373832, -0.49861079 },
+		{ -0.96924376, 1.8759676, 0.041555084 },
+		{ 0.055630036, -0.20397687, 1.0569715 }
+	};
+
+	/** High dynamic range test image, about 12 stops */
+	UniqueBitmap makeHDR(unsigned width, unsigned height) {
+		UniqueBitmap dib(FreeImage_AllocateT(FIT_RGBF, width, height), &::FreeImage_Unload);
+		unsigned seed = 7;
+		auto random = [&seed]() {
+			return nextRandom(seed) / 32767.0;
+		};
+		for (unsigned y = 0; y < height; y++) {
+			FIRGBF *pixel = (FIRGBF*)FreeImage_GetScanLine(dib.get(), y);
+			for (unsigned x = 0; x < width; x++) {
+				const double level = std::exp(-4 + 8.0 * x / width + random());
+				pixel[x].red = (float)(level * (0.2 + random()));
+				pixel[x].green = (float)(level * (0.2 + random()));
+				pixel[x].blue = (float)(level * (0.2 + random()));
+			}
+		}
+		return dib;
+	}
+
+	uint8_t toByte(double v) {
+		return (uint8_t)(255 * std::min(std::max(v, 0.0), 1.0) + 0.5);
+	}
+
+	/** Largest difference between the channels of a 24-bit image and reference pixels */
+	int maxDifference(FIBITMAP *dib, const std::vector<uint8_t>& reference) {
+		int difference = 0;
+		const unsigned width = FreeImage_GetWidth(dib);
+		for (unsigned y = 0; y < FreeImage_GetHeight(dib); y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(dib, y);
+			for (unsigned x = 0; x < width; x++) {
+				const uint8_t *ref = &reference[3 * (y * width + x)];
+				difference = std::max(difference, std::abs(bits[3 * x + FI_RGBA_RED] - ref[0]));
+				difference = std::max(difference, std::abs(bits[3 * x + FI_RGBA_GREEN] - ref[1]));
+				difference = std::max(difference, std::abs(bits[3 * x + FI_RGBA_BLUE] - ref[2]));
+			}
+		}
+		return difference;
+	}
+
+	double padeLog(double x) {
+		if (x < 1) {
+			return (x * (6 + x) / (6 + 4 * x));
+		} else if (x < 2) {
+			return (x * (6 + 0.7662 * x) / (5.9897 + 3.7658 * x));
+		}
+		return std::log(x + 1);
+	}
+
+	std::vector<uint8_t> referenceDrago03(FIBITMAP *dib, double gamma, double exposure) {
+		const unsigned width = FreeImage_GetWidth(dib), height = FreeImage_GetHeight(dib);
+		std::vector<double> Yxy;
+		double maxLum = 0, sumLog = 0;
+		for (unsigned y = 0; y < height; y++) {
+			const FIRGBF *pixel = (const FIRGBF*)FreeImage_GetScanLine(dib, y);
+			for (unsigned x = 0; x < width; x++) {
+				double XYZ[3];
+				for (int i = 0; i < 3; i++) {
+					XYZ[i] = RGB2XYZ[i][0] * pixel[x].red + RGB2XYZ[i][1] * pixel[x].green + RGB2XYZ[i][2] * pixel[x].blue;
+				}
+				const double W = XYZ[0] + XYZ[1] + XYZ[2];
+				Yxy.push_back(XYZ[1]);
+				Yxy.push_back(XYZ[0] / W);
+				Yxy.push_back(XYZ[1] / W);
+				// negative luminance counts as 0 in the statistics
+				maxLum = std::max(maxLum, std::max(0.0, XYZ[1]));
+				sumLog += std::log(2.3e-5 + std::max(0.0, XYZ[1]));
+			}
+		}
+		const double avgLum = std::exp(sumLog / (width * height));
+		const double Lmax = maxLum / avgLum;
+		const double divider = std::log10(Lmax + 1);
+		const double biasP = std::log(0.85) / std::log(0.5);
+		const double expo = std::pow(2.0, exposure);
+		const double fgamma = (0.45 / gamma) * 2;
+		const double start = 0.018 / ((gamma - 2) * 7.5);
+		const double slope = 4.5 * ((gamma - 2) * 7.5);
+
+		std::vector<uint8_t> result;
+		for (size_t i = 0; i < Yxy.size(); i += 3) {
+			const double Yw = Yxy[i] / avgLum * expo;
+			const double interpol = std::log(2 + std::pow(Yw / Lmax, biasP) * 8);
+			const double Y = (padeLog(Yw) / interpol) / divider;
+			const double X = Yxy[i + 1] * Y / Yxy[i + 2];
+			const double Z = X / Yxy[i + 1] - X - Y;
+			for (int c = 0; c < 3; c++) {
+				double v = XYZ2RGB[c][0] * X + XYZ2RGB[c][1] * Y + XYZ2RGB[c][2] * Z;
+				v = (v <= start) ? v * slope : (1.099 * std::pow(v, fgamma) - 0.099);
+				result.push_back(toByte(v));
+			}
+		}
+		return result;
+	}
+
+	std::vector<uint8_t> referenceReinhard05(FIBITMAP *dib, double f, double m, double a, double c) {
+		const unsigned width = FreeImage_GetWidth(dib), height = FreeImage_GetHeight(dib);
+		const double size = (double)width * height;
+		std::vector<double> color, L;
+		double maxLum = -1e20, minLum = 1e20, sumLum = 0, sumLog = 0, Cav[3] = { 0, 0, 0 };
+		for (unsigned y = 0; y < height; y++) {
+			const FIRGBF *pixel = (const FIRGBF*)FreeImage_GetScanLine(dib, y);
+			for (unsigned x = 0; x < width; x++) {
+				const double rgb[3] = { pixel[x].red, pixel[x].green, pixel[x].blue };
+				const double Y = std::max(0.0, 0.2126 * rgb[0] + 0.7152 * rgb[1] + 0.0722 * rgb[2]);
+				L.push_back(Y);
+				maxLum = std::max(maxLum, Y);
+				minLum = std::min(minLum, Y);
+				sumLum += Y;
+				sumLog += std::log(2.3e-5 + Y);
+				for (int i = 0; i < 3; i++) {
+					color.push_back(rgb[i]);
+					Cav[i] += rgb[i] / size;
+				}
+			}
+		}
+		const double Lav = sumLum / size;
+		const double Llav = std::exp(sumLog / size);
+		f = std::exp(-f);
+		if (m == 0) {
+			const double k = (std::log(maxLum) - Llav) / (std::log(maxLum) - std::log(minLum));
+			m = (k < 0) ? 0.3 : 0.3 + 0.7 * std::pow(k, 1.4);
+		}
+		double max_color = -1e6, min_color = 1e6;
+		for (size_t i = 0; i < color.size(); i++) {
+			const double I_l = c * color[i] + (1 - c) * L[i / 3];
+			const double I_g = c * Cav[i % 3] + (1 - c) * Lav;
+			const double I_a = a * I_l + (1 - a) * I_g;
+			color[i] /= color[i] + std::pow(f * I_a, m);
+			max_color = std::max(max_color, color[i]);
+			min_color = std::min(min_color, color[i]);
+		}
+		std::vector<uint8_t> result;
+		for (double v : color) {
+			result.push_back(toByte((v - min_color) / (max_color - min_color)));
+		}
+		return result;
+	}
+
+} // namespace
+
+void testTmoDrago03()
+{
+	printf("testTmoDrago03 ...\n");
+
+	UniqueBitmap hdr = makeHDR(67, 31);
+	for (double gamma : { 2.2, 1.0 }) {
+		for (double exposure : { 0.0, 1.5 }) {
+			UniqueBitmap res(FreeImage_TmoDrago03(hdr.get(), gamma, exposure), &::FreeImage_Unload);
+			assert(res != nullptr && FreeImage_GetBPP(res.get()) == 24);
+			if (gamma != 1.0) {
+				assert(maxDifference(res.get(), referenceDrago03(hdr.get(), gamma, exposure)) <= 1);
+			}
+		}
+	}
+
+	// negative components (out of gamut colors), some of them with a negative luminance
+	{
+		UniqueBitmap hdr = makeHDR(67, 31);
+		std::vector<bool> negative;
+		for (unsigned y = 0; y < 31; y++) {
+			FIRGBF *pixel = (FIRGBF*)FreeImage_GetScanLine(hdr.get(), y);
+			for (unsigned x = 0; x < 67; x++) {
+				if ((x + y) % 7 == 0) {
+					pixel[x].red = 0;
+					pixel[x].green = -pixel[x].green;
+					pixel[x].blue = 3 * pixel[x].blue;
+				} else if ((x + y) % 5 == 0) {
+					pixel[x].red = -0.05F * pixel[x].red;
+				}
+				negative.push_back(RGB2XYZ[1][0] * pixel[x].red + RGB2XYZ[1][1] * pixel[x].green + RGB2XYZ[1][2] * pixel[x].blue < 0);
+			}
+		}
+		UniqueBitmap res(FreeImage_TmoDrago03(hdr.get(), 2.2, 0), &::FreeImage_Unload);
+		assert(res != nullptr);
+		// the pixels with a negative luminance have no reference value, the others depend on the image statistics
+		std::vector<uint8_t> reference = referenceDrago03(hdr.get(), 2.2, 0);
+		for (unsigned y = 0; y < 31; y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(res.get(), y);
+			for (unsigned x = 0; x < 67; x++) {
+				const size_t i = y * 67 + x;
+				if (negative[i]) {
+					reference[3 * i + 0] = bits[3 * x + FI_RGBA_RED];
+					reference[3 * i + 1] = bits[3 * x + FI_RGBA_GREEN];
+					reference[3 * i + 2] = bits[3 * x + FI_RGBA_BLUE];
+				}
+			}
+		}
+		assert(std::count(negative.begin(), negative.end(), true) > 0);
+		assert(maxDifference(res.get(), reference) <= 1);
+	}
+
+	// black and flat images
+	{
+		UniqueBitmap black(FreeImage_AllocateT(FIT_RGBF, 5, 3), &::FreeImage_Unload);
+		UniqueBitmap res(FreeImage_ToneMapping(black.get(), FITMO_DRAGO03), &::FreeImage_Unload);
+		assert(res != nullptr && FreeImage_GetScanLine(res.get(), 1)[4] == 0);
+	}
+}
 
+void testTmoReinhard05()
+{
+	printf("testTmoReinhard05 ...\n");
+
+	UniqueBitmap hdr = makeHDR(67, 31);
+	for (double intensity : { 0.0, -1.0 }) {
+		UniqueBitmap res(FreeImage_TmoReinhard05(hdr.get(), intensity, 0), &::FreeImage_Unload);
+		assert(res != nullptr && FreeImage_GetBPP(res.get()) == 24);
+		assert(maxDifference(res.get(), referenceReinhard05(hdr.get(), intensity, 0, 1, 0)) <= 1);
+	}
+	{
+		UniqueBitmap res(FreeImage_TmoReinhard05Ex(hdr.get(), 0.5, 0, 0.6, 0.4), &::FreeImage_Unload);
+		assert(res != nullptr);
+		assert(maxDifference(res.get(), referenceReinhard05(hdr.get(), 0.5, 0, 0.6, 0.4)) <= 1);
+	}
+	{
+		UniqueBitmap res(FreeImage_TmoReinhard05Ex(hdr.get(), 0, 0.7, 0.3, 1), &::FreeImage_Unload);
+		assert(res != nullptr);
+		assert(maxDifference(res.get(), referenceReinhard05(hdr.get(), 0, 0.7, 0.3, 1)) <= 1);
+	}
 
+	// black pixels stay black
+	{
+		UniqueBitmap dib = makeHDR(9, 4);
+		FIRGBF *pixel = (FIRGBF*)FreeImage_GetScanLine(dib.get(), 2);
+		pixel[3].red = pixel[3].green = pixel[3].blue = 0;
+		UniqueBitmap res(FreeImage_ToneMapping(dib.get(), FITMO_REINHARD05), &::FreeImage_Unload);
+		assert(res != nullptr);
+		const uint8_t *bits = FreeImage_GetScanLine(res.get(), 2);
+		assert(bits[9] == 0 && bits[10] == 0 && bits[11] == 0);
+	}
+}
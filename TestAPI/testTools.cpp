@@ -308,3 +308,98 @@ void testFindMinMax()
 	}
 }
 
+// ----------------------------------------------------------
+
+/**
+Reproducible pseudo random generator (ANSI C linear congruential generator), returns 15 bits
+*/
+unsigned nextRandom(unsigned& seed) {
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+/**
+Fill an image with pseudo random bytes, padding excluded
+*/
+void fillRandom(FIBITMAP *dib, unsigned seed) {
+	const unsigned line = FreeImage_GetLine(dib);
+	for (unsigned y = 0; y < FreeImage_GetHeight(dib); y++) {
+		uint8_t *bits = FreeImage_GetScanLine(dib, y);
+		for (unsigned x = 0; x < line; x++) {
+			bits[x] = (uint8_t)nextRandom(seed);
+		}
+	}
+}
+
+/**
+Synthetic animation frame : a zone plate with flat color blocks on top,
+so that both short and long LZW strings show up in the stream.
+*/
+FIBITMAP* createAnimationFrame(unsigned width, unsigned height, int frame) {
+	FIBITMAP *dib = createZonePlateImage(width, height, 16 + frame);
+	if (dib) {
+		for (unsigned y = 0; y < height; y++) {
+			uint8_t *bits = FreeImage_GetScanLine(dib, y);
+			for (unsigned x = 0; x < width; x++) {
+				if ((((x + frame * 8) / 64) + (y / 64)) % 3 == 0) {
+					bits[x] = (uint8_t)(((x + frame * 8) / 64) * 16 + (y / 64));
+				}
+			}
+		}
+	}
+	return dib;
+}
+
+/**
+Synthetic screenshot : a zone plate with flat color blocks and a varying alpha channel
+*/
+FIBITMAP* createScreenshot(unsigned width, unsigned height) {
+	FIBITMAP *plate = createZonePlateImage(width, height, 64);
+	assert(plate != nullptr);
+	FIBITMAP *dib = FreeImage_ConvertTo32Bits(plate);
+	FreeImage_Unload(plate);
+	assert(dib != nullptr);
+	for (unsigned y = 0; y < height; y++) {
+		FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib, y);
+		for (unsigned x = 0; x < width; x++) {
+			if (((x / 96) + (y / 64)) % 2 == 0) {
+				bits[x].red = (uint8_t)(x / 96 * 24);
+				bits[x].green = (uint8_t)(y / 64 * 16);
+				bits[x].blue = 0xC0;
+			}
+			bits[x].alpha = (uint8_t)((x < width / 2) ? 0xFF : y);
+		}
+	}
+	return dib;
+}
+
+/**
+Image filled with a pattern of bytes, the value of a pixel depends on its position.
+Floating point images hold finite values.
+*/
+UniqueBitmap makePattern(FREE_IMAGE_TYPE type, unsigned width, unsigned height, unsigned bpp) {
+	UniqueBitmap dib(FreeImage_AllocateT(type, width, height, bpp), &::FreeImage_Unload);
+	assert(dib != nullptr);
+	const unsigned line = FreeImage_GetLine(dib.get());
+	for (unsigned y = 0; y < height; y++) {
+		uint8_t *bits = FreeImage_GetScanLine(dib.get(), y);
+		for (unsigned i = 0; i < line; i++) {
+			bits[i] = (uint8_t)(i * 31 + y * 17 + (i * y) / 7);
+		}
+	}
+	if (type == FIT_FLOAT || type == FIT_RGBF || type == FIT_RGBAF || type == FIT_DOUBLE) {
+		const unsigned count = line / ((type == FIT_DOUBLE) ? 8 : 4);
+		for (unsigned y = 0; y < height; y++) {
+			for (unsigned i = 0; i < count; i++) {
+				const double v = (double)((i * 7 + y * 3) % 50) / 7;
+				if (type == FIT_DOUBLE) {
+					reinterpret_cast<double*>(FreeImage_GetScanLine(dib.get(), y))[i] = v;
+				}
+				else {
+					reinterpret_cast<float*>(FreeImage_GetScanLine(dib.get(), y))[i] = (float)v;
+				}
+			}
+		}
+	}
+	return dib;
+}
@@ -0,0 +1,391 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+	bool sameBits(FIBITMAP *a, FIBITMAP *b) {
+		if (FreeImage_GetWidth(a) != FreeImage_GetWidth(b) || FreeImage_GetHeight(a) != FreeImage_GetHeight(b) || FreeImage_GetLine(a) != FreeImage_GetLine(b)) {
+			return false;
+		}
+		for (unsigned y = 0; y < FreeImage_GetHeight(a); y++) {
+			if (memcmp(FreeImage_GetScanLine(a, y), FreeImage_GetScanLine(b, y), FreeImage_GetLine(a)) != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Pixel (x, y) of a 24-bit image, y downwards */
+	const uint8_t* pixel24(FIBITMAP *dib, unsigned x, unsigned y) {
+		return FreeImage_GetScanLine(dib, FreeImage_GetHeight(dib) - 1 - y) + 3 * x;
+	}
+
+} // namespace
+
+void testWarpAffine()
+{
+	printf("testWarpAffine ...\n");
+
+	const double identity[6] = { 1, 0, 0, 0, 1, 0 };
+
+	// the identity is exact for the interpolating kernels, for every image type
+	{
+		const struct { FREE_IMAGE_TYPE type; unsigned bpp; } formats[] = {
+			{ FIT_BITMAP, 8 }, { FIT_BITMAP, 24 }, { FIT_BITMAP, 32 }, { FIT_UINT16, 16 }, { FIT_INT32, 32 }, { FIT_FLOAT, 32 },
+			{ FIT_DOUBLE, 64 }, { FIT_RGB16, 48 }, { FIT_RGBA16, 64 }, { FIT_RGBF, 96 }, { FIT_RGBAF, 128 }
+		};
+		for (const auto& format : formats) {
+			UniqueBitmap src = makePattern(format.type, 45, 31, format.bpp);
+			for (FREE_IMAGE_FILTER filter : { FILTER_BOX, FILTER_BILINEAR, FILTER_CATMULLROM, FILTER_LANCZOS3 }) {
+				UniqueBitmap dst(FreeImage_WarpAffine(src.get(), identity, 45, 31, filter), &::FreeImage_Unload);
+				assert(dst != nullptr && FreeImage_GetImageType(dst.get()) == format.type);
+				assert(sameBits(src.get(), dst.get()));
+			}
+		}
+	}
+
+	// translation : uncovered pixels get the background color, or the edge pixels with FIBM_CLAMP
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 40, 30, 24);
+		const double matrix[6] = { 1, 0, 3, 0, 1, -2 };
+		const uint8_t bkcolor[3] = { 10, 20, 30 };
+		UniqueBitmap dst(FreeImage_WarpAffine(src.get(), matrix, 40, 30, FILTER_BILINEAR, FIBM_ZERO, bkcolor), &::FreeImage_Unload);
+		UniqueBitmap clamped(FreeImage_WarpAffine(src.get(), matrix, 40, 30, FILTER_BILINEAR, FIBM_CLAMP), &::FreeImage_Unload);
+		assert(dst != nullptr && clamped != nullptr);
+		for (unsigned y = 0; y < 30; y++) {
+			for (unsigned x = 0; x < 40; x++) {
+				const uint8_t *pixel = pixel24(dst.get(), x, y);
+				const int sx = (int)x - 3, sy = (int)y + 2;
+				if (sx < 0 || sy >= 30) {
+					assert(memcmp(pixel, bkcolor, 3) == 0);
+					assert(memcmp(pixel24(clamped.get(), x, y), pixel24(src.get(), std::max(sx, 0), std::min(sy, 29)), 3) == 0);
+				}
+				else {
+					assert(memcmp(pixel, pixel24(src.get(), sx, sy), 3) == 0);
+				}
+			}
+		}
+	}
+
+	// a rotation by 90 degrees matches the exact rotation
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 37, 22, 32);
+		const double matrix[6] = { 0, 1, (22 - 1.0) / 2 - (22 - 1.0) / 2, -1, 0, (37 - 1.0) / 2 + (37 - 1.0) / 2 };
+		UniqueBitmap rotated(FreeImage_Rotate(src.get(), 90), &::FreeImage_Unload);
+		for (FREE_IMAGE_FILTER filter : { FILTER_BOX, FILTER_BILINEAR, FILTER_LANCZOS3 }) {
+			UniqueBitmap dst(FreeImage_WarpAffine(src.get(), matrix, 22, 37, filter), &::FreeImage_Unload);
+			assert(dst != nullptr && sameBits(dst.get(), rotated.get()));
+		}
+	}
+
+	// linear values are reproduced by the bilinear kernel, up to the sub-pixel rounding
+	{
+		UniqueBitmap src(FreeImage_AllocateT(FIT_FLOAT, 120, 100), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 100; y++) {
+			float *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(src.get(), 99 - y));
+			for (unsigned x = 0; x < 120; x++) {
+				bits[x] = 0.5F * x + 0.25F * y;
+			}
+		}
+		const double angle = 15 * 3.14159265358979 / 180, scale = 0.7;
+		const double matrix[6] = { scale * cos(angle), -scale * sin(angle), 30, scale * sin(angle), scale * cos(angle), 10 };
+		UniqueBitmap dst(FreeImage_WarpAffine(src.get(), matrix, 100, 100, FILTER_BILINEAR), &::FreeImage_Unload);
+		assert(dst != nullptr);
+		const double det = matrix[0] * matrix[4] - matrix[1] * matrix[3];
+		unsigned checked = 0;
+		for (unsigned y = 0; y < 100; y++) {
+			const float *bits = reinterpret_cast<const float*>(FreeImage_GetScanLine(dst.get(), 99 - y));
+			for (unsigned x = 0; x < 100; x++) {
+				const double dx = x - matrix[2], dy = y - matrix[5];
+				const double sx = (matrix[4] * dx - matrix[1] * dy) / det;
+				const double sy = (-matrix[3] * dx + matrix[0] * dy) / det;
+				if ((sx >= 1) && (sx <= 118) && (sy >= 1) && (sy <= 98)) {
+					assert(std::abs(bits[x] - (0.5 * sx + 0.25 * sy)) < 0.01);
+					checked++;
+				}
+			}
+		}
+		assert(checked > 2000);
+	}
+
+	// palettized images keep their palette and indices
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 50, 40, 8);
+		FIRGBA8 *palette = FreeImage_GetPalette(src.get());
+		for (unsigned i = 0; i < 256; i++) {
+			palette[i].red = (uint8_t)(i * 7);
+			palette[i].green = (uint8_t)(i * 13);
+			palette[i].blue = (uint8_t)i;
+		}
+		assert(FreeImage_GetColorType(src.get()) == FIC_PALETTE);
+		const double matrix[6] = { 0.9, 0.3, 0, -0.3, 0.9, 15 };
+		UniqueBitmap dst(FreeImage_WarpAffine(src.get(), matrix, 50, 40, FILTER_CATMULLROM, FIBM_MIRROR), &::FreeImage_Unload);
+		assert(dst != nullptr && memcmp(FreeImage_GetPalette(dst.get()), palette, 256 * sizeof(FIRGBA8)) == 0);
+		bool used[256] = {};
+		for (unsigned y = 0; y < 40; y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(src.get(), y);
+			for (unsigned x = 0; x < 50; x++) {
+				used[bits[x]] = true;
+			}
+		}
+		for (unsigned y = 0; y < 40; y++) {
+			const uint8_t *bits = FreeImage_GetScanLine(dst.get(), y);
+			for (unsigned x = 0; x < 50; x++) {
+				assert(used[bits[x]]);
+			}
+		}
+	}
+
+	// 1-bit and 4-bit images keep their palette and indices, uncovered pixels get the background index
+	{
+		const double matrix[6] = { 1, 0, 3, 0, 1, -2 };
+		for (unsigned bpp : { 1U, 4U }) {
+			UniqueBitmap src = makePattern(FIT_BITMAP, 45, 31, bpp);
+			FIRGBA8 *palette = FreeImage_GetPalette(src.get());
+			for (unsigned i = 0; i < (1U << bpp); i++) {
+				palette[i].red = (uint8_t)(i * 70);
+				palette[i].green = (uint8_t)(255 - i * 9);
+				palette[i].blue = (uint8_t)(i * 16);
+			}
+			auto index = [bpp](FIBITMAP *dib, unsigned x, unsigned y) {
+				const uint8_t *bits = FreeImage_GetScanLine(dib, FreeImage_GetHeight(dib) - 1 - y);
+				return (bpp == 1) ? ((bits[x / 8] >> (7 - x % 8)) & 1) : ((bits[x / 2] >> ((x % 2) ? 0 : 4)) & 15);
+			};
+			const uint8_t bkcolor = 1;
+			UniqueBitmap dst(FreeImage_WarpAffine(src.get(), matrix, 45, 31, FILTER_CATMULLROM, FIBM_ZERO, &bkcolor), &::FreeImage_Unload);
+			assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == bpp);
+			assert(memcmp(FreeImage_GetPalette(dst.get()), palette, (1U << bpp) * sizeof(FIRGBA8)) == 0);
+			for (unsigned y = 0; y < 31; y++) {
+				for (unsigned x = 0; x < 45; x++) {
+					const int sx = (int)x - 3, sy = (int)y + 2;
+					assert(index(dst.get(), x, y) == ((sx < 0 || sy >= 31) ? bkcolor : index(src.get(), sx, sy)));
+				}
+			}
+			// the background index must be one of the image
+			const uint8_t too_large = (uint8_t)(1U << bpp);
+			assert(FreeImage_WarpAffine(src.get(), matrix, 45, 31, FILTER_BOX, FIBM_ZERO, &too_large) == nullptr);
+		}
+	}
+
+	// 16-bit RGB555 and RGB565 images keep their format
+	{
+		const double matrix[6] = { 1, 0, 3, 0, 1, -2 };
+		for (bool rgb565 : { false, true }) {
+			UniqueBitmap src(rgb565
+				? FreeImage_Allocate(45, 31, 16, FI16_565_RED_MASK, FI16_565_GREEN_MASK, FI16_565_BLUE_MASK)
+				: FreeImage_Allocate(45, 31, 16, FI16_555_RED_MASK, FI16_555_GREEN_MASK, FI16_555_BLUE_MASK), &::FreeImage_Unload);
+			for (unsigned y = 0; y < 31; y++) {
+				uint16_t *bits = reinterpret_cast<uint16_t*>(FreeImage_GetScanLine(src.get(), y));
+				for (unsigned x = 0; x < 45; x++) {
+					bits[x] = (uint16_t)((x * 1031 + y * 719 + x * y * 37) & (rgb565 ? 0xFFFF : 0x7FFF));
+				}
+			}
+			auto pixel = [](FIBITMAP *dib, unsigned x, unsigned y) {
+				return reinterpret_cast<const uint16_t*>(FreeImage_GetScanLine(dib, FreeImage_GetHeight(dib) - 1 - y))[x];
+			};
+			const uint16_t bkcolor = rgb565 ? 0xF81F : 0x7C1F;
+			UniqueBitmap dst(FreeImage_WarpAffine(src.get(), matrix, 45, 31, FILTER_BILINEAR, FIBM_ZERO, &bkcolor), &::FreeImage_Unload);
+			assert(dst != nullptr && FreeImage_GetBPP(dst.get()) == 16);
+			assert(FreeImage_GetGreenMask(dst.get()) == FreeImage_GetGreenMask(src.get()));
+			for (unsigned y = 0; y < 31; y++) {
+				for (unsigned x = 0; x < 45; x++) {
+					const int sx = (int)x - 3, sy = (int)y + 2;
+					assert(pixel(dst.get(), x, y) == ((sx < 0 || sy >= 31) ? bkcolor : pixel(src.get(), sx, sy)));
+				}
+			}
+		}
+	}
+
+	// invalid parameters
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 8, 8, 24);
+		const double singular[6] = { 1, 2, 0, 2, 4, 0 };
+		assert(FreeImage_WarpAffine(src.get(), singular, 8, 8) == nullptr);
+		assert(FreeImage_WarpAffine(src.get(), identity, 0, 8) == nullptr);
+		assert(FreeImage_WarpAffine(src.get(), nullptr, 8, 8) == nullptr);
+	}
+}
+
+void testWarpPerspective()
+{
+	printf("testWarpPerspective ...\n");
+
+	// scale and translation, exact in floating point : every warp gives the affine result
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 60, 40, 24);
+		const double affine[6] = { 2, 0, 3, 0, 0.5, -2 };
+		const double homography[9] = { 2, 0, 3, 0, 0.5, -2, 0, 0, 1 };
+		UniqueBitmap map_x(FreeImage_AllocateT(FIT_FLOAT, 90, 30), &::FreeImage_Unload);
+		UniqueBitmap map_y(FreeImage_AllocateT(FIT_FLOAT, 90, 30), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 30; y++) {
+			float *mx = reinterpret_cast<float*>(FreeImage_GetScanLine(map_x.get(), 29 - y));
+			float *my = reinterpret_cast<float*>(FreeImage_GetScanLine(map_y.get(), 29 - y));
+			for (unsigned x = 0; x < 90; x++) {
+				mx[x] = (x - 3.F) / 2;
+				my[x] = (y + 2.F) * 2;
+			}
+		}
+		UniqueBitmap fixed_x(FreeImage_ConvertRemapMap(map_x.get()), &::FreeImage_Unload);
+		UniqueBitmap fixed_y(FreeImage_ConvertRemapMap(map_y.get()), &::FreeImage_Unload);
+		assert(fixed_x != nullptr && FreeImage_GetImageType(fixed_x.get()) == FIT_INT32);
+
+		const uint8_t bkcolor[3] = { 1, 2, 3 };
+		for (FREE_IMAGE_FILTER filter : { FILTER_BOX, FILTER_BILINEAR, FILTER_CATMULLROM }) {
+			for (FREE_IMAGE_BORDER_MODE border : { FIBM_ZERO, FIBM_MIRROR }) {
+				UniqueBitmap expected(FreeImage_WarpAffine(src.get(), affine, 90, 30, filter, border, bkcolor), &::FreeImage_Unload);
+				UniqueBitmap projected(FreeImage_WarpPerspective(src.get(), homography, 90, 30, filter, border, bkcolor), &::FreeImage_Unload);
+				UniqueBitmap remapped(FreeImage_Remap(src.get(), map_x.get(), map_y.get(), filter, border, bkcolor), &::FreeImage_Unload);
+				UniqueBitmap fixed(FreeImage_Remap(src.get(), fixed_x.get(), fixed_y.get(), filter, border, bkcolor), &::FreeImage_Unload);
+				assert(expected != nullptr && projected != nullptr && remapped != nullptr && fixed != nullptr);
+				assert(sameBits(expected.get(), projected.get()));
+				assert(sameBits(expected.get(), remapped.get()));
+				assert(sameBits(expected.get(), fixed.get()));
+			}
+		}
+	}
+
+	// linear values through a true homography, up to the sub-pixel rounding
+	{
+		UniqueBitmap src(FreeImage_AllocateT(FIT_FLOAT, 120, 100), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 100; y++) {
+			float *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(src.get(), 99 - y));
+			for (unsigned x = 0; x < 120; x++) {
+				bits[x] = 0.5F * x + 0.25F * y;
+			}
+		}
+		const double h[9] = { 0.9, 0.1, 5, -0.05, 1.1, 3, 0.002, 0.001, 1 };
+		UniqueBitmap dst(FreeImage_WarpPerspective(src.get(), h, 110, 110, FILTER_BILINEAR), &::FreeImage_Unload);
+		assert(dst != nullptr);
+		unsigned checked = 0;
+		for (unsigned y = 0; y < 110; y++) {
+			const float *bits = reinterpret_cast<const float*>(FreeImage_GetScanLine(dst.get(), 109 - y));
+			for (unsigned x = 0; x < 110; x++) {
+				// solve the source point of (x, y) by Newton iterations on the forward mapping
+				double sx = x, sy = y;
+				for (int i = 0; i < 20; i++) {
+					const double w = h[6] * sx + h[7] * sy + h[8];
+					const double u = (h[0] * sx + h[1] * sy + h[2]) / w, v = (h[3] * sx + h[4] * sy + h[5]) / w;
+					const double j00 = (h[0] - u * h[6]) / w, j01 = (h[1] - u * h[7]) / w;
+					const double j10 = (h[3] - v * h[6]) / w, j11 = (h[4] - v * h[7]) / w;
+					const double det = j00 * j11 - j01 * j10;
+					sx -= (j11 * (u - x) - j01 * (v - y)) / det;
+					sy -= (-j10 * (u - x) + j00 * (v - y)) / det;
+				}
+				if ((sx >= 1) && (sx <= 118) && (sy >= 1) && (sy <= 98)) {
+					assert(std::abs(bits[x] - (0.5 * sx + 0.25 * sy)) < 0.01);
+					checked++;
+				}
+			}
+		}
+		assert(checked > 5000);
+	}
+
+	// NaN positions are outside of the image
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 10, 10, 8);
+		UniqueBitmap map(FreeImage_AllocateT(FIT_FLOAT, 4, 4), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 4; y++) {
+			float *bits = reinterpret_cast<float*>(FreeImage_GetScanLine(map.get(), y));
+			for (unsigned x = 0; x < 4; x++) {
+				bits[x] = std::nanf("");
+			}
+		}
+		const uint8_t bkcolor = 77;
+		UniqueBitmap dst(FreeImage_Remap(src.get(), map.get(), map.get(), FILTER_BILINEAR, FIBM_ZERO, &bkcolor), &::FreeImage_Unload);
+		assert(dst != nullptr);
+		for (unsigned y = 0; y < 4; y++) {
+			for (unsigned x = 0; x < 4; x++) {
+				assert(FreeImage_GetScanLine(dst.get(), y)[x] == bkcolor);
+			}
+		}
+	}
+
+	// source points behind the projection plane (w < 0) are outside of the image, not mirrored into it
+	{
+		UniqueBitmap src(FreeImage_Allocate(64, 64, 24), &::FreeImage_Unload);
+		for (unsigned y = 0; y < 64; y++) {
+			memset(FreeImage_GetScanLine(src.get(), y), 0xFF, FreeImage_GetLine(src.get()));
+		}
+		// the source points of w > 0 map to x <= 0, the others to the whole destination : only the source
+		// corner (0, 0), at the destination corner, is blended into the first columns by the filter
+		const double h[9] = { -4, 0, 0, 0, -4, 0, -0.08, 0, 1 };
+		const uint8_t bkcolor[3] = { 0, 0, 0 };
+		UniqueBitmap dst(FreeImage_WarpPerspective(src.get(), h, 128, 128, FILTER_BILINEAR, FIBM_ZERO, bkcolor), &::FreeImage_Unload);
+		assert(dst != nullptr);
+		for (unsigned y = 0; y < 128; y++) {
+			for (unsigned x = 4; x < 128; x++) {
+				const uint8_t *p = pixel24(dst.get(), x, y);
+				assert(p[0] == 0 && p[1] == 0 && p[2] == 0);
+			}
+		}
+	}
+
+	// a negative determinant : the sign of w does not depend on the scale of the inverse
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 64, 48, 24);
+		const double mirror[9] = { -1, 0, 63, 0, 1, 0, 0, 0, 1 };
+		UniqueBitmap dst(FreeImage_WarpPerspective(src.get(), mirror, 64, 48, FILTER_BILINEAR), &::FreeImage_Unload);
+		UniqueBitmap expected(FreeImage_Clone(src.get()), &::FreeImage_Unload);
+		assert(dst != nullptr && FreeImage_FlipHorizontal(expected.get()));
+		assert(sameBits(expected.get(), dst.get()));
+	}
+
+	// invalid parameters
+	{
+		UniqueBitmap src = makePattern(FIT_BITMAP, 8, 8, 24);
+		const double singular[9] = { 1, 2, 0, 2, 4, 0, 0, 0, 1 };
+		assert(FreeImage_WarpPerspective(src.get(), singular, 8, 8) == nullptr);
+		UniqueBitmap map_a(FreeImage_AllocateT(FIT_FLOAT, 8, 8), &::FreeImage_Unload);
+		UniqueBitmap map_b(FreeImage_AllocateT(FIT_FLOAT, 8, 7), &::FreeImage_Unload);
+		UniqueBitmap map_c(FreeImage_AllocateT(FIT_DOUBLE, 8, 8), &::FreeImage_Unload);
+		assert(FreeImage_Remap(src.get(), map_a.get(), map_b.get()) == nullptr);
+		assert(FreeImage_Remap(src.get(), map_c.get(), map_c.get()) == nullptr);
+		assert(FreeImage_ConvertRemapMap(map_c.get()) == nullptr);
+	}
+
+	// lens undistortion, radial model
+	{
+		const unsigned width = 192, height = 108;
+		UniqueBitmap src = makePattern(FIT_BITMAP, width, height, 24);
+		UniqueBitmap map_x(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+		UniqueBitmap map_y(FreeImage_AllocateT(FIT_FLOAT, width, height), &::FreeImage_Unload);
+		const double cx = (width - 1) / 2.0, cy = (height - 1) / 2.0, k1 = -0.08;
+		for (unsigned y = 0; y < height; y++) {
+			float *mx = reinterpret_cast<float*>(FreeImage_GetScanLine(map_x.get(), height - 1 - y));
+			float *my = reinterpret_cast<float*>(FreeImage_GetScanLine(map_y.get(), height - 1 - y));
+			for (unsigned x = 0; x < width; x++) {
+				const double nx = (x - cx) / cx, ny = (y - cy) / cx;
+				const double r = 1 + k1 * (nx * nx + ny * ny);
+				mx[x] = (float)(cx + nx * r * cx);
+				my[x] = (float)(cy + ny * r * cx);
+			}
+		}
+		UniqueBitmap a(FreeImage_Remap(src.get(), map_x.get(), map_y.get()), &::FreeImage_Unload);
+		UniqueBitmap fixed_x(FreeImage_ConvertRemapMap(map_x.get()), &::FreeImage_Unload);
+		UniqueBitmap fixed_y(FreeImage_ConvertRemapMap(map_y.get()), &::FreeImage_Unload);
+		UniqueBitmap b(FreeImage_Remap(src.get(), fixed_x.get(), fixed_y.get()), &::FreeImage_Unload);
+		assert(a != nullptr && b != nullptr);
+		assert(FreeImage_GetWidth(b.get()) == width && FreeImage_GetHeight(b.get()) == height);
+	}
+}
@@ -0,0 +1,165 @@
+// ==========================================================
+// FreeImage 3 Test Script
+//
+// Design and implementation by
+// - Herv Drolon (drolon@infonie.fr)
+//
+// This file is part of FreeImage 3
+//
+// COVERED CODE IS PROVIDED UNDER THIS LICENSE ON AN "AS IS" BASIS, WITHOUT WARRANTY
+// OF ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING, WITHOUT LIMITATION, WARRANTIES
+// THAT THE COVERED CODE IS FREE OF DEFECTS, MERCHANTABLE, FIT FOR A PARTICULAR PURPOSE
+// OR NON-INFRINGING. THE ENTIRE RISK AS TO THE QUALITY AND PERFORMANCE OF THE COVERED
+// CODE IS WITH YOU. SHOULD ANY COVERED CODE PROVE DEFECTIVE IN ANY RESPECT, YOU (NOT
+// THE INITIAL DEVELOPER OR ANY OTHER CONTRIBUTOR) ASSUME THE COST OF ANY NECESSARY
+// SERVICING, REPAIR OR CORRECTION. THIS DISCLAIMER OF WARRANTY CONSTITUTES AN ESSENTIAL
+// PART OF THIS LICENSE. NO USE OF ANY COVERED CODE IS AUTHORIZED HEREUNDER EXCEPT UNDER
+// THIS DISCLAIMER.
+//
+// Use at your own risk!
+// ==========================================================
+
+
+#include "TestSuite.h"
+#include <cstring>
+#include <memory>
+
+// ----------------------------------------------------------
+
+static bool
+equalPixels(FIBITMAP *dib1, FIBITMAP *dib2) {
+	if ((FreeImage_GetWidth(dib1) != FreeImage_GetWidth(dib2)) || (FreeImage_GetHeight(dib1) != FreeImage_GetHeight(dib2)) || (FreeImage_GetBPP(dib1) != FreeImage_GetBPP(dib2))) {
+		return false;
+	}
+	const unsigned line = FreeImage_GetLine(dib1);
+	for (unsigned y = 0; y < FreeImage_GetHeight(dib1); y++) {
+		if (memcmp(FreeImage_GetScanLine(dib1, y), FreeImage_GetScanLine(dib2, y), line) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+setTag(FIBITMAP *dib, const char *key, FREE_IMAGE_MDTYPE type, uint32_t length, const void *value) {
+	FITAG *tag = FreeImage_CreateTag();
+	assert(tag != nullptr);
+	FreeImage_SetTagKey(tag, key);
+	FreeImage_SetTagType(tag, type);
+	FreeImage_SetTagCount(tag, 1);
+	FreeImage_SetTagLength(tag, length);
+	FreeImage_SetTagValue(tag, value);
+	FreeImage_SetMetadata(FIMD_ANIMATION, dib, key, tag);
+	FreeImage_DeleteTag(tag);
+}
+
+static int32_t
+getAnimationTag(FIBITMAP *dib, const char *key) {
+	FITAG *tag = nullptr;
+	if (FreeImage_GetMetadata(FIMD_ANIMATION, dib, key, &tag) && (FreeImage_GetTagType(tag) == FIDT_LONG)) {
+		return *(const int32_t*)FreeImage_GetTagValue(tag);
+	}
+	return -1;
+}
+
+/**
+32-bit opaque frame with a gradient, and a flat rectangle given in top-down coordinates
+*/
+static FIBITMAP*
+createFrame(unsigned width, unsigned height, unsigned left, unsigned top, unsigned size, uint8_t value) {
+	FIBITMAP *dib = FreeImage_Allocate(width, height, 32);
+	assert(dib != nullptr);
+	for (unsigned y = 0; y < height; y++) {
+		FIRGBA8 *bits = (FIRGBA8*)FreeImage_GetScanLine(dib, height - 1 - y);
+		for (unsigned x = 0; x < width; x++) {
+			const bool inside = (x >= left) && (x < left + size) && (y >= top) && (y < top + size);
+			bits[x].red = inside ? value : (uint8_t)(x * 4);
+			bits[x].green = inside ? (uint8_t)(255 - value) : (uint8_t)(y * 5);
+			bits[x].blue = 0x40;
+			bits[x].alpha = 0xFF;
+		}
+	}
+	return dib;
+}
+
+// ----------------------------------------------------------
+
+/**
+Write a lossless animation through the multipage API, read it back and check the composited pages.
+The frames only differ by a small rectangle, so that the encoder stores sub-frames and the decoder has to blend them.
+*/
+static void
+testWebPAnimation(const char *lpszPathName, int load_flags) {
+	const unsigned width = 64, height = 48;
+
+	UniqueBitmap frame0(createFrame(width, height, 0, 0, 0, 0), &::FreeImage_Unload);
+	UniqueBitmap frame1(createFrame(width, height, 8, 4, 16, 0xF0), &::FreeImage_Unload);
+	UniqueBitmap frame2(createFrame(width, height, 40, 24, 8, 0x20), &::FreeImage_Unload);
+
+	int32_t loop = 3;
+	setTag(frame0.get(), "Loop", FIDT_LONG, 4, &loop);
+	int32_t frame_time = 40;
+	setTag(frame0.get(), "FrameTime", FIDT_LONG, 4, &frame_time);
+	frame_time = 250;
+	setTag(frame1.get(), "FrameTime", FIDT_LONG, 4, &frame_time);
+
+	// write the animation
+	{
+		FIMULTIBITMAP *out = FreeImage_OpenMultiBitmap(FIF_WEBP, lpszPathName, TRUE, FALSE, TRUE);
+		assert(out != nullptr);
+		FreeImage_AppendPage(out, frame0.get());
+		FreeImage_AppendPage(out, frame1.get());
+		FreeImage_AppendPage(out, frame2.get());
+		FIBOOL bSuccess = FreeImage_CloseMultiBitmap(out, WEBP_LOSSLESS);
+		assert(bSuccess);
+	}
+
+	// single page loading returns the first frame
+	{
+		UniqueBitmap dib(FreeImage_Load(FIF_WEBP, lpszPathName, load_flags), &::FreeImage_Unload);
+		assert(dib != nullptr);
+		assert(equalPixels(dib.get(), frame0.get()));
+	}
+
+	// composited pages, sequential then random access
+	{
+		FIMULTIBITMAP *src = FreeImage_OpenMultiBitmap(FIF_WEBP, lpszPathName, FALSE, TRUE, TRUE, load_flags);
+		assert(src != nullptr);
+		assert(FreeImage_GetPageCount(src) == 3);
+
+		FIBITMAP *expected[] = { frame0.get(), frame1.get(), frame2.get() };
+		const int32_t frame_times[] = { 40, 250, 100 };
+		const int order[] = { 0, 1, 2, 1, 0, 2 };
+		for (int page : order) {
+			FIBITMAP *dib = FreeImage_LockPage(src, page);
+			assert(dib != nullptr);
+			assert(equalPixels(dib, expected[page]));
+			assert(getAnimationTag(dib, "FrameTime") == frame_times[page]);
+			if (page == 0) {
+				assert(getAnimationTag(dib, "Loop") == loop);
+			}
+			FreeImage_UnlockPage(src, dib, FALSE);
+		}
+		FreeImage_CloseMultiBitmap(src, 0);
+	}
+}
+
+// ----------------------------------------------------------
+
+void testWebP(const char *lpszPathName) {
+	printf("testWebP ...\n");
+
+	// still image, single threaded decoding
+	{
+		UniqueBitmap dib(createFrame(64, 48, 8, 8, 16, 0x80), &::FreeImage_Unload);
+		FIBOOL bSuccess = FreeImage_Save(FIF_WEBP, dib.get(), lpszPathName, WEBP_LOSSLESS);
+		assert(bSuccess);
+		UniqueBitmap loaded(FreeImage_Load(FIF_WEBP, lpszPathName, WEBP_LOAD_NOTHREADS), &::FreeImage_Unload);
+		assert(loaded != nullptr);
+		UniqueBitmap loaded32(FreeImage_ConvertTo32Bits(loaded.get()), &::FreeImage_Unload);
+		assert(equalPixels(loaded32.get(), dib.get()));
+	}
+
+	testWebPAnimation(lpszPathName, 0);
+	testWebPAnimation(lpszPathName, WEBP_LOAD_NOTHREADS);
+}
@@ -17,7 +17,7 @@ ExternalProject_Add(WEBP
     DOWNLOAD_EXTRACT_TIMESTAMP TRUE
     UPDATE_COMMAND ""
     PATCH_COMMAND ""
-    BUILD_COMMAND ${BUILD_COMMAND_FOR_TARGET} -t webp libwebpmux sharpyuv
+    BUILD_COMMAND ${BUILD_COMMAND_FOR_TARGET} -t webp libwebpmux webpdemux sharpyuv
     INSTALL_COMMAND ""
     CMAKE_ARGS ${CMAKE_TOOLCHAIN_FILE_ARG} ${CMAKE_BUILD_TYPE_ARG} "-DWEBP_BUILD_ANIM_UTILS=OFF" "-DWEBP_BUILD_CWEBP=OFF" "-DWEBP_BUILD_DWEBP=OFF" "-DWEBP_BUILD_GIF2WEBP=OFF" "-DWEBP_BUILD_IMG2WEBP=OFF" 
         "-DWEBP_BUILD_VWEBP=OFF" "-DWEBP_BUILD_WEBPINFO=OFF" "-DWEBP_BUILD_LIBWEBPMUX=ON" "-DWEBP_BUILD_WEBPMUX=OFF" "-DWEBP_BUILD_EXTRAS=OFF" "-DWEBP_UNICODE=ON"
@@ -32,6 +32,7 @@ add_library(LibWEBP INTERFACE)
 add_dependencies(LibWEBP WEBP)
 link_config_aware_library_path(LibWEBP ${BINARY_DIR} libwebp${CMAKE_STATIC_LIBRARY_SUFFIX})
 link_config_aware_library_path(LibWEBP ${BINARY_DIR} libwebpmux${CMAKE_STATIC_LIBRARY_SUFFIX})
+link_config_aware_library_path(LibWEBP ${BINARY_DIR} libwebpdemux${CMAKE_STATIC_LIBRARY_SUFFIX})
 link_config_aware_library_path(LibWEBP ${BINARY_DIR} libsharpyuv${CMAKE_STATIC_LIBRARY_SUFFIX})
 target_include_directories(LibWEBP INTERFACE ${SOURCE_DIR} ${SOURCE_DIR}/src ${BINARY_DIR}/src)
 set_property(TARGET WEBP PROPERTY FOLDER "Dependencies")